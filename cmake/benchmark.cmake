@@ -0,0 +1,62 @@
+if(NOT ${USE_SYSTEM_BENCHMARK})
+    include(ExternalProject)
+
+    # Protect against multiple inclusion, which would fail when already imported targets are added once more.
+    set(_targetsDefined)
+    set(_targetsNotDefined)
+    set(_expectedTargets)
+    foreach(_expectedTarget benchmark::benchmark)
+        list(APPEND _expectedTargets ${_expectedTarget})
+        if(NOT TARGET ${_expectedTarget})
+            list(APPEND _targetsNotDefined ${_expectedTarget})
+        endif()
+        if(TARGET ${_expectedTarget})
+            list(APPEND _targetsDefined ${_expectedTarget})
+        endif()
+    endforeach()
+    if("${_targetsDefined}" STREQUAL "${_expectedTargets}")
+        unset(_targetsDefined)
+        unset(_targetsNotDefined)
+        unset(_expectedTargets)
+        set(CMAKE_IMPORT_FILE_VERSION)
+        cmake_policy(POP)
+        return()
+    endif()
+    if(NOT "${_targetsDefined}" STREQUAL "")
+        message(FATAL_ERROR "Some (but not all) targets in this export set were already defined.\nTargets Defined: ${_targetsDefined}\nTargets not yet defined: ${_targetsNotDefined}\n")
+    endif()
+    unset(_targetsDefined)
+    unset(_targetsNotDefined)
+    unset(_expectedTargets)
+
+    if(NOT BENCHMARK_VERSION)
+        message(FATAL_ERROR "BENCHMARK_VERSION is not set")
+    endif()
+
+    ExternalProject_Add(benchmark_external
+            PREFIX          "${CMAKE_CURRENT_BINARY_DIR}/external"
+            URL             "https://github.com/google/benchmark/archive/v${BENCHMARK_VERSION}.tar.gz"
+            CMAKE_ARGS      -DCMAKE_BUILD_TYPE=Release -DBENCHMARK_ENABLE_TESTING=OFF -DBENCHMARK_ENABLE_GTEST_TESTS=OFF -DCMAKE_CXX_FLAGS=${CMAKE_CXX_FLAGS}
+            INSTALL_COMMAND "")
+    ExternalProject_Get_Property(benchmark_external SOURCE_DIR BINARY_DIR)
+
+    # Hack to make it work, otherwise INTERFACE_INCLUDE_DIRECTORIES will not be propagated
+    file(MAKE_DIRECTORY "${SOURCE_DIR}/include")
+
+    add_library(benchmark::benchmark STATIC IMPORTED)
+        add_dependencies(benchmark::benchmark benchmark_external)
+        set_target_properties(benchmark::benchmark PROPERTIES
+            IMPORTED_LOCATION               "${BINARY_DIR}/src/${CMAKE_CFG_INTDIR}/${CMAKE_STATIC_LIBRARY_PREFIX}benchmark${CMAKE_STATIC_LIBRARY_SUFFIX}"
+            INTERFACE_INCLUDE_DIRECTORIES   "${SOURCE_DIR}/include"
+            INTERFACE_LINK_LIBRARIES        "\$<IF:\$<PLATFORM_ID:Windows>,Shlwapi,pthread>")
+
+    unset(SOURCE_DIR)
+    unset(BINARY_DIR)
+else()
+    if(NOT BENCHMARK_VERSION)
+        message(WARNING "BENCHMARK_VERSION is not set")
+        find_package(benchmark REQUIRED)
+    else()
+        find_package(benchmark REQUIRED VERSION ${BENCHMARK_VERSION})
+    endif()
+endif()
@@ -25,22 +25,30 @@
 #ifndef LOOT_API_H
 #define LOOT_API_H
 
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "loot/api_decorator.h"
 #include "loot/enum/game_type.h"
 #include "loot/enum/log_level.h"
+#include "loot/enum/log_overflow_policy.h"
 #include "loot/exception/condition_syntax_error.h"
 #include "loot/exception/cyclic_interaction_error.h"
 #include "loot/exception/error_categories.h"
 #include "loot/exception/file_access_error.h"
 #include "loot/exception/git_state_error.h"
+#include "loot/exception/operation_cancelled_error.h"
 #include "loot/exception/undefined_group_error.h"
+#include "loot/executor.h"
 #include "loot/game_interface.h"
+#include "loot/memory_resource.h"
 #include "loot/loot_version.h"
+#include "loot/struct/masterlist_update.h"
+#include "loot/struct/trace_span.h"
 
 namespace loot {
 /**@}*/
@@ -62,6 +70,82 @@ namespace loot {
 LOOT_API void SetLoggingCallback(
     std::function<void(LogLevel, const char*)> callback);
 
+/**
+ * @brief Set the callback function that is called when logging, and have it
+ *        called asynchronously.
+ * @details Instead of calling the callback on the thread that logs a message,
+ *          the message is queued and a dedicated logging thread passes queued
+ *          messages to the callback in the order they were logged. This
+ *          means a slow callback doesn't hold up the threads that libloot
+ *          uses to do its work. The callback is only ever called from the
+ *          logging thread. When the callback is replaced, any messages still
+ *          queued for it are passed to it first.
+ * @param callback
+ *        The function called when logging. The first parameter is the
+ *        level of the message being logged, and the second is the message.
+ * @param queueSize
+ *        The maximum number of messages that can be waiting to be passed to
+ *        the callback. Must be greater than zero.
+ * @param overflowPolicy
+ *        What to do when a message is logged while the queue is full.
+ */
+LOOT_API void SetAsyncLoggingCallback(
+    std::function<void(LogLevel, const char*)> callback,
+    size_t queueSize,
+    LogOverflowPolicy overflowPolicy);
+
+/**
+ * @brief Set the minimum level of message that is logged.
+ * @details Messages below the given level are discarded without being
+ *          formatted or passed to the logging callback. The level applies to
+ *          the current logging callback and to any that are set later. If
+ *          this function is not called, messages of all levels are logged.
+ *          If libloot was built with a higher minimum log level, messages
+ *          below that level are never logged.
+ * @param level
+ *        The minimum level of message to log.
+ */
+LOOT_API void SetLogLevel(LogLevel level);
+
+/**@}*/
+/**********************************************************************/ /**
+                                                                          *  @name
+                                                                          *Tracing
+                                                                          *Functions
+                                                                          *************************************************************************/
+/**@{*/
+
+/**
+ * @brief Set the callback function that is called when a traced span of
+ *        work ends.
+ * @details While tracing is enabled, libloot records spans for creating game
+ *          handles, loading each plugin, caching archives, refreshing the
+ *          condition evaluator's state, loading metadata lists, each sorting
+ *          phase and Git network operations. Tracing is disabled by default,
+ *          and while it is disabled recording a span costs a single check of
+ *          a flag.
+ * @param callback
+ *        The function called with each span as it ends. It may be called
+ *        from any thread, including concurrently from several threads, so it
+ *        should be thread-safe and should not block for long. Any exception
+ *        it throws is ignored. An empty function disables tracing.
+ */
+LOOT_API void SetTracingCallback(
+    std::function<void(const TraceSpan&)> callback);
+
+/**
+ * @brief Enable tracing, writing spans to a file.
+ * @details Replaces any tracing callback with one that writes each span to
+ *          the given file in the Chrome trace event JSON format, which can be
+ *          opened by ``chrome://tracing`` and the Perfetto UI. The file is
+ *          completed when tracing is disabled or the callback is replaced by
+ *          calling SetTracingCallback() or this function again.
+ * @param traceFile
+ *        The path to write the trace to. If a file already exists at this
+ *        path, it is overwritten.
+ */
+LOOT_API void SetTraceFile(const std::filesystem::path& traceFile);
+
 /**@}*/
 /**********************************************************************/ /**
                                                                           *  @name
@@ -106,6 +190,73 @@ LOOT_API bool IsCompatible(const unsigned int major,
  */
 LOOT_API void InitialiseLocale(const std::string& id = "");
 
+/**
+ * @brief Enable or disable sharing parsed plugins between game handles.
+ * @details While sharing is enabled, a game handle that loads a plugin file
+ *          that another handle in the same process has already loaded, with
+ *          the same game type and header-only setting, and which has not
+ *          changed size or modification time since, shares the other handle's
+ *          parsed plugin data instead of parsing the file again. Plugins are
+ *          only shared while at least one handle holds them. Sharing is
+ *          disabled by default.
+ * @param enabled
+ *        Whether to share plugins between game handles.
+ */
+LOOT_API void SetPluginSharingEnabled(bool enabled);
+
+/**
+ * @brief Set the executor that libloot runs its parallel work on.
+ * @details By default, libloot runs parallel work such as loading plugins,
+ *          parsing metadata, evaluating conditions and sorting on an internal
+ *          pool of threads sized according to the hardware concurrency. Once
+ *          an executor is set, that work is submitted to it instead, apart
+ *          from the work of game handles that have their own executor set
+ *          using GameInterface::SetExecutor(). Operations that are already
+ *          running keep using the executor that they started with.
+ * @param executor
+ *        The executor to use, or a null pointer to go back to using the
+ *        internal thread pool.
+ */
+LOOT_API void SetExecutor(std::shared_ptr<Executor> executor);
+
+/**
+ * @brief Set the memory resource that libloot allocates its largest internal
+ *        buffers from.
+ * @details By default, those buffers are allocated from the resource returned
+ *          using the global operator new. Once a memory resource is set,
+ *          they are allocated from it instead, apart from those of game
+ *          handles that have their own resource set using
+ *          GameInterface::SetMemoryResource(). The buffers that use it are
+ *          described for that function. Buffers that were allocated before
+ *          the resource was set keep using the resource that they were
+ *          allocated from, so the resource must outlive every game handle
+ *          that may have used it.
+ * @param resource
+ *        The memory resource to use, or a null pointer to go back to using
+ *        the default resource.
+ */
+LOOT_API void SetMemoryResource(MemoryResource* resource);
+
+/**
+ * @brief Limit the disk space used by the cache files in a directory.
+ * @details Removes the least recently used of libloot's cache files in the
+ *          given directory and its subdirectories until their total size is no
+ *          more than the given size. A cache file is used when it is written
+ *          or successfully loaded. The plugin cache files set using
+ *          GameInterface::SetPluginCachePath() and the compiled masterlist
+ *          files set using DatabaseInterface::SetMasterlistCachePath() are
+ *          cache files, so giving each game handle cache paths in a
+ *          subdirectory of one directory lets their total size be capped
+ *          across games. Other files are left alone and not counted.
+ * @param directory
+ *        The directory to trim. If it does not exist, nothing is removed.
+ * @param maxSize
+ *        The maximum total size of the cache files to keep, in bytes.
+ * @returns The total size of the files that were removed, in bytes.
+ */
+LOOT_API uintmax_t TrimCacheDirectory(const std::filesystem::path& directory,
+                                      uintmax_t maxSize);
+
 /**
  *  @brief Initialise a new game handle.
  *  @details Creates a handle for a game, which is then used by all
@@ -127,6 +278,22 @@ LOOT_API std::shared_ptr<GameInterface> CreateGameHandle(
     const GameType game,
     const std::filesystem::path& game_path,
     const std::filesystem::path& game_local_path = "");
+
+/**
+ *  @brief Update several masterlists at once.
+ *  @details Each masterlist is updated as if by calling
+ *           DatabaseInterface::UpdateMasterlist() on its database, but the
+ *           updates run concurrently, so their network transfers overlap and
+ *           each masterlist is parsed as soon as it has been checked out. This
+ *           function returns once all the updates have finished.
+ *  @param updates
+ *         The masterlists to update. Each must have a different database and
+ *         masterlist path.
+ *  @returns The result of each update, in the same order as the given
+ *           updates. An update failing does not stop the others.
+ */
+LOOT_API std::vector<MasterlistUpdateResult> UpdateMasterlists(
+    const std::vector<MasterlistUpdate>& updates);
 }
 
 #endif
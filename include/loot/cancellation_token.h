@@ -0,0 +1,67 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_CANCELLATION_TOKEN
+#define LOOT_CANCELLATION_TOKEN
+
+#include <atomic>
+#include <memory>
+
+#include "loot/api_decorator.h"
+
+namespace loot {
+/**
+ * @brief A class used to request that an asynchronous operation stops early.
+ * @details Copies of a token share the same state, so a token can be passed
+ *          to an operation and then cancelled using a copy that was kept by
+ *          the caller. Once cancelled, a token stays cancelled.
+ */
+class CancellationToken {
+public:
+  /**
+   * @brief Construct a CancellationToken that has not been cancelled.
+   */
+  LOOT_API CancellationToken();
+
+  /**
+   * @brief Request cancellation of any operations that were given this token
+   *        or one of its copies.
+   * @details This function can be called from any thread.
+   */
+  LOOT_API void Cancel();
+
+  /**
+   * @brief Check if cancellation has been requested.
+   * @return True if Cancel() has been called on this token or one of its
+   *         copies, false otherwise.
+   */
+  LOOT_API bool IsCancelled() const;
+
+private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+}
+
+#endif
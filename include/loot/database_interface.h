@@ -24,7 +24,9 @@
 #ifndef LOOT_DATABASE_INTERFACE
 #define LOOT_DATABASE_INTERFACE
 
+#include <chrono>
 #include <filesystem>
+#include <future>
 #include <optional>
 #include <string>
 #include <vector>
@@ -33,8 +35,10 @@
 #include "loot/metadata/group.h"
 #include "loot/metadata/message.h"
 #include "loot/metadata/plugin_metadata.h"
+#include "loot/struct/masterlist_changes.h"
 #include "loot/struct/masterlist_info.h"
 #include "loot/struct/simple_message.h"
+#include "loot/struct/user_metadata_changes.h"
 
 namespace loot {
 /** @brief The interface provided by API's database handle. */
@@ -60,6 +64,22 @@ public:
   virtual void LoadLists(const std::filesystem::path& masterlist_path,
                          const std::filesystem::path& userlist_path = "") = 0;
 
+  /**
+   * @brief Set the file in which to cache the masterlist in a compiled form.
+   * @details When the masterlist is loaded by LoadLists(), the compiled
+   *          masterlist is used instead of parsing the masterlist if it was
+   *          compiled from a file with identical contents. Otherwise the
+   *          masterlist is parsed and the cache file is overwritten with its
+   *          compiled form. Loading the compiled masterlist is much faster than
+   *          parsing it. An existing file with an unrecognised format is
+   *          ignored. By default no cache file is used.
+   * @param cachePath
+   *        The path to the cache file, which need not exist. If empty, no cache
+   *        file is used.
+   */
+  virtual void SetMasterlistCachePath(
+      const std::filesystem::path& cachePath) = 0;
+
   /**
    * Writes a metadata file containing all loaded user-added metadata.
    * @param outputFile
@@ -71,6 +91,30 @@ public:
   virtual void WriteUserMetadata(const std::filesystem::path& outputFile,
                                  const bool overwrite) const = 0;
 
+  /**
+   * @brief Writes the loaded user metadata to a file on another thread, if it
+   *        has changed since it was last saved to that file.
+   * @details The user metadata is unchanged if it has not been modified since
+   *          it was loaded from the file by LoadLists(), or since it was last
+   *          written to the file by this function or WriteUserMetadata(). The
+   *          metadata is first written to a temporary file in the same
+   *          directory, which then replaces the output file, so the output
+   *          file is never left partially written. The user metadata that is
+   *          written is the metadata that was loaded when this function was
+   *          called. Saves to the same database are run one at a time. The
+   *          DatabaseInterface must not be destroyed before the returned
+   *          future is ready.
+   * @param outputFile
+   *         The path to which the file shall be written. Any existing file is
+   *         overwritten.
+   * @returns A future that becomes ready when the save has finished. Its
+   *          value is true if the file was written and false if writing it was
+   *          skipped because the user metadata was unchanged. Getting its
+   *          value rethrows any exception thrown while saving.
+   */
+  virtual std::future<bool> SaveUserMetadataAsync(
+      const std::filesystem::path& outputFile) const = 0;
+
   /**
    *  @brief Writes a minimal metadata file that only contains plugins with
    *         Bash Tag suggestions and/or dirty info, plus the suggestions and
@@ -127,10 +171,56 @@ public:
                                 const std::string& remote_url,
                                 const std::string& remote_branch) = 0;
 
+  /**
+   *  @brief Start updating and loading the given masterlist in the background.
+   *  @details Updates the masterlist as UpdateMasterlist() would, then parses
+   *           it, on another thread, and returns immediately. This lets the
+   *           network transfer and parsing overlap with other work, such as
+   *           loading plugins.
+   *
+   *           A later call to UpdateMasterlist() with the same arguments waits
+   *           for the background work to finish and returns its result, or
+   *           throws the exception that it failed with, instead of updating
+   *           the masterlist again. A later call to LoadLists() with the same
+   *           masterlist path waits for the background work to finish and
+   *           uses the masterlist that it loaded if the file hasn't changed
+   *           since, instead of parsing it again. If the background work
+   *           failed, LoadLists() loads the masterlist as usual. Only the
+   *           first of those calls joins the background work, and the loaded
+   *           metadata isn't changed until then.
+   *  @param masterlist_path
+   *         The relative or absolute path to the masterlist file that should be
+   *         updated and loaded.
+   *  @param remote_url
+   *         The URL of the remote from which to fetch updates.
+   *  @param remote_branch
+   *         The branch of the remote from which to apply updates.
+   */
+  virtual void PrefetchMasterlist(const std::filesystem::path& masterlist_path,
+                                  const std::string& remote_url,
+                                  const std::string& remote_branch) = 0;
+
+  /**
+   *  @brief Get how the loaded masterlist's metadata changed the last time
+   *         that UpdateMasterlist() updated it.
+   *  @details The changes are found by comparing the masterlist that was
+   *           loaded before the update with the updated masterlist, so if no
+   *           masterlist was loaded, every entry in the updated masterlist is
+   *           reported. Callers can use the changes to only refresh data that
+   *           they derived from the affected metadata. Loading a masterlist
+   *           using LoadLists() does not change the result.
+   *  @returns The changes, which are empty if UpdateMasterlist() has not yet
+   *           updated the masterlist.
+   */
+  virtual MasterlistChanges GetMasterlistChanges() const = 0;
+
   /**
    *  @brief Get the given masterlist's revision.
    *  @details Getting a masterlist's revision is only possible if it is found
-   *           inside a local Git repository.
+   *           inside a local Git repository. The revision is cached, and the
+   *           cached revision is returned by later calls while the
+   *           repository's HEAD commit and the masterlist file's size and
+   *           modification time are unchanged.
    *  @param masterlist_path
    *         The relative or absolute path to the masterlist file that should be
    *         queried.
@@ -158,6 +248,21 @@ public:
   virtual bool IsLatestMasterlist(const std::filesystem::path& masterlist_path,
                                   const std::string& branch) const = 0;
 
+  /**
+   * @brief Set how long the result of checking for a newer masterlist is
+   *        reused for.
+   * @details IsLatestMasterlist() fetches from the masterlist's remote
+   *          repository. If it is called again with the same masterlist path
+   *          and branch within the given interval, and the repository's HEAD
+   *          commit is unchanged, the previous result is returned without
+   *          fetching again. Updating the masterlist using
+   *          UpdateMasterlist() also counts as checking it. By default the
+   *          interval is zero, so the result is never reused.
+   * @param interval
+   *        How long a result is reused for.
+   */
+  virtual void SetMasterlistFetchInterval(std::chrono::seconds interval) = 0;
+
   /**
    *  @}
    *  @name Non-plugin Data Access
@@ -257,6 +362,30 @@ public:
       bool includeUserMetadata = true,
       bool evaluateConditions = false) const = 0;
 
+  /**
+   *  @brief Get all the given plugins' loaded metadata.
+   *  @details This is equivalent to calling GetPluginMetadata() for each
+   *           plugin, but is faster when looking up metadata for many plugins,
+   *           as the work for all the plugins is done together.
+   *  @param plugins
+   *         The filenames of the plugins to look up metadata for.
+   *  @param includeUserMetadata
+   *         If true, any user metadata the plugins have is included in the
+   *         returned metadata, otherwise the metadata returned only includes
+   *         metadata from the masterlist.
+   *  @param evaluateConditions
+   *         If true, any metadata conditions are evaluated before the metadata
+   *         is returned, otherwise unevaluated metadata is returned. Evaluating
+   *         plugin metadata conditions does not clear the condition cache.
+   *  @returns A vector of optionals in the same order as the given plugins.
+   *           Each optional contains the corresponding plugin's metadata if it
+   *           has any, and no value otherwise.
+   */
+  virtual std::vector<std::optional<PluginMetadata>> GetPluginMetadataBatch(
+      const std::vector<std::string>& plugins,
+      bool includeUserMetadata = true,
+      bool evaluateConditions = false) const = 0;
+
   /**
    *  @brief Get a plugin's metadata loaded from the given userlist.
    *  @param plugin
@@ -272,6 +401,25 @@ public:
       const std::string& plugin,
       bool evaluateConditions = false) const = 0;
 
+  /**
+   *  @brief Get all the given plugins' metadata loaded from the userlist.
+   *  @details This is equivalent to calling GetPluginUserMetadata() for each
+   *           plugin, but is faster when looking up metadata for many plugins,
+   *           as the work for all the plugins is done together.
+   *  @param plugins
+   *         The filenames of the plugins to look up user-added metadata for.
+   *  @param evaluateConditions
+   *         If true, any metadata conditions are evaluated before the metadata
+   *         is returned, otherwise unevaluated metadata is returned. Evaluating
+   *         plugin metadata conditions does not clear the condition cache.
+   *  @returns A vector of optionals in the same order as the given plugins.
+   *           Each optional contains the corresponding plugin's user-added
+   *           metadata if it has any, and no value otherwise.
+   */
+  virtual std::vector<std::optional<PluginMetadata>> GetPluginUserMetadataBatch(
+      const std::vector<std::string>& plugins,
+      bool evaluateConditions = false) const = 0;
+
   /**
    *  @brief Sets a plugin's user metadata, overwriting any existing user
    *         metadata.
@@ -296,6 +444,20 @@ public:
    */
   virtual void DiscardAllUserMetadata() = 0;
 
+  /**
+   * @brief Applies a set of changes to the loaded user metadata at once.
+   * @details This is equivalent to calling DiscardPluginUserMetadata() for
+   *          each discarded plugin, then SetPluginUserMetadata() for each
+   *          plugin's metadata, then SetUserGroups() if groups are given, but
+   *          the loaded user metadata is only copied and replaced once, so any
+   *          cached data derived from it is only discarded once. Other threads
+   *          reading the user metadata see either none of the changes or all
+   *          of them.
+   * @param changes
+   *        The changes to apply.
+   */
+  virtual void ApplyUserMetadataChanges(const UserMetadataChanges& changes) = 0;
+
   /** @} */
 };
 }
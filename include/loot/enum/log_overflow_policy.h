@@ -0,0 +1,51 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_LOG_OVERFLOW_POLICY
+#define LOOT_LOG_OVERFLOW_POLICY
+
+/**
+ * The namespace used by libloot.
+ */
+namespace loot {
+/**
+ * @brief Codes used to specify what happens when asynchronous logging produces
+ *        messages faster than the logging callback can handle them, so that
+ *        the queue of messages waiting to be passed to the callback is full.
+ */
+enum struct LogOverflowPolicy : unsigned int {
+  /**
+   * The thread logging a message waits until there is room for it in the
+   * queue, so no messages are lost.
+   */
+  block,
+  /**
+   * The oldest message in the queue is discarded to make room for the new
+   * message, so the thread logging it never waits.
+   */
+  discardOldest,
+};
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TIE_BREAK_MODE
+#define LOOT_TIE_BREAK_MODE
+
+/**
+ * The namespace used by libloot.
+ */
+namespace loot {
+/**
+ * @brief An enum representing the ways in which sorting can order plugins
+ *        that their data and metadata do not order relative to one another.
+ */
+enum struct TieBreakMode : unsigned int {
+  /**
+   * Tie-break edges are added between every pair of plugins that are not
+   * already ordered relative to one another, so the time taken grows with the
+   * square of the number of plugins.
+   */
+  edges,
+  /**
+   * No tie-break edges are added. Instead, whenever more than one plugin could
+   * be next in the sorted load order, the plugin that comes first according
+   * to the tie-break comparison is picked. This is much faster for large
+   * numbers of plugins, but can give a different load order when the
+   * tie-break comparison disagrees with the order that other edges enforce.
+   */
+  lexicographic,
+};
+}
+
+#endif
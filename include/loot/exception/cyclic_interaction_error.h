@@ -44,17 +44,37 @@ public:
    */
   LOOT_API CyclicInteractionError(std::vector<Vertex> cycle);
 
+  /**
+   * @brief Construct an exception detailing several independent cycles.
+   * @param cycles Representations of the cyclic paths, which must not be
+   *               empty.
+   */
+  LOOT_API CyclicInteractionError(std::vector<std::vector<Vertex>> cycles);
+
   /**
    * @brief Get a representation of the cyclic path.
    * @details Each Vertex is the name of a graph element (plugin or group) and
    *          the type of the edge going to the next Vertex. The last Vertex
    *          has an edge going to the first Vertex.
-   * @return A vector of Vertex elements representing the cyclic path.
+   * @return A vector of Vertex elements representing the cyclic path. If
+   *         more than one cycle was found, this is the first of them.
    */
   LOOT_API std::vector<Vertex> GetCycle();
 
+  /**
+   * @brief Get representations of all the cycles that were found.
+   * @details Sorting finds one cycle through each set of plugins or groups
+   *          that are cyclic, so the cycles have no elements in common, and
+   *          every cycle in the graph passes through the elements of one of
+   *          them. Breaking the returned cycles may still leave other cycles
+   *          within the same sets of elements.
+   * @return The cycles, each represented in the same way as by GetCycle(),
+   *         with the cycle that GetCycle() returns first.
+   */
+  LOOT_API std::vector<std::vector<Vertex>> GetCycles();
+
 private:
-  const std::vector<Vertex> cycle_;
+  const std::vector<std::vector<Vertex>> cycles_;
 };
 }
 
@@ -0,0 +1,70 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_EXECUTOR
+#define LOOT_EXECUTOR
+
+#include <cstddef>
+#include <functional>
+
+namespace loot {
+/**
+ * @brief An interface that hosts can implement to run libloot's parallel
+ *        work on threads that they manage.
+ * @details By default, libloot runs parallel work on an internal pool of
+ *          threads sized according to the hardware concurrency. An executor
+ *          can be set for all of libloot using loot::SetExecutor(), or for a
+ *          single game handle using GameInterface::SetExecutor().
+ */
+class Executor {
+public:
+  virtual ~Executor() = default;
+
+  /**
+   * @brief Get the number of tasks that libloot should try to run at once.
+   * @details This is read when the executor is set. The thread that starts
+   *          a piece of parallel work also runs some of its tasks, so libloot
+   *          submits at most one fewer task than this at a time. A value of
+   *          zero is treated as one, which makes libloot run its parallel
+   *          work on the calling thread.
+   * @returns The concurrency to use.
+   */
+  virtual size_t GetConcurrency() const = 0;
+
+  /**
+   * @brief Run the given task.
+   * @details The task may be run on any thread, including the calling thread
+   *          before this function returns, and may be run after the calling
+   *          thread has started waiting for it: libloot does not rely on a
+   *          submitted task starting promptly to make progress. The task does
+   *          not throw. This function may be called concurrently from several
+   *          threads.
+   * @param task
+   *        The task to run.
+   */
+  virtual void Submit(std::function<void()> task) = 0;
+};
+}
+
+#endif
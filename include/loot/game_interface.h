@@ -24,10 +24,23 @@
 #ifndef LOOT_GAME_INTERFACE
 #define LOOT_GAME_INTERFACE
 
+#include <future>
 #include <optional>
 
+#include "loot/cancellation_token.h"
 #include "loot/database_interface.h"
+#include "loot/enum/tie_break_mode.h"
+#include "loot/executor.h"
+#include "loot/memory_resource.h"
 #include "loot/plugin_interface.h"
+#include "loot/struct/condition_statistics.h"
+#include "loot/struct/loaded_plugin_table.h"
+#include "loot/struct/memory_usage.h"
+#include "loot/struct/operation_progress.h"
+#include "loot/struct/plugin_summary.h"
+#include "loot/struct/sort_profile.h"
+#include "loot/struct/sort_statistics.h"
+#include "loot/vertex.h"
 
 namespace loot {
 /** @brief The interface provided for accessing game-specific functionality. */
@@ -45,6 +58,34 @@ public:
    */
   virtual std::shared_ptr<DatabaseInterface> GetDatabase() = 0;
 
+  /**
+   * @brief Enable or disable profiling of condition evaluation.
+   * @details While enabled, every evaluation of a metadata condition by this
+   *          game handle or its database records, for that condition string,
+   *          whether its result came from the condition cache, and if not,
+   *          how long it took to evaluate. This helps to find the
+   *          conditions that make sorting and metadata evaluation slow.
+   *          Enabling profiling discards any statistics recorded before, and
+   *          disabling it keeps them so that they can still be read.
+   *          Disabled by default.
+   * @param enabled
+   *        Whether to profile condition evaluation.
+   */
+  virtual void SetConditionProfilingEnabled(bool enabled) = 0;
+
+  /**
+   * @brief Get the statistics recorded by condition profiling.
+   * @param maxConditions
+   *        The maximum number of conditions to get statistics for. If zero,
+   *        statistics for all profiled conditions are returned.
+   * @returns The statistics for the conditions that took the most total time
+   *          to evaluate, in descending order of total time. Conditions that
+   *          took the same time are ordered by their numbers of evaluations,
+   *          then cache hits, then by condition string.
+   */
+  virtual std::vector<ConditionStatistics> GetConditionStatistics(
+      size_t maxConditions) const = 0;
+
   /**
    * @}
    * @name Plugin Data Access
@@ -62,21 +103,100 @@ public:
    */
   virtual bool IsValidPlugin(const std::string& plugin) const = 0;
 
+  /**
+   * @brief Check which of the given files are valid plugins.
+   * @details Each file is checked in the same way as by IsValidPlugin(), but
+   *          the files are checked in parallel, and their headers are kept so
+   *          that the next call to LoadPlugins() doesn't need to parse them
+   *          again for any of these plugins that it loads header-only, as
+   *          long as their files have not changed. The returned plugins are
+   *          not added to the loaded plugins.
+   * @param  plugins
+   *         The filenames of the files to check.
+   * @returns The valid plugins, with only their headers loaded, in the order
+   *          that they were given.
+   */
+  virtual std::vector<std::shared_ptr<const PluginInterface>>
+  FilterValidPlugins(const std::vector<std::string>& plugins) = 0;
+
+  /**
+   * @brief Set the file in which to persistently cache data derived from
+   *        plugins.
+   * @details When plugins are loaded, cached data is used for any plugin whose
+   *          file is the same file (e.g. the same inode, or on Windows the same
+   *          file ID) and has the same size and modification time as when the
+   *          data was cached, instead of being calculated again, and the cache file
+   *          is updated with any newly calculated data after loading and when
+   *          the game handle is destroyed. This allows the cached data to be
+   *          reused between processes. Currently only plugin CRCs are cached,
+   *          and they are only calculated when first needed. The cache file is read when this
+   *          function is called, and an existing file with an unrecognised
+   *          format is ignored. By default no cache file is used.
+   * @param cachePath
+   *        The path to the cache file, which need not exist. If empty, no cache
+   *        file is used.
+   */
+  virtual void SetPluginCachePath(const std::filesystem::path& cachePath) = 0;
+
   /**
    * @brief Parses plugins and loads their data.
    * @details Any previously-loaded plugin data is discarded when this function
-   *          is called.
+   *          is called, except for plugins that are loaded again using the
+   *          same header-only setting and whose files have not changed size
+   *          or modification time since they were last loaded: their existing
+   *          data is kept instead of parsing them again. Unchanged plugins
+   *          that are loaded again using a different header-only setting
+   *          reuse their parsed headers. If a given file does
+   *          not exist or does not have a plugin file extension, a
+   *          ``std::invalid_argument`` is thrown before any plugins are
+   *          loaded. If any given files cannot be parsed as plugins, the
+   *          others are still loaded, and then a ``std::invalid_argument``
+   *          that names all the invalid files is thrown.
    * @param plugins
    *        The filenames of the plugins to load.
    * @param loadHeadersOnly
    *        If true, only the plugins' ``TES4`` headers are loaded. If false,
    *        all records in the plugins are parsed, apart from the main master
    *        file if it has been identified by a previous call to
-   *        ``IdentifyMainMasterFile()``.
+   *        ``IdentifyMainMasterFile()``. Records are not parsed until data
+   *        that depends on them is first requested, so a plugin with records
+   *        that cannot be parsed causes a FileAccessError to be thrown at
+   *        that point. Sorting reads the records of all loaded
+   *        plugins up front, and does not sort any that cannot be parsed.
    */
   virtual void LoadPlugins(const std::vector<std::string>& plugins,
                            bool loadHeadersOnly) = 0;
 
+  /**
+   * @brief Parses plugins and loads their data on another thread.
+   * @details Behaves like LoadPlugins(), except that it returns immediately.
+   *          Asynchronous operations on the same GameInterface are run one at
+   *          a time, but they may run at the same time as synchronous calls,
+   *          so other functions that load plugins or change the load order
+   *          should not be called until the returned future is ready. Plugins
+   *          can be read using GetPlugin() while they are being loaded. If the
+   *          operation is cancelled, the plugins that were loaded before
+   *          cancellation are kept, and the others are not loaded.
+   * @param plugins
+   *        The filenames of the plugins to load.
+   * @param loadHeadersOnly
+   *        If true, only the plugins' ``TES4`` headers are loaded.
+   * @param cancellationToken
+   *        A token that can be cancelled to stop loading plugins.
+   * @param progressCallback
+   *        A function that is called each time a plugin is loaded. May be
+   *        empty.
+   * @returns A future that becomes ready when loading has finished. Getting
+   *          its value rethrows any exception thrown while loading, or throws
+   *          an OperationCancelledError if loading was cancelled. The
+   *          GameInterface must not be destroyed before the future is ready.
+   */
+  virtual std::future<void> LoadPluginsAsync(
+      const std::vector<std::string>& plugins,
+      bool loadHeadersOnly,
+      const CancellationToken& cancellationToken = CancellationToken(),
+      const ProgressCallback& progressCallback = ProgressCallback()) = 0;
+
   /**
    * @brief Get data for a loaded plugin.
    * @param  pluginName
@@ -97,6 +217,118 @@ public:
   virtual std::set<std::shared_ptr<const PluginInterface>> GetLoadedPlugins()
       const = 0;
 
+  /**
+   * @brief Get the data of all loaded plugins as a table of columns.
+   * @details This gives the same data as calling PluginInterface functions on
+   *          each of the plugins given by GetLoadedPlugins(), but in a single
+   *          call that returns plain values. Values that depend on a plugin's
+   *          records are read in parallel, parsing the records of any plugins
+   *          that were not loaded header-only if they haven't already been
+   *          parsed. CRCs are only given if they have already been calculated,
+   *          so getting the table never reads whole plugin files to calculate
+   *          them.
+   * @returns The table of loaded plugins.
+   */
+  virtual LoadedPluginTable GetLoadedPluginTable() const = 0;
+
+  /**
+   * @brief Get the loaded plugins whose records overlap with the given
+   *        plugin's records.
+   * @details Two plugins' records overlap if each contains a record with the
+   *          same FormID, or with the same record ID for Morrowind. Only
+   *          plugins that were not loaded header-only are compared, and
+   *          plugins whose FormIDs can't have any of the same origins are
+   *          skipped without comparing their records. Results are not cached,
+   *          so the records are compared each time this is called.
+   * @param pluginName
+   *        The filename of the plugin to find overlapping plugins for.
+   * @returns The filenames of the overlapping plugins, in case-insensitive
+   *          lexicographical order. The result is empty if the given plugin is
+   *          not loaded or was loaded header-only.
+   */
+  virtual std::vector<std::string> GetOverlappingPlugins(
+      const std::string& pluginName) const = 0;
+
+  /**
+   * @brief Get which of the given plugins have records that overlap with each
+   *        other.
+   * @details This gives the same results as calling GetOverlappingPlugins()
+   *          for each given plugin and keeping only the given plugins, but
+   *          compares each pair of plugins once, and compares the pairs in
+   *          parallel, so is much faster for many plugins.
+   * @param plugins
+   *        The filenames of the plugins to compare.
+   * @returns A vector with an element for each given plugin, holding the
+   *          filenames of the other given plugins whose records overlap with
+   *          its records, in case-insensitive lexicographical order. An
+   *          element is empty if its plugin is not loaded or was loaded
+   *          header-only.
+   */
+  virtual std::vector<std::vector<std::string>> GetPluginOverlaps(
+      const std::vector<std::string>& plugins) const = 0;
+
+  /**
+   * @brief Get the loaded plugins that have the given plugin as a master.
+   * @details The game handle keeps an index of each loaded plugin's masters,
+   *          so this does not need to check every loaded plugin. The master
+   *          itself does not need to be loaded.
+   * @param masterName
+   *        The filename of the master to find dependent plugins for.
+   * @returns The filenames of the loaded plugins that list the given plugin as
+   *          a master, in case-insensitive lexicographical order.
+   */
+  virtual std::vector<std::string> GetDependentPlugins(
+      const std::string& masterName) const = 0;
+
+  /**
+   * @brief Check if each of the given plugins is valid as a light master.
+   * @details This gives the same results as calling
+   *          PluginInterface::IsValidAsLightMaster() on each loaded plugin,
+   *          but checks the plugins in parallel. Checking a plugin that was
+   *          not loaded header-only needs its records, which are parsed if
+   *          they have not already been, unless the result was saved in the
+   *          persistent plugin cache while the plugin's file was unchanged.
+   *          Results are saved in the persistent plugin cache, so checking
+   *          the same unchanged plugins again is much faster.
+   * @param  plugins
+   *         The filenames of the plugins to check.
+   * @returns A vector with an element for each given plugin, which is true if
+   *          the plugin is loaded and is or would be valid as a light master,
+   *          false otherwise.
+   */
+  virtual std::vector<bool> ArePluginsValidAsLightMasters(
+      const std::vector<std::string>& plugins) const = 0;
+
+  /**
+   * @brief Parses plugins and gives a summary of each to a callback, without
+   *        keeping them loaded.
+   * @details Plugins are parsed in parallel, and each plugin's data is freed
+   *          once its summary has been given to the callback, so at most one
+   *          plugin per thread is held in memory at a time, however many
+   *          plugins are scanned. The loaded plugins are not changed, and
+   *          neither the plugin cache nor the persistent plugin cache is used.
+   *          Summaries are given in an unspecified order. Invalid plugins are
+   *          skipped, and once all the other plugins have been scanned an
+   *          std::invalid_argument that names all the invalid files is
+   *          thrown.
+   * @param plugins
+   *        The filenames of the plugins to scan.
+   * @param loadHeadersOnly
+   *        If true, only the plugins' ``TES4`` headers are parsed, and their
+   *        CRCs are not calculated.
+   * @param callback
+   *        The function to give each plugin's summary to.
+   * @param cancellationToken
+   *        A token that can be cancelled to stop scanning plugins. If it is
+   *        cancelled, plugins that haven't started being parsed are skipped
+   *        and an OperationCancelledError is thrown.
+   */
+  virtual void ScanPlugins(
+      const std::vector<std::string>& plugins,
+      bool loadHeadersOnly,
+      const PluginScanCallback& callback,
+      const CancellationToken& cancellationToken = CancellationToken()) = 0;
+
   /**
    *  @}
    *  @name Sorting
@@ -116,7 +348,10 @@ public:
    *  @details Pulls metadata from the masterlist and userlist if they are
    *           loaded, and reads the contents of each plugin. No changes are
    *           applied to the load order used by the game. This function does
-   *           not load or evaluate the masterlist or userlist.
+   *           not load or evaluate the masterlist or userlist. The plugins are
+   *           loaded in the same way as by ``LoadPlugins()``, so plugins that
+   *           were already loaded and are unchanged are not parsed again,
+   *           even if they were loaded header-only.
    *  @param plugins
    *         A vector of filenames of the plugins to sort.
    *  @returns A vector of the given plugin filenames in their sorted load
@@ -125,6 +360,174 @@ public:
   virtual std::vector<std::string> SortPlugins(
       const std::vector<std::string>& plugins) = 0;
 
+  /**
+   *  @brief Calculates a new load order for the given plugins on another
+   *         thread.
+   *  @details Behaves like SortPlugins(), except that it returns immediately.
+   *           The same restrictions as for LoadPluginsAsync() apply. Progress
+   *           is reported as each plugin is loaded and then as each sorting
+   *           phase starts. Cancellation is checked between plugins and
+   *           between sorting phases.
+   *  @param plugins
+   *         A vector of filenames of the plugins to sort.
+   *  @param cancellationToken
+   *         A token that can be cancelled to stop sorting.
+   *  @param progressCallback
+   *         A function that is called to report progress. May be empty.
+   *  @returns A future that holds the given plugin filenames in their sorted
+   *           load order. Getting its value rethrows any exception thrown
+   *           while sorting, or throws an OperationCancelledError if sorting
+   *           was cancelled.
+   */
+  virtual std::future<std::vector<std::string>> SortPluginsAsync(
+      const std::vector<std::string>& plugins,
+      const CancellationToken& cancellationToken = CancellationToken(),
+      const ProgressCallback& progressCallback = ProgressCallback()) = 0;
+
+  /**
+   *  @brief Calculates where to insert new plugins into an existing load
+   *         order, without sorting the plugins that are already in it.
+   *  @details The given plugins are loaded in the same way as by
+   *           ``SortPlugins()``. Each new plugin is then inserted, in the
+   *           given order, at the position allowed by its masters, master
+   *           flag, hardcoded position, requirements and load after metadata
+   *           relative to the plugins that are already in the load order.
+   *           Within that range its group, the plugins that its records
+   *           overlap with and the tie-break order are used in turn to choose
+   *           its position, as far as they can be satisfied. Only the new
+   *           plugins are compared with other plugins, so this is much faster
+   *           than sorting all the plugins, but the result may differ from
+   *           what ``SortPlugins()`` would give. No changes are applied to
+   *           the load order used by the game.
+   *  @param loadOrder
+   *         The filenames of the plugins in the existing load order, in their
+   *         existing order.
+   *  @param newPlugins
+   *         The filenames of the plugins to insert. None may also be in
+   *         ``loadOrder``, or a ``std::invalid_argument`` is thrown.
+   *  @returns The plugins in the existing load order in their existing
+   *           order, with the new plugins inserted among them. If the
+   *           existing order leaves no position that respects a new plugin's
+   *           masters, master flag, hardcoded position, requirements and
+   *           load after metadata, a CyclicInteractionError is thrown.
+   */
+  virtual std::vector<std::string> SortNewPlugins(
+      const std::vector<std::string>& loadOrder,
+      const std::vector<std::string>& newPlugins) = 0;
+
+  /**
+   *  @brief Calculates load orders for several sets of plugins at once.
+   *  @details Each profile is sorted as ``SortPlugins()`` would sort its
+   *           plugins if they were the only ones loaded and the profile's
+   *           load order was the game's current load order. Every distinct
+   *           plugin in the profiles is loaded only once, in the same way as
+   *           by ``LoadPlugins()``, so when this returns the loaded plugins
+   *           are those of all the profiles. Metadata is evaluated once for
+   *           all the profiles, and the profiles share the results of
+   *           comparing plugins' records with each other and with earlier
+   *           sorts. The profiles' plugin graphs are built and sorted
+   *           concurrently. Sorting profiles does not change the statistics
+   *           given by ``GetSortStatistics()`` or the graph used by
+   *           ``GetPluginsPath()``. No changes are applied to the load order
+   *           used by the game.
+   *  @param profiles
+   *         The profiles to sort.
+   *  @returns The sorted load order of each profile's plugins, in the same
+   *           order as the profiles. If any profile can't be sorted, the
+   *           exception thrown for it is rethrown instead.
+   */
+  virtual std::vector<std::vector<std::string>> SortProfiles(
+      const std::vector<SortProfile>& profiles) = 0;
+
+  /**
+   *  @brief Set how sorting orders plugins that are not otherwise ordered
+   *         relative to one another.
+   *  @details The mode is used by all subsequent sorts. By default,
+   *           ``TieBreakMode::edges`` is used.
+   *  @param mode
+   *         The tie-break mode to use.
+   */
+  virtual void SetSortTieBreakMode(TieBreakMode mode) = 0;
+
+  /**
+   *  @brief Set whether sorting checks the load order that it calculates
+   *         against every edge in the plugin graph.
+   *  @details If enabled, each subsequent sort ends with an extra
+   *           ``ValidateSortedOrder`` phase that checks, in parallel, that
+   *           every plugin loads after all the plugins that the graph says it
+   *           must load after. Any edges that are not respected are logged as
+   *           errors and recorded in the sort statistics. Validation is
+   *           disabled by default.
+   *  @param enabled
+   *         Whether to validate sorted load orders.
+   */
+  virtual void SetSortValidationEnabled(bool enabled) = 0;
+
+  /**
+   *  @brief Set whether plugins' record data is freed after sorting.
+   *  @details If enabled, each subsequent successful sort ends by freeing the
+   *           record data of all loaded plugins, keeping only the values that
+   *           were read from their records, such as their override record
+   *           counts. This greatly reduces the memory held by loaded plugins.
+   *           Sorts reuse the record overlap results of earlier sorts, but if
+   *           a plugin's records are needed again, for example to check if
+   *           they overlap with a plugin that was not sorted before, they are
+   *           read again from its file. Disabled by default.
+   *  @param enabled
+   *         Whether to free plugins' record data after sorting.
+   */
+  virtual void SetRecordReleaseAfterSortEnabled(bool enabled) = 0;
+
+  /**
+   *  @brief Get timings and counts for the most recent sort.
+   *  @returns The statistics for the last ``SortPlugins()`` call, or empty
+   *           statistics if no plugins have been sorted.
+   */
+  virtual SortStatistics GetSortStatistics() const = 0;
+
+  /**
+   *  @brief Get the shortest path between two plugins in the plugin graph of
+   *         the most recent sort.
+   *  @details The plugin graph of the most recent successful SortPlugins() or
+   *           SortPluginsAsync() call is kept, so the constraints that made a
+   *           plugin load after another can be found without sorting again.
+   *           The "shortest" path is the one with the fewest tie-break edges,
+   *           and then the fewest edges, as tie-break edges only make the
+   *           order deterministic. The graph is freed by TrimCaches().
+   *  @param fromPluginName
+   *         The filename of the plugin that loads earlier.
+   *  @param toPluginName
+   *         The filename of the plugin that loads later.
+   *  @returns A vector of Vertex elements representing the path from the
+   *           source plugin to the destination plugin, or an empty vector if
+   *           no path exists, including if the source plugin loads later.
+   *  @throws std::invalid_argument if either plugin was not sorted by the
+   *          most recent sort, or there is no graph from a successful sort.
+   */
+  virtual std::vector<Vertex> GetPluginsPath(
+      const std::string& fromPluginName,
+      const std::string& toPluginName) const = 0;
+
+  /**
+   *  @brief Sort the given plugins and write the data that the sort read to a
+   *         file.
+   *  @details Loads the plugins in the same way as SortPlugins(), then sorts
+   *           them and writes a capture of everything that the sort read from
+   *           the game: the plugins' sorting data, the groups, the load order
+   *           and the results of comparing plugins' records. The capture
+   *           contains no record data, and can be replayed to reproduce the
+   *           sort without the game's files. If the sort fails because of
+   *           cyclic interactions or an undefined group, the capture is still
+   *           written.
+   *  @param plugins
+   *         A vector of filenames of the plugins to sort.
+   *  @param outputFile
+   *         The path to write the capture to. If a file already exists at
+   *         this path, it is overwritten.
+   */
+  virtual void WriteSortCapture(const std::vector<std::string>& plugins,
+                                const std::filesystem::path& outputFile) = 0;
+
   /**
    *  @}
    *  @name Load Order Interaction
@@ -141,6 +544,23 @@ public:
    */
   virtual void LoadCurrentLoadOrderState() = 0;
 
+  /**
+   * @brief Enable or disable watching for changes to the game's files.
+   * @details While enabled, changes to files in the game's data directory,
+   *          its local data directory and its install directory are recorded
+   *          as they are made. Loading plugins then only reads the data
+   *          directory entries for files that have changed, instead of reading
+   *          the whole directory. If load order state has been loaded and its
+   *          files change, it is reloaded by the next function that reads or
+   *          sets the load order or the active state of plugins, as if
+   *          LoadCurrentLoadOrderState() was called first. Watching is
+   *          currently only supported on Linux: on other platforms, enabling
+   *          it has no effect. Disabled by default.
+   * @param enable
+   *        Whether to watch for file changes.
+   */
+  virtual void SetFileWatchingEnabled(bool enable) = 0;
+
   /**
    * @brief Check if a plugin is active.
    * @param  plugin
@@ -149,6 +569,20 @@ public:
    */
   virtual bool IsPluginActive(const std::string& plugin) const = 0;
 
+  /**
+   * @brief Check if each of the given plugins is active.
+   * @details This gives the same results as calling IsPluginActive() for each
+   *          plugin, but reads the load order state once for all of them, so
+   *          is much faster when checking many plugins, e.g. all loaded
+   *          plugins.
+   * @param  plugins
+   *         The filenames of the plugins for which to check the active state.
+   * @returns A vector with an element for each given plugin, which is true if
+   *          the plugin is active, false otherwise.
+   */
+  virtual std::vector<bool> ArePluginsActive(
+      const std::vector<std::string>& plugins) const = 0;
+
   /**
    * @brief Get the current load order.
    * @returns A vector of plugin filenames in their load order.
@@ -161,6 +595,69 @@ public:
    *        A vector of plugin filenames sorted in the load order to set.
    */
   virtual void SetLoadOrder(const std::vector<std::string>& loadOrder) = 0;
+
+  /**
+   *  @}
+   *  @name Memory Management
+   *  @{
+   */
+
+  /**
+   * @brief Get estimates of the memory that the game handle is using.
+   * @details The estimates cover the loaded plugins, the cached archive paths,
+   *          the game's database's masterlist and userlist, cached condition
+   *          results and the plugin sorter. If a masterlist is shared between
+   *          game handles, each handle counts it. This waits for any
+   *          asynchronous operation on the handle to finish.
+   * @returns The estimated memory usage.
+   */
+  virtual MemoryUsage GetMemoryUsage() const = 0;
+
+  /**
+   * @brief Free cached data that can be recalculated when it is next needed.
+   * @details Frees the record data of loaded plugins, as described for
+   *          SetRecordReleaseAfterSortEnabled(), the plugins that were loaded
+   *          to check that they are valid, cached condition results and
+   *          evaluated metadata, and the plugin sorter's graph and cached sort
+   *          results. Loaded plugins, the metadata lists and the results of
+   *          comparing plugins' records are kept. This waits for any
+   *          asynchronous operation on the handle to finish.
+   */
+  virtual void TrimCaches() = 0;
+
+  /**
+   * @brief Set the executor that this handle runs its parallel work on.
+   * @details The executor is used instead of the one set by
+   *          loot::SetExecutor() (or libloot's internal thread pool, if none
+   *          is set) for the parallel work done by this handle and its
+   *          database, such as loading plugins, evaluating conditions and
+   *          sorting. Operations that are already running keep using the
+   *          executor that they started with.
+   * @param executor
+   *        The executor to use, or a null pointer to stop using one for this
+   *        handle.
+   */
+  virtual void SetExecutor(std::shared_ptr<Executor> executor) = 0;
+
+  /**
+   * @brief Set the memory resource that this handle allocates its largest
+   *        internal buffers from.
+   * @details The resource is used instead of the one set by
+   *          loot::SetMemoryResource() for the loaded plugin objects, the
+   *          plugins loaded by FilterValidPlugins(), and the plugin sorter's
+   *          reachability sets, group membership sets and edge types.
+   *          Plugins' own data, values returned by the API and memory
+   *          allocated by libloot's dependencies are still allocated using the
+   *          global operator new. Buffers that were allocated before the
+   *          resource was set keep using the resource that they were allocated
+   *          from, so the resource must outlive the handle and, if plugin
+   *          sharing is enabled, every other handle that could share its
+   *          plugins.
+   * @param resource
+   *        The memory resource to use, or a null pointer to stop using one
+   *        for this handle.
+   */
+  virtual void SetMemoryResource(MemoryResource* resource) = 0;
 };
 }
 
@@ -0,0 +1,72 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_MEMORY_RESOURCE
+#define LOOT_MEMORY_RESOURCE
+
+#include <cstddef>
+
+namespace loot {
+/**
+ * @brief An interface that hosts can implement to provide the memory that
+ *        libloot allocates its largest internal buffers from.
+ * @details A memory resource can be set for all of libloot using
+ *          loot::SetMemoryResource(), or for a single game handle using
+ *          GameInterface::SetMemoryResource().
+ */
+class MemoryResource {
+public:
+  virtual ~MemoryResource() = default;
+
+  /**
+   * @brief Allocate memory.
+   * @details This function may be called concurrently from several threads.
+   *          If the memory can't be allocated, it should throw
+   *          ``std::bad_alloc``.
+   * @param bytes
+   *        The number of bytes to allocate.
+   * @param alignment
+   *        The alignment that the allocated memory must have, which is a power
+   *        of two.
+   * @returns A pointer to the allocated memory.
+   */
+  virtual void* Allocate(size_t bytes, size_t alignment) = 0;
+
+  /**
+   * @brief Free memory that was allocated by Allocate().
+   * @details This function may be called concurrently from several threads,
+   *          and does not throw.
+   * @param pointer
+   *        The pointer that Allocate() returned.
+   * @param bytes
+   *        The number of bytes that were given to Allocate().
+   * @param alignment
+   *        The alignment that was given to Allocate().
+   */
+  virtual void Deallocate(void* pointer, size_t bytes, size_t alignment) = 0;
+};
+}
+
+#endif
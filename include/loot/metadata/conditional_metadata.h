@@ -24,11 +24,14 @@
 #ifndef LOOT_METADATA_CONDITIONAL_METADATA
 #define LOOT_METADATA_CONDITIONAL_METADATA
 
+#include <memory>
 #include <string>
 
 #include "loot/api_decorator.h"
 
 namespace loot {
+class PluginMetadataInterner;
+
 /**
  * A base class for metadata that can be conditional based on the result of
  * evaluating a condition string.
@@ -68,10 +71,12 @@ public:
    * Get the condition string.
    * @return The object's condition string.
    */
-  LOOT_API std::string GetCondition() const;
+  LOOT_API const std::string& GetCondition() const;
 
 private:
-  std::string condition_;
+  friend class PluginMetadataInterner;
+
+  std::shared_ptr<const std::string> condition_;
 };
 }
 #endif
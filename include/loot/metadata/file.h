@@ -83,8 +83,10 @@ public:
   LOOT_API std::string GetDisplayName() const;
 
 private:
-  std::string name_;
-  std::string display_;
+  friend class PluginMetadataInterner;
+
+  std::shared_ptr<const std::string> name_;
+  std::shared_ptr<const std::string> display_;
 };
 }
 
@@ -24,12 +24,15 @@
 #ifndef LOOT_METADATA_LOCATION
 #define LOOT_METADATA_LOCATION
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "loot/api_decorator.h"
 
 namespace loot {
+class PluginMetadataInterner;
+
 /**
  * Represents a URL at which the parent plugin can be found.
  */
@@ -78,8 +81,10 @@ public:
   LOOT_API std::string GetName() const;
 
 private:
-  std::string url_;
-  std::string name_;
+  friend class PluginMetadataInterner;
+
+  std::shared_ptr<const std::string> url_;
+  std::shared_ptr<const std::string> name_;
 };
 }
 
@@ -100,7 +100,7 @@ public:
    * Get the message content.
    * @return The message's MessageContent objects.
    */
-  LOOT_API std::vector<MessageContent> GetContent() const;
+  LOOT_API const std::vector<MessageContent>& GetContent() const;
 
   /**
    * Get the message content given a language.
@@ -120,7 +120,21 @@ public:
    */
   LOOT_API SimpleMessage ToSimpleMessage(const std::string& language) const;
 
+  /**
+   * Get the message as a SimpleMessageView given a language, without copying
+   * any of its strings.
+   * @param  language
+   *         The preferred language for the message content.
+   * @return A SimpleMessageView object for the preferred language, or for
+   *         English if message text is not available for the given language.
+   *         It is only valid for as long as this Message is.
+   */
+  LOOT_API SimpleMessageView ToSimpleMessageView(
+      const std::string& language) const;
+
 private:
+  friend class PluginMetadataInterner;
+
   MessageType type_;
   std::vector<MessageContent> content_;
 };
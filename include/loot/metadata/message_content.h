@@ -24,12 +24,15 @@
 #ifndef LOOT_METADATA_MESSAGE_CONTENT
 #define LOOT_METADATA_MESSAGE_CONTENT
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "loot/api_decorator.h"
 
 namespace loot {
+class PluginMetadataInterner;
+
 /**
  * Represents a message's localised text content.
  */
@@ -62,13 +65,13 @@ public:
    * Get the message text.
    * @return A string containing the message text.
    */
-  LOOT_API std::string GetText() const;
+  LOOT_API const std::string& GetText() const;
 
   /**
    * Get the message language.
    * @return A code representing the language that the message is written in.
    */
-  LOOT_API std::string GetLanguage() const;
+  LOOT_API const std::string& GetLanguage() const;
 
   /**
    * A less-than operator implemented with no semantics so that MessageContent
@@ -96,11 +99,30 @@ public:
    *         default-constructed MessageContent is returned.
    */
   LOOT_API static MessageContent Choose(
-      const std::vector<MessageContent> content,
+      const std::vector<MessageContent>& content,
+      const std::string& language);
+
+  /**
+   * Choose a MessageContent object from a vector given a language, without
+   * copying it.
+   * @param  content
+   *         The MessageContent objects to choose between.
+   * @param  language
+   *         The language code for the preferred language to select. If no
+   *         message in the preferred language is present, the English
+   *         MessageContent will be returned.
+   * @return A pointer to the chosen element of the given vector, or a null
+   *         pointer if the given vector is empty or contains neither the
+   *         preferred language nor English.
+   */
+  LOOT_API static const MessageContent* ChoosePointer(
+      const std::vector<MessageContent>& content,
       const std::string& language);
 
 private:
-  std::string text_;
+  friend class PluginMetadataInterner;
+
+  std::shared_ptr<const std::string> text_;
   std::string language_;
 };
 }
@@ -145,6 +145,8 @@ public:
   LOOT_API MessageContent ChooseInfo(const std::string& language) const;
 
 private:
+  friend class PluginMetadataInterner;
+
   uint32_t crc_;
   unsigned int itm_;
   unsigned int ref_;
@@ -25,7 +25,9 @@
 #define LOOT_METADATA_PLUGIN_METADATA
 
 #include <cstdint>
+#include <functional>
 #include <list>
+#include <memory>
 #include <optional>
 #include <regex>
 #include <set>
@@ -40,6 +42,8 @@
 #include "loot/metadata/tag.h"
 
 namespace loot {
+class PluginMetadataInterner;
+
 /**
  * Represents a plugin's metadata.
  */
@@ -100,7 +104,7 @@ public:
    * filename comparison.
    * @return The normalized plugin name.
    */
-  LOOT_API std::string GetNormalizedName() const;
+  LOOT_API const std::string& GetNormalizedName() const;
 
   /**
    * Check if the plugin metadata is enabled for use during sorting.
@@ -120,49 +124,49 @@ public:
    * Get the plugins that the plugin must load after.
    * @return The plugins that the plugin must load after.
    */
-  LOOT_API std::set<File> GetLoadAfterFiles() const;
+  LOOT_API const std::set<File>& GetLoadAfterFiles() const;
 
   /**
    * Get the files that the plugin requires to be installed.
    * @return The files that the plugin requires to be installed.
    */
-  LOOT_API std::set<File> GetRequirements() const;
+  LOOT_API const std::set<File>& GetRequirements() const;
 
   /**
    * Get the files that the plugin is incompatible with.
    * @return The files that the plugin is incompatible with.
    */
-  LOOT_API std::set<File> GetIncompatibilities() const;
+  LOOT_API const std::set<File>& GetIncompatibilities() const;
 
   /**
    * Get the plugin's messages.
    * @return The plugin's messages.
    */
-  LOOT_API std::vector<Message> GetMessages() const;
+  LOOT_API const std::vector<Message>& GetMessages() const;
 
   /**
    * Get the plugin's Bash Tag suggestions.
    * @return The plugin's Bash Tag suggestions.
    */
-  LOOT_API std::set<Tag> GetTags() const;
+  LOOT_API const std::set<Tag>& GetTags() const;
 
   /**
    * Get the plugin's dirty plugin information.
    * @return The PluginCleaningData objects that identify the plugin as dirty.
    */
-  LOOT_API std::set<PluginCleaningData> GetDirtyInfo() const;
+  LOOT_API const std::set<PluginCleaningData>& GetDirtyInfo() const;
 
   /**
    * Get the plugin's clean plugin information.
    * @return The PluginCleaningData objects that identify the plugin as clean.
    */
-  LOOT_API std::set<PluginCleaningData> GetCleanInfo() const;
+  LOOT_API const std::set<PluginCleaningData>& GetCleanInfo() const;
 
   /**
    * Get the locations at which this plugin can be found.
    * @return The locations at which this plugin can be found.
    */
-  LOOT_API std::set<Location> GetLocations() const;
+  LOOT_API const std::set<Location>& GetLocations() const;
 
   /**
    * Get the plugin's messages as SimpleMessage objects for the given language.
@@ -173,6 +177,18 @@ public:
   LOOT_API std::vector<SimpleMessage> GetSimpleMessages(
       const std::string& language) const;
 
+  /**
+   * Get the plugin's messages as SimpleMessageView objects for the given
+   * language, without copying any of their strings.
+   * @param language
+   *        The language to create the SimpleMessageView objects for.
+   * @return The plugin's messages as SimpleMessageView objects, which are only
+   *         valid for as long as this PluginMetadata object exists and its
+   *         messages are not changed.
+   */
+  LOOT_API std::vector<SimpleMessageView> GetSimpleMessageViews(
+      const std::string& language) const;
+
   /**
    * Set whether the plugin metadata is enabled for use during sorting or not.
    * @param enabled
@@ -197,56 +213,56 @@ public:
    * @param after
    *        The files to set.
    */
-  LOOT_API void SetLoadAfterFiles(const std::set<File>& after);
+  LOOT_API void SetLoadAfterFiles(std::set<File> after);
 
   /**
    * Set the files that the plugin requires to be installed.
    * @param requirements
    *        The files to set.
    */
-  LOOT_API void SetRequirements(const std::set<File>& requirements);
+  LOOT_API void SetRequirements(std::set<File> requirements);
 
   /**
    * Set the files that the plugin must load after.
    * @param incompatibilities
    *        The files to set.
    */
-  LOOT_API void SetIncompatibilities(const std::set<File>& incompatibilities);
+  LOOT_API void SetIncompatibilities(std::set<File> incompatibilities);
 
   /**
    * Set the plugin's messages.
    * @param messages
    *        The messages to set.
    */
-  LOOT_API void SetMessages(const std::vector<Message>& messages);
+  LOOT_API void SetMessages(std::vector<Message> messages);
 
   /**
    * Set the plugin's Bash Tag suggestions.
    * @param tags
    *        The Bash Tag suggestions to set.
    */
-  LOOT_API void SetTags(const std::set<Tag>& tags);
+  LOOT_API void SetTags(std::set<Tag> tags);
 
   /**
    * Set the plugin's dirty information.
    * @param info
    *        The dirty information to set.
    */
-  LOOT_API void SetDirtyInfo(const std::set<PluginCleaningData>& info);
+  LOOT_API void SetDirtyInfo(std::set<PluginCleaningData> info);
 
   /**
    * Set the plugin's clean information.
    * @param info
    *        The clean information to set.
    */
-  LOOT_API void SetCleanInfo(const std::set<PluginCleaningData>& info);
+  LOOT_API void SetCleanInfo(std::set<PluginCleaningData> info);
 
   /**
    * Set the plugin's locations.
    * @param locations
    *        The locations to set.
    */
-  LOOT_API void SetLocations(const std::set<Location>& locations);
+  LOOT_API void SetLocations(std::set<Location> locations);
 
   /**
    * Check if no plugin metadata is set.
@@ -294,16 +310,29 @@ public:
 
 private:
   std::string name_;
+  // The name's normalized form, its hash and whether it is a regex are
+  // calculated once on construction, as hashing and comparing plugin metadata
+  // happens far more often than creating it.
+  std::string normalizedName_;
+  size_t normalizedNameHash_;
+  bool isRegexPlugin_;
   bool enabled_;
   std::optional<std::string> group_;
-  std::set<File> loadAfter_;
-  std::set<File> requirements_;
-  std::set<File> incompatibilities_;
-  std::vector<Message> messages_;
-  std::set<Tag> tags_;
-  std::set<PluginCleaningData> dirtyInfo_;
-  std::set<PluginCleaningData> cleanInfo_;
-  std::set<Location> locations_;
+
+  // The containers are immutable and shared between copies of the object, so
+  // that copying metadata doesn't copy them: they are replaced instead of
+  // being modified. Null pointers represent empty containers.
+  std::shared_ptr<const std::set<File>> loadAfter_;
+  std::shared_ptr<const std::set<File>> requirements_;
+  std::shared_ptr<const std::set<File>> incompatibilities_;
+  std::shared_ptr<const std::vector<Message>> messages_;
+  std::shared_ptr<const std::set<Tag>> tags_;
+  std::shared_ptr<const std::set<PluginCleaningData>> dirtyInfo_;
+  std::shared_ptr<const std::set<PluginCleaningData>> cleanInfo_;
+  std::shared_ptr<const std::set<Location>> locations_;
+
+  friend class PluginMetadataInterner;
+  friend struct std::hash<PluginMetadata>;
 };
 }
 
@@ -316,10 +345,10 @@ struct hash<loot::PluginMetadata> {
   /**
    * Calculate a hash value for an object of a class that implements
    * loot::PluginMetadata.
-   * @return The hash generated from the plugin's lowercased filename.
+   * @return The hash generated from the plugin's normalized filename.
    */
   size_t operator()(const loot::PluginMetadata& plugin) const {
-    return hash<string>()(plugin.GetNormalizedName());
+    return plugin.normalizedNameHash_;
   }
 };
 }
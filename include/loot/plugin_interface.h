@@ -79,6 +79,14 @@ public:
 
   /**
    * Get the plugin's CRC-32 checksum.
+   * @details The checksum of a fully loaded plugin is calculated the first
+   *          time that it is requested, unless it was read from the plugin
+   *          cache. Calculating it reads the plugin's file, so a
+   *          FileAccessError is thrown if the file can't be read, e.g.
+   *          because it was deleted after the plugin was loaded. If the file
+   *          was changed after the plugin was loaded, the checksum is that of
+   *          its new content, and so may not match the plugin's other data.
+   *          Once calculated, the checksum doesn't change.
    * @return An optional containing the plugin's CRC-32 checksum if the plugin
    *         has been fully loaded, otherwise an optional containing no value.
    */
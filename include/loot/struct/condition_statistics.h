@@ -0,0 +1,64 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+#ifndef LOOT_CONDITION_STATISTICS
+#define LOOT_CONDITION_STATISTICS
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace loot {
+/**
+ * @brief A structure that holds counts and timings for evaluating one
+ *        distinct condition string while condition profiling was enabled.
+ */
+struct ConditionStatistics {
+  inline ConditionStatistics() : evaluations(0), cacheHits(0), totalTime(0) {}
+
+  /**
+   * @brief The condition string.
+   */
+  std::string condition;
+
+  /**
+   * @brief The number of times that the condition was evaluated by the
+   *        condition interpreter.
+   */
+  size_t evaluations;
+
+  /**
+   * @brief The number of times that the condition's result was reused from
+   *        the condition cache instead of being evaluated.
+   */
+  size_t cacheHits;
+
+  /**
+   * @brief The total wall clock time spent evaluating the condition, not
+   *        including cache hits.
+   */
+  std::chrono::microseconds totalTime;
+};
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_LOADED_PLUGIN_TABLE
+#define LOOT_LOADED_PLUGIN_TABLE
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace loot {
+/**
+ * @brief The data of all loaded plugins, stored as columns of plain values,
+ *        as given by GameInterface::GetLoadedPluginTable().
+ * @details Each per-plugin column has one element per plugin, and all the
+ *          plugins' strings are concatenated in a single string table that
+ *          the columns refer to by offset and length, so the whole table is
+ *          held in a small, fixed number of allocations however many plugins
+ *          are loaded. Language bindings can expose the columns as arrays
+ *          without copying them or making a call per plugin. Strings are
+ *          UTF-8 encoded and are not null-terminated.
+ */
+struct LoadedPluginTable {
+  /**
+   * @brief Flags set in the ``flags`` column.
+   */
+  enum Flag : uint8_t {
+    /**
+     * @brief The plugin has its master flag set.
+     */
+    isMaster = 1,
+    /**
+     * @brief The plugin is a light master.
+     */
+    isLightMaster = 2,
+    /**
+     * @brief The plugin contains no records other than its ``TES4`` header.
+     */
+    isEmpty = 4,
+    /**
+     * @brief The plugin loads an archive.
+     */
+    loadsArchive = 8,
+    /**
+     * @brief The plugin was loaded header-only.
+     */
+    isHeaderOnly = 16,
+    /**
+     * @brief The plugin's version was read from its description field.
+     */
+    hasVersion = 32,
+    /**
+     * @brief The plugin's CRC is in the ``crcs`` column.
+     */
+    hasCrc = 64,
+  };
+
+  /**
+   * @brief Get the number of plugins in the table.
+   * @returns The number of plugins.
+   */
+  inline size_t Size() const { return flags.size(); }
+
+  /**
+   * @brief All the strings that the other columns refer to.
+   */
+  std::string strings;
+
+  /**
+   * @brief The offset and length of each plugin's filename in ``strings``.
+   *        Plugins are in case-insensitive lexicographical order of their
+   *        filenames.
+   */
+  std::vector<uint32_t> nameOffsets;
+  std::vector<uint32_t> nameLengths;
+
+  /**
+   * @brief Each plugin's flags, as a combination of Flag values.
+   */
+  std::vector<uint8_t> flags;
+
+  /**
+   * @brief The offset and length of each plugin's version in ``strings``, or
+   *        zero for plugins without the ``hasVersion`` flag.
+   */
+  std::vector<uint32_t> versionOffsets;
+  std::vector<uint32_t> versionLengths;
+
+  /**
+   * @brief Each plugin's CRC, or zero for plugins without the ``hasCrc``
+   *        flag.
+   */
+  std::vector<uint32_t> crcs;
+
+  /**
+   * @brief The number of override records in each plugin, which is zero for
+   *        header-only plugins.
+   */
+  std::vector<uint64_t> overrideRecordCounts;
+
+  /**
+   * @brief For each plugin, the index of its first master in the master
+   *        columns. The column has an extra element at the end, so plugin
+   *        ``i``'s masters are at indices ``masterStarts[i]`` up to but not
+   *        including ``masterStarts[i + 1]``.
+   */
+  std::vector<uint32_t> masterStarts;
+
+  /**
+   * @brief The offset and length in ``strings`` of each master filename,
+   *        with each plugin's masters in the order that it lists them.
+   */
+  std::vector<uint32_t> masterOffsets;
+  std::vector<uint32_t> masterLengths;
+};
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+#ifndef LOOT_MASTERLIST_CHANGES
+#define LOOT_MASTERLIST_CHANGES
+
+#include <string>
+#include <vector>
+
+namespace loot {
+/**
+ * @brief A structure that describes how a masterlist's metadata changed when
+ *        it was updated.
+ */
+struct MasterlistChanges {
+  inline MasterlistChanges() : messages_changed(false) {}
+
+  /**
+   * @brief The names of the plugin metadata entries that were added, removed
+   *        or changed, in case-insensitive alphabetical order. Regular
+   *        expression entries are identified by their regular expressions,
+   *        so plugins that they match may also be affected.
+   */
+  std::vector<std::string> plugins;
+
+  /**
+   * @brief The names of the groups that were added, removed or changed, in
+   *        alphabetical order.
+   */
+  std::vector<std::string> groups;
+
+  /**
+   * @brief The Bash Tags that were added to or removed from the masterlist's
+   *        list of known Bash Tags, in alphabetical order.
+   */
+  std::vector<std::string> bash_tags;
+
+  /**
+   * @brief `true` if any general messages were added, removed, changed or
+   *        reordered, and `false` otherwise.
+   */
+  bool messages_changed;
+};
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_MASTERLIST_UPDATE
+#define LOOT_MASTERLIST_UPDATE
+
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "loot/database_interface.h"
+
+namespace loot {
+/**
+ * @brief A structure that describes a masterlist to update using
+ *        UpdateMasterlists().
+ */
+struct MasterlistUpdate {
+  /**
+   * @brief The database to load the updated masterlist into.
+   */
+  std::shared_ptr<DatabaseInterface> database;
+
+  /**
+   * @brief The path to the masterlist file, as passed to
+   *        DatabaseInterface::UpdateMasterlist().
+   */
+  std::filesystem::path masterlist_path;
+
+  /**
+   * @brief The URL of the remote repository to update from.
+   */
+  std::string remote_url;
+
+  /**
+   * @brief The branch of the remote repository to update from.
+   */
+  std::string remote_branch;
+};
+
+/**
+ * @brief A structure that holds the result of updating a masterlist using
+ *        UpdateMasterlists().
+ */
+struct MasterlistUpdateResult {
+  inline MasterlistUpdateResult() : was_updated(false) {}
+
+  /**
+   * @brief `true` if the masterlist was updated, or `false` if it was already
+   *        up to date or could not be updated.
+   */
+  bool was_updated;
+
+  /**
+   * @brief The exception that was thrown while updating the masterlist, or
+   *        null if it was updated successfully.
+   */
+  std::exception_ptr error;
+};
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+#ifndef LOOT_MEMORY_USAGE
+#define LOOT_MEMORY_USAGE
+
+#include <cstddef>
+
+namespace loot {
+/**
+ * @brief A structure that holds estimates of the memory that a game handle is
+ *        using, in bytes.
+ * @details The estimates count the memory held by each part's data structures,
+ *          but not allocator overhead, so they are approximate.
+ */
+struct MemoryUsage {
+  inline MemoryUsage() :
+      plugins(0),
+      pluginRecords(0),
+      archivePaths(0),
+      masterlist(0),
+      userlist(0),
+      conditionCache(0),
+      sorter(0) {}
+
+  /**
+   * @brief The memory used by loaded plugins' data, apart from their records.
+   */
+  size_t plugins;
+
+  /**
+   * @brief The memory used by the records of loaded plugins.
+   * @details esplugin does not report how much memory a plugin's records use,
+   *          so this is an upper bound that assumes the plugin files contain
+   *          only the smallest possible records.
+   */
+  size_t pluginRecords;
+
+  /**
+   * @brief The memory used by the cached paths of archive files.
+   */
+  size_t archivePaths;
+
+  /**
+   * @brief The memory used by the loaded masterlist.
+   */
+  size_t masterlist;
+
+  /**
+   * @brief The memory used by the loaded userlist.
+   */
+  size_t userlist;
+
+  /**
+   * @brief The memory used by cached condition results and cached evaluated
+   *        metadata.
+   */
+  size_t conditionCache;
+
+  /**
+   * @brief The memory used by the plugin sorter, including its plugin graph,
+   *        record overlap results and cached sort results.
+   */
+  size_t sorter;
+
+  /**
+   * @brief Get the total of all the estimates.
+   * @returns The total estimated memory usage in bytes.
+   */
+  inline size_t Total() const {
+    return plugins + pluginRecords + archivePaths + masterlist + userlist +
+           conditionCache + sorter;
+  }
+};
+}
+
+#endif
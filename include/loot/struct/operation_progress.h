@@ -0,0 +1,72 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_OPERATION_PROGRESS
+#define LOOT_OPERATION_PROGRESS
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace loot {
+/**
+ * @brief A structure that describes how far an asynchronous operation has
+ *        got.
+ */
+struct OperationProgress {
+  inline OperationProgress() : completed(0), total(0) {}
+
+  /**
+   * @brief The stage that the operation has reached.
+   * @details This is ``LoadPlugins`` while plugins are being loaded, and the
+   *          name of the current sorting phase while plugins are being sorted.
+   *          Sorting phase names are the same as those recorded in
+   *          SortPhaseStatistics.
+   */
+  std::string stage;
+
+  /**
+   * @brief The number of items in the current stage that have been completed.
+   * @details While loading plugins, this is the number of plugins that have
+   *          been loaded. While sorting, it is the number of phases that have
+   *          completed.
+   */
+  size_t completed;
+
+  /**
+   * @brief The total number of items in the current stage.
+   */
+  size_t total;
+};
+
+/**
+ * @brief A function that is called to report an operation's progress.
+ * @details Calls are never made concurrently, but they may be made from any
+ *          thread, so the function should not block for long.
+ */
+typedef std::function<void(const OperationProgress&)> ProgressCallback;
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_PLUGIN_SUMMARY
+#define LOOT_PLUGIN_SUMMARY
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "loot/metadata/tag.h"
+
+namespace loot {
+/**
+ * @brief A compact summary of a plugin's data, as given by
+ *        GameInterface::ScanPlugins().
+ * @details Apart from the override record count, each field holds the value
+ *          that the equivalent PluginInterface function would give for the
+ *          plugin.
+ */
+struct PluginSummary {
+  inline PluginSummary() :
+      isMaster(false),
+      isLightMaster(false),
+      isEmpty(false),
+      loadsArchive(false) {}
+
+  /**
+   * @brief The plugin's filename, without any ``.ghost`` extension.
+   */
+  std::string name;
+
+  /**
+   * @brief The filenames of the plugin's masters, in the order they are
+   *        listed.
+   */
+  std::vector<std::string> masters;
+
+  /**
+   * @brief Whether the plugin has its master flag set.
+   */
+  bool isMaster;
+
+  /**
+   * @brief Whether the plugin is a light master.
+   */
+  bool isLightMaster;
+
+  /**
+   * @brief Whether the plugin contains no records. Only meaningful if the
+   *        plugin was scanned header-only.
+   */
+  bool isEmpty;
+
+  /**
+   * @brief Whether the plugin loads an archive.
+   */
+  bool loadsArchive;
+
+  /**
+   * @brief The plugin's version, as read from its description field.
+   */
+  std::optional<std::string> version;
+
+  /**
+   * @brief The Bash Tags suggested in the plugin's description field.
+   */
+  std::set<Tag> bashTags;
+
+  /**
+   * @brief The CRC-32 checksum of the plugin's file. Not set if the plugin
+   *        was scanned header-only.
+   */
+  std::optional<uint32_t> crc;
+
+  /**
+   * @brief The number of override records in the plugin. Not set if the
+   *        plugin was scanned header-only.
+   */
+  std::optional<size_t> overrideRecordCount;
+};
+
+/**
+ * @brief A function that is given the summary of each plugin that is scanned.
+ * @details Calls are never made concurrently, but they may be made from any
+ *          thread. Plugins are only parsed as fast as their summaries are
+ *          handled, so a slow function slows the scan down instead of
+ *          increasing its memory usage. If the function throws, no more
+ *          plugins are scanned and the exception is rethrown by the scan.
+ */
+typedef std::function<void(const PluginSummary&)> PluginScanCallback;
+}
+
+#endif
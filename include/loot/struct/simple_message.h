@@ -24,6 +24,9 @@
 #ifndef LOOT_SIMPLE_MESSAGE
 #define LOOT_SIMPLE_MESSAGE
 
+#include <string>
+#include <string_view>
+
 #include "loot/enum/message_type.h"
 
 namespace loot {
@@ -46,6 +49,31 @@ struct SimpleMessage {
   /** @brief The message's condition string. */
   std::string condition;
 };
+
+/**
+ * @brief A structure that holds the same data as a SimpleMessage, but refers
+ *        to the strings of the Message it was created from instead of copying
+ *        them.
+ * @details A SimpleMessageView is only valid for as long as the Message it
+ *          was created from exists and is not modified.
+ */
+struct SimpleMessageView {
+  /** @brief The type of the message. */
+  MessageType type;
+
+  /** @brief The language the message string is written in. */
+  std::string_view language;
+
+  /**
+   * @brief The message string, which may be formatted using
+   * [GitHub Flavored
+   * Markdown](https://help.github.com/articles/github-flavored-markdown).
+   */
+  std::string_view text;
+
+  /** @brief The message's condition string. */
+  std::string_view condition;
+};
 }
 
 #endif
@@ -0,0 +1,53 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_SORT_PROFILE
+#define LOOT_SORT_PROFILE
+
+#include <string>
+#include <vector>
+
+namespace loot {
+/**
+ * @brief A set of plugins to sort together with the load order that they are
+ *        sorted against, as given to GameInterface::SortProfiles().
+ */
+struct SortProfile {
+  /**
+   * @brief The filenames of the plugins to sort.
+   */
+  std::vector<std::string> plugins;
+
+  /**
+   * @brief The load order that is used in place of the game's current load
+   *        order when sorting the plugins.
+   * @details Plugins that are not in it are treated as having no load order
+   *          position. It may contain plugins that are not being sorted.
+   */
+  std::vector<std::string> loadOrder;
+};
+}
+
+#endif
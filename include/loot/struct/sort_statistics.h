@@ -0,0 +1,142 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_SORT_STATISTICS
+#define LOOT_SORT_STATISTICS
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "loot/enum/edge_type.h"
+
+namespace loot {
+/**
+ * @brief A structure that holds timings and counts for one phase of sorting.
+ */
+struct SortPhaseStatistics {
+  inline SortPhaseStatistics() :
+      duration(0), cycleChecks(0), pathQueries(0), pathHits(0) {}
+
+  /**
+   * @brief The name of the phase.
+   */
+  std::string name;
+
+  /**
+   * @brief The wall clock time that the phase took.
+   */
+  std::chrono::microseconds duration;
+
+  /**
+   * @brief The number of edges of each type that were added to the plugin
+   *        graph during the phase. Edge types with no added edges are omitted.
+   */
+  std::map<EdgeType, size_t> edgesAdded;
+
+  /**
+   * @brief The number of times that the phase checked if adding an edge would
+   *        create a cycle.
+   */
+  size_t cycleChecks;
+
+  /**
+   * @brief The number of times that the phase looked up whether a path
+   *        existed between two plugins.
+   */
+  size_t pathQueries;
+
+  /**
+   * @brief The number of path lookups that found an existing path.
+   */
+  size_t pathHits;
+};
+
+/**
+ * @brief A structure that describes an edge in the plugin graph that the
+ *        sorted load order does not respect.
+ */
+struct SortConstraintViolation {
+  inline SortConstraintViolation() : edgeType(EdgeType::hardcoded) {}
+
+  /**
+   * @brief The name of the plugin that the edge says should load first.
+   */
+  std::string fromPlugin;
+
+  /**
+   * @brief The name of the plugin that the edge says should load after
+   *        fromPlugin.
+   */
+  std::string toPlugin;
+
+  /**
+   * @brief The type of the edge.
+   */
+  EdgeType edgeType;
+};
+
+/**
+ * @brief A structure that holds timings and counts for a sort.
+ */
+struct SortStatistics {
+  inline SortStatistics() : peakGraphMemory(0), isCachedResult(false) {}
+
+  /**
+   * @brief The statistics for each phase of the sort, in the order in which
+   *        they were run. If there were no plugins to sort, or the result was
+   *        cached, later phases are omitted.
+   */
+  std::vector<SortPhaseStatistics> phases;
+
+  /**
+   * @brief An estimate of the most memory that the plugin graph used during
+   *        the sort, in bytes. This includes the graph's vertices and edges and
+   *        the data used to check for paths between plugins, but not the
+   *        plugins' own data or allocator overhead. It is zero if the graph
+   *        was not fully built.
+   */
+  size_t peakGraphMemory;
+
+  /**
+   * @brief The edges in the plugin graph that the sorted load order does not
+   *        respect, ordered by the position of their source plugins in the
+   *        graph. This is only populated if sort validation is enabled, and
+   *        should always be empty.
+   */
+  std::vector<SortConstraintViolation> constraintViolations;
+
+  /**
+   * @brief Whether the sorted load order was reused from an earlier sort with
+   *        the same inputs instead of being calculated again. If so,
+   *        peakGraphMemory and constraintViolations are those of the earlier
+   *        sort.
+   */
+  bool isCachedResult;
+};
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+#ifndef LOOT_TRACE_SPAN
+#define LOOT_TRACE_SPAN
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace loot {
+/**
+ * @brief A structure that describes a span of work that libloot did while
+ *        tracing was enabled.
+ */
+struct TraceSpan {
+  inline TraceSpan() : start(0), duration(0), threadId(0) {}
+
+  /**
+   * @brief The name of the span, e.g. ``LoadPlugins`` or the name of a
+   *        sorting phase.
+   */
+  std::string name;
+
+  /**
+   * @brief The part of libloot that the span belongs to, e.g. ``game``,
+   *        ``metadata``, ``sorting`` or ``git``.
+   */
+  std::string category;
+
+  /**
+   * @brief Extra information about the span, such as the name of the plugin
+   *        that was loaded. May be empty.
+   */
+  std::string detail;
+
+  /**
+   * @brief When the span started, relative to an arbitrary point in time that
+   *        is the same for all spans recorded by the process.
+   */
+  std::chrono::microseconds start;
+
+  /**
+   * @brief How long the span lasted.
+   */
+  std::chrono::microseconds duration;
+
+  /**
+   * @brief An ID for the thread that the span ran on. IDs are small integers
+   *        that are assigned to threads in the order that they first record
+   *        a span.
+   */
+  uint32_t threadId;
+};
+}
+
+#endif
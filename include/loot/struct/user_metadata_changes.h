@@ -0,0 +1,63 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+#ifndef LOOT_USER_METADATA_CHANGES
+#define LOOT_USER_METADATA_CHANGES
+
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "loot/metadata/group.h"
+#include "loot/metadata/plugin_metadata.h"
+
+namespace loot {
+/**
+ * @brief A structure that holds a set of changes to apply to the loaded user
+ *        metadata at once, using DatabaseInterface::ApplyUserMetadataChanges().
+ */
+struct UserMetadataChanges {
+  /**
+   * @brief The filenames of the plugins whose user metadata should be
+   *        discarded. These are discarded before the plugins' metadata in
+   *        `plugins` is set.
+   */
+  std::vector<std::string> discarded_plugins;
+
+  /**
+   * @brief The user metadata to set, each overwriting any existing user
+   *        metadata for the plugin that it is for. If more than one entry is
+   *        for the same plugin, the last one is used.
+   */
+  std::vector<PluginMetadata> plugins;
+
+  /**
+   * @brief If it has a value, the groups that should replace the existing
+   *        user group metadata.
+   */
+  std::optional<std::unordered_set<Group>> groups;
+};
+}
+
+#endif
@@ -24,12 +24,24 @@
 
 #include "loot/api.h"
 
+#include <atomic>
 #include <filesystem>
+#include <future>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include <boost/locale.hpp>
+#include <spdlog/async.h>
 
 #include "api/game/game.h"
+#include "api/game/shared_plugin_cache.h"
+#include "api/helpers/cache_file.h"
 #include "api/helpers/logging.h"
+#include "api/helpers/memory_resource.h"
+#include "api/helpers/thread_pool.h"
+#include "api/helpers/tracing.h"
 
 namespace fs = std::filesystem;
 
@@ -55,14 +67,131 @@ std::filesystem::path ResolvePath(const std::filesystem::path& path) {
   return path;
 }
 
+static std::atomic<LogLevel> logLevel(LogLevel::trace);
+static std::mutex loggingMutex;
+// The thread that asynchronous logging passes messages to the callback on.
+static std::shared_ptr<spdlog::details::thread_pool> loggingThreadPool;
+// Replaced loggers that may still be cached, e.g. by a PluginSorter, paired
+// with the thread pools that they log through. An async logger only holds a
+// weak pointer to its pool, so each pool is kept alive until its logger is
+// no longer referenced.
+static std::vector<std::pair<std::weak_ptr<spdlog::logger>,
+                             std::shared_ptr<spdlog::details::thread_pool>>>
+    retiredLoggingThreadPools;
+
+// Waits until the messages that the given async logger has queued have been
+// passed to its sinks' callbacks.
+static void WaitForQueuedMessages(const std::shared_ptr<spdlog::logger>& logger) {
+  for (const auto& sink : logger->sinks()) {
+    auto loggingSink = std::dynamic_pointer_cast<SpdLoggingSink>(sink);
+    if (!loggingSink) {
+      continue;
+    }
+
+    // If the logger discards its oldest messages when its queue is full, the
+    // flush may itself be discarded, so keep posting them until one arrives.
+    const auto flushCount = loggingSink->GetFlushCount();
+    do {
+      logger->flush();
+    } while (!loggingSink->WaitForFlush(flushCount,
+                                        std::chrono::milliseconds(100)));
+  }
+}
+
+void ReplaceLogger(std::shared_ptr<spdlog::logger> logger,
+                   std::shared_ptr<spdlog::details::thread_pool> threadPool) {
+  logger->set_level(mapToSpdlog(logLevel));
+
+  std::shared_ptr<spdlog::logger> oldAsyncLogger;
+  {
+    std::lock_guard<std::mutex> guard(loggingMutex);
+
+    auto oldLogger = getLogger();
+
+    spdlog::drop(LOGGER_NAME);
+    spdlog::register_logger(logger);
+    setLogger(logger);
+
+    if (loggingThreadPool) {
+      oldAsyncLogger = oldLogger;
+      retiredLoggingThreadPools.emplace_back(oldLogger,
+                                             std::move(loggingThreadPool));
+    }
+    loggingThreadPool = std::move(threadPool);
+  }
+
+  // The old thread pool isn't destroyed, as loggers that were cached before
+  // it was replaced may still log through it, but the messages that are
+  // already queued in it are passed to the old callback before returning.
+  if (oldAsyncLogger) {
+    WaitForQueuedMessages(oldAsyncLogger);
+    oldAsyncLogger.reset();
+  }
+
+  std::vector<std::shared_ptr<spdlog::details::thread_pool>> unusedThreadPools;
+  {
+    std::lock_guard<std::mutex> guard(loggingMutex);
+
+    for (auto it = retiredLoggingThreadPools.begin();
+         it != retiredLoggingThreadPools.end();) {
+      if (it->first.expired()) {
+        unusedThreadPools.push_back(std::move(it->second));
+        it = retiredLoggingThreadPools.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Queued messages hold their logger, so these pools' queues are empty, and
+  // destroying them just stops their threads.
+  unusedThreadPools.clear();
+}
+
 LOOT_API void SetLoggingCallback(
     std::function<void(LogLevel, const char*)> callback) {
   auto sink = std::make_shared<SpdLoggingSink>(callback);
   auto logger = std::make_shared<spdlog::logger>(LOGGER_NAME, sink);
-  logger->set_level(spdlog::level::level_enum::trace);
 
-  spdlog::drop(LOGGER_NAME);
-  spdlog::register_logger(logger);
+  ReplaceLogger(logger, nullptr);
+}
+
+LOOT_API void SetAsyncLoggingCallback(
+    std::function<void(LogLevel, const char*)> callback,
+    size_t queueSize,
+    LogOverflowPolicy overflowPolicy) {
+  if (queueSize == 0) {
+    throw std::invalid_argument("The logging queue size must be non-zero.");
+  }
+
+  auto policy = overflowPolicy == LogOverflowPolicy::discardOldest
+                    ? spdlog::async_overflow_policy::overrun_oldest
+                    : spdlog::async_overflow_policy::block;
+  auto threadPool =
+      std::make_shared<spdlog::details::thread_pool>(queueSize, 1);
+  auto sink = std::make_shared<SpdLoggingSink>(callback);
+  auto logger = std::make_shared<spdlog::async_logger>(
+      LOGGER_NAME, sink, threadPool, policy);
+
+  ReplaceLogger(logger, threadPool);
+}
+
+LOOT_API void SetLogLevel(LogLevel level) {
+  logLevel = level;
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->set_level(mapToSpdlog(level));
+  }
+}
+
+LOOT_API void SetTracingCallback(
+    std::function<void(const TraceSpan&)> callback) {
+  setTraceCallback(std::move(callback));
+}
+
+LOOT_API void SetTraceFile(const std::filesystem::path& traceFile) {
+  setTraceFile(traceFile);
 }
 
 LOOT_API bool IsCompatible(const unsigned int versionMajor,
@@ -78,10 +207,29 @@ LOOT_API void InitialiseLocale(const std::string& id) {
   std::locale::global(boost::locale::generator().generate(id));
 }
 
+LOOT_API void SetPluginSharingEnabled(bool enabled) {
+  SharedPluginCache::Get().SetEnabled(enabled);
+}
+
+LOOT_API void SetExecutor(std::shared_ptr<Executor> executor) {
+  ThreadPool::SetGlobalExecutor(executor);
+}
+
+LOOT_API void SetMemoryResource(MemoryResource* resource) {
+  SetGlobalMemoryResource(GetMemoryResourceAdapter(resource));
+}
+
+LOOT_API uintmax_t TrimCacheDirectory(const std::filesystem::path& directory,
+                                      uintmax_t maxSize) {
+  TraceScope traceScope("TrimCacheDirectory", "game", directory.u8string());
+  return TrimCacheFiles(directory, maxSize);
+}
+
 LOOT_API std::shared_ptr<GameInterface> CreateGameHandle(
     const GameType game,
     const std::filesystem::path& gamePath,
     const std::filesystem::path& gameLocalPath) {
+  TraceScope traceScope("CreateGameHandle", "game");
   auto logger = getLogger();
   if (logger) {
     logger->info(
@@ -103,4 +251,55 @@ LOOT_API std::shared_ptr<GameInterface> CreateGameHandle(
 
   return std::make_shared<Game>(game, resolvedGamePath, resolvedGameLocalPath);
 }
+
+LOOT_API std::vector<MasterlistUpdateResult> UpdateMasterlists(
+    const std::vector<MasterlistUpdate>& updates) {
+  // Updates sharing a database or repository would race with each other.
+  std::set<DatabaseInterface*> databases;
+  std::set<fs::path> masterlistPaths;
+  for (const auto& update : updates) {
+    if (!update.database) {
+      throw std::invalid_argument("Masterlist update has no database.");
+    }
+
+    auto masterlistPath =
+        fs::absolute(update.masterlist_path).lexically_normal();
+    if (!databases.insert(update.database.get()).second ||
+        !masterlistPaths.insert(masterlistPath).second) {
+      throw std::invalid_argument(
+          "Masterlist updates must have different databases and paths.");
+    }
+  }
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->info("Updating {} masterlists concurrently.", updates.size());
+  }
+
+  // Each update spends most of its time waiting on the network, so give
+  // each its own thread instead of using the shared thread pool.
+  std::vector<std::future<bool>> futures;
+  for (const auto& update : updates) {
+    futures.push_back(std::async(std::launch::async, [&update]() {
+      return update.database->UpdateMasterlist(
+          update.masterlist_path, update.remote_url, update.remote_branch);
+    }));
+  }
+
+  std::vector<MasterlistUpdateResult> results(updates.size());
+  for (size_t i = 0; i < futures.size(); ++i) {
+    try {
+      results[i].was_updated = futures[i].get();
+    } catch (std::exception& e) {
+      if (logger) {
+        logger->error("Failed to update the masterlist at \"{}\": {}",
+                      updates[i].masterlist_path.u8string(),
+                      e.what());
+      }
+      results[i].error = std::current_exception();
+    }
+  }
+
+  return results;
+}
 }
@@ -24,10 +24,18 @@
 
 #include "api/api_database.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <unordered_map>
 #include <vector>
 
 #include "api/game/game.h"
+#include "api/helpers/logging.h"
+#include "api/helpers/memory_usage.h"
+#include "api/helpers/text.h"
+#include "api/helpers/thread_pool.h"
+#include "api/helpers/tracing.h"
 #include "api/metadata/condition_evaluator.h"
 #include "api/metadata/yaml/plugin_metadata.h"
 #include "api/sorting/plugin_sorter.h"
@@ -37,7 +45,9 @@
 
 namespace loot {
 ApiDatabase::ApiDatabase(std::shared_ptr<ConditionEvaluator> conditionEvaluator) :
-  conditionEvaluator_(conditionEvaluator) {}
+  conditionEvaluator_(conditionEvaluator),
+  lists_(std::make_shared<Lists>(Lists{std::make_shared<Masterlist>(),
+                                       std::make_shared<MetadataList>()})) {}
 
 ///////////////////////////////////
 // Database Loading Functions
@@ -45,12 +55,34 @@ ApiDatabase::ApiDatabase(std::shared_ptr<ConditionEvaluator> conditionEvaluator)
 
 void ApiDatabase::LoadLists(const std::filesystem::path& masterlistPath,
                             const std::filesystem::path& userlistPath) {
-  Masterlist temp;
-  MetadataList userTemp;
+  TraceScope traceScope("LoadLists", "metadata");
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  std::shared_ptr<const Masterlist> temp = std::make_shared<Masterlist>();
+  auto userTemp = std::make_shared<MetadataList>();
+
+  // Holding the prefetched masterlist keeps it available to LoadShared().
+  std::shared_ptr<const Masterlist> prefetched;
+  if (!masterlistPath.empty()) {
+    auto prefetch = TakeMasterlistPrefetch(masterlistPath);
+    if (prefetch) {
+      try {
+        prefetched = prefetch->result.get().masterlist;
+      } catch (std::exception& e) {
+        auto logger = getLogger();
+        if (logger) {
+          logger->warn(
+              "Prefetching the masterlist failed, loading it instead: {}",
+              e.what());
+        }
+      }
+    }
+  }
 
   if (!masterlistPath.empty()) {
     if (std::filesystem::exists(masterlistPath)) {
-      temp.Load(masterlistPath);
+      // Masterlists are immutable once loaded, so game handles that load the
+      // same masterlist share one copy of it.
+      temp = Masterlist::LoadShared(masterlistPath, masterlistCachePath_);
     } else {
       throw FileAccessError("The given masterlist path does not exist: " +
                             masterlistPath.u8string());
@@ -59,15 +91,28 @@ void ApiDatabase::LoadLists(const std::filesystem::path& masterlistPath,
 
   if (!userlistPath.empty()) {
     if (std::filesystem::exists(userlistPath)) {
-      userTemp.Load(userlistPath);
+      userTemp->Load(userlistPath);
     } else {
       throw FileAccessError("The given userlist path does not exist: " +
                             userlistPath.u8string());
     }
   }
 
-  masterlist_ = temp;
-  userlist_ = userTemp;
+  {
+    std::lock_guard<std::mutex> lock(listsWriteMutex_);
+    SetLists(std::make_shared<Lists>(Lists{temp, userTemp}));
+  }
+
+  if (userlistPath.empty()) {
+    SetSavedUserlist("", nullptr);
+  } else {
+    SetSavedUserlist(userlistPath, userTemp);
+  }
+}
+
+void ApiDatabase::SetMasterlistCachePath(
+    const std::filesystem::path& cachePath) {
+  masterlistCachePath_ = cachePath;
 }
 
 void ApiDatabase::WriteUserMetadata(const std::filesystem::path& outputFile,
@@ -79,7 +124,46 @@ void ApiDatabase::WriteUserMetadata(const std::filesystem::path& outputFile,
     throw FileAccessError(
         "Output file exists but overwrite is not set to true.");
 
-  userlist_.Save(outputFile);
+  auto userlist = GetLists()->userlist;
+  userlist->Save(outputFile);
+  SetSavedUserlist(outputFile, userlist);
+}
+
+std::future<bool> ApiDatabase::SaveUserMetadataAsync(
+    const std::filesystem::path& outputFile) const {
+  // Get the userlist now so that later changes aren't saved.
+  auto userlist = GetLists()->userlist;
+
+  return std::async(std::launch::async, [this, outputFile, userlist]() {
+    std::lock_guard<std::mutex> lock(userlistSaveMutex_);
+    const auto path = std::filesystem::absolute(outputFile).lexically_normal();
+
+    if (std::filesystem::exists(path)) {
+      std::lock_guard<std::mutex> savedLock(savedUserlistMutex_);
+      if (savedUserlist_ == userlist && savedUserlistPath_ == path) {
+        return false;
+      }
+    }
+
+    if (!std::filesystem::exists(path.parent_path()))
+      throw std::invalid_argument("Output directory does not exist.");
+
+    // Write to a temporary file first so that the output file is replaced in
+    // one step.
+    auto tempPath = path;
+    tempPath += ".tmp";
+    try {
+      userlist->Save(tempPath);
+      std::filesystem::rename(tempPath, path);
+    } catch (...) {
+      std::error_code errorCode;
+      std::filesystem::remove(tempPath, errorCode);
+      throw;
+    }
+
+    SetSavedUserlist(path, userlist);
+    return true;
+  });
 }
 
 ////////////////////////////////////
@@ -89,29 +173,120 @@ void ApiDatabase::WriteUserMetadata(const std::filesystem::path& outputFile,
 bool ApiDatabase::UpdateMasterlist(const std::filesystem::path& masterlistPath,
                                    const std::string& remoteURL,
                                    const std::string& remoteBranch) {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
   if (!std::filesystem::is_directory(masterlistPath.parent_path()))
     throw std::invalid_argument("Given masterlist path \"" + masterlistPath.u8string() +
                                 "\" does not have a valid parent directory.");
 
-  Masterlist masterlist;
-  if (masterlist.Update(masterlistPath, remoteURL, remoteBranch)) {
-    masterlist_ = masterlist;
+  // A prefetch of the same masterlist is either joined or, if it was started
+  // with different arguments, waited for so that the two updates don't race.
+  auto prefetch = TakeMasterlistPrefetch(masterlistPath);
+  if (prefetch && prefetch->remoteUrl == remoteURL &&
+      prefetch->remoteBranch == remoteBranch) {
+    auto result = prefetch->result.get();
+    if (result.wasUpdated) {
+      SetUpdatedMasterlist(result.masterlist);
+    }
+    return result.wasUpdated;
+  } else if (prefetch) {
+    prefetch->result.wait();
+  }
+
+  auto masterlist = std::make_shared<Masterlist>();
+  if (masterlist->Update(masterlistPath,
+                         remoteURL,
+                         remoteBranch,
+                         &masterlistRevisionCache_)) {
+    SetUpdatedMasterlist(masterlist);
     return true;
   }
 
   return false;
 }
 
+void ApiDatabase::PrefetchMasterlist(
+    const std::filesystem::path& masterlistPath,
+    const std::string& remoteURL,
+    const std::string& remoteBranch) {
+  if (!std::filesystem::is_directory(masterlistPath.parent_path()))
+    throw std::invalid_argument("Given masterlist path \"" + masterlistPath.u8string() +
+                                "\" does not have a valid parent directory.");
+  if (remoteURL.empty() || remoteBranch.empty())
+    throw std::invalid_argument("Repository URL and branch must not be empty.");
+
+  auto path = std::filesystem::absolute(masterlistPath).lexically_normal();
+
+  std::optional<MasterlistPrefetch> previous;
+  {
+    std::lock_guard<std::mutex> lock(masterlistPrefetchMutex_);
+    if (masterlistPrefetch_ && masterlistPrefetch_->path == path &&
+        masterlistPrefetch_->remoteUrl == remoteURL &&
+        masterlistPrefetch_->remoteBranch == remoteBranch) {
+      return;
+    }
+    previous.swap(masterlistPrefetch_);
+  }
+
+  // Don't let an earlier prefetch race with this one.
+  if (previous) {
+    previous->result.wait();
+    previous.reset();
+  }
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->info("Prefetching the masterlist at \"{}\" in the background.",
+                 path.u8string());
+  }
+
+  MasterlistPrefetch prefetch;
+  prefetch.path = path;
+  prefetch.remoteUrl = remoteURL;
+  prefetch.remoteBranch = remoteBranch;
+  // This spends most of its time waiting on the network, so it gets its own
+  // thread instead of using the shared thread pool.
+  prefetch.result =
+      std::async(std::launch::async,
+                 [this,
+                  path,
+                  remoteURL,
+                  remoteBranch,
+                  cachePath = masterlistCachePath_,
+                  threadPool = std::atomic_load(&threadPool_)]() {
+                   ThreadPoolScope threadPoolScope(threadPool);
+                   MasterlistPrefetch::Result result;
+                   result.wasUpdated = Masterlist().Update(
+                       path, remoteURL, remoteBranch, &masterlistRevisionCache_);
+                   result.masterlist = Masterlist::LoadShared(path, cachePath);
+                   return result;
+                 })
+          .share();
+
+  std::lock_guard<std::mutex> lock(masterlistPrefetchMutex_);
+  masterlistPrefetch_ = std::move(prefetch);
+}
+
+MasterlistChanges ApiDatabase::GetMasterlistChanges() const {
+  std::lock_guard<std::mutex> lock(listsWriteMutex_);
+  return masterlistChanges_;
+}
+
 MasterlistInfo ApiDatabase::GetMasterlistRevision(
     const std::filesystem::path& masterlistPath,
     const bool getShortID) const {
-  return Masterlist::GetInfo(masterlistPath, getShortID);
+  return Masterlist::GetInfo(
+      masterlistPath, getShortID, &masterlistRevisionCache_);
 }
 
 bool ApiDatabase::IsLatestMasterlist(
     const std::filesystem::path& masterlist_path,
                                      const std::string& branch) const {
-  return Masterlist::IsLatest(masterlist_path, branch);
+  return Masterlist::IsLatest(
+      masterlist_path, branch, &masterlistRevisionCache_);
+}
+
+void ApiDatabase::SetMasterlistFetchInterval(std::chrono::seconds interval) {
+  masterlistRevisionCache_.SetFetchInterval(interval);
 }
 
 //////////////////////////
@@ -119,117 +294,213 @@ bool ApiDatabase::IsLatestMasterlist(
 //////////////////////////
 
 std::set<std::string> ApiDatabase::GetKnownBashTags() const {
-  auto masterlistTags = masterlist_.BashTags();
-  auto userlistTags = userlist_.BashTags();
-
-  if (!userlistTags.empty()) {
-    masterlistTags.insert(std::begin(userlistTags), std::end(userlistTags));
-  }
-
-  return masterlistTags;
+  return *GetKnownBashTagsView();
 }
 
 std::vector<Message> ApiDatabase::GetGeneralMessages(
     bool evaluateConditions) const {
-  auto masterlistMessages = masterlist_.Messages();
-  auto userlistMessages = userlist_.Messages();
-
-  if (!userlistMessages.empty()) {
-    masterlistMessages.insert(std::end(masterlistMessages),
-                              std::begin(userlistMessages),
-                              std::end(userlistMessages));
-  }
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  auto lists = GetLists();
+  uint64_t stateGeneration = 0;
 
   if (evaluateConditions) {
-    // Evaluate conditions from scratch.
-    conditionEvaluator_->ClearConditionCache();
-    for (auto it = std::begin(masterlistMessages);
-         it != std::end(masterlistMessages);) {
-      if (!conditionEvaluator_->Evaluate(it->GetCondition()))
-        it = masterlistMessages.erase(it);
-      else
-        ++it;
+    // Get the generation before evaluating so that results evaluated against
+    // a state that changes in the meantime are discarded by the next lookup.
+    stateGeneration = conditionEvaluator_->GetStateGeneration();
+
+    std::lock_guard<std::mutex> lock(evaluatedMetadataCacheMutex_);
+    if (evaluatedMetadataCache_.stateGeneration == stateGeneration &&
+        evaluatedMetadataCache_.lists == lists &&
+        evaluatedMetadataCache_.generalMessages) {
+      return evaluatedMetadataCache_.generalMessages.value();
     }
   }
 
-  return masterlistMessages;
-}
-
-std::unordered_set<Group> ApiDatabase::GetGroups(bool includeUserMetadata) const {
-  if (!includeUserMetadata) {
-    auto groups = masterlist_.Groups();
-
-    //Insert the default group in case the masterlist hasn't been loaded.
-    groups.insert(Group());
+  auto messages = lists->masterlist->Messages();
+  auto userlistMessages = lists->userlist->Messages();
 
-    return groups;
+  if (!userlistMessages.empty()) {
+    messages.insert(std::end(messages),
+                    std::make_move_iterator(std::begin(userlistMessages)),
+                    std::make_move_iterator(std::end(userlistMessages)));
   }
 
-  std::unordered_set<Group> mergedGroups;
-
-  auto userlistGroups = userlist_.Groups();
-  for (const auto& group : masterlist_.Groups()) {
-    auto userlistGroup = userlistGroups.find(group.GetName());
-    if (userlistGroup != userlistGroups.end()) {
-      auto afterGroups = group.GetAfterGroups();
-      auto userlistAfterGroups = userlistGroup->GetAfterGroups();
-
-      afterGroups.insert(userlistAfterGroups.begin(), userlistAfterGroups.end());
-      mergedGroups.insert(Group(group.GetName(), afterGroups));
-    } else {
-      mergedGroups.insert(group);
+  if (evaluateConditions) {
+    // Cached condition results are discarded when the state that they
+    // depend on is refreshed, so they can be reused here.
+    messages.erase(std::remove_if(std::begin(messages),
+                                  std::end(messages),
+                                  [&](const Message& message) {
+                                    return !conditionEvaluator_->Evaluate(
+                                        message.GetCondition());
+                                  }),
+                   std::end(messages));
+
+    std::lock_guard<std::mutex> lock(evaluatedMetadataCacheMutex_);
+    if (evaluatedMetadataCache_.stateGeneration != stateGeneration ||
+        evaluatedMetadataCache_.lists != lists) {
+      evaluatedMetadataCache_ = EvaluatedMetadataCache();
+      evaluatedMetadataCache_.stateGeneration = stateGeneration;
+      evaluatedMetadataCache_.lists = lists;
     }
+    evaluatedMetadataCache_.generalMessages = messages;
   }
-  mergedGroups.insert(userlistGroups.begin(), userlistGroups.end());
 
-  // Insert the default group if it's not already present.
-  mergedGroups.insert(Group());
+  return messages;
+}
 
-  return mergedGroups;
+std::unordered_set<Group> ApiDatabase::GetGroups(bool includeUserMetadata) const {
+  return *GetGroupsView(includeUserMetadata);
 }
 
 std::unordered_set<Group> ApiDatabase::GetUserGroups() const {
-  return userlist_.Groups();
+  return *GetUserGroupsView();
 }
 
 void ApiDatabase::SetUserGroups(const std::unordered_set<Group>& groups) {
-  userlist_.SetGroups(groups);
+  UpdateUserlist([&](MetadataList& userlist) { userlist.SetGroups(groups); });
 }
 
 
 std::vector<Vertex> ApiDatabase::GetGroupsPath(const std::string& fromGroupName,
   const std::string& toGroupName) const {
-  auto masterlistGroups = GetGroups(false);
-  auto userGroups = GetUserGroups();
+  auto lists = GetLists();
+
+  std::shared_ptr<const GroupPaths> groupPaths;
+  {
+    std::lock_guard<std::mutex> lock(groupPathsMutex_);
+    if (groupPathsLists_ != lists) {
+      groupPaths_ = std::make_shared<const GroupPaths>(*GetGroupsView(false),
+                                                       *GetUserGroupsView());
+      groupPathsLists_ = lists;
+    }
+    groupPaths = groupPaths_;
+  }
 
-  return loot::GetGroupsPath(masterlistGroups, userGroups, fromGroupName, toGroupName);
+  return groupPaths->GetPath(fromGroupName, toGroupName);
 }
 
 std::optional<PluginMetadata> ApiDatabase::GetPluginMetadata(const std::string& plugin,
                                               bool includeUserMetadata,
                                               bool evaluateConditions) const {
-  auto metadata = masterlist_.FindPlugin(plugin);
+  return GetPluginMetadataBatch(
+             {plugin}, includeUserMetadata, evaluateConditions)
+      .front();
+}
+
+std::vector<std::optional<PluginMetadata>> ApiDatabase::GetPluginMetadataBatch(
+    const std::vector<std::string>& plugins,
+    bool includeUserMetadata,
+    bool evaluateConditions) const {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  std::vector<std::optional<PluginMetadata>> results(plugins.size());
+
+  // The plugins that weren't found in the evaluated metadata cache, and their
+  // indices in the given vector.
+  std::vector<std::string> lookupNames;
+  std::vector<size_t> lookupIndices;
+  std::vector<std::string> cacheKeys;
+  uint64_t stateGeneration = 0;
+
+  // Use the same snapshot throughout, even if the lists are replaced
+  // concurrently.
+  auto lists = GetLists();
+
+  if (evaluateConditions) {
+    cacheKeys.reserve(plugins.size());
+    for (const auto& plugin : plugins) {
+      cacheKeys.push_back(NormalizeFilename(plugin));
+    }
+
+    // Get the generation before evaluating so that results evaluated against
+    // a state that changes in the meantime are discarded by the next lookup.
+    stateGeneration = conditionEvaluator_->GetStateGeneration();
+
+    std::lock_guard<std::mutex> lock(evaluatedMetadataCacheMutex_);
+    if (evaluatedMetadataCache_.stateGeneration != stateGeneration ||
+        evaluatedMetadataCache_.lists != lists) {
+      evaluatedMetadataCache_ = EvaluatedMetadataCache();
+      evaluatedMetadataCache_.stateGeneration = stateGeneration;
+      evaluatedMetadataCache_.lists = lists;
+    }
+
+    auto& cache = includeUserMetadata
+                      ? evaluatedMetadataCache_.withUserMetadata
+                      : evaluatedMetadataCache_.withoutUserMetadata;
+    for (size_t i = 0; i < plugins.size(); ++i) {
+      auto it = cache.find(cacheKeys[i]);
+      if (it != cache.end()) {
+        results[i] = it->second;
+      } else {
+        lookupNames.push_back(plugins[i]);
+        lookupIndices.push_back(i);
+      }
+    }
+
+    if (lookupNames.empty()) {
+      return results;
+    }
+  } else {
+    lookupNames = plugins;
+    for (size_t i = 0; i < plugins.size(); ++i) {
+      lookupIndices.push_back(i);
+    }
+  }
+
+  auto metadata = lists->masterlist->FindPlugins(lookupNames);
 
   if (includeUserMetadata) {
-    auto userMetadata = userlist_.FindPlugin(plugin);
-    if (metadata && userMetadata) {
-      metadata.value().MergeMetadata(userMetadata.value());
-    } else if (userMetadata) {
-      metadata = userMetadata;
+    auto userMetadata = lists->userlist->FindPlugins(lookupNames);
+    for (size_t i = 0; i < metadata.size(); ++i) {
+      if (metadata[i] && userMetadata[i]) {
+        metadata[i].value().MergeMetadata(userMetadata[i].value());
+      } else if (userMetadata[i]) {
+        metadata[i] = std::move(userMetadata[i]);
+      }
     }
   }
 
-  if (evaluateConditions && metadata) {
-    return conditionEvaluator_->EvaluateAll(metadata.value());
+  if (evaluateConditions) {
+    // Evaluate all the plugins' conditions as one batch.
+    std::vector<PluginMetadata> unevaluated;
+    for (const auto& pluginMetadata : metadata) {
+      if (pluginMetadata) {
+        unevaluated.push_back(pluginMetadata.value());
+      }
+    }
+
+    auto evaluated = conditionEvaluator_->EvaluateAll(unevaluated);
+
+    auto evaluatedIt = evaluated.begin();
+    for (auto& pluginMetadata : metadata) {
+      if (pluginMetadata) {
+        pluginMetadata = std::move(*evaluatedIt++);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(evaluatedMetadataCacheMutex_);
+    if (evaluatedMetadataCache_.stateGeneration == stateGeneration &&
+        evaluatedMetadataCache_.lists == lists) {
+      auto& cache = includeUserMetadata
+                        ? evaluatedMetadataCache_.withUserMetadata
+                        : evaluatedMetadataCache_.withoutUserMetadata;
+      for (size_t i = 0; i < metadata.size(); ++i) {
+        cache.emplace(cacheKeys[lookupIndices[i]], metadata[i]);
+      }
+    }
   }
 
-  return metadata;
+  for (size_t i = 0; i < metadata.size(); ++i) {
+    results[lookupIndices[i]] = std::move(metadata[i]);
+  }
+
+  return results;
 }
 
 std::optional<PluginMetadata> ApiDatabase::GetPluginUserMetadata(
     const std::string& plugin,
     bool evaluateConditions) const {
-  auto metadata = userlist_.FindPlugin(plugin);
+  auto metadata = GetLists()->userlist->FindPlugin(plugin);
 
   if (evaluateConditions && metadata) {
     return conditionEvaluator_->EvaluateAll(metadata.value());
@@ -238,16 +509,74 @@ std::optional<PluginMetadata> ApiDatabase::GetPluginUserMetadata(
   return metadata;
 }
 
+std::vector<std::optional<PluginMetadata>>
+ApiDatabase::GetPluginUserMetadataBatch(const std::vector<std::string>& plugins,
+                                        bool evaluateConditions) const {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  auto metadata = GetLists()->userlist->FindPlugins(plugins);
+
+  if (evaluateConditions) {
+    // Evaluate all the plugins' conditions as one batch.
+    std::vector<PluginMetadata> unevaluated;
+    for (const auto& pluginMetadata : metadata) {
+      if (pluginMetadata) {
+        unevaluated.push_back(pluginMetadata.value());
+      }
+    }
+
+    if (!unevaluated.empty()) {
+      auto evaluated = conditionEvaluator_->EvaluateAll(unevaluated);
+
+      auto evaluatedIt = evaluated.begin();
+      for (auto& pluginMetadata : metadata) {
+        if (pluginMetadata) {
+          pluginMetadata = std::move(*evaluatedIt++);
+        }
+      }
+    }
+  }
+
+  return metadata;
+}
+
 void ApiDatabase::SetPluginUserMetadata(const PluginMetadata& pluginMetadata) {
-  userlist_.ErasePlugin(pluginMetadata.GetName());
-  userlist_.AddPlugin(pluginMetadata);
+  UpdateUserlist([&](MetadataList& userlist) {
+    userlist.ErasePlugin(pluginMetadata.GetName());
+    userlist.AddPlugin(pluginMetadata);
+  });
 }
 
 void ApiDatabase::DiscardPluginUserMetadata(const std::string& plugin) {
-  userlist_.ErasePlugin(plugin);
+  UpdateUserlist(
+      [&](MetadataList& userlist) { userlist.ErasePlugin(plugin); });
 }
 
-void ApiDatabase::DiscardAllUserMetadata() { userlist_.Clear(); }
+void ApiDatabase::DiscardAllUserMetadata() {
+  UpdateUserlist([](MetadataList& userlist) { userlist.Clear(); });
+}
+
+void ApiDatabase::ApplyUserMetadataChanges(const UserMetadataChanges& changes) {
+  TraceScope traceScope("ApplyUserMetadataChanges", "metadata");
+  if (changes.discarded_plugins.empty() && changes.plugins.empty() &&
+      !changes.groups.has_value()) {
+    return;
+  }
+
+  UpdateUserlist([&](MetadataList& userlist) {
+    for (const auto& plugin : changes.discarded_plugins) {
+      userlist.ErasePlugin(plugin);
+    }
+
+    for (const auto& pluginMetadata : changes.plugins) {
+      userlist.ErasePlugin(pluginMetadata.GetName());
+      userlist.AddPlugin(pluginMetadata);
+    }
+
+    if (changes.groups.has_value()) {
+      userlist.SetGroups(changes.groups.value());
+    }
+  });
+}
 
 // Writes a minimal masterlist that only contains mods that have Bash Tag
 // suggestions, and/or dirty messages, plus the Tag suggestions and/or messages
@@ -263,15 +592,262 @@ void ApiDatabase::WriteMinimalList(const std::filesystem::path& outputFile,
     throw FileAccessError(
         "Output file exists but overwrite is not set to true.");
 
-  MetadataList minimalList;
-  for (const auto& plugin : masterlist_.Plugins()) {
+  std::ofstream out(outputFile);
+  if (out.fail())
+    throw FileAccessError("Couldn't open output file.");
+
+  // Write each minimal entry as it is created, rather than building a whole
+  // minimal list first.
+  YAML::Emitter emitter(out);
+  emitter.SetIndent(2);
+  emitter << YAML::BeginMap;
+
+  auto masterlist = GetLists()->masterlist;
+  bool hasPlugins = false;
+  masterlist->ForEachPluginInFilenameOrder([&](const PluginMetadata& plugin) {
+    if (!hasPlugins) {
+      emitter << YAML::Key << "plugins" << YAML::Value << YAML::BeginSeq;
+      hasPlugins = true;
+    }
+
     PluginMetadata minimalPlugin(plugin.GetName());
     minimalPlugin.SetTags(plugin.GetTags());
     minimalPlugin.SetDirtyInfo(plugin.GetDirtyInfo());
 
-    minimalList.AddPlugin(minimalPlugin);
+    emitter << minimalPlugin;
+  });
+
+  if (hasPlugins)
+    emitter << YAML::EndSeq;
+
+  emitter << YAML::EndMap;
+}
+
+void ApiDatabase::SetUpdatedMasterlist(
+    std::shared_ptr<const Masterlist> masterlist) {
+  std::lock_guard<std::mutex> lock(listsWriteMutex_);
+  auto lists = GetLists();
+
+  masterlistChanges_ = GetChanges(*lists->masterlist, *masterlist);
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->debug(
+        "The masterlist update changed {} plugin entries and {} groups.",
+        masterlistChanges_.plugins.size(),
+        masterlistChanges_.groups.size());
   }
 
-  minimalList.Save(outputFile);
+  SetLists(std::make_shared<Lists>(Lists{masterlist, lists->userlist}));
+}
+
+std::optional<ApiDatabase::MasterlistPrefetch>
+ApiDatabase::TakeMasterlistPrefetch(
+    const std::filesystem::path& masterlistPath) {
+  std::lock_guard<std::mutex> lock(masterlistPrefetchMutex_);
+  if (!masterlistPrefetch_ ||
+      masterlistPrefetch_->path !=
+          std::filesystem::absolute(masterlistPath).lexically_normal()) {
+    return std::nullopt;
+  }
+
+  std::optional<MasterlistPrefetch> prefetch;
+  prefetch.swap(masterlistPrefetch_);
+  return prefetch;
+}
+
+std::shared_ptr<const ApiDatabase::Lists> ApiDatabase::GetLists() const {
+  return std::atomic_load(&lists_);
+}
+
+void ApiDatabase::SetLists(std::shared_ptr<const Lists> lists) {
+  std::atomic_store(&lists_, std::move(lists));
+
+  ClearEvaluatedMetadataCache();
+
+  std::lock_guard<std::mutex> lock(listsViewsMutex_);
+  listsViews_ = ListsViews();
+}
+
+void ApiDatabase::UpdateUserlist(
+    const std::function<void(MetadataList&)>& modify) {
+  std::lock_guard<std::mutex> lock(listsWriteMutex_);
+  auto lists = GetLists();
+
+  auto userlist = std::make_shared<MetadataList>(*lists->userlist);
+  modify(*userlist);
+
+  SetLists(std::make_shared<Lists>(Lists{lists->masterlist, userlist}));
+}
+
+void ApiDatabase::AddMemoryUsage(MemoryUsage& usage) const {
+  auto lists = GetLists();
+  usage.masterlist += lists->masterlist->GetMemoryUsage();
+  usage.userlist += lists->userlist->GetMemoryUsage();
+
+  const auto estimateMetadata =
+      [](const std::optional<PluginMetadata>& metadata) {
+        return EstimateHeapSize(metadata);
+      };
+
+  std::lock_guard<std::mutex> lock(evaluatedMetadataCacheMutex_);
+  usage.conditionCache +=
+      EstimateHeapSize(evaluatedMetadataCache_.withUserMetadata,
+                       estimateMetadata) +
+      EstimateHeapSize(evaluatedMetadataCache_.withoutUserMetadata,
+                       estimateMetadata) +
+      EstimateHeapSize(evaluatedMetadataCache_.generalMessages);
+}
+
+std::shared_ptr<const std::unordered_set<Group>> ApiDatabase::GetGroupsView(
+    bool includeUserMetadata) const {
+  auto lists = GetLists();
+
+  std::lock_guard<std::mutex> lock(listsViewsMutex_);
+  auto& views = GetListsViews(lists);
+  if (!includeUserMetadata) {
+    if (!views.masterlistGroups) {
+      auto groups = lists->masterlist->GroupsRef();
+
+      // Insert the default group in case the masterlist hasn't been loaded.
+      groups.insert(Group());
+
+      views.masterlistGroups =
+          std::make_shared<const std::unordered_set<Group>>(std::move(groups));
+    }
+
+    return views.masterlistGroups;
+  }
+
+  if (!views.mergedGroups) {
+    std::unordered_set<Group> mergedGroups;
+
+    const auto& userlistGroups = lists->userlist->GroupsRef();
+    for (const auto& group : lists->masterlist->GroupsRef()) {
+      auto userlistGroup = userlistGroups.find(group.GetName());
+      if (userlistGroup != userlistGroups.end()) {
+        auto afterGroups = group.GetAfterGroups();
+        auto userlistAfterGroups = userlistGroup->GetAfterGroups();
+
+        afterGroups.insert(userlistAfterGroups.begin(),
+                           userlistAfterGroups.end());
+        mergedGroups.insert(Group(group.GetName(), afterGroups));
+      } else {
+        mergedGroups.insert(group);
+      }
+    }
+    mergedGroups.insert(userlistGroups.begin(), userlistGroups.end());
+
+    // Insert the default group if it's not already present.
+    mergedGroups.insert(Group());
+
+    views.mergedGroups = std::make_shared<const std::unordered_set<Group>>(
+        std::move(mergedGroups));
+  }
+
+  return views.mergedGroups;
+}
+
+std::shared_ptr<const std::unordered_set<Group>>
+ApiDatabase::GetUserGroupsView() const {
+  auto lists = GetLists();
+
+  std::lock_guard<std::mutex> lock(listsViewsMutex_);
+  auto& views = GetListsViews(lists);
+  if (!views.userGroups) {
+    views.userGroups = std::make_shared<const std::unordered_set<Group>>(
+        lists->userlist->GroupsRef());
+  }
+
+  return views.userGroups;
+}
+
+std::shared_ptr<const std::set<std::string>>
+ApiDatabase::GetKnownBashTagsView() const {
+  auto lists = GetLists();
+
+  std::lock_guard<std::mutex> lock(listsViewsMutex_);
+  auto& views = GetListsViews(lists);
+  if (!views.knownBashTags) {
+    const auto& masterlistTags = lists->masterlist->BashTagsRef();
+    const auto& userlistTags = lists->userlist->BashTagsRef();
+
+    // Both sets are sorted, so merge them in one pass instead of inserting
+    // each userlist tag separately.
+    std::set<std::string> tags;
+    std::set_union(std::begin(masterlistTags),
+                   std::end(masterlistTags),
+                   std::begin(userlistTags),
+                   std::end(userlistTags),
+                   std::inserter(tags, tags.end()));
+
+    views.knownBashTags =
+        std::make_shared<const std::set<std::string>>(std::move(tags));
+  }
+
+  return views.knownBashTags;
+}
+
+void ApiDatabase::PrecomputePluginConditions(const std::string& plugin) const {
+  auto lists = GetLists();
+
+  auto masterlistMetadata = lists->masterlist->FindPlugin(plugin);
+  if (masterlistMetadata) {
+    conditionEvaluator_->PrecomputeConditions(masterlistMetadata.value());
+  }
+
+  auto userMetadata = lists->userlist->FindPlugin(plugin);
+  if (userMetadata) {
+    conditionEvaluator_->PrecomputeConditions(userMetadata.value());
+  }
+}
+
+ApiDatabase::ListsViews& ApiDatabase::GetListsViews(
+    const std::shared_ptr<const Lists>& lists) const {
+  if (listsViews_.lists != lists) {
+    listsViews_ = ListsViews();
+    listsViews_.lists = lists;
+  }
+
+  return listsViews_;
+}
+
+void ApiDatabase::SetSavedUserlist(
+    const std::filesystem::path& path,
+    std::shared_ptr<const MetadataList> userlist) const {
+  std::lock_guard<std::mutex> lock(savedUserlistMutex_);
+  savedUserlistPath_ = path.empty()
+                           ? path
+                           : std::filesystem::absolute(path).lexically_normal();
+  savedUserlist_ = std::move(userlist);
+}
+
+void ApiDatabase::SetThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+  std::atomic_store(&threadPool_, std::move(threadPool));
+}
+
+void ApiDatabase::TrimCaches() {
+  ClearEvaluatedMetadataCache();
+  {
+    // The cache's lists snapshot may keep replaced lists alive.
+    std::lock_guard<std::mutex> lock(evaluatedMetadataCacheMutex_);
+    evaluatedMetadataCache_.lists.reset();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(listsViewsMutex_);
+    listsViews_ = ListsViews();
+  }
+
+  std::lock_guard<std::mutex> lock(groupPathsMutex_);
+  groupPaths_.reset();
+  groupPathsLists_.reset();
+}
+
+void ApiDatabase::ClearEvaluatedMetadataCache() {
+  std::lock_guard<std::mutex> lock(evaluatedMetadataCacheMutex_);
+  evaluatedMetadataCache_.withUserMetadata.clear();
+  evaluatedMetadataCache_.withoutUserMetadata.clear();
+  evaluatedMetadataCache_.generalMessages.reset();
 }
 }
@@ -25,29 +25,47 @@
 #ifndef LOOT_API_LOOT_DB
 #define LOOT_API_LOOT_DB
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "api/game/game_cache.h"
 #include "api/game/load_order_handler.h"
 #include "api/masterlist.h"
+#include "api/masterlist_revision_cache.h"
 #include "api/metadata/condition_evaluator.h"
 #include "api/metadata_list.h"
 #include "loot/database_interface.h"
 #include "loot/enum/game_type.h"
+#include "loot/struct/memory_usage.h"
 #include "loot/vertex.h"
 
 namespace loot {
+class GroupPaths;
+class ThreadPool;
+
 struct ApiDatabase : public DatabaseInterface {
   ApiDatabase(std::shared_ptr<ConditionEvaluator> conditionEvaluator);
 
   void LoadLists(const std::filesystem::path& masterlist_path,
                  const std::filesystem::path& userlist_path = "");
 
+  void SetMasterlistCachePath(const std::filesystem::path& cachePath);
+
   void WriteUserMetadata(const std::filesystem::path& outputFile,
                          const bool overwrite) const;
 
+  std::future<bool> SaveUserMetadataAsync(
+      const std::filesystem::path& outputFile) const;
+
   void WriteMinimalList(const std::filesystem::path& outputFile,
                         const bool overwrite) const;
 
@@ -55,6 +73,12 @@ struct ApiDatabase : public DatabaseInterface {
                         const std::string& remote_url,
                         const std::string& remote_branch);
 
+  void PrefetchMasterlist(const std::filesystem::path& masterlist_path,
+                          const std::string& remote_url,
+                          const std::string& remote_branch);
+
+  MasterlistChanges GetMasterlistChanges() const;
+
   MasterlistInfo GetMasterlistRevision(
       const std::filesystem::path& masterlist_path,
       const bool get_short_id) const;
@@ -62,6 +86,8 @@ struct ApiDatabase : public DatabaseInterface {
   bool IsLatestMasterlist(const std::filesystem::path& masterlist_path,
                           const std::string& branch) const;
 
+  void SetMasterlistFetchInterval(std::chrono::seconds interval);
+
   std::set<std::string> GetKnownBashTags() const;
 
   std::vector<Message> GetGeneralMessages(
@@ -78,20 +104,158 @@ struct ApiDatabase : public DatabaseInterface {
       bool includeUserMetadata = true,
       bool evaluateConditions = false) const;
 
+  std::vector<std::optional<PluginMetadata>> GetPluginMetadataBatch(
+      const std::vector<std::string>& plugins,
+      bool includeUserMetadata = true,
+      bool evaluateConditions = false) const;
+
   std::optional<PluginMetadata> GetPluginUserMetadata(
       const std::string& plugin,
       bool evaluateConditions = false) const;
 
+  std::vector<std::optional<PluginMetadata>> GetPluginUserMetadataBatch(
+      const std::vector<std::string>& plugins,
+      bool evaluateConditions = false) const;
+
   void SetPluginUserMetadata(const PluginMetadata& pluginMetadata);
 
   void DiscardPluginUserMetadata(const std::string& plugin);
 
   void DiscardAllUserMetadata();
 
+  void ApplyUserMetadataChanges(const UserMetadataChanges& changes);
+
+  // Adds estimates of the memory used by the loaded lists and the cached
+  // evaluated metadata to the given usage.
+  void AddMemoryUsage(MemoryUsage& usage) const;
+  // Discards the cached evaluated metadata and group graph, which are rebuilt
+  // when they're next needed.
+  void TrimCaches();
+
+  // Like GetGroups(), GetUserGroups() and GetKnownBashTags(), but return the
+  // views cached for the current lists instead of copies. The cached views
+  // are rebuilt when they're next needed after the lists change.
+  std::shared_ptr<const std::unordered_set<Group>> GetGroupsView(
+      bool includeUserMetadata = true) const;
+  std::shared_ptr<const std::unordered_set<Group>> GetUserGroupsView() const;
+  std::shared_ptr<const std::set<std::string>> GetKnownBashTagsView() const;
+
+  // Evaluates the conditions in the plugin's masterlist and user metadata that
+  // don't depend on other plugins being loaded, so that they're cached by the
+  // time the plugin's metadata is evaluated. Used while plugins are loading.
+  void PrecomputePluginConditions(const std::string& plugin) const;
+
+  // Sets the pool that the database's parallel work runs on. A null pool
+  // makes it use the current pool.
+  void SetThreadPool(std::shared_ptr<ThreadPool> threadPool);
+
 private:
+  // The loaded metadata lists. A snapshot is never modified once it has been
+  // published: changes are made by building a new snapshot and swapping it in,
+  // so readers on other threads can keep using the snapshot they started with
+  // instead of waiting for lists to be loaded.
+  struct Lists {
+    std::shared_ptr<const Masterlist> masterlist;
+    std::shared_ptr<const MetadataList> userlist;
+  };
+
+  // Caches the results of GetPluginMetadata() and GetGeneralMessages() with
+  // evaluateConditions set to true, with plugin metadata keyed by normalized
+  // plugin name. The cache is cleared when the metadata changes or when the
+  // condition evaluator's state generation or the lists snapshot differ from
+  // the ones the results were evaluated with.
+  struct EvaluatedMetadataCache {
+    uint64_t stateGeneration = 0;
+    std::shared_ptr<const Lists> lists;
+    std::unordered_map<std::string, std::optional<PluginMetadata>>
+        withUserMetadata;
+    std::unordered_map<std::string, std::optional<PluginMetadata>>
+        withoutUserMetadata;
+    std::optional<std::vector<Message>> generalMessages;
+  };
+
+  // Views of the lists snapshot that merge or copy its metadata, each built
+  // the first time it's needed for the snapshot.
+  struct ListsViews {
+    std::shared_ptr<const Lists> lists;
+    std::shared_ptr<const std::unordered_set<Group>> masterlistGroups;
+    std::shared_ptr<const std::unordered_set<Group>> userGroups;
+    std::shared_ptr<const std::unordered_set<Group>> mergedGroups;
+    std::shared_ptr<const std::set<std::string>> knownBashTags;
+  };
+
+  // A masterlist update started by PrefetchMasterlist(), with its path made
+  // absolute.
+  struct MasterlistPrefetch {
+    struct Result {
+      bool wasUpdated;
+      std::shared_ptr<const Masterlist> masterlist;
+    };
+
+    std::filesystem::path path;
+    std::string remoteUrl;
+    std::string remoteBranch;
+    std::shared_future<Result> result;
+  };
+
+  // Removes and returns the masterlist prefetch if it is for the given path.
+  std::optional<MasterlistPrefetch> TakeMasterlistPrefetch(
+      const std::filesystem::path& masterlistPath);
+
+  std::shared_ptr<const Lists> GetLists() const;
+  void SetLists(std::shared_ptr<const Lists> lists);
+  // Replaces the masterlist with the given updated masterlist, recording how
+  // it differs from the masterlist it replaces.
+  void SetUpdatedMasterlist(std::shared_ptr<const Masterlist> masterlist);
+  // Replaces the userlist with a modified copy of the current userlist.
+  void UpdateUserlist(const std::function<void(MetadataList&)>& modify);
+
+  void ClearEvaluatedMetadataCache();
+  // Records that the given userlist is the content of the given file, so that
+  // saving it to the file again can be skipped.
+  void SetSavedUserlist(const std::filesystem::path& path,
+                        std::shared_ptr<const MetadataList> userlist) const;
+  // Gets the views for the given lists snapshot, discarding the views of any
+  // other snapshot. Must be called with listsViewsMutex_ held.
+  ListsViews& GetListsViews(const std::shared_ptr<const Lists>& lists) const;
+
   std::shared_ptr<ConditionEvaluator> conditionEvaluator_;
-  Masterlist masterlist_;
-  MetadataList userlist_;
+  std::filesystem::path masterlistCachePath_;
+  // Only accessed through std::atomic_load() and std::atomic_store().
+  std::shared_ptr<ThreadPool> threadPool_;
+  // Only accessed through std::atomic_load() and std::atomic_store().
+  std::shared_ptr<const Lists> lists_;
+  // Serialises changes to the lists so that concurrent writers can't lose
+  // each other's changes. Readers don't lock it.
+  mutable std::mutex listsWriteMutex_;
+  mutable MasterlistRevisionCache masterlistRevisionCache_;
+  // Guarded by listsWriteMutex_.
+  MasterlistChanges masterlistChanges_;
+
+  mutable EvaluatedMetadataCache evaluatedMetadataCache_;
+  mutable std::mutex evaluatedMetadataCacheMutex_;
+
+  // The userlist that was last loaded from or saved to a file, and that
+  // file's absolute path.
+  mutable std::filesystem::path savedUserlistPath_;
+  mutable std::shared_ptr<const MetadataList> savedUserlist_;
+  mutable std::mutex savedUserlistMutex_;
+  // Held while saving the userlist, so that saves run one at a time.
+  mutable std::mutex userlistSaveMutex_;
+
+  mutable ListsViews listsViews_;
+  mutable std::mutex listsViewsMutex_;
+
+  // The group graph used by GetGroupsPath(), and the lists snapshot that it
+  // was built from.
+  mutable std::shared_ptr<const GroupPaths> groupPaths_;
+  mutable std::shared_ptr<const Lists> groupPathsLists_;
+  mutable std::mutex groupPathsMutex_;
+
+  // Declared last so that it's destroyed first: destroying the future of an
+  // unfinished prefetch waits for it, and it uses the other members.
+  std::mutex masterlistPrefetchMutex_;
+  std::optional<MasterlistPrefetch> masterlistPrefetch_;
 };
 }
 
@@ -0,0 +1,168 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/game/data_directory_snapshot.h"
+
+#include "api/helpers/logging.h"
+#include "api/helpers/text.h"
+
+namespace loot {
+DataDirectorySnapshot::DataDirectorySnapshot() {}
+
+DataDirectorySnapshot::DataDirectorySnapshot(
+    const std::filesystem::path& directory) :
+    directory_(directory) {
+  std::error_code errorCode;
+  std::filesystem::directory_iterator it(directory, errorCode);
+  if (errorCode) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->debug("Could not read the directory \"{}\": {}",
+                    directory.u8string(),
+                    errorCode.message());
+    }
+    return;
+  }
+
+  // Directory entries cache file attributes where the platform provides them
+  // while iterating, so this avoids a separate stat call per file on Windows.
+  for (; it != std::filesystem::directory_iterator(); it.increment(errorCode)) {
+    if (errorCode) {
+      break;
+    }
+
+    if (!it->is_regular_file(errorCode)) {
+      continue;
+    }
+
+    Entry entry;
+    entry.fileSize = it->file_size(errorCode);
+    if (errorCode) {
+      continue;
+    }
+    entry.modificationTime = it->last_write_time(errorCode);
+    if (errorCode) {
+      continue;
+    }
+
+    entry.path = it->path();
+    entry.filename = entry.path.filename().u8string();
+    entry.normalizedFilename = NormalizeFilename(entry.filename);
+
+    entryIndices_.emplace(GetLookupKey(entry.filename), entries_.size());
+    entries_.push_back(std::move(entry));
+  }
+}
+
+const std::vector<DataDirectorySnapshot::Entry>&
+DataDirectorySnapshot::GetEntries() const {
+  return entries_;
+}
+
+void DataDirectorySnapshot::Refresh(
+    const std::unordered_set<std::string>& filenames) {
+  if (filenames.empty()) {
+    return;
+  }
+
+  std::unordered_set<std::string> lookupKeys;
+  for (const auto& filename : filenames) {
+    lookupKeys.insert(GetLookupKey(filename));
+  }
+
+  // Drop the existing entries for the files, then add back any that still
+  // exist. The indices of the remaining entries change, so they're rebuilt.
+  std::vector<Entry> entries;
+  entries.reserve(entries_.size());
+  for (auto& entry : entries_) {
+    if (lookupKeys.count(GetLookupKey(entry.filename)) == 0) {
+      entries.push_back(std::move(entry));
+    }
+  }
+
+  for (const auto& filename : filenames) {
+    // Names that the filesystem considers equal only need reading once.
+    if (lookupKeys.erase(GetLookupKey(filename)) == 0) {
+      continue;
+    }
+
+    std::error_code errorCode;
+    auto path = directory_ / std::filesystem::u8path(filename);
+    if (!std::filesystem::is_regular_file(path, errorCode)) {
+      continue;
+    }
+
+    Entry entry;
+    entry.fileSize = std::filesystem::file_size(path, errorCode);
+    if (errorCode) {
+      continue;
+    }
+    entry.modificationTime = std::filesystem::last_write_time(path, errorCode);
+    if (errorCode) {
+      continue;
+    }
+
+    entry.path = path;
+    entry.filename = filename;
+    entry.normalizedFilename = NormalizeFilename(entry.filename);
+
+    entries.push_back(std::move(entry));
+  }
+
+  entries_ = std::move(entries);
+  entryIndices_.clear();
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    entryIndices_.emplace(GetLookupKey(entries_[i].filename), i);
+  }
+}
+
+const DataDirectorySnapshot::Entry* DataDirectorySnapshot::FindFile(
+    const std::string& filename) const {
+  auto it = entryIndices_.find(GetLookupKey(filename));
+  if (it == entryIndices_.end()) {
+    return nullptr;
+  }
+
+  return &entries_[it->second];
+}
+
+const DataDirectorySnapshot::Entry* DataDirectorySnapshot::FindPlugin(
+    const std::string& pluginName) const {
+  auto entry = FindFile(pluginName);
+  if (entry == nullptr) {
+    entry = FindFile(pluginName + ".ghost");
+  }
+
+  return entry;
+}
+
+std::string DataDirectorySnapshot::GetLookupKey(const std::string& filename) {
+#ifdef _WIN32
+  return NormalizeFilename(filename);
+#else
+  return filename;
+#endif
+}
+}
@@ -0,0 +1,87 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_GAME_DATA_DIRECTORY_SNAPSHOT
+#define LOOT_API_GAME_DATA_DIRECTORY_SNAPSHOT
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace loot {
+// A record of the files in a directory, read in a single pass over its
+// entries, so that checking for, sizing and comparing files doesn't need a
+// filesystem call for each check.
+//
+// Files are looked up by name in the same way as the filesystem would: on
+// Windows names are compared case-insensitively, elsewhere they must match
+// exactly. The snapshot isn't updated if the directory changes, unless the
+// changed files are passed to Refresh().
+class DataDirectorySnapshot {
+public:
+  struct Entry {
+    std::filesystem::path path;
+    std::string filename;
+    std::string normalizedFilename;
+    uintmax_t fileSize;
+    std::filesystem::file_time_type modificationTime;
+  };
+
+  DataDirectorySnapshot();
+  // Reads the given directory's regular files. If the directory doesn't exist,
+  // the snapshot is empty.
+  explicit DataDirectorySnapshot(const std::filesystem::path& directory);
+
+  const std::vector<Entry>& GetEntries() const;
+
+  // Reads the current state of the given files in the snapshot's directory,
+  // adding, updating or removing their entries, without reading the rest of
+  // the directory. Entry pointers previously obtained from the snapshot are
+  // invalidated.
+  void Refresh(const std::unordered_set<std::string>& filenames);
+
+  // Get the entry for the file with the given name, or a null pointer if
+  // there is no such file.
+  const Entry* FindFile(const std::string& filename) const;
+
+  // Get the entry for the given plugin, falling back to its ghosted filename
+  // if it is not found, or a null pointer if neither file exists.
+  const Entry* FindPlugin(const std::string& pluginName) const;
+
+  // Get the key that filenames are looked up by, which is the filename as
+  // the filesystem would compare it.
+  static std::string GetLookupKey(const std::string& filename);
+
+private:
+  std::filesystem::path directory_;
+  std::vector<Entry> entries_;
+  std::unordered_map<std::string, size_t> entryIndices_;
+};
+}
+
+#endif
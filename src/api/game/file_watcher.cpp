@@ -0,0 +1,152 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/game/file_watcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "api/helpers/logging.h"
+
+namespace loot {
+#ifdef __linux__
+FileWatcher::FileWatcher(
+    const std::vector<std::filesystem::path>& directories) :
+    inotifyFd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+  auto logger = getLogger();
+  if (inotifyFd_ == -1) {
+    if (logger) {
+      logger->warn("Could not start watching for file changes: {}",
+                   std::strerror(errno));
+    }
+    return;
+  }
+
+  for (const auto& directory : directories) {
+    int watchDescriptor = inotify_add_watch(
+        inotifyFd_,
+        directory.c_str(),
+        IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+            IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+            IN_ONLYDIR);
+    if (watchDescriptor == -1) {
+      if (logger) {
+        logger->debug("Could not watch the directory \"{}\": {}",
+                      directory.u8string(),
+                      std::strerror(errno));
+      }
+      continue;
+    }
+
+    watchedDirectories_.emplace(watchDescriptor, directory);
+  }
+}
+
+FileWatcher::~FileWatcher() {
+  if (inotifyFd_ != -1) {
+    close(inotifyFd_);
+  }
+}
+
+std::vector<FileWatcher::Change> FileWatcher::ReadChanges() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::vector<Change> changes;
+  if (inotifyFd_ == -1) {
+    return changes;
+  }
+
+  alignas(struct inotify_event) char buffer[4096];
+  while (true) {
+    auto length = read(inotifyFd_, buffer, sizeof(buffer));
+    if (length <= 0) {
+      // The queue is empty once the read would block.
+      break;
+    }
+
+    for (char* pointer = buffer; pointer < buffer + length;) {
+      auto event = reinterpret_cast<const struct inotify_event*>(pointer);
+      pointer += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events were dropped, so any watched directory may have changed.
+        for (const auto& watched : watchedDirectories_) {
+          changes.push_back({watched.second, ""});
+        }
+        continue;
+      }
+
+      auto it = watchedDirectories_.find(event->wd);
+      if (it == watchedDirectories_.end()) {
+        continue;
+      }
+
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        changes.push_back({it->second, ""});
+        inotify_rm_watch(inotifyFd_, event->wd);
+        watchedDirectories_.erase(it);
+        continue;
+      }
+
+      if (event->len > 0) {
+        changes.push_back({it->second, std::string(event->name)});
+      }
+    }
+  }
+
+  return changes;
+}
+#else
+FileWatcher::FileWatcher(const std::vector<std::filesystem::path>&) :
+    inotifyFd_(-1) {
+  auto logger = getLogger();
+  if (logger) {
+    logger->debug("Watching for file changes is not supported on this "
+                  "platform.");
+  }
+}
+
+FileWatcher::~FileWatcher() {}
+
+std::vector<FileWatcher::Change> FileWatcher::ReadChanges() { return {}; }
+#endif
+
+bool FileWatcher::IsWatching(const std::filesystem::path& directory) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (const auto& watched : watchedDirectories_) {
+    if (watched.second == directory) {
+      return true;
+    }
+  }
+
+  return false;
+}
+}
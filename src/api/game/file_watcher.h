@@ -0,0 +1,76 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_GAME_FILE_WATCHER
+#define LOOT_API_GAME_FILE_WATCHER
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace loot {
+// Records changes to the files in a set of directories (but not their
+// subdirectories) as they happen, so that callers can tell which files have
+// changed without comparing the directories' contents.
+//
+// Changes are queued by the operating system and read on demand, so a change
+// made before ReadChanges() is called is always included in its result.
+// Watching is currently only implemented on Linux, using inotify. On other
+// platforms no directories are watched.
+class FileWatcher {
+public:
+  struct Change {
+    std::filesystem::path directory;
+    // Empty if changes may have been missed, in which case any file in the
+    // directory may have changed.
+    std::string filename;
+  };
+
+  explicit FileWatcher(const std::vector<std::filesystem::path>& directories);
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  // Checks if changes to files in the given directory are being watched. A
+  // directory that doesn't exist can't be watched, and a directory stops being
+  // watched if it is deleted or moved.
+  bool IsWatching(const std::filesystem::path& directory) const;
+
+  // Get the changes made since the watcher was created or this was last
+  // called. A file may be given more than once.
+  std::vector<Change> ReadChanges();
+
+private:
+  mutable std::mutex mutex_;
+  int inotifyFd_;
+  // Maps watch descriptors to the directories they watch.
+  std::unordered_map<int, std::filesystem::path> watchedDirectories_;
+};
+}
+
+#endif
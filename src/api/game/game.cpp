@@ -25,15 +25,21 @@
 #include "api/game/game.h"
 
 #include <algorithm>
-#include <cmath>
-#include <thread>
-
-#include <boost/algorithm/string.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 #include "api/api_database.h"
+#include "api/game/shared_plugin_cache.h"
+#include "api/helpers/crc.h"
 #include "api/helpers/logging.h"
+#include "api/helpers/text.h"
+#include "api/helpers/thread_pool.h"
+#include "api/helpers/tracing.h"
+#include "api/sorting/overlap_matrix.h"
 #include "api/sorting/plugin_sorter.h"
 #include "loot/exception/file_access_error.h"
+#include "loot/exception/operation_cancelled_error.h"
 
 #ifdef _WIN32
 #ifndef UNICODE
@@ -50,130 +56,370 @@
 
 using std::list;
 using std::string;
-using std::thread;
 using std::vector;
 using std::filesystem::u8path;
 
 namespace loot {
+namespace {
+// Throws an std::invalid_argument naming the plugins at the given indices, if
+// there are any.
+void ThrowIfAnyInvalid(const std::vector<std::string>& plugins,
+                       std::vector<size_t> invalidPlugins) {
+  if (invalidPlugins.empty()) {
+    return;
+  }
+
+  // Report the invalid plugins in the order they were given, rather than
+  // the order they were loaded in.
+  std::sort(invalidPlugins.begin(), invalidPlugins.end());
+
+  std::string names;
+  for (auto index : invalidPlugins) {
+    if (!names.empty()) {
+      names += ", ";
+    }
+    names += "\"" + plugins[index] + "\"";
+  }
+
+  if (invalidPlugins.size() == 1) {
+    throw std::invalid_argument(names + " is not a valid plugin");
+  }
+  throw std::invalid_argument(names + " are not valid plugins");
+}
+}
+
 Game::Game(const GameType gameType,
            const std::filesystem::path& gamePath,
            const std::filesystem::path& localDataPath) :
+    cache_(std::make_shared<GameCache>()),
+    loadOrderHandler_(std::make_shared<LoadOrderHandler>()),
+    sorter_(std::make_shared<PluginSorter>()),
+    releaseRecordsAfterSort_(false),
     type_(gameType),
+    policy_(GetGamePolicy(gameType)),
     gamePath_(gamePath),
-    cache_(std::make_shared<GameCache>()),
-    loadOrderHandler_(std::make_shared<LoadOrderHandler>()) {
-  auto logger = getLogger();
-  if (logger) {
-    logger->info("Initialising load order data for game of type {} at: {}",
-                 (int)type_,
-                 gamePath_.u8string());
+    localDataPath_(localDataPath),
+    canWatchLoadOrderState_(false),
+    hasLoadedLoadOrderState_(false),
+    isLoadOrderStateStale_(false),
+    isDataDirectorySnapshotCurrent_(false),
+    memoryResource_(nullptr) {
+  // libloadorder is only initialised when the load order is first needed, so
+  // that handles that are only used to validate plugins or look up metadata
+  // are cheap to create. The given path is still checked here so that an
+  // invalid path is reported as soon as possible.
+  if (gamePath_.empty()) {
+    throw std::invalid_argument("Game path is not initialised.");
   }
 
-  loadOrderHandler_->Init(type_, gamePath_, localDataPath);
-
   conditionEvaluator_ =
       std::make_shared<ConditionEvaluator>(Type(), DataPath());
-
-  database_ = std::make_shared<ApiDatabase>(conditionEvaluator_);
 }
 
+Game::~Game() { SavePersistentCache(); }
+
 GameType Game::Type() const { return type_; }
 
 std::filesystem::path Game::DataPath() const {
-  if (type_ == GameType::tes3) {
-    return gamePath_ / "Data Files";
-  } else {
-    return gamePath_ / "Data";
-  }
+  return gamePath_ / policy_.dataDirectoryName;
 }
 
 std::shared_ptr<GameCache> Game::GetCache() { return cache_; }
 
-std::shared_ptr<LoadOrderHandler> Game::GetLoadOrderHandler() {
+std::shared_ptr<LoadOrderHandler> Game::GetLoadOrderHandler() const {
+  // If initialisation throws, it's tried again the next time.
+  std::call_once(loadOrderHandlerInitFlag_, [this]() {
+    auto logger = getLogger();
+    if (logger) {
+      logger->info("Initialising load order data for game of type {} at: {}",
+                   (int)type_,
+                   gamePath_.u8string());
+    }
+
+    loadOrderHandler_->Init(type_, gamePath_, localDataPath_);
+  });
+
   return loadOrderHandler_;
 }
 
-std::shared_ptr<DatabaseInterface> Game::GetDatabase() { return database_; }
+const DataDirectorySnapshot& Game::GetDataDirectorySnapshot() const {
+  return dataDirectorySnapshot_;
+}
+
+std::shared_ptr<DatabaseInterface> Game::GetDatabase() {
+  return GetApiDatabase();
+}
+
+void Game::SetConditionProfilingEnabled(bool enabled) {
+  conditionEvaluator_->SetProfilingEnabled(enabled);
+}
+
+std::vector<ConditionStatistics> Game::GetConditionStatistics(
+    size_t maxConditions) const {
+  return conditionEvaluator_->GetProfile(maxConditions);
+}
 
 bool Game::IsValidPlugin(const std::string& plugin) const {
   return Plugin::IsValid(Type(), DataPath() / u8path(plugin));
 }
 
+std::vector<std::shared_ptr<const PluginInterface>> Game::FilterValidPlugins(
+    const std::vector<std::string>& plugins) {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  auto logger = getLogger();
+
+  UpdateDataDirectorySnapshot();
+
+  // The plugins are loaded with their own cache of archive paths, because
+  // replacing the main cache's archive paths would stop LoadPlugins() from
+  // detecting that they have changed since the loaded plugins were loaded.
+  // Plugins loaded header-only don't use the cache for anything else.
+  auto validationCache = std::make_shared<GameCache>();
+  validationCache->SetMemoryResource(memoryResource_);
+  CacheArchives(*validationCache);
+  const pmr::polymorphic_allocator<Plugin> allocator(
+      validationCache->GetMemoryResource());
+
+  std::vector<std::shared_ptr<const Plugin>> loadedPlugins(plugins.size());
+  auto validatePlugins = [&](size_t start, size_t end) {
+    // Queue the reads of all the chunk's headers before parsing any of them.
+    for (size_t i = start; i < end; ++i) {
+      auto entry = dataDirectorySnapshot_.FindPlugin(plugins[i]);
+      if (entry != nullptr && policy_.HasPluginFileExtension(plugins[i])) {
+        Plugin::PrefetchHeader(entry->path);
+      }
+    }
+
+    for (size_t i = start; i < end; ++i) {
+      const auto& plugin = plugins[i];
+      auto entry = dataDirectorySnapshot_.FindPlugin(plugin);
+      if (entry != nullptr && policy_.HasPluginFileExtension(plugin)) {
+        try {
+          loadedPlugins[i] =
+              std::allocate_shared<Plugin>(allocator,
+                                           Type(),
+                                           validationCache,
+                                           entry->path,
+                                           entry->fileSize,
+                                           entry->modificationTime,
+                                           true);
+          continue;
+        } catch (std::exception&) {
+          // The plugin is invalid, which is logged below.
+        }
+      }
+
+      if (logger) {
+        logger->info("The file \"{}\" is not a valid plugin.", plugin);
+      }
+    }
+  };
+
+  // Validating a plugin opens and parses its file's header, which costs much
+  // more than the in-memory work that other callers split up, so fewer
+  // plugins are enough to outweigh the cost of using the thread pool.
+  static constexpr size_t MIN_PARALLEL_PLUGINS = 16;
+
+  ThreadPool::GetCurrent()->RunInChunks(
+      plugins.size(), MIN_PARALLEL_PLUGINS, validatePlugins);
+
+  std::vector<std::shared_ptr<const PluginInterface>> validPlugins;
+  std::vector<std::shared_ptr<const Plugin>> validatedPlugins;
+  for (const auto& plugin : loadedPlugins) {
+    if (plugin) {
+      validPlugins.push_back(plugin);
+      validatedPlugins.push_back(plugin);
+    }
+  }
+
+  cache_->SetValidatedPlugins(validatedPlugins,
+                              validationCache->GetArchivePaths());
+
+  return validPlugins;
+}
+
+void Game::SetPluginCachePath(const std::filesystem::path& cachePath) {
+  pluginCachePath_ = cachePath;
+
+  if (!pluginCachePath_.empty()) {
+    cache_->GetPersistentCache().Load(pluginCachePath_);
+  }
+}
+
 void Game::LoadPlugins(const std::vector<std::string>& plugins,
                        bool loadHeadersOnly) {
-  auto logger = getLogger();
-  uintmax_t meanFileSize = 0;
-  std::multimap<uintmax_t, string> sizeMap;
+  LoadPlugins(
+      plugins, loadHeadersOnly, CancellationToken(), ProgressCallback());
+}
 
-  // First get the plugin sizes.
-  for (const auto& plugin : plugins) {
-    if (!IsValidPlugin(plugin))
-      throw std::invalid_argument("\"" + plugin + "\" is not a valid plugin");
+std::future<void> Game::LoadPluginsAsync(
+    const std::vector<std::string>& plugins,
+    bool loadHeadersOnly,
+    const CancellationToken& cancellationToken,
+    const ProgressCallback& progressCallback) {
+  return std::async(
+      std::launch::async,
+      [this, plugins, loadHeadersOnly, cancellationToken, progressCallback]() {
+        std::lock_guard<std::mutex> lock(asyncOperationMutex_);
+        LoadPlugins(
+            plugins, loadHeadersOnly, cancellationToken, progressCallback);
+      });
+}
 
-    uintmax_t fileSize = Plugin::GetFileSize(DataPath() / u8path(plugin));
-    meanFileSize += fileSize;
+void Game::LoadPlugins(const std::vector<std::string>& plugins,
+                       bool loadHeadersOnly,
+                       const CancellationToken& cancellationToken,
+                       const ProgressCallback& progressCallback) {
+  TraceScope traceScope("LoadPlugins", "game");
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  auto logger = getLogger();
 
-    // Trim .ghost extension if present.
-    if (boost::iends_with(plugin, ".ghost"))
-      sizeMap.emplace(fileSize, plugin.substr(0, plugin.length() - 6));
-    else
-      sizeMap.emplace(fileSize, plugin);
+  if (cancellationToken.IsCancelled()) {
+    throw OperationCancelledError("Loading plugins was cancelled");
   }
-  meanFileSize /= sizeMap.size();  // Rounding error, but not important.
 
-  // Get the number of threads to use.
-  // hardware_concurrency() may be zero, if so then use only one thread.
-  size_t threadsToUse =
-      ::std::min((size_t)thread::hardware_concurrency(), sizeMap.size());
-  threadsToUse = ::std::max(threadsToUse, (size_t)1);
+  struct PluginFile {
+    // The plugin's position in the given list.
+    size_t index;
+    std::string name;
+    DataDirectorySnapshot::Entry file;
+  };
+  std::vector<PluginFile> pluginsBySize;
 
-  // Divide the plugins up by thread.
-  unsigned int pluginsPerThread = ceil((double)sizeMap.size() / threadsToUse);
-  vector<vector<string>> pluginGroups(threadsToUse);
-  if (logger) {
-    logger->info(
-        "Loading {} plugins using {} threads, with up to {} plugins per "
-        "thread.",
-        sizeMap.size(),
-        threadsToUse,
-        pluginsPerThread);
-  }
-
-  // The plugins should be split between the threads so that the data
-  // load is as evenly spread as possible.
-  size_t currentGroup = 0;
-  for (const auto& plugin : sizeMap) {
-    if (currentGroup == threadsToUse) {
-      currentGroup = 0;
-    }
+  // Read the data directory once up front so that checking for plugins and
+  // archives doesn't need a filesystem call per file.
+  UpdateDataDirectorySnapshot();
+
+  // First find the plugin files. Their contents are only checked when they
+  // are loaded, so that each file is only opened and parsed once.
+  for (size_t i = 0; i < plugins.size(); ++i) {
+    const auto& plugin = plugins[i];
+    auto entry = dataDirectorySnapshot_.FindPlugin(plugin);
+    if (entry == nullptr || !policy_.HasPluginFileExtension(plugin))
+      throw std::invalid_argument("\"" + plugin + "\" is not a valid plugin");
 
-    pluginGroups[currentGroup].push_back(plugin.second);
-    ++currentGroup;
+    // Trim .ghost extension if present.
+    if (EndsWithIgnoringAsciiCase(plugin, ".ghost"))
+      pluginsBySize.push_back(
+          {i, plugin.substr(0, plugin.length() - 6), *entry});
+    else
+      pluginsBySize.push_back({i, plugin, *entry});
   }
 
-  // Clear the existing plugin and archive caches.
-  cache_->ClearCachedPlugins();
+  // Parse the largest plugins first, so that the smaller plugins can fill in
+  // around them as workers become free, instead of a worker being left with
+  // a large plugin to parse after all the others have finished.
+  std::stable_sort(pluginsBySize.begin(),
+                   pluginsBySize.end(),
+                   [](const auto& lhs, const auto& rhs) {
+                     return lhs.file.fileSize > rhs.file.fileSize;
+                   });
+
+  // Plugins' archive loading is determined using the cached archive paths, so
+  // previously-loaded plugins can only be reused if those paths are unchanged.
+  auto previousArchivePaths = cache_->GetArchivePaths();
   cache_->ClearCachedArchivePaths();
 
   // Search for and cache archives.
-  CacheArchives();
+  CacheArchives(*cache_);
 
-  // Load the plugins.
-  if (logger) {
-    logger->trace("Starting plugin loading.");
-  }
+  const bool canReusePlugins =
+      previousArchivePaths == cache_->GetArchivePaths();
+
+  // Work out which plugins need to be loaded: any that were previously
+  // loaded with the same header-only setting and which are unchanged on disk
+  // can be kept as they are.
   auto masterPath = DataPath() / u8path(masterFilename_);
-  vector<thread> threads;
-  while (threads.size() < threadsToUse) {
-    vector<string>& pluginGroup = pluginGroups[threads.size()];
-    threads.push_back(thread([&]() {
-      for (auto pluginName : pluginGroup) {
-        try {
-          auto pluginPath = DataPath() / u8path(pluginName);
-          const bool loadHeader =
-              loadHeadersOnly || loot::equivalent(pluginPath, masterPath);
+  std::vector<std::string> unchangedPlugins;
+  vector<std::function<void()>> tasks;
+  // The path of the file that each task parses the header of, or an empty
+  // path if it doesn't parse one.
+  std::vector<std::filesystem::path> headerPaths;
+  // Reading a header is mostly waiting for the file to be opened and its
+  // first block read, so each task prefetches a header far enough ahead of
+  // it that many reads are queued at once, instead of one per worker.
+  auto threadPool = ThreadPool::GetCurrent();
+  const size_t prefetchDistance = threadPool->Size() * 4;
+  std::atomic<bool> skippedPlugins(false);
+  std::mutex invalidPluginsMutex;
+  std::vector<size_t> invalidPlugins;
+  auto database = GetApiDatabase();
+  std::mutex progressMutex;
+  OperationProgress progress;
+  progress.stage = "LoadPlugins";
+  progress.total = pluginsBySize.size();
+  for (const auto& plugin : pluginsBySize) {
+    const auto& pluginName = plugin.name;
+    auto pluginPath = DataPath() / u8path(pluginName);
+    const bool loadHeader =
+        loadHeadersOnly || loot::equivalent(pluginPath, masterPath);
+
+    auto reusablePlugin = cache_->GetUnchangedPlugin(pluginName);
+    if (canReusePlugins && reusablePlugin &&
+        reusablePlugin->IsHeaderOnly() == loadHeader) {
+      unchangedPlugins.push_back(pluginName);
+      continue;
+    }
+
+    // A plugin that was loaded using the other header-only setting, or
+    // header-only by FilterValidPlugins(), doesn't need its header to be
+    // parsed again.
+    if (!reusablePlugin) {
+      reusablePlugin = cache_->GetUnchangedValidatedPlugin(pluginName);
+    }
+
+    headerPaths.push_back(reusablePlugin ? std::filesystem::path()
+                                         : plugin.file.path);
+    tasks.push_back([&, loadHeader, reusablePlugin, i = tasks.size()]() {
+      if (cancellationToken.IsCancelled()) {
+        skippedPlugins = true;
+        return;
+      }
+
+      TraceScope traceScope("LoadPlugin", "game", pluginName);
+
+      if (i + prefetchDistance < headerPaths.size() &&
+          !headerPaths[i + prefetchDistance].empty()) {
+        Plugin::PrefetchHeader(headerPaths[i + prefetchDistance]);
+      }
 
-          cache_->AddPlugin(Plugin(Type(), cache_, pluginPath, loadHeader));
+      std::optional<Plugin> loadedPlugin;
+      try {
+        auto sharedPlugin =
+            reusablePlugin ? nullptr
+                           : SharedPluginCache::Get().Find(
+                                  Type(),
+                                  plugin.file.path,
+                                  plugin.file.fileSize,
+                                  plugin.file.modificationTime,
+                                  loadHeader);
+        if (reusablePlugin) {
+          loadedPlugin.emplace(*reusablePlugin, cache_, loadHeader);
+        } else if (sharedPlugin) {
+          // Another game handle has already parsed this file.
+          loadedPlugin.emplace(*sharedPlugin, cache_, loadHeader);
+        } else {
+          // The file's state was read with the data directory, so it doesn't
+          // need to be read again.
+          loadedPlugin.emplace(Type(),
+                               cache_,
+                               plugin.file.path,
+                               plugin.file.fileSize,
+                               plugin.file.modificationTime,
+                               loadHeader);
+        }
+      } catch (std::exception& e) {
+        if (logger) {
+          logger->info("The file \"{}\" is not a valid plugin.", pluginName);
+        }
+        std::lock_guard<std::mutex> lock(invalidPluginsMutex);
+        invalidPlugins.push_back(plugin.index);
+      }
+
+      if (loadedPlugin) {
+        try {
+          conditionEvaluator_->UpdatePluginState(*loadedPlugin);
+          cache_->AddPlugin(std::move(*loadedPlugin));
         } catch (std::exception& e) {
           if (logger) {
             logger->error(
@@ -182,17 +428,79 @@ void Game::LoadPlugins(const std::vector<std::string>& plugins,
                 e.what());
           }
         }
+
+        // Evaluate what can be of the plugin's metadata while other plugins
+        // are still loading, so that less is left to do when it's next
+        // evaluated.
+        try {
+          database->PrecomputePluginConditions(pluginName);
+        } catch (std::exception& e) {
+          // Any error is reported when the metadata is evaluated.
+          if (logger) {
+            logger->debug("Failed to precompute the conditions of {}: {}",
+                          pluginName,
+                          e.what());
+          }
+        }
       }
-    }));
+
+      if (progressCallback) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress.completed += 1;
+        progressCallback(progress);
+      }
+    });
+  }
+  progress.completed = unchangedPlugins.size();
+
+  // Discard any existing plugin data that isn't being reused.
+  cache_->RetainPlugins(unchangedPlugins);
+  conditionEvaluator_->RetainPluginStates(unchangedPlugins);
+
+  if (logger) {
+    logger->info(
+        "Reusing {} unchanged plugins and loading {} plugins using {} threads.",
+        unchangedPlugins.size(),
+        tasks.size(),
+        threadPool->Size());
+  }
+
+  // Load the plugins.
+  if (logger) {
+    logger->trace("Starting plugin loading.");
+  }
+  for (size_t i = 0; i < prefetchDistance && i < headerPaths.size(); ++i) {
+    if (!headerPaths[i].empty()) {
+      Plugin::PrefetchHeader(headerPaths[i]);
+    }
   }
+  auto timings = threadPool->Run(tasks);
+  cache_->ClearValidatedPlugins();
 
-  // Join all threads.
-  for (auto& thread : threads) {
-    if (thread.joinable())
-      thread.join();
+  if (logger) {
+    for (size_t i = 0; i < timings.size(); ++i) {
+      logger->debug(
+          "Plugin loading thread {} loaded {} plugins, and was busy for {} ms "
+          "and idle for {} ms.",
+          i,
+          timings[i].tasksRun,
+          std::chrono::duration_cast<std::chrono::milliseconds>(timings[i].busy)
+              .count(),
+          std::chrono::duration_cast<std::chrono::milliseconds>(timings[i].idle)
+              .count());
+    }
   }
 
-  conditionEvaluator_->RefreshState(cache_);
+  SavePersistentCache();
+
+  if (skippedPlugins) {
+    if (logger) {
+      logger->info("Plugin loading was cancelled.");
+    }
+    throw OperationCancelledError("Loading plugins was cancelled");
+  }
+
+  ThrowIfAnyInvalid(plugins, invalidPlugins);
 }
 
 std::shared_ptr<const PluginInterface> Game::GetPlugin(
@@ -203,58 +511,789 @@ std::shared_ptr<const PluginInterface> Game::GetPlugin(
 std::set<std::shared_ptr<const PluginInterface>> Game::GetLoadedPlugins()
     const {
   std::set<std::shared_ptr<const PluginInterface>> interfacePointers;
-  for (auto& plugin : cache_->GetPlugins()) {
+  cache_->ForEachPlugin([&](const std::shared_ptr<const Plugin>& plugin) {
     interfacePointers.insert(
         std::static_pointer_cast<const PluginInterface>(plugin));
-  }
+  });
 
   return interfacePointers;
 }
 
+LoadedPluginTable Game::GetLoadedPluginTable() const {
+  TraceScope traceScope("GetLoadedPluginTable", "game");
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+
+  std::vector<std::shared_ptr<const Plugin>> plugins;
+  cache_->ForEachPlugin([&](const std::shared_ptr<const Plugin>& plugin) {
+    plugins.push_back(plugin);
+  });
+  std::sort(plugins.begin(),
+            plugins.end(),
+            [](const std::shared_ptr<const Plugin>& lhs,
+               const std::shared_ptr<const Plugin>& rhs) { return *lhs < *rhs; });
+
+  LoadedPluginTable table;
+  table.flags.resize(plugins.size());
+  table.crcs.resize(plugins.size());
+  table.overrideRecordCounts.resize(plugins.size());
+
+  // Checking if a plugin is empty and counting its override records may
+  // parse its records, so each plugin's values are read in its own task.
+  vector<std::function<void()>> tasks;
+  for (size_t i = 0; i < plugins.size(); ++i) {
+    tasks.push_back([&, i]() {
+      const auto& plugin = plugins[i];
+      uint8_t flags = 0;
+      if (plugin->IsMaster()) {
+        flags |= LoadedPluginTable::isMaster;
+      }
+      if (plugin->IsLightMaster()) {
+        flags |= LoadedPluginTable::isLightMaster;
+      }
+      if (plugin->IsEmpty()) {
+        flags |= LoadedPluginTable::isEmpty;
+      }
+      if (plugin->LoadsArchive()) {
+        flags |= LoadedPluginTable::loadsArchive;
+      }
+      if (plugin->IsHeaderOnly()) {
+        flags |= LoadedPluginTable::isHeaderOnly;
+      }
+
+      auto crc = plugin->GetCRCIfCalculated();
+      if (crc.has_value()) {
+        flags |= LoadedPluginTable::hasCrc;
+        table.crcs[i] = crc.value();
+      }
+
+      table.overrideRecordCounts[i] = plugin->NumOverrideFormIDs();
+      table.flags[i] = flags;
+    });
+  }
+
+  ThreadPool::GetCurrent()->Run(tasks);
+
+  // Reserve space for the string table and columns up front, estimating the
+  // names' lengths from the normalized names to avoid copying them.
+  size_t stringsLength = 0;
+  size_t mastersCount = 0;
+  for (const auto& plugin : plugins) {
+    stringsLength += plugin->GetNormalizedName().length();
+    for (const auto& master : plugin->GetMastersRef()) {
+      stringsLength += master.length();
+    }
+    mastersCount += plugin->GetMastersRef().size();
+  }
+  table.strings.reserve(stringsLength);
+  table.nameOffsets.reserve(plugins.size());
+  table.nameLengths.reserve(plugins.size());
+  table.versionOffsets.reserve(plugins.size());
+  table.versionLengths.reserve(plugins.size());
+  table.masterStarts.reserve(plugins.size() + 1);
+  table.masterOffsets.reserve(mastersCount);
+  table.masterLengths.reserve(mastersCount);
+
+  const auto appendString = [&](const std::string& value,
+                                std::vector<uint32_t>& offsets,
+                                std::vector<uint32_t>& lengths) {
+    offsets.push_back(static_cast<uint32_t>(table.strings.length()));
+    lengths.push_back(static_cast<uint32_t>(value.length()));
+    table.strings.append(value);
+  };
+
+  for (size_t i = 0; i < plugins.size(); ++i) {
+    const auto& plugin = plugins[i];
+    appendString(plugin->GetName(), table.nameOffsets, table.nameLengths);
+
+    auto version = plugin->GetVersion();
+    if (version.has_value()) {
+      table.flags[i] |= LoadedPluginTable::hasVersion;
+      appendString(
+          version.value(), table.versionOffsets, table.versionLengths);
+    } else {
+      table.versionOffsets.push_back(0);
+      table.versionLengths.push_back(0);
+    }
+
+    table.masterStarts.push_back(
+        static_cast<uint32_t>(table.masterOffsets.size()));
+    for (const auto& master : plugin->GetMastersRef()) {
+      appendString(master, table.masterOffsets, table.masterLengths);
+    }
+  }
+  table.masterStarts.push_back(
+      static_cast<uint32_t>(table.masterOffsets.size()));
+
+  return table;
+}
+
+std::vector<std::string> Game::GetOverlappingPlugins(
+    const std::string& pluginName) const {
+  std::vector<std::string> overlappingPlugins;
+  auto plugin = cache_->GetPlugin(pluginName);
+  if (!plugin) {
+    return overlappingPlugins;
+  }
+
+  cache_->ForEachPlugin([&](const std::shared_ptr<const Plugin>& otherPlugin) {
+    if (otherPlugin != plugin && plugin->MayFormIDsOverlap(*otherPlugin) &&
+        plugin->DoFormIDsOverlap(*otherPlugin)) {
+      overlappingPlugins.push_back(otherPlugin->GetName());
+    }
+  });
+
+  std::sort(overlappingPlugins.begin(),
+            overlappingPlugins.end(),
+            [](const std::string& lhs, const std::string& rhs) {
+              return CompareFilenames(lhs, rhs) < 0;
+            });
+
+  return overlappingPlugins;
+}
+
+std::vector<std::vector<std::string>> Game::GetPluginOverlaps(
+    const std::vector<std::string>& pluginNames) const {
+  TraceScope traceScope("GetPluginOverlaps", "game");
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+
+  std::vector<std::shared_ptr<const Plugin>> plugins;
+  plugins.reserve(pluginNames.size());
+  for (const auto& pluginName : pluginNames) {
+    plugins.push_back(cache_->GetPlugin(pluginName));
+  }
+
+  const auto overlaps =
+      OverlapMatrix::Compute(plugins.size(), [&](size_t i, size_t j) {
+        const auto& plugin = plugins[i];
+        const auto& otherPlugin = plugins[j];
+        return plugin && otherPlugin && plugin != otherPlugin &&
+               plugin->MayFormIDsOverlap(*otherPlugin) &&
+               plugin->DoFormIDsOverlap(*otherPlugin);
+      });
+
+  std::vector<std::vector<std::string>> overlappingPlugins(plugins.size());
+  for (size_t i = 0; i < plugins.size(); ++i) {
+    for (size_t j = 0; j < plugins.size(); ++j) {
+      if (i != j && overlaps.Get(i, j)) {
+        overlappingPlugins[i].push_back(plugins[j]->GetName());
+      }
+    }
+
+    std::sort(overlappingPlugins[i].begin(),
+              overlappingPlugins[i].end(),
+              [](const std::string& lhs, const std::string& rhs) {
+                return CompareFilenames(lhs, rhs) < 0;
+              });
+  }
+
+  return overlappingPlugins;
+}
+
+std::vector<std::string> Game::GetDependentPlugins(
+    const std::string& masterName) const {
+  std::vector<std::string> dependentPlugins;
+  for (const auto& plugin : cache_->GetDependentPlugins(masterName)) {
+    dependentPlugins.push_back(plugin->GetName());
+  }
+
+  std::sort(dependentPlugins.begin(),
+            dependentPlugins.end(),
+            [](const std::string& lhs, const std::string& rhs) {
+              return CompareFilenames(lhs, rhs) < 0;
+            });
+
+  return dependentPlugins;
+}
+
+std::vector<bool> Game::ArePluginsValidAsLightMasters(
+    const std::vector<std::string>& pluginNames) const {
+  TraceScope traceScope("ArePluginsValidAsLightMasters", "game");
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+
+  // Each task writes its own element, which std::vector<bool> doesn't allow.
+  std::vector<char> areValid(pluginNames.size(), false);
+  vector<std::function<void()>> tasks;
+  for (size_t i = 0; i < pluginNames.size(); ++i) {
+    auto plugin = cache_->GetPlugin(pluginNames[i]);
+    if (!plugin) {
+      continue;
+    }
+
+    tasks.push_back([&areValid, i, plugin = std::move(plugin)]() {
+      TraceScope traceScope("IsValidAsLightMaster", "game", plugin->GetName());
+      areValid[i] = plugin->IsValidAsLightMaster();
+    });
+  }
+
+  ThreadPool::GetCurrent()->Run(tasks);
+
+  return std::vector<bool>(areValid.begin(), areValid.end());
+}
+
+void Game::ScanPlugins(const std::vector<std::string>& plugins,
+                       bool loadHeadersOnly,
+                       const PluginScanCallback& callback,
+                       const CancellationToken& cancellationToken) {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  auto logger = getLogger();
+
+  if (cancellationToken.IsCancelled()) {
+    throw OperationCancelledError("Scanning plugins was cancelled");
+  }
+
+  UpdateDataDirectorySnapshot();
+
+  // As for FilterValidPlugins(), the plugins get their own cache of archive
+  // paths. They are never added to it, and their CRCs are calculated
+  // directly so that they aren't recorded in its persistent cache, so nothing
+  // is kept once each plugin's summary has been given to the callback.
+  auto scanCache = std::make_shared<GameCache>();
+  scanCache->SetMemoryResource(memoryResource_);
+  CacheArchives(*scanCache);
+
+  std::atomic<bool> skippedPlugins(false);
+  std::atomic<bool> hasCallbackThrown(false);
+  std::mutex invalidPluginsMutex;
+  std::vector<size_t> invalidPlugins;
+  // Held while the callback runs, which also stops workers from parsing
+  // more plugins while the callback is slower than they are.
+  std::mutex callbackMutex;
+
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(plugins.size());
+  for (size_t i = 0; i < plugins.size(); ++i) {
+    tasks.push_back([&, i]() {
+      if (cancellationToken.IsCancelled()) {
+        skippedPlugins = true;
+        return;
+      }
+      if (hasCallbackThrown) {
+        return;
+      }
+
+      const auto& pluginName = plugins[i];
+      TraceScope traceScope("ScanPlugin", "game", pluginName);
+
+      auto recordInvalidPlugin = [&]() {
+        if (logger) {
+          logger->info("The file \"{}\" is not a valid plugin.", pluginName);
+        }
+        std::lock_guard<std::mutex> lock(invalidPluginsMutex);
+        invalidPlugins.push_back(i);
+      };
+
+      auto entry = dataDirectorySnapshot_.FindPlugin(pluginName);
+      if (entry == nullptr || !policy_.HasPluginFileExtension(pluginName)) {
+        recordInvalidPlugin();
+        return;
+      }
+
+      PluginSummary summary;
+      try {
+        Plugin plugin(Type(),
+                      scanCache,
+                      entry->path,
+                      entry->fileSize,
+                      entry->modificationTime,
+                      loadHeadersOnly);
+
+        summary.name = plugin.GetName();
+        summary.masters = plugin.GetMastersRef();
+        summary.isMaster = plugin.IsMaster();
+        summary.isLightMaster = plugin.IsLightMaster();
+        summary.isEmpty = plugin.IsEmpty();
+        summary.loadsArchive = plugin.LoadsArchive();
+        summary.version = plugin.GetVersion();
+        summary.bashTags = plugin.GetBashTags();
+        if (!loadHeadersOnly) {
+          summary.overrideRecordCount = plugin.NumOverrideFormIDs();
+          summary.crc = GetCrc32(entry->path);
+        }
+      } catch (std::exception&) {
+        recordInvalidPlugin();
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(callbackMutex);
+      if (hasCallbackThrown) {
+        return;
+      }
+      try {
+        callback(summary);
+      } catch (...) {
+        hasCallbackThrown = true;
+        throw;
+      }
+    });
+  }
+
+  // The pool rethrows the callback's exception once the remaining tasks have
+  // returned without doing anything.
+  ThreadPool::GetCurrent()->Run(tasks);
+
+  if (skippedPlugins) {
+    if (logger) {
+      logger->info("Plugin scanning was cancelled.");
+    }
+    throw OperationCancelledError("Scanning plugins was cancelled");
+  }
+
+  ThrowIfAnyInvalid(plugins, invalidPlugins);
+}
+
 void Game::IdentifyMainMasterFile(const std::string& masterFile) {
   masterFilename_ = masterFile;
 }
 
 std::vector<std::string> Game::SortPlugins(
     const std::vector<std::string>& plugins) {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
   LoadPlugins(plugins, false);
+  LoadPluginRecords(CancellationToken());
+  RefreshLoadOrderStateIfStale();
 
   // Sort plugins into their load order.
-  PluginSorter sorter;
-  return sorter.Sort(*this);
+  auto sortedPlugins = sorter_->Sort(*this);
+  ReleasePluginRecordsIfEnabled();
+
+  return sortedPlugins;
+}
+
+std::future<std::vector<std::string>> Game::SortPluginsAsync(
+    const std::vector<std::string>& plugins,
+    const CancellationToken& cancellationToken,
+    const ProgressCallback& progressCallback) {
+  return std::async(
+      std::launch::async,
+      [this, plugins, cancellationToken, progressCallback]() {
+        std::lock_guard<std::mutex> lock(asyncOperationMutex_);
+        ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+        LoadPlugins(plugins, false, cancellationToken, progressCallback);
+        LoadPluginRecords(cancellationToken);
+        RefreshLoadOrderStateIfStale();
+
+        auto sortedPlugins =
+            sorter_->Sort(*this, cancellationToken, progressCallback);
+        ReleasePluginRecordsIfEnabled();
+
+        return sortedPlugins;
+      });
+}
+
+std::vector<std::string> Game::SortNewPlugins(
+    const std::vector<std::string>& loadOrder,
+    const std::vector<std::string>& newPlugins) {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  auto plugins = loadOrder;
+  plugins.insert(plugins.end(), newPlugins.begin(), newPlugins.end());
+
+  LoadPlugins(plugins, false);
+  RefreshLoadOrderStateIfStale();
+
+  // Records are only parsed for the plugins that the new plugins are compared
+  // with, so they aren't all loaded up front.
+  auto sortedPlugins = sorter_->SortNewPlugins(*this, loadOrder, newPlugins);
+  ReleasePluginRecordsIfEnabled();
+
+  return sortedPlugins;
+}
+
+std::vector<std::vector<std::string>> Game::SortProfiles(
+    const std::vector<SortProfile>& profiles) {
+  TraceScope traceScope("SortProfiles", "game");
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+
+  // Load each distinct plugin once for all the profiles.
+  std::vector<std::string> plugins;
+  std::unordered_set<std::string> pluginNames;
+  for (const auto& profile : profiles) {
+    for (const auto& plugin : profile.plugins) {
+      if (pluginNames.insert(NormalizeFilename(plugin)).second) {
+        plugins.push_back(plugin);
+      }
+    }
+  }
+
+  LoadPlugins(plugins, false);
+  LoadPluginRecords(CancellationToken());
+  RefreshLoadOrderStateIfStale();
+
+  auto sortedProfiles = sorter_->SortProfiles(*this, profiles);
+  ReleasePluginRecordsIfEnabled();
+
+  return sortedProfiles;
+}
+
+void Game::SetSortTieBreakMode(TieBreakMode mode) {
+  sorter_->SetTieBreakMode(mode);
+}
+
+void Game::SetSortValidationEnabled(bool enabled) {
+  sorter_->SetValidationEnabled(enabled);
+}
+
+void Game::SetRecordReleaseAfterSortEnabled(bool enabled) {
+  releaseRecordsAfterSort_ = enabled;
+}
+
+SortStatistics Game::GetSortStatistics() const {
+  return sorter_->GetStatistics();
+}
+
+std::vector<Vertex> Game::GetPluginsPath(
+    const std::string& fromPluginName,
+    const std::string& toPluginName) const {
+  return sorter_->GetPluginsPath(fromPluginName, toPluginName);
+}
+
+void Game::WriteSortCapture(const std::vector<std::string>& plugins,
+                            const std::filesystem::path& outputFile) {
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  LoadPlugins(plugins, false);
+  LoadPluginRecords(CancellationToken());
+  RefreshLoadOrderStateIfStale();
+
+  SaveSortCapture(sorter_->Capture(*this), outputFile);
 }
 
 void Game::LoadCurrentLoadOrderState() {
-  loadOrderHandler_->LoadCurrentState();
-  conditionEvaluator_->RefreshState(loadOrderHandler_);
+  {
+    // Changes made before now are reflected in the state being loaded.
+    std::lock_guard<std::mutex> lock(fileWatcherMutex_);
+    ReadFileChanges();
+    isLoadOrderStateStale_ = false;
+    hasLoadedLoadOrderState_ = true;
+  }
+
+  GetLoadOrderHandler()->LoadCurrentState();
+  conditionEvaluator_->RefreshState(GetLoadOrderHandler());
+}
+
+void Game::SetFileWatchingEnabled(bool enable) {
+  std::lock_guard<std::mutex> lock(fileWatcherMutex_);
+
+  if (enable == (fileWatcher_ != nullptr)) {
+    return;
+  }
+
+  changedDataFiles_.clear();
+  isDataDirectorySnapshotCurrent_ = false;
+  isLoadOrderStateStale_ = false;
+  canWatchLoadOrderState_ = false;
+
+  if (!enable) {
+    fileWatcher_.reset();
+    return;
+  }
+
+  std::vector<std::filesystem::path> directories({DataPath(), gamePath_});
+  if (!localDataPath_.empty()) {
+    directories.push_back(localDataPath_);
+  }
+  fileWatcher_ = std::make_unique<FileWatcher>(directories);
+
+  // The local data path is found by libloadorder if it isn't given, so its
+  // files can only be watched if it is given.
+  canWatchLoadOrderState_ = fileWatcher_->IsWatching(DataPath()) &&
+                            fileWatcher_->IsWatching(gamePath_) &&
+                            !localDataPath_.empty() &&
+                            fileWatcher_->IsWatching(localDataPath_);
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->debug(
+        "Started watching for file changes. Data directory watched: {}, load "
+        "order state files watched: {}",
+        fileWatcher_->IsWatching(DataPath()),
+        canWatchLoadOrderState_);
+  }
 }
 
 bool Game::IsPluginActive(const std::string& pluginName) const {
-  return loadOrderHandler_->IsPluginActive(pluginName);
+  RefreshLoadOrderStateIfStale();
+
+  return GetLoadOrderHandler()->IsPluginActive(pluginName);
+}
+
+std::vector<bool> Game::ArePluginsActive(
+    const std::vector<std::string>& pluginNames) const {
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Checking if {} plugins are active.", pluginNames.size());
+  }
+
+  RefreshLoadOrderStateIfStale();
+
+  auto state = GetLoadOrderHandler()->GetState();
+
+  std::vector<bool> areActive;
+  areActive.reserve(pluginNames.size());
+  for (const auto& pluginName : pluginNames) {
+    areActive.push_back(state->IsPluginActive(pluginName));
+  }
+
+  return areActive;
 }
 
 std::vector<std::string> Game::GetLoadOrder() const {
-  return loadOrderHandler_->GetLoadOrder();
+  RefreshLoadOrderStateIfStale();
+
+  return GetLoadOrderHandler()->GetLoadOrder();
 }
 
 void Game::SetLoadOrder(const std::vector<std::string>& loadOrder) {
-  loadOrderHandler_->SetLoadOrder(loadOrder);
+  RefreshLoadOrderStateIfStale();
+
+  GetLoadOrderHandler()->SetLoadOrder(loadOrder);
+}
+
+void Game::LoadPluginRecords(const CancellationToken& cancellationToken) {
+  TraceScope traceScope("LoadPluginRecords", "game");
+  ThreadPoolScope threadPoolScope(std::atomic_load(&threadPool_));
+  auto logger = getLogger();
+
+  std::vector<std::shared_ptr<const Plugin>> plugins;
+  cache_->ForEachPlugin([&](const std::shared_ptr<const Plugin>& plugin) {
+    plugins.push_back(plugin);
+  });
+
+  // The pool runs tasks in order, so while each worker parses a plugin, the
+  // plugins that will be parsed next are read into the OS cache in the
+  // background, instead of each worker waiting for its own file to be read.
+  auto threadPool = ThreadPool::GetCurrent();
+  const size_t prefetchDistance = threadPool->Size();
+  for (size_t i = 0; i < prefetchDistance && i < plugins.size(); ++i) {
+    plugins[i]->PrefetchRecords();
+  }
+
+  std::mutex mutex;
+  std::vector<std::string> loadedPlugins;
+  std::atomic<bool> skippedPlugins(false);
+  vector<std::function<void()>> tasks;
+  for (size_t i = 0; i < plugins.size(); ++i) {
+    tasks.push_back([&, i]() {
+      if (cancellationToken.IsCancelled()) {
+        skippedPlugins = true;
+        return;
+      }
+
+      if (i + prefetchDistance < plugins.size()) {
+        plugins[i + prefetchDistance]->PrefetchRecords();
+      }
+
+      const auto& plugin = plugins[i];
+      TraceScope traceScope("LoadRecords", "game", plugin->GetName());
+      try {
+        plugin->LoadRecords();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        loadedPlugins.push_back(plugin->GetName());
+      } catch (std::exception& e) {
+        if (logger) {
+          logger->error(
+              "Caught exception while trying to load the records of {}: {}",
+              plugin->GetName(),
+              e.what());
+        }
+      }
+    });
+  }
+
+  if (logger) {
+    logger->trace("Loading the records of {} plugins.", tasks.size());
+  }
+  threadPool->Run(tasks);
+
+  if (skippedPlugins) {
+    if (logger) {
+      logger->info("Plugin record loading was cancelled.");
+    }
+    throw OperationCancelledError("Loading plugins was cancelled");
+  }
+
+  // Plugins with records that can't be parsed can't be sorted, so discard
+  // them as would have happened if they'd failed to load at all.
+  if (loadedPlugins.size() < plugins.size()) {
+    cache_->RetainPlugins(loadedPlugins);
+    conditionEvaluator_->RetainPluginStates(loadedPlugins);
+  }
+}
+
+MemoryUsage Game::GetMemoryUsage() const {
+  std::lock_guard<std::mutex> lock(asyncOperationMutex_);
+
+  MemoryUsage usage;
+  cache_->AddMemoryUsage(usage);
+  GetApiDatabase()->AddMemoryUsage(usage);
+  usage.conditionCache += conditionEvaluator_->GetConditionCacheMemoryUsage();
+  usage.sorter = sorter_->GetMemoryUsage();
+
+  return usage;
+}
+
+void Game::TrimCaches() {
+  std::lock_guard<std::mutex> lock(asyncOperationMutex_);
+
+  cache_->ForEachPlugin([](const std::shared_ptr<const Plugin>& plugin) {
+    plugin->ReleaseRecords();
+  });
+  cache_->ClearValidatedPlugins();
+  conditionEvaluator_->ClearConditionCache();
+  GetApiDatabase()->TrimCaches();
+  sorter_->Trim();
+}
+
+void Game::SetExecutor(std::shared_ptr<Executor> executor) {
+  std::shared_ptr<ThreadPool> threadPool;
+  if (executor) {
+    threadPool = std::make_shared<ThreadPool>(executor);
+  }
+
+  GetApiDatabase()->SetThreadPool(threadPool);
+  std::atomic_store(&threadPool_, std::move(threadPool));
+}
+
+void Game::SetMemoryResource(MemoryResource* resource) {
+  const auto adapter = GetMemoryResourceAdapter(resource);
+  memoryResource_ = adapter;
+  cache_->SetMemoryResource(adapter);
+  sorter_->SetMemoryResource(adapter);
 }
 
-void Game::CacheArchives() {
-  const auto archiveFileExtension = GetArchiveFileExtension(Type());
+std::shared_ptr<ApiDatabase> Game::GetApiDatabase() const {
+  std::call_once(databaseInitFlag_, [this]() {
+    database_ = std::make_shared<ApiDatabase>(conditionEvaluator_);
+  });
 
-  for (std::filesystem::directory_iterator it(DataPath());
-       it != std::filesystem::directory_iterator();
-       ++it) {
+  return database_;
+}
+
+void Game::ReleasePluginRecordsIfEnabled() const {
+  if (!releaseRecordsAfterSort_) {
+    return;
+  }
+
+  cache_->ForEachPlugin([](const std::shared_ptr<const Plugin>& plugin) {
+    plugin->ReleaseRecords();
+  });
+}
+
+void Game::SavePersistentCache() {
+  auto& persistentCache = cache_->GetPersistentCache();
+  if (pluginCachePath_.empty() || !persistentCache.IsModified()) {
+    return;
+  }
+
+  try {
+    persistentCache.Save(pluginCachePath_);
+  } catch (std::exception& e) {
+    // The cache is an optimisation, so failing to write it isn't fatal.
+    auto logger = getLogger();
+    if (logger) {
+      logger->warn("Failed to save the plugin cache: {}", e.what());
+    }
+  }
+}
+
+void Game::CacheArchives(GameCache& cache) const {
+  TraceScope traceScope("CacheArchives", "game");
+  const auto& archiveFileExtension = policy_.archiveFileExtension;
+
+  for (const auto& entry : dataDirectorySnapshot_.GetEntries()) {
     // Check if the path is an archive by checking if replacing its
-    // file extension with the archive extension resolves to the same file.
-    // Could use boost::iends_with, but it's less obvious here that the
-    // test string is ASCII-only.
-    if (loot::equivalent(it->path(),
-                         replaceExtension(it->path(), archiveFileExtension))) {
-      cache_->CacheArchivePath(it->path());
+    // file extension with the archive extension gives the same filename, as
+    // the filesystem would compare them.
+    auto archiveFilename =
+        replaceExtension(entry.path.filename(), archiveFileExtension)
+            .u8string();
+    if (DataDirectorySnapshot::GetLookupKey(archiveFilename) ==
+        DataDirectorySnapshot::GetLookupKey(entry.filename)) {
+      cache.CacheArchivePath(entry.path);
+    }
+  }
+}
+
+void Game::UpdateDataDirectorySnapshot() {
+  std::unordered_set<std::string> changedFiles;
+  bool isSnapshotCurrent = false;
+  {
+    std::lock_guard<std::mutex> lock(fileWatcherMutex_);
+    ReadFileChanges();
+
+    isSnapshotCurrent = isDataDirectorySnapshotCurrent_;
+    changedFiles.swap(changedDataFiles_);
+
+    // Any changes made from now on will be recorded for the next update.
+    isDataDirectorySnapshotCurrent_ =
+        fileWatcher_ && fileWatcher_->IsWatching(DataPath());
+  }
+
+  if (isSnapshotCurrent) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->debug(
+          "Refreshing {} changed files in the data directory snapshot.",
+          changedFiles.size());
+    }
+    dataDirectorySnapshot_.Refresh(changedFiles);
+  } else {
+    dataDirectorySnapshot_ = DataDirectorySnapshot(DataPath());
+  }
+
+  conditionEvaluator_->SetDataDirectorySnapshot(dataDirectorySnapshot_);
+}
+
+void Game::ReadFileChanges() const {
+  if (!fileWatcher_) {
+    return;
+  }
+
+  const auto dataPath = DataPath();
+  for (const auto& change : fileWatcher_->ReadChanges()) {
+    if (change.directory == dataPath) {
+      if (change.filename.empty()) {
+        isDataDirectorySnapshotCurrent_ = false;
+        isLoadOrderStateStale_ = true;
+        continue;
+      }
+
+      changedDataFiles_.insert(change.filename);
+
+      // Plugin timestamps and the presence of plugins affect the load order.
+      if (policy_.HasPluginFileExtension(change.filename)) {
+        isLoadOrderStateStale_ = true;
+      }
+    } else if (change.directory == gamePath_) {
+      // Some games read load order settings from ini files in their install
+      // directory.
+      if (change.filename.empty() ||
+          EndsWithIgnoringAsciiCase(change.filename, ".ini")) {
+        isLoadOrderStateStale_ = true;
+      }
+    } else {
+      isLoadOrderStateStale_ = true;
+    }
+  }
+}
+
+void Game::RefreshLoadOrderStateIfStale() const {
+  {
+    std::lock_guard<std::mutex> lock(fileWatcherMutex_);
+    ReadFileChanges();
+
+    if (!canWatchLoadOrderState_ || !hasLoadedLoadOrderState_ ||
+        !isLoadOrderStateStale_) {
+      return;
     }
+    isLoadOrderStateStale_ = false;
   }
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->debug("Load order state files have changed, reloading the state.");
+  }
+
+  GetLoadOrderHandler()->LoadCurrentState();
+  conditionEvaluator_->RefreshState(GetLoadOrderHandler());
 }
 }
@@ -25,20 +25,36 @@
 #ifndef LOOT_API_GAME_GAME
 #define LOOT_API_GAME_GAME
 
+#include <atomic>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_set>
 
+#include "api/game/data_directory_snapshot.h"
+#include "api/game/file_watcher.h"
 #include "api/game/game_cache.h"
+#include "api/game/game_policy.h"
 #include "api/game/load_order_handler.h"
+#include "api/helpers/memory_resource.h"
 #include "api/metadata/condition_evaluator.h"
 #include "loot/game_interface.h"
 
 namespace loot {
+struct ApiDatabase;
+class PluginSorter;
+class ThreadPool;
+
 class Game : public GameInterface {
 public:
   Game(const GameType gameType,
        const std::filesystem::path& gamePath,
        const std::filesystem::path& gameLocalDataPath = "");
+  // Saves the persistent plugin cache if it has been modified, so that CRCs
+  // calculated since plugins were last loaded aren't lost.
+  ~Game();
 
   // Internal Methods //
   //////////////////////
@@ -47,47 +63,191 @@ public:
   std::filesystem::path DataPath() const;
 
   std::shared_ptr<GameCache> GetCache();
-  std::shared_ptr<LoadOrderHandler> GetLoadOrderHandler();
+  // Initialises the load order handler the first time it's called.
+  std::shared_ptr<LoadOrderHandler> GetLoadOrderHandler() const;
+
+  // The contents of the data directory as they were when plugins were last
+  // loaded.
+  const DataDirectorySnapshot& GetDataDirectorySnapshot() const;
+
+  // Like GetDatabase(), but gives access to the database's internal methods.
+  // Creates the database the first time it's called.
+  std::shared_ptr<ApiDatabase> GetApiDatabase() const;
 
   // Game Interface Methods //
   ////////////////////////////
 
   std::shared_ptr<DatabaseInterface> GetDatabase();
 
+  void SetConditionProfilingEnabled(bool enabled);
+
+  std::vector<ConditionStatistics> GetConditionStatistics(
+      size_t maxConditions) const;
+
   bool IsValidPlugin(const std::string& plugin) const;
 
+  std::vector<std::shared_ptr<const PluginInterface>> FilterValidPlugins(
+      const std::vector<std::string>& plugins);
+
+  void SetPluginCachePath(const std::filesystem::path& cachePath);
+
   void LoadPlugins(const std::vector<std::string>& plugins,
                    bool loadHeadersOnly);
 
+  std::future<void> LoadPluginsAsync(
+      const std::vector<std::string>& plugins,
+      bool loadHeadersOnly,
+      const CancellationToken& cancellationToken = CancellationToken(),
+      const ProgressCallback& progressCallback = ProgressCallback());
+
   std::shared_ptr<const PluginInterface> GetPlugin(
       const std::string& pluginName) const;
 
   std::set<std::shared_ptr<const PluginInterface>> GetLoadedPlugins() const;
 
+  LoadedPluginTable GetLoadedPluginTable() const;
+
+  std::vector<std::string> GetOverlappingPlugins(
+      const std::string& pluginName) const;
+
+  std::vector<std::vector<std::string>> GetPluginOverlaps(
+      const std::vector<std::string>& plugins) const;
+
+  std::vector<std::string> GetDependentPlugins(
+      const std::string& masterName) const;
+
+  std::vector<bool> ArePluginsValidAsLightMasters(
+      const std::vector<std::string>& plugins) const;
+
+  void ScanPlugins(
+      const std::vector<std::string>& plugins,
+      bool loadHeadersOnly,
+      const PluginScanCallback& callback,
+      const CancellationToken& cancellationToken = CancellationToken());
+
   void IdentifyMainMasterFile(const std::string& masterFile);
 
   std::vector<std::string> SortPlugins(const std::vector<std::string>& plugins);
 
+  std::future<std::vector<std::string>> SortPluginsAsync(
+      const std::vector<std::string>& plugins,
+      const CancellationToken& cancellationToken = CancellationToken(),
+      const ProgressCallback& progressCallback = ProgressCallback());
+
+  std::vector<std::string> SortNewPlugins(
+      const std::vector<std::string>& loadOrder,
+      const std::vector<std::string>& newPlugins);
+
+  std::vector<std::vector<std::string>> SortProfiles(
+      const std::vector<SortProfile>& profiles);
+
+  void SetSortTieBreakMode(TieBreakMode mode);
+
+  void SetSortValidationEnabled(bool enabled);
+
+  void SetRecordReleaseAfterSortEnabled(bool enabled);
+
+  SortStatistics GetSortStatistics() const;
+
+  std::vector<Vertex> GetPluginsPath(const std::string& fromPluginName,
+                                     const std::string& toPluginName) const;
+
+  void WriteSortCapture(const std::vector<std::string>& plugins,
+                        const std::filesystem::path& outputFile);
+
   void LoadCurrentLoadOrderState();
 
+  void SetFileWatchingEnabled(bool enable);
+
   bool IsPluginActive(const std::string& pluginName) const;
 
+  std::vector<bool> ArePluginsActive(
+      const std::vector<std::string>& pluginNames) const;
+
   std::vector<std::string> GetLoadOrder() const;
 
   void SetLoadOrder(const std::vector<std::string>& loadOrder);
 
+  MemoryUsage GetMemoryUsage() const;
+
+  void TrimCaches();
+
+  void SetExecutor(std::shared_ptr<Executor> executor);
+
+  void SetMemoryResource(MemoryResource* resource);
+
 private:
-  void CacheArchives();
+  // Skips plugins that haven't started loading once the token is cancelled,
+  // and reports each loaded plugin to the callback.
+  void LoadPlugins(const std::vector<std::string>& plugins,
+                   bool loadHeadersOnly,
+                   const CancellationToken& cancellationToken,
+                   const ProgressCallback& progressCallback);
+  // Parses the records of all loaded plugins that haven't had them parsed
+  // yet, discarding any plugins with records that can't be parsed.
+  void LoadPluginRecords(const CancellationToken& cancellationToken);
+  // Frees the record data of all loaded plugins if record release after
+  // sorting is enabled.
+  void ReleasePluginRecordsIfEnabled() const;
+  void SavePersistentCache();
+  // Caches the paths of the archives in the data directory snapshot in the
+  // given cache.
+  void CacheArchives(GameCache& cache) const;
+  // Reads the data directory, or if file watching is enabled and the snapshot
+  // is up to date apart from recorded changes, just the changed files.
+  void UpdateDataDirectorySnapshot();
+  // Records any file changes that the watcher has seen. Must be called with
+  // fileWatcherMutex_ held.
+  void ReadFileChanges() const;
+  // Reloads the load order state if file watching has seen changes to the
+  // files it is read from.
+  void RefreshLoadOrderStateIfStale() const;
 
   std::shared_ptr<GameCache> cache_;
+  // Only initialised by GetLoadOrderHandler().
   std::shared_ptr<LoadOrderHandler> loadOrderHandler_;
+  mutable std::once_flag loadOrderHandlerInitFlag_;
   std::shared_ptr<ConditionEvaluator> conditionEvaluator_;
-  std::shared_ptr<DatabaseInterface> database_;
+  // Only created by GetApiDatabase().
+  mutable std::shared_ptr<ApiDatabase> database_;
+  mutable std::once_flag databaseInitFlag_;
+  // Kept between calls to SortPlugins() so that it can reuse work from
+  // earlier sorts.
+  std::shared_ptr<PluginSorter> sorter_;
+  std::atomic<bool> releaseRecordsAfterSort_;
 
   const GameType type_;
+  // Looked up once so that per-plugin code doesn't switch on the game type.
+  const GamePolicy& policy_;
   const std::filesystem::path gamePath_;
+  const std::filesystem::path localDataPath_;
+  std::filesystem::path pluginCachePath_;
+  DataDirectorySnapshot dataDirectorySnapshot_;
 
   std::string masterFilename_;
+
+  // The state used to react to file changes. A null watcher means that file
+  // watching is disabled.
+  mutable std::mutex fileWatcherMutex_;
+  std::unique_ptr<FileWatcher> fileWatcher_;
+  // True if the load order state's files are all being watched.
+  bool canWatchLoadOrderState_;
+  bool hasLoadedLoadOrderState_;
+  mutable bool isLoadOrderStateStale_;
+  // True if the data directory snapshot was taken while watching and no
+  // changes have been missed since.
+  mutable bool isDataDirectorySnapshotCurrent_;
+  mutable std::unordered_set<std::string> changedDataFiles_;
+
+  // The pool for the executor set by SetExecutor(), or null to use the
+  // current pool. Only accessed through std::atomic_load() and
+  // std::atomic_store().
+  std::shared_ptr<ThreadPool> threadPool_;
+  // The resource set by SetMemoryResource(), or null to use the global one.
+  std::atomic<pmr::memory_resource*> memoryResource_;
+
+  // Held while an asynchronous operation runs, so that they run one at a time.
+  mutable std::mutex asyncOperationMutex_;
 };
 }
 #endif
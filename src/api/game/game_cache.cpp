@@ -24,26 +24,37 @@
 
 #include "api/game/game_cache.h"
 
+#include <algorithm>
 #include <thread>
+#include <unordered_set>
 
 #include <boost/locale.hpp>
 
+#include "api/game/shared_plugin_cache.h"
+#include "api/helpers/memory_resource.h"
+#include "api/helpers/memory_usage.h"
 #include "api/helpers/text.h"
 
-using std::lock_guard;
-using std::mutex;
 using std::pair;
+using std::shared_lock;
+using std::shared_mutex;
 using std::string;
+using std::unique_lock;
 
 namespace loot {
-GameCache::GameCache() {}
+GameCache::GameCache() : memoryResource_(nullptr) {}
 
 GameCache::GameCache(const GameCache& cache) :
-    plugins_(cache.plugins_) {}
+    persistentCache_(cache.persistentCache_),
+    memoryResource_(cache.memoryResource_.load()) {
+  CopyPlugins(cache);
+}
 
 GameCache& GameCache::operator=(const GameCache& cache) {
   if (&cache != this) {
-    plugins_ = cache.plugins_;
+    CopyPlugins(cache);
+    persistentCache_ = cache.persistentCache_;
+    memoryResource_ = cache.memoryResource_.load();
   }
 
   return *this;
@@ -51,60 +62,375 @@ GameCache& GameCache::operator=(const GameCache& cache) {
 
 std::set<std::shared_ptr<const Plugin>> GameCache::GetPlugins() const {
   std::set<std::shared_ptr<const Plugin>> output;
-  std::transform(
-      begin(plugins_),
-      end(plugins_),
-      std::inserter<std::set<std::shared_ptr<const Plugin>>>(output,
-                                                             begin(output)),
-      [](const pair<string, std::shared_ptr<const Plugin>>& pluginPair) {
-        return pluginPair.second;
-      });
+  for (const auto& shard : pluginShards_) {
+    shared_lock<shared_mutex> lock(shard.mutex);
+    std::transform(
+        begin(shard.plugins),
+        end(shard.plugins),
+        std::inserter<std::set<std::shared_ptr<const Plugin>>>(output,
+                                                               begin(output)),
+        [](const pair<string, std::shared_ptr<const Plugin>>& pluginPair) {
+          return pluginPair.second;
+        });
+  }
   return output;
 }
 
+void GameCache::ForEachPlugin(
+    const std::function<void(const std::shared_ptr<const Plugin>&)>& callback)
+    const {
+  // Copy one shard's plugins at a time so that the callback can be run
+  // without holding the shard's lock.
+  std::vector<std::shared_ptr<const Plugin>> plugins;
+  for (const auto& shard : pluginShards_) {
+    plugins.clear();
+    {
+      shared_lock<shared_mutex> lock(shard.mutex);
+      for (const auto& pluginPair : shard.plugins) {
+        plugins.push_back(pluginPair.second);
+      }
+    }
+
+    for (const auto& plugin : plugins) {
+      callback(plugin);
+    }
+  }
+}
+
+void GameCache::SetMemoryResource(pmr::memory_resource* resource) {
+  memoryResource_ = resource;
+}
+
+pmr::memory_resource* GameCache::GetMemoryResource() const {
+  return ResolveMemoryResource(memoryResource_);
+}
+
+size_t GameCache::NumPlugins() const {
+  size_t numPlugins = 0;
+  for (const auto& shard : pluginShards_) {
+    shared_lock<shared_mutex> lock(shard.mutex);
+    numPlugins += shard.plugins.size();
+  }
+  return numPlugins;
+}
+
 std::shared_ptr<const Plugin> GameCache::GetPlugin(
     const std::string& pluginName) const {
-  auto it = plugins_.find(NormalizeFilename(pluginName));
-  if (it != end(plugins_))
+  auto normalizedName = NormalizeFilename(pluginName);
+  const auto& shard = pluginShards_[GetShardIndex(normalizedName)];
+
+  shared_lock<shared_mutex> lock(shard.mutex);
+  auto it = shard.plugins.find(normalizedName);
+  if (it != end(shard.plugins))
     return it->second;
 
   return nullptr;
 }
 
 void GameCache::AddPlugin(const Plugin&& plugin) {
-  lock_guard<mutex> lock(mutex_);
+  // Create the shared pointer before taking the lock, as it copies the plugin.
+  std::shared_ptr<const Plugin> sharedPlugin = std::allocate_shared<Plugin>(
+      pmr::polymorphic_allocator<Plugin>(GetMemoryResource()),
+      std::move(plugin));
+  SharedPluginCache::Get().Add(sharedPlugin);
+
+  const auto& normalizedName = sharedPlugin->GetNormalizedName();
+  auto& shard = pluginShards_[GetShardIndex(normalizedName)];
 
-  auto normalizedName = NormalizeFilename(plugin.GetName());
+  // Normalize the masters' names before taking the index's lock, as it's
+  // shared by all plugins.
+  std::vector<std::string> normalizedMasters;
+  normalizedMasters.reserve(sharedPlugin->GetMastersRef().size());
+  for (const auto& master : sharedPlugin->GetMastersRef()) {
+    normalizedMasters.push_back(NormalizeFilename(master));
+  }
 
-  auto it = plugins_.find(normalizedName);
-  if (it != end(plugins_))
-    plugins_.erase(it);
+  {
+    unique_lock<shared_mutex> lock(masterIndexMutex_);
+    std::vector<uint32_t> masterIds;
+    masterIds.reserve(normalizedMasters.size());
+    for (const auto& master : normalizedMasters) {
+      masterIds.push_back(masterIndex_.Intern(master));
+    }
+    masterIndex_.SetMasters(masterIndex_.Intern(normalizedName),
+                            std::move(masterIds));
+  }
 
-  plugins_.emplace(normalizedName,
-                   std::make_shared<Plugin>(std::move(plugin)));
+  unique_lock<shared_mutex> lock(shard.mutex);
+  shard.plugins.insert_or_assign(normalizedName, std::move(sharedPlugin));
 }
 
-std::set<std::filesystem::path> GameCache::GetArchivePaths() const
-{
+std::optional<uint32_t> GameCache::GetPluginId(
+    const std::string& normalizedName) const {
+  shared_lock<shared_mutex> lock(masterIndexMutex_);
+  auto it = masterIndex_.ids.find(normalizedName);
+  if (it == masterIndex_.ids.end()) {
+    return std::nullopt;
+  }
+
+  return it->second;
+}
+
+std::vector<uint32_t> GameCache::GetMasterIds(uint32_t pluginId) const {
+  shared_lock<shared_mutex> lock(masterIndexMutex_);
+  if (pluginId >= masterIndex_.masters.size()) {
+    return {};
+  }
+
+  return masterIndex_.masters[pluginId];
+}
+
+std::vector<std::shared_ptr<const Plugin>> GameCache::GetDependentPlugins(
+    const std::string& pluginName) const {
+  std::vector<std::string> dependentNames;
+  {
+    shared_lock<shared_mutex> lock(masterIndexMutex_);
+    auto it = masterIndex_.ids.find(NormalizeFilename(pluginName));
+    if (it == masterIndex_.ids.end()) {
+      return {};
+    }
+
+    for (const auto dependentId : masterIndex_.dependents[it->second]) {
+      dependentNames.push_back(masterIndex_.names[dependentId]);
+    }
+  }
+
+  std::vector<std::shared_ptr<const Plugin>> dependents;
+  dependents.reserve(dependentNames.size());
+  for (const auto& dependentName : dependentNames) {
+    const auto& shard = pluginShards_[GetShardIndex(dependentName)];
+    shared_lock<shared_mutex> lock(shard.mutex);
+    auto it = shard.plugins.find(dependentName);
+    if (it != shard.plugins.end()) {
+      dependents.push_back(it->second);
+    }
+  }
+
+  return dependents;
+}
+
+std::shared_ptr<const Plugin> GameCache::GetUnchangedPlugin(
+    const std::string& pluginName,
+    bool headerOnly) const {
+  auto plugin = GetPlugin(pluginName);
+  if (plugin && plugin->IsHeaderOnly() == headerOnly &&
+      plugin->IsFileUnchanged()) {
+    return plugin;
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<const Plugin> GameCache::GetUnchangedPlugin(
+    const std::string& pluginName) const {
+  auto plugin = GetPlugin(pluginName);
+  if (plugin && plugin->IsFileUnchanged()) {
+    return plugin;
+  }
+
+  return nullptr;
+}
+
+std::set<std::filesystem::path> GameCache::GetArchivePaths() const {
+  shared_lock<shared_mutex> lock(mutex_);
+
   return archivePaths_;
 }
 
 void GameCache::CacheArchivePath(const std::filesystem::path& path)
 {
-  lock_guard<mutex> lock(mutex_);
+  unique_lock<shared_mutex> lock(mutex_);
 
   archivePaths_.insert(path);
+  normalizedArchiveFilenames_.insert(
+      NormalizeFilename(path.filename().u8string()));
+}
+
+bool GameCache::HasArchiveWithNormalizedPrefix(
+    const std::string& normalizedPrefix) const {
+  shared_lock<shared_mutex> lock(mutex_);
+
+  auto it = normalizedArchiveFilenames_.lower_bound(normalizedPrefix);
+
+  return it != normalizedArchiveFilenames_.end() &&
+         it->compare(0, normalizedPrefix.length(), normalizedPrefix) == 0;
+}
+
+PersistentPluginCache& GameCache::GetPersistentCache() {
+  return persistentCache_;
+}
+
+void GameCache::SetValidatedPlugins(
+    const std::vector<std::shared_ptr<const Plugin>>& plugins,
+    const std::set<std::filesystem::path>& archivePaths) {
+  unique_lock<shared_mutex> lock(mutex_);
+
+  validatedPlugins_.clear();
+  for (const auto& plugin : plugins) {
+    validatedPlugins_.insert_or_assign(plugin->GetNormalizedName(), plugin);
+  }
+  validatedArchivePaths_ = archivePaths;
+}
+
+std::shared_ptr<const Plugin> GameCache::GetUnchangedValidatedPlugin(
+    const std::string& pluginName) const {
+  std::shared_ptr<const Plugin> plugin;
+  {
+    shared_lock<shared_mutex> lock(mutex_);
+
+    if (validatedArchivePaths_ != archivePaths_) {
+      return nullptr;
+    }
+
+    auto it = validatedPlugins_.find(NormalizeFilename(pluginName));
+    if (it == validatedPlugins_.end()) {
+      return nullptr;
+    }
+    plugin = it->second;
+  }
+
+  return plugin->IsFileUnchanged() ? plugin : nullptr;
+}
+
+void GameCache::ClearValidatedPlugins() {
+  unique_lock<shared_mutex> lock(mutex_);
+
+  validatedPlugins_.clear();
+  validatedArchivePaths_.clear();
 }
 
 void GameCache::ClearCachedPlugins() {
-  lock_guard<mutex> guard(mutex_);
+  for (auto& shard : pluginShards_) {
+    unique_lock<shared_mutex> lock(shard.mutex);
+    shard.plugins.clear();
+  }
+
+  unique_lock<shared_mutex> lock(masterIndexMutex_);
+  masterIndex_ = MasterIndex();
+}
 
-  plugins_.clear();
+void GameCache::RetainPlugins(const std::vector<std::string>& pluginNames) {
+  std::unordered_set<std::string> normalizedNames;
+  for (const auto& pluginName : pluginNames) {
+    normalizedNames.insert(NormalizeFilename(pluginName));
+  }
+
+  std::vector<std::string> removedNames;
+  for (auto& shard : pluginShards_) {
+    unique_lock<shared_mutex> lock(shard.mutex);
+
+    for (auto it = shard.plugins.begin(); it != shard.plugins.end();) {
+      if (normalizedNames.count(it->first) == 0) {
+        removedNames.push_back(it->first);
+        it = shard.plugins.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  unique_lock<shared_mutex> lock(masterIndexMutex_);
+  for (const auto& name : removedNames) {
+    masterIndex_.SetMasters(masterIndex_.ids.at(name), {});
+  }
 }
 
 void GameCache::ClearCachedArchivePaths() {
-  lock_guard<mutex> guard(mutex_);
+  unique_lock<shared_mutex> guard(mutex_);
 
   archivePaths_.clear();
+  normalizedArchiveFilenames_.clear();
+}
+
+void GameCache::AddMemoryUsage(MemoryUsage& usage) const {
+  std::unordered_set<const Plugin*> countedPlugins;
+  size_t pluginsBytes = 0;
+  size_t recordsBytes = 0;
+  const auto countPlugin = [&](const std::shared_ptr<const Plugin>& plugin) {
+    if (countedPlugins.insert(plugin.get()).second) {
+      pluginsBytes += plugin->GetMemoryUsage();
+      recordsBytes += plugin->GetRecordsMemoryUsage();
+    }
+    // The plugin isn't part of the pointer's heap size.
+    return size_t(0);
+  };
+
+  size_t mapsBytes = 0;
+  for (const auto& shard : pluginShards_) {
+    shared_lock<shared_mutex> lock(shard.mutex);
+    mapsBytes += EstimateHeapSize(shard.plugins, countPlugin);
+  }
+
+  shared_lock<shared_mutex> lock(mutex_);
+  mapsBytes += EstimateHeapSize(validatedPlugins_, countPlugin);
+
+  {
+    shared_lock<shared_mutex> indexLock(masterIndexMutex_);
+    mapsBytes +=
+        EstimateHeapSize(masterIndex_.ids, [](uint32_t) { return 0; }) +
+        EstimateHeapSize(masterIndex_.names);
+    for (const auto* ids : {&masterIndex_.masters, &masterIndex_.dependents}) {
+      mapsBytes += ids->capacity() * sizeof(std::vector<uint32_t>);
+      for (const auto& pluginIds : *ids) {
+        mapsBytes += pluginIds.capacity() * sizeof(uint32_t);
+      }
+    }
+  }
+
+  usage.plugins +=
+      pluginsBytes + mapsBytes + persistentCache_.GetMemoryUsage();
+  usage.pluginRecords += recordsBytes;
+  usage.archivePaths += EstimateHeapSize(archivePaths_) +
+                        EstimateHeapSize(normalizedArchiveFilenames_) +
+                        EstimateHeapSize(validatedArchivePaths_);
+}
+
+size_t GameCache::GetShardIndex(const std::string& normalizedName) {
+  return std::hash<std::string>()(normalizedName) % NUM_PLUGIN_SHARDS;
+}
+
+void GameCache::CopyPlugins(const GameCache& cache) {
+  for (size_t i = 0; i < NUM_PLUGIN_SHARDS; ++i) {
+    shared_lock<shared_mutex> otherLock(cache.pluginShards_[i].mutex);
+    unique_lock<shared_mutex> lock(pluginShards_[i].mutex);
+    pluginShards_[i].plugins = cache.pluginShards_[i].plugins;
+  }
+
+  shared_lock<shared_mutex> otherLock(cache.masterIndexMutex_);
+  unique_lock<shared_mutex> lock(masterIndexMutex_);
+  masterIndex_ = cache.masterIndex_;
+}
+
+uint32_t GameCache::MasterIndex::Intern(const std::string& normalizedName) {
+  auto it = ids.emplace(normalizedName, static_cast<uint32_t>(names.size()));
+  if (it.second) {
+    names.push_back(normalizedName);
+    masters.emplace_back();
+    dependents.emplace_back();
+  }
+
+  return it.first->second;
+}
+
+void GameCache::MasterIndex::SetMasters(uint32_t pluginId,
+                                        std::vector<uint32_t>&& masterIds) {
+  for (const auto masterId : masters[pluginId]) {
+    auto& masterDependents = dependents[masterId];
+    masterDependents.erase(std::remove(masterDependents.begin(),
+                                       masterDependents.end(),
+                                       pluginId),
+                           masterDependents.end());
+  }
+
+  for (const auto masterId : masterIds) {
+    auto& masterDependents = dependents[masterId];
+    // A plugin may list the same master more than once.
+    if (std::find(masterDependents.begin(), masterDependents.end(), pluginId) ==
+        masterDependents.end()) {
+      masterDependents.push_back(pluginId);
+    }
+  }
+
+  masters[pluginId] = std::move(masterIds);
 }
 }
@@ -25,11 +25,20 @@
 #ifndef LOOT_API_GAME_GAME_CACHE
 #define LOOT_API_GAME_GAME_CACHE
 
+#include <array>
+#include <atomic>
+#include <functional>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "api/game/persistent_plugin_cache.h"
+#include "api/helpers/memory_resource.h"
 #include "api/plugin.h"
+#include "loot/struct/memory_usage.h"
 
 namespace loot {
 class GameCache {
@@ -40,20 +49,128 @@ public:
   GameCache& operator=(const GameCache& cache);
 
   std::set<std::shared_ptr<const Plugin>> GetPlugins() const;
+  // Calls the given function for each cached plugin, in no particular order,
+  // without copying all the plugin pointers into a new container. No locks are
+  // held while the function is called, so it may use the cache.
+  void ForEachPlugin(
+      const std::function<void(const std::shared_ptr<const Plugin>&)>&
+          callback) const;
+  size_t NumPlugins() const;
   std::shared_ptr<const Plugin> GetPlugin(const std::string& pluginName) const;
   void AddPlugin(const Plugin&& plugin);
 
+  // Cached plugins and the plugins that they list as masters are given ids
+  // when plugins are added, so that masters can be resolved without comparing
+  // filenames. Ids are stable until the cached plugins are cleared, including
+  // across reloads of the same plugin. Gets the id of the plugin with the
+  // given normalized filename, if it has one.
+  std::optional<uint32_t> GetPluginId(const std::string& normalizedName) const;
+  // Gets the ids of the masters of the cached plugin with the given id, in
+  // the order that the plugin lists them. This is empty if there is no such
+  // cached plugin.
+  std::vector<uint32_t> GetMasterIds(uint32_t pluginId) const;
+  // Gets the cached plugins that list the given plugin as a master, in no
+  // particular order. The master doesn't need to be cached itself.
+  std::vector<std::shared_ptr<const Plugin>> GetDependentPlugins(
+      const std::string& pluginName) const;
+
+  // Sets the memory resource that plugins added to the cache are allocated
+  // from. If it is null, they're allocated from the global memory resource.
+  void SetMemoryResource(pmr::memory_resource* resource);
+  pmr::memory_resource* GetMemoryResource() const;
+
+  // Get the cached plugin with the given name if it was loaded with the given
+  // header-only setting and its file has not changed since it was loaded.
+  // Returns a null pointer otherwise.
+  std::shared_ptr<const Plugin> GetUnchangedPlugin(
+      const std::string& pluginName,
+      bool headerOnly) const;
+  // Like the above, but whatever header-only setting the plugin was loaded
+  // with.
+  std::shared_ptr<const Plugin> GetUnchangedPlugin(
+      const std::string& pluginName) const;
+
   std::set<std::filesystem::path> GetArchivePaths() const;
   void CacheArchivePath(const std::filesystem::path& path);
+  // Checks if any cached archive's filename, normalized using
+  // NormalizeFilename(), starts with the given normalized prefix. This doesn't
+  // touch the filesystem.
+  bool HasArchiveWithNormalizedPrefix(
+      const std::string& normalizedPrefix) const;
+
+  // Data derived from plugin files that is kept between plugin loads, and
+  // which may be saved to and loaded from disk.
+  PersistentPluginCache& GetPersistentCache();
+
+  // Stores plugins that were loaded header-only to check that they're valid,
+  // along with the archive paths that were cached when they were loaded,
+  // replacing any previously stored plugins. They are kept separately from
+  // the cached plugins, as they have not been loaded.
+  void SetValidatedPlugins(
+      const std::vector<std::shared_ptr<const Plugin>>& plugins,
+      const std::set<std::filesystem::path>& archivePaths);
+  // Get the validated plugin with the given name if its file has not changed
+  // since it was loaded and it was loaded with the same archive paths as are
+  // currently cached. Returns a null pointer otherwise.
+  std::shared_ptr<const Plugin> GetUnchangedValidatedPlugin(
+      const std::string& pluginName) const;
+  void ClearValidatedPlugins();
 
   void ClearCachedPlugins();
+  // Discards all cached plugins apart from those with the given names.
+  void RetainPlugins(const std::vector<std::string>& pluginNames);
   void ClearCachedArchivePaths();
 
+  // Adds estimates of the memory used by the cached plugins, their records,
+  // the validated plugins, the persistent cache and the archive paths to the
+  // given usage. Plugins that are both cached and validated are only counted
+  // once.
+  void AddMemoryUsage(MemoryUsage& usage) const;
+
 private:
-  std::unordered_map<std::string, std::shared_ptr<const Plugin>> plugins_;
+  // Cached plugins are split between shards by the hash of their normalized
+  // filenames, and each shard has its own lock, so that plugins can be added
+  // from many threads at once and read while a load is in progress without
+  // every call waiting on the same lock.
+  struct PluginShard {
+    std::unordered_map<std::string, std::shared_ptr<const Plugin>> plugins;
+    mutable std::shared_mutex mutex;
+  };
+
+  static constexpr size_t NUM_PLUGIN_SHARDS = 16;
+
+  // Forward and reverse indexes of the masters of the cached plugins,
+  // indexed by plugin id.
+  struct MasterIndex {
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> names;
+    std::vector<std::vector<uint32_t>> masters;
+    std::vector<std::vector<uint32_t>> dependents;
+
+    uint32_t Intern(const std::string& normalizedName);
+    // Replaces the masters recorded for the given plugin.
+    void SetMasters(uint32_t pluginId, std::vector<uint32_t>&& masterIds);
+  };
+
+  static size_t GetShardIndex(const std::string& normalizedName);
+  void CopyPlugins(const GameCache& cache);
+
+  std::array<PluginShard, NUM_PLUGIN_SHARDS> pluginShards_;
+  MasterIndex masterIndex_;
+  mutable std::shared_mutex masterIndexMutex_;
   std::set<std::filesystem::path> archivePaths_;
-
-  mutable std::mutex mutex_;
+  // Sorted so that archives sharing a prefix are adjacent.
+  std::set<std::string> normalizedArchiveFilenames_;
+  PersistentPluginCache persistentCache_;
+  std::atomic<pmr::memory_resource*> memoryResource_;
+  // Keyed by normalized filename.
+  std::unordered_map<std::string, std::shared_ptr<const Plugin>>
+      validatedPlugins_;
+  std::set<std::filesystem::path> validatedArchivePaths_;
+
+  // Guards the archive paths and validated plugins, as the archive paths are
+  // read while plugins are being loaded.
+  mutable std::shared_mutex mutex_;
 };
 }
 
@@ -0,0 +1,159 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#include "api/game/game_policy.h"
+
+#include <array>
+#include <stdexcept>
+
+#include <esplugin.hpp>
+#include <libloadorder.hpp>
+#include <loot_condition_interpreter.h>
+
+namespace loot {
+namespace {
+// Checks if the first length characters of text end with the given
+// lowercase ASCII suffix, ignoring ASCII case.
+bool EndsWithLowercaseSuffix(const std::string& text,
+                             size_t length,
+                             const char* suffix,
+                             size_t suffixLength) {
+  if (suffixLength > length) {
+    return false;
+  }
+
+  const char* start = text.data() + length - suffixLength;
+  for (size_t i = 0; i < suffixLength; ++i) {
+    char c = start[i];
+    if (c >= 'A' && c <= 'Z') {
+      c = c - 'A' + 'a';
+    }
+    if (c != suffix[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+}
+
+bool GamePolicy::HasPluginFileExtension(const std::string& filename) const {
+  auto length = filename.length();
+  if (EndsWithLowercaseSuffix(filename, length, ".ghost", 6)) {
+    length -= 6;
+  }
+
+  return EndsWithLowercaseSuffix(filename, length, ".esp", 4) ||
+         EndsWithLowercaseSuffix(filename, length, ".esm", 4) ||
+         (supportsLightPlugins &&
+          EndsWithLowercaseSuffix(filename, length, ".esl", 4));
+}
+
+const GamePolicy& GetGamePolicy(GameType gameType) {
+  // Indexed by the GameType value.
+  static const std::array<GamePolicy, 9> GAME_POLICIES = {{
+      {GameType::tes4,
+       "Data",
+       ".bsa",
+       ArchiveMatching::espBasenamePrefix,
+       false,
+       ESP_GAME_OBLIVION,
+       LIBLO_GAME_TES4,
+       LCI_GAME_OBLIVION},
+      {GameType::tes5,
+       "Data",
+       ".bsa",
+       ArchiveMatching::exactBasename,
+       false,
+       ESP_GAME_SKYRIM,
+       LIBLO_GAME_TES5,
+       LCI_GAME_SKYRIM},
+      {GameType::fo3,
+       "Data",
+       ".bsa",
+       ArchiveMatching::basenamePrefix,
+       false,
+       ESP_GAME_FALLOUT3,
+       LIBLO_GAME_FO3,
+       LCI_GAME_FALLOUT_3},
+      {GameType::fonv,
+       "Data",
+       ".bsa",
+       ArchiveMatching::basenamePrefix,
+       false,
+       ESP_GAME_FALLOUTNV,
+       LIBLO_GAME_FNV,
+       LCI_GAME_FALLOUT_NV},
+      {GameType::fo4,
+       "Data",
+       ".ba2",
+       ArchiveMatching::basenamePrefix,
+       true,
+       ESP_GAME_FALLOUT4,
+       LIBLO_GAME_FO4,
+       LCI_GAME_FALLOUT_4},
+      {GameType::tes5se,
+       "Data",
+       ".bsa",
+       ArchiveMatching::basenamePrefix,
+       true,
+       ESP_GAME_SKYRIMSE,
+       LIBLO_GAME_TES5SE,
+       LCI_GAME_SKYRIM_SE},
+      // esplugin has no ids for the VR games, so they use the Fallout 4 id.
+      {GameType::fo4vr,
+       "Data",
+       ".ba2",
+       ArchiveMatching::basenamePrefix,
+       true,
+       ESP_GAME_FALLOUT4,
+       LIBLO_GAME_FO4VR,
+       LCI_GAME_FALLOUT_4_VR},
+      {GameType::tes5vr,
+       "Data",
+       ".bsa",
+       ArchiveMatching::basenamePrefix,
+       true,
+       ESP_GAME_FALLOUT4,
+       LIBLO_GAME_TES5VR,
+       LCI_GAME_SKYRIM_VR},
+      {GameType::tes3,
+       "Data Files",
+       ".bsa",
+       ArchiveMatching::none,
+       false,
+       ESP_GAME_MORROWIND,
+       LIBLO_GAME_TES3,
+       LCI_GAME_MORROWIND},
+  }};
+
+  const auto index = static_cast<size_t>(gameType);
+  if (index >= GAME_POLICIES.size()) {
+    throw std::invalid_argument("Unrecognised game type: " +
+                                std::to_string(index));
+  }
+
+  return GAME_POLICIES[index];
+}
+}
@@ -0,0 +1,74 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_API_GAME_GAME_POLICY
+#define LOOT_API_GAME_GAME_POLICY
+
+#include <string>
+
+#include "loot/enum/game_type.h"
+
+namespace loot {
+// How a game decides which archives a plugin loads.
+enum struct ArchiveMatching {
+  // Plugins don't load archives.
+  none,
+  // Plugins only load the archive that exactly matches their basename.
+  exactBasename,
+  // Plugins load archives that begin with their basename.
+  basenamePrefix,
+  // Like basenamePrefix, but only .esp plugins load archives.
+  espBasenamePrefix,
+};
+
+// The behaviour that differs between games, so that code that runs once per
+// plugin or per file can look it up once instead of switching on the game
+// type each time.
+struct GamePolicy {
+  GameType gameType;
+  // The name of the data directory within the game's install directory.
+  std::string dataDirectoryName;
+  // Includes the leading period.
+  std::string archiveFileExtension;
+  ArchiveMatching archiveMatching;
+  // True if .esl files are plugins.
+  bool supportsLightPlugins;
+
+  // The ids that identify the game to esplugin, libloadorder and
+  // loot-condition-interpreter.
+  unsigned int espluginGameId;
+  unsigned int libloadorderGameId;
+  int lciGameId;
+
+  // Checks if the filename ends in a plugin file extension, optionally
+  // followed by .ghost.
+  bool HasPluginFileExtension(const std::string& filename) const;
+};
+
+// The returned reference is valid for the lifetime of the program. Throws
+// std::invalid_argument if the game type isn't recognised.
+const GamePolicy& GetGamePolicy(GameType gameType);
+}
+
+#endif
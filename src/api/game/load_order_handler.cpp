@@ -24,37 +24,13 @@
 
 #include "api/game/load_order_handler.h"
 
+#include "api/game/game_policy.h"
 #include "api/helpers/logging.h"
 #include "loot/exception/error_categories.h"
 
 using std::string;
 
 namespace loot {
-unsigned int mapGameId(GameType gameType) {
-  switch (gameType) {
-  case GameType::tes3:
-    return LIBLO_GAME_TES3;
-  case GameType::tes4:
-    return LIBLO_GAME_TES4;
-  case GameType::tes5:
-    return LIBLO_GAME_TES5;
-  case GameType::tes5se:
-    return LIBLO_GAME_TES5SE;
-  case GameType::tes5vr:
-    return LIBLO_GAME_TES5VR;
-  case GameType::fo3:
-    return LIBLO_GAME_FO3;
-  case GameType::fonv:
-    return LIBLO_GAME_FNV;
-  case GameType::fo4:
-    return LIBLO_GAME_FO4;
-  case GameType::fo4vr:
-    return LIBLO_GAME_FO4VR;
-  default:
-    return (unsigned int)-1;
-  }
-}
-
 LoadOrderHandler::LoadOrderHandler() : gh_(nullptr) {}
 
 LoadOrderHandler::~LoadOrderHandler() { lo_destroy_handle(gh_); }
@@ -71,6 +47,11 @@ void LoadOrderHandler::Init(const GameType& gameType,
   if (!tempPathString.empty())
     gameLocalDataPath = tempPathString.c_str();
 
+  {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    state_.reset();
+  }
+
   // If the handle has already been initialised, close it and open another.
   if (gh_ != nullptr) {
     lo_destroy_handle(gh_);
@@ -78,7 +59,7 @@ void LoadOrderHandler::Init(const GameType& gameType,
   }
 
   int ret = lo_create_handle(
-    &gh_, mapGameId(gameType), gamePath.u8string().c_str(), gameLocalDataPath);
+    &gh_, GetGamePolicy(gameType).libloadorderGameId, gamePath.u8string().c_str(), gameLocalDataPath);
 
   HandleError("create a game handle", ret);
 }
@@ -92,6 +73,21 @@ void LoadOrderHandler::LoadCurrentState() {
   unsigned int ret = lo_load_current_state(gh_);
 
   HandleError("load the current load order state", ret);
+
+  auto state = ReadState();
+
+  std::lock_guard<std::mutex> lock(stateMutex_);
+  state_ = state;
+}
+
+std::shared_ptr<const LoadOrderState> LoadOrderHandler::GetState() const {
+  std::lock_guard<std::mutex> lock(stateMutex_);
+
+  if (!state_) {
+    state_ = ReadState();
+  }
+
+  return state_;
 }
 
 bool LoadOrderHandler::IsPluginActive(const std::string& pluginName) const {
@@ -100,12 +96,7 @@ bool LoadOrderHandler::IsPluginActive(const std::string& pluginName) const {
     logger->trace("Checking if plugin \"{}\" is active.", pluginName);
   }
 
-  bool result = false;
-  unsigned int ret = lo_get_plugin_active(gh_, pluginName.c_str(), &result);
-
-  HandleError("check if a plugin is active", ret);
-
-  return result;
+  return GetState()->IsPluginActive(pluginName);
 }
 
 std::vector<std::string> LoadOrderHandler::GetLoadOrder() const {
@@ -114,17 +105,7 @@ std::vector<std::string> LoadOrderHandler::GetLoadOrder() const {
     logger->trace("Getting load order.");
   }
 
-  char** pluginArr;
-  size_t pluginArrSize;
-
-  unsigned int ret = lo_get_load_order(gh_, &pluginArr, &pluginArrSize);
-
-  HandleError("get the load order", ret);
-
-  std::vector<string> loadOrder(pluginArr, pluginArr + pluginArrSize);
-  lo_free_string_array(pluginArr, pluginArrSize);
-
-  return loadOrder;
+  return GetState()->GetLoadOrder();
 }
 
 std::vector<std::string> LoadOrderHandler::GetActivePlugins() const {
@@ -133,18 +114,7 @@ std::vector<std::string> LoadOrderHandler::GetActivePlugins() const {
     logger->trace("Getting active plugins.");
   }
 
-  char** pluginArr;
-  size_t pluginArrSize;
-
-  unsigned int ret =
-    lo_get_active_plugins(gh_, &pluginArr, &pluginArrSize);
-
-  HandleError("get active plugins", ret);
-
-  std::vector<string> loadOrder(pluginArr, pluginArr + pluginArrSize);
-  lo_free_string_array(pluginArr, pluginArrSize);
-
-  return loadOrder;
+  return GetState()->GetActivePlugins();
 }
 
 std::vector<std::string> LoadOrderHandler::GetImplicitlyActivePlugins() const {
@@ -153,50 +123,126 @@ std::vector<std::string> LoadOrderHandler::GetImplicitlyActivePlugins() const {
     logger->trace("Getting implicitly active plugins.");
   }
 
-  char** pluginArr;
-  size_t pluginArrSize;
-
-  unsigned int ret =
-      lo_get_implicitly_active_plugins(gh_, &pluginArr, &pluginArrSize);
-
-  HandleError("get implicitly active plugins", ret);
-
-  std::vector<string> loadOrder(pluginArr, pluginArr + pluginArrSize);
-  lo_free_string_array(pluginArr, pluginArrSize);
-
-  return loadOrder;
+  return GetState()->GetImplicitlyActivePlugins();
 }
 
-void LoadOrderHandler::SetLoadOrder(
+std::vector<std::string> LoadOrderHandler::SetLoadOrder(
     const std::vector<std::string>& loadOrder) const {
   auto logger = getLogger();
   if (logger) {
     logger->info("Setting load order.");
   }
 
-  size_t pluginArrSize = loadOrder.size();
-  char** pluginArr = new char*[pluginArrSize];
-  int i = 0;
-  for (const auto& plugin : loadOrder) {
+  // Setting the load order can rewrite the load order files, or for
+  // timestamp-based games, change the modification time of every plugin, so
+  // avoid it if the load order wouldn't change. The cached snapshot may be
+  // older than the files on disk, so compare against the current state, and
+  // always set an ambiguous load order so that it gets written unambiguously.
+  auto state = RefreshState();
+  auto movedPlugins = state->GetMovedPlugins(loadOrder);
+
+  bool isAmbiguous = true;
+  unsigned int ret = lo_is_ambiguous(gh_, &isAmbiguous);
+  HandleError("check if the load order is ambiguous", ret);
+
+  if (!isAmbiguous && movedPlugins.empty() &&
+      loadOrder.size() == state->GetLoadOrder().size()) {
     if (logger) {
+      logger->info("The load order is unchanged, so it was not set.");
+    }
+    return movedPlugins;
+  }
+
+  if (logger) {
+    logger->info("Moving {} of {} plugins:",
+                 movedPlugins.size(),
+                 loadOrder.size());
+    for (const auto& plugin : movedPlugins) {
       logger->info("\t\t{}", plugin);
     }
+  }
 
+  size_t pluginArrSize = loadOrder.size();
+  char** pluginArr = new char*[pluginArrSize];
+  int i = 0;
+  for (const auto& plugin : loadOrder) {
     pluginArr[i] = new char[plugin.length() + 1];
     strcpy(pluginArr[i], plugin.c_str());
     ++i;
   }
 
-  unsigned int ret = lo_set_load_order(gh_, pluginArr, pluginArrSize);
+  ret = lo_set_load_order(gh_, pluginArr, pluginArrSize);
 
   for (size_t i = 0; i < pluginArrSize; i++) delete[] pluginArr[i];
   delete[] pluginArr;
 
+  // Whether or not the load order was set, the snapshot may now be out of
+  // date, so discard it and take another the next time it's needed.
+  {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    state_.reset();
+  }
+
   HandleError("set the load order", ret);
 
   if (logger) {
     logger->info("Load order set successfully.");
   }
+
+  return movedPlugins;
+}
+
+std::shared_ptr<const LoadOrderState> LoadOrderHandler::RefreshState() const {
+  unsigned int ret = lo_load_current_state(gh_);
+  HandleError("load the current load order state", ret);
+
+  auto state = ReadState();
+
+  // Keep the existing snapshot if nothing has changed, so that it stays
+  // shared with anything that already holds it.
+  std::lock_guard<std::mutex> lock(stateMutex_);
+  if (!state_ || state_->GetLoadOrder() != state->GetLoadOrder() ||
+      state_->GetActivePlugins() != state->GetActivePlugins() ||
+      state_->GetImplicitlyActivePlugins() !=
+          state->GetImplicitlyActivePlugins()) {
+    state_ = state;
+  }
+
+  return state_;
+}
+
+std::shared_ptr<const LoadOrderState> LoadOrderHandler::ReadState() const {
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Reading the load order state from libloadorder.");
+  }
+
+  char** pluginArr;
+  size_t pluginArrSize;
+
+  unsigned int ret = lo_get_load_order(gh_, &pluginArr, &pluginArrSize);
+  HandleError("get the load order", ret);
+
+  std::vector<string> loadOrder(pluginArr, pluginArr + pluginArrSize);
+  lo_free_string_array(pluginArr, pluginArrSize);
+
+  ret = lo_get_active_plugins(gh_, &pluginArr, &pluginArrSize);
+  HandleError("get active plugins", ret);
+
+  std::vector<string> activePlugins(pluginArr, pluginArr + pluginArrSize);
+  lo_free_string_array(pluginArr, pluginArrSize);
+
+  ret = lo_get_implicitly_active_plugins(gh_, &pluginArr, &pluginArrSize);
+  HandleError("get implicitly active plugins", ret);
+
+  std::vector<string> implicitlyActivePlugins(pluginArr,
+                                              pluginArr + pluginArrSize);
+  lo_free_string_array(pluginArr, pluginArrSize);
+
+  return std::make_shared<const LoadOrderState>(
+      std::move(loadOrder),
+      std::move(activePlugins),
+      std::move(implicitlyActivePlugins));
 }
 
 void LoadOrderHandler::HandleError(const std::string& operation,
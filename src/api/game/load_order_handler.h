@@ -27,12 +27,15 @@
 
 #include <filesystem>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include <libloadorder.hpp>
 
+#include "api/game/load_order_state.h"
 #include "loot/enum/game_type.h"
 
 namespace loot {
@@ -47,6 +50,11 @@ public:
 
   void LoadCurrentState();
 
+  // Get a snapshot of libloadorder's load order state. The snapshot is taken
+  // when the current state is loaded, or the first time it's needed after the
+  // load order is set, and is shared until the state next changes.
+  std::shared_ptr<const LoadOrderState> GetState() const;
+
   std::vector<std::string> GetLoadOrder() const;
 
   std::vector<std::string> GetActivePlugins() const;
@@ -55,12 +63,23 @@ public:
 
   bool IsPluginActive(const std::string& pluginName) const;
 
-  void SetLoadOrder(const std::vector<std::string>& loadOrder) const;
+  // Set the load order, returning the plugins that were moved or added, as
+  // given by LoadOrderState::GetMovedPlugins(). The current state is loaded
+  // first, and if it already has the given load order and that load order is
+  // unambiguous, nothing is written.
+  std::vector<std::string> SetLoadOrder(
+      const std::vector<std::string>& loadOrder) const;
 
 private:
+  // Load the current state from disk and update the snapshot with it.
+  std::shared_ptr<const LoadOrderState> RefreshState() const;
+  std::shared_ptr<const LoadOrderState> ReadState() const;
   void HandleError(const std::string& operation, unsigned int returnCode) const;
 
   lo_game_handle gh_;
+
+  mutable std::mutex stateMutex_;
+  mutable std::shared_ptr<const LoadOrderState> state_;
 };
 }
 
@@ -0,0 +1,136 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/game/load_order_state.h"
+
+#include <algorithm>
+
+#include "api/helpers/text.h"
+
+namespace loot {
+LoadOrderState::LoadOrderState() {}
+
+LoadOrderState::LoadOrderState(
+    std::vector<std::string> loadOrder,
+    std::vector<std::string> activePlugins,
+    std::vector<std::string> implicitlyActivePlugins) :
+    loadOrder_(std::move(loadOrder)),
+    activePlugins_(std::move(activePlugins)),
+    implicitlyActivePlugins_(std::move(implicitlyActivePlugins)),
+    isActive_(loadOrder_.size(), false) {
+  loadOrderIndices_.reserve(loadOrder_.size());
+  for (size_t i = 0; i < loadOrder_.size(); ++i) {
+    loadOrderIndices_.emplace(NormalizeFilename(loadOrder_[i]), i);
+  }
+
+  for (const auto& plugin : activePlugins_) {
+    auto index = GetLoadOrderIndex(plugin);
+    if (index.has_value()) {
+      isActive_[index.value()] = true;
+    }
+  }
+}
+
+const std::vector<std::string>& LoadOrderState::GetLoadOrder() const {
+  return loadOrder_;
+}
+
+const std::vector<std::string>& LoadOrderState::GetActivePlugins() const {
+  return activePlugins_;
+}
+
+const std::vector<std::string>& LoadOrderState::GetImplicitlyActivePlugins()
+    const {
+  return implicitlyActivePlugins_;
+}
+
+bool LoadOrderState::IsPluginActive(const std::string& pluginName) const {
+  auto index = GetLoadOrderIndex(pluginName);
+
+  return index.has_value() && isActive_[index.value()];
+}
+
+std::optional<size_t> LoadOrderState::GetLoadOrderIndex(
+    const std::string& pluginName) const {
+  auto it = loadOrderIndices_.find(NormalizeFilename(pluginName));
+  if (it == loadOrderIndices_.end()) {
+    return std::nullopt;
+  }
+
+  return it->second;
+}
+
+std::vector<std::string> LoadOrderState::GetMovedPlugins(
+    const std::vector<std::string>& loadOrder) const {
+  static constexpr size_t NO_PREDECESSOR = static_cast<size_t>(-1);
+
+  // Find the longest subsequence of the given load order whose plugins have
+  // increasing indices in this load order. tails[k] is the position in the
+  // given load order of the last plugin in the best subsequence found so far
+  // of length k + 1.
+  std::vector<std::optional<size_t>> indices;
+  indices.reserve(loadOrder.size());
+  std::vector<size_t> tails;
+  std::vector<size_t> predecessors(loadOrder.size(), NO_PREDECESSOR);
+  for (size_t i = 0; i < loadOrder.size(); ++i) {
+    indices.push_back(GetLoadOrderIndex(loadOrder[i]));
+    if (!indices.back().has_value()) {
+      continue;
+    }
+
+    const auto index = indices.back().value();
+    auto it = std::lower_bound(
+        tails.begin(), tails.end(), index, [&](size_t tail, size_t value) {
+          return indices[tail].value() < value;
+        });
+
+    if (it != tails.begin()) {
+      predecessors[i] = *std::prev(it);
+    }
+
+    if (it == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *it = i;
+    }
+  }
+
+  std::vector<bool> isInPlace(loadOrder.size(), false);
+  if (!tails.empty()) {
+    for (size_t i = tails.back(); i != NO_PREDECESSOR; i = predecessors[i]) {
+      isInPlace[i] = true;
+    }
+  }
+
+  std::vector<std::string> movedPlugins;
+  for (size_t i = 0; i < loadOrder.size(); ++i) {
+    if (!isInPlace[i]) {
+      movedPlugins.push_back(loadOrder[i]);
+    }
+  }
+
+  return movedPlugins;
+}
+}
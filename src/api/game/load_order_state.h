@@ -0,0 +1,78 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_GAME_LOAD_ORDER_STATE
+#define LOOT_API_GAME_LOAD_ORDER_STATE
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace loot {
+// An immutable copy of libloadorder's load order state, so that it can be
+// read repeatedly without calling into libloadorder and copying its string
+// arrays each time.
+//
+// Plugins are looked up by name case-insensitively, like libloadorder does.
+class LoadOrderState {
+public:
+  LoadOrderState();
+  LoadOrderState(std::vector<std::string> loadOrder,
+                 std::vector<std::string> activePlugins,
+                 std::vector<std::string> implicitlyActivePlugins);
+
+  const std::vector<std::string>& GetLoadOrder() const;
+
+  const std::vector<std::string>& GetActivePlugins() const;
+
+  const std::vector<std::string>& GetImplicitlyActivePlugins() const;
+
+  bool IsPluginActive(const std::string& pluginName) const;
+
+  // Get the given plugin's index in the load order, if it is in the load
+  // order.
+  std::optional<size_t> GetLoadOrderIndex(const std::string& pluginName) const;
+
+  // Get the plugins in the given load order that are not in this load order,
+  // or that would need to move to turn this load order into the given one,
+  // in the order they appear in the given load order. The plugins that don't
+  // need to move are the longest run of plugins that are already in the
+  // same relative order, so as few plugins as possible are listed.
+  std::vector<std::string> GetMovedPlugins(
+      const std::vector<std::string>& loadOrder) const;
+
+private:
+  std::vector<std::string> loadOrder_;
+  std::vector<std::string> activePlugins_;
+  std::vector<std::string> implicitlyActivePlugins_;
+  // Parallel to loadOrder_.
+  std::vector<bool> isActive_;
+  // Maps normalised plugin names to their indices in loadOrder_.
+  std::unordered_map<std::string, size_t> loadOrderIndices_;
+};
+}
+
+#endif
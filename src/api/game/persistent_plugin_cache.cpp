@@ -0,0 +1,451 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#include "api/game/persistent_plugin_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "api/helpers/cache_file.h"
+#include "api/helpers/crc.h"
+#include "api/helpers/file_identity.h"
+#include "api/helpers/logging.h"
+#include "api/helpers/memory_usage.h"
+#include "loot/exception/file_access_error.h"
+
+using std::lock_guard;
+using std::mutex;
+
+namespace loot {
+namespace {
+constexpr char CACHE_MAGIC[8] = {'L', 'O', 'O', 'T', 'P', 'L', 'C', '\0'};
+constexpr uint32_t CACHE_VERSION = 5;
+// Entries that go unused for this many consecutive saves are dropped, so that
+// the cache doesn't keep growing as plugins are updated.
+constexpr uint32_t MAX_UNUSED_SAVES = 64;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t entryCount;
+  // The CRC-32 of everything after the header.
+  uint32_t payloadCrc;
+};
+
+// Flags that record which of an entry's values are known.
+constexpr uint32_t HAS_CRC = 1;
+constexpr uint32_t HAS_LIGHT_MASTER_VALIDITY = 2;
+constexpr uint32_t IS_VALID_AS_LIGHT_MASTER = 4;
+
+struct FileEntry {
+  uint64_t fileSize;
+  int64_t modificationTime;
+  uint64_t device;
+  uint64_t fileId;
+  uint32_t crc;
+  uint32_t pathOffset;
+  uint32_t pathLength;
+  uint32_t unusedSaves;
+  uint32_t flags;
+  // Keeps the entry size a multiple of its alignment without implicit
+  // padding, so that nothing uninitialised is written.
+  uint32_t reserved;
+};
+
+template<typename T>
+T ReadAt(const std::vector<char>& buffer, size_t offset) {
+  T value;
+  std::memcpy(&value, buffer.data() + offset, sizeof(T));
+  return value;
+}
+
+template<typename T>
+void Append(std::vector<char>& buffer, const T& value) {
+  auto bytes = reinterpret_cast<const char*>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+}
+
+PersistentPluginCache::PersistentPluginCache() : isModified_(false) {}
+
+PersistentPluginCache::PersistentPluginCache(
+    const PersistentPluginCache& cache) {
+  lock_guard<mutex> guard(cache.mutex_);
+  entries_ = cache.entries_;
+  isModified_ = cache.isModified_;
+}
+
+PersistentPluginCache& PersistentPluginCache::operator=(
+    const PersistentPluginCache& cache) {
+  if (&cache != this) {
+    std::scoped_lock guard(mutex_, cache.mutex_);
+    entries_ = cache.entries_;
+    isModified_ = cache.isModified_;
+  }
+
+  return *this;
+}
+
+std::optional<uint32_t> PersistentPluginCache::GetCrc(
+    const std::filesystem::path& pluginPath,
+    uintmax_t fileSize,
+    std::filesystem::file_time_type modificationTime) const {
+  auto fileIdentity = GetFileIdentity(pluginPath);
+  if (!fileIdentity) {
+    return std::nullopt;
+  }
+
+  lock_guard<mutex> guard(mutex_);
+
+  auto entry =
+      FindEntry(pluginPath, *fileIdentity, fileSize, modificationTime);
+  return entry ? entry->crc : std::nullopt;
+}
+
+void PersistentPluginCache::SetCrc(
+    const std::filesystem::path& pluginPath,
+    uintmax_t fileSize,
+    std::filesystem::file_time_type modificationTime,
+    uint32_t crc) {
+  auto fileIdentity = GetFileIdentity(pluginPath);
+  if (!fileIdentity) {
+    return;
+  }
+
+  lock_guard<mutex> guard(mutex_);
+
+  GetOrAddEntry(pluginPath, *fileIdentity, fileSize, modificationTime).crc =
+      crc;
+}
+
+std::optional<bool> PersistentPluginCache::GetIsValidAsLightMaster(
+    const std::filesystem::path& pluginPath,
+    uintmax_t fileSize,
+    std::filesystem::file_time_type modificationTime) const {
+  auto fileIdentity = GetFileIdentity(pluginPath);
+  if (!fileIdentity) {
+    return std::nullopt;
+  }
+
+  lock_guard<mutex> guard(mutex_);
+
+  auto entry =
+      FindEntry(pluginPath, *fileIdentity, fileSize, modificationTime);
+  return entry ? entry->isValidAsLightMaster : std::nullopt;
+}
+
+void PersistentPluginCache::SetIsValidAsLightMaster(
+    const std::filesystem::path& pluginPath,
+    uintmax_t fileSize,
+    std::filesystem::file_time_type modificationTime,
+    bool isValidAsLightMaster) {
+  auto fileIdentity = GetFileIdentity(pluginPath);
+  if (!fileIdentity) {
+    return;
+  }
+
+  lock_guard<mutex> guard(mutex_);
+
+  GetOrAddEntry(pluginPath, *fileIdentity, fileSize, modificationTime)
+      .isValidAsLightMaster = isValidAsLightMaster;
+}
+
+void PersistentPluginCache::Load(const std::filesystem::path& cacheFilePath) {
+  lock_guard<mutex> guard(mutex_);
+
+  entries_.clear();
+  isModified_ = false;
+
+  if (!std::filesystem::exists(cacheFilePath)) {
+    return;
+  }
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Loading plugin cache from: {}", cacheFilePath.u8string());
+  }
+
+  std::vector<char> buffer;
+  try {
+    std::ifstream in(cacheFilePath, std::ios::binary);
+    in.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+
+    buffer.resize(std::filesystem::file_size(cacheFilePath));
+    in.read(buffer.data(), buffer.size());
+  } catch (std::exception& e) {
+    if (logger) {
+      logger->warn("Unable to read plugin cache file \"{}\". Details: {}",
+                   cacheFilePath.u8string(),
+                   e.what());
+    }
+    return;
+  }
+
+  if (buffer.size() < sizeof(FileHeader)) {
+    if (logger) {
+      logger->warn("Ignoring truncated plugin cache file: {}",
+                   cacheFilePath.u8string());
+    }
+    return;
+  }
+
+  auto header = ReadAt<FileHeader>(buffer, 0);
+  if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+      header.version != CACHE_VERSION) {
+    if (logger) {
+      logger->warn("Ignoring plugin cache file with unrecognised format: {}",
+                   cacheFilePath.u8string());
+    }
+    return;
+  }
+
+  auto pathsOffset =
+      sizeof(FileHeader) + (size_t)header.entryCount * sizeof(FileEntry);
+  if (buffer.size() < pathsOffset) {
+    if (logger) {
+      logger->warn("Ignoring truncated plugin cache file: {}",
+                   cacheFilePath.u8string());
+    }
+    return;
+  }
+
+  auto payloadCrc = UpdateCrc32(0,
+                                buffer.data() + sizeof(FileHeader),
+                                buffer.size() - sizeof(FileHeader));
+  if (payloadCrc != header.payloadCrc) {
+    if (logger) {
+      logger->warn("Ignoring corrupt plugin cache file: {}",
+                   cacheFilePath.u8string());
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < header.entryCount; ++i) {
+    auto entry =
+        ReadAt<FileEntry>(buffer, sizeof(FileHeader) + i * sizeof(FileEntry));
+
+    if (pathsOffset + entry.pathOffset + entry.pathLength > buffer.size()) {
+      if (logger) {
+        logger->warn("Ignoring corrupt plugin cache file: {}",
+                     cacheFilePath.u8string());
+      }
+      entries_.clear();
+      return;
+    }
+
+    std::string path(buffer.data() + pathsOffset + entry.pathOffset,
+                     entry.pathLength);
+    auto modificationTime = std::filesystem::file_time_type(
+        std::filesystem::file_time_type::duration(entry.modificationTime));
+
+    std::optional<uint32_t> crc;
+    if (entry.flags & HAS_CRC) {
+      crc = entry.crc;
+    }
+    std::optional<bool> isValidAsLightMaster;
+    if (entry.flags & HAS_LIGHT_MASTER_VALIDITY) {
+      isValidAsLightMaster = (entry.flags & IS_VALID_AS_LIGHT_MASTER) != 0;
+    }
+
+    entries_[path].push_back(Entry{(uintmax_t)entry.fileSize,
+                                   modificationTime,
+                                   FileIdentity{entry.device, entry.fileId},
+                                   crc,
+                                   isValidAsLightMaster,
+                                   entry.unusedSaves,
+                                   false});
+  }
+
+  MarkCacheFileUsed(cacheFilePath);
+
+  if (logger) {
+    logger->debug("Loaded {} entries from the plugin cache.",
+                  header.entryCount);
+  }
+}
+
+void PersistentPluginCache::Save(const std::filesystem::path& cacheFilePath) {
+  lock_guard<mutex> guard(mutex_);
+
+  size_t entryCount = 0;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto& entries = it->second;
+    for (auto& entry : entries) {
+      entry.unusedSaves = entry.isUsed ? 0 : entry.unusedSaves + 1;
+      entry.isUsed = false;
+    }
+    entries.erase(std::remove_if(entries.begin(),
+                                 entries.end(),
+                                 [](const Entry& entry) {
+                                   return entry.unusedSaves > MAX_UNUSED_SAVES;
+                                 }),
+                  entries.end());
+
+    if (entries.empty()) {
+      it = entries_.erase(it);
+    } else {
+      entryCount += entries.size();
+      ++it;
+    }
+  }
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Saving {} entries to the plugin cache at: {}",
+                  entryCount,
+                  cacheFilePath.u8string());
+  }
+
+  // The entries and filenames are built up in memory first so that their CRC
+  // can be written in the header.
+  std::vector<char> payload;
+  payload.reserve(entryCount * sizeof(FileEntry));
+
+  // Each filename is only written once, and shared by all its entries.
+  uint32_t pathOffset = 0;
+  for (const auto& pair : entries_) {
+    for (const auto& cachedEntry : pair.second) {
+      FileEntry entry;
+      entry.fileSize = cachedEntry.fileSize;
+      entry.modificationTime =
+          cachedEntry.modificationTime.time_since_epoch().count();
+      entry.device = cachedEntry.fileIdentity.device;
+      entry.fileId = cachedEntry.fileIdentity.file;
+      entry.crc = cachedEntry.crc.value_or(0);
+      entry.pathOffset = pathOffset;
+      entry.pathLength = (uint32_t)pair.first.size();
+      entry.unusedSaves = cachedEntry.unusedSaves;
+      entry.flags = 0;
+      if (cachedEntry.crc.has_value()) {
+        entry.flags |= HAS_CRC;
+      }
+      if (cachedEntry.isValidAsLightMaster.has_value()) {
+        entry.flags |= HAS_LIGHT_MASTER_VALIDITY;
+        if (cachedEntry.isValidAsLightMaster.value()) {
+          entry.flags |= IS_VALID_AS_LIGHT_MASTER;
+        }
+      }
+      entry.reserved = 0;
+      Append(payload, entry);
+    }
+
+    pathOffset += (uint32_t)pair.first.size();
+  }
+
+  for (const auto& pair : entries_) {
+    payload.insert(payload.end(), pair.first.begin(), pair.first.end());
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  header.entryCount = (uint32_t)entryCount;
+  header.payloadCrc = UpdateCrc32(0, payload.data(), payload.size());
+
+  try {
+    WriteCacheFile(cacheFilePath, [&](std::ostream& out) {
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(payload.data(), payload.size());
+    });
+  } catch (std::exception& e) {
+    if (logger) {
+      logger->error("Unable to write plugin cache file \"{}\". Details: {}",
+                    cacheFilePath.u8string(),
+                    e.what());
+    }
+    throw FileAccessError("Unable to write plugin cache file \"" +
+                          cacheFilePath.u8string() + "\". Details: " + e.what());
+  }
+
+  isModified_ = false;
+}
+
+bool PersistentPluginCache::IsModified() const {
+  lock_guard<mutex> guard(mutex_);
+
+  return isModified_;
+}
+
+size_t PersistentPluginCache::GetMemoryUsage() const {
+  lock_guard<mutex> guard(mutex_);
+
+  return EstimateHeapSize(entries_, [](const std::vector<Entry>& entries) {
+    return entries.capacity() * sizeof(Entry);
+  });
+}
+
+std::string PersistentPluginCache::GetKey(
+    const std::filesystem::path& pluginPath) {
+  return pluginPath.filename().u8string();
+}
+
+const PersistentPluginCache::Entry* PersistentPluginCache::FindEntry(
+    const std::filesystem::path& pluginPath,
+    const FileIdentity& fileIdentity,
+    uintmax_t fileSize,
+    std::filesystem::file_time_type modificationTime) const {
+  auto it = entries_.find(GetKey(pluginPath));
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  for (const auto& entry : it->second) {
+    if (entry.fileIdentity == fileIdentity && entry.fileSize == fileSize &&
+        entry.modificationTime == modificationTime) {
+      entry.isUsed = true;
+      return &entry;
+    }
+  }
+
+  return nullptr;
+}
+
+PersistentPluginCache::Entry& PersistentPluginCache::GetOrAddEntry(
+    const std::filesystem::path& pluginPath,
+    const FileIdentity& fileIdentity,
+    uintmax_t fileSize,
+    std::filesystem::file_time_type modificationTime) {
+  isModified_ = true;
+
+  auto& entries = entries_[GetKey(pluginPath)];
+  for (auto& entry : entries) {
+    if (entry.fileIdentity == fileIdentity && entry.fileSize == fileSize &&
+        entry.modificationTime == modificationTime) {
+      entry.isUsed = true;
+      return entry;
+    }
+  }
+
+  entries.push_back(Entry{fileSize,
+                          modificationTime,
+                          fileIdentity,
+                          std::nullopt,
+                          std::nullopt,
+                          0,
+                          true});
+  return entries.back();
+}
+}
@@ -0,0 +1,136 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_API_GAME_PERSISTENT_PLUGIN_CACHE
+#define LOOT_API_GAME_PERSISTENT_PLUGIN_CACHE
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "api/helpers/file_identity.h"
+
+namespace loot {
+// Caches data that is expensive to derive from plugin files, keyed on each
+// file's name, identity, size and modification time, so that it can be saved
+// to disk and reused by a later process if the files are unchanged.
+//
+// A file's identity is that of the file itself rather than of its path (see
+// GetFileIdentity()), so a file that is seen through different paths, e.g.
+// through the virtual data directories of different mod manager profiles, only
+// needs to be read once, but different files with the same name, size and
+// modification time don't share an entry. A file that can't be identified,
+// e.g. because it doesn't exist, is never cached. Entries for different
+// versions of a file are kept side by side, so switching between profiles that
+// use different versions doesn't evict them: instead, entries are dropped once
+// they have gone unused for many saves.
+//
+// The file format is a fixed-size header that holds a CRC-32 of the rest of
+// the file, followed by an array of fixed-size entries, followed by a table of
+// UTF-8 filenames that the entries refer to by offset and length. All integers
+// are stored in native byte order, as the cache is not intended to be shared
+// between machines.
+class PersistentPluginCache {
+public:
+  PersistentPluginCache();
+  PersistentPluginCache(const PersistentPluginCache& cache);
+
+  PersistentPluginCache& operator=(const PersistentPluginCache& cache);
+
+  std::optional<uint32_t> GetCrc(
+      const std::filesystem::path& pluginPath,
+      uintmax_t fileSize,
+      std::filesystem::file_time_type modificationTime) const;
+  void SetCrc(const std::filesystem::path& pluginPath,
+              uintmax_t fileSize,
+              std::filesystem::file_time_type modificationTime,
+              uint32_t crc);
+
+  // Whether a plugin's records are valid for a light master, as checked by a
+  // full parse, so that it can be given without parsing them again.
+  std::optional<bool> GetIsValidAsLightMaster(
+      const std::filesystem::path& pluginPath,
+      uintmax_t fileSize,
+      std::filesystem::file_time_type modificationTime) const;
+  void SetIsValidAsLightMaster(
+      const std::filesystem::path& pluginPath,
+      uintmax_t fileSize,
+      std::filesystem::file_time_type modificationTime,
+      bool isValidAsLightMaster);
+
+  // Replaces the cache's contents with those of the given file. If the file
+  // does not exist or is not a valid cache file, the cache is left empty.
+  void Load(const std::filesystem::path& cacheFilePath);
+  void Save(const std::filesystem::path& cacheFilePath);
+
+  // True if the cache has been changed since it was last loaded or saved.
+  bool IsModified() const;
+
+  // An estimate of the memory used by the cache's entries, in bytes.
+  size_t GetMemoryUsage() const;
+
+private:
+  struct Entry {
+    uintmax_t fileSize;
+    std::filesystem::file_time_type modificationTime;
+    FileIdentity fileIdentity;
+    // Each value is only known once it has been derived from the file.
+    std::optional<uint32_t> crc;
+    std::optional<bool> isValidAsLightMaster;
+    // The number of consecutive saves that the entry has not been used for.
+    uint32_t unusedSaves;
+    // Set when the entry is looked up or set, and cleared when it is saved.
+    mutable bool isUsed;
+  };
+
+  static std::string GetKey(const std::filesystem::path& pluginPath);
+
+  // Gets the entry for the given version of a file, marking it as used.
+  // Must be called with the mutex held.
+  const Entry* FindEntry(
+      const std::filesystem::path& pluginPath,
+      const FileIdentity& fileIdentity,
+      uintmax_t fileSize,
+      std::filesystem::file_time_type modificationTime) const;
+  // Like FindEntry(), but adds an empty entry if there isn't one, and marks
+  // the cache as modified.
+  Entry& GetOrAddEntry(const std::filesystem::path& pluginPath,
+                       const FileIdentity& fileIdentity,
+                       uintmax_t fileSize,
+                       std::filesystem::file_time_type modificationTime);
+
+  // Entries are grouped by filename, with one entry per version of each file
+  // with that name.
+  std::unordered_map<std::string, std::vector<Entry>> entries_;
+  bool isModified_;
+
+  mutable std::mutex mutex_;
+};
+}
+
+#endif
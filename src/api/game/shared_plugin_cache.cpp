@@ -0,0 +1,124 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/game/shared_plugin_cache.h"
+
+#include <algorithm>
+
+namespace loot {
+SharedPluginCache& SharedPluginCache::Get() {
+  static SharedPluginCache cache;
+
+  return cache;
+}
+
+void SharedPluginCache::SetEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  isEnabled_ = enabled;
+  if (!enabled) {
+    entries_.clear();
+    pruneThreshold_ = MIN_PRUNE_THRESHOLD;
+  }
+}
+
+bool SharedPluginCache::IsEnabled() const { return isEnabled_; }
+
+std::shared_ptr<const Plugin> SharedPluginCache::Find(
+    GameType gameType,
+    const std::filesystem::path& filePath,
+    uintmax_t fileSize,
+    std::filesystem::file_time_type modificationTime,
+    bool headerOnly) const {
+  if (!isEnabled_) {
+    return nullptr;
+  }
+
+  auto key = GetKey(gameType, filePath, headerOnly);
+  if (std::get<2>(key).empty()) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.fileSize != fileSize ||
+      it->second.modificationTime != modificationTime) {
+    return nullptr;
+  }
+
+  return it->second.plugin.lock();
+}
+
+void SharedPluginCache::Add(const std::shared_ptr<const Plugin>& plugin) {
+  if (!isEnabled_) {
+    return;
+  }
+
+  auto key =
+      GetKey(plugin->GetGameType(), plugin->GetFilePath(), plugin->IsHeaderOnly());
+  if (std::get<2>(key).empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!isEnabled_) {
+    return;
+  }
+
+  entries_.insert_or_assign(std::move(key),
+                            Entry{plugin->GetLoadedFileSize(),
+                                  plugin->GetLoadedModificationTime(),
+                                  plugin});
+
+  if (entries_.size() >= pruneThreshold_) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second.plugin.expired()) {
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    pruneThreshold_ = std::max(MIN_PRUNE_THRESHOLD, entries_.size() * 2);
+  }
+}
+
+SharedPluginCache::Key SharedPluginCache::GetKey(
+    GameType gameType,
+    const std::filesystem::path& filePath,
+    bool headerOnly) {
+  // Handles may refer to the same files through different paths, e.g. through
+  // symlinks or relative paths, so compare canonical paths.
+  std::error_code errorCode;
+  auto canonicalPath = std::filesystem::canonical(filePath, errorCode);
+  if (errorCode) {
+    return Key(gameType, headerOnly, std::string());
+  }
+
+  return Key(gameType, headerOnly, canonicalPath.u8string());
+}
+}
@@ -0,0 +1,97 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_GAME_SHARED_PLUGIN_CACHE
+#define LOOT_API_GAME_SHARED_PLUGIN_CACHE
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "api/plugin.h"
+#include "loot/enum/game_type.h"
+
+namespace loot {
+// A process-wide record of the plugins held by all game handles' caches, so
+// that a handle loading a plugin file that another handle has already loaded
+// can share its parsed data instead of parsing the file again. Plugins are
+// only recorded while sharing is enabled, and are only held for as long as
+// some handle's cache holds them.
+class SharedPluginCache {
+public:
+  static SharedPluginCache& Get();
+
+  // Disabling sharing forgets all recorded plugins.
+  void SetEnabled(bool enabled);
+  bool IsEnabled() const;
+
+  // Get a plugin that was loaded for the given game type and header-only
+  // setting from the given file when it had the given size and modification
+  // time, or a null pointer if there is no such plugin or sharing is
+  // disabled.
+  std::shared_ptr<const Plugin> Find(
+      GameType gameType,
+      const std::filesystem::path& filePath,
+      uintmax_t fileSize,
+      std::filesystem::file_time_type modificationTime,
+      bool headerOnly) const;
+
+  // Records the given plugin so that other handles can find it. Does nothing if
+  // sharing is disabled.
+  void Add(const std::shared_ptr<const Plugin>& plugin);
+
+private:
+  // The game type, header-only setting and canonical file path.
+  typedef std::tuple<GameType, bool, std::string> Key;
+
+  struct Entry {
+    uintmax_t fileSize;
+    std::filesystem::file_time_type modificationTime;
+    std::weak_ptr<const Plugin> plugin;
+  };
+
+  SharedPluginCache() = default;
+
+  // Returns an empty key path if the file's canonical path can't be found.
+  static Key GetKey(GameType gameType,
+                    const std::filesystem::path& filePath,
+                    bool headerOnly);
+
+  std::atomic<bool> isEnabled_{false};
+  mutable std::mutex mutex_;
+  std::map<Key, Entry> entries_;
+  // Entries for plugins that are no longer held are removed once there are
+  // this many entries, so that they don't accumulate.
+  size_t pruneThreshold_ = MIN_PRUNE_THRESHOLD;
+
+  static constexpr size_t MIN_PRUNE_THRESHOLD = 256;
+};
+}
+
+#endif
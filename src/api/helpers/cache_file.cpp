@@ -0,0 +1,162 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/helpers/cache_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "api/helpers/logging.h"
+#include "loot/exception/file_access_error.h"
+
+namespace loot {
+namespace {
+// Temporary files are given this extension followed by a random number.
+constexpr const char* TEMP_FILE_EXTENSION = ".tmp";
+
+bool IsTempFile(const std::filesystem::path& filePath) {
+  return filePath.extension().u8string().rfind(TEMP_FILE_EXTENSION, 0) == 0;
+}
+}
+
+void WriteCacheFile(const std::filesystem::path& cacheFilePath,
+                    const std::function<void(std::ostream&)>& write) {
+  std::error_code errorCode;
+  if (cacheFilePath.has_parent_path()) {
+    std::filesystem::create_directories(cacheFilePath.parent_path(),
+                                        errorCode);
+  }
+
+  auto tempPath = cacheFilePath;
+  tempPath += TEMP_FILE_EXTENSION + std::to_string(std::random_device()());
+
+  std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    throw FileAccessError("Unable to open cache file: " +
+                          tempPath.u8string());
+  }
+
+  try {
+    write(out);
+    out.close();
+  } catch (...) {
+    out.close();
+    std::filesystem::remove(tempPath, errorCode);
+    throw;
+  }
+
+  if (!out.good()) {
+    std::filesystem::remove(tempPath, errorCode);
+    throw FileAccessError("Unable to write cache file: " +
+                          cacheFilePath.u8string());
+  }
+
+  std::filesystem::rename(tempPath, cacheFilePath, errorCode);
+  if (errorCode) {
+    std::filesystem::remove(tempPath, errorCode);
+    throw FileAccessError("Unable to replace cache file: " +
+                          cacheFilePath.u8string());
+  }
+}
+
+void MarkCacheFileUsed(const std::filesystem::path& cacheFilePath) {
+  std::error_code errorCode;
+  std::filesystem::last_write_time(
+      cacheFilePath, std::filesystem::file_time_type::clock::now(), errorCode);
+}
+
+bool IsCacheFile(const std::filesystem::path& filePath) {
+  std::ifstream in(filePath, std::ios::binary);
+  char prefix[sizeof(CACHE_FILE_MAGIC_PREFIX)];
+  in.read(prefix, sizeof(prefix));
+
+  return in.good() && std::memcmp(prefix,
+                                  CACHE_FILE_MAGIC_PREFIX,
+                                  sizeof(CACHE_FILE_MAGIC_PREFIX)) == 0;
+}
+
+uintmax_t TrimCacheFiles(const std::filesystem::path& directory,
+                         uintmax_t maxSize) {
+  struct CacheFile {
+    std::filesystem::path path;
+    uintmax_t size;
+    std::filesystem::file_time_type lastUsed;
+  };
+
+  std::vector<CacheFile> cacheFiles;
+  uintmax_t totalSize = 0;
+
+  std::error_code errorCode;
+  std::filesystem::recursive_directory_iterator it(directory, errorCode);
+  for (; !errorCode && it != std::filesystem::recursive_directory_iterator();
+       it.increment(errorCode)) {
+    // Files that are still being written are skipped, as are files that
+    // can't be inspected.
+    if (!it->is_regular_file(errorCode) || IsTempFile(it->path()) ||
+        !IsCacheFile(it->path())) {
+      continue;
+    }
+
+    auto size = it->file_size(errorCode);
+    if (errorCode) {
+      continue;
+    }
+    auto lastUsed = it->last_write_time(errorCode);
+    if (errorCode) {
+      continue;
+    }
+
+    cacheFiles.push_back(CacheFile{it->path(), size, lastUsed});
+    totalSize += size;
+  }
+
+  std::sort(cacheFiles.begin(),
+            cacheFiles.end(),
+            [](const CacheFile& lhs, const CacheFile& rhs) {
+              return lhs.lastUsed < rhs.lastUsed;
+            });
+
+  auto logger = getLogger();
+  uintmax_t removedSize = 0;
+  for (const auto& cacheFile : cacheFiles) {
+    if (totalSize - removedSize <= maxSize) {
+      break;
+    }
+
+    if (std::filesystem::remove(cacheFile.path, errorCode)) {
+      removedSize += cacheFile.size;
+      if (logger) {
+        logger->debug("Removed least recently used cache file: {}",
+                      cacheFile.path.u8string());
+      }
+    }
+  }
+
+  return removedSize;
+}
+}
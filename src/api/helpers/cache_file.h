@@ -0,0 +1,65 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_HELPERS_CACHE_FILE
+#define LOOT_API_HELPERS_CACHE_FILE
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+
+namespace loot {
+// All of libloot's cache file formats start with an 8-byte magic that begins
+// with these characters and is followed by a 32-bit format version, so that
+// cache files can be recognised and managed together whatever their format.
+// Each format's header also holds a CRC-32 of the data that follows it, so
+// that corrupt files are ignored instead of being trusted.
+constexpr char CACHE_FILE_MAGIC_PREFIX[4] = {'L', 'O', 'O', 'T'};
+
+// Writes a cache file by passing a stream to the given function, replacing any
+// existing file in one step so that other processes never see a partly
+// written file, and can keep reading an old file that they have mapped. The
+// parent directory is created if necessary. Throws a FileAccessError if the
+// file cannot be written.
+void WriteCacheFile(const std::filesystem::path& cacheFilePath,
+                    const std::function<void(std::ostream&)>& write);
+
+// Records that a cache file has just been used, so that it is among the last
+// to be removed by TrimCacheFiles(). Errors are ignored.
+void MarkCacheFileUsed(const std::filesystem::path& cacheFilePath);
+
+// True if the file starts with a cache file magic.
+bool IsCacheFile(const std::filesystem::path& filePath);
+
+// Removes the least recently used cache files in the given directory and its
+// subdirectories until their total size is no more than maxSize bytes. Files
+// that are not cache files are left alone and not counted. Returns the number
+// of bytes removed.
+uintmax_t TrimCacheFiles(const std::filesystem::path& directory,
+                         uintmax_t maxSize);
+}
+
+#endif
@@ -24,11 +24,26 @@
 
 #include "api/helpers/crc.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <fstream>
+#include <vector>
 
-#include <boost/crc.hpp>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define LOOT_CRC32_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define LOOT_CRC32_ARM
+#include <arm_acle.h>
+#endif
 
 #include "api/helpers/logging.h"
+#include "api/helpers/thread_pool.h"
 
 #include "loot/exception/file_access_error.h"
 
@@ -36,42 +51,369 @@ using std::string;
 using std::wstring;
 
 namespace loot {
-size_t GetStreamSize(std::istream& stream) {
-  std::streampos startingPosition = stream.tellg();
+namespace {
+typedef std::array<std::array<uint32_t, 256>, 8> Crc32Tables;
 
-  stream.seekg(0, std::ios_base::end);
-  size_t streamSize = stream.tellg();
-  stream.seekg(startingPosition, std::ios_base::beg);
+// Tables for the slicing-by-8 algorithm using the reflected CRC-32
+// polynomial, where tables[k][i] is the CRC of byte i followed by k zero
+// bytes.
+const Crc32Tables& GetCrc32Tables() {
+  static const Crc32Tables tables = []() {
+    Crc32Tables tables;
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+      }
+      tables[0][i] = crc;
+    }
+
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (size_t k = 1; k < tables.size(); ++k) {
+        tables[k][i] =
+            (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+      }
+    }
+
+    return tables;
+  }();
+
+  return tables;
+}
+
+inline uint32_t LoadLittleEndian32(const unsigned char* data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+         ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// The kernels below operate on the CRC's internal state, which is the
+// bitwise complement of the CRC value.
+uint32_t UpdateCrc32StateSlicingBy8(uint32_t state,
+                                    const unsigned char* data,
+                                    size_t length) {
+  const auto& tables = GetCrc32Tables();
+
+  while (length >= 8) {
+    uint32_t one = state ^ LoadLittleEndian32(data);
+    uint32_t two = LoadLittleEndian32(data + 4);
+    state = tables[7][one & 0xFF] ^ tables[6][(one >> 8) & 0xFF] ^
+            tables[5][(one >> 16) & 0xFF] ^ tables[4][one >> 24] ^
+            tables[3][two & 0xFF] ^ tables[2][(two >> 8) & 0xFF] ^
+            tables[1][(two >> 16) & 0xFF] ^ tables[0][two >> 24];
+
+    data += 8;
+    length -= 8;
+  }
+
+  while (length > 0) {
+    state = (state >> 8) ^ tables[0][(state ^ *data) & 0xFF];
+    data += 1;
+    length -= 1;
+  }
+
+  return state;
+}
+
+#ifdef LOOT_CRC32_X86
+bool IsPclmulSupported() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  const bool hasPclmul = (info[2] & (1 << 1)) != 0;
+  const bool hasSse41 = (info[2] & (1 << 19)) != 0;
+  return hasPclmul && hasSse41;
+#else
+  return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+// Folds 64-byte blocks using carry-less multiplication, as described in "Fast
+// CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" by
+// Gopal et al. (Intel, 2009). length must be at least 64 and a multiple of 16.
+#ifndef _MSC_VER
+__attribute__((target("pclmul,sse4.1")))
+#endif
+uint32_t UpdateCrc32StatePclmul(uint32_t state,
+                                const unsigned char* data,
+                                size_t length) {
+  alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+  alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+  alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+  alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+  x1 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+  x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+  x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+  x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)state));
+
+  x0 = _mm_load_si128((const __m128i*)k1k2);
 
-  return streamSize;
+  data += 64;
+  length -= 64;
+
+  // Fold four 128-bit lanes in parallel.
+  while (length >= 64) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+    y5 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+    y6 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+    y7 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+    y8 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+    data += 64;
+    length -= 64;
+  }
+
+  // Fold the four lanes into one.
+  x0 = _mm_load_si128((const __m128i*)k3k4);
+
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  // Fold any remaining 16-byte blocks.
+  while (length >= 16) {
+    x2 = _mm_loadu_si128((const __m128i*)data);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    data += 16;
+    length -= 16;
+  }
+
+  // Fold 128 bits down to 64 bits.
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_srli_si128(x1, 8);
+  x1 = _mm_xor_si128(x1, x2);
+
+  x0 = _mm_loadl_epi64((const __m128i*)k5k0);
+
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits.
+  x0 = _mm_load_si128((const __m128i*)poly);
+
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+#endif
+
+#ifdef LOOT_CRC32_ARM
+uint32_t UpdateCrc32StateArm(uint32_t state,
+                             const unsigned char* data,
+                             size_t length) {
+  while (length >= 8) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    state = __crc32d(state, value);
+    data += 8;
+    length -= 8;
+  }
+
+  while (length > 0) {
+    state = __crc32b(state, *data);
+    data += 1;
+    length -= 1;
+  }
+
+  return state;
+}
+#endif
+
+uint32_t UpdateCrc32State(uint32_t state,
+                          const unsigned char* data,
+                          size_t length) {
+#if defined(LOOT_CRC32_X86)
+  static const bool usePclmul = IsPclmulSupported();
+  if (usePclmul && length >= 64) {
+    const size_t foldedLength = length & ~(size_t)15;
+    state = UpdateCrc32StatePclmul(state, data, foldedLength);
+    data += foldedLength;
+    length -= foldedLength;
+  }
+#elif defined(LOOT_CRC32_ARM)
+  return UpdateCrc32StateArm(state, data, length);
+#endif
+
+  return UpdateCrc32StateSlicingBy8(state, data, length);
+}
+}
+
+uint32_t UpdateCrc32(uint32_t crc, const char* data, size_t length) {
+  return ~UpdateCrc32State(
+      ~crc, reinterpret_cast<const unsigned char*>(data), length);
+}
+
+namespace {
+typedef std::array<uint32_t, 32> Gf2Matrix;
+
+uint32_t Gf2MatrixTimes(const Gf2Matrix& matrix, uint32_t vector) {
+  uint32_t sum = 0;
+  for (size_t i = 0; vector != 0; ++i, vector >>= 1) {
+    if (vector & 1) {
+      sum ^= matrix[i];
+    }
+  }
+  return sum;
+}
+
+Gf2Matrix Gf2MatrixSquare(const Gf2Matrix& matrix) {
+  Gf2Matrix square;
+  for (size_t i = 0; i < matrix.size(); ++i) {
+    square[i] = Gf2MatrixTimes(matrix, matrix[i]);
+  }
+  return square;
+}
+
+// Calculates the CRC of length bytes of the given file, starting at offset.
+uint32_t GetFileRegionCrc32(const std::filesystem::path& filename,
+                            uintmax_t offset,
+                            uintmax_t length) {
+  std::ifstream ifile(filename, std::ios::binary);
+  ifile.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+  ifile.seekg(offset);
+
+  // Read in large blocks so that the CRC kernel spends its time working on
+  // data instead of waiting for small reads.
+  static const size_t bufferSize = 1024 * 1024;
+  uintmax_t bytesLeft = length;
+  std::vector<char> buffer((size_t)std::min<uintmax_t>(bytesLeft, bufferSize));
+
+  uint32_t checksum = 0;
+  while (bytesLeft > 0) {
+    auto bytesToRead = (size_t)std::min<uintmax_t>(bytesLeft, bufferSize);
+    ifile.read(buffer.data(), bytesToRead);
+
+    checksum = UpdateCrc32(checksum, buffer.data(), (size_t)ifile.gcount());
+    bytesLeft -= ifile.gcount();
+  }
+
+  return checksum;
+}
+}
+
+// Applies the effect of appending length2 zero bytes to the first input by
+// repeatedly squaring the operator for one zero bit, as in zlib's
+// crc32_combine().
+uint32_t CombineCrc32(uint32_t crc1, uint32_t crc2, uintmax_t length2) {
+  if (length2 == 0) {
+    return crc1;
+  }
+
+  // The operator for one zero bit.
+  Gf2Matrix odd;
+  odd[0] = 0xEDB88320;
+  for (size_t i = 1; i < odd.size(); ++i) {
+    odd[i] = (uint32_t)1 << (i - 1);
+  }
+
+  // The operators for two and four zero bits.
+  Gf2Matrix even = Gf2MatrixSquare(odd);
+  odd = Gf2MatrixSquare(even);
+
+  // Each iteration squares the operator to give the operator for the next
+  // power of two zero bytes, and applies it if that bit of length2 is set.
+  while (true) {
+    even = Gf2MatrixSquare(odd);
+    if (length2 & 1) {
+      crc1 = Gf2MatrixTimes(even, crc1);
+    }
+    length2 >>= 1;
+    if (length2 == 0) {
+      break;
+    }
+
+    odd = Gf2MatrixSquare(even);
+    if (length2 & 1) {
+      crc1 = Gf2MatrixTimes(odd, crc1);
+    }
+    length2 >>= 1;
+    if (length2 == 0) {
+      break;
+    }
+  }
+
+  return crc1 ^ crc2;
 }
 
 // Calculate the CRC of the given file for comparison purposes.
 uint32_t GetCrc32(const std::filesystem::path& filename) {
+  // Below this size, a file's CRC is calculated faster than the file can be
+  // split up and handed out to the thread pool.
+  static constexpr uintmax_t MIN_PARALLEL_FILE_SIZE = 64 * 1024 * 1024;
+  static constexpr uintmax_t CHUNK_SIZE = 16 * 1024 * 1024;
+
   try {
     auto logger = getLogger();
-    if (logger) {
+    if (shouldLog(logger, spdlog::level::trace)) {
       logger->trace("Calculating CRC for: {}", filename.u8string());
     }
 
-    std::ifstream ifile(filename, std::ios::binary);
-    ifile.exceptions(std::ios_base::badbit | std::ios_base::failbit);
-
-    static const size_t bufferSize = 8192;
-    char buffer[bufferSize];
-    boost::crc_32_type result;
-    size_t bytesLeft = GetStreamSize(ifile);
-    while (bytesLeft > 0) {
-      if (bytesLeft > bufferSize)
-        ifile.read(buffer, bufferSize);
-      else
-        ifile.read(buffer, bytesLeft);
-
-      result.process_bytes(buffer, ifile.gcount());
-      bytesLeft -= ifile.gcount();
+    const uintmax_t fileSize = std::filesystem::file_size(filename);
+    auto threadPool = ThreadPool::GetCurrent();
+
+    uint32_t checksum = 0;
+    if (fileSize < MIN_PARALLEL_FILE_SIZE || threadPool->Size() == 1) {
+      checksum = GetFileRegionCrc32(filename, 0, fileSize);
+    } else {
+      const size_t numChunks =
+          (size_t)((fileSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+      std::vector<uint32_t> chunkCrcs(numChunks);
+      std::vector<std::function<void()>> tasks;
+      for (size_t i = 0; i < numChunks; ++i) {
+        tasks.push_back([&, i]() {
+          const uintmax_t offset = i * CHUNK_SIZE;
+          chunkCrcs[i] = GetFileRegionCrc32(
+              filename, offset, std::min(CHUNK_SIZE, fileSize - offset));
+        });
+      }
+
+      threadPool->Run(tasks);
+
+      checksum = chunkCrcs[0];
+      for (size_t i = 1; i < numChunks; ++i) {
+        const uintmax_t offset = i * CHUNK_SIZE;
+        checksum = CombineCrc32(
+            checksum, chunkCrcs[i], std::min(CHUNK_SIZE, fileSize - offset));
+      }
     }
 
-    uint32_t checksum = result.checksum();
     if (logger) {
       logger->debug("CRC32(\"{}\"): {:x}", filename.u8string(), checksum);
     }
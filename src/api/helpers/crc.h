@@ -25,10 +25,22 @@
 #ifndef LOOT_API_HELPERS_CRC
 #define LOOT_API_HELPERS_CRC
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 
 namespace loot {
+// Update a running CRC-32 with the given data. The CRC of an empty input is 0,
+// so pass that to start a new calculation.
+uint32_t UpdateCrc32(uint32_t crc, const char* data, size_t length);
+
+// Get the CRC-32 of two inputs concatenated together, given the CRC of each
+// and the length of the second.
+uint32_t CombineCrc32(uint32_t crc1, uint32_t crc2, uintmax_t length2);
+
+// Get the CRC-32 of the given file. Large files are split into chunks that
+// have their CRCs calculated in parallel on the current thread pool, unless it
+// only has one thread.
 uint32_t GetCrc32(const std::filesystem::path& filename);
 }
 
@@ -0,0 +1,78 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/helpers/file_identity.h"
+
+#ifdef _WIN32
+#ifndef UNICODE
+#define UNICODE
+#endif
+#ifndef _UNICODE
+#define _UNICODE
+#endif
+#define NOMINMAX
+#include "windows.h"
+#else
+#include <sys/stat.h>
+#endif
+
+namespace loot {
+std::optional<FileIdentity> GetFileIdentity(const std::filesystem::path& path) {
+#ifdef _WIN32
+  // Backup semantics allow a handle to be opened for a directory too, and no
+  // access rights are needed to read a file's information.
+  HANDLE handle = CreateFile(path.wstring().c_str(),
+                             0,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE |
+                                 FILE_SHARE_DELETE,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_FLAG_BACKUP_SEMANTICS,
+                             nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return std::nullopt;
+  }
+
+  BY_HANDLE_FILE_INFORMATION info;
+  const BOOL result = GetFileInformationByHandle(handle, &info);
+  CloseHandle(handle);
+  if (!result) {
+    return std::nullopt;
+  }
+
+  return FileIdentity{
+      info.dwVolumeSerialNumber,
+      (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow};
+#else
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    return std::nullopt;
+  }
+
+  return FileIdentity{static_cast<uint64_t>(info.st_dev),
+                      static_cast<uint64_t>(info.st_ino)};
+#endif
+}
+}
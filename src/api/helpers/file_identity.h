@@ -0,0 +1,56 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_HELPERS_FILE_IDENTITY
+#define LOOT_API_HELPERS_FILE_IDENTITY
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace loot {
+// Identifies a file independently of the path used to reach it: two paths
+// have the same identity if they are links to the same file. On Windows this
+// is the volume serial number and file index, and elsewhere it is the device
+// and inode numbers.
+struct FileIdentity {
+  uint64_t device;
+  uint64_t file;
+};
+
+inline bool operator==(const FileIdentity& lhs, const FileIdentity& rhs) {
+  return lhs.device == rhs.device && lhs.file == rhs.file;
+}
+
+inline bool operator!=(const FileIdentity& lhs, const FileIdentity& rhs) {
+  return !(lhs == rhs);
+}
+
+// Gets the identity of the file at the given path, or nullopt if it can't be
+// read, e.g. because the file doesn't exist. Never throws.
+std::optional<FileIdentity> GetFileIdentity(const std::filesystem::path& path);
+}
+
+#endif
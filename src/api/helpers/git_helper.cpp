@@ -25,6 +25,9 @@
 #include "api/helpers/git_helper.h"
 
 #include <iomanip>
+#include <list>
+#include <mutex>
+#include <optional>
 #include <sstream>
 
 #include <boost/lexical_cast.hpp>
@@ -32,6 +35,7 @@
 #include <boost/uuid/uuid_io.hpp>
 
 #include "api/helpers/logging.h"
+#include "api/helpers/tracing.h"
 #include "loot/exception/error_categories.h"
 #include "loot/exception/git_state_error.h"
 
@@ -40,6 +44,125 @@ using std::string;
 namespace fs = std::filesystem;
 
 namespace loot {
+namespace {
+// The maximum number of idle repository handles to keep open. The least
+// recently pooled handle is freed to make room for another.
+constexpr size_t MAX_POOLED_REPOSITORIES = 8;
+
+std::string GetRepositoryKey(const std::filesystem::path& repoRoot) {
+  return fs::absolute(repoRoot).lexically_normal().u8string();
+}
+
+// Holds open repository handles between uses. Handles aren't safe to use
+// from more than one thread at once, so each is only held by one GitHelper
+// at a time: taking a handle removes it from the pool.
+class RepositoryPool {
+public:
+  static RepositoryPool& Get() {
+    static RepositoryPool pool;
+    return pool;
+  }
+
+  // Returns nullptr if there is no pooled handle for the repository that can
+  // be reused.
+  git_repository* Take(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+      if (it->key != key) {
+        continue;
+      }
+
+      auto entry = *it;
+      entries_.erase(std::next(it).base());
+
+      if (GetSignature(entry.repo) != entry.signature) {
+        // The repository has been changed by something other than a
+        // GitHelper, e.g. it has been deleted and cloned again, so it's
+        // opened again instead of trusting libgit2 to notice.
+        git_repository_free(entry.repo);
+        return nullptr;
+      }
+
+      return entry.repo;
+    }
+
+    return nullptr;
+  }
+
+  void Return(const std::string& key, git_repository* repo) {
+    auto signature = GetSignature(repo);
+    if (!signature.has_value()) {
+      git_repository_free(repo);
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    entries_.push_back(Entry{key, signature.value(), repo});
+
+    if (entries_.size() > MAX_POOLED_REPOSITORIES) {
+      git_repository_free(entries_.front().repo);
+      entries_.pop_front();
+    }
+  }
+
+private:
+  struct Signature {
+    fs::file_time_type gitDirTime;
+    fs::file_time_type packDirTime;
+
+    bool operator!=(const Signature& rhs) const {
+      return gitDirTime != rhs.gitDirTime || packDirTime != rhs.packDirTime;
+    }
+  };
+
+  struct Entry {
+    std::string key;
+    Signature signature;
+    git_repository* repo;
+  };
+
+  // Hold a reference to libgit2 for as long as the pooled handles may be
+  // used, so that GitHelper destructors don't shut it down.
+  RepositoryPool() { git_libgit2_init(); }
+
+  ~RepositoryPool() {
+    for (const auto& entry : entries_) {
+      git_repository_free(entry.repo);
+    }
+    git_libgit2_shutdown();
+  }
+
+  // Config, HEAD and packed-refs changes replace files in the Git directory,
+  // and new objects are fetched into new pack files, so those changes update
+  // the modification times of these directories. Loose ref updates happen in
+  // nested directories and don't, but libgit2 re-reads refs from disk on each
+  // lookup, so a pooled handle never sees stale refs anyway.
+  static std::optional<Signature> GetSignature(git_repository* repo) {
+    const auto gitDir = fs::u8path(git_repository_path(repo));
+
+    std::error_code errorCode;
+    Signature signature;
+    signature.gitDirTime = fs::last_write_time(gitDir, errorCode);
+    if (errorCode) {
+      return std::nullopt;
+    }
+
+    signature.packDirTime =
+        fs::last_write_time(gitDir / "objects" / "pack", errorCode);
+    if (errorCode) {
+      return std::nullopt;
+    }
+
+    return signature;
+  }
+
+  std::mutex mutex_;
+  std::list<Entry> entries_;
+};
+}
+
 GitHelper::GitHelper() : logger_(getLogger()) {}
 
 GitHelper::GitData::GitData() :
@@ -71,7 +194,6 @@ GitHelper::GitData::~GitData() {
   git_object_free(object);
   git_config_free(config);
   git_remote_free(remote);
-  git_repository_free(repo);
   git_reference_free(reference);
   git_reference_free(reference2);
   git_blob_free(blob);
@@ -81,6 +203,12 @@ GitHelper::GitData::~GitData() {
   git_buf_free(&buffer);
   git_strarray_free(&checkout_options.paths);
 
+  if (repo != nullptr && !repoKey.empty()) {
+    RepositoryPool::Get().Return(repoKey, repo);
+  } else {
+    git_repository_free(repo);
+  }
+
   git_libgit2_shutdown();
 }
 
@@ -103,10 +231,14 @@ void GitHelper::InitialiseOptions(const std::string& branch,
   data_.checkout_options.paths.strings = paths;
   data_.checkout_options.paths.count = 1;
 
-  // Initialise clone options.
+  // Initialise clone options. Only the branch that will be checked out is
+  // cloned, to avoid downloading the history of every other branch.
+  checkoutBranch_ = branch;
   data_.clone_options.checkout_opts = data_.checkout_options;
   data_.clone_options.bare = 0;
-  data_.clone_options.checkout_branch = branch.c_str();
+  data_.clone_options.checkout_branch = checkoutBranch_.c_str();
+  data_.clone_options.remote_cb = CreateSingleBranchRemote;
+  data_.clone_options.remote_cb_payload = &checkoutBranch_;
 }
 
 void GitHelper::Open(const std::filesystem::path& repoRoot) {
@@ -114,7 +246,16 @@ void GitHelper::Open(const std::filesystem::path& repoRoot) {
     logger_->info("Attempting to open Git repository at: {}",
                   repoRoot.u8string());
   }
-  Call(git_repository_open(&data_.repo, repoRoot.u8string().c_str()));
+  auto key = GetRepositoryKey(repoRoot);
+  data_.repo = RepositoryPool::Get().Take(key);
+  if (data_.repo != nullptr) {
+    if (logger_) {
+      logger_->debug("Reusing an already-open handle for the repository.");
+    }
+  } else {
+    Call(git_repository_open(&data_.repo, repoRoot.u8string().c_str()));
+  }
+  data_.repoKey = key;
 }
 
 void GitHelper::SetRemoteUrl(const std::string& remote,
@@ -174,9 +315,27 @@ int GitHelper::DiffFileCallback(const git_diff_delta* delta,
   return 0;
 }
 
+int GitHelper::CreateSingleBranchRemote(git_remote** out,
+                                        git_repository* repo,
+                                        const char* name,
+                                        const char* url,
+                                        void* payload) {
+  auto branch = static_cast<const std::string*>(payload);
+  auto refspec = GetBranchRefspec(name, *branch);
+
+  return git_remote_create_with_fetchspec(
+      out, repo, name, url, refspec.c_str());
+}
+
+std::string GitHelper::GetBranchRefspec(const std::string& remote,
+                                        const std::string& branch) {
+  return "+refs/heads/" + branch + ":refs/remotes/" + remote + "/" + branch;
+}
+
 // Clones a repository and opens it.
 void GitHelper::Clone(const std::filesystem::path& path,
                       const std::string& url) {
+  TraceScope traceScope("Clone", "git", url);
   if (data_.repo != nullptr)
     throw GitStateError(
         "Cannot clone repository that has already been opened.");
@@ -213,7 +372,9 @@ void GitHelper::Clone(const std::filesystem::path& path,
 
   // If repo was cloned into a temporary directory, move it into the target
   // path.
-  if (repoPath != path) {
+  if (repoPath == path) {
+    data_.repoKey = GetRepositoryKey(path);
+  } else {
     // Free the repository to ensure all file handles are closed.
     git_repository_free(data_.repo);
     data_.repo = nullptr;
@@ -258,21 +419,28 @@ void GitHelper::Clone(const std::filesystem::path& path,
   }
 }
 
-void GitHelper::Fetch(const std::string& remote) {
+void GitHelper::Fetch(const std::string& remote, const std::string& branch) {
+  TraceScope traceScope("Fetch", "git", branch);
   if (data_.repo == nullptr)
     throw GitStateError(
         "Cannot fetch updates for repository that has not been opened.");
 
   if (logger_) {
-    logger_->trace("Fetching updates from remote.");
+    logger_->trace("Fetching updates for branch {} from remote.", branch);
   }
 
   // Get the origin remote.
   Call(git_remote_lookup(&data_.remote, data_.repo, remote.c_str()));
 
-  // Now fetch any updates.
+  // Now fetch any updates. The refspec overrides those configured for the
+  // remote, so that repositories cloned with all branches also only fetch
+  // the one that is needed.
+  auto refspec = GetBranchRefspec(remote, branch);
+  char* refspecString = &refspec[0];
+  git_strarray refspecs = {&refspecString, 1};
+
   git_fetch_options fetch_options = GIT_FETCH_OPTIONS_INIT;
-  Call(git_remote_fetch(data_.remote, nullptr, &fetch_options, nullptr));
+  Call(git_remote_fetch(data_.remote, &refspecs, &fetch_options, nullptr));
 
   // Log some stats on what was fetched either during update or clone.
   const git_transfer_progress* stats = git_remote_stats(data_.remote);
@@ -429,6 +597,69 @@ bool GitHelper::BranchExists(const std::string& branch) {
   return false;
 }
 
+std::optional<bool> GitHelper::IsBranchSameAsRemote(
+    const std::string& remote,
+    const std::string& branch) {
+  TraceScope traceScope("ListRemoteRefs", "git", branch);
+  if (data_.repo == nullptr) {
+    throw GitStateError(
+        "Cannot check remote branch for repository that has not been opened.");
+  } else if (data_.remote != nullptr) {
+    throw GitStateError(
+        "Cannot check remote branch, remote memory already allocated.");
+  } else if (data_.reference != nullptr) {
+    throw GitStateError(
+        "Cannot check remote branch, reference memory already allocated.");
+  }
+
+  if (logger_) {
+    logger_->trace("Listing the refs advertised by remote {}.", remote);
+  }
+
+  Call(git_remote_lookup(&data_.remote, data_.repo, remote.c_str()));
+  Call(git_remote_connect(
+      data_.remote, GIT_DIRECTION_FETCH, nullptr, nullptr, nullptr));
+
+  const git_remote_head** heads = nullptr;
+  size_t headsCount = 0;
+  Call(git_remote_ls(&heads, &headsCount, data_.remote));
+
+  const auto refName = "refs/heads/" + branch;
+  std::optional<git_oid> remoteCommitId;
+  for (size_t i = 0; i < headsCount; ++i) {
+    if (refName == heads[i]->name) {
+      remoteCommitId = heads[i]->oid;
+      break;
+    }
+  }
+
+  git_remote_disconnect(data_.remote);
+  git_remote_free(data_.remote);
+  data_.remote = nullptr;
+
+  if (!remoteCommitId.has_value()) {
+    if (logger_) {
+      logger_->debug("Remote {} does not have the branch {}.", remote, branch);
+    }
+    return std::nullopt;
+  }
+
+  int ret = git_branch_lookup(
+      &data_.reference, data_.repo, branch.c_str(), GIT_BRANCH_LOCAL);
+  if (ret == GIT_ENOTFOUND) {
+    return false;
+  }
+  Call(ret);
+
+  bool isSame =
+      git_oid_equal(GetCommitId(data_.reference), &remoteCommitId.value()) != 0;
+
+  git_reference_free(data_.reference);
+  data_.reference = nullptr;
+
+  return isSame;
+}
+
 bool GitHelper::IsBranchUpToDate(const std::string& branch) {
   if (data_.repo == nullptr) {
     throw GitStateError(
@@ -604,7 +835,7 @@ bool GitHelper::IsFileDifferent(const std::filesystem::path& repoRoot,
     logger->trace("Existing repository found, attempting to open it.");
   }
   GitHelper git;
-  git.Call(git_repository_open(&git.data_.repo, repoRoot.u8string().c_str()));
+  git.Open(repoRoot);
 
   // Perform a git diff, then iterate the deltas to see if one exists for the
   // masterlist.
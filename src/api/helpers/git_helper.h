@@ -26,6 +26,7 @@
 #define LOOT_API_HELPERS_GIT_HELPER
 
 #include <filesystem>
+#include <optional>
 #include <string>
 
 #include <git2.h>
@@ -38,6 +39,11 @@ public:
 
   void InitialiseOptions(const std::string& branch,
                          const std::string& filenameToCheckout);
+  // Repository handles are returned to a process-wide pool when the helper is
+  // destroyed, and reused by later helpers that open the same repository, so
+  // that libgit2's caches of its objects, refs and config are kept. A pooled
+  // handle is discarded instead of reused if the repository's Git directory
+  // or pack directory has been modified since the handle was pooled.
   void Open(const std::filesystem::path& repoRoot);
   void SetRemoteUrl(const std::string& remote, const std::string& url);
 
@@ -45,8 +51,11 @@ public:
   static bool IsFileDifferent(const std::filesystem::path& repoRoot,
                               const std::string& filename);
 
+  // If options have been initialised, only the branch they were initialised
+  // with is cloned from the remote.
   void Clone(const std::filesystem::path& path, const std::string& url);
-  void Fetch(const std::string& remote);
+  // Only fetches the given branch from the remote.
+  void Fetch(const std::string& remote, const std::string& branch);
 
   void CheckoutNewBranch(const std::string& remote, const std::string& branch);
   void CheckoutRevision(const std::string& revision);
@@ -54,6 +63,12 @@ public:
   // Deletes the branch, detaching HEAD if it's currently set to the branch.
   void DeleteBranch(const std::string& branch);
 
+  // Connects to the remote to check if the given local branch is at the
+  // commit that the remote's branch of the same name is at, without fetching
+  // anything. Returns std::nullopt if the remote doesn't have the branch.
+  std::optional<bool> IsBranchSameAsRemote(const std::string& remote,
+                                           const std::string& branch);
+
   bool BranchExists(const std::string& branch);
   bool IsBranchUpToDate(const std::string& branch);
   bool IsBranchCheckedOut(const std::string& branch);
@@ -86,12 +101,25 @@ private:
 
     git_checkout_options checkout_options;
     git_clone_options clone_options;
+
+    // The key of repo in the repository pool, or empty if it shouldn't be
+    // pooled.
+    std::string repoKey;
   };
 
   static int DiffFileCallback(const git_diff_delta* delta,
                               float progress,
                               void* payload);
 
+  // Creates a remote that only fetches the branch given as the payload.
+  static int CreateSingleBranchRemote(git_remote** out,
+                                      git_repository* repo,
+                                      const char* name,
+                                      const char* url,
+                                      void* payload);
+  static std::string GetBranchRefspec(const std::string& remote,
+                                      const std::string& branch);
+
   // Removes the read-only flag from some files in git repositories
   // created by libgit2.
   void GrantWritePermissions(const std::filesystem::path& path);
@@ -101,6 +129,8 @@ private:
   const git_oid* GetCommitId(git_reference* reference);
 
   GitData data_;
+  // Held so that the clone options can point to it.
+  std::string checkoutBranch_;
   std::shared_ptr<spdlog::logger> logger_;
 };
 }
@@ -26,16 +26,78 @@
 
 #define FMT_USE_STD_STRING_VIEW
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/base_sink.h>
 
 #include "loot/enum/log_level.h"
 
+// The lowest spdlog level (0 is trace, 1 is debug, and so on) that libloot
+// can log at. Messages guarded by shouldLog() that are below this level are
+// compiled out, and the logger never lets through messages below it.
+#ifndef LOOT_LOG_MIN_LEVEL
+#define LOOT_LOG_MIN_LEVEL 0
+#endif
+
 namespace loot {
 static const char* LOGGER_NAME = "loot_api_logger";
 
+// The logger is held here as well as in spdlog's registry so that getting it
+// doesn't involve locking the registry and looking the logger up by name.
+inline std::shared_ptr<spdlog::logger>& getLoggerInstance() {
+  static std::shared_ptr<spdlog::logger> logger;
+  return logger;
+}
+
 inline std::shared_ptr<spdlog::logger> getLogger() {
-  return spdlog::get(LOGGER_NAME);
+  return std::atomic_load(&getLoggerInstance());
+}
+
+inline void setLogger(std::shared_ptr<spdlog::logger> logger) {
+  std::atomic_store(&getLoggerInstance(), std::move(logger));
+}
+
+// Checks if a message at the given level would be logged, so that callers can
+// skip building the message's arguments if it wouldn't be.
+inline bool shouldLog(const std::shared_ptr<spdlog::logger>& logger,
+                      spdlog::level::level_enum level) {
+  return level >= LOOT_LOG_MIN_LEVEL && logger && logger->should_log(level);
+}
+
+inline spdlog::level::level_enum mapToSpdlog(LogLevel level) {
+  using spdlog::level::level_enum;
+  level_enum severity = level_enum::trace;
+  switch (level) {
+    case LogLevel::trace:
+      severity = level_enum::trace;
+      break;
+    case LogLevel::debug:
+      severity = level_enum::debug;
+      break;
+    case LogLevel::info:
+      severity = level_enum::info;
+      break;
+    case LogLevel::warning:
+      severity = level_enum::warn;
+      break;
+    case LogLevel::error:
+      severity = level_enum::err;
+      break;
+    case LogLevel::fatal:
+      severity = level_enum::critical;
+      break;
+  }
+
+  if (severity < LOOT_LOG_MIN_LEVEL) {
+    return static_cast<level_enum>(LOOT_LOG_MIN_LEVEL);
+  }
+  return severity;
 }
 
 class SpdLoggingSink : public spdlog::sinks::base_sink<std::mutex> {
@@ -44,18 +106,45 @@ public:
     this->callback = callback;
   }
 
+  size_t GetFlushCount() const {
+    std::lock_guard<std::mutex> lock(flushMutex_);
+    return flushCount_;
+  }
+
+  // Waits until the sink has been flushed more than the given number of
+  // times, or until the timeout has passed, and returns whether it has.
+  bool WaitForFlush(size_t flushCount, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(flushMutex_);
+    return flushed_.wait_for(
+        lock, timeout, [&]() { return flushCount_ > flushCount; });
+  }
+
 protected:
   void sink_it_(const spdlog::details::log_msg& msg) override {
     // string_view isn't necessarily null-terminated, so using
-    // msg.payload.data() directly isn't a good idea.
-    std::string payload = std::string(msg.payload.data(), msg.payload.size());
-    callback(mapFromSpdlog(msg.level), payload.c_str());
+    // msg.payload.data() directly isn't a good idea. The payload is copied
+    // into a reused buffer instead, which base_sink's mutex protects.
+    buffer_.assign(msg.payload.data(), msg.payload.size());
+    callback(mapFromSpdlog(msg.level), buffer_.c_str());
   }
 
-  void flush_() override {}
+  // An async logger passes flushes to its sinks in order with its messages,
+  // so counting them shows when earlier messages have been passed on.
+  void flush_() override {
+    {
+      std::lock_guard<std::mutex> lock(flushMutex_);
+      ++flushCount_;
+    }
+    flushed_.notify_all();
+  }
 
 private:
   std::function<void(LogLevel, const char*)> callback;
+  std::string buffer_;
+
+  mutable std::mutex flushMutex_;
+  std::condition_variable flushed_;
+  size_t flushCount_ = 0;
 
   static LogLevel mapFromSpdlog(spdlog::level::level_enum severity) {
     using spdlog::level::level_enum;
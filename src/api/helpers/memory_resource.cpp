@@ -0,0 +1,89 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#include "api/helpers/memory_resource.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace loot {
+namespace {
+class MemoryResourceAdapter : public pmr::memory_resource {
+public:
+  explicit MemoryResourceAdapter(MemoryResource& resource) :
+      resource_(resource) {}
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    return resource_.Allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+    resource_.Deallocate(pointer, bytes, alignment);
+  }
+
+  bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  MemoryResource& resource_;
+};
+
+std::atomic<pmr::memory_resource*> globalMemoryResource(nullptr);
+}
+
+pmr::memory_resource* GetMemoryResourceAdapter(MemoryResource* resource) {
+  if (resource == nullptr) {
+    return nullptr;
+  }
+
+  static std::mutex mutex;
+  static std::unordered_map<MemoryResource*,
+                            std::unique_ptr<MemoryResourceAdapter>>
+      adapters;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& adapter = adapters[resource];
+  if (!adapter) {
+    adapter = std::make_unique<MemoryResourceAdapter>(*resource);
+  }
+
+  return adapter.get();
+}
+
+pmr::memory_resource* GetGlobalMemoryResource() {
+  auto resource = globalMemoryResource.load();
+  return resource == nullptr ? pmr::get_default_resource() : resource;
+}
+
+void SetGlobalMemoryResource(pmr::memory_resource* resource) {
+  globalMemoryResource.store(resource);
+}
+
+pmr::memory_resource* ResolveMemoryResource(pmr::memory_resource* resource) {
+  return resource == nullptr ? GetGlobalMemoryResource() : resource;
+}
+}
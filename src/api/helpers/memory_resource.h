@@ -0,0 +1,65 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_API_HELPERS_MEMORY_RESOURCE
+#define LOOT_API_HELPERS_MEMORY_RESOURCE
+
+#include <vector>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#else
+#include <experimental/memory_resource>
+#endif
+
+#include "loot/memory_resource.h"
+
+namespace loot {
+// Older standard libraries (e.g. GCC 8's) only provide the polymorphic
+// memory resource types as a technical specification.
+#if __has_include(<memory_resource>)
+namespace pmr = std::pmr;
+#else
+namespace pmr = std::experimental::pmr;
+#endif
+
+template<typename T>
+using PolymorphicVector = std::vector<T, pmr::polymorphic_allocator<T>>;
+
+// Gets a memory resource that forwards to the given MemoryResource, or null if
+// the given resource is null. The same adapter is returned each time the same
+// resource is given, and it is never destroyed, so memory allocated through it
+// can be freed through it even after the resource has been replaced.
+pmr::memory_resource* GetMemoryResourceAdapter(MemoryResource* resource);
+// Gets the memory resource set by SetGlobalMemoryResource(), or the default
+// memory resource if none is set.
+pmr::memory_resource* GetGlobalMemoryResource();
+// Sets the memory resource that libloot's internal buffers are allocated from
+// when they have no resource of their own. Passing null restores the default.
+void SetGlobalMemoryResource(pmr::memory_resource* resource);
+// Returns the given resource, or the global memory resource if it is null.
+pmr::memory_resource* ResolveMemoryResource(pmr::memory_resource* resource);
+}
+
+#endif
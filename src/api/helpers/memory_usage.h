@@ -0,0 +1,169 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+#ifndef LOOT_API_HELPERS_MEMORY_USAGE
+#define LOOT_API_HELPERS_MEMORY_USAGE
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "loot/metadata/group.h"
+#include "loot/metadata/plugin_metadata.h"
+
+// Estimates of the heap memory that values hold, used to report memory usage.
+// They count the values' own allocations, including the allocations that
+// containers make for their elements, but not the size of the values
+// themselves or any allocator overhead. Strings short enough to be stored
+// inline don't allocate.
+namespace loot {
+// The memory a node-based container uses per element on top of the element,
+// for the pointers that link the nodes together.
+constexpr size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+constexpr size_t HASH_NODE_OVERHEAD = 2 * sizeof(void*);
+
+template<typename Char>
+size_t EstimateHeapSize(const std::basic_string<Char>& string) {
+  static const size_t inlineCapacity = std::basic_string<Char>().capacity();
+
+  return string.size() > inlineCapacity ? (string.size() + 1) * sizeof(Char)
+                                        : 0;
+}
+
+inline size_t EstimateHeapSize(const std::filesystem::path& path) {
+  return EstimateHeapSize(path.native());
+}
+
+template<typename T>
+size_t EstimateHeapSize(const std::optional<T>& optional) {
+  return optional.has_value() ? EstimateHeapSize(optional.value()) : 0;
+}
+
+template<typename T>
+size_t EstimateHeapSize(const std::vector<T>& vector) {
+  size_t bytes = vector.capacity() * sizeof(T);
+  for (const auto& element : vector) {
+    bytes += EstimateHeapSize(element);
+  }
+  return bytes;
+}
+
+template<typename T>
+size_t EstimateHeapSize(const std::set<T>& set) {
+  size_t bytes = set.size() * (sizeof(T) + TREE_NODE_OVERHEAD);
+  for (const auto& element : set) {
+    bytes += EstimateHeapSize(element);
+  }
+  return bytes;
+}
+
+template<typename T>
+size_t EstimateHeapSize(const std::unordered_set<T>& set) {
+  size_t bytes = set.size() * (sizeof(T) + HASH_NODE_OVERHEAD) +
+                 set.bucket_count() * sizeof(void*);
+  for (const auto& element : set) {
+    bytes += EstimateHeapSize(element);
+  }
+  return bytes;
+}
+
+// Maps take a function that estimates the heap size of a value, so that any
+// value type can be counted.
+template<typename K, typename V, typename F>
+size_t EstimateHeapSize(const std::map<K, V>& map, const F& estimateValue) {
+  size_t bytes = map.size() * (sizeof(K) + sizeof(V) + TREE_NODE_OVERHEAD);
+  for (const auto& [key, value] : map) {
+    bytes += EstimateHeapSize(key) + estimateValue(value);
+  }
+  return bytes;
+}
+
+template<typename K, typename V, typename F>
+size_t EstimateHeapSize(const std::unordered_map<K, V>& map,
+                        const F& estimateValue) {
+  size_t bytes = map.size() * (sizeof(K) + sizeof(V) + HASH_NODE_OVERHEAD) +
+                 map.bucket_count() * sizeof(void*);
+  for (const auto& [key, value] : map) {
+    bytes += EstimateHeapSize(key) + estimateValue(value);
+  }
+  return bytes;
+}
+
+inline size_t EstimateHeapSize(const MessageContent& content) {
+  return EstimateHeapSize(content.GetText()) +
+         EstimateHeapSize(content.GetLanguage());
+}
+
+inline size_t EstimateHeapSize(const Message& message) {
+  return EstimateHeapSize(message.GetContent()) +
+         EstimateHeapSize(message.GetCondition());
+}
+
+inline size_t EstimateHeapSize(const File& file) {
+  return EstimateHeapSize(file.GetName()) +
+         EstimateHeapSize(file.GetDisplayName()) +
+         EstimateHeapSize(file.GetCondition());
+}
+
+inline size_t EstimateHeapSize(const Tag& tag) {
+  return EstimateHeapSize(tag.GetName()) + EstimateHeapSize(tag.GetCondition());
+}
+
+inline size_t EstimateHeapSize(const PluginCleaningData& cleaningData) {
+  return EstimateHeapSize(cleaningData.GetCleaningUtility()) +
+         EstimateHeapSize(cleaningData.GetInfo());
+}
+
+inline size_t EstimateHeapSize(const Location& location) {
+  return EstimateHeapSize(location.GetURL()) +
+         EstimateHeapSize(location.GetName());
+}
+
+inline size_t EstimateHeapSize(const Group& group) {
+  return EstimateHeapSize(group.GetName()) +
+         EstimateHeapSize(group.GetDescription()) +
+         EstimateHeapSize(group.GetAfterGroups());
+}
+
+inline size_t EstimateHeapSize(const PluginMetadata& metadata) {
+  return EstimateHeapSize(metadata.GetName()) +
+         EstimateHeapSize(metadata.GetNormalizedName()) +
+         EstimateHeapSize(metadata.GetGroup()) +
+         EstimateHeapSize(metadata.GetLoadAfterFiles()) +
+         EstimateHeapSize(metadata.GetRequirements()) +
+         EstimateHeapSize(metadata.GetIncompatibilities()) +
+         EstimateHeapSize(metadata.GetMessages()) +
+         EstimateHeapSize(metadata.GetTags()) +
+         EstimateHeapSize(metadata.GetDirtyInfo()) +
+         EstimateHeapSize(metadata.GetCleanInfo()) +
+         EstimateHeapSize(metadata.GetLocations());
+}
+}
+
+#endif
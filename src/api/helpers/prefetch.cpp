@@ -0,0 +1,52 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/helpers/prefetch.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace loot {
+void PrefetchFile(const std::filesystem::path& path, uintmax_t length) {
+#ifdef _WIN32
+  // Windows has no equivalent hint for a file that is read through its own
+  // handle, and its cache manager already reads ahead of sequential reads.
+  (void)path;
+  (void)length;
+#else
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return;
+  }
+
+  // The hint applies to the file's cached pages, not to this descriptor, so
+  // it still helps once the descriptor is closed.
+  posix_fadvise(fd, 0, static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+  close(fd);
+#endif
+}
+}
@@ -0,0 +1,40 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_HELPERS_PREFETCH
+#define LOOT_API_HELPERS_PREFETCH
+
+#include <cstdint>
+#include <filesystem>
+
+namespace loot {
+// Hints to the operating system that the first length bytes of the given file
+// will be read soon, so that it can start reading them into its cache in the
+// background. If length is zero, the whole file is prefetched. This is only a
+// hint: it does nothing on platforms that don't support it, and never throws.
+void PrefetchFile(const std::filesystem::path& path, uintmax_t length = 0);
+}
+
+#endif
@@ -23,9 +23,10 @@
     */
 #include "api/helpers/text.h"
 
-#include <regex>
-
-#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
 
 #ifdef _WIN32
 #include "windows.h"
@@ -35,40 +36,223 @@
 using namespace icu;
 #endif
 
-using std::regex;
-
 namespace loot {
-/* The string below matches timestamps that use forwardslashes for date
-   separators. However, Pseudosem v1.0.1 will only compare the first
-   two digits as it does not recognise forwardslashes as separators. */
-const std::string dateRegex =
-    R"((\d{1,2}/\d{1,2}/\d{1,4} \d{1,2}:\d{1,2}:\d{1,2}))";
-
-/* The string below matches the range of version strings supported by
-   Pseudosem v1.0.1, excluding space separators, as they make version
-   extraction from inside sentences very tricky and have not been
-   seen "in the wild". */
-const std::string pseudosemVersionRegex =
-    R"((\d+(?:\.\d+)+(?:[-._:]?[A-Za-z0-9]+)*))"
-    // The string below prevents version numbers followed by a comma from
-    // matching.
-    R"((?!,))";
-
-/* There are a few different version formats that can appear in strings
-   together, and in order to extract the correct one, they must be searched
-   for in order of priority. */
-const std::vector<regex> versionRegexes({
-    regex(dateRegex, regex::ECMAScript | regex::icase),
-    regex(R"(version:?\s)" + pseudosemVersionRegex,
-          regex::ECMAScript | regex::icase),
-    regex(R"((?:^|v|\s))" + pseudosemVersionRegex,
-          regex::ECMAScript | regex::icase),
-    regex(
-        /* The string below matches a number containing one or more digits
-           found at the start of the search string or preceded by 'v'. */
-        R"((?:^|v)(\d+))",
-        regex::ECMAScript | regex::icase),
-});
+/* Versions are extracted using hand-written matchers that give the same
+   results as searching for the following ECMAScript regular expressions
+   case-insensitively, in order of priority, and using the first sub-match:
+
+   1. (\d{1,2}/\d{1,2}/\d{1,4} \d{1,2}:\d{1,2}:\d{1,2})
+   2. version:?\s<pseudosem>
+   3. (?:^|v|\s)<pseudosem>
+   4. (?:^|v)(\d+)
+
+   where <pseudosem> is (\d+(?:\.\d+)+(?:[-._:]?[A-Za-z0-9]+)*)(?!,)
+
+   The first expression matches timestamps that use forwardslashes for date
+   separators. However, Pseudosem v1.0.1 will only compare the first two digits
+   as it does not recognise forwardslashes as separators.
+
+   <pseudosem> matches the range of version strings supported by Pseudosem
+   v1.0.1, excluding space separators, as they make version extraction from
+   inside sentences very tricky and have not been seen "in the wild". Version
+   numbers followed by a comma are not matched.
+
+   The last expression matches a number containing one or more digits found at
+   the start of the search string or preceded by 'v'.
+
+   std::regex is slow, and plugin descriptions are searched every time plugins
+   are loaded, so matching by hand is much faster. */
+namespace {
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool IsAlphanumeric(char c) {
+  return IsDigit(c) || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+bool IsVersionSeparator(char c) {
+  return c == '-' || c == '.' || c == '_' || c == ':';
+}
+
+// Matches the characters in std::regex's \s class in the classic locale.
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+         c == '\r';
+}
+
+bool IsV(char c) { return c == 'v' || c == 'V'; }
+
+size_t CountDigits(const std::string& text, size_t pos) {
+  size_t count = 0;
+  while (pos + count < text.length() && IsDigit(text[pos + count])) {
+    ++count;
+  }
+  return count;
+}
+
+// Matches a run of between 1 and maxDigits digits that is followed by the
+// given separator, returning the position after the separator, or npos.
+size_t MatchDigitsThen(const std::string& text,
+                       size_t pos,
+                       size_t maxDigits,
+                       char separator) {
+  auto count = CountDigits(text, pos);
+  if (count == 0 || count > maxDigits || pos + count >= text.length() ||
+      text[pos + count] != separator) {
+    return std::string::npos;
+  }
+  return pos + count + 1;
+}
+
+// Equivalent to matching dateRegex at pos, returning the end of the match or
+// npos.
+size_t MatchDate(const std::string& text, size_t pos) {
+  // The maximum number of digits in each field, and the separator after it.
+  static const std::pair<size_t, char> fields[] = {
+      {2, '/'}, {2, '/'}, {4, ' '}, {2, ':'}, {2, ':'}};
+  for (const auto& field : fields) {
+    pos = MatchDigitsThen(text, pos, field.first, field.second);
+    if (pos == std::string::npos) {
+      return pos;
+    }
+  }
+
+  auto count = CountDigits(text, pos);
+  if (count == 0) {
+    return std::string::npos;
+  }
+  return pos + std::min(count, size_t(2));
+}
+
+// Equivalent to matching pseudosemVersionRegex at pos, returning the end of
+// the match or npos.
+size_t MatchPseudosemVersion(const std::string& text, size_t pos) {
+  // The leading digits can't backtrack, as they must be followed by a period.
+  auto start = pos;
+  pos += CountDigits(text, pos);
+  if (pos == start || pos + 1 >= text.length() || text[pos] != '.' ||
+      !IsDigit(text[pos + 1])) {
+    return std::string::npos;
+  }
+
+  // The shortest possible match ends after the first digit after the period.
+  auto minEnd = pos + 2;
+  pos = minEnd;
+
+  // Everything after that is matched greedily, as separators that are each
+  // followed by an alphanumeric character, or alphanumeric characters.
+  while (pos < text.length()) {
+    if (IsAlphanumeric(text[pos])) {
+      ++pos;
+    } else if (IsVersionSeparator(text[pos]) && pos + 1 < text.length() &&
+               IsAlphanumeric(text[pos + 1])) {
+      pos += 2;
+    } else {
+      break;
+    }
+  }
+
+  if (pos == text.length() || text[pos] != ',') {
+    return pos;
+  }
+
+  // The lookahead failed, so backtrack to the last alphanumeric character.
+  // The character after it can't be a comma, as it's part of the match.
+  for (--pos; pos >= minEnd; --pos) {
+    if (IsAlphanumeric(text[pos - 1])) {
+      return pos;
+    }
+  }
+
+  return std::string::npos;
+}
+
+std::optional<std::string> ExtractDate(const std::string& text) {
+  for (size_t pos = 0; pos < text.length(); ++pos) {
+    auto end = MatchDate(text, pos);
+    if (end != std::string::npos) {
+      return text.substr(pos, end - pos);
+    }
+  }
+
+  return std::nullopt;
+}
+
+// Equivalent to searching for "version:?\s" followed by a pseudosem version,
+// case-insensitively.
+std::optional<std::string> ExtractPrefixedVersion(const std::string& text) {
+  static const std::string prefix = "version";
+
+  for (size_t pos = 0; pos + prefix.length() < text.length(); ++pos) {
+    bool isPrefix = std::equal(
+        prefix.begin(), prefix.end(), text.begin() + pos, [](char a, char b) {
+          return a == b || (b >= 'A' && b <= 'Z' && a == b - 'A' + 'a');
+        });
+    if (!isPrefix) {
+      continue;
+    }
+
+    auto versionPos = pos + prefix.length();
+    if (text[versionPos] == ':') {
+      ++versionPos;
+    }
+    if (versionPos >= text.length() || !IsSpace(text[versionPos])) {
+      continue;
+    }
+    ++versionPos;
+
+    auto end = MatchPseudosemVersion(text, versionPos);
+    if (end != std::string::npos) {
+      return text.substr(versionPos, end - versionPos);
+    }
+  }
+
+  return std::nullopt;
+}
+
+// Equivalent to searching for a pseudosem version at the start of the text,
+// or after a 'v' or whitespace character.
+std::optional<std::string> ExtractPseudosemVersion(const std::string& text) {
+  for (size_t pos = 0; pos < text.length(); ++pos) {
+    if (pos == 0) {
+      auto end = MatchPseudosemVersion(text, pos);
+      if (end != std::string::npos) {
+        return text.substr(pos, end - pos);
+      }
+    }
+
+    if (IsV(text[pos]) || IsSpace(text[pos])) {
+      auto versionPos = pos + 1;
+      auto end = MatchPseudosemVersion(text, versionPos);
+      if (end != std::string::npos) {
+        return text.substr(versionPos, end - versionPos);
+      }
+    }
+  }
+
+  return std::nullopt;
+}
+
+// Equivalent to searching for a number at the start of the text or after a
+// 'v'.
+std::optional<std::string> ExtractNumber(const std::string& text) {
+  for (size_t pos = 0; pos < text.length(); ++pos) {
+    auto numberPos = pos;
+    if (pos != 0 || !IsDigit(text[pos])) {
+      if (!IsV(text[pos])) {
+        continue;
+      }
+      numberPos = pos + 1;
+    }
+
+    auto count = CountDigits(text, numberPos);
+    if (count > 0) {
+      return text.substr(numberPos, count);
+    }
+  }
+
+  return std::nullopt;
+}
+}
 
 std::set<Tag> ExtractBashTags(const std::string& description) {
   std::set<Tag> tags;
@@ -84,36 +268,51 @@ std::set<Tag> ExtractBashTags(const std::string& description) {
     return tags;
   }
 
-  auto commaSeparatedTags = description.substr(startPos, endPos - startPos);
+  // Split and trim the tag names in place, so that each is only copied when
+  // its Tag is constructed.
+  const auto isWhitespace = [](char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  };
+  while (true) {
+    auto commaPos = description.find(',', startPos);
+    if (commaPos == std::string::npos || commaPos > endPos) {
+      commaPos = endPos;
+    }
+
+    auto tagStart = startPos;
+    while (tagStart < commaPos && isWhitespace(description[tagStart])) {
+      ++tagStart;
+    }
+    auto tagEnd = commaPos;
+    while (tagEnd > tagStart && isWhitespace(description[tagEnd - 1])) {
+      --tagEnd;
+    }
 
-  std::vector<std::string> bashTags;
-  boost::split(bashTags, commaSeparatedTags, [](char c) { return c == ','; });
+    tags.emplace_hint(tags.end(),
+                      description.substr(tagStart, tagEnd - tagStart));
 
-  for (auto& tag : bashTags) {
-    boost::trim(tag);
-    tags.insert(Tag(tag));
+    if (commaPos == endPos) {
+      break;
+    }
+    startPos = commaPos + 1;
   }
 
   return tags;
 }
 
 std::optional<std::string> ExtractVersion(const std::string& text) {
-  std::smatch what;
-  for (const auto& versionRegex : versionRegexes) {
-    if (std::regex_search(text, what, versionRegex)) {
-      for (auto it = next(begin(what)); it != end(what); ++it) {
-        if (it->str().empty())
-          continue;
-
-        // Use the first non-empty sub-match.
-        std::string version = *it;
-        boost::trim(version);
-        return version;
-      }
-    }
+  auto version = ExtractDate(text);
+  if (!version) {
+    version = ExtractPrefixedVersion(text);
+  }
+  if (!version) {
+    version = ExtractPseudosemVersion(text);
+  }
+  if (!version) {
+    version = ExtractNumber(text);
   }
 
-  return std::nullopt;
+  return version;
 }
 
 #ifdef _WIN32
@@ -134,7 +333,131 @@ std::string FromWinWide(const std::wstring& wstr) {
 }
 #endif
 
+namespace {
+// Almost all filenames are ASCII, and ASCII filenames can be case-folded
+// without ICU or Win32 calls. To match the platform implementations, ASCII
+// letters are folded to uppercase on Windows and lowercase elsewhere. Strings
+// are processed eight bytes at a time, treating each 64-bit word as a vector
+// of bytes.
+typedef uint64_t Word;
+constexpr size_t WORD_SIZE = sizeof(Word);
+constexpr Word ONES = 0x0101010101010101u;
+constexpr Word HIGH_BITS = 0x80 * ONES;
+
+#ifdef _WIN32
+constexpr char FOLD_FIRST = 'a';
+constexpr char FOLD_LAST = 'z';
+#else
+constexpr char FOLD_FIRST = 'A';
+constexpr char FOLD_LAST = 'Z';
+#endif
+
+Word LoadWord(const char* data) {
+  Word word;
+  std::memcpy(&word, data, WORD_SIZE);
+  return word;
+}
+
+// Checks that the string only contains ASCII characters other than NUL, which
+// Win32 string functions treat as a terminator.
+bool IsFoldableAscii(const std::string& text) {
+  size_t i = 0;
+  for (; i + WORD_SIZE <= text.length(); i += WORD_SIZE) {
+    auto word = LoadWord(text.data() + i);
+    if ((word & HIGH_BITS) != 0 || ((word - ONES) & ~word & HIGH_BITS) != 0) {
+      return false;
+    }
+  }
+
+  for (; i < text.length(); ++i) {
+    if (text[i] == '\0' || static_cast<unsigned char>(text[i]) >= 0x80) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+char FoldAscii(char c) {
+  return c >= FOLD_FIRST && c <= FOLD_LAST ? c ^ 0x20 : c;
+}
+
+// The word's bytes must all be ASCII. Adding to each byte sets its high bit if
+// the byte is at least the added value's complement, and can't carry into the
+// next byte, so the range check is done for all eight bytes at once.
+Word FoldAscii(Word word) {
+  auto atLeastFirst = word + (0x80 - FOLD_FIRST) * ONES;
+  auto afterLast = word + (0x80 - FOLD_LAST - 1) * ONES;
+  auto inRange = (atLeastFirst ^ afterLast) & HIGH_BITS;
+
+  // Flipping the 0x20 bit switches an ASCII letter's case.
+  return word ^ (inRange >> 2);
+}
+
+int CompareFoldedAscii(const std::string& lhs, const std::string& rhs) {
+  auto length = std::min(lhs.length(), rhs.length());
+
+  size_t i = 0;
+  for (; i + WORD_SIZE <= length; i += WORD_SIZE) {
+    if (FoldAscii(LoadWord(lhs.data() + i)) !=
+        FoldAscii(LoadWord(rhs.data() + i))) {
+      break;
+    }
+  }
+
+  for (; i < length; ++i) {
+    auto lhsChar = FoldAscii(lhs[i]);
+    auto rhsChar = FoldAscii(rhs[i]);
+    if (lhsChar != rhsChar) {
+      return lhsChar < rhsChar ? -1 : 1;
+    }
+  }
+
+  if (lhs.length() == rhs.length()) {
+    return 0;
+  }
+
+  return lhs.length() < rhs.length() ? -1 : 1;
+}
+
+std::string FoldAscii(const std::string& text) {
+  std::string folded(text.length(), '\0');
+
+  size_t i = 0;
+  for (; i + WORD_SIZE <= text.length(); i += WORD_SIZE) {
+    auto word = FoldAscii(LoadWord(text.data() + i));
+    std::memcpy(&folded[i], &word, WORD_SIZE);
+  }
+
+  for (; i < text.length(); ++i) {
+    folded[i] = FoldAscii(text[i]);
+  }
+
+  return folded;
+}
+
+char ToLowerAscii(char c) { return c >= 'A' && c <= 'Z' ? c ^ 0x20 : c; }
+}
+
+bool EndsWithIgnoringAsciiCase(const std::string& text,
+                               const std::string& suffix) {
+  if (suffix.length() > text.length()) {
+    return false;
+  }
+
+  return std::equal(suffix.begin(),
+                    suffix.end(),
+                    text.end() - suffix.length(),
+                    [](char lhs, char rhs) {
+                      return ToLowerAscii(lhs) == ToLowerAscii(rhs);
+                    });
+}
+
 int CompareFilenames(const std::string& lhs, const std::string& rhs) {
+  if (IsFoldableAscii(lhs) && IsFoldableAscii(rhs)) {
+    return CompareFoldedAscii(lhs, rhs);
+  }
+
 #ifdef _WIN32
   // On Windows, use CompareStringOrdinal as that will perform case conversion
   // using the operating system uppercase table information, which (I think)
@@ -160,6 +483,10 @@ int CompareFilenames(const std::string& lhs, const std::string& rhs) {
 }
 
 std::string NormalizeFilename(const std::string& filename) {
+  if (IsFoldableAscii(filename)) {
+    return FoldAscii(filename);
+  }
+
 #ifdef _WIN32
   auto wideString = ToWinWide(filename);
   CharUpperBuffW(&wideString[0], wideString.length());
@@ -172,4 +499,53 @@ std::string NormalizeFilename(const std::string& filename) {
   return normalizedFilename;
 #endif
 }
+
+int CompareNormalizedFilenames(const std::string& lhs,
+                               const std::string& rhs) {
+  auto mismatch = std::mismatch(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+
+  if (mismatch.first == lhs.end()) {
+    return mismatch.second == rhs.end() ? 0 : -1;
+  }
+  if (mismatch.second == rhs.end()) {
+    return 1;
+  }
+
+  // Both CompareFilenames() implementations compare UTF-16 code units, and
+  // UTF-8 byte order only differs from UTF-16 code unit order in that code
+  // points U+E000 to U+FFFF sort after supplementary code points in UTF-16.
+  // Those code points' UTF-8 lead bytes are 0xEE and 0xEF, and supplementary
+  // code points' lead bytes are 0xF0 to 0xF4, so moving 0xEE and 0xEF above
+  // that range at the first differing byte gives the UTF-16 order. Only lead
+  // bytes need fixing up, as the strings are identical up to this point, so
+  // any differing continuation bytes belong to the same lead byte.
+  auto fixup = [](unsigned char byte) -> unsigned int {
+    return byte == 0xEE || byte == 0xEF ? byte + 0x10 : byte;
+  };
+
+  auto lhsByte = fixup(static_cast<unsigned char>(*mismatch.first));
+  auto rhsByte = fixup(static_cast<unsigned char>(*mismatch.second));
+
+  return lhsByte < rhsByte ? -1 : 1;
+}
+
+std::shared_ptr<const std::string> MakeSharedString(const std::string& value) {
+  if (value.empty()) {
+    return nullptr;
+  }
+
+  return std::make_shared<const std::string>(value);
+}
+
+const std::string& GetSharedString(
+    const std::shared_ptr<const std::string>& value) {
+  static const std::string EMPTY_STRING;
+
+  return value ? *value : EMPTY_STRING;
+}
+
+bool SharedStringsEqual(const std::shared_ptr<const std::string>& lhs,
+                        const std::shared_ptr<const std::string>& rhs) {
+  return lhs == rhs || GetSharedString(lhs) == GetSharedString(rhs);
+}
 }
@@ -25,6 +25,7 @@
 #ifndef LOOT_API_HELPERS_TEXT
 #define LOOT_API_HELPERS_TEXT
 
+#include <memory>
 #include <optional>
 #include <set>
 #include <string>
@@ -36,10 +37,17 @@ std::set<Tag> ExtractBashTags(const std::string& description);
 
 std::optional<std::string> ExtractVersion(const std::string& text);
 
+// Checks if the text ends with the suffix, treating ASCII letters as equal to
+// their other case. Unlike boost::iends_with(), this doesn't depend on the
+// global locale.
+bool EndsWithIgnoringAsciiCase(const std::string& text,
+                               const std::string& suffix);
+
 // Compare strings as if they're filenames, respecting filesystem case
 // insensitivity on Windows. Returns -1 if lhs < rhs, 0 if lhs == rhs, and 1 if
 // lhs > rhs. The comparison may give different results on Linux, but is still
-// locale-invariant.
+// locale-invariant. Filenames that are entirely ASCII are compared without
+// any ICU or Win32 calls.
 int CompareFilenames(const std::string& lhs, const std::string& rhs);
 
 // Normalize the given filename in a way that is locale-invariant. On Windows,
@@ -49,6 +57,26 @@ int CompareFilenames(const std::string& lhs, const std::string& rhs);
 // that the normalized filenames distinguish characters in a similar way to the
 // Windows filesystem.
 std::string NormalizeFilename(const std::string& filename);
+
+// Compare two filenames that have already been normalized using
+// NormalizeFilename(), giving the same result as calling CompareFilenames() on
+// the original filenames. This is much cheaper than CompareFilenames(), as it
+// compares the normalized strings' bytes without any case conversion.
+int CompareNormalizedFilenames(const std::string& lhs, const std::string& rhs);
+
+// Metadata strings are held through shared pointers so that equal strings can
+// be shared between objects. Empty strings are held as null pointers, so that
+// they don't need an allocation.
+std::shared_ptr<const std::string> MakeSharedString(const std::string& value);
+
+// Returns the string that the pointer holds, or an empty string if it is null.
+const std::string& GetSharedString(
+    const std::shared_ptr<const std::string>& value);
+
+// Compares two shared strings' values, without comparing their characters if
+// the pointers are equal.
+bool SharedStringsEqual(const std::shared_ptr<const std::string>& lhs,
+                        const std::shared_ptr<const std::string>& rhs);
 }
 
 #endif
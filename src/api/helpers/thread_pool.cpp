@@ -0,0 +1,318 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#include "api/helpers/thread_pool.h"
+
+#include <algorithm>
+
+using std::lock_guard;
+using std::mutex;
+using std::unique_lock;
+using std::chrono::steady_clock;
+
+namespace loot {
+namespace {
+// The pool that the current thread is a worker of, if any, and its index in
+// that pool.
+thread_local const ThreadPool* currentWorkerPool = nullptr;
+thread_local size_t currentWorkerIndex = 0;
+
+// The pool of the innermost ThreadPoolScope on this thread, if any.
+thread_local std::shared_ptr<ThreadPool> scopedPool;
+
+// The pool for the global executor, if one is set. Only accessed through
+// std::atomic_load() and std::atomic_store().
+std::shared_ptr<ThreadPool>& getGlobalPoolInstance() {
+  static std::shared_ptr<ThreadPool> pool;
+  return pool;
+}
+}
+
+struct ThreadPool::Batch {
+  Batch(const std::vector<std::function<void()>>& tasks, size_t numWorkers) :
+      tasks(&tasks),
+      numTasks(tasks.size()),
+      nextTask(0),
+      remainingTasks(tasks.size()),
+      timings(numWorkers) {}
+
+  // The caller's tasks, which are only valid until Run() returns. Executor
+  // helpers may start after that, so they must check nextTask against
+  // numTasks before reading the tasks.
+  const std::vector<std::function<void()>>* tasks;
+  const size_t numTasks;
+  size_t nextTask;
+  size_t remainingTasks;
+  std::vector<WorkerTiming> timings;
+  std::exception_ptr exception;
+  std::condition_variable finished;
+};
+
+ThreadPool::ThreadPool(size_t numThreads) :
+    stopping_(false), executorConcurrency_(0) {
+  numThreads = std::max(numThreads, (size_t)1);
+
+  for (size_t i = 0; i < numThreads; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::ThreadPool(std::shared_ptr<Executor> executor) :
+    stopping_(false),
+    executor_(executor),
+    executorConcurrency_(std::max(executor->GetConcurrency(), (size_t)1)) {}
+
+ThreadPool::~ThreadPool() {
+  {
+    lock_guard<mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  workAvailable_.notify_all();
+
+  for (auto& worker : workers_) {
+    if (worker.joinable())
+      worker.join();
+  }
+}
+
+size_t ThreadPool::Size() const {
+  return executor_ ? executorConcurrency_ : workers_.size();
+}
+
+std::vector<WorkerTiming> ThreadPool::Run(
+    const std::vector<std::function<void()>>& tasks) {
+  if (tasks.empty()) {
+    return std::vector<WorkerTiming>(Size());
+  }
+
+  auto batch = std::make_shared<Batch>(tasks, Size());
+  auto start = steady_clock::now();
+
+  if (executor_) {
+    // The calling thread is worker 0, and the executor gets a task for each
+    // of the pool's other workers that there are batch tasks for.
+    auto self = shared_from_this();
+    const size_t numHelpers = std::min(Size(), tasks.size()) - 1;
+    for (size_t i = 1; i <= numHelpers; ++i) {
+      try {
+        executor_->Submit(
+            [self, batch, i]() { self->RunBatchTasks(batch, i); });
+      } catch (...) {
+        // The calling thread runs any tasks that the helpers don't.
+        break;
+      }
+    }
+
+    RunBatchTasks(batch,
+                  currentWorkerPool == this ? currentWorkerIndex : 0);
+
+    unique_lock<mutex> lock(mutex_);
+    batch->finished.wait(lock, [&]() { return batch->remainingTasks == 0; });
+  } else {
+    unique_lock<mutex> lock(mutex_);
+    queue_.push_back(batch);
+    workAvailable_.notify_all();
+
+    if (currentWorkerPool == this) {
+      while (batch->nextTask < batch->numTasks) {
+        RunNextTask(lock, batch, currentWorkerIndex);
+      }
+    }
+
+    batch->finished.wait(lock, [&]() { return batch->remainingTasks == 0; });
+  }
+
+  auto elapsed = steady_clock::now() - start;
+  for (auto& timing : batch->timings) {
+    if (elapsed > timing.busy) {
+      timing.idle = elapsed - timing.busy;
+    }
+  }
+
+  if (batch->exception) {
+    std::rethrow_exception(batch->exception);
+  }
+
+  return batch->timings;
+}
+
+void ThreadPool::RunInChunks(size_t count,
+                             size_t minParallelCount,
+                             const std::function<void(size_t, size_t)>& func) {
+  static constexpr size_t CHUNKS_PER_WORKER = 4;
+
+  if (count == 0) {
+    return;
+  }
+
+  if (count < minParallelCount || Size() == 1) {
+    func(0, count);
+    return;
+  }
+
+  const size_t numChunks = Size() * CHUNKS_PER_WORKER;
+  const size_t chunkSize = (count + numChunks - 1) / numChunks;
+  std::vector<std::function<void()>> tasks;
+  for (size_t start = 0; start < count; start += chunkSize) {
+    const size_t end = std::min(start + chunkSize, count);
+    tasks.push_back([&func, start, end]() { func(start, end); });
+  }
+
+  Run(tasks);
+}
+
+ThreadPool& ThreadPool::GetShared() {
+  // hardware_concurrency() may be zero, the constructor handles that.
+  static ThreadPool pool(std::thread::hardware_concurrency());
+
+  return pool;
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::GetCurrent() {
+  if (scopedPool) {
+    return scopedPool;
+  }
+
+  auto globalPool = std::atomic_load(&getGlobalPoolInstance());
+  if (globalPool) {
+    return globalPool;
+  }
+
+  // The shared pool is never destroyed before the process exits, so this
+  // doesn't own it.
+  return std::shared_ptr<ThreadPool>(std::shared_ptr<ThreadPool>(),
+                                     &GetShared());
+}
+
+void ThreadPool::SetGlobalExecutor(std::shared_ptr<Executor> executor) {
+  std::shared_ptr<ThreadPool> pool;
+  if (executor) {
+    pool = std::make_shared<ThreadPool>(executor);
+  }
+
+  std::atomic_store(&getGlobalPoolInstance(), std::move(pool));
+}
+
+void ThreadPool::RunNextTask(unique_lock<mutex>& lock,
+                             const std::shared_ptr<Batch>& batch,
+                             size_t workerIndex) {
+  const auto& task = (*batch->tasks)[batch->nextTask];
+  batch->nextTask += 1;
+  if (batch->nextTask == batch->numTasks) {
+    // Batches run through an executor aren't queued.
+    auto it = std::find(queue_.begin(), queue_.end(), batch);
+    if (it != queue_.end()) {
+      queue_.erase(it);
+    }
+  }
+
+  lock.unlock();
+
+  std::exception_ptr exception;
+  auto start = steady_clock::now();
+  try {
+    task();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  auto elapsed = steady_clock::now() - start;
+
+  lock.lock();
+
+  auto& timing = batch->timings[workerIndex];
+  timing.busy += elapsed;
+  timing.tasksRun += 1;
+
+  if (exception && !batch->exception) {
+    batch->exception = exception;
+  }
+
+  batch->remainingTasks -= 1;
+  if (batch->remainingTasks == 0) {
+    batch->finished.notify_all();
+  }
+}
+
+void ThreadPool::WorkerLoop(size_t workerIndex) {
+  currentWorkerPool = this;
+  currentWorkerIndex = workerIndex;
+
+  unique_lock<mutex> lock(mutex_);
+  while (true) {
+    workAvailable_.wait(lock,
+                        [this]() { return stopping_ || !queue_.empty(); });
+
+    // Outstanding work is finished before stopping.
+    if (queue_.empty()) {
+      return;
+    }
+
+    // Copy the pointer, as running the task may remove the batch from the
+    // queue.
+    auto batch = queue_.front();
+    RunNextTask(lock, batch, workerIndex);
+  }
+}
+
+void ThreadPool::RunBatchTasks(const std::shared_ptr<Batch>& batch,
+                               size_t workerIndex) {
+  unique_lock<mutex> lock(mutex_);
+  // A helper that starts after all the batch's tasks have been started may
+  // be running after Run() has returned, so it mustn't touch the tasks.
+  if (batch->nextTask >= batch->numTasks) {
+    return;
+  }
+
+  // Executor threads may run tasks for other pools or for the host, so the
+  // worker state is restored afterwards.
+  auto previousWorkerPool = currentWorkerPool;
+  auto previousWorkerIndex = currentWorkerIndex;
+  currentWorkerPool = this;
+  currentWorkerIndex = workerIndex;
+  // Parallel work started by the tasks uses the same pool.
+  ThreadPoolScope scope(shared_from_this());
+
+  while (batch->nextTask < batch->numTasks) {
+    RunNextTask(lock, batch, workerIndex);
+  }
+  lock.unlock();
+
+  currentWorkerPool = previousWorkerPool;
+  currentWorkerIndex = previousWorkerIndex;
+}
+
+ThreadPoolScope::ThreadPoolScope(std::shared_ptr<ThreadPool> pool) :
+    isActive_(pool != nullptr) {
+  if (isActive_) {
+    previousPool_ = std::move(scopedPool);
+    scopedPool = std::move(pool);
+  }
+}
+
+ThreadPoolScope::~ThreadPoolScope() {
+  if (isActive_) {
+    scopedPool = std::move(previousPool_);
+  }
+}
+}
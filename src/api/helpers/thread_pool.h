@@ -0,0 +1,149 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_API_HELPERS_THREAD_POOL
+#define LOOT_API_HELPERS_THREAD_POOL
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "loot/executor.h"
+
+namespace loot {
+struct WorkerTiming {
+  std::chrono::nanoseconds busy{0};
+  std::chrono::nanoseconds idle{0};
+  size_t tasksRun{0};
+};
+
+// A fixed-size pool of worker threads that pull tasks from a shared FIFO
+// queue, so a worker that finishes early picks up the next outstanding task
+// instead of sitting idle. Tasks submitted in a single Run() call are started
+// in the order given, so callers should order them largest-first for the best
+// load balance.
+class ThreadPool : public std::enable_shared_from_this<ThreadPool> {
+public:
+  explicit ThreadPool(size_t numThreads);
+  // Creates a pool that has no threads of its own, and instead runs tasks
+  // through the given executor, using its concurrency as the pool's size. The
+  // thread that calls Run() counts as one of the pool's workers and runs tasks
+  // too, so Run() finishes even if the executor doesn't start the tasks
+  // submitted to it until the caller's work is done. Such a pool must be owned
+  // by a std::shared_ptr.
+  explicit ThreadPool(std::shared_ptr<Executor> executor);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t Size() const;
+
+  // Runs the given tasks on the pool's workers and blocks until they have all
+  // completed. The returned vector holds one entry per worker thread, giving
+  // how long that worker spent running this batch's tasks and how long it was
+  // not doing so while the batch was outstanding. If any task throws, the
+  // first exception thrown is rethrown once all tasks have completed. If
+  // called from a task running on this pool, the calling worker runs the
+  // tasks itself until they have all been started, so that idle workers can
+  // help with them without the caller waiting on workers that could all be
+  // waiting too.
+  std::vector<WorkerTiming> Run(
+      const std::vector<std::function<void()>>& tasks);
+
+  // Calls func(start, end) for consecutive ranges of item indices that
+  // together cover [0, count). Handing work to the pool has a fixed cost, so
+  // if there are fewer than minParallelCount items, or the pool only has one
+  // worker, func is called once for all the items on the calling thread, and
+  // callers should set minParallelCount to roughly the number of their items
+  // that take as long to process as that cost. Otherwise the items are split
+  // into several chunks per worker and run using Run(), so that workers that
+  // get cheap items can pick up more work.
+  void RunInChunks(size_t count,
+                   size_t minParallelCount,
+                   const std::function<void(size_t, size_t)>& func);
+
+  // Get a pool that is shared by all callers in the process, sized according
+  // to the hardware concurrency available.
+  static ThreadPool& GetShared();
+
+  // Get the pool that parallel work on the calling thread should use: the
+  // pool of the innermost ThreadPoolScope on this thread if there is one,
+  // otherwise the pool for the executor given to SetGlobalExecutor(),
+  // otherwise the shared pool.
+  static std::shared_ptr<ThreadPool> GetCurrent();
+
+  // Makes GetCurrent() use the given executor outside of any ThreadPoolScope.
+  // A null executor restores the use of the shared pool. Work that is already
+  // running keeps using the pool that it started with.
+  static void SetGlobalExecutor(std::shared_ptr<Executor> executor);
+
+private:
+  struct Batch;
+
+  // Runs the next task of the given batch, which must have tasks that have
+  // not been started. The lock must be held on entry, and is held on exit.
+  void RunNextTask(std::unique_lock<std::mutex>& lock,
+                   const std::shared_ptr<Batch>& batch,
+                   size_t workerIndex);
+  void WorkerLoop(size_t workerIndex);
+  // Runs tasks of the given batch on the calling thread as the pool's worker
+  // with the given index, until they have all been started.
+  void RunBatchTasks(const std::shared_ptr<Batch>& batch, size_t workerIndex);
+
+  std::vector<std::thread> workers_;
+  std::deque<std::shared_ptr<Batch>> queue_;
+  bool stopping_;
+
+  // Only set for pools that run their tasks through an executor.
+  std::shared_ptr<Executor> executor_;
+  size_t executorConcurrency_;
+
+  std::mutex mutex_;
+  std::condition_variable workAvailable_;
+};
+
+// While it exists, makes ThreadPool::GetCurrent() return the given pool on
+// the thread that created it. A null pool leaves the current pool unchanged.
+class ThreadPoolScope {
+public:
+  explicit ThreadPoolScope(std::shared_ptr<ThreadPool> pool);
+  ~ThreadPoolScope();
+
+  ThreadPoolScope(const ThreadPoolScope&) = delete;
+  ThreadPoolScope& operator=(const ThreadPoolScope&) = delete;
+
+private:
+  std::shared_ptr<ThreadPool> previousPool_;
+  bool isActive_;
+};
+}
+
+#endif
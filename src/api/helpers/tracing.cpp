@@ -0,0 +1,176 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#include "api/helpers/tracing.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include "loot/exception/file_access_error.h"
+
+namespace loot {
+namespace {
+// Only accessed through std::atomic_load() and std::atomic_store().
+std::shared_ptr<const TraceCallback>& getTraceCallbackInstance() {
+  static std::shared_ptr<const TraceCallback> callback;
+  return callback;
+}
+
+// Span start times are relative to this.
+std::chrono::steady_clock::time_point getTraceEpoch() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return epoch;
+}
+
+uint32_t getTraceThreadId() {
+  static std::atomic<uint32_t> nextThreadId(1);
+  thread_local const uint32_t threadId = nextThreadId++;
+  return threadId;
+}
+
+void writeJsonString(std::ostream& out, const std::string& string) {
+  static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+  out.put('"');
+  for (const char character : string) {
+    switch (character) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(character) < 0x20) {
+          out << "\\u00" << HEX_DIGITS[(character >> 4) & 0xF]
+              << HEX_DIGITS[character & 0xF];
+        } else {
+          out.put(character);
+        }
+    }
+  }
+  out.put('"');
+}
+
+// Writes spans as complete ("X") events in the JSON object format that
+// chrome://tracing and Perfetto read. The event array is closed when the
+// writer is destroyed.
+class TraceFileWriter {
+public:
+  explicit TraceFileWriter(const std::filesystem::path& traceFile) :
+      out_(traceFile, std::ios::binary | std::ios::trunc), isFirstEvent_(true) {
+    if (!out_.is_open()) {
+      throw FileAccessError("Unable to open trace file \"" +
+                            traceFile.u8string() + "\".");
+    }
+
+    out_ << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    out_.flush();
+  }
+
+  ~TraceFileWriter() { out_ << "\n]}\n"; }
+
+  void Write(const TraceSpan& span) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    out_ << (isFirstEvent_ ? "\n" : ",\n");
+    isFirstEvent_ = false;
+
+    out_ << "{\"name\":";
+    writeJsonString(out_, span.name);
+    out_ << ",\"cat\":";
+    writeJsonString(out_, span.category);
+    out_ << ",\"ph\":\"X\",\"ts\":" << span.start.count()
+         << ",\"dur\":" << span.duration.count() << ",\"pid\":1,\"tid\":"
+         << span.threadId;
+    if (!span.detail.empty()) {
+      out_ << ",\"args\":{\"detail\":";
+      writeJsonString(out_, span.detail);
+      out_ << "}";
+    }
+    out_ << "}";
+  }
+
+private:
+  std::ofstream out_;
+  bool isFirstEvent_;
+  std::mutex mutex_;
+};
+}
+
+void setTraceCallback(TraceCallback callback) {
+  // Make sure the epoch is set before any span can start.
+  getTraceEpoch();
+
+  std::shared_ptr<const TraceCallback> newCallback;
+  if (callback) {
+    newCallback = std::make_shared<const TraceCallback>(std::move(callback));
+  }
+
+  getTracingEnabledFlag().store(newCallback != nullptr,
+                                std::memory_order_relaxed);
+  std::atomic_store(&getTraceCallbackInstance(), std::move(newCallback));
+}
+
+void setTraceFile(const std::filesystem::path& traceFile) {
+  auto writer = std::make_shared<TraceFileWriter>(traceFile);
+
+  // The writer is destroyed, completing the file, once the callback has been
+  // replaced and any calls to it have returned.
+  setTraceCallback(
+      [writer](const TraceSpan& span) { writer->Write(span); });
+}
+
+void TraceScope::Record() const {
+  auto callback = std::atomic_load(&getTraceCallbackInstance());
+  if (!callback) {
+    return;
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+
+  TraceSpan span;
+  span.name = name_;
+  span.category = category_;
+  span.detail = detail_;
+  span.start = std::chrono::duration_cast<std::chrono::microseconds>(
+      start_ - getTraceEpoch());
+  span.duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start_);
+  span.threadId = getTraceThreadId();
+
+  try {
+    (*callback)(span);
+  } catch (...) {
+    // Tracing must not affect the work being traced.
+  }
+}
+}
@@ -0,0 +1,101 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+#ifndef LOOT_API_HELPERS_TRACING
+#define LOOT_API_HELPERS_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+#include "loot/struct/trace_span.h"
+
+namespace loot {
+typedef std::function<void(const TraceSpan&)> TraceCallback;
+
+// Checked before doing any other tracing work, so that tracing costs a single
+// relaxed load while it's disabled.
+inline std::atomic<bool>& getTracingEnabledFlag() {
+  static std::atomic<bool> enabled(false);
+  return enabled;
+}
+
+inline bool isTracingEnabled() {
+  return getTracingEnabledFlag().load(std::memory_order_relaxed);
+}
+
+// Replaces the function that ended spans are passed to. An empty function
+// disables tracing. The callback may be called from any thread, and calls
+// may be concurrent. Any exception it throws is discarded.
+void setTraceCallback(TraceCallback callback);
+
+// Replaces the trace callback with one that writes spans to the given file in
+// Chrome's trace event JSON format, which Perfetto can also read. The file is
+// completed when the callback is replaced. Throws FileAccessError if the file
+// can't be opened.
+void setTraceFile(const std::filesystem::path& traceFile);
+
+// Records a span that lasts from its construction to its destruction, if
+// tracing is enabled when it's constructed. The name and category must
+// outlive the scope. The detail is only copied while tracing.
+class TraceScope {
+public:
+  inline TraceScope(const char* name, const char* category) :
+      name_(name), category_(category), isTracing_(isTracingEnabled()) {
+    if (isTracing_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  inline TraceScope(const char* name,
+                    const char* category,
+                    const std::string& detail) :
+      TraceScope(name, category) {
+    if (isTracing_) {
+      detail_ = detail;
+    }
+  }
+
+  inline ~TraceScope() {
+    if (isTracing_) {
+      Record();
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  void Record() const;
+
+  const char* name_;
+  const char* category_;
+  std::string detail_;
+  bool isTracing_;
+  std::chrono::steady_clock::time_point start_;
+};
+}
+
+#endif
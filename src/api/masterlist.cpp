@@ -24,9 +24,13 @@
 
 #include "api/masterlist.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "api/game/game.h"
 #include "api/helpers/git_helper.h"
 #include "api/helpers/logging.h"
+#include "api/metadata_list_cache.h"
 #include "loot/exception/file_access_error.h"
 #include "loot/exception/git_state_error.h"
 
@@ -35,8 +39,92 @@ using std::string;
 namespace fs = std::filesystem;
 
 namespace loot {
+namespace {
+// The number of earlier revisions to try if the latest masterlist can't be
+// parsed.
+constexpr size_t MAX_FALLBACK_REVISIONS = 10;
+
+// A masterlist loaded by Masterlist::LoadShared(), and the contents of the
+// file it was loaded from.
+struct SharedMasterlist {
+  MetadataListSource source;
+  std::weak_ptr<const Masterlist> masterlist;
+};
+
+// Keyed by the absolute paths of the masterlists. Entries are only replaced,
+// never removed, so there's at most one per masterlist path that has been
+// loaded.
+std::mutex sharedMasterlistsMutex;
+std::unordered_map<std::string, SharedMasterlist> sharedMasterlists;
+
+bool IsSameSource(const MetadataListSource& lhs,
+                  const MetadataListSource& rhs) {
+  return lhs.fileSize == rhs.fileSize && lhs.crc == rhs.crc;
+}
+
+std::shared_ptr<const Masterlist> FindSharedMasterlist(
+    const std::string& key,
+    const MetadataListSource& source) {
+  auto it = sharedMasterlists.find(key);
+  if (it == sharedMasterlists.end() ||
+      !IsSameSource(it->second.source, source)) {
+    return nullptr;
+  }
+
+  return it->second.masterlist.lock();
+}
+
+MasterlistRevisionCache::Revision GetRevision(GitHelper& git,
+                                              const fs::path& path) {
+  MasterlistRevisionCache::Revision revision;
+  revision.headId = git.GetHeadCommitId(false);
+  revision.shortHeadId = git.GetHeadCommitId(true);
+  revision.headDate = git.GetHeadCommitDate();
+
+  // Record the file's state before diffing it so that any change made while
+  // it is being diffed will be picked up. The file may not exist, in which
+  // case the revision won't be reused from the cache.
+  std::error_code errorCode;
+  revision.fileSize = fs::file_size(path, errorCode);
+  revision.modificationTime = fs::last_write_time(path, errorCode);
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Diffing masterlist HEAD and working copy.");
+  }
+  revision.isModified = GitHelper::IsFileDifferent(
+      path.parent_path(), path.filename().u8string());
+
+  return revision;
+}
+
+MasterlistRevisionCache::Revision GetRevision(
+    GitHelper& git,
+    const fs::path& path,
+    MasterlistRevisionCache* revisionCache) {
+  if (revisionCache == nullptr) {
+    return GetRevision(git, path);
+  }
+
+  auto revision = revisionCache->GetRevision(path, git.GetHeadCommitId(false));
+  if (revision) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->trace("Using cached masterlist revision {}.", revision->headId);
+    }
+    return revision.value();
+  }
+
+  auto newRevision = GetRevision(git, path);
+  revisionCache->SetRevision(path, newRevision);
+
+  return newRevision;
+}
+}
+
 MasterlistInfo Masterlist::GetInfo(const std::filesystem::path& path,
-                                   bool shortID) {
+                                   bool shortID,
+                                   MasterlistRevisionCache* revisionCache) {
   // Compare HEAD and working copy, and get revision info.
   GitHelper git;
   MasterlistInfo info;
@@ -59,20 +147,18 @@ MasterlistInfo Masterlist::GetInfo(const std::filesystem::path& path,
 
   git.Open(path.parent_path());
 
-  info.revision_id = git.GetHeadCommitId(shortID);
-  info.revision_date = git.GetHeadCommitDate();
+  auto revision = GetRevision(git, path, revisionCache);
 
-  if (logger) {
-    logger->trace("Diffing masterlist HEAD and working copy.");
-  }
-  info.is_modified =
-      GitHelper::IsFileDifferent(path.parent_path(), path.filename().u8string());
+  info.revision_id = shortID ? revision.shortHeadId : revision.headId;
+  info.revision_date = revision.headDate;
+  info.is_modified = revision.isModified;
 
   return info;
 }
 
 bool Masterlist::IsLatest(const std::filesystem::path& path,
-                          const std::string& repoBranch) {
+                          const std::string& repoBranch,
+                          MasterlistRevisionCache* revisionCache) {
   if (repoBranch.empty())
     throw std::invalid_argument("Repository branch must not be empty.");
 
@@ -90,15 +176,89 @@ bool Masterlist::IsLatest(const std::filesystem::path& path,
 
   git.Open(path.parent_path());
 
-  git.Fetch("origin");
+  std::string headId;
+  if (revisionCache != nullptr) {
+    headId = git.GetHeadCommitId(false);
+    auto isLatest = revisionCache->IsLatest(path, repoBranch, headId);
+    if (isLatest) {
+      if (logger) {
+        logger->trace(
+            "Using cached result of checking for a newer masterlist.");
+      }
+      return isLatest.value();
+    }
+  }
+
+  // Listing the remote's refs is much cheaper than fetching from it, and is
+  // enough to tell if the local branch is up to date. Only fetch if it isn't,
+  // so that the remote-tracking branch is updated as before.
+  bool isLatest =
+      git.IsBranchSameAsRemote("origin", repoBranch).value_or(false) &&
+      git.IsBranchCheckedOut(repoBranch);
+  if (isLatest) {
+    if (logger) {
+      logger->trace("The local branch {} is at the remote branch's commit.",
+                    repoBranch);
+    }
+  } else {
+    git.Fetch("origin", repoBranch);
+
+    isLatest = git.BranchExists(repoBranch) &&
+               git.IsBranchUpToDate(repoBranch) &&
+               git.IsBranchCheckedOut(repoBranch);
+  }
+
+  if (revisionCache != nullptr) {
+    revisionCache->SetIsLatest(path, repoBranch, headId, isLatest);
+  }
+
+  return isLatest;
+}
+
+std::shared_ptr<const Masterlist> Masterlist::LoadShared(
+    const std::filesystem::path& path,
+    const std::filesystem::path& cacheFilePath) {
+  const auto key = fs::absolute(path).lexically_normal().u8string();
+  const auto source = MetadataListSource::FromFile(path);
+
+  {
+    std::lock_guard<std::mutex> lock(sharedMasterlistsMutex);
+    auto masterlist = FindSharedMasterlist(key, source);
+    if (masterlist) {
+      auto logger = getLogger();
+      if (logger) {
+        logger->debug("Reusing the already-loaded masterlist at \"{}\".",
+                      path.u8string());
+      }
+      return masterlist;
+    }
+  }
+
+  // Load the masterlist without holding the lock so that loading different
+  // masterlists isn't serialised.
+  auto masterlist = std::make_shared<Masterlist>();
+  if (cacheFilePath.empty()) {
+    masterlist->Load(path);
+  } else {
+    masterlist->Load(path, cacheFilePath);
+  }
+
+  std::lock_guard<std::mutex> lock(sharedMasterlistsMutex);
+  // Another thread may have loaded the same masterlist in the meantime.
+  auto existing = FindSharedMasterlist(key, source);
+  if (existing) {
+    return existing;
+  }
 
-  return git.BranchExists(repoBranch) && git.IsBranchUpToDate(repoBranch) &&
-         git.IsBranchCheckedOut(repoBranch);
+  sharedMasterlists[key] = SharedMasterlist{source, masterlist};
+
+  return masterlist;
 }
 
 bool Masterlist::Update(const std::filesystem::path& path,
                         const std::string& repoUrl,
-                        const std::string& repoBranch) {
+                        const std::string& repoBranch,
+                        MasterlistRevisionCache* revisionCache) {
   GitHelper git;
   auto logger = getLogger();
   fs::path repoPath = path.parent_path();
@@ -123,7 +283,7 @@ bool Masterlist::Update(const std::filesystem::path& path,
     git.SetRemoteUrl("origin", repoUrl);
 
     // Now fetch updates from the remote.
-    git.Fetch("origin");
+    git.Fetch("origin", repoBranch);
 
     if (logger) {
       logger->debug(
@@ -134,11 +294,15 @@ bool Masterlist::Update(const std::filesystem::path& path,
     if (git.BranchExists(repoBranch)) {
       if (git.IsBranchUpToDate(repoBranch) &&
           git.IsBranchCheckedOut(repoBranch) &&
-          !GitHelper::IsFileDifferent(repoPath, filename)) {
+          !GetRevision(git, path, revisionCache).isModified) {
         if (logger) {
           logger->info(
               "Local branch and masterlist file are already up to date.");
         }
+        if (revisionCache != nullptr) {
+          revisionCache->SetIsLatest(
+              path, repoBranch, git.GetHeadCommitId(false), true);
+        }
         return false;
       }
 
@@ -151,11 +315,21 @@ bool Masterlist::Update(const std::filesystem::path& path,
 
   // Now whether the repository was cloned or updated, the working directory
   // contains the latest masterlist. Try parsing it: on failure, detach the HEAD
-  // back one commit and try again.
-  while (true) {
+  // back one commit and try again, up to a limit so that a masterlist that
+  // can't be parsed doesn't walk the whole history.
+  for (size_t fallbacks = 0;; ++fallbacks) {
     try {
       this->Load(path);
 
+      // The branch may not be checked out at its latest commit if the
+      // latest masterlist failed to parse.
+      if (revisionCache != nullptr) {
+        revisionCache->SetIsLatest(path,
+                                   repoBranch,
+                                   git.GetHeadCommitId(false),
+                                   git.IsBranchCheckedOut(repoBranch));
+      }
+
       return true;
     } catch (std::exception& e) {
       if (logger) {
@@ -163,12 +337,12 @@ bool Masterlist::Update(const std::filesystem::path& path,
                       git.GetHeadCommitId(true),
                       e.what());
       }
+
+      if (fallbacks == MAX_FALLBACK_REVISIONS) {
+        throw;
+      }
       git.CheckoutRevision("HEAD^");
     }
   }
-
-  // This should never be reached as git.CheckoutRevision() will throw if it
-  // tries to go one back from the start of history.
-  return true;
 }
 }
@@ -26,23 +26,40 @@
 #define LOOT_API_MASTERLIST
 
 #include <filesystem>
+#include <memory>
 #include <string>
 
+#include "api/masterlist_revision_cache.h"
 #include "api/metadata_list.h"
 #include "loot/struct/masterlist_info.h"
 
 namespace loot {
+// If a revision cache is given, the functions below use it to skip diffing
+// the masterlist and fetching from its remote where they can, and record
+// their results in it.
 class Masterlist : public MetadataList {
 public:
+  // Loads the masterlist at the given path, using the compiled metadata cache
+  // at the given cache path if it's not empty. If a masterlist loaded from the
+  // same path with the same contents is still in use elsewhere in the
+  // process, that masterlist is returned instead of loading another copy.
+  static std::shared_ptr<const Masterlist> LoadShared(
+      const std::filesystem::path& path,
+      const std::filesystem::path& cacheFilePath = "");
+
   bool Update(const std::filesystem::path& path,
               const std::string& repoURL,
-              const std::string& repoBranch);
+              const std::string& repoBranch,
+              MasterlistRevisionCache* revisionCache = nullptr);
 
-  static MasterlistInfo GetInfo(const std::filesystem::path& path,
-                                bool shortID);
+  static MasterlistInfo GetInfo(
+      const std::filesystem::path& path,
+      bool shortID,
+      MasterlistRevisionCache* revisionCache = nullptr);
 
   static bool IsLatest(const std::filesystem::path& path,
-                       const std::string& repoBranch);
+                       const std::string& repoBranch,
+                       MasterlistRevisionCache* revisionCache = nullptr);
 };
 }
 
@@ -0,0 +1,99 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/masterlist_revision_cache.h"
+
+namespace loot {
+MasterlistRevisionCache::MasterlistRevisionCache() : fetchInterval_(0) {}
+
+void MasterlistRevisionCache::SetFetchInterval(std::chrono::seconds interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  fetchInterval_ = interval;
+}
+
+std::optional<MasterlistRevisionCache::Revision>
+MasterlistRevisionCache::GetRevision(const std::filesystem::path& path,
+                                     const std::string& headId) const {
+  std::error_code errorCode;
+  auto fileSize = std::filesystem::file_size(path, errorCode);
+  if (errorCode) {
+    return std::nullopt;
+  }
+
+  auto modificationTime = std::filesystem::last_write_time(path, errorCode);
+  if (errorCode) {
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = revisions_.find(path.u8string());
+  if (it == revisions_.end() || it->second.headId != headId ||
+      it->second.fileSize != fileSize ||
+      it->second.modificationTime != modificationTime) {
+    return std::nullopt;
+  }
+
+  return it->second;
+}
+
+void MasterlistRevisionCache::SetRevision(const std::filesystem::path& path,
+                                          const Revision& revision) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  revisions_.insert_or_assign(path.u8string(), revision);
+}
+
+std::optional<bool> MasterlistRevisionCache::IsLatest(
+    const std::filesystem::path& path,
+    const std::string& branch,
+    const std::string& headId) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = fetchResults_.find(path.u8string());
+  if (it == fetchResults_.end() || it->second.branch != branch ||
+      it->second.headId != headId ||
+      std::chrono::steady_clock::now() - it->second.fetchTime >=
+          fetchInterval_) {
+    return std::nullopt;
+  }
+
+  return it->second.isLatest;
+}
+
+void MasterlistRevisionCache::SetIsLatest(const std::filesystem::path& path,
+                                          const std::string& branch,
+                                          const std::string& headId,
+                                          bool isLatest) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  FetchResult result;
+  result.branch = branch;
+  result.headId = headId;
+  result.fetchTime = std::chrono::steady_clock::now();
+  result.isLatest = isLatest;
+
+  fetchResults_.insert_or_assign(path.u8string(), result);
+}
+}
@@ -0,0 +1,93 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_MASTERLIST_REVISION_CACHE
+#define LOOT_API_MASTERLIST_REVISION_CACHE
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace loot {
+// Caches the results of querying masterlists' Git repositories, so that
+// repeated queries can skip diffing the masterlist and fetching from the
+// remote while the local repository and masterlist file are unchanged.
+class MasterlistRevisionCache {
+public:
+  struct Revision {
+    std::string headId;
+    std::string shortHeadId;
+    std::string headDate;
+    // The state of the masterlist file before it was compared with HEAD.
+    uintmax_t fileSize;
+    std::filesystem::file_time_type modificationTime;
+    bool isModified;
+  };
+
+  MasterlistRevisionCache();
+
+  // Fetch results are reused for this long. If zero, they are not reused.
+  void SetFetchInterval(std::chrono::seconds interval);
+
+  // Returns the cached revision if it was recorded for the given HEAD commit
+  // and the masterlist file still has the recorded size and modification time.
+  std::optional<Revision> GetRevision(const std::filesystem::path& path,
+                                      const std::string& headId) const;
+  void SetRevision(const std::filesystem::path& path,
+                   const Revision& revision);
+
+  // Returns the cached result of checking if the masterlist is the latest
+  // revision of the given branch, if the check was made less than the fetch
+  // interval ago with the given HEAD commit.
+  std::optional<bool> IsLatest(const std::filesystem::path& path,
+                               const std::string& branch,
+                               const std::string& headId) const;
+  // Records the result of a check that has just fetched from the remote.
+  void SetIsLatest(const std::filesystem::path& path,
+                   const std::string& branch,
+                   const std::string& headId,
+                   bool isLatest);
+
+private:
+  struct FetchResult {
+    std::string branch;
+    std::string headId;
+    std::chrono::steady_clock::time_point fetchTime;
+    bool isLatest;
+  };
+
+  std::unordered_map<std::string, Revision> revisions_;
+  std::unordered_map<std::string, FetchResult> fetchResults_;
+  std::chrono::seconds fetchInterval_;
+
+  mutable std::mutex mutex_;
+};
+}
+
+#endif
@@ -24,15 +24,125 @@
 
 #include "api/metadata/condition_evaluator.h"
 
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <optional>
+#include <unordered_map>
 
+#include <boost/algorithm/string.hpp>
+
+#include "api/game/game_policy.h"
 #include "api/helpers/crc.h"
 #include "api/helpers/logging.h"
+#include "api/helpers/memory_usage.h"
+#include "api/helpers/text.h"
+#include "api/helpers/thread_pool.h"
+#include "api/helpers/tracing.h"
 #include "loot/exception/condition_syntax_error.h"
 
 using std::filesystem::u8path;
 
 namespace loot {
+namespace {
+// Appends the conditions of the metadata's files, messages and tags, in that
+// order. Cleaning data is checked using CRCs, so has no conditions.
+void AppendConditions(const PluginMetadata& pluginMetadata,
+                      std::vector<std::string>& conditions) {
+  for (const auto& file : pluginMetadata.GetLoadAfterFiles()) {
+    conditions.push_back(file.GetCondition());
+  }
+  for (const auto& file : pluginMetadata.GetRequirements()) {
+    conditions.push_back(file.GetCondition());
+  }
+  for (const auto& file : pluginMetadata.GetIncompatibilities()) {
+    conditions.push_back(file.GetCondition());
+  }
+  for (const auto& message : pluginMetadata.GetMessages()) {
+    conditions.push_back(message.GetCondition());
+  }
+  for (const auto& tag : pluginMetadata.GetTags()) {
+    conditions.push_back(tag.GetCondition());
+  }
+}
+
+bool IsIdentifierChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// Condition paths that contain any of these characters are regexes.
+bool IsRegexPath(const std::string& path) {
+  return path.find_first_of(":\\*?|[]()^$+{}") != std::string::npos;
+}
+
+bool IsPluginFilename(const std::string& path) {
+  if (path.find('/') != std::string::npos) {
+    return false;
+  }
+
+  auto normalized = NormalizeFilename(path);
+  return boost::ends_with(normalized, ".esp") ||
+         boost::ends_with(normalized, ".esm") ||
+         boost::ends_with(normalized, ".esl");
+}
+
+// A condition that is a single function call with one string argument.
+struct SimpleCondition {
+  std::string function;
+  std::string argument;
+  bool isNegated;
+};
+
+std::optional<SimpleCondition> ParseSimpleCondition(
+    const std::string& condition) {
+  SimpleCondition simpleCondition{"", "", false};
+
+  auto skipSpaces = [&](size_t pos) {
+    pos = condition.find_first_not_of(' ', pos);
+    return pos == std::string::npos ? condition.size() : pos;
+  };
+
+  auto pos = skipSpaces(0);
+  if (condition.compare(pos, 4, "not ") == 0) {
+    simpleCondition.isNegated = true;
+    pos = skipSpaces(pos + 4);
+  }
+
+  auto nameEnd = pos;
+  while (nameEnd < condition.size() && IsIdentifierChar(condition[nameEnd])) {
+    ++nameEnd;
+  }
+  simpleCondition.function = condition.substr(pos, nameEnd - pos);
+
+  pos = skipSpaces(nameEnd);
+  if (pos == condition.size() || condition[pos] != '(') {
+    return std::nullopt;
+  }
+
+  pos = skipSpaces(pos + 1);
+  if (pos == condition.size() || condition[pos] != '"') {
+    return std::nullopt;
+  }
+
+  auto argumentEnd = condition.find('"', pos + 1);
+  if (argumentEnd == std::string::npos) {
+    return std::nullopt;
+  }
+  simpleCondition.argument = condition.substr(pos + 1, argumentEnd - pos - 1);
+
+  pos = skipSpaces(argumentEnd + 1);
+  if (pos == condition.size() || condition[pos] != ')') {
+    return std::nullopt;
+  }
+
+  if (skipSpaces(pos + 1) != condition.size()) {
+    return std::nullopt;
+  }
+
+  return simpleCondition;
+}
+}
+
 void HandleError(const std::string operation, int returnCode) {
   if (returnCode == LCI_OK) {
     return;
@@ -56,202 +166,812 @@ void HandleError(const std::string operation, int returnCode) {
   throw ConditionSyntaxError(err);
 }
 
-int mapGameType(GameType gameType) {
-  switch (gameType) {
-  case GameType::tes3:
-    return LCI_GAME_MORROWIND;
-  case GameType::tes4:
-    return LCI_GAME_OBLIVION;
-  case GameType::tes5:
-    return LCI_GAME_SKYRIM;
-  case GameType::tes5se:
-    return LCI_GAME_SKYRIM_SE;
-  case GameType::tes5vr:
-    return LCI_GAME_SKYRIM_VR;
-  case GameType::fo3:
-    return LCI_GAME_FALLOUT_3;
-  case GameType::fonv:
-    return LCI_GAME_FALLOUT_NV;
-  case GameType::fo4:
-    return LCI_GAME_FALLOUT_4;
-  case GameType::fo4vr:
-    return LCI_GAME_FALLOUT_4_VR;
-  default:
-    throw std::runtime_error("Unrecognised game type encountered while mapping for condition evaluation.");
-  }
-}
-
-std::string IntToHexString(const uint32_t value) {
-  std::stringstream stream;
-  stream << std::hex << value;
-  return stream.str();
+std::string GetChecksumCondition(const std::string& pluginName,
+                                 const PluginCleaningData& cleaningData) {
+  char crc[8];
+  auto crcEnd =
+      std::to_chars(std::begin(crc), std::end(crc), cleaningData.GetCRC(), 16)
+          .ptr;
+
+  std::string condition;
+  condition.reserve(pluginName.size() + (crcEnd - crc) + 14);
+  condition.append("checksum(\"")
+      .append(pluginName)
+      .append("\", ")
+      .append(crc, crcEnd)
+      .append(")");
+
+  return condition;
 }
 
 ConditionEvaluator::ConditionEvaluator(
     const GameType gameType,
-    const std::filesystem::path& dataPath) {
-    lci_state * state = nullptr;
+    const std::filesystem::path& dataPath) :
+    gameType_(gameType),
+    dataPath_(dataPath),
+    stateGeneration_(0),
+    conditionResultsVersion_(0),
+    pluginIndependentResultsVersion_(0),
+    arePluginStatesStale_(false),
+    areInterpreterResultsStale_(false),
+    isProfiling_(false) {}
+
+lci_state* ConditionEvaluator::GetInterpreterState() {
+  // If creating the state throws, it's tried again the next time.
+  std::call_once(lciStateInitFlag_, [this]() {
+    lci_state* state = nullptr;
 
     // This probably isn't correct for API users other than LOOT.
     // But that probably doesn't matter, as the only things conditional
     // on LOOT's version are LOOT-specific messages.
     auto lootPath = std::filesystem::absolute("LOOT.exe");
-    int result = lci_state_create(&state, mapGameType(gameType), dataPath.u8string().c_str(), lootPath.u8string().c_str());
+    int result = lci_state_create(&state,
+                                  GetGamePolicy(gameType_).lciGameId,
+                                  dataPath_.u8string().c_str(),
+                                  lootPath.u8string().c_str());
     HandleError("create state object for condition evaluation", result);
 
     lciState_ = std::shared_ptr<lci_state>(state, lci_state_destroy);
+  });
+
+  return lciState_.get();
 }
 
 bool ConditionEvaluator::Evaluate(const std::string& condition) {
   if (condition.empty())
     return true;
 
-  auto logger = getLogger();
-  if (logger) {
-    logger->trace("Evaluating condition: {}", condition);
+  uint64_t resultsVersion = 0;
+  {
+    std::shared_lock<std::shared_mutex> lock(conditionResultsMutex_);
+    auto it = conditionResults_.find(condition);
+    if (it != conditionResults_.end()) {
+      const bool isTrue = it->second.isTrue;
+      lock.unlock();
+
+      if (isProfiling_) {
+        RecordProfile(condition, true, std::chrono::steady_clock::duration(0));
+      }
+      return isTrue;
+    }
+    resultsVersion = conditionResultsVersion_;
   }
 
-  int result = lci_condition_eval(condition.c_str(), lciState_.get());
-  if (result != LCI_RESULT_FALSE && result != LCI_RESULT_TRUE) {
-    HandleError("evaluate condition \"" + condition + "\"", result);
+  const bool isTrue = EvaluateUncached(condition, true);
+  auto dependencies = GetDependencies(condition);
+
+  std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+  if (conditionResultsVersion_ == resultsVersion) {
+    conditionResults_.emplace(condition,
+                              CachedResult{isTrue, std::move(dependencies)});
   }
 
-  return result == LCI_RESULT_TRUE;
+  return isTrue;
 }
 
-PluginMetadata ConditionEvaluator::EvaluateAll(const PluginMetadata& pluginMetadata) {
-  PluginMetadata evaluatedMetadata(pluginMetadata.GetName());
-  evaluatedMetadata.SetEnabled(pluginMetadata.IsEnabled());
-  evaluatedMetadata.SetLocations(pluginMetadata.GetLocations());
+void ConditionEvaluator::PrecomputeConditions(
+    const PluginMetadata& pluginMetadata) {
+  std::vector<std::string> conditions;
+  AppendConditions(pluginMetadata, conditions);
+
+  for (const auto& condition : conditions) {
+    if (condition.empty()) {
+      continue;
+    }
+
+    auto dependencies = GetDependencies(condition);
+    if (!dependencies.loadedPlugins.empty()) {
+      continue;
+    }
+
+    uint64_t resultsVersion = 0;
+    {
+      std::shared_lock<std::shared_mutex> lock(conditionResultsMutex_);
+      if (conditionResults_.count(condition) != 0) {
+        continue;
+      }
+      resultsVersion = pluginIndependentResultsVersion_;
+    }
 
-  if (pluginMetadata.GetGroup()) {
-    evaluatedMetadata.SetGroup(pluginMetadata.GetGroup().value());
+    const bool isTrue = EvaluateUncached(condition, false);
+
+    std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+    if (pluginIndependentResultsVersion_ == resultsVersion) {
+      conditionResults_.emplace(condition,
+                                CachedResult{isTrue, std::move(dependencies)});
+    }
   }
+}
 
-  std::set<File> fileSet;
-  for (const auto& file : pluginMetadata.GetLoadAfterFiles()) {
-    if (Evaluate(file.GetCondition()))
-      fileSet.insert(file);
+bool ConditionEvaluator::EvaluateUncached(const std::string& condition,
+                                          bool givePluginStates) {
+  bool isTrue = false;
+  const bool isProfiling = isProfiling_;
+  const auto start = isProfiling ? std::chrono::steady_clock::now()
+                                 : std::chrono::steady_clock::time_point();
+  std::optional<bool> stateResult;
+  {
+    std::shared_lock<std::shared_mutex> lock(conditionResultsMutex_);
+    stateResult = EvaluateFromState(condition);
   }
-  evaluatedMetadata.SetLoadAfterFiles(fileSet);
 
-  fileSet.clear();
-  for (const auto& file : pluginMetadata.GetRequirements()) {
-    if (Evaluate(file.GetCondition()))
-      fileSet.insert(file);
+  if (stateResult.has_value()) {
+    isTrue = stateResult.value();
+    if (isProfiling) {
+      RecordProfile(condition, false, std::chrono::steady_clock::now() - start);
+    }
+  } else {
+    // Even a condition that doesn't depend on plugin states needs the
+    // interpreter's cache to be cleared if its files may have changed.
+    if (givePluginStates || areInterpreterResultsStale_) {
+      SetInterpreterPluginStates();
+    }
+
+    auto logger = getLogger();
+    if (logger) {
+      logger->trace("Evaluating condition: {}", condition);
+    }
+
+    const auto interpreterStart =
+        isProfiling ? std::chrono::steady_clock::now()
+                    : std::chrono::steady_clock::time_point();
+    int result = lci_condition_eval(condition.c_str(), GetInterpreterState());
+    if (isProfiling) {
+      RecordProfile(condition,
+                    false,
+                    std::chrono::steady_clock::now() - interpreterStart);
+    }
+    if (result != LCI_RESULT_FALSE && result != LCI_RESULT_TRUE) {
+      HandleError("evaluate condition \"" + condition + "\"", result);
+    }
+
+    isTrue = result == LCI_RESULT_TRUE;
   }
-  evaluatedMetadata.SetRequirements(fileSet);
 
-  fileSet.clear();
-  for (const auto& file : pluginMetadata.GetIncompatibilities()) {
-    if (Evaluate(file.GetCondition()))
-      fileSet.insert(file);
+  return isTrue;
+}
+
+PluginMetadata ConditionEvaluator::EvaluateAll(const PluginMetadata& pluginMetadata) {
+  return EvaluateAll(std::vector<PluginMetadata>({pluginMetadata}))[0];
+}
+
+std::vector<bool> ConditionEvaluator::Evaluate(
+    const std::vector<std::string>& conditions) {
+  // Most conditions are cheap to evaluate, being cached or quick to parse and
+  // check, so it takes this many to outweigh the cost of using the pool.
+  static constexpr size_t MIN_PARALLEL_CONDITIONS = 64;
+
+  std::unordered_map<std::string, size_t> uniqueIndices;
+  std::vector<const std::string*> uniqueConditions;
+  std::vector<size_t> resultIndices;
+  resultIndices.reserve(conditions.size());
+  for (const auto& condition : conditions) {
+    auto it = uniqueIndices.emplace(condition, uniqueConditions.size()).first;
+    if (it->second == uniqueConditions.size()) {
+      uniqueConditions.push_back(&it->first);
+    }
+    resultIndices.push_back(it->second);
   }
-  evaluatedMetadata.SetIncompatibilities(fileSet);
 
-  std::vector<Message> messages;
-  for (const auto& message : pluginMetadata.GetMessages()) {
-    if (Evaluate(message.GetCondition()))
-      messages.push_back(message);
+  // Use char rather than bool so that workers write to distinct bytes.
+  std::vector<char> uniqueResults(uniqueConditions.size());
+  ThreadPool::GetCurrent()->RunInChunks(
+      uniqueConditions.size(),
+      MIN_PARALLEL_CONDITIONS,
+      [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+          uniqueResults[i] = Evaluate(*uniqueConditions[i]);
+        }
+      });
+
+  std::vector<bool> results;
+  results.reserve(resultIndices.size());
+  for (const auto index : resultIndices) {
+    results.push_back(uniqueResults[index] != 0);
   }
-  evaluatedMetadata.SetMessages(messages);
 
-  std::set<Tag> tagSet;
-  for (const auto& tag : pluginMetadata.GetTags()) {
-    if (Evaluate(tag.GetCondition()))
-      tagSet.insert(tag);
+  return results;
+}
+
+std::vector<PluginMetadata> ConditionEvaluator::EvaluateAll(
+    const std::vector<PluginMetadata>& pluginsMetadata) {
+  // Cleaning data applies if the plugin's CRC matches. If the plugin's CRC
+  // is already recorded, compare it directly instead of evaluating a
+  // checksum() condition. Otherwise the plugin wasn't loaded, was loaded
+  // header-only, or hasn't had its CRC calculated yet, so fall back to a
+  // condition, for which the interpreter calculates and caches the CRC.
+  std::vector<uint32_t> recordedCrcs(pluginsMetadata.size(), 0);
+  {
+    std::shared_lock<std::shared_mutex> lock(conditionResultsMutex_);
+    for (size_t i = 0; i < pluginsMetadata.size(); ++i) {
+      const auto& pluginMetadata = pluginsMetadata[i];
+      if (pluginMetadata.GetName().empty() ||
+          pluginMetadata.IsRegexPlugin() ||
+          (pluginMetadata.GetDirtyInfo().empty() &&
+           pluginMetadata.GetCleanInfo().empty())) {
+        continue;
+      }
+
+      auto state = pluginStates_.find(pluginMetadata.GetNormalizedName());
+      if (state != pluginStates_.end()) {
+        recordedCrcs[i] = state->second.crc;
+      }
+    }
   }
-  evaluatedMetadata.SetTags(tagSet);
 
-  if (!evaluatedMetadata.IsRegexPlugin()) {
-    std::set<PluginCleaningData> infoSet;
-    for (const auto& info : pluginMetadata.GetDirtyInfo()) {
-      if (Evaluate(info, pluginMetadata.GetName()))
-        infoSet.insert(info);
+  // Gather all the other conditions, evaluate them as one batch, then use the
+  // results in the same order as the conditions were gathered.
+  std::vector<std::string> conditions;
+  for (size_t i = 0; i < pluginsMetadata.size(); ++i) {
+    const auto& pluginMetadata = pluginsMetadata[i];
+    AppendConditions(pluginMetadata, conditions);
+
+    // Cleaning data can't apply to plugins without names or to regex
+    // entries, so no conditions are needed for them.
+    if (!pluginMetadata.GetName().empty() &&
+        !pluginMetadata.IsRegexPlugin() && recordedCrcs[i] == 0) {
+      for (const auto& info : pluginMetadata.GetDirtyInfo()) {
+        conditions.push_back(
+            GetChecksumCondition(pluginMetadata.GetName(), info));
+      }
+      for (const auto& info : pluginMetadata.GetCleanInfo()) {
+        conditions.push_back(
+            GetChecksumCondition(pluginMetadata.GetName(), info));
+      }
     }
-    evaluatedMetadata.SetDirtyInfo(infoSet);
+  }
+
+  auto results = Evaluate(conditions);
+  auto result = results.cbegin();
+
+  std::vector<PluginMetadata> evaluatedPluginsMetadata;
+  evaluatedPluginsMetadata.reserve(pluginsMetadata.size());
+  for (size_t i = 0; i < pluginsMetadata.size(); ++i) {
+    const auto& pluginMetadata = pluginsMetadata[i];
+    PluginMetadata evaluatedMetadata(pluginMetadata.GetName());
+    evaluatedMetadata.SetEnabled(pluginMetadata.IsEnabled());
+    evaluatedMetadata.SetLocations(pluginMetadata.GetLocations());
+
+    if (pluginMetadata.GetGroup()) {
+      evaluatedMetadata.SetGroup(pluginMetadata.GetGroup().value());
+    }
+
+    std::set<File> fileSet;
+    for (const auto& file : pluginMetadata.GetLoadAfterFiles()) {
+      if (*result++)
+        fileSet.insert(file);
+    }
+    evaluatedMetadata.SetLoadAfterFiles(fileSet);
+
+    fileSet.clear();
+    for (const auto& file : pluginMetadata.GetRequirements()) {
+      if (*result++)
+        fileSet.insert(file);
+    }
+    evaluatedMetadata.SetRequirements(fileSet);
+
+    fileSet.clear();
+    for (const auto& file : pluginMetadata.GetIncompatibilities()) {
+      if (*result++)
+        fileSet.insert(file);
+    }
+    evaluatedMetadata.SetIncompatibilities(fileSet);
+
+    std::vector<Message> messages;
+    for (const auto& message : pluginMetadata.GetMessages()) {
+      if (*result++)
+        messages.push_back(message);
+    }
+    evaluatedMetadata.SetMessages(messages);
 
-    infoSet.clear();
-    for (const auto& info : pluginMetadata.GetCleanInfo()) {
-      if (Evaluate(info, pluginMetadata.GetName()))
-        infoSet.insert(info);
+    std::set<Tag> tagSet;
+    for (const auto& tag : pluginMetadata.GetTags()) {
+      if (*result++)
+        tagSet.insert(tag);
     }
-    evaluatedMetadata.SetCleanInfo(infoSet);
+    evaluatedMetadata.SetTags(tagSet);
+
+    if (!pluginMetadata.GetName().empty() &&
+        !pluginMetadata.IsRegexPlugin()) {
+      const auto crc = recordedCrcs[i];
+      auto applies = [&](const PluginCleaningData& info) {
+        return crc == 0 ? *result++ : info.GetCRC() == crc;
+      };
+
+      std::set<PluginCleaningData> infoSet;
+      for (const auto& info : pluginMetadata.GetDirtyInfo()) {
+        if (applies(info))
+          infoSet.insert(info);
+      }
+      evaluatedMetadata.SetDirtyInfo(infoSet);
+
+      infoSet.clear();
+      for (const auto& info : pluginMetadata.GetCleanInfo()) {
+        if (applies(info))
+          infoSet.insert(info);
+      }
+      evaluatedMetadata.SetCleanInfo(infoSet);
+    }
+
+    evaluatedPluginsMetadata.push_back(evaluatedMetadata);
   }
 
-  return evaluatedMetadata;
+  return evaluatedPluginsMetadata;
 }
 
 void ConditionEvaluator::ClearConditionCache() {
-  int result = lci_state_clear_condition_cache(lciState_.get());
+  {
+    std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+    conditionResults_.clear();
+    ++conditionResultsVersion_;
+    ++pluginIndependentResultsVersion_;
+  }
+
+  int result = lci_state_clear_condition_cache(GetInterpreterState());
   HandleError("clear the condition cache", result);
 }
 
-void ConditionEvaluator::RefreshState(std::shared_ptr<LoadOrderHandler> loadOrderHandler) {
-  ClearConditionCache();
+void ConditionEvaluator::SetProfilingEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(profileMutex_);
+  if (enabled && !isProfiling_) {
+    profile_.clear();
+  }
+  isProfiling_ = enabled;
+}
+
+std::vector<ConditionStatistics> ConditionEvaluator::GetProfile(
+    size_t maxConditions) const {
+  std::vector<ConditionStatistics> statistics;
+  {
+    std::lock_guard<std::mutex> lock(profileMutex_);
+    statistics.reserve(profile_.size());
+    for (const auto& [condition, profile] : profile_) {
+      ConditionStatistics conditionStatistics;
+      conditionStatistics.condition = condition;
+      conditionStatistics.evaluations = profile.evaluations;
+      conditionStatistics.cacheHits = profile.cacheHits;
+      conditionStatistics.totalTime =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              profile.totalTime);
+      statistics.push_back(std::move(conditionStatistics));
+    }
+  }
+
+  const auto isMoreExpensive = [](const ConditionStatistics& lhs,
+                                  const ConditionStatistics& rhs) {
+    if (lhs.totalTime != rhs.totalTime) {
+      return lhs.totalTime > rhs.totalTime;
+    }
+    if (lhs.evaluations != rhs.evaluations) {
+      return lhs.evaluations > rhs.evaluations;
+    }
+    if (lhs.cacheHits != rhs.cacheHits) {
+      return lhs.cacheHits > rhs.cacheHits;
+    }
+    return lhs.condition < rhs.condition;
+  };
+
+  if (maxConditions > 0 && maxConditions < statistics.size()) {
+    std::partial_sort(statistics.begin(),
+                      statistics.begin() + maxConditions,
+                      statistics.end(),
+                      isMoreExpensive);
+    statistics.resize(maxConditions);
+  } else {
+    std::sort(statistics.begin(), statistics.end(), isMoreExpensive);
+  }
+
+  return statistics;
+}
+
+void ConditionEvaluator::RecordProfile(
+    const std::string& condition,
+    bool isCacheHit,
+    std::chrono::steady_clock::duration duration) {
+  std::lock_guard<std::mutex> lock(profileMutex_);
+  // Profiling may have been disabled since the caller checked.
+  if (!isProfiling_) {
+    return;
+  }
+
+  auto& profile = profile_[condition];
+  if (isCacheHit) {
+    profile.cacheHits += 1;
+  } else {
+    profile.evaluations += 1;
+    profile.totalTime += duration;
+  }
+}
+
+size_t ConditionEvaluator::GetConditionCacheMemoryUsage() const {
+  std::shared_lock<std::shared_mutex> lock(conditionResultsMutex_);
+
+  return EstimateHeapSize(conditionResults_, [](const CachedResult& result) {
+    return EstimateHeapSize(result.dependencies.activePlugins) +
+           EstimateHeapSize(result.dependencies.loadedPlugins);
+  });
+}
 
-  std::vector<std::string> activePluginNameStrings = loadOrderHandler->GetActivePlugins();
+void ConditionEvaluator::RefreshState(std::shared_ptr<LoadOrderHandler> loadOrderHandler) {
+  TraceScope traceScope("RefreshActivePluginsState", "metadata");
+  auto loadOrderState = loadOrderHandler->GetState();
   std::vector<const char *> activePluginNames;
-  for (auto& pluginName : activePluginNameStrings) {
+  std::unordered_set<std::string> activePlugins;
+  for (auto& pluginName : loadOrderState->GetActivePlugins()) {
     activePluginNames.push_back(pluginName.c_str());
+    activePlugins.insert(NormalizeFilename(pluginName));
   }
 
-  int result = lci_state_set_active_plugins(lciState_.get(),
+  std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+
+  // The interpreter's own cache can't be partially cleared.
+  int result = lci_state_clear_condition_cache(GetInterpreterState());
+  HandleError("clear the condition cache", result);
+
+  result = lci_state_set_active_plugins(GetInterpreterState(),
     &activePluginNames[0],
     activePluginNames.size());
   HandleError("cache active plugins for condition evaluation", result);
+
+  std::unordered_set<std::string> changedPlugins;
+  for (const auto& plugin : activePlugins) {
+    if (activePlugins_.count(plugin) == 0) {
+      changedPlugins.insert(plugin);
+    }
+  }
+  for (const auto& plugin : activePlugins_) {
+    if (activePlugins.count(plugin) == 0) {
+      changedPlugins.insert(plugin);
+    }
+  }
+  activePlugins_ = std::move(activePlugins);
+
+  if (!changedPlugins.empty()) {
+    for (auto it = conditionResults_.begin(); it != conditionResults_.end();) {
+      const auto& dependencies = it->second.dependencies;
+      bool isAffected = dependencies.dependsOnAnyActivePlugin ||
+                        std::any_of(dependencies.activePlugins.begin(),
+                                    dependencies.activePlugins.end(),
+                                    [&](const std::string& plugin) {
+                                      return changedPlugins.count(plugin) != 0;
+                                    });
+      if (isAffected) {
+        it = conditionResults_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    ++conditionResultsVersion_;
+    ++pluginIndependentResultsVersion_;
+  }
+
+  ++stateGeneration_;
 }
 
 void ConditionEvaluator::RefreshState(std::shared_ptr<GameCache> gameCache) {
-  ClearConditionCache();
+  TraceScope traceScope("RefreshPluginsState", "metadata");
+  std::unordered_map<std::string, PluginState> pluginStates;
+  pluginStates.reserve(gameCache->NumPlugins());
+  gameCache->ForEachPlugin([&](const std::shared_ptr<const Plugin>& plugin) {
+    pluginStates.emplace(plugin->GetNormalizedName(),
+                         PluginState{plugin->GetName(),
+                                     plugin->GetVersion().value_or(""),
+                                     plugin->GetCRCIfCalculated().value_or(0)});
+  });
+
+  std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+
+  std::unordered_set<std::string> changedPlugins;
+  for (const auto& state : pluginStates) {
+    auto oldState = pluginStates_.find(state.first);
+    if (oldState == pluginStates_.end() ||
+        !IsUnchanged(oldState->second, state.second)) {
+      changedPlugins.insert(state.first);
+    }
+  }
+  for (const auto& state : pluginStates_) {
+    if (pluginStates.count(state.first) == 0) {
+      changedPlugins.insert(state.first);
+    }
+  }
+  pluginStates_ = std::move(pluginStates);
+
+  DiscardResults(changedPlugins, true);
+  arePluginStatesStale_ = true;
+  areInterpreterResultsStale_ = true;
+
+  ++stateGeneration_;
+}
 
-  std::vector<std::string> pluginNames;
-  std::vector<std::string> pluginVersionStrings;
-  std::vector<uint32_t> crcs;
-  for (auto plugin : gameCache->GetPlugins()) {
-    pluginNames.push_back(plugin->GetName());
-    pluginVersionStrings.push_back(plugin->GetVersion().value_or(""));
-    crcs.push_back(plugin->GetCRC().value_or(0));
+void ConditionEvaluator::UpdatePluginState(const Plugin& plugin) {
+  PluginState state{plugin.GetName(),
+                    plugin.GetVersion().value_or(""),
+                    plugin.GetCRCIfCalculated().value_or(0)};
+
+  std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+
+  auto it = pluginStates_.find(plugin.GetNormalizedName());
+  if (it == pluginStates_.end()) {
+    pluginStates_.emplace(plugin.GetNormalizedName(), std::move(state));
+  } else if (!IsUnchanged(it->second, state)) {
+    it->second = std::move(state);
+  } else {
+    return;
+  }
+
+  DiscardResults({plugin.GetNormalizedName()}, false);
+  arePluginStatesStale_ = true;
+
+  ++stateGeneration_;
+}
+
+void ConditionEvaluator::RetainPluginStates(
+    const std::vector<std::string>& pluginNames) {
+  std::unordered_set<std::string> retainedPlugins;
+  for (const auto& pluginName : pluginNames) {
+    retainedPlugins.insert(NormalizeFilename(pluginName));
+  }
+
+  std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+
+  std::unordered_set<std::string> removedPlugins;
+  for (auto it = pluginStates_.begin(); it != pluginStates_.end();) {
+    if (retainedPlugins.count(it->first) == 0) {
+      removedPlugins.insert(it->first);
+      it = pluginStates_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  DiscardResults(removedPlugins, true);
+  arePluginStatesStale_ = true;
+  areInterpreterResultsStale_ = true;
+
+  ++stateGeneration_;
+}
+
+void ConditionEvaluator::SetDataDirectorySnapshot(
+    const DataDirectorySnapshot& snapshot) {
+  std::unordered_set<std::string> dataFiles;
+  dataFiles.reserve(snapshot.GetEntries().size());
+  for (const auto& entry : snapshot.GetEntries()) {
+    dataFiles.insert(DataDirectorySnapshot::GetLookupKey(entry.filename));
+  }
+
+  std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+  dataFiles_ = std::move(dataFiles);
+
+  DiscardResults({}, true);
+  areInterpreterResultsStale_ = true;
+
+  ++stateGeneration_;
+}
+
+std::optional<bool> ConditionEvaluator::EvaluateFromState(
+    const std::string& condition) const {
+  auto simpleCondition = ParseSimpleCondition(condition);
+  if (!simpleCondition.has_value() ||
+      IsRegexPath(simpleCondition->argument)) {
+    return std::nullopt;
+  }
+
+  const auto& argument = simpleCondition->argument;
+  std::optional<bool> result;
+  if (simpleCondition->function == "active") {
+    result = activePlugins_.count(NormalizeFilename(argument)) != 0;
+  } else if (simpleCondition->function == "file" && dataFiles_.has_value() &&
+             argument.find_first_of("/\\") == std::string::npos) {
+    // The snapshot only holds the data directory's files, so a missing path
+    // could still be a directory, unless it's a plugin. The interpreter also
+    // checks for ghosted plugins.
+    if (dataFiles_->count(DataDirectorySnapshot::GetLookupKey(argument)) !=
+        0) {
+      result = true;
+    } else if (IsPluginFilename(argument)) {
+      result = dataFiles_->count(
+                   DataDirectorySnapshot::GetLookupKey(argument + ".ghost")) !=
+               0;
+    }
+  }
+
+  if (result.has_value() && simpleCondition->isNegated) {
+    result = !result.value();
+  }
+
+  return result;
+}
+
+// Results that depend on the filesystem in ways that the recorded plugin
+// states don't cover may have changed since they were evaluated. That
+// includes the CRCs and versions of plugins that have no recorded state, or
+// that have no recorded CRC because they were loaded header-only or their CRC
+// hadn't been calculated yet, as the interpreter reads them from disk
+// instead.
+void ConditionEvaluator::DiscardResults(
+    const std::unordered_set<std::string>& plugins,
+    bool includeFileDependencies) {
+  for (auto it = conditionResults_.begin(); it != conditionResults_.end();) {
+    const auto& dependencies = it->second.dependencies;
+    bool isAffected =
+        (includeFileDependencies && dependencies.dependsOnFiles) ||
+        std::any_of(dependencies.loadedPlugins.begin(),
+                    dependencies.loadedPlugins.end(),
+                    [&](const std::string& plugin) {
+                      if (plugins.count(plugin) != 0) {
+                        return true;
+                      }
+                      if (!includeFileDependencies) {
+                        return false;
+                      }
+                      auto state = pluginStates_.find(plugin);
+                      return state == pluginStates_.end() ||
+                             state->second.crc == 0;
+                    });
+    if (isAffected) {
+      it = conditionResults_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ++conditionResultsVersion_;
+  if (includeFileDependencies) {
+    ++pluginIndependentResultsVersion_;
+  }
+}
+
+void ConditionEvaluator::SetInterpreterPluginStates() {
+  if (!arePluginStatesStale_ && !areInterpreterResultsStale_) {
+    return;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(conditionResultsMutex_);
+  if (!arePluginStatesStale_ && !areInterpreterResultsStale_) {
+    return;
   }
 
   std::vector<plugin_version> pluginVersions;
   std::vector<plugin_crc> pluginCrcs;
-  for (size_t i = 0; i < pluginNames.size(); ++i) {
-    if (!pluginVersionStrings[i].empty()) {
+  for (const auto& entry : pluginStates_) {
+    const auto& state = entry.second;
+    if (!state.version.empty()) {
       plugin_version pluginVersion;
-      pluginVersion.plugin_name = pluginNames[i].c_str();
-      pluginVersion.version = pluginVersionStrings[i].c_str();
+      pluginVersion.plugin_name = state.name.c_str();
+      pluginVersion.version = state.version.c_str();
       pluginVersions.push_back(pluginVersion);
     }
 
-    if (crcs[i] != 0) {
+    if (state.crc != 0) {
       plugin_crc pluginCrc;
-      pluginCrc.plugin_name = pluginNames[i].c_str();
-      pluginCrc.crc = crcs[i];
+      pluginCrc.plugin_name = state.name.c_str();
+      pluginCrc.crc = state.crc;
       pluginCrcs.push_back(pluginCrc);
     }
   }
 
-  int result = lci_state_set_plugin_versions(lciState_.get(),
-    &pluginVersions[0],
+  // The interpreter's own cache can't be partially cleared.
+  int result = lci_state_clear_condition_cache(GetInterpreterState());
+  HandleError("clear the condition cache", result);
+
+  result = lci_state_set_plugin_versions(GetInterpreterState(),
+    pluginVersions.data(),
     pluginVersions.size());
   HandleError("cache plugin versions for condition evaluation", result);
 
-  result = lci_state_set_crc_cache(lciState_.get(),
-    &pluginCrcs[0],
+  result = lci_state_set_crc_cache(GetInterpreterState(),
+    pluginCrcs.data(),
     pluginCrcs.size());
   HandleError("fill CRC cache for condition evaluation", result);
+
+  arePluginStatesStale_ = false;
+  areInterpreterResultsStale_ = false;
 }
 
-bool ConditionEvaluator::Evaluate(const PluginCleaningData& cleaningData,
-  const std::string& pluginName) {
-  if (pluginName.empty())
-    return false;
+bool ConditionEvaluator::IsUnchanged(const PluginState& oldState,
+                                     const PluginState& newState) {
+  // A plugin without a recorded CRC was loaded header-only or hasn't had its
+  // CRC calculated yet, so the interpreter calculates it when needed and it
+  // may have changed.
+  return newState.crc != 0 && oldState.crc == newState.crc &&
+         oldState.version == newState.version;
+}
+
+// Finds the functions called in the condition and their first arguments,
+// without fully parsing it, so the dependencies may be overestimated.
+ConditionEvaluator::ConditionDependencies ConditionEvaluator::GetDependencies(
+    const std::string& condition) {
+  ConditionDependencies dependencies;
+
+  size_t pos = 0;
+  while (pos < condition.size()) {
+    if (condition[pos] == '"') {
+      // Skip over strings that aren't first arguments.
+      auto end = condition.find('"', pos + 1);
+      pos = end == std::string::npos ? condition.size() : end + 1;
+      continue;
+    }
+
+    if (!IsIdentifierChar(condition[pos])) {
+      ++pos;
+      continue;
+    }
+
+    auto nameEnd = pos;
+    while (nameEnd < condition.size() && IsIdentifierChar(condition[nameEnd])) {
+      ++nameEnd;
+    }
+    auto function = condition.substr(pos, nameEnd - pos);
+    pos = nameEnd;
+
+    if (function == "not" || function == "and" || function == "or") {
+      continue;
+    }
+
+    pos = condition.find_first_not_of(' ', pos);
+    if (pos == std::string::npos || condition[pos] != '(') {
+      continue;
+    }
 
-  return Evaluate("checksum(\"" + pluginName + "\", " + IntToHexString(cleaningData.GetCRC()) + ")");
+    pos = condition.find_first_not_of(' ', pos + 1);
+    std::string argument;
+    if (pos != std::string::npos && condition[pos] == '"') {
+      auto end = condition.find('"', pos + 1);
+      if (end != std::string::npos) {
+        argument = condition.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+      }
+    }
+
+    if (function == "active") {
+      if (IsRegexPath(argument)) {
+        dependencies.dependsOnAnyActivePlugin = true;
+      } else {
+        dependencies.activePlugins.push_back(NormalizeFilename(argument));
+      }
+    } else if (function == "many_active") {
+      dependencies.dependsOnAnyActivePlugin = true;
+    } else if (function == "checksum" || function == "version" ||
+               function == "is_master") {
+      if (!IsRegexPath(argument) && IsPluginFilename(argument)) {
+        dependencies.loadedPlugins.push_back(NormalizeFilename(argument));
+      } else {
+        dependencies.dependsOnFiles = true;
+      }
+    } else if (function == "file" || function == "readable" ||
+               function == "many" || function == "product_version") {
+      dependencies.dependsOnFiles = true;
+    } else {
+      dependencies.dependsOnAnyActivePlugin = true;
+      dependencies.dependsOnFiles = true;
+    }
+  }
+
+  return dependencies;
+}
+
+uint64_t ConditionEvaluator::GetStateGeneration() const {
+  return stateGeneration_;
 }
 
 void ParseCondition(const std::string& condition) {
+  // Metadata files repeat many of their conditions, and are usually reloaded
+  // with few changes, so conditions that have already been parsed
+  // successfully are remembered for the life of the process and not parsed
+  // again. Conditions that fail to parse are not remembered, so that they
+  // are reported every time they are encountered. The number remembered is
+  // bounded in case an unusually large number of distinct conditions is
+  // parsed.
+  static constexpr size_t MAX_PARSED_CONDITIONS = 65536;
+  static std::unordered_set<std::string> parsedConditions;
+  static std::shared_mutex parsedConditionsMutex;
+
+  {
+    std::shared_lock<std::shared_mutex> lock(parsedConditionsMutex);
+    if (parsedConditions.count(condition) != 0) {
+      return;
+    }
+  }
+
   auto logger = getLogger();
   if (logger) {
     logger->trace("Testing condition syntax: {}", condition);
@@ -259,5 +979,11 @@ void ParseCondition(const std::string& condition) {
 
   int result = lci_condition_parse(condition.c_str());
   HandleError("parse condition \"" + condition + "\"", result);
+
+  std::unique_lock<std::shared_mutex> lock(parsedConditionsMutex);
+  if (parsedConditions.size() >= MAX_PARSED_CONDITIONS) {
+    parsedConditions.clear();
+  }
+  parsedConditions.insert(condition);
 }
 }
@@ -25,15 +25,26 @@
 #ifndef LOOT_API_METADATA_CONDITION_EVALUATOR
 #define LOOT_API_METADATA_CONDITION_EVALUATOR
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <loot_condition_interpreter.h>
 
+#include "api/game/data_directory_snapshot.h"
 #include "api/game/game_cache.h"
 #include "api/game/load_order_handler.h"
 #include "loot/metadata/plugin_cleaning_data.h"
 #include "loot/metadata/plugin_metadata.h"
+#include "loot/struct/condition_statistics.h"
 
 namespace loot {
 class ConditionEvaluator {
@@ -44,14 +55,166 @@ public:
   bool Evaluate(const std::string& condition);
   PluginMetadata EvaluateAll(const PluginMetadata& pluginMetadata);
 
+  // Evaluates the given conditions, returning their results in the same
+  // order. Each distinct condition is only evaluated once, and if there are
+  // enough of them they are evaluated in parallel.
+  std::vector<bool> Evaluate(const std::vector<std::string>& conditions);
+  // Equivalent to calling EvaluateAll() on each object, but evaluates all
+  // their conditions together as one batch.
+  std::vector<PluginMetadata> EvaluateAll(
+      const std::vector<PluginMetadata>& pluginsMetadata);
+
   void ClearConditionCache();
+  // An estimate of the memory used by the cached condition results, in bytes.
+  // The interpreter's own cache isn't counted, as its size isn't exposed.
+  size_t GetConditionCacheMemoryUsage() const;
+  // Refreshing the state only discards the cached results of conditions that
+  // may be affected by the changes: refreshing the active plugins discards
+  // results that depend on the active state of plugins that were activated or
+  // deactivated, and refreshing from the game cache discards results that
+  // depend on the filesystem, apart from those that only depend on the CRCs
+  // and versions of plugins that are unchanged in the cache.
   void RefreshState(std::shared_ptr<LoadOrderHandler> loadOrderHandler);
   void RefreshState(std::shared_ptr<GameCache> gameCache);
-private:
-  bool Evaluate(const PluginCleaningData& cleaningData,
-    const std::string& pluginName);
 
+  // Records the CRC and version of a single loaded plugin, discarding only
+  // the cached results that depend on them, so that plugins can be added to
+  // the state as they are loaded instead of rebuilding it all afterwards.
+  // The interpreter is given the updated state before the next condition is
+  // evaluated.
+  void UpdatePluginState(const Plugin& plugin);
+  // Forgets the CRCs and versions of any plugins that aren't named, and
+  // discards results that depend on the filesystem, as plugins are only
+  // retained when they are reloaded from disk.
+  void RetainPluginStates(const std::vector<std::string>& pluginNames);
+
+  // Evaluates and caches the results of the metadata's conditions that don't
+  // depend on any plugin's CRC, version or master flag, so that they can be
+  // evaluated while plugins are still being loaded. The interpreter isn't
+  // given plugin states that have changed since it was last given them, and
+  // results are only discarded by changes that could affect them, so this
+  // doesn't slow down as plugins' states are updated.
+  void PrecomputeConditions(const PluginMetadata& pluginMetadata);
+
+  // Records which files are in the data directory snapshot, so that simple
+  // file() conditions can be answered without the interpreter checking the
+  // filesystem. Simple active() conditions are answered from the active
+  // plugins given by the last refresh. Discards results that depend on the
+  // filesystem.
+  void SetDataDirectorySnapshot(const DataDirectorySnapshot& snapshot);
+
+  // Incremented each time the state is refreshed, so that results derived
+  // from evaluating conditions can be invalidated when the game state changes.
+  uint64_t GetStateGeneration() const;
+
+  // While profiling is enabled, each call to Evaluate() for a non-empty
+  // condition records a cache hit or an evaluation and its duration against
+  // the condition string. Enabling profiling discards the existing profile.
+  void SetProfilingEnabled(bool enabled);
+  // Gets the statistics for the given number of conditions that took the most
+  // time to evaluate, or for all conditions if the number is zero, as
+  // described for GameInterface::GetConditionStatistics().
+  std::vector<ConditionStatistics> GetProfile(size_t maxConditions) const;
+private:
+  // The parts of the game state that a condition's result depends on.
+  struct ConditionDependencies {
+    // The normalized names of plugins whose active state matters.
+    std::vector<std::string> activePlugins;
+    // The normalized names of plugins whose CRC, version or master flag
+    // matters.
+    std::vector<std::string> loadedPlugins;
+    // True if the condition has a regex active plugin check, or anything
+    // else that could depend on any plugin's active state.
+    bool dependsOnAnyActivePlugin = false;
+    // True if the condition depends on anything on the filesystem that isn't
+    // covered by loadedPlugins.
+    bool dependsOnFiles = false;
+  };
+
+  struct CachedResult {
+    bool isTrue;
+    ConditionDependencies dependencies;
+  };
+
+  struct ConditionProfile {
+    size_t evaluations = 0;
+    size_t cacheHits = 0;
+    std::chrono::steady_clock::duration totalTime{0};
+  };
+
+  struct PluginState {
+    std::string name;
+    std::string version;
+    uint32_t crc;
+  };
+
+  static ConditionDependencies GetDependencies(const std::string& condition);
+
+  // Gets the result of a condition that is a single file() or active() call,
+  // optionally negated, if it can be determined from the recorded state.
+  // Must be called with a lock held.
+  std::optional<bool> EvaluateFromState(const std::string& condition) const;
+
+  // Evaluates a condition without checking for a cached result. If
+  // givePluginStates is false, the interpreter's cache is only cleared if
+  // results that don't depend on plugin states may be stale, so the condition
+  // must not depend on plugin states.
+  bool EvaluateUncached(const std::string& condition, bool givePluginStates);
+
+  // Discards the cached results of conditions that depend on any of the
+  // given plugins' CRCs and versions, or on the filesystem if
+  // includeFileDependencies is true. Must be called with a unique lock held.
+  void DiscardResults(const std::unordered_set<std::string>& plugins,
+                      bool includeFileDependencies);
+  // Gives the interpreter the plugin CRCs and versions recorded since they
+  // were last given to it, if any.
+  void SetInterpreterPluginStates();
+  void RecordProfile(const std::string& condition,
+                     bool isCacheHit,
+                     std::chrono::steady_clock::duration duration);
+  static bool IsUnchanged(const PluginState& oldState,
+                          const PluginState& newState);
+  // The interpreter's state is only created when it's first needed, because
+  // creating it is relatively expensive and many game handles never evaluate
+  // any conditions.
+  lci_state* GetInterpreterState();
+
+  const GameType gameType_;
+  const std::filesystem::path dataPath_;
+  std::once_flag lciStateInitFlag_;
   std::shared_ptr<lci_state> lciState_;
+  std::atomic<uint64_t> stateGeneration_;
+
+  // The results of conditions evaluated since the condition cache was last
+  // cleared, so that each distinct condition only has to be parsed and
+  // evaluated by the interpreter once. Results are discarded when the state
+  // that they depend on changes.
+  std::unordered_map<std::string, CachedResult> conditionResults_;
+  // Incremented whenever results are discarded, so that results evaluated
+  // against an older state are not cached.
+  uint64_t conditionResultsVersion_;
+  // Like conditionResultsVersion_, but only incremented when results that
+  // don't depend on plugin states may be discarded.
+  uint64_t pluginIndependentResultsVersion_;
+  // The state given to the interpreter by the last refreshes, keyed by
+  // normalized plugin name.
+  std::unordered_set<std::string> activePlugins_;
+  std::unordered_map<std::string, PluginState> pluginStates_;
+  // The lookup keys of the files in the data directory snapshot, or nullopt
+  // if no snapshot has been given.
+  std::optional<std::unordered_set<std::string>> dataFiles_;
+  // True if pluginStates_ has changed since it was given to the interpreter.
+  std::atomic<bool> arePluginStatesStale_;
+  // True if the interpreter's cache may hold results that are stale for a
+  // reason other than plugin states changing.
+  std::atomic<bool> areInterpreterResultsStale_;
+  mutable std::shared_mutex conditionResultsMutex_;
+
+  // Checked before recording anything, so that profiling costs nothing more
+  // than a load while it's disabled.
+  std::atomic<bool> isProfiling_;
+  std::unordered_map<std::string, ConditionProfile> profile_;
+  mutable std::mutex profileMutex_;
 };
 
 void ParseCondition(const std::string& condition);
@@ -26,6 +26,7 @@
 
 #include "api/game/game.h"
 #include "api/helpers/logging.h"
+#include "api/helpers/text.h"
 #include "api/metadata/condition_evaluator.h"
 
 using std::string;
@@ -34,15 +35,19 @@ namespace loot {
 ConditionalMetadata::ConditionalMetadata() {}
 
 ConditionalMetadata::ConditionalMetadata(const string& condition) :
-    condition_(condition) {}
+    condition_(MakeSharedString(condition)) {}
 
-bool ConditionalMetadata::IsConditional() const { return !condition_.empty(); }
+bool ConditionalMetadata::IsConditional() const {
+  return condition_ != nullptr;
+}
 
-std::string ConditionalMetadata::GetCondition() const { return condition_; }
+const std::string& ConditionalMetadata::GetCondition() const {
+  return GetSharedString(condition_);
+}
 
 void ConditionalMetadata::ParseCondition() const {
-  if (!condition_.empty()) {
-    loot::ParseCondition(condition_);
+  if (condition_) {
+    loot::ParseCondition(*condition_);
   }
 }
 }
@@ -35,24 +35,27 @@ File::File() {}
 File::File(const std::string& name,
            const std::string& display,
            const std::string& condition) :
-    name_(name),
-    display_(display),
-    ConditionalMetadata(condition) {}
+    ConditionalMetadata(condition),
+    name_(MakeSharedString(name)),
+    display_(MakeSharedString(display)) {}
 
 bool File::operator<(const File& rhs) const {
-  return CompareFilenames(name_, rhs.name_) < 0;
+  return CompareFilenames(GetSharedString(name_),
+                          GetSharedString(rhs.name_)) < 0;
 }
 
 bool File::operator==(const File& rhs) const {
-  return CompareFilenames(name_, rhs.name_) == 0;
+  return name_ == rhs.name_ ||
+         CompareFilenames(GetSharedString(name_),
+                          GetSharedString(rhs.name_)) == 0;
 }
 
-std::string File::GetName() const { return name_; }
+std::string File::GetName() const { return GetSharedString(name_); }
 
 std::string File::GetDisplayName() const {
-  if (display_.empty())
-    return name_;
+  if (!display_)
+    return GetSharedString(name_);
   else
-    return display_;
+    return *display_;
 }
 }
@@ -24,22 +24,24 @@
 
 #include "loot/metadata/location.h"
 
+#include "api/helpers/text.h"
+
 namespace loot {
 Location::Location() {}
 
 Location::Location(const std::string& url, const std::string& name) :
-    url_(url),
-    name_(name) {}
+    url_(MakeSharedString(url)),
+    name_(MakeSharedString(name)) {}
 
 bool Location::operator<(const Location& rhs) const {
-  return url_ < rhs.url_;
+  return GetSharedString(url_) < GetSharedString(rhs.url_);
 }
 
 bool Location::operator==(const Location& rhs) const {
-  return url_ == rhs.url_;
+  return SharedStringsEqual(url_, rhs.url_);
 }
 
-std::string Location::GetURL() const { return url_; }
+std::string Location::GetURL() const { return GetSharedString(url_); }
 
-std::string Location::GetName() const { return name_; }
+std::string Location::GetName() const { return GetSharedString(name_); }
 }
@@ -68,19 +68,39 @@ bool Message::operator==(const Message& rhs) const {
 
 MessageType Message::GetType() const { return type_; }
 
-std::vector<MessageContent> Message::GetContent() const { return content_; }
+const std::vector<MessageContent>& Message::GetContent() const {
+  return content_;
+}
 MessageContent Message::GetContent(const std::string& language) const {
   return MessageContent::Choose(content_, language);
 }
 SimpleMessage Message::ToSimpleMessage(const std::string& language) const {
-  MessageContent content = GetContent(language);
+  SimpleMessageView view = ToSimpleMessageView(language);
   SimpleMessage simpleMessage;
 
-  simpleMessage.type = GetType();
-  simpleMessage.language = content.GetLanguage();
-  simpleMessage.text = content.GetText();
-  simpleMessage.condition = GetCondition();
+  simpleMessage.type = view.type;
+  simpleMessage.language = std::string(view.language);
+  simpleMessage.text = std::string(view.text);
+  simpleMessage.condition = std::string(view.condition);
 
   return simpleMessage;
 }
+
+SimpleMessageView Message::ToSimpleMessageView(
+    const std::string& language) const {
+  SimpleMessageView view;
+
+  view.type = GetType();
+  view.condition = GetCondition();
+
+  auto content = MessageContent::ChoosePointer(content_, language);
+  if (content == nullptr) {
+    view.language = MessageContent::defaultLanguage;
+  } else {
+    view.language = content->GetLanguage();
+    view.text = content->GetText();
+  }
+
+  return view;
+}
 }
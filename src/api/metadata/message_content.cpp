@@ -26,6 +26,8 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include "api/helpers/text.h"
+
 namespace loot {
 const std::string MessageContent::defaultLanguage = "en";
 
@@ -33,33 +35,43 @@ MessageContent::MessageContent() : language_(MessageContent::defaultLanguage) {}
 
 MessageContent::MessageContent(const std::string& text,
                                const std::string& language) :
-    text_(text),
+    text_(MakeSharedString(text)),
     language_(language) {}
 
-std::string MessageContent::GetText() const { return text_; }
+const std::string& MessageContent::GetText() const {
+  return GetSharedString(text_);
+}
 
-std::string MessageContent::GetLanguage() const { return language_; }
+const std::string& MessageContent::GetLanguage() const { return language_; }
 
 bool MessageContent::operator<(const MessageContent& rhs) const {
-  return text_ < rhs.text_;
+  return GetText() < rhs.GetText();
 }
 
 bool MessageContent::operator==(const MessageContent& rhs) const {
-  return text_ == rhs.text_;
+  return SharedStringsEqual(text_, rhs.text_);
 }
-MessageContent MessageContent::Choose(const std::vector<MessageContent> content,
-                                      const std::string& language) {
+MessageContent MessageContent::Choose(
+    const std::vector<MessageContent>& content,
+    const std::string& language) {
+  auto chosen = ChoosePointer(content, language);
+  return chosen == nullptr ? MessageContent() : *chosen;
+}
+
+const MessageContent* MessageContent::ChoosePointer(
+    const std::vector<MessageContent>& content,
+    const std::string& language) {
   if (content.empty())
-    return MessageContent();
+    return nullptr;
   else if (content.size() == 1)
-    return content[0];
+    return &content[0];
   else {
-    MessageContent english;
+    const MessageContent* english = nullptr;
     for (const auto& mc : content) {
       if (mc.GetLanguage() == language) {
-        return mc;
+        return &mc;
       } else if (mc.GetLanguage() == MessageContent::defaultLanguage)
-        english = mc;
+        english = &mc;
     }
     return english;
   }
@@ -24,10 +24,10 @@
 
 #include "loot/metadata/plugin_metadata.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <regex>
 
-#include <boost/algorithm/string.hpp>
 #include <boost/locale.hpp>
 
 #include "api/game/game.h"
@@ -41,15 +41,151 @@ using std::set;
 using std::vector;
 
 namespace loot {
-PluginMetadata::PluginMetadata() :
-    enabled_(true) {}
+namespace {
+template<typename T>
+const T& GetOrEmpty(const std::shared_ptr<const T>& container) {
+  static const T empty;
+  return container ? *container : empty;
+}
+
+template<typename T>
+std::shared_ptr<const T> Share(T container) {
+  if (container.empty()) {
+    return nullptr;
+  }
+
+  return std::make_shared<const T>(std::move(container));
+}
+
+template<typename T>
+bool IsEmpty(const std::shared_ptr<const T>& container) {
+  return !container || container->empty();
+}
+
+// Merges the source set into the destination set, sharing the source if the
+// destination is empty, and only copying the destination if the source has
+// elements that it doesn't.
+template<typename T>
+void MergeSets(std::shared_ptr<const T>& destination,
+               const std::shared_ptr<const T>& source) {
+  if (IsEmpty(source) || destination == source) {
+    return;
+  }
+
+  if (IsEmpty(destination)) {
+    destination = source;
+    return;
+  }
+
+  // Both sets are sorted, so they can be compared and merged in linear time.
+  if (std::includes(destination->begin(),
+                    destination->end(),
+                    source->begin(),
+                    source->end())) {
+    return;
+  }
+
+  // Inserting in order with an end hint makes each insert constant time.
+  // Elements already in the destination are kept, as with insert().
+  auto merged = std::make_shared<T>();
+  std::set_union(destination->begin(),
+                 destination->end(),
+                 source->begin(),
+                 source->end(),
+                 inserter(*merged, merged->end()));
+  destination = std::move(merged);
+}
+
+// Gets the elements of the first set that aren't in the second, sharing the
+// first set if none of its elements are in the second.
+template<typename T>
+std::shared_ptr<const T> Difference(const std::shared_ptr<const T>& lhs,
+                                    const std::shared_ptr<const T>& rhs) {
+  if (IsEmpty(lhs) || IsEmpty(rhs)) {
+    return IsEmpty(lhs) ? nullptr : lhs;
+  }
+
+  T difference;
+  std::set_difference(lhs->begin(),
+                      lhs->end(),
+                      rhs->begin(),
+                      rhs->end(),
+                      inserter(difference, difference.end()));
+
+  if (difference.size() == lhs->size()) {
+    return lhs;
+  }
+
+  return Share(std::move(difference));
+}
+
+// Gets the messages in the first vector that aren't in the second, in sorted
+// order. Pointers to the messages are sorted instead of copies of them, so
+// that only the messages in the difference are copied.
+std::shared_ptr<const vector<Message>> MessagesDifference(
+    const std::shared_ptr<const vector<Message>>& lhs,
+    const std::shared_ptr<const vector<Message>>& rhs) {
+  if (IsEmpty(lhs)) {
+    return nullptr;
+  }
+
+  auto less = [](const Message* a, const Message* b) { return *a < *b; };
+  auto sortedPointers = [&](const vector<Message>& messages) {
+    vector<const Message*> pointers;
+    pointers.reserve(messages.size());
+    for (const auto& message : messages) {
+      pointers.push_back(&message);
+    }
+    std::sort(pointers.begin(), pointers.end(), less);
+    return pointers;
+  };
+
+  // If there's nothing to remove and the messages are already sorted, the
+  // result is the same as the input.
+  if (IsEmpty(rhs) && std::is_sorted(lhs->begin(), lhs->end())) {
+    return lhs;
+  }
+
+  const auto lhsPointers = sortedPointers(*lhs);
+  vector<const Message*> differencePointers;
+  if (IsEmpty(rhs)) {
+    differencePointers = lhsPointers;
+  } else {
+    const auto rhsPointers = sortedPointers(*rhs);
+    std::set_difference(lhsPointers.begin(),
+                        lhsPointers.end(),
+                        rhsPointers.begin(),
+                        rhsPointers.end(),
+                        std::back_inserter(differencePointers),
+                        less);
+  }
+
+  vector<Message> difference;
+  difference.reserve(differencePointers.size());
+  for (const auto message : differencePointers) {
+    difference.push_back(*message);
+  }
+
+  return Share(std::move(difference));
+}
+}
+
+PluginMetadata::PluginMetadata() : PluginMetadata(std::string()) {}
 
 PluginMetadata::PluginMetadata(const std::string& n) :
     name_(n),
     enabled_(true) {
   // If the name passed ends in '.ghost', that should be trimmed.
-  if (boost::iends_with(name_, ".ghost"))
+  if (EndsWithIgnoringAsciiCase(name_, ".ghost"))
     name_ = name_.substr(0, name_.length() - 6);
+
+  normalizedName_ = NormalizeFilename(name_);
+  normalizedNameHash_ = std::hash<std::string>()(normalizedName_);
+
+  // Treat as regex if the plugin filename contains any of ":\*?|" as
+  // they are not valid Windows filename characters, but have meaning
+  // in regexes.
+  isRegexPlugin_ = strpbrk(name_.c_str(), ":\\*?|") != nullptr;
 }
 
 void PluginMetadata::MergeMetadata(const PluginMetadata& plugin) {
@@ -69,29 +205,32 @@ void PluginMetadata::MergeMetadata(const PluginMetadata& plugin) {
   // condition strings which aren't considered when comparing them, so
   // will be lost if the plugin being merged in has additional data in
   // these strings.
-  loadAfter_.insert(begin(plugin.loadAfter_), end(plugin.loadAfter_));
-  requirements_.insert(begin(plugin.requirements_), end(plugin.requirements_));
-  incompatibilities_.insert(begin(plugin.incompatibilities_),
-                            end(plugin.incompatibilities_));
+  MergeSets(loadAfter_, plugin.loadAfter_);
+  MergeSets(requirements_, plugin.requirements_);
+  MergeSets(incompatibilities_, plugin.incompatibilities_);
 
   // Merge Bash Tags too. Conditions are ignored during comparison, but
   // if a tag is added and removed, both instances will be in the set.
-  tags_.insert(begin(plugin.tags_), end(plugin.tags_));
+  MergeSets(tags_, plugin.tags_);
 
   // Messages are in an ordered list, and should be fully merged.
-  messages_.insert(
-      end(messages_), begin(plugin.messages_), end(plugin.messages_));
+  if (IsEmpty(messages_)) {
+    messages_ = plugin.messages_;
+  } else if (!IsEmpty(plugin.messages_)) {
+    auto messages = std::make_shared<vector<Message>>(*messages_);
+    messages->insert(
+        end(*messages), begin(*plugin.messages_), end(*plugin.messages_));
+    messages_ = std::move(messages);
+  }
 
-  dirtyInfo_.insert(begin(plugin.dirtyInfo_), end(plugin.dirtyInfo_));
-  cleanInfo_.insert(begin(plugin.cleanInfo_), end(plugin.cleanInfo_));
-  locations_.insert(begin(plugin.locations_), end(plugin.locations_));
+  MergeSets(dirtyInfo_, plugin.dirtyInfo_);
+  MergeSets(cleanInfo_, plugin.cleanInfo_);
+  MergeSets(locations_, plugin.locations_);
 
   return;
 }
 
 PluginMetadata PluginMetadata::NewMetadata(const PluginMetadata& plugin) const {
-  using std::set_difference;
-
   PluginMetadata p(*this);
 
   if (p.group_ == plugin.group_) {
@@ -99,73 +238,15 @@ PluginMetadata PluginMetadata::NewMetadata(const PluginMetadata& plugin) const {
   }
 
   // Compare this plugin against the given plugin.
-  set<File> filesDiff;
-  set_difference(begin(loadAfter_),
-                 end(loadAfter_),
-                 begin(plugin.loadAfter_),
-                 end(plugin.loadAfter_),
-                 inserter(filesDiff, begin(filesDiff)));
-  p.SetLoadAfterFiles(filesDiff);
-
-  filesDiff.clear();
-  set_difference(begin(requirements_),
-                 end(requirements_),
-                 begin(plugin.requirements_),
-                 end(plugin.requirements_),
-                 inserter(filesDiff, begin(filesDiff)));
-  p.SetRequirements(filesDiff);
-
-  filesDiff.clear();
-  set_difference(begin(incompatibilities_),
-                 end(incompatibilities_),
-                 begin(plugin.incompatibilities_),
-                 end(plugin.incompatibilities_),
-                 inserter(filesDiff, begin(filesDiff)));
-  p.SetIncompatibilities(filesDiff);
-
-  vector<Message> msgs1 = plugin.GetMessages();
-  vector<Message> msgs2 = messages_;
-  std::sort(begin(msgs1), end(msgs1));
-  std::sort(begin(msgs2), end(msgs2));
-  vector<Message> mDiff;
-  set_difference(begin(msgs2),
-                 end(msgs2),
-                 begin(msgs1),
-                 end(msgs1),
-                 inserter(mDiff, begin(mDiff)));
-  p.SetMessages(mDiff);
-
-  set<Tag> tagDiff;
-  set_difference(begin(tags_),
-                 end(tags_),
-                 begin(plugin.tags_),
-                 end(plugin.tags_),
-                 inserter(tagDiff, begin(tagDiff)));
-  p.SetTags(tagDiff);
-
-  set<PluginCleaningData> dirtDiff;
-  set_difference(begin(dirtyInfo_),
-                 end(dirtyInfo_),
-                 begin(plugin.dirtyInfo_),
-                 end(plugin.dirtyInfo_),
-                 inserter(dirtDiff, begin(dirtDiff)));
-  p.SetDirtyInfo(dirtDiff);
-
-  set<PluginCleaningData> cleanDiff;
-  set_difference(begin(cleanInfo_),
-                 end(cleanInfo_),
-                 begin(plugin.cleanInfo_),
-                 end(plugin.cleanInfo_),
-                 inserter(cleanDiff, begin(cleanDiff)));
-  p.SetCleanInfo(cleanDiff);
-
-  set<Location> locationsDiff;
-  set_difference(begin(locations_),
-                 end(locations_),
-                 begin(plugin.locations_),
-                 end(plugin.locations_),
-                 inserter(locationsDiff, begin(locationsDiff)));
-  p.SetLocations(locationsDiff);
+  p.loadAfter_ = Difference(loadAfter_, plugin.loadAfter_);
+  p.requirements_ = Difference(requirements_, plugin.requirements_);
+  p.incompatibilities_ =
+      Difference(incompatibilities_, plugin.incompatibilities_);
+  p.messages_ = MessagesDifference(messages_, plugin.messages_);
+  p.tags_ = Difference(tags_, plugin.tags_);
+  p.dirtyInfo_ = Difference(dirtyInfo_, plugin.dirtyInfo_);
+  p.cleanInfo_ = Difference(cleanInfo_, plugin.cleanInfo_);
+  p.locations_ = Difference(locations_, plugin.locations_);
 
   return p;
 }
@@ -176,41 +257,52 @@ std::string PluginMetadata::GetLowercasedName() const {
   return boost::locale::to_lower(name_);
 }
 
-std::string PluginMetadata::GetNormalizedName() const {
-  return NormalizeFilename(name_);
+const std::string& PluginMetadata::GetNormalizedName() const {
+  return normalizedName_;
 }
 
 bool PluginMetadata::IsEnabled() const { return enabled_; }
 
 std::optional<std::string> PluginMetadata::GetGroup() const { return group_; }
 
-std::set<File> PluginMetadata::GetLoadAfterFiles() const { return loadAfter_; }
+const std::set<File>& PluginMetadata::GetLoadAfterFiles() const {
+  return GetOrEmpty(loadAfter_);
+}
 
-std::set<File> PluginMetadata::GetRequirements() const { return requirements_; }
+const std::set<File>& PluginMetadata::GetRequirements() const {
+  return GetOrEmpty(requirements_);
+}
 
-std::set<File> PluginMetadata::GetIncompatibilities() const {
-  return incompatibilities_;
+const std::set<File>& PluginMetadata::GetIncompatibilities() const {
+  return GetOrEmpty(incompatibilities_);
 }
 
-std::vector<Message> PluginMetadata::GetMessages() const { return messages_; }
+const std::vector<Message>& PluginMetadata::GetMessages() const {
+  return GetOrEmpty(messages_);
+}
 
-std::set<Tag> PluginMetadata::GetTags() const { return tags_; }
+const std::set<Tag>& PluginMetadata::GetTags() const {
+  return GetOrEmpty(tags_);
+}
 
-std::set<PluginCleaningData> PluginMetadata::GetDirtyInfo() const {
-  return dirtyInfo_;
+const std::set<PluginCleaningData>& PluginMetadata::GetDirtyInfo() const {
+  return GetOrEmpty(dirtyInfo_);
 }
 
-std::set<PluginCleaningData> PluginMetadata::GetCleanInfo() const {
-  return cleanInfo_;
+const std::set<PluginCleaningData>& PluginMetadata::GetCleanInfo() const {
+  return GetOrEmpty(cleanInfo_);
 }
 
-std::set<Location> PluginMetadata::GetLocations() const { return locations_; }
+const std::set<Location>& PluginMetadata::GetLocations() const {
+  return GetOrEmpty(locations_);
+}
 
 std::vector<SimpleMessage> PluginMetadata::GetSimpleMessages(
     const std::string& language) const {
-  std::vector<SimpleMessage> simpleMessages(messages_.size());
-  std::transform(begin(messages_),
-                 end(messages_),
+  const auto& messages = GetMessages();
+  std::vector<SimpleMessage> simpleMessages(messages.size());
+  std::transform(begin(messages),
+                 end(messages),
                  begin(simpleMessages),
                  [&](const Message& message) {
                    return message.ToSimpleMessage(language);
@@ -219,6 +311,20 @@ std::vector<SimpleMessage> PluginMetadata::GetSimpleMessages(
   return simpleMessages;
 }
 
+std::vector<SimpleMessageView> PluginMetadata::GetSimpleMessageViews(
+    const std::string& language) const {
+  const auto& messages = GetMessages();
+  std::vector<SimpleMessageView> views(messages.size());
+  std::transform(begin(messages),
+                 end(messages),
+                 begin(views),
+                 [&](const Message& message) {
+                   return message.ToSimpleMessageView(language);
+                 });
+
+  return views;
+}
+
 void PluginMetadata::SetEnabled(const bool e) { enabled_ = e; }
 
 void PluginMetadata::SetGroup(const std::string& group) {
@@ -229,57 +335,54 @@ void PluginMetadata::UnsetGroup() {
   group_ = std::nullopt;
 }
 
-void PluginMetadata::SetLoadAfterFiles(const std::set<File>& l) {
-  loadAfter_ = l;
+void PluginMetadata::SetLoadAfterFiles(std::set<File> l) {
+  loadAfter_ = Share(std::move(l));
 }
 
-void PluginMetadata::SetRequirements(const std::set<File>& r) {
-  requirements_ = r;
+void PluginMetadata::SetRequirements(std::set<File> r) {
+  requirements_ = Share(std::move(r));
 }
 
-void PluginMetadata::SetIncompatibilities(const std::set<File>& i) {
-  incompatibilities_ = i;
+void PluginMetadata::SetIncompatibilities(std::set<File> i) {
+  incompatibilities_ = Share(std::move(i));
 }
 
-void PluginMetadata::SetMessages(const std::vector<Message>& m) {
-  messages_ = m;
+void PluginMetadata::SetMessages(std::vector<Message> m) {
+  messages_ = Share(std::move(m));
 }
 
-void PluginMetadata::SetTags(const std::set<Tag>& t) { tags_ = t; }
+void PluginMetadata::SetTags(std::set<Tag> t) { tags_ = Share(std::move(t)); }
 
-void PluginMetadata::SetDirtyInfo(
-    const std::set<PluginCleaningData>& dirtyInfo) {
-  dirtyInfo_ = dirtyInfo;
+void PluginMetadata::SetDirtyInfo(std::set<PluginCleaningData> dirtyInfo) {
+  dirtyInfo_ = Share(std::move(dirtyInfo));
 }
 
-void PluginMetadata::SetCleanInfo(const std::set<PluginCleaningData>& info) {
-  cleanInfo_ = info;
+void PluginMetadata::SetCleanInfo(std::set<PluginCleaningData> info) {
+  cleanInfo_ = Share(std::move(info));
 }
 
-void PluginMetadata::SetLocations(const std::set<Location>& locations) {
-  locations_ = locations;
+void PluginMetadata::SetLocations(std::set<Location> locations) {
+  locations_ = Share(std::move(locations));
 }
 
 bool PluginMetadata::HasNameOnly() const {
-  return !group_.has_value() &&
-         loadAfter_.empty() && requirements_.empty() &&
-         incompatibilities_.empty() && messages_.empty() && tags_.empty() &&
-         dirtyInfo_.empty() && cleanInfo_.empty() && locations_.empty();
+  return !group_.has_value() && IsEmpty(loadAfter_) &&
+         IsEmpty(requirements_) && IsEmpty(incompatibilities_) &&
+         IsEmpty(messages_) && IsEmpty(tags_) && IsEmpty(dirtyInfo_) &&
+         IsEmpty(cleanInfo_) && IsEmpty(locations_);
 }
 
-bool PluginMetadata::IsRegexPlugin() const {
-  // Treat as regex if the plugin filename contains any of ":\*?|" as
-  // they are not valid Windows filename characters, but have meaning
-  // in regexes.
-  return strpbrk(name_.c_str(), ":\\*?|") != nullptr;
-}
+bool PluginMetadata::IsRegexPlugin() const { return isRegexPlugin_; }
 
 bool PluginMetadata::operator==(const PluginMetadata& rhs) const {
-  if (IsRegexPlugin() == rhs.IsRegexPlugin()) {
-    return CompareFilenames(name_, rhs.name_) == 0;
+  // Normalized names are equal exactly when CompareFilenames() finds the
+  // names equal.
+  if (isRegexPlugin_ == rhs.isRegexPlugin_) {
+    return normalizedNameHash_ == rhs.normalizedNameHash_ &&
+           normalizedName_ == rhs.normalizedName_;
   }
 
-  if (IsRegexPlugin())
+  if (isRegexPlugin_)
     return regex_match(rhs.GetName(),
                        regex(name_, regex::ECMAScript | regex::icase));
   else
@@ -0,0 +1,194 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/metadata/plugin_metadata_interner.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+namespace loot {
+namespace {
+struct ExactLess {
+  bool operator()(const MessageContent& lhs, const MessageContent& rhs) const {
+    return std::tie(lhs.GetText(), lhs.GetLanguage()) <
+           std::tie(rhs.GetText(), rhs.GetLanguage());
+  }
+
+  bool operator()(const File& lhs, const File& rhs) const {
+    return std::make_tuple(
+               lhs.GetName(), lhs.GetDisplayName(), lhs.GetCondition()) <
+           std::make_tuple(
+               rhs.GetName(), rhs.GetDisplayName(), rhs.GetCondition());
+  }
+
+  bool operator()(const Tag& lhs, const Tag& rhs) const {
+    return std::make_tuple(
+               lhs.IsAddition(), lhs.GetName(), lhs.GetCondition()) <
+           std::make_tuple(
+               rhs.IsAddition(), rhs.GetName(), rhs.GetCondition());
+  }
+
+  bool operator()(const Message& lhs, const Message& rhs) const {
+    auto lhsKey = std::make_tuple(lhs.GetType(), lhs.GetCondition());
+    auto rhsKey = std::make_tuple(rhs.GetType(), rhs.GetCondition());
+    if (lhsKey != rhsKey) {
+      return lhsKey < rhsKey;
+    }
+
+    return (*this)(lhs.GetContent(), rhs.GetContent());
+  }
+
+  bool operator()(const PluginCleaningData& lhs,
+                  const PluginCleaningData& rhs) const {
+    auto lhsKey = std::make_tuple(lhs.GetCRC(),
+                                  lhs.GetITMCount(),
+                                  lhs.GetDeletedReferenceCount(),
+                                  lhs.GetDeletedNavmeshCount(),
+                                  lhs.GetCleaningUtility());
+    auto rhsKey = std::make_tuple(rhs.GetCRC(),
+                                  rhs.GetITMCount(),
+                                  rhs.GetDeletedReferenceCount(),
+                                  rhs.GetDeletedNavmeshCount(),
+                                  rhs.GetCleaningUtility());
+    if (lhsKey != rhsKey) {
+      return lhsKey < rhsKey;
+    }
+
+    return (*this)(lhs.GetInfo(), rhs.GetInfo());
+  }
+
+  bool operator()(const Location& lhs, const Location& rhs) const {
+    return std::make_tuple(lhs.GetURL(), lhs.GetName()) <
+           std::make_tuple(rhs.GetURL(), rhs.GetName());
+  }
+
+  template<typename Container>
+  bool operator()(const Container& lhs, const Container& rhs) const {
+    return std::lexicographical_compare(
+        lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), *this);
+  }
+};
+}
+
+template<typename T>
+bool PluginMetadataInterner::ContentsLess::operator()(
+    const std::shared_ptr<const T>& lhs,
+    const std::shared_ptr<const T>& rhs) const {
+  return ExactLess()(*lhs, *rhs);
+}
+
+void PluginMetadataInterner::Intern(PluginMetadata& plugin) {
+  Intern(files_, plugin.loadAfter_);
+  Intern(files_, plugin.requirements_);
+  Intern(files_, plugin.incompatibilities_);
+  Intern(messages_, plugin.messages_);
+  Intern(tags_, plugin.tags_);
+  Intern(cleaningData_, plugin.dirtyInfo_);
+  Intern(cleaningData_, plugin.cleanInfo_);
+  Intern(locations_, plugin.locations_);
+}
+
+size_t PluginMetadataInterner::StringHash::operator()(
+    const std::shared_ptr<const std::string>& value) const {
+  return std::hash<std::string>()(*value);
+}
+
+bool PluginMetadataInterner::StringEqual::operator()(
+    const std::shared_ptr<const std::string>& lhs,
+    const std::shared_ptr<const std::string>& rhs) const {
+  return *lhs == *rhs;
+}
+
+template<typename T>
+void PluginMetadataInterner::Intern(Pool<T>& pool,
+                                    std::shared_ptr<const T>& container) {
+  if (!container) {
+    return;
+  }
+
+  auto it = pool.find(container);
+  if (it != pool.end()) {
+    container = *it;
+    return;
+  }
+
+  // Interning strings doesn't change their values, so the elements stay in
+  // the same order.
+  T interned;
+  for (auto element : *container) {
+    InternStrings(element);
+    interned.insert(interned.end(), std::move(element));
+  }
+
+  container = std::make_shared<const T>(std::move(interned));
+  pool.insert(container);
+}
+
+void PluginMetadataInterner::Intern(
+    std::shared_ptr<const std::string>& value) {
+  if (!value) {
+    return;
+  }
+
+  value = *strings_.insert(value).first;
+}
+
+void PluginMetadataInterner::InternStrings(ConditionalMetadata& metadata) {
+  Intern(metadata.condition_);
+}
+
+void PluginMetadataInterner::InternStrings(MessageContent& content) {
+  Intern(content.text_);
+}
+
+void PluginMetadataInterner::InternStrings(Message& message) {
+  InternStrings(static_cast<ConditionalMetadata&>(message));
+  for (auto& content : message.content_) {
+    InternStrings(content);
+  }
+}
+
+void PluginMetadataInterner::InternStrings(File& file) {
+  InternStrings(static_cast<ConditionalMetadata&>(file));
+  Intern(file.name_);
+  Intern(file.display_);
+}
+
+void PluginMetadataInterner::InternStrings(Tag& tag) {
+  InternStrings(static_cast<ConditionalMetadata&>(tag));
+}
+
+void PluginMetadataInterner::InternStrings(PluginCleaningData& info) {
+  for (auto& content : info.info_) {
+    InternStrings(content);
+  }
+}
+
+void PluginMetadataInterner::InternStrings(Location& location) {
+  Intern(location.url_);
+  Intern(location.name_);
+}
+}
@@ -0,0 +1,93 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_METADATA_PLUGIN_METADATA_INTERNER
+#define LOOT_API_METADATA_PLUGIN_METADATA_INTERNER
+
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "loot/metadata/plugin_metadata.h"
+
+namespace loot {
+// Makes the PluginMetadata objects passed to it share equal containers, so
+// that a metadata list in which many plugins have the same messages, tags,
+// files or locations only holds one copy of each, rather than one copy per
+// plugin. Containers that aren't equal to one already seen also have their
+// message texts, URLs, file names and conditions shared with equal strings in
+// the other containers.
+class PluginMetadataInterner {
+public:
+  void Intern(PluginMetadata& plugin);
+
+private:
+  // Compares containers using all of their elements' fields, as the
+  // metadata classes' comparison operators ignore some of them.
+  struct ContentsLess {
+    template<typename T>
+    bool operator()(const std::shared_ptr<const T>& lhs,
+                    const std::shared_ptr<const T>& rhs) const;
+  };
+
+  template<typename T>
+  using Pool = std::set<std::shared_ptr<const T>, ContentsLess>;
+
+  struct StringHash {
+    size_t operator()(const std::shared_ptr<const std::string>& value) const;
+  };
+
+  struct StringEqual {
+    bool operator()(const std::shared_ptr<const std::string>& lhs,
+                    const std::shared_ptr<const std::string>& rhs) const;
+  };
+
+  template<typename T>
+  void Intern(Pool<T>& pool, std::shared_ptr<const T>& container);
+
+  void Intern(std::shared_ptr<const std::string>& value);
+  void InternStrings(ConditionalMetadata& metadata);
+  void InternStrings(MessageContent& content);
+  void InternStrings(Message& message);
+  void InternStrings(File& file);
+  void InternStrings(Tag& tag);
+  void InternStrings(PluginCleaningData& info);
+  void InternStrings(Location& location);
+
+  std::unordered_set<std::shared_ptr<const std::string>,
+                     StringHash,
+                     StringEqual>
+      strings_;
+  Pool<std::set<File>> files_;
+  Pool<std::vector<Message>> messages_;
+  Pool<std::set<Tag>> tags_;
+  Pool<std::set<PluginCleaningData>> cleaningData_;
+  Pool<std::set<Location>> locations_;
+};
+}
+
+#endif
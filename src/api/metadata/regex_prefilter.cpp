@@ -0,0 +1,221 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/metadata/regex_prefilter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+
+namespace loot {
+namespace {
+char FoldAsciiChar(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool IsAsciiAlphanumeric(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9');
+}
+
+bool IsAsciiDigit(char c) { return c >= '0' && c <= '9'; }
+
+std::string FoldAscii(const std::string& text) {
+  std::string folded(text);
+  std::transform(folded.begin(), folded.end(), folded.begin(), FoldAsciiChar);
+  return folded;
+}
+}
+
+// Splits the ECMAScript regex into a sequence of single characters that must
+// be matched literally and other tokens, which are anything that could match
+// something else, or nothing. Non-ASCII characters aren't treated as literals,
+// as whether they are matched case-insensitively depends on the locale.
+// Top-level alternation means that no literals are required.
+RegexPrefilter::RequiredLiterals RegexPrefilter::GetRequiredLiterals(
+    const std::string& regex) {
+  std::vector<std::optional<char>> tokens;
+  size_t groupDepth = 0;
+  // The index of the last token that wasn't a quantifier.
+  size_t lastAtom = SIZE_MAX;
+  auto addAtom = [&](std::optional<char> token) {
+    tokens.push_back(token);
+    lastAtom = tokens.size() - 1;
+  };
+
+  size_t i = 0;
+  while (i < regex.size()) {
+    const char c = regex[i];
+
+    if (c == '\\') {
+      if (i + 1 == regex.size()) {
+        addAtom(std::nullopt);
+        i += 1;
+        continue;
+      }
+
+      const char escaped = regex[i + 1];
+      i += 2;
+      if (!IsAsciiAlphanumeric(escaped)) {
+        if (static_cast<unsigned char>(escaped) < 0x80) {
+          addAtom(escaped);
+        } else {
+          addAtom(std::nullopt);
+        }
+        continue;
+      }
+
+      // Skip the rest of the escape sequence, so that it isn't mistaken for
+      // literals.
+      if (escaped == 'x') {
+        i += 2;
+      } else if (escaped == 'u') {
+        i += 4;
+      } else if (escaped == 'c') {
+        i += 1;
+      } else if (IsAsciiDigit(escaped)) {
+        while (i < regex.size() && IsAsciiDigit(regex[i])) {
+          ++i;
+        }
+      }
+      addAtom(std::nullopt);
+    } else if (c == '[') {
+      // Skip to the end of the bracket expression.
+      i += 1;
+      if (i < regex.size() && regex[i] == '^') {
+        i += 1;
+      }
+      if (i < regex.size() && regex[i] == ']') {
+        i += 1;
+      }
+      while (i < regex.size() && regex[i] != ']') {
+        i += regex[i] == '\\' ? 2 : 1;
+      }
+      i += 1;
+      addAtom(std::nullopt);
+    } else if (c == '*' || c == '?' || c == '{' || c == '+') {
+      // The quantified token may be matched zero times, unless it's quantified
+      // by "+" alone. Quantifiers may themselves be quantified, so mark the
+      // last token that wasn't a quantifier.
+      if (c != '+' && lastAtom < tokens.size()) {
+        tokens[lastAtom] = std::nullopt;
+      }
+      if (c == '{') {
+        while (i < regex.size() && regex[i] != '}') {
+          ++i;
+        }
+      }
+      i += 1;
+      tokens.push_back(std::nullopt);
+    } else if ((c == '^' && i == 0) || (c == '$' && i + 1 == regex.size())) {
+      // The whole string is always matched, so these anchors have no effect.
+      i += 1;
+    } else if (c == '|') {
+      if (groupDepth == 0) {
+        return RequiredLiterals();
+      }
+      i += 1;
+      addAtom(std::nullopt);
+    } else {
+      if (c == '(') {
+        groupDepth += 1;
+      } else if (c == ')' && groupDepth > 0) {
+        groupDepth -= 1;
+      }
+
+      const bool isLiteral = static_cast<unsigned char>(c) < 0x80 &&
+                             c != '.' && c != '^' && c != '$' && c != '(' &&
+                             c != ')';
+      if (isLiteral) {
+        addAtom(c);
+      } else {
+        addAtom(std::nullopt);
+      }
+      i += 1;
+    }
+  }
+
+  RequiredLiterals literals;
+  for (auto it = tokens.begin(); it != tokens.end() && it->has_value(); ++it) {
+    literals.prefix += FoldAsciiChar(it->value());
+  }
+  for (auto it = tokens.rbegin(); it != tokens.rend() && it->has_value();
+       ++it) {
+    literals.suffix += FoldAsciiChar(it->value());
+  }
+  std::reverse(literals.suffix.begin(), literals.suffix.end());
+
+  return literals;
+}
+
+void RegexPrefilter::Add(const std::string& regex) {
+  const size_t index = numRegexes_++;
+  const auto literals = GetRequiredLiterals(regex);
+
+  // Prefer to index the regex by its prefix, as most filenames end with one
+  // of only a few file extensions, unless the prefix is too short to be
+  // selective.
+  const auto prefixLength = std::min(literals.prefix.size(), MAX_KEY_LENGTH);
+  const auto suffixLength = std::min(literals.suffix.size(), MAX_KEY_LENGTH);
+  if (prefixLength > 1 || (prefixLength == 1 && suffixLength <= 1)) {
+    byPrefix_[literals.prefix.substr(0, prefixLength)].push_back(index);
+  } else if (suffixLength > 0) {
+    bySuffix_[literals.suffix.substr(literals.suffix.size() - suffixLength)]
+        .push_back(index);
+  } else {
+    unindexed_.push_back(index);
+  }
+}
+
+void RegexPrefilter::Clear() {
+  numRegexes_ = 0;
+  byPrefix_.clear();
+  bySuffix_.clear();
+  unindexed_.clear();
+}
+
+std::vector<size_t> RegexPrefilter::GetCandidates(
+    const std::string& text) const {
+  std::vector<size_t> candidates(unindexed_);
+
+  const auto folded = FoldAscii(text);
+  const auto maxLength = std::min(folded.size(), MAX_KEY_LENGTH);
+  for (size_t length = 1; length <= maxLength; ++length) {
+    auto it = byPrefix_.find(folded.substr(0, length));
+    if (it != byPrefix_.end()) {
+      candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+
+    it = bySuffix_.find(folded.substr(folded.size() - length));
+    if (it != bySuffix_.end()) {
+      candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+
+  return candidates;
+}
+}
@@ -0,0 +1,69 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_METADATA_REGEX_PREFILTER
+#define LOOT_API_METADATA_REGEX_PREFILTER
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace loot {
+// Indexes case-insensitive regexes by the literal text that any string they
+// fully match must start or end with, so that the regexes that could match a
+// given filename can be found without trying them all. Regexes are identified
+// by the order in which they were added.
+class RegexPrefilter {
+public:
+  // The literal text that any string fully matched by a regex must start and
+  // end with. Only ASCII characters are included, and letters are lowercased.
+  struct RequiredLiterals {
+    std::string prefix;
+    std::string suffix;
+  };
+
+  static RequiredLiterals GetRequiredLiterals(const std::string& regex);
+
+  void Add(const std::string& regex);
+  void Clear();
+
+  // Get the indices of the regexes that could fully match the given string,
+  // in the order the regexes were added.
+  std::vector<size_t> GetCandidates(const std::string& text) const;
+
+private:
+  // Regexes are indexed by up to this many characters of their literals.
+  static constexpr size_t MAX_KEY_LENGTH = 4;
+
+  size_t numRegexes_ = 0;
+
+  std::unordered_map<std::string, std::vector<size_t>> byPrefix_;
+  std::unordered_map<std::string, std::vector<size_t>> bySuffix_;
+  // Regexes with no required literals, which must always be tried.
+  std::vector<size_t> unindexed_;
+};
+}
+
+#endif
@@ -24,19 +24,32 @@
 
 #include "api/metadata_list.h"
 
+#include <algorithm>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
 
 #include "api/game/game.h"
 #include "api/helpers/logging.h"
+#include "api/helpers/memory_usage.h"
 #include "api/helpers/text.h"
+#include "api/helpers/thread_pool.h"
+#include "api/helpers/tracing.h"
 #include "api/metadata/condition_evaluator.h"
+#include "api/metadata/plugin_metadata_interner.h"
 #include "api/metadata/yaml/group.h"
+#include "api/metadata/yaml/message.h"
 #include "api/metadata/yaml/plugin_metadata.h"
+#include "api/metadata_list_cache.h"
+#include "api/metadata_list_reader.h"
 #include "loot/exception/file_access_error.h"
 
 namespace loot {
 void MetadataList::Load(const std::filesystem::path& filepath) {
+  TraceScope traceScope("LoadMetadataList", "metadata", filepath.u8string());
   Clear();
 
   auto logger = getLogger();
@@ -48,31 +61,141 @@ void MetadataList::Load(const std::filesystem::path& filepath) {
   if (!in.good())
     throw FileAccessError("Cannot open " + filepath.u8string());
 
-  YAML::Node metadataList = YAML::Load(in);
-  in.close();
-
-  if (!metadataList.IsMap())
-    throw FileAccessError("The root of the metadata file " + filepath.u8string() +
-                          " is not a YAML map.");
+  // Plugin entries are converted in batches of this many, so that only one
+  // batch's nodes are held in memory at once.
+  static constexpr size_t PLUGIN_BATCH_SIZE = 2048;
+  // Converting an entry checks the syntax of its conditions, which is cheap
+  // for most entries, so it takes this many to outweigh the cost of using the
+  // thread pool.
+  static constexpr size_t MIN_PARALLEL_PLUGINS = 64;
+
+  // Entries are converted as they are read, so the YAML for the whole file
+  // is never held in memory at once.
+  PluginMetadataInterner interner;
+  std::vector<Message> messages;
+  std::set<std::string> bashTags;
+  std::unordered_set<Group> groups;
+  bool hasGroups = false;
+
+  // Converting a plugin entry also checks the syntax of all its conditions,
+  // which is most of the cost of loading a masterlist, so the entries are
+  // converted in parallel. Conversion only reads the nodes, which yaml-cpp
+  // allows from multiple threads. The converted entries are then added in the
+  // order they were read, so that the same duplicate entry or conversion
+  // error is reported whichever threads finish first.
+  std::vector<YAML::Node> pendingPlugins;
+  auto addPendingPlugins = [&]() {
+    if (pendingPlugins.empty()) {
+      return;
+    }
 
-  if (metadataList["plugins"]) {
-    for (const auto& node : metadataList["plugins"]) {
-      PluginMetadata plugin(node.as<PluginMetadata>());
+    std::vector<std::optional<PluginMetadata>> converted(pendingPlugins.size());
+    std::vector<std::exception_ptr> errors(pendingPlugins.size());
+    auto convertPlugins = [&](size_t start, size_t end) {
+      for (size_t i = start; i < end; ++i) {
+        try {
+          converted[i] = pendingPlugins[i].as<PluginMetadata>();
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      }
+    };
+
+    ThreadPool::GetCurrent()->RunInChunks(
+        pendingPlugins.size(), MIN_PARALLEL_PLUGINS, convertPlugins);
+    pendingPlugins.clear();
+
+    for (size_t i = 0; i < converted.size(); ++i) {
+      if (errors[i]) {
+        std::rethrow_exception(errors[i]);
+      }
+
+      auto& plugin = converted[i].value();
+      interner.Intern(plugin);
       if (plugin.IsRegexPlugin())
-        regexPlugins_.push_back(plugin);
+        AddRegexPlugin(plugin);
       else if (!plugins_.insert(plugin).second)
         throw FileAccessError("More than one entry exists for \"" +
                               plugin.GetName() + "\"");
     }
-  }
-  if (metadataList["globals"])
-    messages_ = metadataList["globals"].as<std::vector<Message>>();
+  };
+
+  auto addElement = [&](const std::string& key, const YAML::Node& element) {
+    if (key == "plugins") {
+      pendingPlugins.push_back(element);
+      if (pendingPlugins.size() == PLUGIN_BATCH_SIZE) {
+        addPendingPlugins();
+      }
+      return;
+    }
 
-  if (metadataList["bash_tags"])
-    bashTags_ = metadataList["bash_tags"].as<std::set<std::string>>();
+    // Add any pending entries first so that errors are still reported in
+    // the order they occur in the file.
+    addPendingPlugins();
+
+    if (key == "globals") {
+      messages.push_back(element.as<Message>());
+    } else if (key == "bash_tags") {
+      if (!bashTags.insert(element.as<std::string>()).second)
+        throw YAML::RepresentationException(
+            element.Mark(), "bad conversion: set elements must be unique");
+    } else if (key == "groups") {
+      hasGroups = true;
+      if (!groups.insert(element.as<Group>()).second)
+        throw YAML::RepresentationException(
+            element.Mark(),
+            "bad conversion: unordered set elements must be unique");
+    }
+  };
+
+  // Values that aren't read element by element are converted as a whole, so
+  // that values that aren't sequences are handled as they would be by the
+  // YAML converters.
+  auto addValue = [&](const std::string& key, const YAML::Node& value) {
+    addPendingPlugins();
+
+    if (key == "plugins") {
+      for (const auto& node : value) {
+        addElement(key, node);
+      }
+    } else if (key == "globals") {
+      for (const auto& message : value.as<std::vector<Message>>()) {
+        messages.push_back(message);
+      }
+    } else if (key == "bash_tags") {
+      auto tags = value.as<std::set<std::string>>();
+      bashTags.insert(tags.begin(), tags.end());
+    } else if (key == "groups") {
+      hasGroups = true;
+      auto valueGroups = value.as<std::unordered_set<Group>>();
+      groups.insert(valueGroups.begin(), valueGroups.end());
+    }
+  };
+
+  try {
+    MetadataListReader reader(addElement, addValue);
+    if (!reader.Read(in))
+      throw FileAccessError("The root of the metadata file " +
+                            filepath.u8string() + " is not a YAML map.");
+    addPendingPlugins();
+  } catch (...) {
+    // If reading failed, any entries that were read before the failure are
+    // still converted, so that errors they contain are reported first.
+    try {
+      addPendingPlugins();
+    } catch (...) {
+      Clear();
+      throw;
+    }
+    Clear();
+    throw;
+  }
+  in.close();
 
-  if (metadataList["groups"])
-    groups_ = metadataList["groups"].as<std::unordered_set<Group>>();
+  messages_ = std::move(messages);
+  bashTags_ = std::move(bashTags);
+  if (hasGroups)
+    groups_ = std::move(groups);
 
   groups_.insert(Group());
 
@@ -81,12 +204,66 @@ void MetadataList::Load(const std::filesystem::path& filepath) {
   }
 }
 
+void MetadataList::Load(const std::filesystem::path& filepath,
+                        const std::filesystem::path& cacheFilePath) {
+  TraceScope traceScope(
+      "LoadMetadataListWithCache", "metadata", filepath.u8string());
+  if (!std::filesystem::exists(filepath)) {
+    throw FileAccessError("Cannot open " + filepath.u8string());
+  }
+
+  auto source = MetadataListSource::FromFile(filepath);
+  auto contents = LoadMetadataListCache(cacheFilePath, source, true);
+  auto logger = getLogger();
+
+  if (contents) {
+    Clear();
+
+    bashTags_ = contents.value().bashTags;
+    SetGroups(contents.value().groups);
+    messages_ = contents.value().messages;
+    for (const auto& plugin : contents.value().plugins) {
+      AddPlugin(plugin);
+    }
+    undecodedPlugins_ = std::move(contents.value().undecodedPlugins);
+
+    if (logger) {
+      logger->debug("Loaded {} from the compiled metadata cache.",
+                    filepath.u8string());
+    }
+    return;
+  }
+
+  Load(filepath);
+
+  MetadataListContents loadedContents;
+  loadedContents.bashTags = bashTags_;
+  loadedContents.groups = groups_;
+  loadedContents.messages = messages_;
+  loadedContents.plugins = Plugins();
+
+  try {
+    SaveMetadataListCache(cacheFilePath, source, loadedContents);
+  } catch (std::exception& e) {
+    if (logger) {
+      logger->warn("Failed to save the compiled metadata cache \"{}\": {}",
+                   cacheFilePath.u8string(),
+                   e.what());
+    }
+  }
+}
+
 void MetadataList::Save(const std::filesystem::path& filepath) const {
   auto logger = getLogger();
   if (logger) {
     logger->trace("Saving metadata list to: {}", filepath.u8string());
   }
-  YAML::Emitter emitter;
+  std::ofstream out(filepath);
+  if (out.fail())
+    throw FileAccessError("Couldn't open output file.");
+
+  // Emit directly to the file to avoid holding the whole document in memory.
+  YAML::Emitter emitter(out);
   emitter.SetIndent(2);
   emitter << YAML::BeginMap;
 
@@ -99,46 +276,93 @@ void MetadataList::Save(const std::filesystem::path& filepath) const {
   if (!messages_.empty())
     emitter << YAML::Key << "globals" << YAML::Value << messages_;
 
-  auto plugins = Plugins();
-  plugins.sort([](const PluginMetadata& p1, const PluginMetadata& p2) {
-    return CompareFilenames(p1.GetName(), p2.GetName()) < 0;
-  });
-
-  if (!plugins.empty())
-    emitter << YAML::Key << "plugins" << YAML::Value << plugins;
+  if (!plugins_.empty() || !undecodedPlugins_.empty() ||
+      !regexPlugins_.empty()) {
+    emitter << YAML::Key << "plugins" << YAML::Value << YAML::BeginSeq;
+    ForEachPluginInFilenameOrder(
+        [&](const PluginMetadata& plugin) { emitter << plugin; });
+    emitter << YAML::EndSeq;
+  }
 
   emitter << YAML::EndMap;
-
-  std::ofstream out(filepath);
-  if (out.fail())
-    throw FileAccessError("Couldn't open output file.");
-
-  out << emitter.c_str();
-  out.close();
 }
 
+
 void MetadataList::Clear() {
   bashTags_.clear();
   plugins_.clear();
+  undecodedPlugins_.clear();
   regexPlugins_.clear();
+  compiledRegexes_.clear();
+  regexPrefilter_.Clear();
   messages_.clear();
 }
 
 std::list<PluginMetadata> MetadataList::Plugins() const {
   std::list<PluginMetadata> pluginList(plugins_.begin(), plugins_.end());
 
+  for (const auto& undecodedPlugin : undecodedPlugins_) {
+    pluginList.push_back(undecodedPlugin.second());
+  }
+
   pluginList.insert(
       pluginList.end(), regexPlugins_.begin(), regexPlugins_.end());
 
   return pluginList;
 }
 
+void MetadataList::ForEachPluginInFilenameOrder(
+    const std::function<void(const PluginMetadata&)>& function) const {
+  struct SortablePlugin {
+    std::string normalizedName;
+    const PluginMetadata* plugin;
+    const std::function<PluginMetadata()>* decoder;
+  };
+
+  std::vector<SortablePlugin> sortablePlugins;
+  sortablePlugins.reserve(plugins_.size() + undecodedPlugins_.size() +
+                          regexPlugins_.size());
+  for (const auto& plugin : plugins_) {
+    sortablePlugins.push_back({plugin.GetNormalizedName(), &plugin, nullptr});
+  }
+  for (const auto& undecodedPlugin : undecodedPlugins_) {
+    sortablePlugins.push_back(
+        {undecodedPlugin.first, nullptr, &undecodedPlugin.second});
+  }
+  for (const auto& plugin : regexPlugins_) {
+    sortablePlugins.push_back({plugin.GetNormalizedName(), &plugin, nullptr});
+  }
+
+  std::stable_sort(sortablePlugins.begin(),
+                   sortablePlugins.end(),
+                   [](const SortablePlugin& lhs, const SortablePlugin& rhs) {
+                     return CompareNormalizedFilenames(lhs.normalizedName,
+                                                       rhs.normalizedName) < 0;
+                   });
+
+  for (const auto& sortablePlugin : sortablePlugins) {
+    if (sortablePlugin.plugin) {
+      function(*sortablePlugin.plugin);
+    } else {
+      function((*sortablePlugin.decoder)());
+    }
+  }
+}
+
 std::vector<Message> MetadataList::Messages() const { return messages_; }
 
 std::set<std::string> MetadataList::BashTags() const { return bashTags_; }
 
+const std::set<std::string>& MetadataList::BashTagsRef() const {
+  return bashTags_;
+}
+
 std::unordered_set<Group> MetadataList::Groups() const { return groups_; }
 
+const std::unordered_set<Group>& MetadataList::GroupsRef() const {
+  return groups_;
+}
+
 void MetadataList::SetGroups(const std::unordered_set<Group>& groups) {
   groups_ = groups;
   groups_.insert(Group());
@@ -147,48 +371,119 @@ void MetadataList::SetGroups(const std::unordered_set<Group>& groups) {
 // Merges multiple matching regex entries if any are found.
 std::optional<PluginMetadata> MetadataList::FindPlugin(
     const std::string& pluginName) const {
-  PluginMetadata match(pluginName);
+  return FindPlugins({pluginName}).front();
+}
 
-  auto it = plugins_.find(match);
+std::vector<std::optional<PluginMetadata>> MetadataList::FindPlugins(
+    const std::vector<std::string>& pluginNames) const {
+  // Matching a plugin's name only tries the few regex entries that the
+  // prefilter finds for it, so it takes this many to outweigh the cost of
+  // using the thread pool.
+  static constexpr size_t MIN_PARALLEL_PLUGINS = 64;
+
+  std::vector<PluginMetadata> matches;
+  std::vector<bool> isRegexName;
+  matches.reserve(pluginNames.size());
+  isRegexName.reserve(pluginNames.size());
+  for (const auto& pluginName : pluginNames) {
+    PluginMetadata match(pluginName);
+    isRegexName.push_back(match.IsRegexPlugin());
+
+    auto it = plugins_.find(match);
+    if (it != plugins_.end()) {
+      match = *it;
+    } else if (!undecodedPlugins_.empty()) {
+      auto undecodedIt = undecodedPlugins_.find(match.GetNormalizedName());
+      if (undecodedIt != undecodedPlugins_.end()) {
+        match = undecodedIt->second();
+      }
+    }
 
-  if (it != plugins_.end())
-    match = *it;
+    matches.push_back(match);
+  }
 
-  // Now we want to also match possibly multiple regex entries.
-  auto regIt = find(regexPlugins_.begin(), regexPlugins_.end(), match);
-  while (regIt != regexPlugins_.end()) {
-    match.MergeMetadata(*regIt);
+  // Now we want to also match possibly multiple regex entries. A regex name
+  // is only matched by an entry with the same name, as when comparing
+  // PluginMetadata objects. Other names are only tried against the entries
+  // that the prefilter finds could match them. Each plugin's matching entries
+  // are merged in the order they were added.
+  auto mergeRegexMatches = [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      const auto& pluginName = pluginNames[i];
+      if (isRegexName[i]) {
+        for (const auto& regexPlugin : regexPlugins_) {
+          if (CompareFilenames(regexPlugin.GetName(), pluginName) == 0) {
+            matches[i].MergeMetadata(regexPlugin);
+          }
+        }
+        continue;
+      }
+
+      for (const auto index : regexPrefilter_.GetCandidates(pluginName)) {
+        if (std::regex_match(pluginName, compiledRegexes_[index])) {
+          matches[i].MergeMetadata(regexPlugins_[index]);
+        }
+      }
+    }
+  };
 
-    regIt = find(++regIt, regexPlugins_.end(), match);
+  if (!regexPlugins_.empty()) {
+    ThreadPool::GetCurrent()->RunInChunks(
+        pluginNames.size(), MIN_PARALLEL_PLUGINS, mergeRegexMatches);
   }
 
-  if (match.HasNameOnly()) {
-    return std::nullopt;
+  std::vector<std::optional<PluginMetadata>> results;
+  results.reserve(matches.size());
+  for (auto& match : matches) {
+    if (match.HasNameOnly()) {
+      results.push_back(std::nullopt);
+    } else {
+      results.push_back(std::move(match));
+    }
   }
 
-  return match;
+  return results;
 }
 
 void MetadataList::AddPlugin(const PluginMetadata& plugin) {
   if (plugin.IsRegexPlugin())
-    regexPlugins_.push_back(plugin);
+    AddRegexPlugin(plugin);
   else {
-    if (!plugins_.insert(plugin).second)
+    if (undecodedPlugins_.count(plugin.GetNormalizedName()) != 0 ||
+        !plugins_.insert(plugin).second)
       throw std::invalid_argument(
           "Cannot add \"" + plugin.GetName() +
           "\" to the metadata list as another entry already exists.");
   }
 }
 
+void MetadataList::AddRegexPlugin(const PluginMetadata& plugin) {
+  // Compile the regex first so that nothing is added if it is invalid.
+  compiledRegexes_.emplace_back(plugin.GetName(),
+                                std::regex::ECMAScript | std::regex::icase);
+  regexPlugins_.push_back(plugin);
+  regexPrefilter_.Add(plugin.GetName());
+}
+
 // Doesn't erase matching regex entries, because they might also
 // be required for other plugins.
 void MetadataList::ErasePlugin(const std::string& pluginName) {
-  auto it = plugins_.find(PluginMetadata(pluginName));
+  PluginMetadata plugin(pluginName);
+  auto it = plugins_.find(plugin);
 
   if (it != plugins_.end()) {
     plugins_.erase(it);
     return;
   }
+
+  undecodedPlugins_.erase(plugin.GetNormalizedName());
+}
+
+void MetadataList::DecodeAllPlugins() {
+  for (const auto& undecodedPlugin : undecodedPlugins_) {
+    plugins_.insert(undecodedPlugin.second());
+  }
+  undecodedPlugins_.clear();
 }
 
 void MetadataList::AppendMessage(const Message& message) {
@@ -197,22 +492,33 @@ void MetadataList::AppendMessage(const Message& message) {
 
 void MetadataList::EvalAllConditions(
     ConditionEvaluator& conditionEvaluator) {
+  DecodeAllPlugins();
+
   if (unevaluatedPlugins_.empty())
     unevaluatedPlugins_.swap(plugins_);
   else
     plugins_.clear();
 
-  for (const auto& plugin : unevaluatedPlugins_) {
-    plugins_.insert(conditionEvaluator.EvaluateAll(plugin));
-  }
-
   if (unevaluatedRegexPlugins_.empty())
     unevaluatedRegexPlugins_ = regexPlugins_;
   else
     regexPlugins_ = unevaluatedRegexPlugins_;
 
+  // Evaluate all plugin entries' conditions together so that they can be
+  // deduplicated and evaluated in parallel.
+  std::vector<PluginMetadata> unevaluated(unevaluatedPlugins_.begin(),
+                                          unevaluatedPlugins_.end());
+  unevaluated.insert(
+      unevaluated.end(), regexPlugins_.begin(), regexPlugins_.end());
+
+  auto evaluated = conditionEvaluator.EvaluateAll(unevaluated);
+
+  auto evaluatedIt = evaluated.begin();
+  for (size_t i = 0; i < unevaluatedPlugins_.size(); ++i) {
+    plugins_.insert(*evaluatedIt++);
+  }
   for (auto& plugin : regexPlugins_) {
-    plugin = conditionEvaluator.EvaluateAll(plugin);
+    plugin = *evaluatedIt++;
   }
 
   if (unevaluatedMessages_.empty())
@@ -220,9 +526,124 @@ void MetadataList::EvalAllConditions(
   else
     messages_.clear();
 
+  std::vector<std::string> messageConditions;
   for (const auto& message : unevaluatedMessages_) {
-    if (conditionEvaluator.Evaluate(message.GetCondition()))
-      messages_.push_back(message);
+    messageConditions.push_back(message.GetCondition());
+  }
+
+  auto messageResults = conditionEvaluator.Evaluate(messageConditions);
+  for (size_t i = 0; i < unevaluatedMessages_.size(); ++i) {
+    if (messageResults[i])
+      messages_.push_back(unevaluatedMessages_[i]);
+  }
+}
+
+size_t MetadataList::GetMemoryUsage() const {
+  return sizeof(MetadataList) + EstimateHeapSize(groups_) +
+         EstimateHeapSize(bashTags_) + EstimateHeapSize(plugins_) +
+         EstimateHeapSize(undecodedPlugins_,
+                          [](const std::function<PluginMetadata()>&) {
+                            return size_t(0);
+                          }) +
+         EstimateHeapSize(regexPlugins_) +
+         compiledRegexes_.capacity() * sizeof(std::regex) +
+         EstimateHeapSize(messages_) + EstimateHeapSize(unevaluatedPlugins_) +
+         EstimateHeapSize(unevaluatedRegexPlugins_) +
+         EstimateHeapSize(unevaluatedMessages_);
+}
+
+namespace {
+struct EntryYaml {
+  std::string name;
+  std::string yaml;
+};
+
+template<typename T>
+std::string EmitYaml(const T& value) {
+  YAML::Emitter emitter;
+  emitter << value;
+  return emitter.c_str();
+}
+
+// Keyed by normalized name. Entries that share a name, e.g. two regex entries
+// that differ only in case, are compared together.
+std::map<std::string, EntryYaml> GetPluginEntries(const MetadataList& list) {
+  std::map<std::string, EntryYaml> entries;
+  list.ForEachPluginInFilenameOrder([&](const PluginMetadata& plugin) {
+    auto& entry = entries[plugin.GetNormalizedName()];
+    if (entry.name.empty()) {
+      entry.name = plugin.GetName();
+    }
+    entry.yaml += EmitYaml(plugin);
+  });
+
+  return entries;
+}
+
+std::map<std::string, EntryYaml> GetGroupEntries(const MetadataList& list) {
+  std::map<std::string, EntryYaml> entries;
+  for (const auto& group : list.Groups()) {
+    entries.emplace(group.GetName(),
+                    EntryYaml{group.GetName(), EmitYaml(group)});
+  }
+
+  return entries;
+}
+
+std::vector<std::string> GetChangedEntries(
+    const std::map<std::string, EntryYaml>& from,
+    const std::map<std::string, EntryYaml>& to) {
+  std::vector<std::string> changed;
+
+  auto fromIt = from.begin();
+  auto toIt = to.begin();
+  while (fromIt != from.end() || toIt != to.end()) {
+    if (toIt == to.end() ||
+        (fromIt != from.end() && fromIt->first < toIt->first)) {
+      changed.push_back(fromIt->second.name);
+      ++fromIt;
+    } else if (fromIt == from.end() || toIt->first < fromIt->first) {
+      changed.push_back(toIt->second.name);
+      ++toIt;
+    } else {
+      if (fromIt->second.yaml != toIt->second.yaml) {
+        changed.push_back(toIt->second.name);
+      }
+      ++fromIt;
+      ++toIt;
+    }
   }
+
+  return changed;
+}
+}
+
+MasterlistChanges GetChanges(const MetadataList& from, const MetadataList& to) {
+  MasterlistChanges changes;
+
+  changes.plugins =
+      GetChangedEntries(GetPluginEntries(from), GetPluginEntries(to));
+  changes.groups = GetChangedEntries(GetGroupEntries(from), GetGroupEntries(to));
+
+  const auto& fromTags = from.BashTagsRef();
+  const auto& toTags = to.BashTagsRef();
+  std::set_symmetric_difference(fromTags.begin(),
+                                fromTags.end(),
+                                toTags.begin(),
+                                toTags.end(),
+                                std::back_inserter(changes.bash_tags));
+
+  auto fromMessages = from.Messages();
+  auto toMessages = to.Messages();
+  changes.messages_changed =
+      fromMessages.size() != toMessages.size() ||
+      !std::equal(fromMessages.begin(),
+                  fromMessages.end(),
+                  toMessages.begin(),
+                  [](const Message& lhs, const Message& rhs) {
+                    return EmitYaml(lhs) == EmitYaml(rhs);
+                  });
+
+  return changes;
 }
 }
@@ -26,31 +26,55 @@
 #define LOOT_API_METADATA_LIST
 
 #include <filesystem>
+#include <functional>
 #include <optional>
+#include <regex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "api/metadata/condition_evaluator.h"
+#include "api/metadata/regex_prefilter.h"
 #include "loot/metadata/group.h"
 #include "loot/metadata/plugin_metadata.h"
+#include "loot/struct/masterlist_changes.h"
 
 namespace loot {
 class MetadataList {
 public:
   void Load(const std::filesystem::path& filepath);
+  // Load the given file using the compiled metadata cache at the given path if
+  // it was compiled from the file's current contents, otherwise load the file
+  // and then write the cache.
+  void Load(const std::filesystem::path& filepath,
+            const std::filesystem::path& cacheFilePath);
   void Save(const std::filesystem::path& filepath) const;
   void Clear();
 
   std::list<PluginMetadata> Plugins() const;
+  // Calls the given function with each plugin entry in filename order, without
+  // copying the entries.
+  void ForEachPluginInFilenameOrder(
+      const std::function<void(const PluginMetadata&)>& function) const;
   std::vector<Message> Messages() const;
   std::set<std::string> BashTags() const;
+  // Like BashTags(), but without copying them.
+  const std::set<std::string>& BashTagsRef() const;
   std::unordered_set<Group> Groups() const;
+  // Like Groups(), but without copying them.
+  const std::unordered_set<Group>& GroupsRef() const;
 
   void SetGroups(const std::unordered_set<Group>& groups);
 
   // Merges multiple matching regex entries if any are found.
   std::optional<PluginMetadata> FindPlugin(const std::string& pluginName) const;
+  // Equivalent to calling FindPlugin() for each name, but matches the regex
+  // entries against the plugins in parallel if there are enough plugins.
+  // Only the regex entries that the prefilter finds could match a plugin's
+  // name are tried against it.
+  std::vector<std::optional<PluginMetadata>> FindPlugins(
+      const std::vector<std::string>& pluginNames) const;
   void AddPlugin(const PluginMetadata& plugin);
 
   // Doesn't erase matching regex entries, because they might also
@@ -62,17 +86,41 @@ public:
   // Eval plugin conditions.
   void EvalAllConditions(ConditionEvaluator& conditionEvaluator);
 
+  // An estimate of the memory used by the list's metadata, in bytes. Compiled
+  // regexes and metadata that hasn't been decoded from the compiled metadata
+  // cache are only counted by their sizes, as their contents aren't exposed.
+  size_t GetMemoryUsage() const;
+
 protected:
+  void AddRegexPlugin(const PluginMetadata& plugin);
+  // Moves any plugins that have not yet been decoded from the compiled
+  // metadata cache into plugins_.
+  void DecodeAllPlugins();
+
   std::unordered_set<Group> groups_;
   std::set<std::string> bashTags_;
   std::unordered_set<PluginMetadata> plugins_;
-  std::list<PluginMetadata> regexPlugins_;
+  // Non-regex plugins loaded from the compiled metadata cache that have not
+  // been decoded, keyed by their normalized names. Each is decoded whenever it
+  // is looked up, so that loading does not pay for entries that are not used.
+  std::unordered_map<std::string, std::function<PluginMetadata()>>
+      undecodedPlugins_;
+  std::vector<PluginMetadata> regexPlugins_;
+  // The compiled regexes for the entries in regexPlugins_, in the same order.
+  std::vector<std::regex> compiledRegexes_;
+  // Indexes the entries in regexPlugins_ by their positions.
+  RegexPrefilter regexPrefilter_;
   std::vector<Message> messages_;
 
   std::unordered_set<PluginMetadata> unevaluatedPlugins_;
-  std::list<PluginMetadata> unevaluatedRegexPlugins_;
+  std::vector<PluginMetadata> unevaluatedRegexPlugins_;
   std::vector<Message> unevaluatedMessages_;
 };
+
+// Compares the plugin entries, groups, general messages and Bash Tags of the
+// two lists. Entries are compared using their YAML representations, because
+// PluginMetadata and Group equality only compares names.
+MasterlistChanges GetChanges(const MetadataList& from, const MetadataList& to);
 }
 
 #endif
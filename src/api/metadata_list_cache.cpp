@@ -0,0 +1,600 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/metadata_list_cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "api/helpers/cache_file.h"
+#include "api/helpers/crc.h"
+#include "api/helpers/logging.h"
+
+namespace loot {
+namespace {
+constexpr char CACHE_MAGIC[8] = {'L', 'O', 'O', 'T', 'C', 'M', 'L', '\0'};
+constexpr uint32_t CACHE_VERSION = 2;
+// Used in place of a string index for a string that is not set.
+constexpr uint32_t NO_STRING = UINT32_MAX;
+// The number of fields in each plugin index entry.
+constexpr size_t PLUGIN_INDEX_ENTRY_SIZE = 3;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t sourceCrc;
+  uint64_t sourceFileSize;
+  uint32_t fieldCount;
+  uint32_t stringCount;
+  // The CRC-32 of everything after the header.
+  uint32_t payloadCrc;
+  uint32_t padding;
+};
+
+struct StringEntry {
+  uint32_t offset;
+  uint32_t length;
+};
+
+class CorruptCacheError : public std::runtime_error {
+public:
+  CorruptCacheError() : std::runtime_error("The cache data is corrupt.") {}
+};
+
+class CacheWriter {
+public:
+  void Write(uint32_t value) { fields_.push_back(value); }
+
+  void Write(const std::string& value) { Write(GetStringIndex(value)); }
+
+  void Write(const MessageContent& content) {
+    Write(content.GetText());
+    Write(content.GetLanguage());
+  }
+
+  void Write(const Message& message) {
+    Write(static_cast<uint32_t>(message.GetType()));
+    Write(message.GetCondition());
+    WriteAll(message.GetContent());
+  }
+
+  void Write(const File& file) {
+    Write(file.GetName());
+    Write(file.GetDisplayName() == file.GetName() ? std::string()
+                                                  : file.GetDisplayName());
+    Write(file.GetCondition());
+  }
+
+  void Write(const Tag& tag) {
+    Write(tag.GetName());
+    Write((uint32_t)tag.IsAddition());
+    Write(tag.GetCondition());
+  }
+
+  void Write(const PluginCleaningData& info) {
+    Write(info.GetCRC());
+    Write(info.GetITMCount());
+    Write(info.GetDeletedReferenceCount());
+    Write(info.GetDeletedNavmeshCount());
+    Write(info.GetCleaningUtility());
+    WriteAll(info.GetInfo());
+  }
+
+  void Write(const Location& location) {
+    Write(location.GetURL());
+    Write(location.GetName());
+  }
+
+  void Write(const Group& group) {
+    Write(group.GetName());
+    Write(group.GetDescription());
+    WriteAll(group.GetAfterGroups());
+  }
+
+  void Write(const PluginMetadata& plugin) {
+    Write(plugin.GetName());
+    Write((uint32_t)plugin.IsEnabled());
+    if (plugin.GetGroup()) {
+      Write(plugin.GetGroup().value());
+    } else {
+      Write(NO_STRING);
+    }
+    WriteAll(plugin.GetLoadAfterFiles());
+    WriteAll(plugin.GetRequirements());
+    WriteAll(plugin.GetIncompatibilities());
+    WriteAll(plugin.GetMessages());
+    WriteAll(plugin.GetTags());
+    WriteAll(plugin.GetDirtyInfo());
+    WriteAll(plugin.GetCleanInfo());
+    WriteAll(plugin.GetLocations());
+  }
+
+  // Plugins are preceded by an index of their names, normalized names and
+  // offsets, so that they can be decoded individually.
+  void WritePlugins(const std::list<PluginMetadata>& plugins) {
+    Write((uint32_t)plugins.size());
+
+    auto indexPosition = fields_.size();
+    fields_.resize(fields_.size() + plugins.size() * PLUGIN_INDEX_ENTRY_SIZE);
+
+    for (const auto& plugin : plugins) {
+      fields_[indexPosition] = GetStringIndex(plugin.GetName());
+      fields_[indexPosition + 1] = GetStringIndex(plugin.GetNormalizedName());
+      fields_[indexPosition + 2] = (uint32_t)fields_.size();
+      indexPosition += PLUGIN_INDEX_ENTRY_SIZE;
+
+      Write(plugin);
+    }
+  }
+
+  template<typename Container>
+  void WriteAll(const Container& container) {
+    Write((uint32_t)container.size());
+    for (const auto& element : container) {
+      Write(element);
+    }
+  }
+
+  void Save(const std::filesystem::path& cacheFilePath,
+            const MetadataListSource& source) const {
+    FileHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.sourceCrc = source.crc;
+    header.sourceFileSize = source.fileSize;
+    header.fieldCount = (uint32_t)fields_.size();
+    header.stringCount = (uint32_t)strings_.size();
+    header.padding = 0;
+
+    std::vector<StringEntry> stringEntries;
+    stringEntries.reserve(strings_.size());
+    uint32_t offset = 0;
+    for (const auto string : strings_) {
+      stringEntries.push_back(StringEntry{offset, (uint32_t)string->length()});
+      offset += (uint32_t)string->length();
+    }
+
+    auto fieldsData = reinterpret_cast<const char*>(fields_.data());
+    auto stringEntriesData =
+        reinterpret_cast<const char*>(stringEntries.data());
+    header.payloadCrc =
+        UpdateCrc32(0, fieldsData, fields_.size() * sizeof(uint32_t));
+    header.payloadCrc =
+        UpdateCrc32(header.payloadCrc,
+                    stringEntriesData,
+                    stringEntries.size() * sizeof(StringEntry));
+    for (const auto string : strings_) {
+      header.payloadCrc =
+          UpdateCrc32(header.payloadCrc, string->data(), string->length());
+    }
+
+    // Other processes may have the existing cache file mapped, so it's
+    // replaced by a new file instead of having its contents overwritten.
+    WriteCacheFile(cacheFilePath, [&](std::ostream& out) {
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(fieldsData, fields_.size() * sizeof(uint32_t));
+      out.write(stringEntriesData,
+                stringEntries.size() * sizeof(StringEntry));
+      for (const auto string : strings_) {
+        out.write(string->data(), string->length());
+      }
+    });
+  }
+
+private:
+  uint32_t GetStringIndex(const std::string& value) {
+    auto it = stringIndices_.find(value);
+    if (it == stringIndices_.end()) {
+      it = stringIndices_.emplace(value, (uint32_t)strings_.size()).first;
+      strings_.push_back(&it->first);
+    }
+
+    return it->second;
+  }
+
+  std::vector<uint32_t> fields_;
+  std::unordered_map<std::string, uint32_t> stringIndices_;
+  // Points to the keys of stringIndices_, in index order.
+  std::vector<const std::string*> strings_;
+};
+
+// The cache file's contents. The file is mapped into memory if possible, so
+// that processes that load the same cache share its read-only pages instead
+// of each reading it into their own memory. Plugins are decoded from the
+// mapping when they're first needed.
+struct CacheData {
+  boost::interprocess::mapped_region region;
+  // Holds the contents if the file can't be mapped.
+  std::vector<char> buffer;
+
+  const char* begin = nullptr;
+  size_t size = 0;
+  // Pointers to the sections of the contents that follow the header.
+  const char* fields = nullptr;
+  size_t fieldCount = 0;
+  const char* stringEntries = nullptr;
+  size_t stringCount = 0;
+  const char* strings = nullptr;
+};
+
+// Readers share the loaded data, so that a plugin's fields can be read
+// independently of the rest of the cache.
+class CacheReader {
+public:
+  CacheReader(std::shared_ptr<const CacheData> data, size_t position) :
+      data_(data), position_(position) {}
+
+  uint32_t ReadInt() {
+    if (position_ >= data_->fieldCount) {
+      throw CorruptCacheError();
+    }
+
+    // The mapping may not be suitably aligned, so copy the field out.
+    uint32_t value;
+    std::memcpy(&value,
+                data_->fields + position_ * sizeof(uint32_t),
+                sizeof(value));
+    ++position_;
+    return value;
+  }
+
+  bool ReadBool() { return ReadInt() != 0; }
+
+  std::string ReadString() { return GetString(ReadInt()); }
+
+  MessageContent ReadMessageContent() {
+    auto text = ReadString();
+    return MessageContent(text, ReadString());
+  }
+
+  Message ReadMessage() {
+    auto type = ReadInt();
+    if (type > static_cast<uint32_t>(MessageType::error)) {
+      throw CorruptCacheError();
+    }
+    auto condition = ReadString();
+    auto content = ReadVector(&CacheReader::ReadMessageContent);
+
+    return Message(static_cast<MessageType>(type), content, condition);
+  }
+
+  File ReadFile() {
+    auto name = ReadString();
+    auto display = ReadString();
+    return File(name, display, ReadString());
+  }
+
+  Tag ReadTag() {
+    auto name = ReadString();
+    auto isAddition = ReadBool();
+    return Tag(name, isAddition, ReadString());
+  }
+
+  PluginCleaningData ReadPluginCleaningData() {
+    auto crc = ReadInt();
+    auto itm = ReadInt();
+    auto ref = ReadInt();
+    auto nav = ReadInt();
+    auto utility = ReadString();
+    auto info = ReadVector(&CacheReader::ReadMessageContent);
+
+    return PluginCleaningData(crc, utility, info, itm, ref, nav);
+  }
+
+  Location ReadLocation() {
+    auto url = ReadString();
+    return Location(url, ReadString());
+  }
+
+  Group ReadGroup() {
+    auto name = ReadString();
+    auto description = ReadString();
+    auto afterGroups = ReadSet<std::unordered_set<std::string>>(
+        &CacheReader::ReadString);
+
+    return Group(name, afterGroups, description);
+  }
+
+  PluginMetadata ReadPluginMetadata() {
+    PluginMetadata plugin(ReadString());
+    plugin.SetEnabled(ReadBool());
+
+    auto groupIndex = ReadInt();
+    if (groupIndex != NO_STRING) {
+      plugin.SetGroup(GetString(groupIndex));
+    }
+
+    plugin.SetLoadAfterFiles(ReadSet<std::set<File>>(&CacheReader::ReadFile));
+    plugin.SetRequirements(ReadSet<std::set<File>>(&CacheReader::ReadFile));
+    plugin.SetIncompatibilities(
+        ReadSet<std::set<File>>(&CacheReader::ReadFile));
+    plugin.SetMessages(ReadVector(&CacheReader::ReadMessage));
+    plugin.SetTags(ReadSet<std::set<Tag>>(&CacheReader::ReadTag));
+    plugin.SetDirtyInfo(ReadSet<std::set<PluginCleaningData>>(
+        &CacheReader::ReadPluginCleaningData));
+    plugin.SetCleanInfo(ReadSet<std::set<PluginCleaningData>>(
+        &CacheReader::ReadPluginCleaningData));
+    plugin.SetLocations(
+        ReadSet<std::set<Location>>(&CacheReader::ReadLocation));
+
+    return plugin;
+  }
+
+  template<typename T>
+  std::vector<T> ReadVector(T (CacheReader::*readElement)()) {
+    auto count = ReadCount();
+    std::vector<T> elements;
+    elements.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      elements.push_back((this->*readElement)());
+    }
+
+    return elements;
+  }
+
+  template<typename Set, typename T>
+  Set ReadSet(T (CacheReader::*readElement)()) {
+    auto count = ReadCount();
+    Set elements;
+    for (uint32_t i = 0; i < count; ++i) {
+      elements.insert((this->*readElement)());
+    }
+
+    return elements;
+  }
+
+  // Reads the plugin index and plugin records. If lazy is true, only regex
+  // plugins are decoded, and the others are given as decoders instead.
+  void ReadPlugins(MetadataListContents& contents, bool lazy) {
+    auto count = ReadCount();
+    if (count > (data_->fieldCount - position_) / PLUGIN_INDEX_ENTRY_SIZE) {
+      throw CorruptCacheError();
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+      auto name = ReadString();
+      auto normalizedName = ReadString();
+      auto offset = ReadInt();
+      if (offset >= data_->fieldCount) {
+        throw CorruptCacheError();
+      }
+
+      if (lazy && !PluginMetadata(name).IsRegexPlugin()) {
+        auto data = data_;
+        contents.undecodedPlugins.emplace(normalizedName, [data, offset]() {
+          return CacheReader(data, offset).ReadPluginMetadata();
+        });
+      } else {
+        contents.plugins.push_back(
+            CacheReader(data_, offset).ReadPluginMetadata());
+      }
+    }
+  }
+
+private:
+  // Every element takes at least one field, so a count larger than the number
+  // of remaining fields must be corrupt. Checking this avoids reserving a huge
+  // amount of memory.
+  uint32_t ReadCount() {
+    auto count = ReadInt();
+    if (count > data_->fieldCount - position_) {
+      throw CorruptCacheError();
+    }
+
+    return count;
+  }
+
+  // The string entries were checked when the cache was opened.
+  std::string GetString(uint32_t index) const {
+    if (index >= data_->stringCount) {
+      throw CorruptCacheError();
+    }
+
+    StringEntry entry;
+    std::memcpy(&entry,
+                data_->stringEntries + index * sizeof(StringEntry),
+                sizeof(entry));
+
+    return std::string(data_->strings + entry.offset, entry.length);
+  }
+
+  const std::shared_ptr<const CacheData> data_;
+  size_t position_;
+};
+
+// Maps the given file into memory, or if that fails, reads it into memory.
+// Returns null if the file can't be read.
+std::shared_ptr<CacheData> ReadCacheFile(
+    const std::filesystem::path& cacheFilePath) {
+  auto data = std::make_shared<CacheData>();
+
+  std::error_code errorCode;
+  auto fileSize = std::filesystem::file_size(cacheFilePath, errorCode);
+  if (errorCode) {
+    return nullptr;
+  }
+
+  try {
+    if (fileSize > 0) {
+      // The mapping outlives the file mapping object, which holds the file
+      // open.
+      boost::interprocess::file_mapping file(cacheFilePath.c_str(),
+                                             boost::interprocess::read_only);
+      data->region = boost::interprocess::mapped_region(
+          file, boost::interprocess::read_only);
+      data->begin = static_cast<const char*>(data->region.get_address());
+      data->size = data->region.get_size();
+      return data;
+    }
+  } catch (boost::interprocess::interprocess_exception& e) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->debug("Unable to map compiled metadata cache file {}: {}",
+                    cacheFilePath.u8string(),
+                    e.what());
+    }
+  }
+
+  std::ifstream in(cacheFilePath, std::ios::binary);
+  if (!in.is_open()) {
+    return nullptr;
+  }
+
+  data->buffer.resize(fileSize);
+  in.read(data->buffer.data(), data->buffer.size());
+  if (!in.good()) {
+    return nullptr;
+  }
+
+  data->begin = data->buffer.data();
+  data->size = data->buffer.size();
+  return data;
+}
+
+std::optional<CacheReader> OpenCache(const std::filesystem::path& cacheFilePath,
+                                     const MetadataListSource& source) {
+  auto data = ReadCacheFile(cacheFilePath);
+  if (!data || data->size < sizeof(FileHeader)) {
+    return std::nullopt;
+  }
+
+  FileHeader header;
+  std::memcpy(&header, data->begin, sizeof(header));
+  if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+      header.version != CACHE_VERSION || header.sourceCrc != source.crc ||
+      header.sourceFileSize != source.fileSize) {
+    return std::nullopt;
+  }
+
+  // Plugins may be decoded long after the cache is loaded, so check that the
+  // data is intact now rather than risk finding out later.
+  auto payloadCrc = UpdateCrc32(0,
+                                data->begin + sizeof(FileHeader),
+                                data->size - sizeof(FileHeader));
+  if (payloadCrc != header.payloadCrc) {
+    return std::nullopt;
+  }
+
+  auto stringEntriesOffset =
+      sizeof(FileHeader) + (size_t)header.fieldCount * sizeof(uint32_t);
+  auto stringsOffset =
+      stringEntriesOffset + (size_t)header.stringCount * sizeof(StringEntry);
+  if (data->size < stringsOffset) {
+    return std::nullopt;
+  }
+
+  for (size_t i = 0; i < header.stringCount; ++i) {
+    StringEntry entry;
+    std::memcpy(&entry,
+                data->begin + stringEntriesOffset + i * sizeof(StringEntry),
+                sizeof(entry));
+
+    if ((size_t)entry.offset + entry.length > data->size - stringsOffset) {
+      return std::nullopt;
+    }
+  }
+
+  data->fields = data->begin + sizeof(FileHeader);
+  data->fieldCount = header.fieldCount;
+  data->stringEntries = data->begin + stringEntriesOffset;
+  data->stringCount = header.stringCount;
+  data->strings = data->begin + stringsOffset;
+
+  MarkCacheFileUsed(cacheFilePath);
+
+  return CacheReader(data, 0);
+}
+}
+
+MetadataListSource MetadataListSource::FromFile(
+    const std::filesystem::path& filepath) {
+  MetadataListSource source;
+  source.fileSize = std::filesystem::file_size(filepath);
+  source.crc = GetCrc32(filepath);
+
+  return source;
+}
+
+std::optional<MetadataListContents> LoadMetadataListCache(
+    const std::filesystem::path& cacheFilePath,
+    const MetadataListSource& source,
+    bool lazy) {
+  auto logger = getLogger();
+
+  auto reader = OpenCache(cacheFilePath, source);
+  if (!reader) {
+    if (logger) {
+      logger->debug(
+          "No valid compiled metadata cache matching the source file was found "
+          "at: {}",
+          cacheFilePath.u8string());
+    }
+    return std::nullopt;
+  }
+
+  try {
+    MetadataListContents contents;
+    contents.bashTags =
+        reader->ReadSet<std::set<std::string>>(&CacheReader::ReadString);
+    contents.groups =
+        reader->ReadSet<std::unordered_set<Group>>(&CacheReader::ReadGroup);
+    contents.messages = reader->ReadVector(&CacheReader::ReadMessage);
+
+    reader->ReadPlugins(contents, lazy);
+
+    return contents;
+  } catch (CorruptCacheError&) {
+    if (logger) {
+      logger->warn("Ignoring corrupt compiled metadata cache file: {}",
+                   cacheFilePath.u8string());
+    }
+    return std::nullopt;
+  }
+}
+
+void SaveMetadataListCache(const std::filesystem::path& cacheFilePath,
+                           const MetadataListSource& source,
+                           const MetadataListContents& contents) {
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Saving compiled metadata cache to: {}",
+                  cacheFilePath.u8string());
+  }
+
+  CacheWriter writer;
+  writer.WriteAll(contents.bashTags);
+  writer.WriteAll(contents.groups);
+  writer.WriteAll(contents.messages);
+  writer.WritePlugins(contents.plugins);
+
+  writer.Save(cacheFilePath, source);
+}
+}
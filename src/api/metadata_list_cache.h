@@ -0,0 +1,86 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_METADATA_LIST_CACHE
+#define LOOT_API_METADATA_LIST_CACHE
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "loot/metadata/group.h"
+#include "loot/metadata/message.h"
+#include "loot/metadata/plugin_metadata.h"
+
+namespace loot {
+// The data loaded from a metadata file.
+struct MetadataListContents {
+  std::set<std::string> bashTags;
+  std::unordered_set<Group> groups;
+  std::vector<Message> messages;
+  std::list<PluginMetadata> plugins;
+  // Plugins that have not yet been decoded, keyed by their normalized names.
+  std::unordered_map<std::string, std::function<PluginMetadata()>>
+      undecodedPlugins;
+};
+
+// Identifies the contents of the metadata file that a cache was compiled from.
+struct MetadataListSource {
+  static MetadataListSource FromFile(const std::filesystem::path& filepath);
+
+  uintmax_t fileSize;
+  uint32_t crc;
+};
+
+// Compiled metadata cache files store metadata in a binary format that is much
+// faster to load than YAML. They hold a fixed-size header that identifies the
+// source file, followed by a sequence of 32-bit fields, followed by a table of
+// strings that the fields refer to by index. Each distinct string is stored
+// once. Plugin records are preceded by an index of their names and offsets, so
+// that each can be decoded on its own. All integers are stored in native byte
+// order, as the cache is not intended to be shared between machines.
+
+// Returns the cached contents if the given file is a valid cache compiled from
+// the given source, and nullopt otherwise. If lazy is true, non-regex plugins
+// are returned in undecodedPlugins instead of plugins.
+std::optional<MetadataListContents> LoadMetadataListCache(
+    const std::filesystem::path& cacheFilePath,
+    const MetadataListSource& source,
+    bool lazy = false);
+
+// Throws a FileAccessError if the cache file cannot be written.
+void SaveMetadataListCache(const std::filesystem::path& cacheFilePath,
+                           const MetadataListSource& source,
+                           const MetadataListContents& contents);
+}
+
+#endif
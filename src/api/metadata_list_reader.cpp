@@ -0,0 +1,252 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/metadata_list_reader.h"
+
+#include <yaml-cpp/parser.h>
+
+namespace loot {
+namespace {
+const std::string MERGE_KEY = "<<";
+
+bool IsMergeKey(const YAML::Node& key) {
+  return key.IsScalar() && key.Scalar() == MERGE_KEY;
+}
+
+bool HasKey(const YAML::Node& map, const YAML::Node& key) {
+  if (!key.IsScalar()) {
+    return false;
+  }
+
+  for (const auto& pair : map) {
+    if (pair.first.IsScalar() && pair.first.Scalar() == key.Scalar()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+}
+
+MetadataListReader::MetadataListReader(ElementHandler elementHandler,
+                                       ValueHandler valueHandler) :
+    elementHandler_(elementHandler),
+    valueHandler_(valueHandler),
+    isRootMap_(false) {}
+
+bool MetadataListReader::Read(std::istream& in) {
+  isRootMap_ = false;
+  frames_.clear();
+  anchors_.clear();
+
+  YAML::Parser parser(in);
+  parser.HandleNextDocument(*this);
+
+  anchors_.clear();
+
+  return isRootMap_;
+}
+
+void MetadataListReader::OnDocumentStart(const YAML::Mark&) {}
+
+void MetadataListReader::OnDocumentEnd() {}
+
+void MetadataListReader::OnNull(const YAML::Mark&, YAML::anchor_t anchor) {
+  YAML::Node node(YAML::NodeType::Null);
+  AddAnchor(anchor, node);
+  AddNode(node);
+}
+
+void MetadataListReader::OnAlias(const YAML::Mark&, YAML::anchor_t anchor) {
+  AddNode(anchors_[anchor]);
+}
+
+void MetadataListReader::OnScalar(const YAML::Mark&,
+                                  const std::string& tag,
+                                  YAML::anchor_t anchor,
+                                  const std::string& value) {
+  YAML::Node node(value);
+  node.SetTag(tag);
+  AddAnchor(anchor, node);
+  AddNode(node);
+}
+
+void MetadataListReader::OnSequenceStart(const YAML::Mark&,
+                                         const std::string& tag,
+                                         YAML::anchor_t anchor,
+                                         YAML::EmitterStyle::value style) {
+  // Anchored sequences are built in full so that they can be aliased.
+  if (IsReadingTopLevelValue() && anchor == YAML::NullAnchor) {
+    Frame frame{FrameType::topLevelSequence};
+    frame.topLevelKey = GetKeyString(frames_.back().key.value());
+    frames_.push_back(frame);
+    return;
+  }
+
+  YAML::Node node(YAML::NodeType::Sequence);
+  node.SetTag(tag);
+  node.SetStyle(style);
+  AddAnchor(anchor, node);
+  frames_.push_back(Frame{FrameType::sequence, node});
+}
+
+void MetadataListReader::OnSequenceEnd() {
+  auto frame = frames_.back();
+  frames_.pop_back();
+
+  if (frame.type == FrameType::topLevelSequence) {
+    // The elements have already been handled.
+    frames_.back().key.reset();
+  } else {
+    AddNode(frame.node);
+  }
+}
+
+void MetadataListReader::OnMapStart(const YAML::Mark&,
+                                    const std::string& tag,
+                                    YAML::anchor_t anchor,
+                                    YAML::EmitterStyle::value style) {
+  if (frames_.empty() && !isRootMap_) {
+    isRootMap_ = true;
+    frames_.push_back(Frame{FrameType::rootMap});
+    return;
+  }
+
+  YAML::Node node(YAML::NodeType::Map);
+  node.SetTag(tag);
+  node.SetStyle(style);
+  AddAnchor(anchor, node);
+  frames_.push_back(Frame{FrameType::map, node});
+}
+
+void MetadataListReader::OnMapEnd() {
+  auto frame = frames_.back();
+  frames_.pop_back();
+
+  if (frame.type == FrameType::map) {
+    ResolveMergeKeys(frame.node);
+    AddNode(frame.node);
+  }
+}
+
+std::string MetadataListReader::GetKeyString(const YAML::Node& key) {
+  return key.IsScalar() ? key.Scalar() : std::string();
+}
+
+// Replaces the map's merge keys with the entries of the maps that they refer
+// to, unless the map already has an entry with the same key. If a merge key
+// refers to a sequence of maps, earlier maps take precedence.
+void MetadataListReader::ResolveMergeKeys(YAML::Node& map) {
+  bool hasMergeKey = false;
+  for (const auto& pair : map) {
+    if (IsMergeKey(pair.first)) {
+      hasMergeKey = true;
+      break;
+    }
+  }
+
+  if (!hasMergeKey) {
+    return;
+  }
+
+  YAML::Node merged(YAML::NodeType::Map);
+  merged.SetTag(map.Tag());
+  std::vector<YAML::Node> sources;
+  for (const auto& pair : map) {
+    if (!IsMergeKey(pair.first)) {
+      merged.force_insert(pair.first, pair.second);
+    } else if (pair.second.IsMap()) {
+      sources.push_back(pair.second);
+    } else if (pair.second.IsSequence()) {
+      for (const auto& source : pair.second) {
+        if (!source.IsMap()) {
+          throw YAML::RepresentationException(
+              source.Mark(), "bad conversion: merge key values must be maps");
+        }
+        sources.push_back(source);
+      }
+    } else {
+      throw YAML::RepresentationException(
+          pair.second.Mark(), "bad conversion: merge key values must be maps");
+    }
+  }
+
+  for (const auto& source : sources) {
+    for (const auto& pair : source) {
+      if (!HasKey(merged, pair.first)) {
+        merged.force_insert(pair.first, pair.second);
+      }
+    }
+  }
+
+  // Assigning to the node also changes any anchors that refer to it.
+  map = merged;
+}
+
+bool MetadataListReader::IsReadingTopLevelValue() const {
+  return !frames_.empty() && frames_.back().type == FrameType::rootMap &&
+         frames_.back().key.has_value();
+}
+
+void MetadataListReader::AddAnchor(YAML::anchor_t anchor,
+                                   const YAML::Node& node) {
+  if (anchor != YAML::NullAnchor) {
+    anchors_[anchor] = node;
+  }
+}
+
+void MetadataListReader::AddNode(const YAML::Node& node) {
+  if (frames_.empty()) {
+    // This is the document's root, which isn't a map.
+    return;
+  }
+
+  auto& frame = frames_.back();
+  switch (frame.type) {
+    case FrameType::rootMap:
+      if (!frame.key) {
+        frame.key = node;
+      } else {
+        valueHandler_(GetKeyString(frame.key.value()), node);
+        frame.key.reset();
+      }
+      break;
+    case FrameType::topLevelSequence:
+      elementHandler_(frame.topLevelKey, node);
+      break;
+    case FrameType::map:
+      if (!frame.key) {
+        frame.key = node;
+      } else {
+        frame.node.force_insert(frame.key.value(), node);
+        frame.key.reset();
+      }
+      break;
+    case FrameType::sequence:
+      frame.node.push_back(node);
+      break;
+  }
+}
+}
@@ -0,0 +1,118 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_METADATA_LIST_READER
+#define LOOT_API_METADATA_LIST_READER
+
+#include <functional>
+#include <istream>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <yaml-cpp/eventhandler.h>
+#include <yaml-cpp/yaml.h>
+
+namespace loot {
+// Reads a metadata file's YAML document from the parser's events, so that the
+// elements of its top-level sequences (e.g. the plugin entries) can be
+// converted and discarded as they are read, instead of first building nodes
+// for the whole document. Nodes are only built for one element at a time,
+// plus anything that is anchored so that aliases to it can be resolved.
+//
+// Merge keys are resolved as each map is read, so the nodes that are passed
+// to the handlers never contain them.
+class MetadataListReader : public YAML::EventHandler {
+public:
+  // Called with the key of a top-level sequence and each of its elements.
+  typedef std::function<void(const std::string& key,
+                             const YAML::Node& element)>
+      ElementHandler;
+  // Called with the key and value of each other top-level map entry.
+  typedef std::function<void(const std::string& key, const YAML::Node& value)>
+      ValueHandler;
+
+  MetadataListReader(ElementHandler elementHandler, ValueHandler valueHandler);
+
+  // Reads the first document in the given stream, and returns false if its
+  // root is not a map, in which case no handlers are called.
+  bool Read(std::istream& in);
+
+  void OnDocumentStart(const YAML::Mark& mark);
+  void OnDocumentEnd();
+
+  void OnNull(const YAML::Mark& mark, YAML::anchor_t anchor);
+  void OnAlias(const YAML::Mark& mark, YAML::anchor_t anchor);
+  void OnScalar(const YAML::Mark& mark,
+                const std::string& tag,
+                YAML::anchor_t anchor,
+                const std::string& value);
+
+  void OnSequenceStart(const YAML::Mark& mark,
+                       const std::string& tag,
+                       YAML::anchor_t anchor,
+                       YAML::EmitterStyle::value style);
+  void OnSequenceEnd();
+
+  void OnMapStart(const YAML::Mark& mark,
+                  const std::string& tag,
+                  YAML::anchor_t anchor,
+                  YAML::EmitterStyle::value style);
+  void OnMapEnd();
+
+private:
+  enum struct FrameType { rootMap, topLevelSequence, map, sequence };
+
+  struct Frame {
+    explicit Frame(FrameType type, YAML::Node node = YAML::Node()) :
+        type(type), node(node) {}
+
+    FrameType type;
+    YAML::Node node;
+    // For maps, the key of the entry whose value is being read, if any.
+    std::optional<YAML::Node> key;
+    // For top-level sequences, the key of the root map entry.
+    std::string topLevelKey;
+  };
+
+  static std::string GetKeyString(const YAML::Node& key);
+  static void ResolveMergeKeys(YAML::Node& map);
+
+  bool IsReadingTopLevelValue() const;
+  void AddAnchor(YAML::anchor_t anchor, const YAML::Node& node);
+  // Adds the given node to the collection that is currently being read.
+  void AddNode(const YAML::Node& node);
+
+  ElementHandler elementHandler_;
+  ValueHandler valueHandler_;
+
+  bool isRootMap_;
+  std::vector<Frame> frames_;
+  std::unordered_map<YAML::anchor_t, YAML::Node> anchors_;
+};
+}
+
+#endif
@@ -25,13 +25,16 @@
 #include "api/plugin.h"
 
 #include <filesystem>
+#include <unordered_set>
 
-#include <boost/algorithm/string.hpp>
 #include <boost/locale.hpp>
 
 #include "api/game/game.h"
+#include "api/game/game_policy.h"
 #include "api/helpers/crc.h"
 #include "api/helpers/logging.h"
+#include "api/helpers/memory_usage.h"
+#include "api/helpers/prefetch.h"
 #include "api/helpers/text.h"
 #include "loot/exception/file_access_error.h"
 
@@ -39,15 +42,38 @@ using std::set;
 using std::string;
 
 namespace loot {
+namespace {
+// Used to estimate the memory used by a plugin's parsed records. No record is
+// smaller than a Morrowind record header, and esplugin keeps at least an ID
+// and some flags for each record.
+constexpr uintmax_t MIN_RECORD_SIZE = 16;
+constexpr uintmax_t ESTIMATED_RECORD_ENTRY_SIZE = 8;
+
+std::string TrimGhostExtension(const std::string& filename) {
+  if (EndsWithIgnoringAsciiCase(filename, ".ghost")) {
+    return filename.substr(0, filename.length() - 6);
+  }
+
+  return filename;
+}
+}
+
 Plugin::Plugin(const GameType gameType,
                std::shared_ptr<GameCache> gameCache,
                std::filesystem::path pluginPath,
                const bool headerOnly) :
-    name_(pluginPath.filename().u8string()),
-    esPlugin(nullptr),
     isEmpty_(true),
+    isMaster_(false),
+    isLightMaster_(false),
     loadsArchive_(false),
-    numOverrideRecords_(0) {
+    headerVersion_(0.0f),
+    gameType_(gameType),
+    name_(pluginPath.filename().u8string()),
+    normalizedName_(NormalizeFilename(name_)),
+    headerOnly_(headerOnly),
+    gameCache_(gameCache),
+    fileSize_(0),
+    esPlugin(nullptr) {
   auto logger = getLogger();
 
   try {
@@ -56,25 +82,46 @@ Plugin::Plugin(const GameType gameType,
       pluginPath += ".ghost";
     }
 
-    Load(pluginPath, gameType, headerOnly);
+    // Record the file's state before reading it so that any change made while
+    // it is being read will be picked up.
+    path_ = pluginPath;
+    fileSize_ = std::filesystem::file_size(pluginPath);
+    modificationTime_ = std::filesystem::last_write_time(pluginPath);
 
-    auto ret = esp_plugin_is_empty(esPlugin.get(), &isEmpty_);
-    if (ret != ESP_OK) {
-      throw FileAccessError("Error checking if \"" + name_ + "\" is empty. esplugin error code: " + std::to_string(ret));
+    Read(gameCache);
+  } catch (std::exception& e) {
+    if (logger) {
+      logger->error(
+          "Cannot read plugin file \"{}\". Details: {}", name_, e.what());
     }
+    throw FileAccessError("Cannot read \"" + name_ + "\". Details: " + e.what());
+  }
+}
 
-    if (!headerOnly) {
-      crc_ = GetCrc32(pluginPath);
-
-      ret = esp_plugin_count_override_records(esPlugin.get(),
-                                              &numOverrideRecords_);
-      if (ret != ESP_OK) {
-        throw FileAccessError("Error counting override records in \"" + name_ + "\". esplugin error code: " + std::to_string(ret));
-      }
-    }
+Plugin::Plugin(const GameType gameType,
+               std::shared_ptr<GameCache> gameCache,
+               const std::filesystem::path& filePath,
+               uintmax_t fileSize,
+               std::filesystem::file_time_type modificationTime,
+               const bool headerOnly) :
+    isEmpty_(true),
+    isMaster_(false),
+    isLightMaster_(false),
+    loadsArchive_(false),
+    headerVersion_(0.0f),
+    gameType_(gameType),
+    name_(TrimGhostExtension(filePath.filename().u8string())),
+    normalizedName_(NormalizeFilename(name_)),
+    headerOnly_(headerOnly),
+    gameCache_(gameCache),
+    path_(filePath),
+    fileSize_(fileSize),
+    modificationTime_(modificationTime),
+    esPlugin(nullptr) {
+  auto logger = getLogger();
 
-    tags_ = ExtractBashTags(GetDescription());
-    loadsArchive_ = LoadsArchive(gameType, gameCache, pluginPath);
+  try {
+    Read(gameCache);
   } catch (std::exception& e) {
     if (logger) {
       logger->error(
@@ -84,66 +131,145 @@ Plugin::Plugin(const GameType gameType,
   }
 }
 
-std::string Plugin::GetName() const { return name_; }
-
-float Plugin::GetHeaderVersion() const {
-  float version;
-  auto ret = esp_plugin_header_version(esPlugin.get(), &version);
-  if (ret != ESP_OK) {
-    throw FileAccessError(name_ +
-      " : esplugin error code: " + std::to_string(ret));
+Plugin::Plugin(const Plugin& plugin,
+               std::shared_ptr<GameCache> gameCache,
+               const bool headerOnly) :
+    isEmpty_(plugin.isEmpty_),
+    isMaster_(plugin.isMaster_),
+    isLightMaster_(plugin.isLightMaster_),
+    loadsArchive_(LoadsArchive(plugin.gameType_, gameCache, plugin.path_)),
+    headerVersion_(plugin.headerVersion_),
+    gameType_(plugin.gameType_),
+    name_(plugin.name_),
+    normalizedName_(plugin.normalizedName_),
+    headerOnly_(headerOnly),
+    gameCache_(gameCache),
+    path_(plugin.path_),
+    fileSize_(plugin.fileSize_),
+    modificationTime_(plugin.modificationTime_),
+    masters_(plugin.masters_),
+    version_(plugin.version_),
+    tags_(plugin.tags_),
+    recordData_(plugin.recordData_),
+    esPlugin(plugin.esPlugin) {
+  if (headerOnly_ == plugin.headerOnly_) {
+    return;
   }
 
-  return version;
+  if (headerOnly_) {
+    recordData_.reset();
+
+    // The header records how many records the plugin has, so checking if it
+    // is empty doesn't need its records.
+    auto ret = esp_plugin_is_empty(esPlugin.get(), &isEmpty_);
+    if (ret != ESP_OK) {
+      throw FileAccessError("Error checking if \"" + name_ +
+                            "\" is empty. esplugin error code: " +
+                            std::to_string(ret));
+    }
+  } else {
+    recordData_ = std::make_shared<RecordData>();
+    if (gameCache) {
+      const auto& persistentCache = gameCache->GetPersistentCache();
+      recordData_->crc =
+          persistentCache.GetCrc(path_, fileSize_, modificationTime_);
+      recordData_->cachedIsValidAsLightMaster =
+          persistentCache.GetIsValidAsLightMaster(
+              path_, fileSize_, modificationTime_);
+    }
+  }
 }
 
-std::optional<std::string> Plugin::GetVersion() const {
-  return ExtractVersion(GetDescription());
+std::string Plugin::GetName() const { return name_; }
+
+const std::string& Plugin::GetNormalizedName() const {
+  return normalizedName_;
 }
 
-std::vector<std::string> Plugin::GetMasters() const {
-  char** masters;
-  uint8_t numMasters;
-  auto ret = esp_plugin_masters(esPlugin.get(), &masters, &numMasters);
-  if (ret != ESP_OK) {
-    throw FileAccessError(name_ +
-                          " : esplugin error code: " + std::to_string(ret));
-  }
+float Plugin::GetHeaderVersion() const { return headerVersion_; }
 
-  std::vector<std::string> mastersVec(masters, masters + numMasters);
-  esp_string_array_free(masters, numMasters);
+std::optional<std::string> Plugin::GetVersion() const { return version_; }
 
-  return mastersVec;
+std::vector<std::string> Plugin::GetMasters() const { return masters_; }
+
+const std::vector<std::string>& Plugin::GetMastersRef() const {
+  return masters_;
 }
 
 std::set<Tag> Plugin::GetBashTags() const { return tags_; }
 
-std::optional<uint32_t> Plugin::GetCRC() const { return crc_; }
+std::optional<uint32_t> Plugin::GetCRC() const {
+  if (headerOnly_) {
+    return std::nullopt;
+  }
 
-bool Plugin::IsMaster() const {
-  bool isMaster;
-  auto ret = esp_plugin_is_master(esPlugin.get(), &isMaster);
-  if (ret != ESP_OK) {
-    throw FileAccessError(name_ +
-                          " : esplugin error code: " + std::to_string(ret));
+  std::lock_guard<std::mutex> lock(recordData_->crcMutex);
+  if (recordData_->crc) {
+    return recordData_->crc;
+  }
+
+  // Check the file's state before reading it, so that a CRC isn't cached
+  // for a file that has changed.
+  const bool isFileUnchanged = IsFileUnchanged();
+  if (!isFileUnchanged) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->warn(
+          "\"{}\" has changed since its header was loaded, its CRC may not "
+          "match its header.",
+          name_);
+    }
   }
 
-  return isMaster;
+  try {
+    recordData_->crc = GetCrc32(path_);
+  } catch (std::exception& e) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->error("Cannot calculate the CRC of plugin file \"{}\". "
+                    "Details: {}",
+                    name_,
+                    e.what());
+    }
+    throw FileAccessError("Cannot calculate the CRC of \"" + name_ +
+                          "\". Details: " + e.what());
+  }
+
+  auto gameCache = gameCache_.lock();
+  if (isFileUnchanged && gameCache) {
+    gameCache->GetPersistentCache().SetCrc(
+        path_, fileSize_, modificationTime_, recordData_->crc.value());
+  }
+
+  return recordData_->crc;
 }
 
-bool Plugin::IsLightMaster() const {
-  bool isLightMaster;
-  auto ret = esp_plugin_is_light_master(esPlugin.get(), &isLightMaster);
-  if (ret != ESP_OK) {
-    throw FileAccessError(name_ +
-                          " : esplugin error code: " + std::to_string(ret));
+std::optional<uint32_t> Plugin::GetCRCIfCalculated() const {
+  if (headerOnly_) {
+    return std::nullopt;
   }
 
-  return isLightMaster;
+  std::lock_guard<std::mutex> lock(recordData_->crcMutex);
+  return recordData_->crc;
 }
 
-bool Plugin::IsValidAsLightMaster() const
-{
+bool Plugin::IsMaster() const { return isMaster_; }
+
+bool Plugin::IsLightMaster() const { return isLightMaster_; }
+
+bool Plugin::IsValidAsLightMaster() const {
+  if (!headerOnly_) {
+    {
+      std::lock_guard<std::mutex> lock(recordData_->mutex);
+      if (!recordData_->isParsed &&
+          recordData_->cachedIsValidAsLightMaster.has_value()) {
+        return recordData_->cachedIsValidAsLightMaster.value();
+      }
+    }
+
+    return GetRecordData().isValidAsLightMaster;
+  }
+
   bool isValid;
   auto ret = esp_plugin_is_valid_as_light_master(esPlugin.get(), &isValid);
   if (ret != ESP_OK) {
@@ -154,17 +280,21 @@ bool Plugin::IsValidAsLightMaster() const
   return isValid;
 }
 
-bool Plugin::IsEmpty() const { return isEmpty_; }
+bool Plugin::IsEmpty() const {
+  return headerOnly_ ? isEmpty_ : GetRecordData().isEmpty;
+}
 
 bool Plugin::LoadsArchive() const { return loadsArchive_; }
 
 bool Plugin::DoFormIDsOverlap(const PluginInterface& plugin) const {
   try {
-    auto otherPlugin = dynamic_cast<const Plugin&>(plugin);
+    const auto& otherPlugin = dynamic_cast<const Plugin&>(plugin);
 
     bool doPluginsOverlap;
+    auto records = GetRecordsPlugin();
+    auto otherRecords = otherPlugin.GetRecordsPlugin();
     auto ret = esp_plugin_do_records_overlap(
-        esPlugin.get(), otherPlugin.esPlugin.get(), &doPluginsOverlap);
+        records.get(), otherRecords.get(), &doPluginsOverlap);
     if (ret != ESP_OK) {
       throw FileAccessError(name_ +
                             " : esplugin error code: " + std::to_string(ret));
@@ -183,7 +313,134 @@ bool Plugin::DoFormIDsOverlap(const PluginInterface& plugin) const {
   return false;
 }
 
-size_t Plugin::NumOverrideFormIDs() const { return numOverrideRecords_; }
+bool Plugin::MayFormIDsOverlap(const Plugin& plugin) const {
+  if (headerOnly_ || plugin.headerOnly_) {
+    return false;
+  }
+
+  if (gameType_ == GameType::tes3) {
+    return true;
+  }
+
+  // If neither plugin overrides any records, each plugin's records all
+  // belong to itself.
+  if (NumOverrideFormIDs() == 0 && plugin.NumOverrideFormIDs() == 0) {
+    return false;
+  }
+
+  std::unordered_set<std::string> origins({normalizedName_});
+  for (const auto& master : masters_) {
+    origins.insert(NormalizeFilename(master));
+  }
+
+  if (origins.count(plugin.normalizedName_) != 0) {
+    return true;
+  }
+
+  for (const auto& master : plugin.masters_) {
+    if (origins.count(NormalizeFilename(master)) != 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Plugin::IsHeaderOnly() const { return headerOnly_; }
+
+GameType Plugin::GetGameType() const { return gameType_; }
+
+const std::filesystem::path& Plugin::GetFilePath() const { return path_; }
+
+uintmax_t Plugin::GetLoadedFileSize() const { return fileSize_; }
+
+std::filesystem::file_time_type Plugin::GetLoadedModificationTime() const {
+  return modificationTime_;
+}
+
+void Plugin::LoadRecords() const {
+  if (!headerOnly_) {
+    GetRecordData();
+  }
+}
+
+void Plugin::PrefetchRecords() const {
+  if (headerOnly_) {
+    return;
+  }
+
+  // If the lock is held, the records are being parsed, so it's too late to
+  // prefetch them.
+  std::unique_lock<std::mutex> lock(recordData_->mutex, std::try_to_lock);
+  if (!lock.owns_lock() || recordData_->isParsed) {
+    return;
+  }
+  lock.unlock();
+
+  PrefetchFile(path_);
+}
+
+void Plugin::ReleaseRecords() const {
+  if (headerOnly_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(recordData_->mutex);
+  recordData_->esPlugin.reset();
+}
+
+void Plugin::PrefetchHeader(const std::filesystem::path& pluginPath) {
+  // Enough for the headers of all but the largest plugins, which have very
+  // long descriptions or master lists.
+  static constexpr uintmax_t HEADER_PREFETCH_LENGTH = 64 * 1024;
+
+  PrefetchFile(pluginPath, HEADER_PREFETCH_LENGTH);
+}
+
+bool Plugin::IsFileUnchanged() const {
+  std::error_code errorCode;
+  auto fileSize = std::filesystem::file_size(path_, errorCode);
+  if (errorCode) {
+    return false;
+  }
+
+  auto modificationTime = std::filesystem::last_write_time(path_, errorCode);
+  if (errorCode) {
+    return false;
+  }
+
+  return fileSize == fileSize_ && modificationTime == modificationTime_;
+}
+
+size_t Plugin::NumOverrideFormIDs() const {
+  return headerOnly_ ? 0 : GetRecordData().numOverrideRecords;
+}
+
+size_t Plugin::GetMemoryUsage() const {
+  size_t bytes = sizeof(Plugin) + EstimateHeapSize(name_) +
+                 EstimateHeapSize(normalizedName_) + EstimateHeapSize(path_) +
+                 EstimateHeapSize(masters_) + EstimateHeapSize(version_) +
+                 EstimateHeapSize(tags_);
+  if (recordData_) {
+    bytes += sizeof(RecordData);
+  }
+
+  return bytes;
+}
+
+size_t Plugin::GetRecordsMemoryUsage() const {
+  if (headerOnly_) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(recordData_->mutex);
+  if (!recordData_->esPlugin) {
+    return 0;
+  }
+
+  return static_cast<size_t>(fileSize_ / MIN_RECORD_SIZE *
+                             ESTIMATED_RECORD_ENTRY_SIZE);
+}
 
 bool Plugin::IsValid(const GameType gameType,
                      const std::filesystem::path& pluginPath) {
@@ -226,12 +483,12 @@ uintmax_t Plugin::GetFileSize(std::filesystem::path pluginPath) {
 }
 
 bool Plugin::operator<(const Plugin& rhs) const {
-  return CompareFilenames(name_, rhs.name_) < 0;
+  return CompareNormalizedFilenames(normalizedName_, rhs.normalizedName_) < 0;
 }
 
-void Plugin::Load(const std::filesystem::path& path,
-                  GameType gameType,
-                  bool headerOnly) {
+Plugin::EspPluginPtr Plugin::Load(const std::filesystem::path& path,
+                                  GameType gameType,
+                                  bool headerOnly) {
   ::Plugin* plugin;
   int ret = esp_plugin_new(
       &plugin, GetEspluginGameId(gameType), path.u8string().c_str());
@@ -240,14 +497,175 @@ void Plugin::Load(const std::filesystem::path& path,
                           " : esplugin error code: " + std::to_string(ret));
   }
 
-  esPlugin = std::shared_ptr<std::remove_pointer<::Plugin>::type>(
-      plugin, esp_plugin_free);
+  auto parsedPlugin = EspPluginPtr(plugin, esp_plugin_free);
 
-  ret = esp_plugin_parse(esPlugin.get(), headerOnly);
+  ret = esp_plugin_parse(parsedPlugin.get(), headerOnly);
   if (ret != ESP_OK) {
     throw FileAccessError(path.u8string() +
                           " : esplugin error code: " + std::to_string(ret));
   }
+
+  return parsedPlugin;
+}
+
+const Plugin::RecordData& Plugin::GetRecordData() const {
+  std::lock_guard<std::mutex> lock(recordData_->mutex);
+
+  if (!recordData_->isParsed) {
+    if (!IsFileUnchanged()) {
+      auto logger = getLogger();
+      if (logger) {
+        logger->warn(
+            "\"{}\" has changed since its header was loaded, its records "
+            "may not match its header.",
+            name_);
+      }
+    }
+
+    ParseRecords();
+  }
+
+  if (!recordData_->error.empty()) {
+    throw FileAccessError("Cannot read the records of \"" + name_ +
+                          "\". Details: " + recordData_->error);
+  }
+
+  return *recordData_;
+}
+
+void Plugin::ParseRecords() const {
+  recordData_->isParsed = true;
+
+  try {
+    auto plugin = Load(path_, gameType_, false);
+
+    auto ret = esp_plugin_is_empty(plugin.get(), &recordData_->isEmpty);
+    if (ret != ESP_OK) {
+      throw FileAccessError("Error checking if \"" + name_ + "\" is empty. esplugin error code: " + std::to_string(ret));
+    }
+
+    ret = esp_plugin_count_override_records(
+        plugin.get(), &recordData_->numOverrideRecords);
+    if (ret != ESP_OK) {
+      throw FileAccessError("Error counting override records in \"" + name_ + "\". esplugin error code: " + std::to_string(ret));
+    }
+
+    ret = esp_plugin_is_valid_as_light_master(
+        plugin.get(), &recordData_->isValidAsLightMaster);
+    if (ret != ESP_OK) {
+      throw FileAccessError(name_ +
+                            " : esplugin error code: " + std::to_string(ret));
+    }
+
+    // Checking light master validity walks all the records, so save the
+    // result to be reused while the file is unchanged.
+    auto gameCache = gameCache_.lock();
+    if (gameCache && IsFileUnchanged()) {
+      gameCache->GetPersistentCache().SetIsValidAsLightMaster(
+          path_, fileSize_, modificationTime_, recordData_->isValidAsLightMaster);
+    }
+
+    recordData_->esPlugin = plugin;
+  } catch (std::exception& e) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->error("Cannot read the records of plugin file \"{}\". "
+                    "Details: {}",
+                    name_,
+                    e.what());
+    }
+    recordData_->error = e.what();
+  }
+}
+
+Plugin::EspPluginPtr Plugin::GetRecordsPlugin() const {
+  if (headerOnly_) {
+    return esPlugin;
+  }
+
+  GetRecordData();
+
+  std::lock_guard<std::mutex> lock(recordData_->mutex);
+  if (!recordData_->esPlugin) {
+    // The values read from the records are kept, so only the esplugin object
+    // needs to be recreated.
+    auto logger = getLogger();
+    if (logger) {
+      logger->debug("Parsing the released records of \"{}\" again.", name_);
+    }
+    if (!IsFileUnchanged() && logger) {
+      logger->warn(
+          "\"{}\" has changed since its records were released, its records "
+          "may not match the data read from them.",
+          name_);
+    }
+
+    recordData_->esPlugin = Load(path_, gameType_, false);
+  }
+
+  return recordData_->esPlugin;
+}
+
+void Plugin::Read(const std::shared_ptr<GameCache>& gameCache) {
+  // Only the header is parsed up front: the records are parsed when
+  // something that depends on them is first needed.
+  esPlugin = Load(path_, gameType_, true);
+
+  if (headerOnly_) {
+    auto ret = esp_plugin_is_empty(esPlugin.get(), &isEmpty_);
+    if (ret != ESP_OK) {
+      throw FileAccessError("Error checking if \"" + name_ + "\" is empty. esplugin error code: " + std::to_string(ret));
+    }
+  } else {
+    recordData_ = std::make_shared<RecordData>();
+
+    // Most plugins' CRCs are never used, so they're only calculated when
+    // first needed, but cached values are cheap to look up.
+    const auto& persistentCache = gameCache->GetPersistentCache();
+    recordData_->crc =
+        persistentCache.GetCrc(path_, fileSize_, modificationTime_);
+    recordData_->cachedIsValidAsLightMaster =
+        persistentCache.GetIsValidAsLightMaster(
+            path_, fileSize_, modificationTime_);
+  }
+
+  ReadHeaderData();
+  loadsArchive_ = LoadsArchive(gameType_, gameCache, path_);
+}
+
+void Plugin::ReadHeaderData() {
+  auto ret = esp_plugin_header_version(esPlugin.get(), &headerVersion_);
+  if (ret != ESP_OK) {
+    throw FileAccessError(name_ +
+                          " : esplugin error code: " + std::to_string(ret));
+  }
+
+  ret = esp_plugin_is_master(esPlugin.get(), &isMaster_);
+  if (ret != ESP_OK) {
+    throw FileAccessError(name_ +
+                          " : esplugin error code: " + std::to_string(ret));
+  }
+
+  ret = esp_plugin_is_light_master(esPlugin.get(), &isLightMaster_);
+  if (ret != ESP_OK) {
+    throw FileAccessError(name_ +
+                          " : esplugin error code: " + std::to_string(ret));
+  }
+
+  char** masters;
+  uint8_t numMasters;
+  ret = esp_plugin_masters(esPlugin.get(), &masters, &numMasters);
+  if (ret != ESP_OK) {
+    throw FileAccessError(name_ +
+                          " : esplugin error code: " + std::to_string(ret));
+  }
+
+  masters_.assign(masters, masters + numMasters);
+  esp_string_array_free(masters, numMasters);
+
+  auto description = GetDescription();
+  tags_ = ExtractBashTags(description);
+  version_ = ExtractVersion(description);
 }
 
 std::string Plugin::GetDescription() const {
@@ -268,10 +686,7 @@ std::string Plugin::GetDescription() const {
 }
 
 std::string GetArchiveFileExtension(const GameType gameType) {
-  if (gameType == GameType::fo4 || gameType == GameType::fo4vr)
-    return ".ba2";
-  else
-    return ".bsa";
+  return GetGamePolicy(gameType).archiveFileExtension;
 }
 
 std::filesystem::path replaceExtension(std::filesystem::path path, const std::string& newExtension) {
@@ -306,73 +721,34 @@ bool equivalent(const std::filesystem::path& path1, const std::filesystem::path&
 bool Plugin::LoadsArchive(const GameType gameType,
                           const std::shared_ptr<GameCache> gameCache,
                           const std::filesystem::path& pluginPath) {
-  if (gameType == GameType::tes3) {
-    return false;
-  }
-
-  const string archiveExtension = GetArchiveFileExtension(gameType);
-
-  if (gameType == GameType::tes5) {
-    // Skyrim plugins only load BSAs that exactly match their basename.
-    return std::filesystem::exists(replaceExtension(pluginPath, archiveExtension));
-  } else if (gameType != GameType::tes4 ||
-             boost::iends_with(pluginPath.filename().u8string(), ".esp")) {
-    // Oblivion .esp files and FO3, FNV, FO4 plugins can load archives which
-    // begin with the plugin basename.
-
-    auto basenameLength = pluginPath.stem().native().length();
-    auto pluginExtension = pluginPath.extension().native();
-
-    for (const auto& archivePath : gameCache->GetArchivePaths()) {
-      // Need to check if it starts with the given plugin's basename,
-      // but case insensitively. This is hard to do accurately, so
-      // instead check if the plugin with the same length basename and
-      // and the given plugin's file extension is equivalent.
-      auto bsaPluginFilename =
-          archivePath.filename().native().substr(0, basenameLength) +
-          pluginExtension;
-      auto bsaPluginPath =
-          pluginPath.parent_path() / bsaPluginFilename;
-      if (loot::equivalent(pluginPath, bsaPluginPath)) {
-        return true;
+  const auto& policy = GetGamePolicy(gameType);
+
+  switch (policy.archiveMatching) {
+    case ArchiveMatching::exactBasename:
+      return std::filesystem::exists(
+          replaceExtension(pluginPath, policy.archiveFileExtension));
+    case ArchiveMatching::espBasenamePrefix:
+      if (!EndsWithIgnoringAsciiCase(pluginPath.filename().u8string(),
+                                     ".esp")) {
+        return false;
       }
-    }
+      [[fallthrough]];
+    case ArchiveMatching::basenamePrefix:
+      // Need to check if it starts with the given plugin's basename, but case
+      // insensitively, so compare normalized filenames. The cache keeps them
+      // sorted, so this doesn't need to check every archive.
+      return gameCache->HasArchiveWithNormalizedPrefix(
+          NormalizeFilename(pluginPath.stem().u8string()));
+    default:
+      return false;
   }
-
-  return false;
 }
 
 unsigned int Plugin::GetEspluginGameId(GameType gameType) {
-  switch (gameType) {
-    case GameType::tes3:
-      return ESP_GAME_MORROWIND;
-    case GameType::tes4:
-      return ESP_GAME_OBLIVION;
-    case GameType::tes5:
-      return ESP_GAME_SKYRIM;
-    case GameType::tes5se:
-      return ESP_GAME_SKYRIMSE;
-    case GameType::fo3:
-      return ESP_GAME_FALLOUT3;
-    case GameType::fonv:
-      return ESP_GAME_FALLOUTNV;
-    default:
-      return ESP_GAME_FALLOUT4;
-  }
+  return GetGamePolicy(gameType).espluginGameId;
 }
 
-bool hasPluginFileExtension(std::string filename, GameType gameType) {
-  if (boost::iends_with(filename, ".ghost")) {
-    filename = filename.substr(0, filename.length() - 6);
-  }
-
-  bool espOrEsm = boost::iends_with(filename, ".esp") ||
-                  boost::iends_with(filename, ".esm");
-  bool lightMaster =
-      (gameType == GameType::fo4 || gameType == GameType::fo4vr ||
-       gameType == GameType::tes5se || gameType == GameType::tes5vr) &&
-      boost::iends_with(filename, ".esl");
-
-  return espOrEsm || lightMaster;
+bool hasPluginFileExtension(const std::string& filename, GameType gameType) {
+  return GetGamePolicy(gameType).HasPluginFileExtension(filename);
 }
 }
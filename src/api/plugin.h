@@ -26,6 +26,9 @@
 
 #include <cstdint>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <type_traits>
@@ -47,13 +50,39 @@ public:
          std::shared_ptr<GameCache> gameCache,
          std::filesystem::path pluginPath,
          const bool headerOnly);
+  // Loads the plugin from the given file, which may be ghosted, using the
+  // given size and modification time as the file's state before loading
+  // instead of reading them from the filesystem. The plugin's name is the
+  // filename without any .ghost extension.
+  Plugin(const GameType gameType,
+         std::shared_ptr<GameCache> gameCache,
+         const std::filesystem::path& filePath,
+         uintmax_t fileSize,
+         std::filesystem::file_time_type modificationTime,
+         const bool headerOnly);
+  // Copies a plugin that was loaded for another game cache, sharing its parsed
+  // data. Archive loading is checked again using the given cache's archives.
+  // If the header-only setting differs from the given plugin's, its parsed
+  // header is reused, and its records aren't shared.
+  Plugin(const Plugin& plugin,
+         std::shared_ptr<GameCache> gameCache,
+         const bool headerOnly);
 
   std::string GetName() const;
+  // The plugin's filename, as returned by NormalizeFilename().
+  const std::string& GetNormalizedName() const;
   float GetHeaderVersion() const;
   std::optional<std::string> GetVersion() const;
   std::vector<std::string> GetMasters() const;
+  // Like GetMasters(), but without copying them.
+  const std::vector<std::string>& GetMastersRef() const;
   std::set<Tag> GetBashTags() const;
+  // The CRC of a fully loaded plugin is calculated the first time that it is
+  // requested, unless it was available from the persistent cache. Throws if
+  // the CRC can't be calculated.
   std::optional<uint32_t> GetCRC() const;
+  // Like GetCRC(), but doesn't calculate the CRC if it isn't already known.
+  std::optional<uint32_t> GetCRCIfCalculated() const;
 
   bool IsMaster() const;
   bool IsLightMaster() const;
@@ -61,10 +90,56 @@ public:
   bool IsEmpty() const;
   bool LoadsArchive() const;
   bool DoFormIDsOverlap(const PluginInterface& plugin) const;
+  // Checks if this plugin's records could overlap with the given plugin's
+  // records, without comparing them. A plugin's FormIDs can only belong to
+  // itself or one of its masters, so plugins with none of those files in
+  // common can't overlap. Morrowind record IDs aren't namespaced by plugin,
+  // so any two Morrowind plugins that aren't header-only may overlap.
+  bool MayFormIDsOverlap(const Plugin& plugin) const;
+
+  bool IsHeaderOnly() const;
+  GameType GetGameType() const;
+
+  // The state of the file this plugin was loaded from, as it was before
+  // loading. The path may be ghosted.
+  const std::filesystem::path& GetFilePath() const;
+  uintmax_t GetLoadedFileSize() const;
+  std::filesystem::file_time_type GetLoadedModificationTime() const;
+
+  // If the plugin wasn't loaded header-only, its records are parsed the first
+  // time that data which depends on them is needed. This parses them now if
+  // they haven't been parsed already, and throws if they can't be parsed.
+  void LoadRecords() const;
+  // Hints to the operating system that LoadRecords() will be called soon, so
+  // that it can start reading the file in the background. Does nothing if the
+  // plugin is header-only or its records are already being parsed or have
+  // been parsed.
+  void PrefetchRecords() const;
+  // Frees the esplugin data for the plugin's records, keeping the values that
+  // were read from them. If the records are needed again to check for
+  // overlapping FormIDs, they're parsed again from the plugin's file. Does
+  // nothing if the plugin is header-only or its records haven't been parsed.
+  void ReleaseRecords() const;
+
+  // Checks if the file this plugin was loaded from still has the same size
+  // and modification time that it had when it was loaded.
+  bool IsFileUnchanged() const;
 
   // Load ordering functions.
   size_t NumOverrideFormIDs() const;
 
+  // Estimates of the memory used by the plugin, in bytes, as described for
+  // MemoryUsage. The estimate of the memory used by its records is zero if
+  // they haven't been parsed or have been released.
+  size_t GetMemoryUsage() const;
+  size_t GetRecordsMemoryUsage() const;
+
+  // Hints to the operating system that the header of the plugin at the given
+  // path, which must already have any .ghost extension resolved, will be read
+  // soon. Prefetching the headers of many plugins at once lets their reads be
+  // queued together, instead of each parse waiting for its own read.
+  static void PrefetchHeader(const std::filesystem::path& pluginPath);
+
   // Validity checks.
   static bool IsValid(const GameType gameType,
                       const std::filesystem::path& pluginPath);
@@ -73,9 +148,51 @@ public:
   bool operator<(const Plugin& rhs) const;
 
 private:
-  void Load(const std::filesystem::path& path,
-            GameType gameType,
-            bool headerOnly);
+  typedef std::shared_ptr<std::remove_pointer<::Plugin>::type> EspPluginPtr;
+
+  // Data that depends on the plugin's records. It's shared between copies of
+  // the plugin so that the records are only parsed once.
+  struct RecordData {
+    std::mutex mutex;
+    bool isParsed = false;
+    // Holds the error message if the records couldn't be parsed.
+    std::string error;
+
+    EspPluginPtr esPlugin;
+    bool isEmpty = true;
+    bool isValidAsLightMaster = false;
+    size_t numOverrideRecords = 0;
+    // Read from the persistent cache, so that light master validity can be
+    // given without parsing the records. Not changed once the data is shared.
+    std::optional<bool> cachedIsValidAsLightMaster;
+
+    // The CRC has its own lock so that calculating it doesn't wait for the
+    // records to be parsed, or vice versa.
+    std::mutex crcMutex;
+    std::optional<uint32_t> crc;
+  };
+
+  static EspPluginPtr Load(const std::filesystem::path& path,
+                           GameType gameType,
+                           bool headerOnly);
+  // Parses the plugin's records if necessary. Must not be called for a
+  // header-only plugin.
+  const RecordData& GetRecordData() const;
+  // Parses the plugin's records into recordData_, recording any error instead
+  // of throwing it. Must be called with recordData_'s mutex held, or before
+  // recordData_ is shared with any copies.
+  void ParseRecords() const;
+  // The esplugin object to use for operations that involve records. If the
+  // records were released, they're parsed again. The returned pointer keeps
+  // the object alive if the records are released again while it's in use.
+  EspPluginPtr GetRecordsPlugin() const;
+  // Parses the header of the file at path_ and reads the data that depends on
+  // it. Used by the constructors once path_, fileSize_ and modificationTime_
+  // are set.
+  void Read(const std::shared_ptr<GameCache>& gameCache);
+  // Reads the header fields that are exposed through accessors, so that
+  // they don't need to be read from esplugin on every call.
+  void ReadHeaderData();
   std::string GetDescription() const;
 
   static bool LoadsArchive(const GameType gameType,
@@ -84,22 +201,39 @@ private:
   static unsigned int GetEspluginGameId(GameType gameType);
 
   bool isEmpty_;  // Does the plugin contain any records other than the TES4
-                  // header?
+                  // header? Only used for header-only plugins.
+  bool isMaster_;
+  bool isLightMaster_;
   bool loadsArchive_;
+  float headerVersion_;
+  const GameType gameType_;
   const std::string name_;
+  const std::string normalizedName_;
+  const bool headerOnly_;
+  // Used to save lazily calculated CRCs. This isn't a shared pointer because
+  // the cache holds the plugin.
+  const std::weak_ptr<GameCache> gameCache_;
+
+  // The state of the file the plugin was loaded from, as it was before
+  // loading.
+  std::filesystem::path path_;
+  uintmax_t fileSize_;
+  std::filesystem::file_time_type modificationTime_;
+
+  std::vector<std::string> masters_;
   std::optional<std::string> version_;  // Obtained from description field.
-  std::optional<uint32_t> crc_;
   std::set<Tag> tags_;
 
-  // Useful caches.
-  size_t numOverrideRecords_;
+  // Null for header-only plugins.
+  std::shared_ptr<RecordData> recordData_;
 
-  std::shared_ptr<std::remove_pointer<::Plugin>::type> esPlugin;
+  // Only the plugin's header is parsed into this object.
+  EspPluginPtr esPlugin;
 };
 
 std::string GetArchiveFileExtension(const GameType gameType);
 
-bool hasPluginFileExtension(std::string filename, GameType gameType);
+bool hasPluginFileExtension(const std::string& filename, GameType gameType);
 
 bool equivalent(const std::filesystem::path& path1, const std::filesystem::path& path2);
 
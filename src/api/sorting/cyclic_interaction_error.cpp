@@ -43,9 +43,36 @@ std::string describeCycle(const std::vector<Vertex>& cycle) {
   return text;
 }
 
+std::string describeCycles(const std::vector<std::vector<Vertex>>& cycles) {
+  if (cycles.size() == 1) {
+    return "Cyclic interaction detected: " + describeCycle(cycles[0]);
+  }
+
+  std::string text =
+      std::to_string(cycles.size()) + " cyclic interactions detected: ";
+  for (size_t i = 0; i < cycles.size(); ++i) {
+    if (i != 0) {
+      text += "; ";
+    }
+    text += describeCycle(cycles[i]);
+  }
+
+  return text;
+}
+
 CyclicInteractionError::CyclicInteractionError(std::vector<Vertex> cycle) :
-    std::runtime_error("Cyclic interaction detected: " + describeCycle(cycle)),
-    cycle_(cycle) {}
+    CyclicInteractionError(std::vector<std::vector<Vertex>>({cycle})) {}
+
+CyclicInteractionError::CyclicInteractionError(
+    std::vector<std::vector<Vertex>> cycles) :
+    std::runtime_error(describeCycles(cycles)),
+    cycles_(cycles) {}
 
-std::vector<Vertex> CyclicInteractionError::GetCycle() { return cycle_; }
+std::vector<Vertex> CyclicInteractionError::GetCycle() {
+  return cycles_.empty() ? std::vector<Vertex>() : cycles_[0];
+}
+
+std::vector<std::vector<Vertex>> CyclicInteractionError::GetCycles() {
+  return cycles_;
+}
 }
@@ -24,10 +24,13 @@
 
 #include "group_sort.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/bellman_ford_shortest_paths.hpp>
 #include <boost/graph/depth_first_search.hpp>
 #include <boost/graph/graph_traits.hpp>
+#include <boost/graph/topological_sort.hpp>
 
 #include "api/helpers/logging.h"
 #include "loot/exception/cyclic_interaction_error.h"
@@ -37,24 +40,24 @@ namespace loot {
 class GroupSortingData {
 public:
   GroupSortingData() {}
-  GroupSortingData(std::string name) : name_(name) {}
+  GroupSortingData(std::string name) : name_(std::move(name)) {}
 
-  std::string GetName() const { return name_; }
+  const std::string& GetName() const { return name_; }
 
-  std::unordered_set<std::string> GetMasterlistAfterGroups() const {
+  const std::unordered_set<std::string>& GetMasterlistAfterGroups() const {
     return masterlistAfterGroups_;
   }
 
-  std::unordered_set<std::string> GetUserAfterGroups() const {
+  const std::unordered_set<std::string>& GetUserAfterGroups() const {
     return userAfterGroups_;
   }
 
   void SetMasterlistAfterGroups(std::unordered_set<std::string> groups) {
-    masterlistAfterGroups_ = groups;
+    masterlistAfterGroups_ = std::move(groups);
   }
 
   void SetUserAfterGroups(std::unordered_set<std::string> groups) {
-    userAfterGroups_ = groups;
+    userAfterGroups_ = std::move(groups);
   }
 
 private:
@@ -71,24 +74,6 @@ typedef boost::adjacency_list<boost::vecS,
     GroupGraph;
 typedef boost::graph_traits<GroupGraph>::vertex_descriptor vertex_t;
 typedef boost::graph_traits<GroupGraph>::edge_descriptor edge_t;
-typedef boost::associative_property_map<std::map<edge_t, int>> edge_map_t;
-
-class AfterGroupsVisitor : public boost::dfs_visitor<> {
-public:
-  AfterGroupsVisitor(std::unordered_set<std::string>& visitedGroups) :
-      visitedGroups_(visitedGroups) {}
-  void tree_edge(edge_t edge, const GroupGraph& graph) {
-    auto target = boost::target(edge, graph);
-    visitedGroups_.insert(graph[target].GetName());
-  }
-
-  std::unordered_set<std::string> get_visited_groups() const {
-    return visitedGroups_;
-  }
-
-private:
-  std::unordered_set<std::string>& visitedGroups_;
-};
 
 std::string join(const std::unordered_set<std::string>& set) {
   std::string output;
@@ -99,16 +84,22 @@ std::string join(const std::unordered_set<std::string>& set) {
   return output.substr(0, output.length() - 2);
 }
 
-GroupGraph BuildGraph(const std::unordered_set<Group>& masterlistGroups,
-                      const std::unordered_set<Group>& userGroups) {
+// Builds the group graph, and fills the given map with each group's vertex,
+// keyed by group name. As the graph stores its vertices in a vector, they are
+// also indices.
+GroupGraph BuildGraph(
+    const std::unordered_set<Group>& masterlistGroups,
+    const std::unordered_set<Group>& userGroups,
+    std::unordered_map<std::string, vertex_t>& groupVertices) {
   GroupGraph graph;
 
-  std::unordered_map<std::string, vertex_t> groupVertices;
+  groupVertices.clear();
+  groupVertices.reserve(masterlistGroups.size() + userGroups.size());
   for (const auto& group : masterlistGroups) {
     auto groupSortingData = GroupSortingData(group.GetName());
     groupSortingData.SetMasterlistAfterGroups(group.GetAfterGroups());
 
-    auto vertex = boost::add_vertex(groupSortingData, graph);
+    auto vertex = boost::add_vertex(std::move(groupSortingData), graph);
     groupVertices.emplace(group.GetName(), vertex);
   }
   for (const auto& group : userGroups) {
@@ -119,15 +110,28 @@ GroupGraph BuildGraph(const std::unordered_set<Group>& masterlistGroups,
       auto groupSortingData = GroupSortingData(group.GetName());
       groupSortingData.SetUserAfterGroups(group.GetAfterGroups());
 
-      auto vertex = boost::add_vertex(groupSortingData, graph);
+      auto vertex = boost::add_vertex(std::move(groupSortingData), graph);
       groupVertices.emplace(group.GetName(), vertex);
     }
   }
 
   auto logger = getLogger();
+  auto addEdges = [&](const vertex_t& vertex,
+                      const std::unordered_set<std::string>& afterGroups,
+                      EdgeType edgeType) {
+    for (const auto& otherGroupName : afterGroups) {
+      auto otherVertex = groupVertices.find(otherGroupName);
+      if (otherVertex == groupVertices.end()) {
+        throw UndefinedGroupError(otherGroupName);
+      }
+
+      boost::add_edge(vertex, otherVertex->second, edgeType, graph);
+    }
+  };
+
   for (const vertex_t& vertex :
        boost::make_iterator_range(boost::vertices(graph))) {
-    auto group = graph[vertex];
+    const auto& group = graph[vertex];
 
     if (logger) {
       logger->trace(
@@ -138,36 +142,31 @@ GroupGraph BuildGraph(const std::unordered_set<Group>& masterlistGroups,
           join(group.GetUserAfterGroups()));
     }
 
-    for (const auto& otherGroupName : group.GetMasterlistAfterGroups()) {
-      auto otherVertex = groupVertices.find(otherGroupName);
-      if (otherVertex == groupVertices.end()) {
-        throw UndefinedGroupError(otherGroupName);
-      }
-
-      auto vertex = groupVertices[group.GetName()];
-      boost::add_edge(
-          vertex, otherVertex->second, EdgeType::masterlistLoadAfter, graph);
-    }
-
-    for (const auto& otherGroupName : group.GetUserAfterGroups()) {
-      auto otherVertex = groupVertices.find(otherGroupName);
-      if (otherVertex == groupVertices.end()) {
-        throw UndefinedGroupError(otherGroupName);
-      }
-
-      auto vertex = groupVertices[group.GetName()];
-      boost::add_edge(
-          vertex, otherVertex->second, EdgeType::userLoadAfter, graph);
-    }
+    addEdges(vertex,
+             group.GetMasterlistAfterGroups(),
+             EdgeType::masterlistLoadAfter);
+    addEdges(vertex, group.GetUserAfterGroups(), EdgeType::userLoadAfter);
   }
 
   return graph;
 }
 
 std::unordered_map<std::string, std::unordered_set<std::string>>
-GetTransitiveAfterGroups(const std::unordered_set<Group>& masterlistGroups,
-                         const std::unordered_set<Group>& userGroups) {
-  GroupGraph graph = BuildGraph(masterlistGroups, userGroups);
+GetAfterGroupsByName(const std::unordered_set<Group>& groups) {
+  std::unordered_map<std::string, std::unordered_set<std::string>> afterGroups;
+  for (const auto& group : groups) {
+    afterGroups.emplace(group.GetName(), group.GetAfterGroups());
+  }
+
+  return afterGroups;
+}
+
+GroupClosure::GroupClosure(const std::unordered_set<Group>& masterlistGroups,
+                           const std::unordered_set<Group>& userGroups) :
+    masterlistAfterGroups_(GetAfterGroupsByName(masterlistGroups)),
+    userAfterGroups_(GetAfterGroupsByName(userGroups)) {
+  std::unordered_map<std::string, vertex_t> groupVertices;
+  GroupGraph graph = BuildGraph(masterlistGroups, userGroups, groupVertices);
 
   auto logger = getLogger();
   if (logger) {
@@ -178,111 +177,285 @@ GetTransitiveAfterGroups(const std::unordered_set<Group>& masterlistGroups,
   if (logger) {
     logger->trace("Checking for cycles in the group graph");
   }
-  boost::depth_first_search(graph, boost::visitor(CycleDetector<GroupGraph>()));
-
-  std::unordered_map<std::string, std::unordered_set<std::string>>
-      transitiveAfterGroups;
+  CheckForAllCycles<GroupGraph>(
+      graph, [](const edge_t& edge, const GroupGraph& graph) {
+        return graph[edge];
+      });
+
+  // The graph stores its vertices in a vector, so they are also indices.
+  const auto numVertices = boost::num_vertices(graph);
+  afterGroups_.assign(numVertices, boost::dynamic_bitset<>(numVertices));
+  beforeGroups_.assign(numVertices, boost::dynamic_bitset<>(numVertices));
+  names_.reserve(numVertices);
   for (const vertex_t& vertex :
        boost::make_iterator_range(boost::vertices(graph))) {
-    std::unordered_set<std::string> visitedGroups;
-    AfterGroupsVisitor afterGroupsVisitor(visitedGroups);
-
-    // Create a color map.
-    std::vector<boost::default_color_type> colorVec(boost::num_vertices(graph));
-    auto colorMap = boost::make_iterator_property_map(
-        colorVec.begin(), boost::get(boost::vertex_index, graph), colorVec[0]);
+    names_.push_back(graph[vertex].GetName());
+  }
+  indices_ = std::move(groupVertices);
+
+  // Edges go from groups to their after groups, so the sort outputs each
+  // group after all the groups that it loads after, and their closures are
+  // complete by the time that its closure is calculated.
+  std::vector<vertex_t> sortedVertices;
+  sortedVertices.reserve(numVertices);
+  boost::topological_sort(graph, std::back_inserter(sortedVertices));
+
+  for (const auto& vertex : sortedVertices) {
+    for (const auto& edge :
+         boost::make_iterator_range(boost::out_edges(vertex, graph))) {
+      auto target = boost::target(edge, graph);
+      afterGroups_[vertex].set(target);
+      afterGroups_[vertex] |= afterGroups_[target];
+    }
 
-    boost::depth_first_visit(graph, vertex, afterGroupsVisitor, colorMap);
-    transitiveAfterGroups[graph[vertex].GetName()] = visitedGroups;
+    const auto& afterGroups = afterGroups_[vertex];
+    for (auto i = afterGroups.find_first(); i != afterGroups.npos;
+         i = afterGroups.find_next(i)) {
+      beforeGroups_[i].set(vertex);
+    }
 
-    if (logger) {
+    if (shouldLog(logger, spdlog::level::trace)) {
       logger->trace("Group \"{}\" transitively loads after groups \"{}\"",
-                    graph[vertex].GetName(),
-                    join(visitedGroups));
+                    names_[vertex],
+                    join(GetNames(afterGroups)));
     }
   }
+}
+
+bool GroupClosure::IsBuiltFrom(
+    const std::unordered_set<Group>& masterlistGroups,
+    const std::unordered_set<Group>& userGroups) const {
+  return GetAfterGroupsByName(masterlistGroups) == masterlistAfterGroups_ &&
+         GetAfterGroupsByName(userGroups) == userAfterGroups_;
+}
+
+std::unordered_map<std::string, std::unordered_set<std::string>>
+GroupClosure::GetTransitiveAfterGroups() const {
+  std::unordered_map<std::string, std::unordered_set<std::string>>
+      transitiveAfterGroups;
+  for (size_t i = 0; i < names_.size(); ++i) {
+    transitiveAfterGroups.emplace(names_[i], GetNames(afterGroups_[i]));
+  }
 
   return transitiveAfterGroups;
 }
 
-vertex_t GetVertexByName(const GroupGraph& graph, const std::string& name) {
-  for (const auto& vertex :
-       boost::make_iterator_range(boost::vertices(graph))) {
-    if (graph[vertex].GetName() == name) {
-      return vertex;
-    }
+std::unordered_set<std::string> GroupClosure::GetGroupsInPaths(
+    const std::string& firstGroupName,
+    const std::string& lastGroupName) const {
+  auto firstIndex = GetIndex(firstGroupName);
+  auto lastIndex = GetIndex(lastGroupName);
+  if (!firstIndex.has_value() || !lastIndex.has_value()) {
+    return std::unordered_set<std::string>();
   }
 
-  auto logger = getLogger();
-  if (logger) {
-    logger->error("Can't find group with name \"{}\"", name);
+  // A group is in a path if the last group loads after it and it loads after
+  // the first group.
+  return GetNames(afterGroups_[lastIndex.value()] &
+                  beforeGroups_[firstIndex.value()]);
+}
+
+std::optional<size_t> GroupClosure::GetIndex(
+    const std::string& groupName) const {
+  auto it = indices_.find(groupName);
+  if (it == indices_.end()) {
+    return std::nullopt;
   }
 
-  throw std::invalid_argument("Can't find group with name \"" + name + "\"");
+  return it->second;
 }
 
+size_t GroupClosure::NumGroups() const { return names_.size(); }
 
-std::vector<Vertex> GetGroupsPath(
-    const std::unordered_set<Group>& masterlistGroups,
-    const std::unordered_set<Group>& userGroups,
-    const std::string& fromGroupName,
-    const std::string& toGroupName) {
-  GroupGraph graph = BuildGraph(masterlistGroups, userGroups);
+const boost::dynamic_bitset<>& GroupClosure::GetAfterGroups(
+    size_t groupIndex) const {
+  return afterGroups_.at(groupIndex);
+}
 
-  auto logger = getLogger();
+std::unordered_set<std::string> GroupClosure::GetNames(
+    const boost::dynamic_bitset<>& groups) const {
+  std::unordered_set<std::string> names;
+  for (auto i = groups.find_first(); i != groups.npos;
+       i = groups.find_next(i)) {
+    names.insert(names_[i]);
+  }
 
-  auto fromVertex = GetVertexByName(graph, fromGroupName);
-  auto toVertex = GetVertexByName(graph, toGroupName);
+  return names;
+}
 
-  std::map<edge_t, int> weightMap;
-  for (const auto& edge : boost::make_iterator_range(boost::edges(graph))) {
-    if (graph[edge] == EdgeType::userLoadAfter) {
-      weightMap[edge] = -1000000;  // Magnitude is an arbitrarily large number.
-    } else {
-      weightMap[edge] = 1;
+std::unordered_map<std::string, std::unordered_set<std::string>>
+GetTransitiveAfterGroups(const std::unordered_set<Group>& masterlistGroups,
+                         const std::unordered_set<Group>& userGroups) {
+  return GroupClosure(masterlistGroups, userGroups).GetTransitiveAfterGroups();
+}
+
+GroupPaths::GroupPaths(const std::unordered_set<Group>& masterlistGroups,
+                       const std::unordered_set<Group>& userGroups) {
+  std::unordered_map<std::string, vertex_t> groupVertices;
+  GroupGraph graph = BuildGraph(masterlistGroups, userGroups, groupVertices);
+
+  const auto numVertices = boost::num_vertices(graph);
+  names_.reserve(numVertices);
+  edges_.resize(numVertices);
+  for (const vertex_t& vertex :
+       boost::make_iterator_range(boost::vertices(graph))) {
+    names_.push_back(graph[vertex].GetName());
+
+    for (const auto& edge :
+         boost::make_iterator_range(boost::out_edges(vertex, graph))) {
+      edges_[vertex].push_back(Edge{boost::target(edge, graph), graph[edge]});
     }
   }
+  indices_ = std::move(groupVertices);
+
+  // Paths can be found in a single pass over the groups in topological order
+  // if the graph is acyclic. Otherwise they're found using Bellman-Ford.
+  try {
+    boost::depth_first_search(graph,
+                              boost::visitor(CycleDetector<GroupGraph>()));
+
+    boost::topological_sort(graph, std::back_inserter(topologicalOrder_));
+    // The sort outputs each group after the groups it loads after, but paths
+    // are followed from groups to the groups that they load after.
+    std::reverse(topologicalOrder_.begin(), topologicalOrder_.end());
+  } catch (const CyclicInteractionError&) {
+    auto logger = getLogger();
+    if (logger) {
+      logger->debug("The group graph contains a cycle.");
+    }
+    topologicalOrder_.clear();
+  }
+}
 
-  std::vector<vertex_t> predecessors(boost::num_vertices(graph));
-  std::vector<int> distance(predecessors.size(),
-                            (std::numeric_limits<int>::max)());
-  distance[toVertex] = 0;
-
-  bellman_ford_shortest_paths(
-      graph,
-      boost::weight_map(edge_map_t(weightMap))
-          .predecessor_map(boost::make_iterator_property_map(
-              predecessors.begin(), get(boost::vertex_index, graph)))
-          .distance_map(&distance[0])
-          .root_vertex(toVertex));
+std::vector<Vertex> GroupPaths::GetPath(const std::string& fromGroupName,
+                                        const std::string& toGroupName) const {
+  const auto fromIndex = GetIndex(fromGroupName);
+  const auto toIndex = GetIndex(toGroupName);
+
+  // Paths are found from the last group, following the edges from groups to
+  // the groups that they load after, so the path is walked backwards from the
+  // first group.
+  std::unique_lock<std::mutex> lock(shortestPathsMutex_);
+  auto it = shortestPaths_.find(toIndex);
+  if (it == shortestPaths_.end()) {
+    it = shortestPaths_.emplace(toIndex, FindShortestPaths(toIndex)).first;
+  }
+  const auto& shortestPaths = it->second;
+  lock.unlock();
 
   std::vector<Vertex> path;
-  vertex_t currentVertex = fromVertex;
-  while (currentVertex != toVertex) {
-    auto nextVertex = predecessors[currentVertex];
-    if (nextVertex == currentVertex) {
+  auto currentIndex = fromIndex;
+  while (currentIndex != toIndex) {
+    auto nextIndex = shortestPaths.predecessors[currentIndex];
+    // A cycle of user edges can leave the predecessors in a loop, so also
+    // stop if the path has become longer than any path could be.
+    if (nextIndex == currentIndex || path.size() == names_.size()) {
+      auto logger = getLogger();
       if (logger) {
         logger->error(
             "Unreachable vertex {} encountered while looking for vertex {}",
-            graph[currentVertex].GetName(),
-            graph[toVertex].GetName());
+            names_[currentIndex],
+            names_[toIndex]);
       }
       return std::vector<Vertex>();
     }
 
-    auto pair = boost::edge(nextVertex, currentVertex, graph);
-    if (!pair.second) {
-      throw std::runtime_error("Unexpectedly couldn't find edge between \"" +
-                               graph[currentVertex].GetName() + "\" and \"" +
-                               graph[nextVertex].GetName() + "\"");
-    }
-    auto vertex = Vertex(graph[currentVertex].GetName(), graph[pair.first]);
-    path.push_back(vertex);
+    path.push_back(
+        Vertex(names_[currentIndex], shortestPaths.edgeTypes[currentIndex]));
 
-    currentVertex = nextVertex;
+    currentIndex = nextIndex;
   }
-  path.push_back(Vertex(graph[currentVertex].GetName()));
+  path.push_back(Vertex(names_[currentIndex]));
 
   return path;
 }
+
+size_t GroupPaths::GetIndex(const std::string& groupName) const {
+  auto it = indices_.find(groupName);
+  if (it != indices_.end()) {
+    return it->second;
+  }
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->error("Can't find group with name \"{}\"", groupName);
+  }
+
+  throw std::invalid_argument("Can't find group with name \"" + groupName +
+                              "\"");
+}
+
+GroupPaths::ShortestPaths GroupPaths::FindShortestPaths(
+    size_t rootIndex) const {
+  // User edges are given a large negative weight so that paths containing
+  // them are preferred. The magnitude is an arbitrarily large number.
+  static constexpr int USER_EDGE_WEIGHT = -1000000;
+  static constexpr int MASTERLIST_EDGE_WEIGHT = 1;
+
+  const auto numVertices = names_.size();
+  ShortestPaths paths;
+  paths.predecessors.resize(numVertices);
+  paths.edgeTypes.resize(numVertices, EdgeType::masterlistLoadAfter);
+  for (size_t i = 0; i < numVertices; ++i) {
+    paths.predecessors[i] = i;
+  }
+
+  std::vector<int> distances(numVertices, (std::numeric_limits<int>::max)());
+  distances[rootIndex] = 0;
+
+  // Returns true if the edge shortened the path to its target.
+  auto relax = [&](size_t source, const Edge& edge) {
+    if (distances[source] == (std::numeric_limits<int>::max)()) {
+      return false;
+    }
+
+    auto weight = edge.type == EdgeType::userLoadAfter
+                      ? USER_EDGE_WEIGHT
+                      : MASTERLIST_EDGE_WEIGHT;
+    if (distances[source] + weight >= distances[edge.target]) {
+      return false;
+    }
+
+    distances[edge.target] = distances[source] + weight;
+    paths.predecessors[edge.target] = source;
+    paths.edgeTypes[edge.target] = edge.type;
+    return true;
+  };
+
+  if (!topologicalOrder_.empty()) {
+    // Groups that come before the root in topological order can't be reached
+    // from it, so relaxing their edges is skipped.
+    auto it = std::find(
+        topologicalOrder_.begin(), topologicalOrder_.end(), rootIndex);
+    for (; it != topologicalOrder_.end(); ++it) {
+      for (const auto& edge : edges_[*it]) {
+        relax(*it, edge);
+      }
+    }
+  } else {
+    for (size_t pass = 1; pass < numVertices; ++pass) {
+      bool relaxed = false;
+      for (size_t source = 0; source < numVertices; ++source) {
+        for (const auto& edge : edges_[source]) {
+          relaxed = relax(source, edge) || relaxed;
+        }
+      }
+
+      if (!relaxed) {
+        break;
+      }
+    }
+  }
+
+  return paths;
+}
+
+std::vector<Vertex> GetGroupsPath(
+    const std::unordered_set<Group>& masterlistGroups,
+    const std::unordered_set<Group>& userGroups,
+    const std::string& fromGroupName,
+    const std::string& toGroupName) {
+  return GroupPaths(masterlistGroups, userGroups)
+      .GetPath(fromGroupName, toGroupName);
+}
 }
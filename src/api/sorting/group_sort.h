@@ -25,41 +25,153 @@
 #ifndef LOOT_API_SORTING_GROUP_SORT
 #define LOOT_API_SORTING_GROUP_SORT
 
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <boost/dynamic_bitset.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/depth_first_search.hpp>
+#include <boost/graph/strong_components.hpp>
 
 #include "loot/exception/cyclic_interaction_error.h"
 #include "loot/metadata/group.h"
+#include "loot/vertex.h"
 
 namespace loot {
+// The transitive closure of the group graph. Each group is given an index, and
+// the groups that each group transitively loads after and before are stored
+// as bitsets over those indices, so that finding the groups that lie between
+// two others doesn't involve searching the graph.
+class GroupClosure {
+public:
+  // Throws if an after group is undefined or if the groups are cyclic.
+  GroupClosure(const std::unordered_set<Group>& masterlistGroups,
+               const std::unordered_set<Group>& userGroups);
+
+  // Checks if the closure was built from the given groups. Unlike comparing
+  // the sets of groups, this also compares each group's after groups.
+  bool IsBuiltFrom(const std::unordered_set<Group>& masterlistGroups,
+                   const std::unordered_set<Group>& userGroups) const;
+
+  // Map entries are a group name and names of transitive load after groups.
+  std::unordered_map<std::string, std::unordered_set<std::string>>
+  GetTransitiveAfterGroups() const;
+
+  // Get the groups that are in paths from the last group to the first group,
+  // not including the first and last groups themselves. If either group is
+  // undefined or there is no path between them, the result is empty.
+  std::unordered_set<std::string> GetGroupsInPaths(
+      const std::string& firstGroupName,
+      const std::string& lastGroupName) const;
+
+  // Groups are indexed from zero up to the number of groups. Returns no value
+  // if the group is undefined.
+  std::optional<size_t> GetIndex(const std::string& groupName) const;
+  size_t NumGroups() const;
+  // The indices of the groups that the given group transitively loads after.
+  const boost::dynamic_bitset<>& GetAfterGroups(size_t groupIndex) const;
+
+private:
+  std::unordered_set<std::string> GetNames(
+      const boost::dynamic_bitset<>& groups) const;
+
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, size_t> indices_;
+  std::vector<boost::dynamic_bitset<>> afterGroups_;
+  std::vector<boost::dynamic_bitset<>> beforeGroups_;
+
+  // The after groups that each group was defined with, keyed by group name.
+  std::unordered_map<std::string, std::unordered_set<std::string>>
+      masterlistAfterGroups_;
+  std::unordered_map<std::string, std::unordered_set<std::string>>
+      userAfterGroups_;
+};
+
 // Map entries are a group name and names of transitive load after groups.
 std::unordered_map<std::string, std::unordered_set<std::string>>
 GetTransitiveAfterGroups(const std::unordered_set<Group>& masterlistGroups,
                          const std::unordered_set<Group>& userGroups);
 
+// The group graph, stored so that paths between groups can be found without
+// rebuilding it. The paths that end at each group are found the first time
+// they're needed and then kept, so a query only has to walk a path. Paths
+// prefer user load after edges over masterlist load after edges, and then
+// prefer fewer edges.
+class GroupPaths {
+public:
+  // Throws if an after group is undefined.
+  GroupPaths(const std::unordered_set<Group>& masterlistGroups,
+             const std::unordered_set<Group>& userGroups);
+
+  // Get the path from the first group to the last group, or an empty vector
+  // if there is no path. Throws if either group is undefined.
+  std::vector<Vertex> GetPath(const std::string& fromGroupName,
+                              const std::string& toGroupName) const;
+
+private:
+  struct Edge {
+    size_t target;
+    EdgeType type;
+  };
+
+  // The shortest paths from a group, stored as the previous group and edge
+  // type on the path to each other group. Unreachable groups are their own
+  // predecessors.
+  struct ShortestPaths {
+    std::vector<size_t> predecessors;
+    std::vector<EdgeType> edgeTypes;
+  };
+
+  size_t GetIndex(const std::string& groupName) const;
+  ShortestPaths FindShortestPaths(size_t rootIndex) const;
+
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, size_t> indices_;
+  std::vector<std::vector<Edge>> edges_;
+  // Empty if the graph contains a cycle.
+  std::vector<size_t> topologicalOrder_;
+
+  mutable std::mutex shortestPathsMutex_;
+  mutable std::unordered_map<size_t, ShortestPaths> shortestPaths_;
+};
+
 std::vector<Vertex> GetGroupsPath(
     const std::unordered_set<Group>& masterlistGroups,
     const std::unordered_set<Group>& userGroups,
     const std::string& fromGroupName,
     const std::string& toGroupName);
 
+// Throws a CyclicInteractionError if the graph contains a cycle. The trail of
+// edges leading to the current vertex is recorded as descriptors, and their
+// types are only looked up once a cycle is found.
 template<typename G>
 class CycleDetector : public boost::dfs_visitor<> {
 public:
-  void tree_edge(typename boost::graph_traits<G>::edge_descriptor edge,
-                 const G& graph) {
-    auto source = boost::source(edge, graph);
+  typedef typename boost::graph_traits<G>::edge_descriptor Edge;
+  typedef std::function<EdgeType(const Edge&, const G&)> EdgeTypeGetter;
+
+  CycleDetector() :
+      getEdgeType_([](const Edge& edge, const G& graph) {
+        return graph[edge];
+      }) {}
 
-    auto vertex = Vertex(graph[source].GetName(), graph[edge]);
+  // For graphs that don't store edge types as edge properties.
+  explicit CycleDetector(EdgeTypeGetter getEdgeType) :
+      getEdgeType_(getEdgeType) {}
+
+  void tree_edge(Edge edge, const G& graph) {
+    auto source = boost::source(edge, graph);
 
     // Check if the vertex already exists in the recorded trail.
-    auto it = find_if(begin(trail), end(trail), [&](const Vertex& v) {
-      return v.GetName() == graph[source].GetName();
+    auto it = find_if(begin(trail), end(trail), [&](const Edge& e) {
+      return boost::source(e, graph) == source;
     });
 
     if (it != end(trail)) {
@@ -68,28 +180,138 @@ public:
       trail.erase(it, end(trail));
     }
 
-    trail.push_back(vertex);
+    trail.push_back(edge);
   }
 
-  void back_edge(typename boost::graph_traits<G>::edge_descriptor edge,
-                 const G& graph) {
-    auto source = boost::source(edge, graph);
+  void back_edge(Edge edge, const G& graph) {
     auto target = boost::target(edge, graph);
 
-    auto vertex = Vertex(graph[source].GetName(), graph[edge]);
-    trail.push_back(vertex);
+    trail.push_back(edge);
 
-    auto it = find_if(begin(trail), end(trail), [&](const Vertex& v) {
-      return v.GetName() == graph[target].GetName();
+    auto it = find_if(begin(trail), end(trail), [&](const Edge& e) {
+      return boost::source(e, graph) == target;
     });
 
     if (it != trail.end()) {
-      throw CyclicInteractionError(std::vector<Vertex>(it, trail.end()));
+      std::vector<Vertex> cycle;
+      for (; it != trail.end(); ++it) {
+        cycle.push_back(Vertex(graph[boost::source(*it, graph)].GetName(),
+                               getEdgeType_(*it, graph)));
+      }
+      throw CyclicInteractionError(cycle);
     }
   }
 
 private:
-  std::vector<Vertex> trail;
+  EdgeTypeGetter getEdgeType_;
+  std::vector<Edge> trail;
 };
+
+// Finds the graph's strongly connected components that contain cycles, and
+// gets the shortest cycle through the first vertex of each component, apart
+// from the component that contains the given vertex, which already has a
+// cycle. The cycles are returned in the order of their first vertices.
+template<typename G>
+std::vector<std::vector<Vertex>> FindOtherCycles(
+    const G& graph,
+    const typename boost::graph_traits<G>::vertex_descriptor& cyclicVertex,
+    const typename CycleDetector<G>::EdgeTypeGetter& getEdgeType) {
+  typedef typename boost::graph_traits<G>::vertex_descriptor VertexDescriptor;
+  typedef typename boost::graph_traits<G>::edge_descriptor Edge;
+
+  // The graph stores its vertices in a vector, so they are also indices.
+  const auto numVertices = boost::num_vertices(graph);
+  std::vector<size_t> components(numVertices);
+  boost::strong_components(
+      graph,
+      boost::make_iterator_property_map(components.begin(),
+                                        boost::get(boost::vertex_index, graph)));
+
+  std::vector<bool> isComponentVisited(numVertices, false);
+  isComponentVisited[components[cyclicVertex]] = true;
+
+  std::vector<std::vector<Vertex>> cycles;
+  std::vector<std::optional<Edge>> predecessors(numVertices);
+  for (VertexDescriptor root = 0; root < numVertices; ++root) {
+    const auto component = components[root];
+    if (isComponentVisited[component]) {
+      continue;
+    }
+    isComponentVisited[component] = true;
+
+    // Search breadth-first within the component until an edge leads back to
+    // the root. A component with only one vertex may not have one.
+    std::fill(predecessors.begin(), predecessors.end(), std::nullopt);
+    std::queue<VertexDescriptor> queue;
+    queue.push(root);
+    std::optional<Edge> closingEdge;
+    while (!queue.empty() && !closingEdge.has_value()) {
+      auto vertex = queue.front();
+      queue.pop();
+
+      for (const auto& edge :
+           boost::make_iterator_range(boost::out_edges(vertex, graph))) {
+        auto target = boost::target(edge, graph);
+        if (target == root) {
+          closingEdge = edge;
+          break;
+        }
+
+        if (components[target] == component && !predecessors[target]) {
+          predecessors[target] = edge;
+          queue.push(target);
+        }
+      }
+    }
+
+    if (!closingEdge.has_value()) {
+      continue;
+    }
+
+    std::vector<Vertex> cycle;
+    for (auto edge = closingEdge;;) {
+      auto source = boost::source(edge.value(), graph);
+      cycle.push_back(
+          Vertex(graph[source].GetName(), getEdgeType(edge.value(), graph)));
+      if (source == root) {
+        break;
+      }
+      edge = predecessors[source];
+    }
+    std::reverse(cycle.begin(), cycle.end());
+
+    cycles.push_back(std::move(cycle));
+  }
+
+  return cycles;
+}
+
+// Throws a CyclicInteractionError if the graph contains a cycle. The first
+// cycle is the one that a depth-first search finds, and the error also holds
+// a cycle for each other independent set of cyclic vertices.
+template<typename G>
+void CheckForAllCycles(
+    const G& graph,
+    const typename CycleDetector<G>::EdgeTypeGetter& getEdgeType) {
+  try {
+    boost::depth_first_search(
+        graph, boost::visitor(CycleDetector<G>(getEdgeType)));
+  } catch (CyclicInteractionError& e) {
+    auto firstCycle = e.GetCycle();
+    std::vector<std::vector<Vertex>> cycles({firstCycle});
+
+    // Finding the other cycles only needs one of the first cycle's vertices.
+    for (const auto& vertex :
+         boost::make_iterator_range(boost::vertices(graph))) {
+      if (graph[vertex].GetName() == firstCycle[0].GetName()) {
+        auto otherCycles = FindOtherCycles(graph, vertex, getEdgeType);
+        cycles.insert(cycles.end(), otherCycles.begin(), otherCycles.end());
+        break;
+      }
+    }
+
+    throw CyclicInteractionError(cycles);
+  }
+}
 }
 #endif
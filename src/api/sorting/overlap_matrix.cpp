@@ -0,0 +1,113 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/sorting/overlap_matrix.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "api/helpers/thread_pool.h"
+
+namespace loot {
+namespace {
+// More tiles than workers lets workers that finish early pick up the
+// remaining tiles, as rows towards the end of the matrix have fewer pairs.
+constexpr size_t TILES_PER_WORKER = 4;
+}
+
+OverlapMatrix::OverlapMatrix() : size_(0), wordsPerRow_(0) {}
+
+OverlapMatrix::OverlapMatrix(size_t size) :
+    size_(size),
+    wordsPerRow_((size + BITS_PER_WORD - 1) / BITS_PER_WORD),
+    words_(size * wordsPerRow_, 0) {}
+
+OverlapMatrix OverlapMatrix::Compute(
+    size_t size,
+    const std::function<bool(size_t, size_t)>& doFormIDsOverlap) {
+  OverlapMatrix matrix(size);
+  if (size < 2) {
+    return matrix;
+  }
+
+  const size_t pairCount = size * (size - 1) / 2;
+  const size_t tileCount =
+      std::max<size_t>(1, ThreadPool::GetCurrent()->Size() * TILES_PER_WORKER);
+  const size_t pairsPerTile = (pairCount + tileCount - 1) / tileCount;
+
+  // Row i holds the pairs (i, j) for j > i, so earlier rows are longer, and
+  // the largest tiles are submitted first.
+  std::vector<std::function<void()>> tasks;
+  size_t firstRow = 0;
+  while (firstRow < size - 1) {
+    size_t endRow = firstRow;
+    size_t tilePairs = 0;
+    while (endRow < size - 1 && tilePairs < pairsPerTile) {
+      tilePairs += size - endRow - 1;
+      ++endRow;
+    }
+
+    tasks.push_back([&matrix, &doFormIDsOverlap, size, firstRow, endRow]() {
+      for (size_t i = firstRow; i < endRow; ++i) {
+        for (size_t j = i + 1; j < size; ++j) {
+          if (doFormIDsOverlap(i, j)) {
+            matrix.Set(i, j);
+          }
+        }
+      }
+    });
+
+    firstRow = endRow;
+  }
+
+  ThreadPool::GetCurrent()->Run(tasks);
+
+  return matrix;
+}
+
+size_t OverlapMatrix::Size() const { return size_; }
+
+bool OverlapMatrix::Get(size_t i, size_t j) const {
+  if (i > j) {
+    std::swap(i, j);
+  }
+
+  const auto word = words_[i * wordsPerRow_ + j / BITS_PER_WORD];
+  return (word >> (j % BITS_PER_WORD)) & 1;
+}
+
+void OverlapMatrix::Set(size_t i, size_t j) {
+  if (i > j) {
+    std::swap(i, j);
+  }
+
+  words_[i * wordsPerRow_ + j / BITS_PER_WORD] |= uint64_t{1}
+                                                   << (j % BITS_PER_WORD);
+}
+
+size_t OverlapMatrix::GetMemoryUsage() const {
+  return words_.capacity() * sizeof(uint64_t);
+}
+}
@@ -0,0 +1,72 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_SORTING_OVERLAP_MATRIX
+#define LOOT_API_SORTING_OVERLAP_MATRIX
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace loot {
+// A symmetric relation between plugins, identified by their indices, packed
+// one bit per pair. Each row starts on a new word, so that rows can be written
+// by different threads at once.
+class OverlapMatrix {
+public:
+  OverlapMatrix();
+  explicit OverlapMatrix(size_t size);
+
+  // Calls the given function for each pair of indices i < j, in parallel on
+  // the current thread pool, and records the pairs that it returns true for.
+  // The pairs are split into tiles of whole rows with roughly equal numbers
+  // of pairs, so the function is called from several threads at once and
+  // must be safe to call concurrently. If it throws, the first exception
+  // thrown is rethrown once all the tiles have finished.
+  static OverlapMatrix Compute(
+      size_t size,
+      const std::function<bool(size_t, size_t)>& doFormIDsOverlap);
+
+  size_t Size() const;
+
+  bool Get(size_t i, size_t j) const;
+  // Must not be called for pairs in the same row at the same time, where the
+  // row is the smaller of the two indices.
+  void Set(size_t i, size_t j);
+
+  // An estimate of the memory used by the matrix, in bytes.
+  size_t GetMemoryUsage() const;
+
+private:
+  static constexpr size_t BITS_PER_WORD = 64;
+
+  size_t size_;
+  size_t wordsPerRow_;
+  std::vector<uint64_t> words_;
+};
+}
+
+#endif
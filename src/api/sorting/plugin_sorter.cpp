@@ -24,21 +24,35 @@
 
 #include "plugin_sorter.h"
 
+#include <chrono>
+#include <algorithm>
 #include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <optional>
 #include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/graph/breadth_first_search.hpp>
-#include <boost/graph/iteration_macros.hpp>
 #include <boost/graph/topological_sort.hpp>
 #include <boost/locale.hpp>
 
+#include "api/api_database.h"
 #include "api/game/game.h"
 #include "api/helpers/logging.h"
+#include "api/helpers/memory_resource.h"
+#include "api/helpers/memory_usage.h"
 #include "api/helpers/text.h"
+#include "api/helpers/thread_pool.h"
+#include "api/helpers/tracing.h"
 #include "api/metadata/condition_evaluator.h"
 #include "api/sorting/group_sort.h"
+#include "api/sorting/overlap_matrix.h"
 #include "loot/exception/cyclic_interaction_error.h"
+#include "loot/exception/operation_cancelled_error.h"
 #include "loot/exception/undefined_group_error.h"
 
 using std::list;
@@ -50,6 +64,62 @@ typedef boost::graph_traits<PluginGraph>::vertex_iterator vertex_it;
 typedef boost::graph_traits<PluginGraph>::edge_descriptor edge_t;
 typedef boost::graph_traits<PluginGraph>::edge_iterator edge_it;
 
+// The number of phases run by PluginSorter::Sort(), which is the total that
+// progress is reported against. The lexicographic tie-break mode doesn't run
+// the AddTieBreakEdges phase.
+constexpr size_t NUM_SORT_PHASES = 8;
+
+// The number of sort results that a sorter keeps for reuse.
+constexpr size_t MAX_CACHED_SORTS = 4;
+
+// The tie-break load order index of plugins that have no load order position,
+// so that they compare after all the plugins that do.
+constexpr size_t NO_LOAD_ORDER_INDEX = std::numeric_limits<size_t>::max();
+
+// Appends values to a sort key. Variable-length values are prefixed with
+// their length so that different sequences of values give different keys.
+class SortKeyWriter {
+public:
+  void Write(uint64_t value) {
+    key_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void Write(const std::string& value) {
+    Write((uint64_t)value.size());
+    key_.append(value);
+  }
+
+  void Write(const std::set<File>& files) {
+    Write((uint64_t)files.size());
+    for (const auto& file : files) {
+      Write(file.GetName());
+    }
+  }
+
+  std::string Release() { return std::move(key_); }
+
+private:
+  std::string key_;
+};
+
+// Checks if two sorted ranges have any element in common.
+bool HaveCommonElement(const std::vector<std::string>& sorted,
+                       const std::vector<std::string>& otherSorted) {
+  auto it = sorted.begin();
+  auto otherIt = otherSorted.begin();
+  while (it != sorted.end() && otherIt != otherSorted.end()) {
+    if (*it < *otherIt) {
+      ++it;
+    } else if (*otherIt < *it) {
+      ++otherIt;
+    } else {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 std::string describeEdgeType(EdgeType edgeType) {
   switch (edgeType) {
     case EdgeType::hardcoded:
@@ -77,58 +147,287 @@ std::string describeEdgeType(EdgeType edgeType) {
   }
 }
 
-std::vector<std::string> PluginSorter::Sort(Game& game) {
-  logger_ = getLogger();
+std::vector<std::string> PluginSorter::Sort(
+    Game& game,
+    const CancellationToken& cancellationToken,
+    const ProgressCallback& progressCallback) {
+  return Sort(
+      game.Type(),
+      [&]() { AddPluginVertices(game); },
+      [&]() { return GetHardcodedPluginData(game); },
+      cancellationToken,
+      progressCallback);
+}
 
-  // Clear existing data.
-  graph_.clear();
-  indexMap_.clear();
-  pathsCache_.clear();
+std::vector<std::string> PluginSorter::Sort(
+    const SortCapture& capture,
+    const CancellationToken& cancellationToken,
+    const ProgressCallback& progressCallback) {
+  return Sort(
+      capture.gameType,
+      [&]() { AddPluginVertices(capture); },
+      [&]() { return capture.hardcodedPlugins; },
+      cancellationToken,
+      progressCallback);
+}
+
+std::vector<std::vector<std::string>> PluginSorter::SortProfiles(
+    Game& game,
+    const std::vector<SortProfile>& profiles) {
+  auto loadedPlugins = game.GetCache()->GetPlugins();
+  RetainOverlapResults(loadedPlugins);
+
+  // The metadata of every plugin in the profiles is evaluated together once,
+  // and each profile's vertices are added from it in the plugins' set order,
+  // as they would be when sorting only that profile's plugins.
+  const std::vector<std::shared_ptr<const Plugin>> plugins(
+      loadedPlugins.begin(), loadedPlugins.end());
+  const auto metadata = GetPluginsMetadata(game, plugins);
+  std::unordered_map<std::string, size_t> pluginIndices;
+  for (size_t i = 0; i < plugins.size(); ++i) {
+    pluginIndices.emplace(plugins[i]->GetNormalizedName(), i);
+  }
+
+  std::vector<std::unique_ptr<PluginSorter>> sorters;
+  std::vector<std::vector<std::string>> sortedProfiles(profiles.size());
+  std::vector<std::function<void()>> tasks;
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    auto sorter = std::make_unique<PluginSorter>();
+    sorter->tieBreakMode_ = tieBreakMode_.load();
+    sorter->validationEnabled_ = validationEnabled_.load();
+    sorter->memoryResource_ = memoryResource_.load();
+    sorter->groupClosure_ = groupClosure_;
+    sorter->sharedOverlapResults_ = &overlapResults_;
+
+    tasks.push_back([&, i, sorter = sorter.get()]() {
+      TraceScope traceScope("SortProfile", "game");
+      const auto& profile = profiles[i];
+
+      // Plugins that weren't loaded because they're invalid are skipped.
+      std::vector<size_t> indices;
+      for (const auto& pluginName : profile.plugins) {
+        auto name = pluginName;
+        if (EndsWithIgnoringAsciiCase(name, ".ghost")) {
+          name = name.substr(0, name.length() - 6);
+        }
+
+        auto it = pluginIndices.find(NormalizeFilename(name));
+        if (it != pluginIndices.end()) {
+          indices.push_back(it->second);
+        }
+      }
+      std::sort(indices.begin(), indices.end());
+      indices.erase(std::unique(indices.begin(), indices.end()),
+                    indices.end());
+
+      std::unordered_map<std::string, size_t> loadOrderIndices;
+      for (size_t j = 0; j < profile.loadOrder.size(); ++j) {
+        loadOrderIndices.emplace(NormalizeFilename(profile.loadOrder[j]), j);
+      }
+
+      sortedProfiles[i] = sorter->Sort(
+          game.Type(),
+          [&]() {
+            sorter->AddPluginVertices(
+                game,
+                plugins,
+                metadata,
+                indices,
+                [&](const std::string& name) -> std::optional<size_t> {
+                  auto it = loadOrderIndices.find(NormalizeFilename(name));
+                  if (it == loadOrderIndices.end()) {
+                    return std::nullopt;
+                  }
+                  return it->second;
+                });
+          },
+          [&]() { return sorter->GetHardcodedPluginData(game); },
+          CancellationToken(),
+          ProgressCallback());
+    });
+    sorters.push_back(std::move(sorter));
+  }
+
+  ThreadPool::GetCurrent()->Run(tasks);
+
+  // The profiles' sorters only read this sorter's results, so add the
+  // results that they calculated now that they have all finished.
+  for (const auto& sorter : sorters) {
+    for (auto& results : sorter->overlapResults_) {
+      overlapResults_[results.first].insert(results.second.begin(),
+                                            results.second.end());
+    }
+  }
+
+  return sortedProfiles;
+}
+
+SortCapture PluginSorter::Capture(Game& game) {
+  try {
+    Sort(game);
+  } catch (CyclicInteractionError& e) {
+    if (logger_) {
+      logger_->info("Capturing a sort that failed: {}", e.what());
+    }
+  } catch (UndefinedGroupError& e) {
+    if (logger_) {
+      logger_->info("Capturing a sort that failed: {}", e.what());
+    }
+  }
+
+  SortCapture capture;
+  capture.gameType = game.Type();
+  capture.masterlistGroups = *game.GetApiDatabase()->GetGroupsView(false);
+  capture.userGroups = *game.GetApiDatabase()->GetUserGroupsView();
+  capture.hardcodedPlugins = GetHardcodedPluginData(game);
+
+  const auto toFilenames = [](const std::set<File>& files) {
+    std::vector<std::string> filenames;
+    for (const auto& file : files) {
+      filenames.push_back(file.GetName());
+    }
+    return filenames;
+  };
+
+  for (const auto& vertex :
+       boost::make_iterator_range(boost::vertices(graph_))) {
+    const auto& plugin = graph_[vertex];
+
+    SortCapture::Plugin capturedPlugin;
+    capturedPlugin.name = plugin.GetName();
+    capturedPlugin.normalizedName = plugin.GetNormalizedName();
+    capturedPlugin.isMaster = plugin.IsMaster();
+    capturedPlugin.loadsArchive = plugin.LoadsArchive();
+    capturedPlugin.masters = plugin.GetMasters();
+    capturedPlugin.numOverrideFormIDs = plugin.NumOverrideFormIDs();
+    capturedPlugin.group = plugin.GetGroup();
+    capturedPlugin.masterlistLoadAfterFiles =
+        toFilenames(plugin.GetMasterlistLoadAfterFiles());
+    capturedPlugin.userLoadAfterFiles =
+        toFilenames(plugin.GetUserLoadAfterFiles());
+    capturedPlugin.masterlistRequirements =
+        toFilenames(plugin.GetMasterlistRequirements());
+    capturedPlugin.userRequirements =
+        toFilenames(plugin.GetUserRequirements());
+    capturedPlugin.loadOrderIndex = plugin.GetLoadOrderIndex();
+
+    // The stored results include every pair that the sort compared, and may
+    // also include pairs from earlier sorts of the same plugins.
+    auto resultsIt = overlapResults_.find(plugin.GetNormalizedName());
+    if (resultsIt != overlapResults_.end()) {
+      for (const auto& result : resultsIt->second) {
+        if (result.second && vertexIds_.count(result.first) != 0) {
+          capturedPlugin.overlappingPlugins.insert(result.first);
+        }
+      }
+    }
+
+    capture.plugins.push_back(std::move(capturedPlugin));
+  }
+
+  return capture;
+}
+
+std::vector<std::string> PluginSorter::Sort(
+    GameType gameType,
+    const std::function<void()>& addPluginVertices,
+    const std::function<HardcodedPluginData()>& getHardcodedPluginData,
+    const CancellationToken& cancellationToken,
+    const ProgressCallback& progressCallback) {
+  ResetGraph(cancellationToken, progressCallback);
+  SetSortedGraph(nullptr);
+  const TieBreakMode tieBreakMode = tieBreakMode_;
+  const bool validationEnabled = validationEnabled_;
+  numPhases_ = tieBreakMode == TieBreakMode::edges ? NUM_SORT_PHASES
+                                                   : NUM_SORT_PHASES - 1;
+  if (validationEnabled) {
+    numPhases_ += 1;
+  }
 
-  AddPluginVertices(game);
+  RunPhase("AddPluginVertices", [&]() { addPluginVertices(); });
 
   // If there aren't any vertices, exit early, because sorting assumes
   // there is at least one plugin.
   if (boost::num_vertices(graph_) == 0)
     return vector<std::string>();
 
-  if (logger_) {
-    logger_->info("Current load order: ");
-    for (const auto& plugin : game.GetLoadOrder()) {
-      logger_->info("\t\t{}", plugin);
+  const auto hardcodedPlugins = getHardcodedPluginData();
+
+  auto sortKey = GetSortKey(
+      gameType, hardcodedPlugins, tieBreakMode, validationEnabled);
+  if (sortKey.has_value()) {
+    for (auto it = cachedSorts_.begin(); it != cachedSorts_.end(); ++it) {
+      if (it->key != sortKey.value()) {
+        continue;
+      }
+
+      if (logger_) {
+        logger_->info(
+            "The plugins to sort and their metadata are unchanged since an "
+            "earlier sort, so reusing its result.");
+      }
+
+      cachedSorts_.splice(cachedSorts_.begin(), cachedSorts_, it);
+
+      const auto& cachedStatistics = cachedSorts_.front().statistics;
+      statistics_.peakGraphMemory = cachedStatistics.peakGraphMemory;
+      statistics_.constraintViolations = cachedStatistics.constraintViolations;
+      statistics_.isCachedResult = true;
+      SetSortedGraph(cachedSorts_.front().sortedGraph);
+
+      return cachedSorts_.front().plugins;
     }
   }
 
   // Now add the interactions between plugins to the graph as edges.
-  AddSpecificEdges();
-  AddHardcodedPluginEdges(game);
-  AddGroupEdges();
-  AddOverlapEdges();
-  AddTieBreakEdges();
+  RunPhase("AddSpecificEdges", [&]() { AddSpecificEdges(); });
+  RunPhase("AddHardcodedPluginEdges", [&]() {
+    AddHardcodedPluginEdges(gameType, hardcodedPlugins);
+  });
+  RunPhase("AddGroupEdges", [&]() { AddGroupEdges(); });
+  RunPhase("AddOverlapEdges", [&]() { AddOverlapEdges(gameType); });
+  if (tieBreakMode == TieBreakMode::edges) {
+    RunPhase("AddTieBreakEdges", [&]() { AddTieBreakEdges(); });
+  }
+
+  // No more edges are added after this point, so the graph is at its largest.
+  statistics_.peakGraphMemory = GetGraphMemoryUsage();
 
-  CheckForCycles();
+  RunPhase("CheckForCycles", [&]() { CheckForCycles(); });
 
   // Now we can sort.
   list<vertex_t> sortedVertices;
   if (logger_) {
     logger_->trace("Performing topological sort on plugin graph...");
   }
-  boost::topological_sort(graph_,
-                          std::front_inserter(sortedVertices),
-                          boost::vertex_index_map(vertexIndexMap_));
+  RunPhase("TopologicalSort", [&]() {
+    if (tieBreakMode == TieBreakMode::edges) {
+      boost::topological_sort(graph_, std::front_inserter(sortedVertices));
+    } else {
+      sortedVertices = LexicographicalTopologicalSort();
+    }
+  });
 
-  // Check that the sorted path is Hamiltonian (ie. unique).
-  if (logger_) {
-    logger_->trace("Checking uniqueness of calculated load order...");
+  if (validationEnabled) {
+    RunPhase("ValidateSortedOrder",
+             [&]() { ValidateSortedOrder(sortedVertices); });
   }
-  for (auto it = sortedVertices.begin(); it != sortedVertices.end(); ++it) {
-    if (next(it) != sortedVertices.end() &&
-        !boost::edge(*it, *next(it), graph_).second && logger_) {
-      logger_->error(
-          "The calculated load order is not unique. No edge exists between {} "
-          "and {}.",
-          graph_[*it].GetName(),
-          graph_[*next(it)].GetName());
+
+  // Check that the sorted path is Hamiltonian (ie. unique). Without tie-break
+  // edges it usually isn't, and the tie-breaks make it deterministic instead.
+  if (tieBreakMode == TieBreakMode::edges) {
+    if (logger_) {
+      logger_->trace("Checking uniqueness of calculated load order...");
+    }
+    for (auto it = sortedVertices.begin(); it != sortedVertices.end(); ++it) {
+      if (next(it) != sortedVertices.end() &&
+          !boost::edge(*it, *next(it), graph_).second && logger_) {
+        logger_->error(
+            "The calculated load order is not unique. No edge exists between "
+            "{} and {}.",
+            graph_[*it].GetName(),
+            graph_[*next(it)].GetName());
+      }
     }
   }
 
@@ -144,15 +443,248 @@ std::vector<std::string> PluginSorter::Sort(Game& game) {
     }
   }
 
+  auto sortedGraph = CreateSortedGraph(sortedVertices);
+  SetSortedGraph(sortedGraph);
+
+  if (sortKey.has_value()) {
+    cachedSorts_.push_front(CachedSort{
+        std::move(sortKey.value()), plugins, statistics_, sortedGraph});
+    if (cachedSorts_.size() > MAX_CACHED_SORTS) {
+      cachedSorts_.pop_back();
+    }
+  }
+
+  return plugins;
+}
+
+std::vector<std::string> PluginSorter::SortNewPlugins(
+    Game& game,
+    const std::vector<std::string>& loadOrder,
+    const std::vector<std::string>& newPlugins) {
+  ResetGraph(CancellationToken(), ProgressCallback());
+  numPhases_ = 2;
+
+  RunPhase("AddPluginVertices", [&]() { AddPluginVertices(game); });
+
+  const auto getVertex = [&](const std::string& plugin) {
+    auto vertex = GetVertexByName(plugin);
+    if (!vertex.has_value()) {
+      throw std::invalid_argument("\"" + plugin + "\" is not loaded");
+    }
+    return vertex.value();
+  };
+
+  std::vector<bool> isPlaced(boost::num_vertices(graph_), false);
+  std::vector<vertex_t> order;
+  order.reserve(loadOrder.size() + newPlugins.size());
+  for (const auto& plugin : loadOrder) {
+    auto vertex = getVertex(plugin);
+    isPlaced[vertex] = true;
+    order.push_back(vertex);
+  }
+
+  std::vector<vertex_t> newVertices;
+  for (const auto& plugin : newPlugins) {
+    auto vertex = getVertex(plugin);
+    if (isPlaced[vertex]) {
+      throw std::invalid_argument("\"" + plugin +
+                                  "\" is already in the load order");
+    }
+    isPlaced[vertex] = true;
+    newVertices.push_back(vertex);
+  }
+
+  const auto hardcodedPlugins = GetHardcodedPluginData(game);
+
+  RunPhase("PlaceNewPlugins", [&]() {
+    for (const auto& vertex : newVertices) {
+      PlaceVertex(vertex, order, game.Type(), hardcodedPlugins);
+    }
+  });
+
+  if (logger_) {
+    logger_->info("Calculated order: ");
+  }
+  vector<std::string> plugins;
+  for (const auto& vertex : order) {
+    plugins.push_back(graph_[vertex].GetName());
+    if (logger_) {
+      logger_->info("\t{}", plugins.back());
+    }
+  }
+
   return plugins;
 }
 
+const SortStatistics& PluginSorter::GetStatistics() const {
+  return statistics_;
+}
+
+std::vector<Vertex> PluginSorter::GetPluginsPath(
+    const std::string& fromPluginName,
+    const std::string& toPluginName) const {
+  std::shared_ptr<const SortedPluginGraph> sortedGraph;
+  {
+    std::lock_guard<std::mutex> lock(sortedGraphMutex_);
+    sortedGraph = sortedGraph_;
+  }
+
+  if (!sortedGraph) {
+    throw std::invalid_argument(
+        "There is no plugin graph from a successful sort to find a path in");
+  }
+
+  return sortedGraph->GetPath(fromPluginName, toPluginName);
+}
+
+void PluginSorter::SetTieBreakMode(TieBreakMode mode) { tieBreakMode_ = mode; }
+
+void PluginSorter::SetValidationEnabled(bool enabled) {
+  validationEnabled_ = enabled;
+}
+
+size_t PluginSorter::GetMemoryUsage() const {
+  size_t bytes = GetGraphMemoryUsage();
+
+  bytes += EstimateHeapSize(vertexIds_, [](const vertex_t&) { return 0; });
+  bytes += masterVertices_.capacity() * sizeof(std::vector<vertex_t>);
+  for (const auto& vertices : masterVertices_) {
+    bytes += vertices.capacity() * sizeof(vertex_t);
+  }
+  bytes += EstimateHeapSize(overlapPlugins_,
+                            [](const std::shared_ptr<const Plugin>&) {
+                              // The plugins are counted as part of the game
+                              // cache.
+                              return 0;
+                            });
+  bytes += EstimateHeapSize(
+      overlapResults_, [](const std::unordered_map<std::string, bool>& results) {
+        return EstimateHeapSize(results, [](bool) { return 0; });
+      });
+
+  // The sorted graph is usually shared with the most recent cached sort, so
+  // it's only counted separately if it isn't.
+  {
+    std::lock_guard<std::mutex> lock(sortedGraphMutex_);
+    if (sortedGraph_ &&
+        (cachedSorts_.empty() ||
+         cachedSorts_.front().sortedGraph != sortedGraph_)) {
+      bytes += sortedGraph_->GetMemoryUsage();
+    }
+  }
+
+  for (const auto& cachedSort : cachedSorts_) {
+    if (cachedSort.sortedGraph) {
+      bytes += cachedSort.sortedGraph->GetMemoryUsage();
+    }
+    bytes += sizeof(cachedSort) + EstimateHeapSize(cachedSort.key) +
+             EstimateHeapSize(cachedSort.plugins) +
+             cachedSort.statistics.phases.capacity() *
+                 sizeof(SortPhaseStatistics) +
+             cachedSort.statistics.constraintViolations.capacity() *
+                 sizeof(SortConstraintViolation);
+  }
+
+  return bytes;
+}
+
+void PluginSorter::Trim() {
+  // Swapping with empty containers frees their memory, unlike clearing them.
+  PluginGraph().swap(graph_);
+  std::unordered_map<std::string, vertex_t>().swap(vertexIds_);
+  std::vector<std::vector<vertex_t>>().swap(masterVertices_);
+  std::vector<PolymorphicVector<uint8_t>>().swap(edgeTypes_);
+  std::vector<VertexSet>().swap(descendants_);
+  std::vector<VertexSet>().swap(ancestors_);
+  std::vector<size_t>().swap(vertexGroups_);
+  std::vector<size_t>().swap(tieBreakLoadOrderIndices_);
+  std::vector<uint32_t>().swap(tieBreakBasenameRanks_);
+  std::vector<uint32_t>().swap(tieBreakExtensionRanks_);
+  std::vector<VertexSet>().swap(afterGroupVertices_);
+
+  cachedSorts_.clear();
+  SetSortedGraph(nullptr);
+}
+
+void PluginSorter::SetMemoryResource(pmr::memory_resource* resource) {
+  memoryResource_ = resource;
+}
+
+PluginSorter::VertexSet PluginSorter::CreateVertexSet(
+    size_t numVertices) const {
+  return VertexSet(numVertices,
+                   0,
+                   VertexSet::allocator_type(
+                       ResolveMemoryResource(memoryResource_)));
+}
+
+void PluginSorter::ResetGraph(const CancellationToken& cancellationToken,
+                              const ProgressCallback& progressCallback) {
+  logger_ = getLogger();
+  cancellationToken_ = cancellationToken;
+  progressCallback_ = progressCallback;
+
+  graph_.clear();
+  vertexIds_.clear();
+  masterVertices_.clear();
+  edgeTypes_.clear();
+  descendants_.clear();
+  ancestors_.clear();
+  vertexGroups_.clear();
+  tieBreakLoadOrderIndices_.clear();
+  tieBreakBasenameRanks_.clear();
+  tieBreakExtensionRanks_.clear();
+  afterGroupVertices_.clear();
+  statistics_ = SortStatistics();
+}
+
+void PluginSorter::RunPhase(const std::string& name,
+                            const std::function<void()>& phase) {
+  if (cancellationToken_.IsCancelled()) {
+    if (logger_) {
+      logger_->info("Sorting was cancelled before phase {}.", name);
+    }
+    throw OperationCancelledError("Sorting was cancelled");
+  }
+
+  if (progressCallback_) {
+    OperationProgress progress;
+    progress.stage = name;
+    progress.completed = statistics_.phases.size();
+    progress.total = numPhases_;
+    progressCallback_(progress);
+  }
+
+  phaseStatistics_ = SortPhaseStatistics();
+  phaseStatistics_.name = name;
+
+  TraceScope traceScope(name.c_str(), "sorting");
+  auto start = std::chrono::steady_clock::now();
+  phase();
+  phaseStatistics_.duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start);
+
+  if (logger_) {
+    logger_->debug(
+        "Sorting phase {} took {} us, checked for cycles {} times and found "
+        "{} of {} queried paths.",
+        name,
+        phaseStatistics_.duration.count(),
+        phaseStatistics_.cycleChecks,
+        phaseStatistics_.pathHits,
+        phaseStatistics_.pathQueries);
+  }
+
+  statistics_.phases.push_back(phaseStatistics_);
+}
+
 void PluginSorter::AddPluginVertices(Game& game) {
   // The resolution of tie-breaks in the plugin graph may be dependent
   // on the order in which vertices are iterated over, as an earlier tie
   // break resolution may cause a potential later tie break to instead
-  // cause a cycle. Vertices are stored in a std::list and added to the
-  // list using push_back().
+  // cause a cycle. Vertices are stored in a std::vector and added to the
+  // vector using push_back().
   // Plugins are stored in an unordered map, so simply iterating over
   // its elements is not guarunteed to produce a consistent vertex order.
   // MSVC 2013 and GCC 5.0 have been shown to produce consistent
@@ -166,156 +698,484 @@ void PluginSorter::AddPluginVertices(Game& game) {
   // unspecified behaviour will remain in future compiler updates, so
   // implement it generally.
 
-  // Using a set of plugin names followed by finding the matching key
-  // in the unordered map, as it's probably faster than copying the
-  // full plugin objects then sorting them.
-  std::map<std::string, std::vector<std::string>> groupPlugins;
-
-  auto loadOrder = game.GetLoadOrder();
-
-  for (const auto& plugin : game.GetCache()->GetPlugins()) {
-    auto masterlistMetadata =
-        game.GetDatabase()
-            ->GetPluginMetadata(plugin->GetName(), false, true)
-            .value_or(PluginMetadata(plugin->GetName()));
-    auto userMetadata = game.GetDatabase()
-                            ->GetPluginUserMetadata(plugin->GetName(), true)
-                            .value_or(PluginMetadata(plugin->GetName()));
-
-    auto pluginSortingData =
-        PluginSortingData(*plugin, masterlistMetadata, userMetadata, loadOrder);
-
-    auto groupName = pluginSortingData.GetGroup();
-    auto groupIt = groupPlugins.find(groupName);
-    if (groupIt == groupPlugins.end()) {
-      groupPlugins.emplace(groupName,
-                           std::vector<std::string>({plugin->GetName()}));
-    } else {
-      groupIt->second.push_back(plugin->GetName());
+  // The load order state snapshot indexes the current load order by name,
+  // so each plugin's position can be looked up without comparing its name
+  // against every entry.
+  auto loadOrderState = game.GetLoadOrderHandler()->GetState();
+  if (logger_) {
+    logger_->info("Current load order: ");
+    for (const auto& plugin : loadOrderState->GetLoadOrder()) {
+      logger_->info("\t\t{}", plugin);
     }
+  }
 
-    boost::add_vertex(pluginSortingData, graph_);
+  auto plugins = game.GetCache()->GetPlugins();
+  RetainOverlapResults(plugins);
+
+  const std::vector<std::shared_ptr<const Plugin>> pluginsToAdd(
+      plugins.begin(), plugins.end());
+  std::vector<size_t> indices(pluginsToAdd.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  AddPluginVertices(
+      game,
+      pluginsToAdd,
+      GetPluginsMetadata(game, pluginsToAdd),
+      indices,
+      [&](const std::string& pluginName) {
+        return loadOrderState->GetLoadOrderIndex(pluginName);
+      });
+}
+
+PluginSorter::PluginsMetadata PluginSorter::GetPluginsMetadata(
+    Game& game,
+    const std::vector<std::shared_ptr<const Plugin>>& plugins) {
+  // Resolve all the plugins' metadata up front, so that the lookups and
+  // condition evaluation are batched (and run in parallel where there are
+  // enough plugins) instead of being done one plugin at a time.
+  std::vector<std::string> pluginNames;
+  pluginNames.reserve(plugins.size());
+  for (const auto& plugin : plugins) {
+    pluginNames.push_back(plugin->GetName());
   }
 
-  // Map sets of transitive group dependencies to sets of transitive plugin
-  // dependencies.
-  groups_ = game.GetDatabase()->GetGroups();
-
-  auto groups = GetTransitiveAfterGroups(game.GetDatabase()->GetGroups(false),
-                                         game.GetDatabase()->GetUserGroups());
-  for (auto& group : groups) {
-    std::unordered_set<std::string> transitivePlugins;
-    for (const auto& afterGroup : group.second) {
-      auto pluginsIt = groupPlugins.find(afterGroup);
-      if (pluginsIt != groupPlugins.end()) {
-        transitivePlugins.insert(pluginsIt->second.begin(),
-                                 pluginsIt->second.end());
+  auto database = game.GetDatabase();
+  PluginsMetadata metadata;
+  metadata.masterlistMetadata =
+      database->GetPluginMetadataBatch(pluginNames, false, true);
+  metadata.userMetadata =
+      database->GetPluginUserMetadataBatch(pluginNames, true);
+
+  return metadata;
+}
+
+void PluginSorter::AddPluginVertices(
+    Game& game,
+    const std::vector<std::shared_ptr<const Plugin>>& plugins,
+    const PluginsMetadata& metadata,
+    const std::vector<size_t>& indices,
+    const std::function<std::optional<size_t>(const std::string&)>&
+        getLoadOrderIndex) {
+  for (const auto index : indices) {
+    const auto& plugin = plugins[index];
+    const auto pluginName = plugin->GetName();
+
+    auto pluginSortingData = PluginSortingData(
+        *plugin,
+        metadata.masterlistMetadata[index].value_or(
+            PluginMetadata(pluginName)),
+        metadata.userMetadata[index].value_or(PluginMetadata(pluginName)),
+        getLoadOrderIndex(pluginName));
+
+    auto vertex = boost::add_vertex(pluginSortingData, graph_);
+    vertexIds_.emplace(plugin->GetNormalizedName(), vertex);
+  }
+
+  // Resolve the plugins' masters through the cache's interned plugin ids,
+  // instead of normalising each master's filename to look up its vertex.
+  const auto& gameCache = *game.GetCache();
+  std::unordered_map<uint32_t, vertex_t> vertexByPluginId;
+  std::vector<std::optional<uint32_t>> pluginIds;
+  pluginIds.reserve(indices.size());
+  for (const auto index : indices) {
+    const auto& plugin = plugins[index];
+    auto pluginId = gameCache.GetPluginId(plugin->GetNormalizedName());
+    if (pluginId.has_value()) {
+      vertexByPluginId.emplace(pluginId.value(),
+                               vertexIds_.at(plugin->GetNormalizedName()));
+    }
+    pluginIds.push_back(pluginId);
+  }
+
+  masterVertices_.resize(indices.size());
+  vertex_it vit, vitend;
+  for (boost::tie(vit, vitend) = boost::vertices(graph_); vit != vitend;
+       ++vit) {
+    if (!pluginIds[*vit].has_value()) {
+      // The plugin was removed from the cache after it was read.
+      masterVertices_[*vit] = GetMasterVerticesByName(*vit);
+      continue;
+    }
+
+    for (const auto masterId : gameCache.GetMasterIds(pluginIds[*vit].value())) {
+      auto it = vertexByPluginId.find(masterId);
+      if (it != vertexByPluginId.end()) {
+        masterVertices_[*vit].push_back(it->second);
       }
     }
-    group.second = transitivePlugins;
   }
 
-  // Add all transitive plugin dependencies for a group to the plugin's load
-  // after metadata.
+  // Use the database's cached group views to avoid copying the groups.
+  auto apiDatabase = game.GetApiDatabase();
+  InitialiseVertexData(*apiDatabase->GetGroupsView(false),
+                       *apiDatabase->GetUserGroupsView());
+}
+
+void PluginSorter::AddPluginVertices(const SortCapture& capture) {
+  for (const auto& plugin : capture.plugins) {
+    auto vertex = boost::add_vertex(PluginSortingData(plugin), graph_);
+    vertexIds_.emplace(plugin.normalizedName, vertex);
+  }
+
+  masterVertices_.resize(boost::num_vertices(graph_));
+  vertex_it vit, vitend;
+  for (boost::tie(vit, vitend) = boost::vertices(graph_); vit != vitend;
+       ++vit) {
+    masterVertices_[*vit] = GetMasterVerticesByName(*vit);
+  }
+
+  InitialiseVertexData(capture.masterlistGroups, capture.userGroups);
+}
+
+void PluginSorter::InitialiseVertexData(
+    const std::unordered_set<Group>& masterlistGroups,
+    const std::unordered_set<Group>& userGroups) {
+  const auto numVertices = boost::num_vertices(graph_);
+
+  // Copies of a container with a polymorphic allocator use the default
+  // memory resource, so each container is constructed separately.
+  const auto memoryResource = ResolveMemoryResource(memoryResource_);
+  edgeTypes_.clear();
+  descendants_.clear();
+  ancestors_.clear();
+  edgeTypes_.reserve(numVertices);
+  descendants_.reserve(numVertices);
+  ancestors_.reserve(numVertices);
+  for (size_t i = 0; i < numVertices; ++i) {
+    edgeTypes_.emplace_back(memoryResource);
+    descendants_.push_back(CreateVertexSet(numVertices));
+    ancestors_.push_back(CreateVertexSet(numVertices));
+  }
+
+  InitialiseTieBreakKeys();
+
+  if (!groupClosure_.has_value() ||
+      !groupClosure_.value().IsBuiltFrom(masterlistGroups, userGroups)) {
+    groupClosure_.emplace(masterlistGroups, userGroups);
+    ++groupClosureVersion_;
+  }
+  const auto& groupClosure = groupClosure_.value();
+
+  // Record which vertices are in each group.
+  std::vector<VertexSet> groupVertices;
+  groupVertices.reserve(groupClosure.NumGroups());
+  for (size_t i = 0; i < groupClosure.NumGroups(); ++i) {
+    groupVertices.push_back(CreateVertexSet(0));
+  }
+  vertexGroups_.reserve(numVertices);
   for (const auto& vertex :
        boost::make_iterator_range(boost::vertices(graph_))) {
-    PluginSortingData& plugin = graph_[vertex];
+    const auto& plugin = graph_[vertex];
+    auto groupIndex = groupClosure.GetIndex(plugin.GetGroup());
+    if (!groupIndex.has_value()) {
+      throw UndefinedGroupError(plugin.GetGroup());
+    }
 
-    if (logger_) {
-      logger_->trace(
-          "Plugin \"{}\" belongs to group \"{}\", setting after group plugins",
-          plugin.GetName(),
-          plugin.GetGroup());
+    if (shouldLog(logger_, spdlog::level::trace)) {
+      logger_->trace("Plugin \"{}\" belongs to group \"{}\"",
+                     plugin.GetName(),
+                     plugin.GetGroup());
     }
 
-    auto groupsIt = groups.find(plugin.GetGroup());
-    if (groupsIt == groups.end()) {
-      throw UndefinedGroupError(plugin.GetGroup());
-    } else {
-      plugin.SetAfterGroupPlugins(groupsIt->second);
+    auto& vertices = groupVertices[groupIndex.value()];
+    if (vertices.empty()) {
+      vertices.resize(numVertices);
+    }
+    vertices.set(vertex);
+    vertexGroups_.push_back(groupIndex.value());
+  }
+
+  // Map sets of transitive group dependencies to sets of transitive plugin
+  // dependencies. Only groups that contain plugins need their set.
+  afterGroupVertices_.clear();
+  afterGroupVertices_.reserve(groupClosure.NumGroups());
+  for (size_t i = 0; i < groupVertices.size(); ++i) {
+    afterGroupVertices_.push_back(CreateVertexSet(0));
+    if (groupVertices[i].empty()) {
+      continue;
+    }
+
+    auto& afterVertices = afterGroupVertices_.back();
+    afterVertices.resize(numVertices);
+
+    const auto& afterGroups = groupClosure.GetAfterGroups(i);
+    for (auto j = afterGroups.find_first(); j != afterGroups.npos;
+         j = afterGroups.find_next(j)) {
+      if (!groupVertices[j].empty()) {
+        afterVertices |= groupVertices[j];
+      }
     }
   }
+}
+
+std::vector<std::vector<PluginSorter::CandidateEdge>>
+PluginSorter::GetCandidateEdges(
+    const std::function<void(const vertex_t&, std::vector<CandidateEdge>&)>&
+        getEdges) const {
+  std::vector<std::vector<CandidateEdge>> candidateEdges(
+      boost::num_vertices(graph_));
 
-  // Prebuild an index map, which std::list-based VertexList graphs don't have.
-  vertexIndexMap_ = vertex_map_t(indexMap_);
-  size_t i = 0;
-  BGL_FORALL_VERTICES(v, graph_, PluginGraph)
-  put(vertexIndexMap_, v, i++);
+  ForEachVertex([&](const vertex_t& vertex) {
+    getEdges(vertex, candidateEdges[vertex]);
+  });
+
+  return candidateEdges;
 }
 
-std::optional<vertex_t> PluginSorter::GetVertexByName(
-    const std::string& name) const {
+void PluginSorter::ForEachVertex(
+    const std::function<void(const vertex_t&)>& func) const {
+  // The work done per vertex is often just a scan of its edges, so it takes
+  // more vertices than other items to outweigh the cost of using the pool.
+  static constexpr size_t MIN_PARALLEL_VERTICES = 128;
+
+  ThreadPool::GetCurrent()->RunInChunks(
+      boost::num_vertices(graph_),
+      MIN_PARALLEL_VERTICES,
+      [&](size_t start, size_t end) {
+        for (vertex_t vertex = start; vertex < end; ++vertex) {
+          func(vertex);
+        }
+      });
+}
+
+std::shared_ptr<const SortedPluginGraph> PluginSorter::CreateSortedGraph(
+    const std::list<vertex_t>& sortedVertices) const {
+  std::vector<size_t> positions(boost::num_vertices(graph_));
+  size_t position = 0;
+  for (const auto& vertex : sortedVertices) {
+    positions[vertex] = position;
+    ++position;
+  }
+
+  auto sortedGraph = std::make_shared<SortedPluginGraph>();
+  for (const auto& vertex : sortedVertices) {
+    sortedGraph->AddVertex(graph_[vertex].GetName());
+
+    // An edge can only go backwards if the order violates it, which
+    // validation reports, so such edges are left out.
+    size_t index = 0;
+    for (const auto& edge :
+         boost::make_iterator_range(boost::out_edges(vertex, graph_))) {
+      const auto targetPosition = positions[boost::target(edge, graph_)];
+      if (targetPosition > positions[vertex]) {
+        sortedGraph->AddEdge(targetPosition,
+                             static_cast<EdgeType>(edgeTypes_[vertex][index]));
+      }
+      ++index;
+    }
+  }
+
+  return sortedGraph;
+}
+
+void PluginSorter::SetSortedGraph(
+    std::shared_ptr<const SortedPluginGraph> sortedGraph) {
+  std::lock_guard<std::mutex> lock(sortedGraphMutex_);
+  sortedGraph_ = std::move(sortedGraph);
+}
+
+void PluginSorter::ValidateSortedOrder(
+    const std::list<vertex_t>& sortedVertices) {
+  std::vector<size_t> positions(boost::num_vertices(graph_));
+  size_t position = 0;
+  for (const auto& vertex : sortedVertices) {
+    positions[vertex] = position;
+    ++position;
+  }
+
+  // Violations are found per vertex and then combined in vertex order, so
+  // that they're reported in the same order however the work is split up.
+  std::vector<std::vector<SortConstraintViolation>> violations(
+      boost::num_vertices(graph_));
+  ForEachVertex([&](const vertex_t& vertex) {
+    size_t index = 0;
+    for (const auto& edge :
+         boost::make_iterator_range(boost::out_edges(vertex, graph_))) {
+      const auto target = boost::target(edge, graph_);
+      if (positions[target] <= positions[vertex]) {
+        SortConstraintViolation violation;
+        violation.fromPlugin = graph_[vertex].GetName();
+        violation.toPlugin = graph_[target].GetName();
+        violation.edgeType = static_cast<EdgeType>(edgeTypes_[vertex][index]);
+        violations[vertex].push_back(violation);
+      }
+      ++index;
+    }
+  });
+
+  for (auto& vertexViolations : violations) {
+    for (auto& violation : vertexViolations) {
+      if (logger_) {
+        logger_->error(
+            "The calculated load order does not respect the {} edge from "
+            "\"{}\" to \"{}\".",
+            describeEdgeType(violation.edgeType),
+            violation.fromPlugin,
+            violation.toPlugin);
+      }
+      statistics_.constraintViolations.push_back(std::move(violation));
+    }
+  }
+}
+
+std::optional<std::string> PluginSorter::GetSortKey(
+    GameType gameType,
+    const HardcodedPluginData& hardcodedPlugins,
+    TieBreakMode tieBreakMode,
+    bool validationEnabled) const {
+  SortKeyWriter writer;
+  writer.Write((uint64_t)gameType);
+  writer.Write((uint64_t)tieBreakMode);
+  writer.Write((uint64_t)validationEnabled);
+  writer.Write((uint64_t)groupClosureVersion_);
+
+  // The plugin graph is built from the vertices in the order they were added,
+  // so that order is part of the key.
+  writer.Write((uint64_t)boost::num_vertices(graph_));
   for (const auto& vertex :
        boost::make_iterator_range(boost::vertices(graph_))) {
-    if (CompareFilenames(graph_[vertex].GetName(), name) == 0) {
-      return vertex;
+    const auto& plugin = graph_[vertex];
+    const auto loadedPlugin = plugin.GetPlugin();
+    if (loadedPlugin == nullptr) {
+      return std::nullopt;
+    }
+
+    // Whether plugins' records overlap isn't known until they're compared,
+    // so identify the records by the state of the file that they came from.
+    writer.Write(loadedPlugin->GetFilePath().u8string());
+    writer.Write((uint64_t)loadedPlugin->GetLoadedFileSize());
+    writer.Write((uint64_t)loadedPlugin->GetLoadedModificationTime()
+                     .time_since_epoch()
+                     .count());
+    writer.Write((uint64_t)loadedPlugin->IsHeaderOnly());
+
+    writer.Write(plugin.GetName());
+    writer.Write((uint64_t)plugin.IsMaster());
+    writer.Write((uint64_t)plugin.LoadsArchive());
+    writer.Write((uint64_t)plugin.GetMasters().size());
+    for (const auto& master : plugin.GetMasters()) {
+      writer.Write(master);
     }
+    writer.Write((uint64_t)plugin.NumOverrideFormIDs());
+    writer.Write(plugin.GetGroup());
+    writer.Write(plugin.GetMasterlistLoadAfterFiles());
+    writer.Write(plugin.GetUserLoadAfterFiles());
+    writer.Write(plugin.GetMasterlistRequirements());
+    writer.Write(plugin.GetUserRequirements());
+
+    const auto& loadOrderIndex = plugin.GetLoadOrderIndex();
+    writer.Write((uint64_t)loadOrderIndex.has_value());
+    writer.Write((uint64_t)loadOrderIndex.value_or(0));
   }
 
-  return std::nullopt;
+  writer.Write((uint64_t)hardcodedPlugins.implicitlyActivePlugins.size());
+  for (const auto& plugin : hardcodedPlugins.implicitlyActivePlugins) {
+    writer.Write(plugin);
+  }
+  for (const auto inDataDirectory : hardcodedPlugins.verticesInDataDirectory) {
+    writer.Write((uint64_t)inDataDirectory);
+  }
+  for (const auto index : hardcodedPlugins.implicitlyActiveIndices) {
+    writer.Write((uint64_t)index);
+  }
+
+  return writer.Release();
+}
+
+std::optional<vertex_t> PluginSorter::GetVertexByName(
+    const std::string& name) const {
+  auto it = vertexIds_.find(NormalizeFilename(name));
+  if (it == vertexIds_.end()) {
+    return std::nullopt;
+  }
+
+  return it->second;
+}
+
+std::vector<vertex_t> PluginSorter::GetMasterVerticesByName(
+    const vertex_t& vertex) const {
+  std::vector<vertex_t> masterVertices;
+  for (const auto& master : graph_[vertex].GetMasters()) {
+    auto masterVertex = GetVertexByName(master);
+    if (masterVertex.has_value()) {
+      masterVertices.push_back(masterVertex.value());
+    }
+  }
+
+  return masterVertices;
 }
 
 void PluginSorter::CheckForCycles() const {
   if (logger_) {
     logger_->trace("Checking plugin graph for cycles...");
   }
-  boost::depth_first_search(
-      graph_,
-      visitor(CycleDetector<PluginGraph>()).vertex_index_map(vertexIndexMap_));
+  auto getEdgeType = [this](const edge_t& edge, const PluginGraph& graph) {
+    return GetEdgeType(boost::source(edge, graph), boost::target(edge, graph));
+  };
+  CheckForAllCycles(graph_, getEdgeType);
 }
 
-bool PluginSorter::EdgeCreatesCycle(const vertex_t& fromVertex,
-                                    const vertex_t& toVertex) {
-  if (pathsCache_.count(GraphPath(toVertex, fromVertex)) != 0) {
-    return true;
+EdgeType PluginSorter::GetEdgeType(const vertex_t& fromVertex,
+                                   const vertex_t& toVertex) const {
+  // Edges are never removed, so the graph's out-edges for a vertex are in the
+  // order that they were added.
+  size_t index = 0;
+  for (const auto& edge :
+       boost::make_iterator_range(boost::out_edges(fromVertex, graph_))) {
+    if (boost::target(edge, graph_) == toVertex) {
+      return static_cast<EdgeType>(edgeTypes_[fromVertex][index]);
+    }
+    ++index;
   }
 
-  auto start = toVertex;
-  auto end = fromVertex;
+  throw std::logic_error("No edge exists from \"" +
+                         graph_[fromVertex].GetName() + "\" to \"" +
+                         graph_[toVertex].GetName() + "\"");
+}
+
+size_t PluginSorter::GetGraphMemoryUsage() const {
+  const size_t numVertices = boost::num_vertices(graph_);
 
-  std::queue<vertex_t> forwardQueue;
-  std::queue<vertex_t> reverseQueue;
-  std::unordered_set<vertex_t> forwardVisited;
-  std::unordered_set<vertex_t> reverseVisited;
+  size_t bytes = numVertices * sizeof(PluginGraph::stored_vertex);
+  for (const auto& types : edgeTypes_) {
+    // Each edge is stored as its target in the graph, plus its type.
+    bytes += types.capacity() * (sizeof(vertex_t) + sizeof(uint8_t)) +
+             sizeof(types);
+  }
 
-  forwardQueue.push(start);
-  forwardVisited.insert(start);
-  reverseQueue.push(end);
-  reverseVisited.insert(end);
+  // The reachability sets.
+  const size_t bitsetBytes =
+      (numVertices + VertexSet::bits_per_block - 1) /
+      VertexSet::bits_per_block * sizeof(VertexSet::block_type);
+  bytes += (descendants_.size() + ancestors_.size()) *
+           (sizeof(VertexSet) + bitsetBytes);
+
+  // The tie-break keys.
+  bytes += tieBreakLoadOrderIndices_.capacity() * sizeof(size_t) +
+           (tieBreakBasenameRanks_.capacity() +
+            tieBreakExtensionRanks_.capacity()) *
+               sizeof(uint32_t);
+
+  // The group membership data.
+  bytes += vertexGroups_.capacity() * sizeof(size_t);
+  for (const auto& afterVertices : afterGroupVertices_) {
+    bytes += sizeof(afterVertices) + (afterVertices.empty() ? 0 : bitsetBytes);
+  }
 
-  while (!forwardQueue.empty() && !reverseQueue.empty()) {
-    if (!forwardQueue.empty()) {
-      auto v = forwardQueue.front();
-      forwardQueue.pop();
-      if (v == end || reverseVisited.count(v) > 0) {
-        return true;
-      }
-      for (auto adjacentV :
-           boost::make_iterator_range(boost::adjacent_vertices(v, graph_))) {
-        if (forwardVisited.count(adjacentV) == 0) {
-          pathsCache_.insert(GraphPath(start, adjacentV));
+  return bytes;
+}
 
-          forwardVisited.insert(adjacentV);
-          forwardQueue.push(adjacentV);
-        }
-      }
-    }
-    if (!reverseQueue.empty()) {
-      auto v = reverseQueue.front();
-      reverseQueue.pop();
-      if (v == start || forwardVisited.count(v) > 0) {
-        return true;
-      }
-      for (auto adjacentV : boost::make_iterator_range(
-               boost::inv_adjacent_vertices(v, graph_))) {
-        if (reverseVisited.count(adjacentV) == 0) {
-          pathsCache_.insert(GraphPath(adjacentV, end));
+bool PluginSorter::EdgeCreatesCycle(const vertex_t& fromVertex,
+                                    const vertex_t& toVertex) {
+  phaseStatistics_.cycleChecks += 1;
+  return fromVertex == toVertex || PathExists(toVertex, fromVertex);
+}
 
-          reverseVisited.insert(adjacentV);
-          reverseQueue.push(adjacentV);
-        }
-      }
-    }
+bool PluginSorter::PathExists(const vertex_t& fromVertex,
+                              const vertex_t& toVertex) {
+  phaseStatistics_.pathQueries += 1;
+  if (descendants_[fromVertex].test(toVertex)) {
+    phaseStatistics_.pathHits += 1;
+    return true;
   }
 
   return false;
@@ -324,48 +1184,99 @@ bool PluginSorter::EdgeCreatesCycle(const vertex_t& fromVertex,
 void PluginSorter::AddEdge(const vertex_t& fromVertex,
                            const vertex_t& toVertex,
                            EdgeType edgeType) {
-  auto graphPath = GraphPath(fromVertex, toVertex);
-
-  if (pathsCache_.count(graphPath) != 0) {
+  // An edge that duplicates an existing path adds nothing to the ordering.
+  if (PathExists(fromVertex, toVertex)) {
     return;
   }
 
-  if (logger_) {
+  if (shouldLog(logger_, spdlog::level::trace)) {
     logger_->trace("Adding {} edge from \"{}\" to \"{}\".",
                    describeEdgeType(edgeType),
                    graph_[fromVertex].GetName(),
                    graph_[toVertex].GetName());
   }
 
-  boost::add_edge(fromVertex, toVertex, edgeType, graph_);
-  pathsCache_.insert(graphPath);
-}
-
-void PluginSorter::AddHardcodedPluginEdges(Game& game) {
-  using std::filesystem::u8path;
-
-  auto implicitlyActivePlugins =
-      game.GetLoadOrderHandler()->GetImplicitlyActivePlugins();
+  boost::add_edge(fromVertex, toVertex, graph_);
+  edgeTypes_[fromVertex].push_back(static_cast<uint8_t>(edgeType));
+  phaseStatistics_.edgesAdded[edgeType] += 1;
+
+  // Everything that could reach fromVertex can now reach everything that
+  // toVertex could reach.
+  // Assigning to the sets keeps their allocator, unlike copy constructing.
+  auto newAncestors = CreateVertexSet(0);
+  newAncestors = ancestors_[fromVertex];
+  newAncestors.set(fromVertex);
+  auto newDescendants = CreateVertexSet(0);
+  newDescendants = descendants_[toVertex];
+  newDescendants.set(toVertex);
+
+  for (auto i = newAncestors.find_first(); i != newAncestors.npos;
+       i = newAncestors.find_next(i)) {
+    descendants_[i] |= newDescendants;
+  }
 
-  std::set<std::filesystem::path> processedPluginPaths;
-  for (const auto& plugin : implicitlyActivePlugins) {
-    auto pluginPath = game.DataPath() / u8path(plugin);
+  for (auto i = newDescendants.find_first(); i != newDescendants.npos;
+       i = newDescendants.find_next(i)) {
+    ancestors_[i] |= newAncestors;
+  }
+}
 
-    try {
-      processedPluginPaths.insert(std::filesystem::canonical(pluginPath));
-    } catch (std::filesystem::filesystem_error& e) {
+HardcodedPluginData PluginSorter::GetHardcodedPluginData(Game& game) const {
+  auto loadOrderState = game.GetLoadOrderHandler()->GetState();
+
+  // Identify files using the data directory snapshot taken when the plugins
+  // were loaded, instead of resolving each plugin's canonical path. Each
+  // file has one entry in the snapshot, so entries can be compared by
+  // address, and each vertex's entry only needs to be looked up once.
+  const auto& snapshot = game.GetDataDirectorySnapshot();
+
+  HardcodedPluginData data;
+  std::unordered_map<const DataDirectorySnapshot::Entry*, size_t>
+      implicitlyActiveIndices;
+  for (const auto& plugin : loadOrderState->GetImplicitlyActivePlugins()) {
+    auto pluginEntry = snapshot.FindFile(plugin);
+    if (pluginEntry == nullptr) {
       if (logger_) {
         logger_->trace(
-            "Skipping adding hardcoded plugin edges for \"{}\" as its "
-            "canonical path could not be determined: {}",
-            plugin,
-            e.what());
+            "Skipping adding hardcoded plugin edges for \"{}\" as it is not "
+            "present in the data directory.",
+            plugin);
       }
       continue;
     }
 
-    if (game.Type() == GameType::tes5 &&
-        loot::equivalent(plugin, "update.esm")) {
+    implicitlyActiveIndices.emplace(pluginEntry,
+                                    data.implicitlyActivePlugins.size());
+    data.implicitlyActivePlugins.push_back(plugin);
+  }
+
+  const auto numVertices = boost::num_vertices(graph_);
+  data.verticesInDataDirectory.reserve(numVertices);
+  data.implicitlyActiveIndices.reserve(numVertices);
+  for (const auto& vertex :
+       boost::make_iterator_range(boost::vertices(graph_))) {
+    auto entry = snapshot.FindPlugin(graph_[vertex].GetName());
+    data.verticesInDataDirectory.push_back(entry != nullptr);
+
+    auto it = implicitlyActiveIndices.find(entry);
+    data.implicitlyActiveIndices.push_back(
+        entry != nullptr && it != implicitlyActiveIndices.end()
+            ? it->second
+            : data.implicitlyActivePlugins.size());
+  }
+
+  return data;
+}
+
+void PluginSorter::AddHardcodedPluginEdges(
+    GameType gameType,
+    const HardcodedPluginData& hardcodedPlugins) {
+  const auto& implicitlyActivePlugins =
+      hardcodedPlugins.implicitlyActivePlugins;
+  for (size_t i = 0; i < implicitlyActivePlugins.size(); ++i) {
+    const auto& plugin = implicitlyActivePlugins[i];
+
+    if (gameType == GameType::tes5 && loot::equivalent(plugin, "update.esm")) {
       if (logger_) {
         logger_->trace(
             "Skipping adding hardcoded plugin edges for Update.esm as it does "
@@ -386,21 +1297,13 @@ void PluginSorter::AddHardcodedPluginEdges(Game& game) {
       continue;
     }
 
+    // Plugins that are the same file as this or an earlier implicitly active
+    // plugin have already been processed, and don't load after this one.
     vertex_it vit, vitend;
-    for (tie(vit, vitend) = boost::vertices(graph_); vit != vitend; ++vit) {
-      auto& graphPlugin = graph_[*vit];
-
-      auto graphPluginPath = game.DataPath() / u8path(graphPlugin.GetName());
-      if (!std::filesystem::exists(graphPluginPath)) {
-        graphPluginPath += ".ghost";
-      }
-
-      if (!std::filesystem::exists(graphPluginPath)) {
-        continue;
-      }
-
-      if (processedPluginPaths.count(
-              std::filesystem::canonical(graphPluginPath)) == 0) {
+    for (boost::tie(vit, vitend) = boost::vertices(graph_); vit != vitend;
+         ++vit) {
+      if (hardcodedPlugins.verticesInDataDirectory[*vit] &&
+          hardcodedPlugins.implicitlyActiveIndices[*vit] > i) {
         AddEdge(pluginVertex.value(), *vit, EdgeType::hardcoded);
       }
     }
@@ -408,9 +1311,40 @@ void PluginSorter::AddHardcodedPluginEdges(Game& game) {
 }
 
 void PluginSorter::AddSpecificEdges() {
-  // Add edges for all relationships that aren't overlaps.
+  // Add edges for all relationships that aren't overlaps. Looking up the
+  // vertices of each plugin's masters, requirements and load after files
+  // doesn't depend on the edges in the graph, so it's done in parallel.
+  auto candidateEdges = GetCandidateEdges(
+      [this](const vertex_t& vertex, std::vector<CandidateEdge>& edges) {
+        for (const auto& parentVertex : masterVertices_[vertex]) {
+          edges.push_back({parentVertex, vertex, EdgeType::master});
+        }
+
+        auto addFileEdges = [&](const std::set<File>& files,
+                                EdgeType edgeType) {
+          for (const auto& file : files) {
+            auto parentVertex = GetVertexByName(file.GetName());
+            if (parentVertex.has_value()) {
+              edges.push_back({parentVertex.value(), vertex, edgeType});
+            }
+          }
+        };
+
+        addFileEdges(graph_[vertex].GetMasterlistRequirements(),
+                     EdgeType::masterlistRequirement);
+        addFileEdges(graph_[vertex].GetUserRequirements(),
+                     EdgeType::userRequirement);
+        addFileEdges(graph_[vertex].GetMasterlistLoadAfterFiles(),
+                     EdgeType::masterlistLoadAfter);
+        addFileEdges(graph_[vertex].GetUserLoadAfterFiles(),
+                     EdgeType::userLoadAfter);
+      });
+
+  // Master flag edges are cheap to find but there can be a lot of them, so
+  // they're found while adding the edges instead of being buffered.
   vertex_it vit, vitend;
-  for (tie(vit, vitend) = boost::vertices(graph_); vit != vitend; ++vit) {
+  for (boost::tie(vit, vitend) = boost::vertices(graph_); vit != vitend;
+       ++vit) {
     for (vertex_it vit2 = vit; vit2 != vitend; ++vit2) {
       if (graph_[*vit].IsMaster() == graph_[*vit2].IsMaster())
         continue;
@@ -427,37 +1361,8 @@ void PluginSorter::AddSpecificEdges() {
       AddEdge(parentVertex, vertex, EdgeType::masterFlag);
     }
 
-    for (const auto& master : graph_[*vit].GetMasters()) {
-      auto parentVertex = GetVertexByName(master);
-      if (parentVertex.has_value()) {
-        AddEdge(parentVertex.value(), *vit, EdgeType::master);
-      }
-    }
-
-    for (const auto& file : graph_[*vit].GetMasterlistRequirements()) {
-      auto parentVertex = GetVertexByName(file.GetName());
-      if (parentVertex.has_value()) {
-        AddEdge(parentVertex.value(), *vit, EdgeType::masterlistRequirement);
-      }
-    }
-    for (const auto& file : graph_[*vit].GetUserRequirements()) {
-      auto parentVertex = GetVertexByName(file.GetName());
-      if (parentVertex.has_value()) {
-        AddEdge(parentVertex.value(), *vit, EdgeType::userRequirement);
-      }
-    }
-
-    for (const auto& file : graph_[*vit].GetMasterlistLoadAfterFiles()) {
-      auto parentVertex = GetVertexByName(file.GetName());
-      if (parentVertex.has_value()) {
-        AddEdge(parentVertex.value(), *vit, EdgeType::masterlistLoadAfter);
-      }
-    }
-    for (const auto& file : graph_[*vit].GetUserLoadAfterFiles()) {
-      auto parentVertex = GetVertexByName(file.GetName());
-      if (parentVertex.has_value()) {
-        AddEdge(parentVertex.value(), *vit, EdgeType::userLoadAfter);
-      }
+    for (const auto& edge : candidateEdges[*vit]) {
+      AddEdge(edge.fromVertex, edge.toVertex, edge.edgeType);
     }
   }
 }
@@ -501,84 +1406,31 @@ void ignorePlugin(const std::string& pluginName,
   }
 }
 
-// Look for paths to targetGroupName from group. Don't pass visitedGroups by
-// reference as each after group should be able to record paths independently.
-std::unordered_set<std::string> pathfinder(
-    const Group& group,
-    const std::string& targetGroupName,
-    const std::unordered_set<Group>& groups,
-    std::unordered_set<std::string> visitedGroups) {
-  // If the current group is the target group, return the set of groups in the
-  // path leading to it.
-  if (group.GetName() == targetGroupName) {
-    return visitedGroups;
-  }
-
-  if (group.GetAfterGroups().empty()) {
-    return std::unordered_set<std::string>();
-  }
-
-  visitedGroups.insert(group.GetName());
-
-  // Call pathfinder on each after group. We want to find all paths, so merge
-  // all return values.
-  std::unordered_set<std::string> mergedVisitedGroups;
-  for (const auto& afterGroupName : group.GetAfterGroups()) {
-    auto afterGroup = *groups.find(Group(afterGroupName));
-
-    auto recursedVisitedGroups =
-        pathfinder(afterGroup, targetGroupName, groups, visitedGroups);
-
-    mergedVisitedGroups.insert(recursedVisitedGroups.begin(),
-                               recursedVisitedGroups.end());
-  }
-
-  // Return mergedVisitedGroups if it is empty, to indicate the current group's
-  // after groups had no path to the target group.
-  if (mergedVisitedGroups.empty()) {
-    return mergedVisitedGroups;
-  }
-
-  // If any after groups had paths to the target group, mergedVisitedGroups
-  // will be non-empty. To ensure that it contains full paths, merge it
-  // with visitedGroups and return that merged set.
-  visitedGroups.insert(mergedVisitedGroups.begin(), mergedVisitedGroups.end());
-
-  return visitedGroups;
-}
-
-std::unordered_set<std::string> getGroupsInPaths(
-    const std::unordered_set<Group>& groups,
-    const std::string& firstGroupName,
-    const std::string& lastGroupName) {
-  // Groups are linked in reverse order, i.e. firstGroup can be found from
-  // lastGroup, but not the other way around.
-  auto lastGroup = *groups.find(Group(lastGroupName));
-
-  auto groupsInPaths = pathfinder(
-      lastGroup, firstGroupName, groups, std::unordered_set<std::string>());
-
-  groupsInPaths.erase(lastGroupName);
-
-  return groupsInPaths;
-}
-
 void PluginSorter::AddGroupEdges() {
+  // Finding the after group plugins' vertices doesn't depend on the edges in
+  // the graph, so it can be done in parallel.
+  auto candidateEdges = GetCandidateEdges(
+      [this](const vertex_t& vertex, std::vector<CandidateEdge>& edges) {
+        const auto& afterVertices = afterGroupVertices_[vertexGroups_[vertex]];
+        for (auto parentVertex = afterVertices.find_first();
+             parentVertex != afterVertices.npos;
+             parentVertex = afterVertices.find_next(parentVertex)) {
+          edges.push_back({parentVertex, vertex, EdgeType::group});
+        }
+      });
+
   std::vector<std::pair<vertex_t, vertex_t>> acyclicEdgePairs;
   std::map<std::string, std::unordered_set<std::string>> groupPluginsToIgnore;
-  for (const vertex_t& vertex :
-       boost::make_iterator_range(boost::vertices(graph_))) {
-    for (const auto& pluginName : graph_[vertex].GetAfterGroupPlugins()) {
-      auto parentVertex = GetVertexByName(pluginName);
-      if (!parentVertex.has_value()) {
-        continue;
-      }
+  for (const auto& edges : candidateEdges) {
+    for (const auto& edge : edges) {
+      const auto& vertex = edge.toVertex;
+      const auto& parentVertex = edge.fromVertex;
 
-      if (EdgeCreatesCycle(parentVertex.value(), vertex)) {
-        auto& fromPlugin = graph_[parentVertex.value()];
+      if (EdgeCreatesCycle(parentVertex, vertex)) {
+        auto& fromPlugin = graph_[parentVertex];
         auto& toPlugin = graph_[vertex];
 
-        if (logger_) {
+        if (shouldLog(logger_, spdlog::level::trace)) {
           logger_->trace(
               "Skipping group edge from \"{}\" to \"{}\" as it would "
               "create a cycle.",
@@ -612,15 +1464,15 @@ void PluginSorter::AddGroupEdges() {
           continue;
         }
 
-        auto groupsInPaths = getGroupsInPaths(
-            groups_, fromPlugin.GetGroup(), toPlugin.GetGroup());
+        auto groupsInPaths = groupClosure_.value().GetGroupsInPaths(
+            fromPlugin.GetGroup(), toPlugin.GetGroup());
 
         ignorePlugin(pluginToIgnore, groupsInPaths, groupPluginsToIgnore);
 
         continue;
       }
 
-      acyclicEdgePairs.push_back(std::make_pair(parentVertex.value(), vertex));
+      acyclicEdgePairs.push_back(std::make_pair(parentVertex, vertex));
     }
   }
 
@@ -632,7 +1484,7 @@ void PluginSorter::AddGroupEdges() {
 
     if (!ignore) {
       AddEdge(edgePair.first, edgePair.second, EdgeType::group);
-    } else if (logger_) {
+    } else if (shouldLog(logger_, spdlog::level::trace)) {
       logger_->trace(
           "Skipping group edge from \"{}\" to \"{}\" as it would "
           "create a multi-group cycle.",
@@ -642,10 +1494,77 @@ void PluginSorter::AddGroupEdges() {
   }
 }
 
-void PluginSorter::AddOverlapEdges() {
-  vertex_it vit, vitend;
-  for (tie(vit, vitend) = boost::vertices(graph_); vit != vitend; ++vit) {
-    vertex_t vertex = *vit;
+void PluginSorter::AddOverlapEdges(GameType gameType) {
+  std::vector<vertex_t> vertices;
+  for (const auto& vertex :
+       boost::make_iterator_range(boost::vertices(graph_))) {
+    vertices.push_back(vertex);
+  }
+
+  // A plugin's FormIDs can only belong to the plugin itself or one of its
+  // masters, so two plugins' records can only overlap if they have one of
+  // these files in common. Index the plugins by those files so that pairs
+  // that have none in common can be skipped without asking esplugin to
+  // compare their records. Morrowind record IDs aren't namespaced by plugin,
+  // so this doesn't apply to it.
+  const bool useOriginsIndex = gameType != GameType::tes3;
+  std::vector<std::vector<std::string>> recordOrigins(vertices.size());
+  std::unordered_map<std::string, std::vector<size_t>> pluginsByRecordOrigin;
+  if (useOriginsIndex) {
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      const auto& plugin = graph_[vertices[i]];
+      recordOrigins[i].push_back(plugin.GetNormalizedName());
+      for (const auto& master : plugin.GetMasters()) {
+        recordOrigins[i].push_back(NormalizeFilename(master));
+      }
+
+      for (const auto& origin : recordOrigins[i]) {
+        pluginsByRecordOrigin[origin].push_back(i);
+      }
+    }
+  }
+
+  // Edges are only added between the pair of plugins being compared, so
+  // whether the loop below compares a pair can be decided before it starts.
+  const auto shouldCompare = [&](size_t i, size_t j) {
+    const auto& vertex = vertices[i];
+    const auto& otherVertex = vertices[j];
+    const auto numOverrideFormIDs = graph_[vertex].NumOverrideFormIDs();
+    return numOverrideFormIDs != 0 &&
+           numOverrideFormIDs != graph_[otherVertex].NumOverrideFormIDs() &&
+           !boost::edge(vertex, otherVertex, graph_).second &&
+           !boost::edge(otherVertex, vertex, graph_).second;
+  };
+
+  // Comparing records is read-only, so compare all the pairs that the loop
+  // will need in parallel first, and let the loop add edges in the same order
+  // as it would if it compared each pair itself.
+  std::vector<std::vector<std::string>> sortedRecordOrigins = recordOrigins;
+  for (auto& origins : sortedRecordOrigins) {
+    std::sort(origins.begin(), origins.end());
+  }
+  const auto overlaps =
+      OverlapMatrix::Compute(vertices.size(), [&](size_t i, size_t j) {
+        if (!shouldCompare(i, j) ||
+            (useOriginsIndex &&
+             !HaveCommonElement(sortedRecordOrigins[i],
+                                sortedRecordOrigins[j]))) {
+          return false;
+        }
+
+        auto storedOverlap = GetStoredOverlap(vertices[i], vertices[j]);
+        if (storedOverlap.has_value()) {
+          return storedOverlap.value();
+        }
+
+        return graph_[vertices[i]].DoFormIDsOverlap(graph_[vertices[j]]);
+      });
+
+  overlapChecks_ = 0;
+  size_t overlapComparisons = 0;
+  std::vector<bool> mayOverlap(vertices.size(), !useOriginsIndex);
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    vertex_t vertex = vertices[i];
 
     if (graph_[vertex].NumOverrideFormIDs() == 0) {
       if (logger_) {
@@ -657,15 +1576,29 @@ void PluginSorter::AddOverlapEdges() {
       continue;
     }
 
-    for (vertex_it vit2 = std::next(vit); vit2 != vitend; ++vit2) {
-      vertex_t otherVertex = *vit2;
+    if (useOriginsIndex) {
+      std::fill(mayOverlap.begin(), mayOverlap.end(), false);
+      for (const auto& origin : recordOrigins[i]) {
+        for (const auto& index : pluginsByRecordOrigin[origin]) {
+          mayOverlap[index] = true;
+        }
+      }
+    }
+
+    for (size_t j = i + 1; j < vertices.size(); ++j) {
+      vertex_t otherVertex = vertices[j];
 
-      if (vertex == otherVertex ||
-          boost::edge(vertex, otherVertex, graph_).second ||
-          boost::edge(otherVertex, vertex, graph_).second ||
-          graph_[vertex].NumOverrideFormIDs() ==
-              graph_[otherVertex].NumOverrideFormIDs() ||
-          !graph_[vertex].DoFormIDsOverlap(graph_[otherVertex])) {
+      if (!mayOverlap[j] || !shouldCompare(i, j)) {
+        continue;
+      }
+
+      overlapComparisons += 1;
+      const bool overlap = overlaps.Get(i, j);
+      if (!GetStoredOverlap(vertex, otherVertex).has_value()) {
+        StoreOverlap(vertex, otherVertex, overlap);
+      }
+
+      if (!overlap) {
         continue;
       }
 
@@ -683,48 +1616,178 @@ void PluginSorter::AddOverlapEdges() {
         AddEdge(fromVertex, toVertex, EdgeType::overlap);
     }
   }
+
+  if (logger_) {
+    logger_->debug(
+        "Compared the records of {} pairs of plugins, reusing the results "
+        "for {} pairs from the previous sort.",
+        overlapChecks_,
+        overlapComparisons - overlapChecks_);
+  }
+}
+
+void PluginSorter::RetainOverlapResults(
+    const std::set<std::shared_ptr<const Plugin>>& plugins) {
+  std::unordered_map<std::string, std::shared_ptr<const Plugin>>
+      currentPlugins;
+  for (const auto& plugin : plugins) {
+    currentPlugins.emplace(plugin->GetNormalizedName(), plugin);
+  }
+
+  for (auto it = overlapPlugins_.begin(); it != overlapPlugins_.end();) {
+    auto currentIt = currentPlugins.find(it->first);
+    if (currentIt != currentPlugins.end() && currentIt->second == it->second) {
+      ++it;
+      continue;
+    }
+
+    auto resultsIt = overlapResults_.find(it->first);
+    if (resultsIt != overlapResults_.end()) {
+      for (const auto& result : resultsIt->second) {
+        auto otherResultsIt = overlapResults_.find(result.first);
+        if (otherResultsIt != overlapResults_.end() &&
+            otherResultsIt != resultsIt) {
+          otherResultsIt->second.erase(it->first);
+        }
+      }
+      overlapResults_.erase(resultsIt);
+    }
+
+    it = overlapPlugins_.erase(it);
+  }
+
+  overlapPlugins_.insert(currentPlugins.begin(), currentPlugins.end());
 }
 
-int ComparePlugins(const PluginSortingData& plugin1,
-                   const PluginSortingData& plugin2) {
-  if (plugin1.GetLoadOrderIndex().has_value() &&
-      !plugin2.GetLoadOrderIndex().has_value()) {
-    return -1;
+bool PluginSorter::DoFormIDsOverlap(const vertex_t& vertex,
+                                    const vertex_t& otherVertex) {
+  auto storedOverlap = GetStoredOverlap(vertex, otherVertex);
+  if (storedOverlap.has_value()) {
+    return storedOverlap.value();
   }
 
-  if (!plugin1.GetLoadOrderIndex().has_value() &&
-      plugin2.GetLoadOrderIndex().has_value()) {
-    return 1;
+  bool overlap = graph_[vertex].DoFormIDsOverlap(graph_[otherVertex]);
+  StoreOverlap(vertex, otherVertex, overlap);
+
+  return overlap;
+}
+
+std::optional<bool> PluginSorter::GetStoredOverlap(
+    const vertex_t& vertex,
+    const vertex_t& otherVertex) const {
+  // Captured results are already stored by their plugins.
+  if (graph_[vertex].IsCaptured()) {
+    return std::nullopt;
   }
 
-  if (plugin1.GetLoadOrderIndex().has_value() &&
-      plugin2.GetLoadOrderIndex().has_value()) {
-    if (plugin1.GetLoadOrderIndex().value() <
-        plugin2.GetLoadOrderIndex().value()) {
-      return -1;
-    } else {
-      return 1;
+  const auto findResult =
+      [&](const std::unordered_map<std::string,
+                                   std::unordered_map<std::string, bool>>&
+              results) -> std::optional<bool> {
+    auto resultsIt = results.find(graph_[vertex].GetNormalizedName());
+    if (resultsIt == results.end()) {
+      return std::nullopt;
+    }
+
+    auto it = resultsIt->second.find(graph_[otherVertex].GetNormalizedName());
+    if (it == resultsIt->second.end()) {
+      return std::nullopt;
     }
+
+    return it->second;
+  };
+
+  auto result = findResult(overlapResults_);
+  if (!result.has_value() && sharedOverlapResults_ != nullptr) {
+    result = findResult(*sharedOverlapResults_);
   }
 
-  // Neither plugin has a load order position. Compare plugin basenames to
-  // get an ordering.
-  auto name1 = plugin1.GetName();
-  auto name2 = plugin2.GetName();
-  auto basename1 = name1.substr(0, name1.length() - 4);
-  auto basename2 = name2.substr(0, name2.length() - 4);
+  return result;
+}
+
+void PluginSorter::StoreOverlap(const vertex_t& vertex,
+                                const vertex_t& otherVertex,
+                                bool overlap) {
+  overlapChecks_ += 1;
+  if (graph_[vertex].IsCaptured()) {
+    return;
+  }
+
+  const auto& name = graph_[vertex].GetNormalizedName();
+  const auto& otherName = graph_[otherVertex].GetNormalizedName();
+  overlapResults_[name].emplace(otherName, overlap);
+  overlapResults_[otherName].emplace(name, overlap);
+}
+
+void PluginSorter::InitialiseTieBreakKeys() {
+  const size_t numVertices = boost::num_vertices(graph_);
+  tieBreakLoadOrderIndices_.assign(numVertices, NO_LOAD_ORDER_INDEX);
+  tieBreakBasenameRanks_.assign(numVertices, 0);
+  tieBreakExtensionRanks_.assign(numVertices, 0);
+
+  // Normalize each name once, so that ranking them only compares bytes.
+  std::vector<std::string> basenames;
+  std::vector<std::string> extensions;
+  basenames.reserve(numVertices);
+  extensions.reserve(numVertices);
+  for (const auto& vertex :
+       boost::make_iterator_range(boost::vertices(graph_))) {
+    const auto& plugin = graph_[vertex];
+    tieBreakLoadOrderIndices_[vertex] =
+        plugin.GetLoadOrderIndex().value_or(NO_LOAD_ORDER_INDEX);
+
+    // Plugin filenames end in a four-character extension.
+    const auto name = plugin.GetName();
+    const auto basenameLength = name.length() < 4 ? 0 : name.length() - 4;
+    basenames.push_back(NormalizeFilename(name.substr(0, basenameLength)));
+    extensions.push_back(NormalizeFilename(name.substr(basenameLength)));
+  }
+
+  // Give names that compare equal the same rank.
+  const auto rank = [&](const std::vector<std::string>& names,
+                        std::vector<uint32_t>& ranks) {
+    std::vector<vertex_t> order(numVertices);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](vertex_t lhs, vertex_t rhs) {
+      return CompareNormalizedFilenames(names[lhs], names[rhs]) < 0;
+    });
+
+    uint32_t currentRank = 0;
+    for (size_t i = 1; i < order.size(); ++i) {
+      if (CompareNormalizedFilenames(names[order[i - 1]], names[order[i]]) !=
+          0) {
+        ++currentRank;
+      }
+      ranks[order[i]] = currentRank;
+    }
+  };
+  rank(basenames, tieBreakBasenameRanks_);
+  rank(extensions, tieBreakExtensionRanks_);
+}
+
+int PluginSorter::CompareTieBreakKeys(const vertex_t& vertex,
+                                      const vertex_t& otherVertex) const {
+  const auto compare = [](auto lhs, auto rhs) {
+    return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+  };
 
-  int result = CompareFilenames(basename1, basename2);
+  // Plugins with load order positions come first, in that order, and only
+  // plugins without one are ordered by name.
+  int result = compare(tieBreakLoadOrderIndices_[vertex],
+                       tieBreakLoadOrderIndices_[otherVertex]);
+  if (result != 0) {
+    return result;
+  }
 
+  // A .esp and .esm plugin may have the same basename.
+  result = compare(tieBreakBasenameRanks_[vertex],
+                   tieBreakBasenameRanks_[otherVertex]);
   if (result != 0) {
     return result;
-  } else {
-    // Could be a .esp and .esm plugin with the same basename,
-    // compare their extensions.
-    auto ext1 = name1.substr(name1.length() - 4);
-    auto ext2 = name2.substr(name2.length() - 4);
-    return CompareFilenames(ext1, ext2);
   }
+
+  return compare(tieBreakExtensionRanks_[vertex],
+                 tieBreakExtensionRanks_[otherVertex]);
 }
 
 void PluginSorter::AddTieBreakEdges() {
@@ -733,14 +1796,15 @@ void PluginSorter::AddTieBreakEdges() {
   // that aren't already linked. Use existing load order to decide the direction
   // of these edges.
   vertex_it vit, vitend;
-  for (tie(vit, vitend) = boost::vertices(graph_); vit != vitend; ++vit) {
+  for (boost::tie(vit, vitend) = boost::vertices(graph_); vit != vitend;
+       ++vit) {
     vertex_t vertex = *vit;
 
     for (vertex_it vit2 = std::next(vit); vit2 != vitend; ++vit2) {
       vertex_t otherVertex = *vit2;
 
       vertex_t toVertex, fromVertex;
-      if (ComparePlugins(graph_[vertex], graph_[otherVertex]) < 0) {
+      if (CompareTieBreakKeys(vertex, otherVertex) < 0) {
         fromVertex = vertex;
         toVertex = otherVertex;
       } else {
@@ -753,4 +1817,233 @@ void PluginSorter::AddTieBreakEdges() {
     }
   }
 }
+
+std::optional<EdgeType> PluginSorter::GetSpecificEdgeType(
+    const vertex_t& fromVertex,
+    const vertex_t& toVertex,
+    GameType gameType,
+    const HardcodedPluginData& hardcodedPlugins) const {
+  const auto& fromPlugin = graph_[fromVertex];
+  const auto& toPlugin = graph_[toVertex];
+
+  const auto& implicitlyActivePlugins =
+      hardcodedPlugins.implicitlyActivePlugins;
+  const auto implicitlyActiveIndex =
+      hardcodedPlugins.implicitlyActiveIndices[fromVertex];
+  if (implicitlyActiveIndex < implicitlyActivePlugins.size() &&
+      !(gameType == GameType::tes5 &&
+        loot::equivalent(implicitlyActivePlugins[implicitlyActiveIndex],
+                         "update.esm")) &&
+      hardcodedPlugins.verticesInDataDirectory[toVertex] &&
+      hardcodedPlugins.implicitlyActiveIndices[toVertex] >
+          implicitlyActiveIndex) {
+    return EdgeType::hardcoded;
+  }
+
+  if (fromPlugin.IsMaster() && !toPlugin.IsMaster()) {
+    return EdgeType::masterFlag;
+  }
+
+  for (const auto& master : toPlugin.GetMasters()) {
+    if (NormalizeFilename(master) == fromPlugin.GetNormalizedName()) {
+      return EdgeType::master;
+    }
+  }
+
+  const File file(fromPlugin.GetName());
+  if (toPlugin.GetMasterlistRequirements().count(file) != 0) {
+    return EdgeType::masterlistRequirement;
+  }
+  if (toPlugin.GetUserRequirements().count(file) != 0) {
+    return EdgeType::userRequirement;
+  }
+  if (toPlugin.GetMasterlistLoadAfterFiles().count(file) != 0) {
+    return EdgeType::masterlistLoadAfter;
+  }
+  if (toPlugin.GetUserLoadAfterFiles().count(file) != 0) {
+    return EdgeType::userLoadAfter;
+  }
+
+  return std::nullopt;
+}
+
+bool PluginSorter::IsInEarlierGroup(const vertex_t& vertex,
+                                    const vertex_t& otherVertex) const {
+  return groupClosure_.value()
+      .GetAfterGroups(vertexGroups_[otherVertex])
+      .test(vertexGroups_[vertex]);
+}
+
+void PluginSorter::PlaceVertex(const vertex_t& vertex,
+                               std::vector<vertex_t>& order,
+                               GameType gameType,
+                               const HardcodedPluginData& hardcodedPlugins) {
+  const auto& plugin = graph_[vertex];
+
+  // The vertex can be inserted at any position from lower to upper
+  // inclusive, where inserting at a position puts it before the vertex that
+  // is currently at that position. Each kind of constraint narrows the range
+  // in turn, and is skipped if it would leave no valid position.
+  size_t lower = 0;
+  size_t upper = order.size();
+
+  // Specific edges can't be skipped, as the full sort would fail if they
+  // formed a cycle. Remember which vertices set the bounds so that a cycle
+  // can be reported.
+  size_t lowerVertexIndex = 0;
+  EdgeType lowerEdgeType = EdgeType::hardcoded;
+  EdgeType upperEdgeType = EdgeType::hardcoded;
+  for (size_t i = 0; i < order.size(); ++i) {
+    auto edgeType =
+        GetSpecificEdgeType(order[i], vertex, gameType, hardcodedPlugins);
+    if (edgeType.has_value()) {
+      lower = i + 1;
+      lowerVertexIndex = i;
+      lowerEdgeType = edgeType.value();
+    }
+
+    if (i < upper) {
+      edgeType =
+          GetSpecificEdgeType(vertex, order[i], gameType, hardcodedPlugins);
+      if (edgeType.has_value()) {
+        upper = i;
+        upperEdgeType = edgeType.value();
+      }
+    }
+  }
+
+  if (lower > upper) {
+    if (logger_) {
+      logger_->error(
+          "\"{}\" must load after \"{}\" and before \"{}\", which load in "
+          "the opposite order.",
+          plugin.GetName(),
+          graph_[order[lowerVertexIndex]].GetName(),
+          graph_[order[upper]].GetName());
+    }
+    throw CyclicInteractionError(std::vector<Vertex>({
+        Vertex(plugin.GetName(), upperEdgeType),
+        Vertex(graph_[order[upper]].GetName()),
+        Vertex(graph_[order[lowerVertexIndex]].GetName(), lowerEdgeType),
+    }));
+  }
+
+  // The functions check if the given vertex must load before or after the
+  // vertex being placed.
+  const auto narrow = [&](const std::string& constraint,
+                          const std::function<bool(const vertex_t&)>&
+                              mustLoadBefore,
+                          const std::function<bool(const vertex_t&)>&
+                              mustLoadAfter) {
+    auto newLower = lower;
+    auto newUpper = upper;
+    for (size_t i = lower; i < upper; ++i) {
+      if (mustLoadBefore(order[i])) {
+        newLower = i + 1;
+      } else if (newUpper == upper && mustLoadAfter(order[i])) {
+        newUpper = i;
+      }
+    }
+
+    if (newLower <= newUpper) {
+      lower = newLower;
+      upper = newUpper;
+    } else if (logger_) {
+      logger_->debug(
+          "Ignoring the {} of \"{}\" as the existing load order conflicts "
+          "with them.",
+          constraint,
+          plugin.GetName());
+    }
+  };
+
+  narrow(
+      "groups",
+      [&](const vertex_t& other) { return IsInEarlierGroup(other, vertex); },
+      [&](const vertex_t& other) { return IsInEarlierGroup(vertex, other); });
+
+  // As in AddOverlapEdges(), the plugin that overrides more records loads
+  // first.
+  const auto numOverrideFormIDs = plugin.NumOverrideFormIDs();
+  const auto overlaps = [&](const vertex_t& other) {
+    const auto& otherPlugin = graph_[other];
+    return numOverrideFormIDs != otherPlugin.NumOverrideFormIDs() &&
+           plugin.GetPlugin()->MayFormIDsOverlap(*otherPlugin.GetPlugin()) &&
+           DoFormIDsOverlap(vertex, other);
+  };
+  narrow(
+      "record overlaps",
+      [&](const vertex_t& other) {
+        return graph_[other].NumOverrideFormIDs() > numOverrideFormIDs &&
+               overlaps(other);
+      },
+      [&](const vertex_t& other) {
+        return graph_[other].NumOverrideFormIDs() < numOverrideFormIDs &&
+               overlaps(other);
+      });
+
+  // Use the position of the first plugin that the tie-break order puts after
+  // this one.
+  auto position = upper;
+  for (size_t i = lower; i < upper; ++i) {
+    if (CompareTieBreakKeys(vertex, order[i]) < 0) {
+      position = i;
+      break;
+    }
+  }
+
+  if (logger_) {
+    logger_->trace("Placing \"{}\" at position {} of {}.",
+                   plugin.GetName(),
+                   position,
+                   order.size());
+  }
+
+  order.insert(order.begin() + position, vertex);
+}
+
+std::list<vertex_t> PluginSorter::LexicographicalTopologicalSort() const {
+  // Kahn's algorithm, using a min-heap of the vertices that are ready to be
+  // sorted.
+  auto comparator = [&](const vertex_t& lhs, const vertex_t& rhs) {
+    return CompareTieBreakKeys(lhs, rhs) > 0;
+  };
+  std::priority_queue<vertex_t, std::vector<vertex_t>, decltype(comparator)>
+      candidates(comparator);
+
+  // The graph only stores out-edges, so count each vertex's in-edges first.
+  std::vector<size_t> unsortedInEdges(boost::num_vertices(graph_));
+  edge_it eit, eitend;
+  for (boost::tie(eit, eitend) = boost::edges(graph_); eit != eitend; ++eit) {
+    unsortedInEdges[boost::target(*eit, graph_)] += 1;
+  }
+
+  vertex_it vit, vitend;
+  for (boost::tie(vit, vitend) = boost::vertices(graph_); vit != vitend;
+       ++vit) {
+    if (unsortedInEdges[*vit] == 0) {
+      candidates.push(*vit);
+    }
+  }
+
+  std::list<vertex_t> sortedVertices;
+  while (!candidates.empty()) {
+    auto vertex = candidates.top();
+    candidates.pop();
+    sortedVertices.push_back(vertex);
+
+    boost::graph_traits<PluginGraph>::out_edge_iterator oit, oitend;
+    for (boost::tie(oit, oitend) = boost::out_edges(vertex, graph_);
+         oit != oitend;
+         ++oit) {
+      auto target = boost::target(*oit, graph_);
+      unsortedInEdges[target] -= 1;
+      if (unsortedInEdges[target] == 0) {
+        candidates.push(target);
+      }
+    }
+  }
+
+  return sortedVertices;
+}
 }
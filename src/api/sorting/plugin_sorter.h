@@ -27,84 +27,381 @@
 
 #define FMT_NO_FMT_STRING_ALIAS
 
+#include <atomic>
+#include <functional>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
 
 #include <spdlog/spdlog.h>
-#include <boost/container_hash/hash.hpp>
+#include <boost/dynamic_bitset.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
 
 #include "api/game/game.h"
+#include "api/helpers/memory_resource.h"
 #include "api/plugin.h"
+#include "api/sorting/group_sort.h"
 #include "api/sorting/plugin_sorting_data.h"
+#include "api/sorting/sort_capture.h"
+#include "api/sorting/sorted_plugin_graph.h"
+#include "loot/cancellation_token.h"
+#include "loot/enum/tie_break_mode.h"
 #include "loot/exception/cyclic_interaction_error.h"
+#include "loot/struct/operation_progress.h"
+#include "loot/struct/sort_profile.h"
+#include "loot/struct/sort_statistics.h"
 
 namespace loot {
-typedef boost::adjacency_list<boost::listS,
-                              boost::listS,
-                              boost::bidirectionalS,
-                              PluginSortingData,
-                              EdgeType>
+// Vertices are stored contiguously so that vertex descriptors are dense
+// integer indices, which also serve as the graph's vertex index map. Vertices
+// are never removed, so descriptors remain valid as the graph is built.
+// Each edge is stored as just its target in its source's out-edge vector:
+// edge properties and bidirectional graphs would each need a separately
+// allocated node per edge, so edge types are stored outside the graph.
+typedef boost::adjacency_list<boost::vecS,
+                              boost::vecS,
+                              boost::directedS,
+                              PluginSortingData>
     PluginGraph;
 typedef boost::graph_traits<PluginGraph>::vertex_descriptor vertex_t;
-typedef boost::associative_property_map<std::map<vertex_t, size_t>>
-    vertex_map_t;
 
 std::string describeEdgeType(EdgeType edgeType);
 
-struct GraphPath {
-  GraphPath(vertex_t from, vertex_t to) : from(from), to(to) {}
+// A sorter keeps the results of comparing plugins' records between calls to
+// Sort(), so that sorting again after a change only compares the records of
+// plugins that have been loaded since the last sort. The plugin graph is still
+// built from scratch each time, so the result is the same as that of a new
+// sorter.
+//
+// It also keeps the results of its most recent sorts of a game's plugins,
+// keyed on everything that the sort reads, so sorting the same inputs again
+// reuses the earlier result instead of building the plugin graph.
+class PluginSorter {
+public:
+  // Throws OperationCancelledError if the token is cancelled before a sorting
+  // phase starts, and reports each phase to the callback as it starts.
+  std::vector<std::string> Sort(
+      Game& game,
+      const CancellationToken& cancellationToken = CancellationToken(),
+      const ProgressCallback& progressCallback = ProgressCallback());
 
-  bool operator==(const GraphPath& rhs) const {
-    return this->from == rhs.from && this->to == rhs.to;
-  }
+  // Sorts using the captured data instead of a game, giving the same result as
+  // the captured sort. Captured overlap results aren't kept for later sorts.
+  std::vector<std::string> Sort(
+      const SortCapture& capture,
+      const CancellationToken& cancellationToken = CancellationToken(),
+      const ProgressCallback& progressCallback = ProgressCallback());
 
-  vertex_t from;
-  vertex_t to;
-};
-}
+  // Inserts the new plugins into the given load order without changing the
+  // order of the plugins already in it, as described for
+  // GameInterface::SortNewPlugins(). All the given plugins must be loaded.
+  std::vector<std::string> SortNewPlugins(
+      Game& game,
+      const std::vector<std::string>& loadOrder,
+      const std::vector<std::string>& newPlugins);
 
-namespace std {
-template<>
-struct hash<loot::GraphPath> {
-  size_t operator()(const loot::GraphPath& graphPath) const {
-    size_t seed = 0;
-    boost::hash_combine(seed, graphPath.from);
-    boost::hash_combine(seed, graphPath.to);
+  // Sorts each profile's loaded plugins as described for
+  // GameInterface::SortProfiles(). Each profile is sorted concurrently by a
+  // separate sorter that reads this sorter's overlap results, and the results
+  // that they calculate are stored here once they have all finished, so pairs
+  // of plugins that no earlier sort compared may be compared once for each
+  // profile that they're both in. Doesn't change the statistics, the cached
+  // sort results or the graph used by GetPluginsPath().
+  std::vector<std::vector<std::string>> SortProfiles(
+      Game& game,
+      const std::vector<SortProfile>& profiles);
 
-    return seed;
-  }
-};
-}
+  // Sorts the game's loaded plugins and captures the data that the sort read,
+  // so that it can be replayed. If the sort fails because of a cycle or an
+  // undefined group, the capture is still returned, as replaying it will fail
+  // in the same way.
+  SortCapture Capture(Game& game);
 
-namespace loot {
-class PluginSorter {
-public:
-  std::vector<std::string> Sort(Game& game);
+  // The statistics for the most recent call to Sort().
+  const SortStatistics& GetStatistics() const;
+
+  // Gets the shortest path between two plugins in the plugin graph of the
+  // most recent call to Sort(), as described for SortedPluginGraph::GetPath().
+  // Throws std::invalid_argument if either plugin was not sorted, including
+  // if the most recent sort failed or the graph has been trimmed. It may be
+  // called while a sort is running, and answers for the previous sort until
+  // that sort completes.
+  std::vector<Vertex> GetPluginsPath(const std::string& fromPluginName,
+                                     const std::string& toPluginName) const;
+
+  // Sets the tie-break mode used by subsequent calls to Sort(). It may be
+  // called while a sort is running, and won't affect that sort.
+  void SetTieBreakMode(TieBreakMode mode);
+
+  // Sets whether subsequent calls to Sort() check that the sorted order
+  // respects every edge in the plugin graph, recording any edges that it
+  // doesn't in the statistics.
+  void SetValidationEnabled(bool enabled);
+
+  // An estimate of the memory used by the plugin graph, the stored overlap
+  // results and the cached sort results, in bytes. Must not be called while
+  // a sort is running.
+  size_t GetMemoryUsage() const;
+
+  // Frees the plugin graph left by the last sort, its sorted copy and the
+  // cached sort results.
+  // Overlap results are kept, as recalculating them would mean comparing the
+  // records of every pair of plugins again. Must not be called while a sort
+  // is running.
+  void Trim();
+
+  // Sets the memory resource that the plugin graph's reachability sets, group
+  // membership sets and edge types are allocated from. If it is null, they're
+  // allocated from the global memory resource. It may be called while a sort
+  // is running, and won't affect that sort's existing allocations.
+  void SetMemoryResource(pmr::memory_resource* resource);
 
 private:
+  // A set of vertices, indexed by vertex.
+  typedef boost::dynamic_bitset<unsigned long,
+                                pmr::polymorphic_allocator<unsigned long>>
+      VertexSet;
+
+  // Creates an empty vertex set that can hold the given number of vertices,
+  // allocated from the sorter's memory resource.
+  VertexSet CreateVertexSet(size_t numVertices) const;
+
+  struct CandidateEdge {
+    vertex_t fromVertex;
+    vertex_t toVertex;
+    EdgeType edgeType;
+  };
+
+  // The metadata of each of a list of plugins, in the same order.
+  struct PluginsMetadata {
+    std::vector<std::optional<PluginMetadata>> masterlistMetadata;
+    std::vector<std::optional<PluginMetadata>> userMetadata;
+  };
+
+  struct CachedSort {
+    std::string key;
+    std::vector<std::string> plugins;
+    SortStatistics statistics;
+    std::shared_ptr<const SortedPluginGraph> sortedGraph;
+  };
+
+  // Runs the sorting phases, using the given functions to read the plugins and
+  // data directory.
+  std::vector<std::string> Sort(
+      GameType gameType,
+      const std::function<void()>& addPluginVertices,
+      const std::function<HardcodedPluginData()>& getHardcodedPluginData,
+      const CancellationToken& cancellationToken,
+      const ProgressCallback& progressCallback);
+
+  // Clears the plugin graph and the data kept alongside it, and sets up the
+  // state used by RunPhase().
+  void ResetGraph(const CancellationToken& cancellationToken,
+                  const ProgressCallback& progressCallback);
+
+  // Runs the given function as a sorting phase, recording its statistics.
+  void RunPhase(const std::string& name, const std::function<void()>& phase);
+
+  // Serialises every input to the sort once the plugin vertices have been
+  // added, so that sorts with equal keys give equal results. Returns nullopt
+  // if the vertices were added from a capture, which isn't cached.
+  std::optional<std::string> GetSortKey(
+      GameType gameType,
+      const HardcodedPluginData& hardcodedPlugins,
+      TieBreakMode tieBreakMode,
+      bool validationEnabled) const;
+
   std::optional<vertex_t> GetVertexByName(const std::string& name) const;
+  // Looks up the vertices of the vertex's plugin's masters by filename.
+  std::vector<vertex_t> GetMasterVerticesByName(const vertex_t& vertex) const;
   void CheckForCycles() const;
   bool EdgeCreatesCycle(const vertex_t& u, const vertex_t& v);
+  bool PathExists(const vertex_t& fromVertex, const vertex_t& toVertex);
 
   void AddPluginVertices(Game& game);
+  // Adds the plugins at the given indices in the list as vertices, in the
+  // order given, using the metadata at the same indices and the given
+  // function to look up each plugin's load order position by filename.
+  void AddPluginVertices(
+      Game& game,
+      const std::vector<std::shared_ptr<const Plugin>>& plugins,
+      const PluginsMetadata& metadata,
+      const std::vector<size_t>& indices,
+      const std::function<std::optional<size_t>(const std::string&)>&
+          getLoadOrderIndex);
+  static PluginsMetadata GetPluginsMetadata(
+      Game& game,
+      const std::vector<std::shared_ptr<const Plugin>>& plugins);
+  void AddPluginVertices(const SortCapture& capture);
+  // Sets up the data that is stored for each vertex once all the vertices
+  // have been added. Throws if a plugin's group is undefined.
+  void InitialiseVertexData(const std::unordered_set<Group>& masterlistGroups,
+                            const std::unordered_set<Group>& userGroups);
+  // Ranks the vertices' plugins for tie-breaking. Called by
+  // InitialiseVertexData().
+  void InitialiseTieBreakKeys();
+  // Compares two vertices' plugins for tie-breaking, returning -1, 0 or 1.
+  // Plugins with load order positions come first, in that order, followed by
+  // the other plugins in case-insensitive order of their basenames, then of
+  // their extensions.
+  int CompareTieBreakKeys(const vertex_t& vertex,
+                          const vertex_t& otherVertex) const;
   void AddSpecificEdges();
-  void AddHardcodedPluginEdges(Game& game);
+  HardcodedPluginData GetHardcodedPluginData(Game& game) const;
+  void AddHardcodedPluginEdges(GameType gameType,
+                               const HardcodedPluginData& hardcodedPlugins);
   void AddGroupEdges();
-  void AddOverlapEdges();
+  void AddOverlapEdges(GameType gameType);
   void AddTieBreakEdges();
 
+  // Gets the type of the edge that the plugin graph would have from one
+  // vertex to the other because of their masters, master flags, hardcoded
+  // positions, requirements or load after metadata, if any. Doesn't check
+  // the opposite direction.
+  std::optional<EdgeType> GetSpecificEdgeType(
+      const vertex_t& fromVertex,
+      const vertex_t& toVertex,
+      GameType gameType,
+      const HardcodedPluginData& hardcodedPlugins) const;
+  // Checks if one vertex's plugin is in a group that the other's loads after.
+  bool IsInEarlierGroup(const vertex_t& vertex,
+                        const vertex_t& otherVertex) const;
+  // Inserts the new vertex into the order, which holds every vertex that has
+  // already been placed.
+  void PlaceVertex(const vertex_t& vertex,
+                   std::vector<vertex_t>& order,
+                   GameType gameType,
+                   const HardcodedPluginData& hardcodedPlugins);
+
+  // A topological sort that picks the candidate that compares first with
+  // CompareTieBreakKeys() whenever there is more than one vertex with no unsorted
+  // predecessors. The graph must be acyclic.
+  std::list<vertex_t> LexicographicalTopologicalSort() const;
+
+  // Calls func for each vertex, using the shared thread pool if there are
+  // enough vertices. func must not modify the graph, and must only write to
+  // data that belongs to the vertex that it is given.
+  void ForEachVertex(const std::function<void(const vertex_t&)>& func) const;
+
+  // Calls getEdges for each vertex to find the candidate edges for that
+  // vertex, using ForEachVertex(). The results are indexed by vertex so that
+  // they can be added in the same order as if they had been found serially.
+  std::vector<std::vector<CandidateEdge>> GetCandidateEdges(
+      const std::function<void(const vertex_t&, std::vector<CandidateEdge>&)>&
+          getEdges) const;
+
+  // Copies the plugin graph with its vertices in the given sorted order.
+  std::shared_ptr<const SortedPluginGraph> CreateSortedGraph(
+      const std::list<vertex_t>& sortedVertices) const;
+  void SetSortedGraph(std::shared_ptr<const SortedPluginGraph> sortedGraph);
+
+  // Records any edges that the given order doesn't respect in the statistics.
+  void ValidateSortedOrder(const std::list<vertex_t>& sortedVertices);
+
   void AddEdge(const vertex_t& fromVertex,
                const vertex_t& toVertex,
                EdgeType edgeType);
+  EdgeType GetEdgeType(const vertex_t& fromVertex,
+                       const vertex_t& toVertex) const;
+  // An estimate of the memory used by the graph and the data kept alongside
+  // it, not including memory owned by the vertices' plugin data.
+  size_t GetGraphMemoryUsage() const;
+
+  // Discards overlap results for plugins that are no longer loaded or that
+  // have been reloaded.
+  void RetainOverlapResults(
+      const std::set<std::shared_ptr<const Plugin>>& plugins);
+  bool DoFormIDsOverlap(const vertex_t& vertex, const vertex_t& otherVertex);
+  // Gets the result stored by an earlier comparison of the two plugins'
+  // records, if there is one. Captured plugins' results aren't stored here.
+  std::optional<bool> GetStoredOverlap(const vertex_t& vertex,
+                                       const vertex_t& otherVertex) const;
+  // Counts a comparison of the two plugins' records and stores its result.
+  void StoreOverlap(const vertex_t& vertex,
+                    const vertex_t& otherVertex,
+                    bool overlap);
 
   PluginGraph graph_;
-  std::map<vertex_t, size_t> indexMap_;
-  vertex_map_t vertexIndexMap_;
+  // Maps normalised plugin filenames to their vertices.
+  std::unordered_map<std::string, vertex_t> vertexIds_;
+  // For each vertex, the vertices of its plugin's masters that are being
+  // sorted, in the order the plugin lists them. They're resolved when the
+  // vertices are added, using the game cache's master index if there is one.
+  std::vector<std::vector<vertex_t>> masterVertices_;
   std::shared_ptr<spdlog::logger> logger_;
-  std::unordered_set<Group> groups_;
+  // Kept between sorts and only rebuilt when the groups change.
+  std::optional<GroupClosure> groupClosure_;
+  // Incremented each time groupClosure_ is rebuilt, so that sort keys can
+  // identify the groups without serialising them.
+  size_t groupClosureVersion_ = 0;
+  // For each vertex, the index of its plugin's group in groupClosure_.
+  std::vector<size_t> vertexGroups_;
+  // The tie-break keys of each vertex's plugin, as arrays indexed by vertex,
+  // so that comparing two plugins is a few integer comparisons instead of
+  // comparing their filenames. Plugins with no load order position have the
+  // largest index. The ranks order the plugins' basenames and extensions as
+  // CompareFilenames() does, and names that compare equal have equal ranks.
+  std::vector<size_t> tieBreakLoadOrderIndices_;
+  std::vector<uint32_t> tieBreakBasenameRanks_;
+  std::vector<uint32_t> tieBreakExtensionRanks_;
+  // For each group, indexed as in groupClosure_, the set of vertices whose
+  // plugins are in groups that it transitively loads after. It's shared by
+  // all the vertices in the group, and is empty if the group has no plugins.
+  std::vector<VertexSet> afterGroupVertices_;
+
+  // For each vertex, the types of its out-edges, in the same order as the
+  // graph stores them, each packed into a single byte.
+  std::vector<PolymorphicVector<uint8_t>> edgeTypes_;
+
+  // For each vertex, the sets of vertices that can be reached from it and
+  // that it can be reached from. They are updated as each edge is added, so
+  // that checking for a path between two vertices is a single lookup.
+  std::vector<VertexSet> descendants_;
+  std::vector<VertexSet> ancestors_;
+
+  std::atomic<pmr::memory_resource*> memoryResource_{nullptr};
+
+  // The plugins that the stored overlap results were calculated for, keyed
+  // by normalised filename.
+  std::unordered_map<std::string, std::shared_ptr<const Plugin>>
+      overlapPlugins_;
+  // Whether two plugins' records overlap, keyed by one plugin's normalised
+  // filename and then the other's. Each result is stored under both plugins.
+  std::unordered_map<std::string, std::unordered_map<std::string, bool>>
+      overlapResults_;
+  // Overlap results that are read as well as overlapResults_, but never
+  // written, or null. They're those of the sorter that is sorting profiles
+  // using this one.
+  const std::unordered_map<std::string, std::unordered_map<std::string, bool>>*
+      sharedOverlapResults_ = nullptr;
+  // The number of pairs of plugins whose records were compared during the
+  // current sort.
+  size_t overlapChecks_ = 0;
+
+  // The results of the most recent sorts, most recent first.
+  std::list<CachedSort> cachedSorts_;
+
+  // The graph of the most recent successful sort, or null if the most recent
+  // sort failed or sorted no plugins. It's replaced rather than modified, and
+  // the mutex is only held to access the pointer.
+  std::shared_ptr<const SortedPluginGraph> sortedGraph_;
+  mutable std::mutex sortedGraphMutex_;
+
+  std::atomic<TieBreakMode> tieBreakMode_{TieBreakMode::edges};
+  std::atomic<bool> validationEnabled_{false};
+  // The number of phases that the current sort runs.
+  size_t numPhases_ = 0;
+
+  CancellationToken cancellationToken_;
+  ProgressCallback progressCallback_;
 
-  std::unordered_set<GraphPath> pathsCache_;
+  SortStatistics statistics_;
+  // The statistics for the phase that is currently running.
+  SortPhaseStatistics phaseStatistics_;
 };
 }
 
@@ -24,22 +24,38 @@
 
 #include "plugin_sorting_data.h"
 
-#include <boost/algorithm/string.hpp>
 #include <boost/locale.hpp>
 
 #include <loot/metadata/group.h>
+
 #include "api/helpers/text.h"
 
 namespace loot {
+namespace {
+std::set<File> ToFiles(const std::vector<std::string>& filenames) {
+  std::set<File> files;
+  for (const auto& filename : filenames) {
+    files.insert(File(filename));
+  }
+
+  return files;
+}
+}
+
+PluginSortingData::PluginSortingData() :
+    plugin_(nullptr), capturedPlugin_(nullptr) {}
+
 PluginSortingData::PluginSortingData(const Plugin& plugin,
                                      const PluginMetadata& masterlistMetadata,
     const PluginMetadata& userMetadata,
-    const std::vector<std::string>& loadOrder) :
-    plugin_(plugin),
+    const std::optional<size_t>& loadOrderIndex) :
+    plugin_(&plugin),
+    capturedPlugin_(nullptr),
     masterlistLoadAfter_(masterlistMetadata.GetLoadAfterFiles()),
     userLoadAfter_(userMetadata.GetLoadAfterFiles()),
     masterlistReq_(masterlistMetadata.GetRequirements()),
-    userReq_(userMetadata.GetRequirements()) {
+    userReq_(userMetadata.GetRequirements()),
+    loadOrderIndex_(loadOrderIndex) {
   if (userMetadata.GetGroup()) {
     group_ = userMetadata.GetGroup().value();
   } else if (masterlistMetadata.GetGroup()) {
@@ -47,47 +63,62 @@ PluginSortingData::PluginSortingData(const Plugin& plugin,
   } else {
     group_ = Group().GetName();
   }
+}
 
-  for (size_t i = 0; i < loadOrder.size(); i++) {
-    if (CompareFilenames(GetName(), loadOrder[i]) == 0) {
-      loadOrderIndex_ = i;
-    }
-  }
+PluginSortingData::PluginSortingData(const SortCapture::Plugin& plugin) :
+    plugin_(nullptr),
+    capturedPlugin_(&plugin),
+    group_(plugin.group),
+    masterlistLoadAfter_(ToFiles(plugin.masterlistLoadAfterFiles)),
+    userLoadAfter_(ToFiles(plugin.userLoadAfterFiles)),
+    masterlistReq_(ToFiles(plugin.masterlistRequirements)),
+    userReq_(ToFiles(plugin.userRequirements)),
+    loadOrderIndex_(plugin.loadOrderIndex) {}
+
+std::string PluginSortingData::GetName() const {
+  return capturedPlugin_ ? capturedPlugin_->name : plugin_->GetName();
 }
 
-std::string PluginSortingData::GetName() const { return plugin_.GetName(); }
+const std::string& PluginSortingData::GetNormalizedName() const {
+  return capturedPlugin_ ? capturedPlugin_->normalizedName
+                         : plugin_->GetNormalizedName();
+}
 
 bool PluginSortingData::IsMaster() const {
-  return plugin_.IsMaster() || (plugin_.IsLightMaster() &&
-                                !boost::iends_with(plugin_.GetName(), ".esp"));
+  if (capturedPlugin_) {
+    return capturedPlugin_->isMaster;
+  }
+
+  return plugin_->IsMaster() ||
+         (plugin_->IsLightMaster() &&
+          !EndsWithIgnoringAsciiCase(plugin_->GetName(), ".esp"));
 }
 
-bool PluginSortingData::LoadsArchive() const { return plugin_.LoadsArchive(); }
+bool PluginSortingData::LoadsArchive() const {
+  return capturedPlugin_ ? capturedPlugin_->loadsArchive
+                         : plugin_->LoadsArchive();
+}
 
-std::vector<std::string> PluginSortingData::GetMasters() const {
-  return plugin_.GetMasters();
+const std::vector<std::string>& PluginSortingData::GetMasters() const {
+  return capturedPlugin_ ? capturedPlugin_->masters : plugin_->GetMastersRef();
 }
 
 size_t PluginSortingData::NumOverrideFormIDs() const {
-  return plugin_.NumOverrideFormIDs();
+  return capturedPlugin_ ? capturedPlugin_->numOverrideFormIDs
+                         : plugin_->NumOverrideFormIDs();
 }
 
 bool PluginSortingData::DoFormIDsOverlap(
     const PluginSortingData& plugin) const {
-  return plugin_.DoFormIDsOverlap(plugin.plugin_);
-}
-
-std::string PluginSortingData::GetGroup() const { return group_; }
+  if (capturedPlugin_) {
+    return capturedPlugin_->overlappingPlugins.count(
+               plugin.GetNormalizedName()) != 0;
+  }
 
-std::unordered_set<std::string> PluginSortingData::GetAfterGroupPlugins()
-    const {
-  return afterGroupPlugins_;
+  return plugin_->DoFormIDsOverlap(*plugin.plugin_);
 }
 
-void PluginSortingData::SetAfterGroupPlugins(
-    std::unordered_set<std::string> plugins) {
-  afterGroupPlugins_ = plugins;
-}
+std::string PluginSortingData::GetGroup() const { return group_; }
 
 const std::set<File>& PluginSortingData::GetMasterlistLoadAfterFiles() const {
   return masterlistLoadAfter_;
@@ -107,4 +138,8 @@ const std::set<File>& PluginSortingData::GetUserRequirements() const {
 const std::optional<size_t>& PluginSortingData::GetLoadOrderIndex() const {
   return loadOrderIndex_;
 }
+
+bool PluginSortingData::IsCaptured() const { return capturedPlugin_ != nullptr; }
+
+const Plugin* PluginSortingData::GetPlugin() const { return plugin_; }
 }
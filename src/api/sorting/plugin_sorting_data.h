@@ -26,28 +26,33 @@
 #define LOOT_API_SORTING_PLUGIN_SORTING_DATA
 
 #include "api/plugin.h"
+#include "api/sorting/sort_capture.h"
 #include "loot/metadata/plugin_metadata.h"
 
 namespace loot {
 class PluginSortingData {
 public:
+  // Only provided because the plugin graph's vertex storage requires it. A
+  // default-constructed object has no plugin and must not be used.
+  PluginSortingData();
   PluginSortingData(const Plugin& plugin,
                     const PluginMetadata& masterlistMetadata,
                     const PluginMetadata& userMetadata,
-                    const std::vector<std::string>& loadOrder);
+                    const std::optional<size_t>& loadOrderIndex);
+  // Uses the captured plugin's data instead of reading a plugin, so that a
+  // sort can be replayed. The captured plugin must outlive this object.
+  explicit PluginSortingData(const SortCapture::Plugin& plugin);
 
   std::string GetName() const;
+  const std::string& GetNormalizedName() const;
   bool IsMaster() const;
   bool LoadsArchive() const;
-  std::vector<std::string> GetMasters() const;
+  const std::vector<std::string>& GetMasters() const;
   size_t NumOverrideFormIDs() const;
   bool DoFormIDsOverlap(const PluginSortingData& plugin) const;
 
   std::string GetGroup() const;
 
-  std::unordered_set<std::string> GetAfterGroupPlugins() const;
-  void SetAfterGroupPlugins(std::unordered_set<std::string> plugins);
-
   const std::set<File>& GetMasterlistLoadAfterFiles() const;
   const std::set<File>& GetUserLoadAfterFiles() const;
   const std::set<File>& GetMasterlistRequirements() const;
@@ -55,10 +60,17 @@ public:
 
   const std::optional<size_t>& GetLoadOrderIndex() const;
 
+  // Checks if this object was created from a captured plugin.
+  bool IsCaptured() const;
+  // The plugin that this object was created from, or null if it was created
+  // from a captured plugin.
+  const Plugin* GetPlugin() const;
+
 private:
-  const Plugin& plugin_;
+  // Exactly one of these is set, unless the object was default-constructed.
+  const Plugin* plugin_;
+  const SortCapture::Plugin* capturedPlugin_;
   std::string group_;
-  std::unordered_set<std::string> afterGroupPlugins_;
 
   std::set<File> masterlistLoadAfter_;
   std::set<File> userLoadAfter_;
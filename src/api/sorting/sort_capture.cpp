@@ -0,0 +1,407 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/sorting/sort_capture.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "api/helpers/logging.h"
+#include "api/helpers/text.h"
+#include "loot/exception/file_access_error.h"
+
+namespace loot {
+namespace {
+constexpr char CAPTURE_MAGIC[8] = {'L', 'O', 'O', 'T', 'S', 'R', 'T', '\0'};
+constexpr uint32_t CAPTURE_VERSION = 1;
+// Used in place of a load order index for a plugin that isn't in the load
+// order.
+constexpr uint32_t NO_INDEX = UINT32_MAX;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t fieldCount;
+  uint32_t stringCount;
+  uint32_t padding;
+};
+
+struct StringEntry {
+  uint32_t offset;
+  uint32_t length;
+};
+
+class InvalidCaptureError : public std::runtime_error {
+public:
+  InvalidCaptureError() :
+      std::runtime_error("The sort capture data is invalid.") {}
+};
+
+class CaptureWriter {
+public:
+  void Write(uint32_t value) { fields_.push_back(value); }
+
+  void Write(const std::string& value) {
+    auto it = stringIndices_.find(value);
+    if (it == stringIndices_.end()) {
+      it = stringIndices_.emplace(value, (uint32_t)strings_.size()).first;
+      strings_.push_back(&it->first);
+    }
+
+    Write(it->second);
+  }
+
+  void Write(const Group& group) {
+    Write(group.GetName());
+    WriteAll(group.GetAfterGroups());
+  }
+
+  template<typename Container>
+  void WriteAll(const Container& container) {
+    Write((uint32_t)container.size());
+    for (const auto& element : container) {
+      Write(element);
+    }
+  }
+
+  void Write(const SortCapture& capture) {
+    Write(static_cast<uint32_t>(capture.gameType));
+
+    // Overlapping plugins are written as the indices of the plugins that
+    // come later than each plugin, so that each pair is only stored once.
+    std::unordered_map<std::string, uint32_t> pluginIndices;
+    for (const auto& plugin : capture.plugins) {
+      pluginIndices.emplace(plugin.normalizedName,
+                            (uint32_t)pluginIndices.size());
+    }
+
+    Write((uint32_t)capture.plugins.size());
+    for (size_t i = 0; i < capture.plugins.size(); ++i) {
+      const auto& plugin = capture.plugins[i];
+      Write(plugin.name);
+      Write((uint32_t)plugin.isMaster);
+      Write((uint32_t)plugin.loadsArchive);
+      WriteAll(plugin.masters);
+      Write((uint32_t)plugin.numOverrideFormIDs);
+      Write(plugin.group);
+      WriteAll(plugin.masterlistLoadAfterFiles);
+      WriteAll(plugin.userLoadAfterFiles);
+      WriteAll(plugin.masterlistRequirements);
+      WriteAll(plugin.userRequirements);
+      Write(plugin.loadOrderIndex.has_value()
+                ? (uint32_t)plugin.loadOrderIndex.value()
+                : NO_INDEX);
+
+      std::vector<uint32_t> laterOverlaps;
+      for (const auto& other : plugin.overlappingPlugins) {
+        auto it = pluginIndices.find(other);
+        if (it != pluginIndices.end() && it->second > i) {
+          laterOverlaps.push_back(it->second);
+        }
+      }
+      WriteAll(laterOverlaps);
+    }
+
+    WriteAll(capture.masterlistGroups);
+    WriteAll(capture.userGroups);
+
+    const auto& hardcodedPlugins = capture.hardcodedPlugins;
+    WriteAll(hardcodedPlugins.implicitlyActivePlugins);
+    for (size_t i = 0; i < capture.plugins.size(); ++i) {
+      Write((uint32_t)hardcodedPlugins.verticesInDataDirectory.at(i));
+      Write((uint32_t)hardcodedPlugins.implicitlyActiveIndices.at(i));
+    }
+  }
+
+  void Save(const std::filesystem::path& filePath) const {
+    FileHeader header;
+    std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    header.version = CAPTURE_VERSION;
+    header.fieldCount = (uint32_t)fields_.size();
+    header.stringCount = (uint32_t)strings_.size();
+    header.padding = 0;
+
+    std::vector<StringEntry> stringEntries;
+    stringEntries.reserve(strings_.size());
+    uint32_t offset = 0;
+    for (const auto string : strings_) {
+      stringEntries.push_back(StringEntry{offset, (uint32_t)string->length()});
+      offset += (uint32_t)string->length();
+    }
+
+    std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      throw FileAccessError("Unable to open sort capture file: " +
+                            filePath.u8string());
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(fields_.data()),
+              fields_.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(stringEntries.data()),
+              stringEntries.size() * sizeof(StringEntry));
+    for (const auto string : strings_) {
+      out.write(string->data(), string->length());
+    }
+
+    if (!out.good()) {
+      throw FileAccessError("Unable to write sort capture file: " +
+                            filePath.u8string());
+    }
+  }
+
+private:
+  std::vector<uint32_t> fields_;
+  std::unordered_map<std::string, uint32_t> stringIndices_;
+  // Points to the keys of stringIndices_, in index order.
+  std::vector<const std::string*> strings_;
+};
+
+class CaptureReader {
+public:
+  CaptureReader(const std::vector<uint32_t>& fields,
+                const std::vector<std::string>& strings) :
+      fields_(fields), strings_(strings), position_(0) {}
+
+  uint32_t ReadInt() {
+    if (position_ >= fields_.size()) {
+      throw InvalidCaptureError();
+    }
+
+    return fields_[position_++];
+  }
+
+  bool ReadBool() { return ReadInt() != 0; }
+
+  const std::string& ReadString() {
+    auto index = ReadInt();
+    if (index >= strings_.size()) {
+      throw InvalidCaptureError();
+    }
+
+    return strings_[index];
+  }
+
+  std::vector<std::string> ReadStrings() {
+    auto count = ReadCount();
+    std::vector<std::string> strings;
+    strings.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      strings.push_back(ReadString());
+    }
+
+    return strings;
+  }
+
+  std::unordered_set<Group> ReadGroups() {
+    auto count = ReadCount();
+    std::unordered_set<Group> groups;
+    for (uint32_t i = 0; i < count; ++i) {
+      auto& name = ReadString();
+      auto afterGroups = ReadStrings();
+      groups.insert(Group(name,
+                          std::unordered_set<std::string>(afterGroups.begin(),
+                                                          afterGroups.end())));
+    }
+
+    return groups;
+  }
+
+  SortCapture ReadCapture() {
+    SortCapture capture;
+
+    auto gameType = ReadInt();
+    if (gameType > static_cast<uint32_t>(GameType::tes3)) {
+      throw InvalidCaptureError();
+    }
+    capture.gameType = static_cast<GameType>(gameType);
+
+    auto pluginCount = ReadCount();
+    capture.plugins.resize(pluginCount);
+    std::vector<std::vector<uint32_t>> laterOverlaps(pluginCount);
+    for (uint32_t i = 0; i < pluginCount; ++i) {
+      auto& plugin = capture.plugins[i];
+      plugin.name = ReadString();
+      plugin.normalizedName = NormalizeFilename(plugin.name);
+      plugin.isMaster = ReadBool();
+      plugin.loadsArchive = ReadBool();
+      plugin.masters = ReadStrings();
+      plugin.numOverrideFormIDs = ReadInt();
+      plugin.group = ReadString();
+      plugin.masterlistLoadAfterFiles = ReadStrings();
+      plugin.userLoadAfterFiles = ReadStrings();
+      plugin.masterlistRequirements = ReadStrings();
+      plugin.userRequirements = ReadStrings();
+
+      auto loadOrderIndex = ReadInt();
+      if (loadOrderIndex != NO_INDEX) {
+        plugin.loadOrderIndex = loadOrderIndex;
+      }
+
+      auto overlapCount = ReadCount();
+      for (uint32_t j = 0; j < overlapCount; ++j) {
+        auto otherIndex = ReadInt();
+        if (otherIndex <= i || otherIndex >= pluginCount) {
+          throw InvalidCaptureError();
+        }
+        laterOverlaps[i].push_back(otherIndex);
+      }
+    }
+
+    for (size_t i = 0; i < pluginCount; ++i) {
+      auto& plugin = capture.plugins[i];
+      for (const auto otherIndex : laterOverlaps[i]) {
+        auto& other = capture.plugins[otherIndex];
+        plugin.overlappingPlugins.insert(other.normalizedName);
+        other.overlappingPlugins.insert(plugin.normalizedName);
+      }
+    }
+
+    capture.masterlistGroups = ReadGroups();
+    capture.userGroups = ReadGroups();
+
+    auto& hardcodedPlugins = capture.hardcodedPlugins;
+    hardcodedPlugins.implicitlyActivePlugins = ReadStrings();
+    for (uint32_t i = 0; i < pluginCount; ++i) {
+      hardcodedPlugins.verticesInDataDirectory.push_back(ReadBool());
+
+      auto index = ReadInt();
+      if (index > hardcodedPlugins.implicitlyActivePlugins.size()) {
+        throw InvalidCaptureError();
+      }
+      hardcodedPlugins.implicitlyActiveIndices.push_back(index);
+    }
+
+    if (position_ != fields_.size()) {
+      throw InvalidCaptureError();
+    }
+
+    return capture;
+  }
+
+private:
+  // Every element takes at least one field, so a count larger than the number
+  // of remaining fields must be invalid. Checking this avoids reserving a huge
+  // amount of memory.
+  uint32_t ReadCount() {
+    auto count = ReadInt();
+    if (count > fields_.size() - position_) {
+      throw InvalidCaptureError();
+    }
+
+    return count;
+  }
+
+  const std::vector<uint32_t>& fields_;
+  const std::vector<std::string>& strings_;
+  size_t position_;
+};
+}
+
+void SaveSortCapture(const SortCapture& capture,
+                     const std::filesystem::path& filePath) {
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Saving a sort capture of {} plugins to: {}",
+                  capture.plugins.size(),
+                  filePath.u8string());
+  }
+
+  CaptureWriter writer;
+  writer.Write(capture);
+  writer.Save(filePath);
+}
+
+SortCapture LoadSortCapture(const std::filesystem::path& filePath) {
+  auto logger = getLogger();
+  if (logger) {
+    logger->trace("Loading sort capture from: {}", filePath.u8string());
+  }
+
+  std::ifstream in(filePath, std::ios::binary);
+  if (!in.is_open()) {
+    throw FileAccessError("Unable to open sort capture file: " +
+                          filePath.u8string());
+  }
+
+  std::vector<char> buffer;
+  in.seekg(0, std::ios::end);
+  buffer.resize((size_t)in.tellg());
+  in.seekg(0, std::ios::beg);
+  in.read(buffer.data(), buffer.size());
+  if (!in.good()) {
+    throw FileAccessError("Unable to read sort capture file: " +
+                          filePath.u8string());
+  }
+
+  const auto invalidCaptureError = FileAccessError(
+      "The file at \"" + filePath.u8string() + "\" is not a valid sort capture.");
+
+  FileHeader header;
+  if (buffer.size() < sizeof(header)) {
+    throw invalidCaptureError;
+  }
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  if (std::memcmp(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 ||
+      header.version != CAPTURE_VERSION) {
+    throw invalidCaptureError;
+  }
+
+  auto stringEntriesOffset =
+      sizeof(FileHeader) + (size_t)header.fieldCount * sizeof(uint32_t);
+  auto stringsOffset =
+      stringEntriesOffset + (size_t)header.stringCount * sizeof(StringEntry);
+  if (buffer.size() < stringsOffset) {
+    throw invalidCaptureError;
+  }
+
+  std::vector<uint32_t> fields(header.fieldCount);
+  std::memcpy(fields.data(),
+              buffer.data() + sizeof(FileHeader),
+              fields.size() * sizeof(uint32_t));
+
+  std::vector<std::string> strings;
+  strings.reserve(header.stringCount);
+  for (size_t i = 0; i < header.stringCount; ++i) {
+    StringEntry entry;
+    std::memcpy(&entry,
+                buffer.data() + stringEntriesOffset + i * sizeof(StringEntry),
+                sizeof(entry));
+    if (stringsOffset + entry.offset + entry.length > buffer.size()) {
+      throw invalidCaptureError;
+    }
+    strings.emplace_back(buffer.data() + stringsOffset + entry.offset,
+                         entry.length);
+  }
+
+  try {
+    return CaptureReader(fields, strings).ReadCapture();
+  } catch (InvalidCaptureError&) {
+    throw invalidCaptureError;
+  }
+}
+}
@@ -0,0 +1,100 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_SORTING_SORT_CAPTURE
+#define LOOT_API_SORTING_SORT_CAPTURE
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "loot/enum/game_type.h"
+#include "loot/metadata/group.h"
+
+namespace loot {
+// The inputs to adding hardcoded plugin edges that come from the data
+// directory.
+struct HardcodedPluginData {
+  // The implicitly active plugins that are present in the data directory, in
+  // the order that the game loads them.
+  std::vector<std::string> implicitlyActivePlugins;
+  // For each vertex, whether its plugin's file is in the data directory.
+  std::vector<bool> verticesInDataDirectory;
+  // For each vertex, the index in implicitlyActivePlugins of the first entry
+  // that is the same file as the vertex's plugin, or the number of implicitly
+  // active plugins if there is none.
+  std::vector<size_t> implicitlyActiveIndices;
+};
+
+// Everything that PluginSorter reads from a game when sorting, so that a sort
+// can be replayed without the game's files.
+struct SortCapture {
+  struct Plugin {
+    std::string name;
+    std::string normalizedName;
+    // Light masters that don't have a .esp extension count as masters.
+    bool isMaster = false;
+    bool loadsArchive = false;
+    std::vector<std::string> masters;
+    size_t numOverrideFormIDs = 0;
+    // The group that the plugin's evaluated metadata puts it in.
+    std::string group;
+    std::vector<std::string> masterlistLoadAfterFiles;
+    std::vector<std::string> userLoadAfterFiles;
+    std::vector<std::string> masterlistRequirements;
+    std::vector<std::string> userRequirements;
+    std::optional<size_t> loadOrderIndex;
+    // The normalised filenames of the plugins whose records overlap with
+    // this plugin's. Only pairs that the captured sort compared are known, so
+    // a replay must build the same graph to make the same comparisons.
+    std::unordered_set<std::string> overlappingPlugins;
+  };
+
+  GameType gameType = GameType::tes4;
+  // In the order that the sorter added them to the plugin graph.
+  std::vector<Plugin> plugins;
+  std::unordered_set<Group> masterlistGroups;
+  std::unordered_set<Group> userGroups;
+  HardcodedPluginData hardcodedPlugins;
+};
+
+// Sort capture files hold a fixed-size header, followed by a sequence of 32-bit
+// fields, followed by a table of the strings that the fields refer to by index.
+// All integers are stored in little-endian byte order, which is the native
+// order on every platform that libloot supports, so captures can be attached
+// to bug reports and replayed on other machines.
+
+// Throws a FileAccessError if the capture cannot be written.
+void SaveSortCapture(const SortCapture& capture,
+                     const std::filesystem::path& filePath);
+
+// Throws a FileAccessError if the capture cannot be read or is not valid.
+SortCapture LoadSortCapture(const std::filesystem::path& filePath);
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include "api/sorting/sorted_plugin_graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "api/helpers/logging.h"
+#include "api/helpers/memory_usage.h"
+#include "api/helpers/text.h"
+
+namespace loot {
+void SortedPluginGraph::AddVertex(const std::string& pluginName) {
+  indices_.emplace(NormalizeFilename(pluginName), names_.size());
+  names_.push_back(pluginName);
+  edgeOffsets_.push_back((uint32_t)edgeTargets_.size());
+}
+
+void SortedPluginGraph::AddEdge(size_t toIndex, EdgeType edgeType) {
+  if (names_.empty() || toIndex < names_.size()) {
+    throw std::logic_error("Plugin graph edges must go to later vertices");
+  }
+
+  edgeTargets_.push_back((uint32_t)toIndex);
+  edgeTypes_.push_back(static_cast<uint8_t>(edgeType));
+}
+
+size_t SortedPluginGraph::NumVertices() const { return names_.size(); }
+
+std::vector<Vertex> SortedPluginGraph::GetPath(
+    const std::string& fromPluginName,
+    const std::string& toPluginName) const {
+  const auto fromIndex = GetIndex(fromPluginName);
+  const auto toIndex = GetIndex(toPluginName);
+
+  if (fromIndex > toIndex) {
+    return std::vector<Vertex>();
+  }
+
+  // Each cost is the number of tie-break edges and then the number of edges
+  // in the best path found so far from the first plugin.
+  typedef std::pair<size_t, size_t> Cost;
+  constexpr Cost UNREACHABLE{std::numeric_limits<size_t>::max(),
+                             std::numeric_limits<size_t>::max()};
+
+  const auto numVertices = toIndex - fromIndex + 1;
+  std::vector<Cost> costs(numVertices, UNREACHABLE);
+  std::vector<size_t> predecessors(numVertices, 0);
+  std::vector<EdgeType> edgeTypes(numVertices, EdgeType::tieBreak);
+  costs[0] = Cost{0, 0};
+
+  for (size_t i = fromIndex; i < toIndex; ++i) {
+    const auto& cost = costs[i - fromIndex];
+    if (cost == UNREACHABLE) {
+      continue;
+    }
+
+    const size_t edgesEnd = i + 1 < names_.size() ? edgeOffsets_[i + 1]
+                                                  : edgeTargets_.size();
+    for (size_t edge = edgeOffsets_[i]; edge < edgesEnd; ++edge) {
+      const size_t target = edgeTargets_[edge];
+      if (target > toIndex) {
+        continue;
+      }
+
+      const auto edgeType = static_cast<EdgeType>(edgeTypes_[edge]);
+      const Cost newCost{
+          cost.first + (edgeType == EdgeType::tieBreak ? 1 : 0),
+          cost.second + 1};
+      if (newCost < costs[target - fromIndex]) {
+        costs[target - fromIndex] = newCost;
+        predecessors[target - fromIndex] = i;
+        edgeTypes[target - fromIndex] = edgeType;
+      }
+    }
+  }
+
+  if (costs[toIndex - fromIndex] == UNREACHABLE) {
+    return std::vector<Vertex>();
+  }
+
+  // Walk the path backwards from the last plugin, then reverse it.
+  std::vector<Vertex> path{Vertex(names_[toIndex])};
+  auto currentIndex = toIndex;
+  while (currentIndex != fromIndex) {
+    const auto offset = currentIndex - fromIndex;
+    currentIndex = predecessors[offset];
+    path.push_back(Vertex(names_[currentIndex], edgeTypes[offset]));
+  }
+  std::reverse(path.begin(), path.end());
+
+  return path;
+}
+
+size_t SortedPluginGraph::GetMemoryUsage() const {
+  return EstimateHeapSize(names_) +
+         EstimateHeapSize(indices_, [](size_t) { return 0; }) +
+         (edgeOffsets_.capacity() + edgeTargets_.capacity()) *
+             sizeof(uint32_t) +
+         edgeTypes_.capacity() * sizeof(uint8_t);
+}
+
+size_t SortedPluginGraph::GetIndex(const std::string& pluginName) const {
+  auto it = indices_.find(NormalizeFilename(pluginName));
+  if (it != indices_.end()) {
+    return it->second;
+  }
+
+  auto logger = getLogger();
+  if (logger) {
+    logger->error("Can't find plugin with name \"{}\" in the sorted graph",
+                  pluginName);
+  }
+
+  throw std::invalid_argument("Can't find plugin with name \"" + pluginName +
+                              "\" in the last sort");
+}
+}
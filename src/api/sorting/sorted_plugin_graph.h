@@ -0,0 +1,81 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_API_SORTING_SORTED_PLUGIN_GRAPH
+#define LOOT_API_SORTING_SORTED_PLUGIN_GRAPH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "loot/enum/edge_type.h"
+#include "loot/vertex.h"
+
+namespace loot {
+// A compact copy of the plugin graph that a sort built, kept so that the
+// constraints behind the sorted load order can be explained without sorting
+// again. The vertices are stored in their sorted order, so every edge goes
+// from a vertex to a later one, and the shortest paths between two plugins
+// can be found in a single pass over the vertices between them. Out-edges are
+// stored in one array, with each vertex's edges starting at an offset.
+class SortedPluginGraph {
+public:
+  // Adds a vertex after the vertices already in the graph. Vertices must be
+  // added in their sorted order.
+  void AddVertex(const std::string& pluginName);
+  // Adds an edge from the last vertex added to the vertex at the given
+  // position in the sorted order, which must be later.
+  void AddEdge(size_t toIndex, EdgeType edgeType);
+
+  size_t NumVertices() const;
+
+  // Get the path from the first plugin to the last plugin, or an empty vector
+  // if there is no path. Paths with fewer tie-break edges are preferred, then
+  // paths with fewer edges, as tie-break edges only make the order
+  // deterministic. Throws std::invalid_argument if either plugin is not in
+  // the graph.
+  std::vector<Vertex> GetPath(const std::string& fromPluginName,
+                              const std::string& toPluginName) const;
+
+  // An estimate of the memory used by the graph, in bytes.
+  size_t GetMemoryUsage() const;
+
+private:
+  size_t GetIndex(const std::string& pluginName) const;
+
+  std::vector<std::string> names_;
+  // Maps normalised plugin filenames to their vertices.
+  std::unordered_map<std::string, size_t> indices_;
+  // The edges from vertex i are at positions edgeOffsets_[i] up to
+  // edgeOffsets_[i + 1], or the end of the arrays for the last vertex.
+  std::vector<uint32_t> edgeOffsets_;
+  std::vector<uint32_t> edgeTargets_;
+  std::vector<uint8_t> edgeTypes_;
+};
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_BENCHMARKS_GAME_BENCHMARKS
+#define LOOT_BENCHMARKS_GAME_BENCHMARKS
+
+#include <benchmark/benchmark.h>
+
+#include "api/game/game.h"
+#include "benchmarks/synthetic_game.h"
+
+namespace loot {
+namespace benchmarks {
+static void GameLoadPlugins(benchmark::State& state) {
+  const auto& syntheticGame = GetSyntheticGame(state.range(0));
+  bool loadHeadersOnly = state.range(1) != 0;
+
+  for (auto _ : state) {
+    // Use a new game each time so that no loaded plugins are reused.
+    state.PauseTiming();
+    Game game(SyntheticGame::gameType,
+              syntheticGame.GamePath(),
+              syntheticGame.LocalPath());
+    game.LoadCurrentLoadOrderState();
+    state.ResumeTiming();
+
+    game.LoadPlugins(syntheticGame.Plugins(), loadHeadersOnly);
+  }
+
+  state.SetItemsProcessed(state.iterations() * syntheticGame.Plugins().size());
+}
+BENCHMARK(GameLoadPlugins)
+    ->Args({1000, 1})
+    ->Args({1000, 0})
+    ->Args({5000, 1})
+    ->Args({5000, 0})
+    ->Unit(benchmark::kMillisecond);
+
+static void GameLoadPluginsAgain(benchmark::State& state) {
+  const auto& syntheticGame = GetSyntheticGame(state.range(0));
+  Game game(SyntheticGame::gameType,
+            syntheticGame.GamePath(),
+            syntheticGame.LocalPath());
+  game.LoadCurrentLoadOrderState();
+  game.LoadPlugins(syntheticGame.Plugins(), false);
+
+  for (auto _ : state) {
+    game.LoadPlugins(syntheticGame.Plugins(), false);
+  }
+
+  state.SetItemsProcessed(state.iterations() * syntheticGame.Plugins().size());
+}
+BENCHMARK(GameLoadPluginsAgain)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Unit(benchmark::kMillisecond);
+}
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_BENCHMARKS_METADATA_BENCHMARKS
+#define LOOT_BENCHMARKS_METADATA_BENCHMARKS
+
+#include <benchmark/benchmark.h>
+
+#include "api/metadata/condition_evaluator.h"
+#include "api/metadata_list.h"
+#include "benchmarks/synthetic_game.h"
+
+namespace loot {
+namespace benchmarks {
+static void MetadataListLoad(benchmark::State& state) {
+  const auto& game = GetSyntheticGame(state.range(0));
+
+  for (auto _ : state) {
+    MetadataList metadataList;
+    metadataList.Load(game.MasterlistPath());
+    benchmark::DoNotOptimize(metadataList);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(MetadataListLoad)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Unit(benchmark::kMillisecond);
+
+static void MetadataListFindPlugin(benchmark::State& state) {
+  const auto& game = GetSyntheticGame(state.range(0));
+  MetadataList metadataList;
+  metadataList.Load(game.MasterlistPath());
+
+  for (auto _ : state) {
+    for (const auto& plugin : game.Plugins()) {
+      benchmark::DoNotOptimize(metadataList.FindPlugin(plugin));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * game.Plugins().size());
+}
+BENCHMARK(MetadataListFindPlugin)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Unit(benchmark::kMillisecond);
+
+static void PluginMetadataMergeRegexMatches(benchmark::State& state) {
+  // Each entry has some metadata in common with the others, as entries that
+  // match the same plugin usually do.
+  std::vector<PluginMetadata> regexEntries;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    const auto index = std::to_string(i);
+    PluginMetadata entry("Plugin.*" + index + "\\.esp");
+    entry.SetLoadAfterFiles({File("Common.esm"), File("Master" + index + ".esm")});
+    entry.SetTags({Tag("Relev"), Tag("Tag" + index)});
+    entry.SetMessages({Message(MessageType::say, "Message " + index)});
+    entry.SetDirtyInfo(
+        {PluginCleaningData(static_cast<uint32_t>(i), "utility", {}, 1, 2, 3)});
+    regexEntries.push_back(entry);
+  }
+
+  for (auto _ : state) {
+    PluginMetadata match("Plugin.esp");
+    for (const auto& entry : regexEntries) {
+      match.MergeMetadata(entry);
+    }
+    benchmark::DoNotOptimize(match);
+  }
+
+  state.SetItemsProcessed(state.iterations() * regexEntries.size());
+}
+BENCHMARK(PluginMetadataMergeRegexMatches)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMicrosecond);
+
+static void ConditionEvaluatorEvaluateAll(benchmark::State& state) {
+  const auto& game = GetSyntheticGame(state.range(0));
+  MetadataList metadataList;
+  metadataList.Load(game.MasterlistPath());
+
+  std::vector<PluginMetadata> pluginsMetadata;
+  for (const auto& metadata : metadataList.FindPlugins(game.Plugins())) {
+    if (metadata.has_value()) {
+      pluginsMetadata.push_back(metadata.value());
+    }
+  }
+
+  ConditionEvaluator evaluator(SyntheticGame::gameType, game.DataPath());
+
+  for (auto _ : state) {
+    // Clear the cache so that each iteration evaluates every condition.
+    evaluator.ClearConditionCache();
+    benchmark::DoNotOptimize(evaluator.EvaluateAll(pluginsMetadata));
+  }
+
+  state.SetItemsProcessed(state.iterations() * pluginsMetadata.size());
+}
+BENCHMARK(ConditionEvaluatorEvaluateAll)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Unit(benchmark::kMillisecond);
+}
+}
+
+#endif
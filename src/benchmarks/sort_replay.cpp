@@ -0,0 +1,125 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "api/sorting/plugin_sorter.h"
+#include "api/sorting/sort_capture.h"
+
+// Replays a sort capture written by GameInterface::WriteSortCapture() and
+// reports how long each sorting phase took, so that a slow sort can be
+// profiled without the game's files.
+int main(int argc, char* argv[]) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " <capture file> [iterations]"
+              << std::endl;
+    return 1;
+  }
+
+  size_t iterations = 10;
+  if (argc == 3) {
+    iterations = std::strtoul(argv[2], nullptr, 10);
+    if (iterations == 0) {
+      std::cerr << "The number of iterations must be a positive integer."
+                << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    auto capture = loot::LoadSortCapture(argv[1]);
+    std::cout << "Replaying the sort of " << capture.plugins.size()
+              << " plugins " << iterations << " times." << std::endl;
+
+    // Phases are listed in the order that they first ran.
+    std::vector<std::string> phaseNames;
+    std::map<std::string, std::vector<std::chrono::microseconds>> durations;
+    std::vector<std::chrono::microseconds> totals;
+    size_t edgeCount = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+      // Use a new sorter each time so that no work is reused between sorts.
+      loot::PluginSorter sorter;
+      sorter.Sort(capture);
+
+      const auto& statistics = sorter.GetStatistics();
+      std::chrono::microseconds total(0);
+      for (const auto& phase : statistics.phases) {
+        auto& phaseDurations = durations[phase.name];
+        if (phaseDurations.empty()) {
+          phaseNames.push_back(phase.name);
+        }
+        phaseDurations.push_back(phase.duration);
+        total += phase.duration;
+      }
+      totals.push_back(total);
+
+      edgeCount = 0;
+      for (const auto& phase : statistics.phases) {
+        for (const auto& count : phase.edgesAdded) {
+          edgeCount += count.second;
+        }
+      }
+    }
+
+    const auto printTimes =
+        [](const std::string& name,
+           const std::vector<std::chrono::microseconds>& times) {
+          auto min = times.front();
+          std::chrono::microseconds sum(0);
+          for (const auto& time : times) {
+            min = std::min(min, time);
+            sum += time;
+          }
+
+          std::cout << std::left << std::setw(28) << name << std::right
+                    << std::setw(12) << min.count() << std::setw(12)
+                    << sum.count() / times.size() << std::endl;
+        };
+
+    std::cout << "The sorted plugin graph has " << edgeCount << " edges."
+              << std::endl
+              << std::endl
+              << std::left << std::setw(28) << "Phase" << std::right
+              << std::setw(12) << "Min (us)" << std::setw(12) << "Mean (us)"
+              << std::endl;
+    for (const auto& name : phaseNames) {
+      printTimes(name, durations.at(name));
+    }
+    printTimes("Total", totals);
+  } catch (std::exception& e) {
+    std::cerr << "Replaying the sort failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
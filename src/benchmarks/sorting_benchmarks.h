@@ -0,0 +1,102 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_BENCHMARKS_SORTING_BENCHMARKS
+#define LOOT_BENCHMARKS_SORTING_BENCHMARKS
+
+#include <benchmark/benchmark.h>
+
+#include "api/game/game.h"
+#include "api/sorting/group_sort.h"
+#include "api/sorting/plugin_sorter.h"
+#include "benchmarks/synthetic_game.h"
+
+namespace loot {
+namespace benchmarks {
+static void GetTransitiveAfterGroups(benchmark::State& state) {
+  const auto& game = GetSyntheticGame(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        loot::GetTransitiveAfterGroups(game.Groups(), {}));
+  }
+
+  state.SetItemsProcessed(state.iterations() * game.Groups().size());
+}
+BENCHMARK(GetTransitiveAfterGroups)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+// Sets up a game with all the synthetic game's plugins loaded and its
+// masterlist loaded.
+static void LoadSyntheticGame(Game& game,
+                              const SyntheticGame& syntheticGame) {
+  game.LoadCurrentLoadOrderState();
+  game.LoadPlugins(syntheticGame.Plugins(), false);
+  game.GetDatabase()->LoadLists(syntheticGame.MasterlistPath());
+}
+
+static void PluginSorterSort(benchmark::State& state) {
+  const auto& syntheticGame = GetSyntheticGame(state.range(0));
+  Game game(SyntheticGame::gameType,
+            syntheticGame.GamePath(),
+            syntheticGame.LocalPath());
+  LoadSyntheticGame(game, syntheticGame);
+
+  for (auto _ : state) {
+    // Use a new sorter each time so that no overlap results are reused.
+    PluginSorter sorter;
+    benchmark::DoNotOptimize(sorter.Sort(game));
+  }
+
+  state.SetItemsProcessed(state.iterations() * syntheticGame.Plugins().size());
+}
+BENCHMARK(PluginSorterSort)
+    ->Arg(1000)
+    ->Arg(2000)
+    ->Unit(benchmark::kMillisecond);
+
+static void PluginSorterSortAgain(benchmark::State& state) {
+  const auto& syntheticGame = GetSyntheticGame(state.range(0));
+  Game game(SyntheticGame::gameType,
+            syntheticGame.GamePath(),
+            syntheticGame.LocalPath());
+  LoadSyntheticGame(game, syntheticGame);
+
+  PluginSorter sorter;
+  sorter.Sort(game);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sorter.Sort(game));
+  }
+
+  state.SetItemsProcessed(state.iterations() * syntheticGame.Plugins().size());
+}
+BENCHMARK(PluginSorterSortAgain)
+    ->Arg(1000)
+    ->Arg(2000)
+    ->Unit(benchmark::kMillisecond);
+}
+}
+
+#endif
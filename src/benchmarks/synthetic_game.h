@@ -0,0 +1,353 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_BENCHMARKS_SYNTHETIC_GAME
+#define LOOT_BENCHMARKS_SYNTHETIC_GAME
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+#include "api/metadata_list.h"
+#include "loot/enum/game_type.h"
+
+namespace loot {
+namespace benchmarks {
+struct SyntheticGameOptions {
+  // The number of plugins, not counting the game's main master file.
+  size_t plugins = 1000;
+  // One in every masterInterval plugins is a master file.
+  size_t masterInterval = 10;
+  // The number of master files, in addition to the main master file, that
+  // each plugin depends on.
+  size_t mastersPerPlugin = 3;
+  // The number of new records each plugin adds.
+  size_t newRecordsPerPlugin = 50;
+  // The number of its masters' records that each plugin overrides.
+  size_t overrideRecordsPerPlugin = 20;
+  size_t groups = 50;
+  // The number of masterlist entries that are regular expressions, each of
+  // which matches a subset of the plugins.
+  size_t regexEntries = 50;
+  // The number of plugins that are active.
+  size_t activePlugins = 255;
+};
+
+// Writes a game install containing generated Oblivion plugins and a masterlist
+// for them to a temporary directory, which is removed on destruction. Oblivion
+// is used because its load order is timestamp-based and its plugin format is
+// the simplest, so the load order can be as long as is wanted. The contents
+// are generated from a fixed seed, so they are the same for the same options.
+class SyntheticGame {
+public:
+  static constexpr GameType gameType = GameType::tes4;
+  static constexpr const char* masterFile = "Oblivion.esm";
+
+  explicit SyntheticGame(const SyntheticGameOptions& options) :
+      rootPath_(std::filesystem::temp_directory_path() /
+                ("libloot-benchmarks-" +
+                 boost::uuids::to_string(
+                     (boost::uuids::random_generator())()))),
+      gamePath_(rootPath_ / "game"),
+      localPath_(rootPath_ / "local" / "game"),
+      masterlistPath_(rootPath_ / "masterlist.yaml") {
+    std::filesystem::create_directories(DataPath());
+    std::filesystem::create_directories(localPath_);
+
+    WritePlugins(options);
+    WriteActivePlugins(options);
+    WriteMasterlist(options);
+  }
+
+  ~SyntheticGame() {
+    std::error_code ec;
+    std::filesystem::remove_all(rootPath_, ec);
+  }
+
+  SyntheticGame(const SyntheticGame&) = delete;
+  SyntheticGame& operator=(const SyntheticGame&) = delete;
+
+  const std::filesystem::path& GamePath() const { return gamePath_; }
+  std::filesystem::path DataPath() const { return gamePath_ / "Data"; }
+  const std::filesystem::path& LocalPath() const { return localPath_; }
+  const std::filesystem::path& MasterlistPath() const {
+    return masterlistPath_;
+  }
+
+  // All the plugins, including the main master file, in load order.
+  const std::vector<std::string>& Plugins() const { return plugins_; }
+  const std::unordered_set<Group>& Groups() const { return groups_; }
+
+private:
+  struct Record {
+    uint32_t formId;
+    std::string editorId;
+  };
+
+  template<typename T>
+  static void Append(std::string& buffer, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    buffer.append(bytes, sizeof(T));
+  }
+
+  static void AppendSubrecord(std::string& buffer,
+                              const char* type,
+                              const std::string& data) {
+    buffer.append(type, 4);
+    Append(buffer, static_cast<uint16_t>(data.size()));
+    buffer.append(data);
+  }
+
+  static void AppendRecord(std::string& buffer,
+                           const char* type,
+                           uint32_t flags,
+                           uint32_t formId,
+                           const std::string& data) {
+    buffer.append(type, 4);
+    Append(buffer, static_cast<uint32_t>(data.size()));
+    Append(buffer, flags);
+    Append(buffer, formId);
+    Append(buffer, static_cast<uint32_t>(0));
+    buffer.append(data);
+  }
+
+  static std::string ZString(const std::string& value) {
+    return value + '\0';
+  }
+
+  // Writes a plugin with a header that lists the given masters, followed by a
+  // single group of global variable records. A record's FormID's most
+  // significant byte is the index of the master that it belongs to, or the
+  // number of masters if the record is new.
+  static void WritePlugin(const std::filesystem::path& path,
+                          bool isMaster,
+                          const std::vector<std::string>& masters,
+                          const std::vector<Record>& records) {
+    std::string header;
+    AppendSubrecord(header, "HEDR", [&]() {
+      std::string hedr;
+      Append(hedr, 0.8f);
+      Append(hedr, static_cast<uint32_t>(records.size()));
+      Append(hedr, static_cast<uint32_t>(0x800));
+      return hedr;
+    }());
+    for (const auto& master : masters) {
+      AppendSubrecord(header, "MAST", ZString(master));
+      AppendSubrecord(header, "DATA", std::string(8, '\0'));
+    }
+
+    std::string group;
+    for (const auto& record : records) {
+      std::string data;
+      AppendSubrecord(data, "EDID", ZString(record.editorId));
+      AppendSubrecord(data, "FNAM", "s");
+      AppendSubrecord(data, "FLTV", std::string(4, '\0'));
+      AppendRecord(group, "GLOB", 0, record.formId, data);
+    }
+
+    std::string buffer;
+    AppendRecord(buffer, "TES4", isMaster ? 0x1 : 0, 0, header);
+    if (!group.empty()) {
+      buffer.append("GRUP", 4);
+      Append(buffer, static_cast<uint32_t>(group.size() + 20));
+      buffer.append("GLOB", 4);
+      Append(buffer, static_cast<uint32_t>(0));
+      Append(buffer, static_cast<uint32_t>(0));
+      buffer.append(group);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(buffer.data(), buffer.size());
+  }
+
+  static std::string GetPluginName(size_t index, bool isMaster) {
+    std::string number = std::to_string(index);
+    number.insert(0, 5 - std::min<size_t>(number.size(), 5), '0');
+    return "Synthetic " + number + (isMaster ? ".esm" : ".esp");
+  }
+
+  void WritePlugins(const SyntheticGameOptions& options) {
+    std::mt19937 random(0);
+
+    // Generate all the master files before the other plugins so that each
+    // plugin can depend on any master file that has been generated before it
+    // and the generated order is a valid load order.
+    auto masterCount = options.plugins / options.masterInterval;
+    auto timestamp = std::filesystem::file_time_type::clock::now() -
+                     std::chrono::minutes(options.plugins + 1);
+    for (size_t i = 0; i <= options.plugins; ++i) {
+      bool isMaster = i <= masterCount;
+      auto name = i == 0 ? masterFile : GetPluginName(i, isMaster);
+
+      std::vector<std::string> masters;
+      if (i > 0) {
+        std::vector<std::string> candidates(
+            plugins_.begin() + 1,
+            plugins_.begin() + std::min(i, masterCount + 1));
+        std::shuffle(candidates.begin(), candidates.end(), random);
+        candidates.resize(
+            std::min(candidates.size(), options.mastersPerPlugin));
+
+        masters.push_back(masterFile);
+        masters.insert(masters.end(), candidates.begin(), candidates.end());
+      }
+
+      std::vector<Record> records;
+      for (size_t j = 0; !masters.empty() && options.newRecordsPerPlugin > 0 &&
+                         j < options.overrideRecordsPerPlugin;
+           ++j) {
+        uint32_t masterIndex = random() % masters.size();
+        uint32_t objectIndex = 0x800 + random() % options.newRecordsPerPlugin;
+        records.push_back({(masterIndex << 24) | objectIndex, ""});
+      }
+      for (size_t j = 0; j < options.newRecordsPerPlugin; ++j) {
+        uint32_t objectIndex = 0x800 + static_cast<uint32_t>(j);
+        records.push_back(
+            {(static_cast<uint32_t>(masters.size()) << 24) | objectIndex, ""});
+      }
+      for (auto& record : records) {
+        record.editorId = "Synthetic" + std::to_string(i) + "_" +
+                          std::to_string(record.formId);
+      }
+
+      // Oblivion's load order is the order of plugins' timestamps.
+      auto path = DataPath() / name;
+      WritePlugin(path, isMaster, masters, records);
+      std::filesystem::last_write_time(path,
+                                       timestamp + std::chrono::minutes(i));
+
+      plugins_.push_back(name);
+    }
+  }
+
+  void WriteActivePlugins(const SyntheticGameOptions& options) {
+    std::ofstream out(localPath_ / "plugins.txt");
+    for (size_t i = 0; i < plugins_.size() && i < options.activePlugins;
+         ++i) {
+      out << plugins_[i] << std::endl;
+    }
+  }
+
+  void WriteMasterlist(const SyntheticGameOptions& options) {
+    std::mt19937 random(1);
+
+    groups_.insert(Group());
+    std::string previousGroup = Group().GetName();
+    for (size_t i = 0; i < options.groups; ++i) {
+      auto name = "Group " + std::to_string(i);
+      std::unordered_set<std::string> afterGroups = {previousGroup};
+      if (i > 1) {
+        afterGroups.insert("Group " + std::to_string(random() % (i - 1)));
+      }
+      groups_.insert(Group(name, afterGroups));
+      previousGroup = name;
+    }
+
+    MetadataList masterlist;
+    masterlist.SetGroups(groups_);
+
+    for (size_t i = 1; i < plugins_.size(); ++i) {
+      PluginMetadata plugin(plugins_[i]);
+      if (options.groups > 0) {
+        plugin.SetGroup("Group " +
+                        std::to_string(i * options.groups / plugins_.size()));
+      }
+
+      auto other = plugins_.at(1 + random() % (plugins_.size() - 1));
+      if (i % 3 == 0) {
+        plugin.SetTags({Tag("Relev"), Tag("Delev", true, "active(\"" + other +
+                                                           "\")")});
+      }
+      if (i % 5 == 0) {
+        plugin.SetMessages({Message(MessageType::warn,
+                                    "Synthetic message.",
+                                    "file(\"" + other + "\")")});
+      }
+      if (i % 7 == 0) {
+        plugin.SetIncompatibilities({File(other, "", "active(\"" + other +
+                                                         "\")")});
+      }
+
+      masterlist.AddPlugin(plugin);
+    }
+
+    for (size_t i = 0; i < options.regexEntries; ++i) {
+      // Matches plugins with the given digit in the given position of their
+      // number.
+      auto digit = std::to_string(i % 10);
+      auto position = i / 10 % 4;
+      PluginMetadata plugin("Synthetic " + std::string(position, '.') +
+                            digit + "\\d{" + std::to_string(4 - position) +
+                            "}\\.esp");
+      plugin.SetMessages({Message(MessageType::say,
+                                  "Synthetic regex message.",
+                                  "many(\"Synthetic .*\\.esm\")")});
+      masterlist.AddPlugin(plugin);
+    }
+
+    masterlist.Save(masterlistPath_);
+  }
+
+  const std::filesystem::path rootPath_;
+  const std::filesystem::path gamePath_;
+  const std::filesystem::path localPath_;
+  const std::filesystem::path masterlistPath_;
+
+  std::vector<std::string> plugins_;
+  std::unordered_set<Group> groups_;
+};
+
+// Generating a game can take a while, so share one per plugin count between
+// benchmarks.
+inline const SyntheticGame& GetSyntheticGame(size_t plugins) {
+  static std::map<size_t, std::unique_ptr<SyntheticGame>> games;
+
+  auto it = games.find(plugins);
+  if (it == games.end()) {
+    SyntheticGameOptions options;
+    options.plugins = plugins;
+    it = games.emplace(plugins, std::make_unique<SyntheticGame>(options))
+             .first;
+  }
+
+  return *it->second;
+}
+}
+}
+
+#endif
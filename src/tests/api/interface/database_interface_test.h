@@ -27,6 +27,9 @@ along with LOOT.  If not, see
 
 #include "loot/api.h"
 
+#include <atomic>
+#include <thread>
+
 #include "tests/api/interface/api_game_operations_test.h"
 
 namespace loot {
@@ -169,6 +172,65 @@ TEST_P(DatabaseInterfaceTest,
       db_->LoadLists(masterlistPath, userlistPath_));
 }
 
+TEST_P(DatabaseInterfaceTest,
+       loadListsShouldNotDisruptConcurrentCallsToGetPluginMetadata) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, ""));
+
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> missing(0);
+  std::thread reader([&]() {
+    while (!stop) {
+      if (!db_->GetPluginMetadata(blankEsm)) {
+        ++missing;
+      }
+    }
+  });
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_NO_THROW(db_->LoadLists(masterlistPath, ""));
+  }
+
+  stop = true;
+  reader.join();
+
+  EXPECT_EQ(0, missing);
+}
+
+TEST_P(DatabaseInterfaceTest,
+       evaluatedQueriesMadeConcurrentlyShouldGetTheSameResultsAsOneThread) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, userlistPath_));
+
+  auto expectedMetadata = db_->GetPluginMetadata(blankEsm, true, true);
+  ASSERT_TRUE(expectedMetadata.has_value());
+  auto expectedGroups = db_->GetGroups();
+
+  std::atomic<size_t> mismatches(0);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      for (size_t j = 0; j < 50; ++j) {
+        auto metadata = db_->GetPluginMetadata(blankEsm, true, true);
+        if (!metadata || metadata->GetLoadAfterFiles() !=
+                             expectedMetadata->GetLoadAfterFiles()) {
+          ++mismatches;
+        }
+        if (db_->GetGroups() != expectedGroups) {
+          ++mismatches;
+        }
+      }
+    });
+  }
+
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(0, mismatches);
+}
+
 TEST_P(
     DatabaseInterfaceTest,
     writeUserMetadataShouldThrowIfTheFileAlreadyExistsAndTheOverwriteArgumentIsFalse) {
@@ -297,6 +359,63 @@ TEST_P(
   EXPECT_TRUE(std::filesystem::exists(masterlistPath));
 }
 
+TEST_P(DatabaseInterfaceTest,
+       prefetchMasterlistShouldThrowIfTheRepositoryUrlGivenIsEmpty) {
+  EXPECT_THROW(db_->PrefetchMasterlist(masterlistPath, "", branch_),
+               std::invalid_argument);
+}
+
+TEST_P(DatabaseInterfaceTest,
+       updateMasterlistShouldReturnTheResultOfAPrefetchWithTheSameArguments) {
+  ASSERT_NO_THROW(db_->PrefetchMasterlist(masterlistPath, url_, branch_));
+
+  bool updated = false;
+  EXPECT_NO_THROW(
+      updated = db_->UpdateMasterlist(masterlistPath, url_, branch_));
+  EXPECT_TRUE(updated);
+  EXPECT_TRUE(std::filesystem::exists(masterlistPath));
+
+  EXPECT_NO_THROW(
+      updated = db_->UpdateMasterlist(masterlistPath, url_, branch_));
+  EXPECT_FALSE(updated);
+}
+
+TEST_P(DatabaseInterfaceTest,
+       updateMasterlistShouldThrowIfAPrefetchWithTheSameArgumentsFailed) {
+  ASSERT_NO_THROW(
+      db_->PrefetchMasterlist(masterlistPath, url_, "missing-branch"));
+
+  EXPECT_THROW(
+      db_->UpdateMasterlist(masterlistPath, url_, "missing-branch"),
+      std::system_error);
+}
+
+TEST_P(DatabaseInterfaceTest, loadListsShouldWaitForAPrefetchedMasterlist) {
+  ASSERT_NO_THROW(db_->PrefetchMasterlist(masterlistPath, url_, branch_));
+
+  EXPECT_NO_THROW(db_->LoadLists(masterlistPath, ""));
+  EXPECT_TRUE(std::filesystem::exists(masterlistPath));
+}
+
+TEST_P(DatabaseInterfaceTest,
+       getMasterlistChangesShouldReturnNoChangesIfTheMasterlistWasNotUpdated) {
+  auto changes = db_->GetMasterlistChanges();
+
+  EXPECT_TRUE(changes.plugins.empty());
+  EXPECT_TRUE(changes.groups.empty());
+  EXPECT_TRUE(changes.bash_tags.empty());
+  EXPECT_FALSE(changes.messages_changed);
+}
+
+TEST_P(DatabaseInterfaceTest,
+       getMasterlistChangesShouldReturnTheChangesMadeByAnUpdate) {
+  ASSERT_TRUE(db_->UpdateMasterlist(masterlistPath, url_, branch_));
+
+  // No masterlist was loaded before the update, so all its entries changed.
+  auto changes = db_->GetMasterlistChanges();
+  EXPECT_FALSE(changes.plugins.empty());
+}
+
 TEST_P(DatabaseInterfaceTest,
        getMasterlistRevisionShouldThrowIfNoMasterlistIsPresent) {
   MasterlistInfo info;
@@ -496,6 +615,29 @@ TEST_P(DatabaseInterfaceTest,
   EXPECT_TRUE(groups.find(Group("group4"))->GetAfterGroups().empty());
 }
 
+TEST_P(DatabaseInterfaceTest,
+  getGroupsShouldReflectUserGroupsThatWereSetAfterItWasLastCalled) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+
+  ASSERT_NO_THROW(
+    db_->LoadLists(masterlistPath, userlistPath_));
+
+  auto groups = db_->GetGroups();
+  EXPECT_EQ(0, groups.count(Group("group5")));
+
+  db_->SetUserGroups(std::unordered_set<Group>({
+    Group("group5", {"default"}),
+  }));
+
+  groups = db_->GetGroups();
+  EXPECT_EQ(1, groups.count(Group("group5")));
+  EXPECT_EQ(std::unordered_set<std::string>({"default"}),
+            groups.find(Group("group5"))->GetAfterGroups());
+  EXPECT_EQ(1, db_->GetGroups(false).count(Group("group1")));
+  EXPECT_EQ(0, db_->GetGroups(false).count(Group("group5")));
+}
+
 TEST_P(DatabaseInterfaceTest,
   getGroupsPathShouldReturnTheShortestPathBetweenTheGivenGroups) {
   ASSERT_NO_THROW(GenerateMasterlist());
@@ -513,6 +655,20 @@ TEST_P(DatabaseInterfaceTest,
   EXPECT_FALSE(path[1].GetTypeOfEdgeToNextVertex().has_value());
 }
 
+TEST_P(DatabaseInterfaceTest,
+       getGroupsPathShouldReflectUserGroupsSetSinceItWasLastCalled) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, userlistPath_));
+
+  ASSERT_EQ(2, db_->GetGroupsPath("group1", "group3").size());
+
+  db_->SetUserGroups({Group("group3")});
+
+  EXPECT_TRUE(db_->GetGroupsPath("group1", "group3").empty());
+}
+
 TEST_P(DatabaseInterfaceTest,
        getKnownBashTagsShouldReturnAllBashTagsListedInLoadedMetadata) {
   ASSERT_NO_THROW(GenerateMasterlist());
@@ -559,6 +715,26 @@ TEST_P(
   EXPECT_TRUE(messages.empty());
 }
 
+TEST_P(
+    DatabaseInterfaceTest,
+    getGeneralMessagesShouldNotReuseEvaluatedMessagesAfterTheListsAreReloaded) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, ""));
+
+  EXPECT_TRUE(db_->GetGeneralMessages(true).empty());
+  EXPECT_TRUE(db_->GetGeneralMessages(true).empty());
+
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, userlistPath_));
+
+  auto messages = db_->GetGeneralMessages(true);
+
+  std::vector<Message> expectedMessages({
+      Message(MessageType::say, generalUserlistMessage),
+  });
+  EXPECT_EQ(expectedMessages, messages);
+}
+
 TEST_P(
     DatabaseInterfaceTest,
     getPluginMetadataShouldReturnAnEmptyOptionalIfThePluginHasNoMetadata) {
@@ -609,6 +785,89 @@ TEST_P(
   EXPECT_TRUE(metadata.GetMessages().empty());
 }
 
+TEST_P(DatabaseInterfaceTest,
+       getPluginMetadataBatchShouldReturnTheSameResultsAsGetPluginMetadata) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, userlistPath_));
+
+  std::vector<std::string> plugins({blankEsm, blankDifferentEsp, missingEsp});
+  for (bool includeUserMetadata : {false, true}) {
+    for (bool evaluateConditions : {false, true}) {
+      auto batch = db_->GetPluginMetadataBatch(
+          plugins, includeUserMetadata, evaluateConditions);
+
+      ASSERT_EQ(plugins.size(), batch.size());
+      for (size_t i = 0; i < plugins.size(); ++i) {
+        auto metadata = db_->GetPluginMetadata(
+            plugins[i], includeUserMetadata, evaluateConditions);
+
+        ASSERT_EQ(metadata.has_value(), batch[i].has_value());
+        if (metadata) {
+          EXPECT_EQ(metadata.value().GetLoadAfterFiles(),
+                    batch[i].value().GetLoadAfterFiles());
+          EXPECT_EQ(metadata.value().GetIncompatibilities(),
+                    batch[i].value().GetIncompatibilities());
+          EXPECT_EQ(metadata.value().GetMessages(),
+                    batch[i].value().GetMessages());
+          EXPECT_EQ(metadata.value().GetTags(), batch[i].value().GetTags());
+        }
+      }
+    }
+  }
+}
+
+TEST_P(
+    DatabaseInterfaceTest,
+    getPluginUserMetadataBatchShouldReturnTheSameResultsAsGetPluginUserMetadata) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, userlistPath_));
+
+  std::vector<std::string> plugins({blankEsm, blankDifferentEsp, missingEsp});
+  for (bool evaluateConditions : {false, true}) {
+    auto batch = db_->GetPluginUserMetadataBatch(plugins, evaluateConditions);
+
+    ASSERT_EQ(plugins.size(), batch.size());
+    for (size_t i = 0; i < plugins.size(); ++i) {
+      auto metadata = db_->GetPluginUserMetadata(plugins[i], evaluateConditions);
+
+      ASSERT_EQ(metadata.has_value(), batch[i].has_value());
+      if (metadata) {
+        EXPECT_EQ(metadata.value().GetLoadAfterFiles(),
+                  batch[i].value().GetLoadAfterFiles());
+        EXPECT_EQ(metadata.value().GetRequirements(),
+                  batch[i].value().GetRequirements());
+        EXPECT_EQ(metadata.value().GetMessages(),
+                  batch[i].value().GetMessages());
+        EXPECT_EQ(metadata.value().GetTags(), batch[i].value().GetTags());
+      }
+    }
+  }
+}
+
+TEST_P(
+    DatabaseInterfaceTest,
+    getPluginMetadataShouldReflectUserMetadataChangesIfConditionsAreEvaluated) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, ""));
+
+  auto metadata = db_->GetPluginMetadata(blankEsm, true, true).value();
+  EXPECT_TRUE(metadata.GetRequirements().empty());
+
+  PluginMetadata newMetadata(blankEsm);
+  newMetadata.SetRequirements(std::set<File>({File(masterFile)}));
+  db_->SetPluginUserMetadata(newMetadata);
+
+  metadata = db_->GetPluginMetadata(blankEsm, true, true).value();
+  EXPECT_EQ(newMetadata.GetRequirements(), metadata.GetRequirements());
+
+  db_->DiscardPluginUserMetadata(blankEsm);
+
+  metadata = db_->GetPluginMetadata(blankEsm, true, true).value();
+  EXPECT_TRUE(metadata.GetRequirements().empty());
+}
+
 TEST_P(
     DatabaseInterfaceTest,
     getPluginUserMetadataShouldReturnAnEmptyPluginMetadataObjectIfThePluginHasNoUserMetadata) {
@@ -772,6 +1031,64 @@ TEST_P(DatabaseInterfaceTest,
   EXPECT_EQ(expectedTags, tags);
 }
 
+TEST_P(DatabaseInterfaceTest,
+       applyUserMetadataChangesShouldApplyAllTheGivenChanges) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+  ASSERT_NO_THROW(
+      db_->LoadLists(masterlistPath, userlistPath_));
+
+  PluginMetadata plugin(blankEsp);
+  plugin.SetGroup("group4");
+
+  UserMetadataChanges changes;
+  changes.discarded_plugins = {blankEsm};
+  changes.plugins = {plugin};
+  changes.groups = std::unordered_set<Group>({Group("group4")});
+
+  db_->ApplyUserMetadataChanges(changes);
+
+  EXPECT_FALSE(db_->GetPluginUserMetadata(blankEsm));
+  EXPECT_TRUE(db_->GetPluginUserMetadata(blankDifferentEsp));
+  EXPECT_EQ("group4", db_->GetPluginUserMetadata(blankEsp).value().GetGroup());
+  EXPECT_EQ(1, db_->GetUserGroups().count(Group("group4")));
+}
+
+TEST_P(DatabaseInterfaceTest,
+       saveUserMetadataAsyncShouldSkipWritingUnchangedUserMetadata) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+  ASSERT_NO_THROW(
+      db_->LoadLists(masterlistPath, userlistPath_));
+
+  // The userlist hasn't changed since it was loaded from its file.
+  EXPECT_FALSE(db_->SaveUserMetadataAsync(userlistPath_).get());
+
+  EXPECT_TRUE(db_->SaveUserMetadataAsync(minimalOutputPath_).get());
+  EXPECT_FALSE(db_->SaveUserMetadataAsync(minimalOutputPath_).get());
+}
+
+TEST_P(DatabaseInterfaceTest,
+       saveUserMetadataAsyncShouldWriteTheUserMetadataIfItHasChanged) {
+  ASSERT_NO_THROW(GenerateMasterlist());
+  ASSERT_NO_THROW(GenerateUserlist());
+  ASSERT_NO_THROW(
+      db_->LoadLists(masterlistPath, userlistPath_));
+
+  db_->DiscardPluginUserMetadata(blankEsm);
+
+  EXPECT_TRUE(db_->SaveUserMetadataAsync(userlistPath_).get());
+  EXPECT_FALSE(db_->SaveUserMetadataAsync(userlistPath_).get());
+
+  auto tempPath = userlistPath_;
+  tempPath += ".tmp";
+  EXPECT_FALSE(std::filesystem::exists(tempPath));
+
+  ASSERT_NO_THROW(db_->LoadLists(masterlistPath, userlistPath_));
+  EXPECT_FALSE(db_->GetPluginUserMetadata(blankEsm));
+  EXPECT_TRUE(db_->GetPluginUserMetadata(blankDifferentEsp));
+}
+
 TEST_P(
     DatabaseInterfaceTest,
     discardAllUserMetadataShouldDiscardAllUserMetadataAndNoMasterlistMetadata) {
@@ -91,6 +91,90 @@ TEST_P(GameInterfaceTest, isValidPluginShouldReturnFalseForAnEmptyFile) {
   EXPECT_FALSE(handle_->IsValidPlugin(emptyFile));
 }
 
+TEST_P(GameInterfaceTest,
+       filterValidPluginsShouldReturnTheValidPluginsInTheGivenOrder) {
+  auto plugins = handle_->FilterValidPlugins(
+      {blankEsp, nonPluginFile, "missing.esp", blankMasterDependentEsm, blankEsm});
+
+  ASSERT_EQ(3, plugins.size());
+  EXPECT_EQ(blankEsp, plugins[0]->GetName());
+  EXPECT_EQ(blankMasterDependentEsm, plugins[1]->GetName());
+  EXPECT_EQ(blankEsm, plugins[2]->GetName());
+  EXPECT_EQ("5.0", plugins[2]->GetVersion().value());
+  EXPECT_FALSE(plugins[2]->GetCRC());
+}
+
+TEST_P(GameInterfaceTest, filterValidPluginsShouldNotLoadThePlugins) {
+  handle_->FilterValidPlugins({blankEsm, blankEsp});
+
+  EXPECT_TRUE(handle_->GetLoadedPlugins().empty());
+}
+
+TEST_P(GameInterfaceTest,
+       scanPluginsShouldGiveASummaryOfEachPluginWithoutLoadingThem) {
+  std::vector<PluginSummary> summaries;
+  handle_->ScanPlugins({blankEsm, blankMasterDependentEsm},
+                       false,
+                       [&](const PluginSummary& summary) {
+                         summaries.push_back(summary);
+                       });
+
+  ASSERT_EQ(2, summaries.size());
+  if (summaries[0].name != blankEsm) {
+    std::swap(summaries[0], summaries[1]);
+  }
+  EXPECT_EQ(blankEsm, summaries[0].name);
+  EXPECT_TRUE(summaries[0].masters.empty());
+  EXPECT_TRUE(summaries[0].isMaster);
+  EXPECT_EQ("5.0", summaries[0].version.value());
+  EXPECT_EQ(blankEsmCrc, summaries[0].crc.value());
+  EXPECT_TRUE(summaries[0].overrideRecordCount.has_value());
+  EXPECT_EQ(blankMasterDependentEsm, summaries[1].name);
+  EXPECT_EQ(std::vector<std::string>({blankEsm}), summaries[1].masters);
+
+  EXPECT_TRUE(handle_->GetLoadedPlugins().empty());
+}
+
+TEST_P(GameInterfaceTest,
+       scanPluginsWithHeadersOnlyTrueShouldNotGiveCrcsOrOverrideRecordCounts) {
+  std::vector<PluginSummary> summaries;
+  handle_->ScanPlugins({blankEsm}, true, [&](const PluginSummary& summary) {
+    summaries.push_back(summary);
+  });
+
+  ASSERT_EQ(1, summaries.size());
+  EXPECT_EQ("5.0", summaries[0].version.value());
+  EXPECT_FALSE(summaries[0].crc.has_value());
+  EXPECT_FALSE(summaries[0].overrideRecordCount.has_value());
+}
+
+TEST_P(GameInterfaceTest,
+       scanPluginsShouldThrowForInvalidPluginsOnceTheValidOnesAreScanned) {
+  std::vector<std::string> names;
+  EXPECT_THROW(handle_->ScanPlugins({nonPluginFile, blankEsm, "missing.esp"},
+                                    true,
+                                    [&](const PluginSummary& summary) {
+                                      names.push_back(summary.name);
+                                    }),
+               std::invalid_argument);
+
+  EXPECT_EQ(std::vector<std::string>({blankEsm}), names);
+}
+
+TEST_P(GameInterfaceTest,
+       scanPluginsShouldRethrowAnExceptionThrownByTheCallback) {
+  size_t calls = 0;
+  EXPECT_THROW(handle_->ScanPlugins(pluginsToLoad,
+                                    true,
+                                    [&](const PluginSummary&) {
+                                      ++calls;
+                                      throw std::runtime_error("stop");
+                                    }),
+               std::runtime_error);
+
+  EXPECT_EQ(1, calls);
+}
+
 TEST_P(
     GameInterfaceTest,
     loadPluginsWithHeadersOnlyTrueShouldLoadTheHeadersOfAllInstalledPlugins) {
@@ -188,6 +272,207 @@ TEST_P(GameInterfaceTest, sortPluginsShouldSucceedIfPassedValidArguments) {
   EXPECT_EQ(expectedOrder, actualOrder);
 }
 
+TEST_P(GameInterfaceTest, sortProfilesShouldReturnAnEmptyListIfGivenNoProfiles) {
+  EXPECT_TRUE(handle_->SortProfiles({}).empty());
+}
+
+TEST_P(GameInterfaceTest,
+       sortProfilesShouldSortEachProfileAgainstItsOwnLoadOrder) {
+  SortProfile espProfile;
+  espProfile.plugins = {blankEsp, blankDifferentEsp};
+  espProfile.loadOrder = {blankDifferentEsp, blankEsp};
+
+  SortProfile esmProfile;
+  esmProfile.plugins = {blankMasterDependentEsm, blankEsm};
+
+  handle_->LoadCurrentLoadOrderState();
+  auto sorted = handle_->SortProfiles({espProfile, esmProfile});
+
+  ASSERT_EQ(2, sorted.size());
+  EXPECT_EQ(std::vector<std::string>({blankDifferentEsp, blankEsp}),
+            sorted[0]);
+  EXPECT_EQ(std::vector<std::string>({blankEsm, blankMasterDependentEsm}),
+            sorted[1]);
+  EXPECT_EQ(4, handle_->GetLoadedPlugins().size());
+}
+
+TEST_P(GameInterfaceTest, getPluginsPathShouldThrowIfNoPluginsHaveBeenSorted) {
+  EXPECT_THROW(handle_->GetPluginsPath(blankEsm, blankMasterDependentEsm),
+               std::invalid_argument);
+}
+
+TEST_P(GameInterfaceTest,
+       getPluginsPathShouldExplainWhyAPluginLoadsAfterAnotherInTheLastSort) {
+  handle_->LoadCurrentLoadOrderState();
+  handle_->SortPlugins({blankEsm, blankMasterDependentEsm, blankEsp});
+
+  auto path = handle_->GetPluginsPath(blankEsm, blankMasterDependentEsm);
+
+  ASSERT_EQ(2, path.size());
+  EXPECT_EQ(blankEsm, path[0].GetName());
+  EXPECT_EQ(EdgeType::master, path[0].GetTypeOfEdgeToNextVertex());
+  EXPECT_EQ(blankMasterDependentEsm, path[1].GetName());
+  EXPECT_FALSE(path[1].GetTypeOfEdgeToNextVertex().has_value());
+
+  EXPECT_THROW(handle_->GetPluginsPath(blankEsm, blankDifferentEsm),
+               std::invalid_argument);
+}
+
+TEST_P(GameInterfaceTest,
+       getLoadedPluginTableShouldBeEmptyIfNoPluginsAreLoaded) {
+  auto table = handle_->GetLoadedPluginTable();
+
+  EXPECT_EQ(0, table.Size());
+  EXPECT_TRUE(table.strings.empty());
+  EXPECT_EQ(std::vector<uint32_t>({0}), table.masterStarts);
+}
+
+TEST_P(GameInterfaceTest,
+       getLoadedPluginTableShouldMatchTheLoadedPluginsInFilenameOrder) {
+  handle_->LoadPlugins({blankMasterDependentEsm, blankEsm, blankEsp}, false);
+  handle_->GetPlugin(blankEsm)->GetCRC();
+
+  auto table = handle_->GetLoadedPluginTable();
+
+  ASSERT_EQ(3, table.Size());
+  ASSERT_EQ(4, table.masterStarts.size());
+  const auto getString = [&](uint32_t offset, uint32_t length) {
+    return table.strings.substr(offset, length);
+  };
+
+  const std::vector<std::string> expectedNames(
+      {blankMasterDependentEsm, blankEsm, blankEsp});
+  for (size_t i = 0; i < table.Size(); ++i) {
+    const auto name =
+        getString(table.nameOffsets[i], table.nameLengths[i]);
+    EXPECT_EQ(expectedNames[i], name);
+
+    const auto plugin = handle_->GetPlugin(name);
+    ASSERT_NE(nullptr, plugin);
+    EXPECT_EQ(plugin->IsMaster(),
+              (table.flags[i] & LoadedPluginTable::isMaster) != 0);
+    EXPECT_EQ(plugin->IsEmpty(),
+              (table.flags[i] & LoadedPluginTable::isEmpty) != 0);
+    EXPECT_EQ(0, table.flags[i] & LoadedPluginTable::isHeaderOnly);
+
+    std::vector<std::string> masters;
+    for (auto j = table.masterStarts[i]; j < table.masterStarts[i + 1]; ++j) {
+      masters.push_back(
+          getString(table.masterOffsets[j], table.masterLengths[j]));
+    }
+    EXPECT_EQ(plugin->GetMasters(), masters);
+
+    if (name == blankEsm) {
+      ASSERT_NE(0, table.flags[i] & LoadedPluginTable::hasCrc);
+      EXPECT_EQ(blankEsmCrc, table.crcs[i]);
+    }
+
+    if (plugin->GetVersion().has_value()) {
+      ASSERT_NE(0, table.flags[i] & LoadedPluginTable::hasVersion);
+      EXPECT_EQ(plugin->GetVersion().value(),
+                getString(table.versionOffsets[i], table.versionLengths[i]));
+    }
+  }
+}
+
+TEST_P(GameInterfaceTest,
+       getOverlappingPluginsShouldReturnAnEmptyVectorIfThePluginIsNotLoaded) {
+  EXPECT_TRUE(handle_->GetOverlappingPlugins(blankEsm).empty());
+}
+
+TEST_P(GameInterfaceTest,
+       getOverlappingPluginsShouldReturnPluginsWhoseRecordsOverlap) {
+  handle_->LoadPlugins({blankEsm, blankMasterDependentEsm, blankEsp}, false);
+
+  EXPECT_EQ(std::vector<std::string>({blankMasterDependentEsm}),
+            handle_->GetOverlappingPlugins(blankEsm));
+  EXPECT_EQ(std::vector<std::string>({blankEsm}),
+            handle_->GetOverlappingPlugins(blankMasterDependentEsm));
+}
+
+TEST_P(GameInterfaceTest,
+       getOverlappingPluginsShouldReturnAnEmptyVectorForAHeaderOnlyPlugin) {
+  handle_->LoadPlugins({blankEsm, blankMasterDependentEsm}, true);
+
+  EXPECT_TRUE(handle_->GetOverlappingPlugins(blankEsm).empty());
+}
+
+TEST_P(GameInterfaceTest,
+       getPluginOverlapsShouldMatchGettingEachPluginsOverlappingPlugins) {
+  handle_->LoadPlugins({blankEsm, blankMasterDependentEsm, blankEsp}, false);
+
+  auto overlaps = handle_->GetPluginOverlaps(
+      {blankEsm, blankMasterDependentEsm, blankEsp});
+
+  ASSERT_EQ(3, overlaps.size());
+  EXPECT_EQ(std::vector<std::string>({blankMasterDependentEsm}), overlaps[0]);
+  EXPECT_EQ(std::vector<std::string>({blankEsm}), overlaps[1]);
+  EXPECT_TRUE(overlaps[2].empty());
+}
+
+TEST_P(GameInterfaceTest,
+       getPluginOverlapsShouldGiveAnEmptyElementForAPluginThatIsNotLoaded) {
+  handle_->LoadPlugins({blankEsm}, false);
+
+  auto overlaps = handle_->GetPluginOverlaps({blankEsm, blankMasterDependentEsm});
+
+  EXPECT_EQ(std::vector<std::vector<std::string>>(2), overlaps);
+}
+
+TEST_P(GameInterfaceTest,
+       getDependentPluginsShouldReturnAnEmptyVectorIfNoPluginsAreLoaded) {
+  EXPECT_TRUE(handle_->GetDependentPlugins(blankEsm).empty());
+}
+
+TEST_P(GameInterfaceTest,
+       getDependentPluginsShouldReturnLoadedPluginsThatHaveTheGivenMaster) {
+  handle_->LoadPlugins(
+      {blankMasterDependentEsp, blankEsm, blankMasterDependentEsm, blankEsp},
+      true);
+
+  EXPECT_EQ(
+      std::vector<std::string>({blankMasterDependentEsm, blankMasterDependentEsp}),
+      handle_->GetDependentPlugins(boost::to_upper_copy(blankEsm)));
+  EXPECT_TRUE(handle_->GetDependentPlugins(blankEsp).empty());
+}
+
+TEST_P(GameInterfaceTest,
+       arePluginsValidAsLightMastersShouldMatchCheckingEachPlugin) {
+  handle_->LoadPlugins({blankEsm, blankMasterDependentEsm, blankEsp}, false);
+
+  auto areValid = handle_->ArePluginsValidAsLightMasters(
+      {blankEsm, blankMasterDependentEsm, blankEsp});
+
+  ASSERT_EQ(3, areValid.size());
+  EXPECT_EQ(handle_->GetPlugin(blankEsm)->IsValidAsLightMaster(), areValid[0]);
+  EXPECT_EQ(handle_->GetPlugin(blankMasterDependentEsm)->IsValidAsLightMaster(),
+            areValid[1]);
+  EXPECT_EQ(handle_->GetPlugin(blankEsp)->IsValidAsLightMaster(), areValid[2]);
+}
+
+TEST_P(GameInterfaceTest,
+       arePluginsValidAsLightMastersShouldBeFalseForPluginsThatAreNotLoaded) {
+  EXPECT_EQ(std::vector<bool>({false}),
+            handle_->ArePluginsValidAsLightMasters({blankEsm}));
+}
+
+TEST_P(GameInterfaceTest,
+       getDependentPluginsShouldNotRequireTheMasterToBeLoaded) {
+  handle_->LoadPlugins({blankMasterDependentEsm}, true);
+
+  EXPECT_EQ(std::vector<std::string>({blankMasterDependentEsm}),
+            handle_->GetDependentPlugins(blankEsm));
+}
+
+TEST_P(GameInterfaceTest, writeSortCaptureShouldWriteAFileForTheGivenPlugins) {
+  auto capturePath = localPath / "sort.capture";
+
+  handle_->LoadCurrentLoadOrderState();
+  handle_->WriteSortCapture({masterFile, blankEsm, blankEsp}, capturePath);
+
+  EXPECT_TRUE(std::filesystem::exists(capturePath));
+}
+
 TEST_P(GameInterfaceTest,
        isPluginActiveShouldReturnFalseIfTheGivenPluginIsNotActive) {
   handle_->LoadCurrentLoadOrderState();
@@ -200,6 +485,23 @@ TEST_P(GameInterfaceTest,
   EXPECT_FALSE(handle_->IsPluginActive(blankEsp));
 }
 
+TEST_P(GameInterfaceTest,
+       arePluginsActiveShouldReturnTheActiveStateOfEachGivenPlugin) {
+  handle_->LoadCurrentLoadOrderState();
+
+  auto areActive =
+      handle_->ArePluginsActive({blankEsm, blankEsp, blankEsm, missingEsp});
+
+  EXPECT_EQ(std::vector<bool>({true, false, true, false}), areActive);
+}
+
+TEST_P(GameInterfaceTest,
+       arePluginsActiveShouldReturnAnEmptyVectorIfGivenNoPlugins) {
+  handle_->LoadCurrentLoadOrderState();
+
+  EXPECT_TRUE(handle_->ArePluginsActive({}).empty());
+}
+
 TEST_P(GameInterfaceTest, getLoadOrderShouldReturnTheCurrentLoadOrder) {
   // Remove the non-ASCII duplicate plugin.
   std::filesystem::remove(dataPath / std::filesystem::u8path(nonAsciiEsm));
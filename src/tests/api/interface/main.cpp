@@ -29,6 +29,7 @@
 #include "tests/api/interface/database_interface_test.h"
 #include "tests/api/interface/game_interface_test.h"
 #include "tests/api/interface/is_compatible_test.h"
+#include "tests/api/interface/update_masterlists_test.h"
 
 #include <boost/locale.hpp>
 
@@ -63,5 +64,63 @@ TEST(SetLoggingCallback, shouldWriteMessagesToGivenCallback) {
 
   FAIL();
 }
+
+TEST(SetAsyncLoggingCallback, shouldThrowIfTheQueueSizeIsZero) {
+  EXPECT_THROW(SetAsyncLoggingCallback(
+                   [](LogLevel, const char *) {}, 0, LogOverflowPolicy::block),
+               std::invalid_argument);
+}
+
+TEST(SetAsyncLoggingCallback,
+     shouldWriteQueuedMessagesToGivenCallbackBeforeItIsReplaced) {
+  std::string loggedMessages;
+  SetAsyncLoggingCallback(
+      [&](LogLevel level, const char *string) {
+        loggedMessages += std::string(string);
+      },
+      16,
+      LogOverflowPolicy::block);
+
+  EXPECT_THROW(CreateGameHandle(GameType::tes4, "dummy"),
+               std::invalid_argument);
+
+  SetLoggingCallback([](LogLevel, const char *) {});
+
+  EXPECT_EQ(
+      "Attempting to create a game handle with game path \"dummy\" "
+      "and local path \"\"",
+      loggedMessages);
+}
+
+TEST(SetLogLevel, shouldNotWriteMessagesBelowTheGivenLevelToTheCallback) {
+  std::string loggedMessages;
+  SetLoggingCallback([&](LogLevel level, const char *string) {
+    loggedMessages += std::string(string);
+  });
+  SetLogLevel(LogLevel::warning);
+
+  EXPECT_THROW(CreateGameHandle(GameType::tes4, "dummy"),
+               std::invalid_argument);
+  EXPECT_EQ("", loggedMessages);
+
+  SetLogLevel(LogLevel::trace);
+  SetLoggingCallback([](LogLevel, const char *) {});
+}
+
+TEST(SetLogLevel, shouldApplyToLoggingCallbacksThatAreSetLater) {
+  SetLogLevel(LogLevel::warning);
+
+  std::string loggedMessages;
+  SetLoggingCallback([&](LogLevel level, const char *string) {
+    loggedMessages += std::string(string);
+  });
+
+  EXPECT_THROW(CreateGameHandle(GameType::tes4, "dummy"),
+               std::invalid_argument);
+  EXPECT_EQ("", loggedMessages);
+
+  SetLogLevel(LogLevel::trace);
+  SetLoggingCallback([](LogLevel, const char *) {});
+}
 }
 }
@@ -0,0 +1,148 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERFACE_UPDATE_MASTERLISTS_TEST
+#define LOOT_TESTS_API_INTERFACE_UPDATE_MASTERLISTS_TEST
+
+#include "loot/api.h"
+
+#include "tests/api/interface/api_game_operations_test.h"
+
+namespace loot {
+namespace test {
+class UpdateMasterlistsTest : public ApiGameOperationsTest {
+protected:
+  UpdateMasterlistsTest() :
+      url_("https://github.com/loot/testing-metadata.git"),
+      branch_("master"),
+      otherMasterlistPath_(localPath / "other" / "masterlist.yaml") {}
+
+  void SetUp() {
+    ApiGameOperationsTest::SetUp();
+
+    otherHandle_ =
+        CreateGameHandle(GetParam(), dataPath.parent_path(), localPath);
+    std::filesystem::create_directory(otherMasterlistPath_.parent_path());
+  }
+
+  MasterlistUpdate CreateUpdate(std::shared_ptr<GameInterface> handle,
+                                const std::filesystem::path& path,
+                                const std::string& branch) {
+    MasterlistUpdate update;
+    update.database = handle->GetDatabase();
+    update.masterlist_path = path;
+    update.remote_url = url_;
+    update.remote_branch = branch;
+
+    return update;
+  }
+
+  const std::string url_;
+  const std::string branch_;
+  const std::filesystem::path otherMasterlistPath_;
+
+  std::shared_ptr<GameInterface> otherHandle_;
+};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(,
+                        UpdateMasterlistsTest,
+                        ::testing::Values(GameType::tes4,
+                                          GameType::tes5,
+                                          GameType::fo3,
+                                          GameType::fonv,
+                                          GameType::fo4,
+                                          GameType::tes5se));
+
+TEST_P(UpdateMasterlistsTest, shouldThrowIfTwoUpdatesHaveTheSameDatabase) {
+  std::vector<MasterlistUpdate> updates({
+      CreateUpdate(handle_, masterlistPath, branch_),
+      CreateUpdate(handle_, otherMasterlistPath_, branch_),
+  });
+
+  EXPECT_THROW(UpdateMasterlists(updates), std::invalid_argument);
+  EXPECT_FALSE(std::filesystem::exists(masterlistPath));
+}
+
+TEST_P(UpdateMasterlistsTest, shouldThrowIfTwoUpdatesHaveTheSamePath) {
+  std::vector<MasterlistUpdate> updates({
+      CreateUpdate(handle_, masterlistPath, branch_),
+      CreateUpdate(otherHandle_, masterlistPath, branch_),
+  });
+
+  EXPECT_THROW(UpdateMasterlists(updates), std::invalid_argument);
+  EXPECT_FALSE(std::filesystem::exists(masterlistPath));
+}
+
+TEST_P(UpdateMasterlistsTest, shouldReturnAnEmptyVectorIfGivenNoUpdates) {
+  EXPECT_TRUE(UpdateMasterlists({}).empty());
+}
+
+TEST_P(UpdateMasterlistsTest,
+       shouldUpdateEachMasterlistAndReturnTheResultsInTheGivenOrder) {
+  std::vector<MasterlistUpdate> updates({
+      CreateUpdate(handle_, masterlistPath, branch_),
+      CreateUpdate(otherHandle_, otherMasterlistPath_, branch_),
+  });
+
+  auto results = UpdateMasterlists(updates);
+
+  ASSERT_EQ(2, results.size());
+  for (const auto& result : results) {
+    EXPECT_TRUE(result.was_updated);
+    EXPECT_FALSE(result.error);
+  }
+  EXPECT_TRUE(std::filesystem::exists(masterlistPath));
+  EXPECT_TRUE(std::filesystem::exists(otherMasterlistPath_));
+  EXPECT_FALSE(handle_->GetDatabase()->GetGroups(false).empty());
+
+  results = UpdateMasterlists(updates);
+
+  ASSERT_EQ(2, results.size());
+  for (const auto& result : results) {
+    EXPECT_FALSE(result.was_updated);
+    EXPECT_FALSE(result.error);
+  }
+}
+
+TEST_P(UpdateMasterlistsTest, shouldNotStopOtherUpdatesIfOneFails) {
+  std::vector<MasterlistUpdate> updates({
+      CreateUpdate(handle_, masterlistPath, "missing-branch"),
+      CreateUpdate(otherHandle_, otherMasterlistPath_, branch_),
+  });
+
+  auto results = UpdateMasterlists(updates);
+
+  ASSERT_EQ(2, results.size());
+  EXPECT_FALSE(results[0].was_updated);
+  EXPECT_THROW(std::rethrow_exception(results[0].error), std::system_error);
+  EXPECT_TRUE(results[1].was_updated);
+  EXPECT_FALSE(results[1].error);
+}
+}
+}
+
+#endif
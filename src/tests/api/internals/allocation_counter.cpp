@@ -0,0 +1,175 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#include "tests/api/internals/allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Plain integers so that they're constant-initialised and can be used by
+// allocations made before main() or during thread startup.
+thread_local size_t allocationCount = 0;
+thread_local size_t allocatedBytes = 0;
+
+void* Allocate(std::size_t size) {
+  ++allocationCount;
+  allocatedBytes += size;
+
+  // malloc(0) may return a null pointer, but operator new must not.
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+  ++allocationCount;
+  allocatedBytes += size;
+
+  const auto align = static_cast<std::size_t>(alignment);
+  if (size == 0) {
+    size = align;
+  }
+
+#ifdef _WIN32
+  return _aligned_malloc(size, align);
+#else
+  // aligned_alloc() requires the size to be a multiple of the alignment.
+  return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+}
+
+void DeallocateAligned(void* pointer) noexcept {
+#ifdef _WIN32
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+}
+
+namespace loot {
+namespace test {
+AllocationCounter::AllocationCounter() :
+    startCount_(allocationCount), startBytes_(allocatedBytes) {}
+
+size_t AllocationCounter::GetCount() const {
+  return allocationCount - startCount_;
+}
+
+size_t AllocationCounter::GetBytes() const {
+  return allocatedBytes - startBytes_;
+}
+}
+}
+
+void* operator new(std::size_t size) {
+  auto pointer = Allocate(size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  auto pointer = AllocateAligned(size, alignment);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size,
+                   std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return AllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size,
+                     std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  DeallocateAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+  DeallocateAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+  DeallocateAligned(pointer);
+}
+
+void operator delete[](void* pointer,
+                       std::size_t,
+                       std::align_val_t) noexcept {
+  DeallocateAligned(pointer);
+}
+
+void operator delete(void* pointer,
+                     std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  DeallocateAligned(pointer);
+}
+
+void operator delete[](void* pointer,
+                       std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  DeallocateAligned(pointer);
+}
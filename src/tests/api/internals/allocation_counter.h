@@ -0,0 +1,52 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_ALLOCATION_COUNTER
+#define LOOT_TESTS_API_INTERNALS_ALLOCATION_COUNTER
+
+#include <cstddef>
+
+namespace loot {
+namespace test {
+// Counts the heap allocations made through operator new by the thread that
+// created the counter, from its construction until the counts are read.
+// Allocations made by other threads, such as thread pool workers, aren't
+// counted, so operations under test should be given inputs small enough to
+// run on the calling thread. The global operator new and delete replacements
+// that do the counting are defined in allocation_counter.cpp.
+class AllocationCounter {
+public:
+  AllocationCounter();
+
+  size_t GetCount() const;
+  size_t GetBytes() const;
+
+private:
+  size_t startCount_;
+  size_t startBytes_;
+};
+}
+}
+
+#endif
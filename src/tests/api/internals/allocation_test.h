@@ -0,0 +1,189 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_ALLOCATION_TEST
+#define LOOT_TESTS_API_INTERNALS_ALLOCATION_TEST
+
+#include <fstream>
+#include <memory>
+
+#include "api/game/game.h"
+#include "api/metadata/condition_evaluator.h"
+#include "api/metadata_list.h"
+#include "tests/api/internals/allocation_counter.h"
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+TEST(AllocationCounter, shouldCountAllocationsMadeSinceItWasConstructed) {
+  auto before = std::make_unique<int>(1);
+
+  AllocationCounter counter;
+  EXPECT_EQ(0, counter.GetCount());
+  EXPECT_EQ(0, counter.GetBytes());
+
+  auto after = std::make_unique<int>(2);
+  auto array = std::make_unique<char[]>(100);
+
+  EXPECT_EQ(2, counter.GetCount());
+  EXPECT_LE(sizeof(int) + 100, counter.GetBytes());
+}
+
+class AllocationTest : public CommonGameTestFixture {
+protected:
+  AllocationTest() :
+      metadataPath(metadataFilesPath / "allocations.yaml"),
+      game_(GetParam(), dataPath.parent_path(), localPath) {}
+
+  // Writes a metadata file with the given number of plugin entries, each
+  // with a tag and a conditional tag.
+  void WriteMetadataFile(size_t numberOfPlugins) {
+    std::ofstream out(metadataPath);
+    out << "plugins:" << std::endl;
+    for (size_t i = 0; i < numberOfPlugins; ++i) {
+      out << "  - name: " << i << ".esp" << std::endl
+          << "    tag:" << std::endl
+          << "      - Relev" << std::endl
+          << "      - name: Delev" << std::endl
+          << "        condition: 'file(\"" << blankEsm << "\")'"
+          << std::endl;
+    }
+    out.close();
+  }
+
+  // Gets the number of allocations made by FindPlugin() for a plugin entry
+  // in a list with the given number of entries.
+  size_t CountFindPluginAllocations(size_t numberOfPlugins) {
+    WriteMetadataFile(numberOfPlugins);
+
+    MetadataList metadataList;
+    metadataList.Load(metadataPath);
+
+    AllocationCounter counter;
+    auto plugin = metadataList.FindPlugin("0.esp");
+    auto count = counter.GetCount();
+
+    EXPECT_TRUE(plugin.has_value());
+    return count;
+  }
+
+  const std::filesystem::path metadataPath;
+  Game game_;
+};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(, AllocationTest, ::testing::Values(GameType::tes5));
+
+TEST_P(AllocationTest, gameCacheGetPluginShouldNotAllocateForAShortAsciiName) {
+  auto cache = game_.GetCache();
+  cache->AddPlugin(
+      Plugin(game_.Type(), cache, game_.DataPath() / blankEsm, true));
+
+  AllocationCounter counter;
+  auto plugin = cache->GetPlugin(blankEsm);
+  auto missingPlugin = cache->GetPlugin("missing.esp");
+
+  EXPECT_EQ(0, counter.GetCount());
+  EXPECT_NE(nullptr, plugin);
+  EXPECT_EQ(nullptr, missingPlugin);
+}
+
+TEST_P(AllocationTest,
+       metadataListFindPluginAllocationsShouldNotDependOnTheNumberOfEntries) {
+  auto smallListCount = CountFindPluginAllocations(10);
+  auto largeListCount = CountFindPluginAllocations(1000);
+
+  EXPECT_EQ(smallListCount, largeListCount);
+}
+
+TEST_P(AllocationTest,
+       metadataListFindPluginShouldOnlyAllocateToCopyTheMatchingEntry) {
+  WriteMetadataFile(10);
+
+  MetadataList metadataList;
+  metadataList.Load(metadataPath);
+  auto entry = metadataList.FindPlugin("0.esp");
+  ASSERT_TRUE(entry.has_value());
+
+  AllocationCounter copyCounter;
+  auto copy = entry;
+  auto copyCount = copyCounter.GetCount();
+
+  AllocationCounter counter;
+  auto plugin = metadataList.FindPlugin("0.esp");
+
+  EXPECT_GE(copyCount, counter.GetCount());
+}
+
+TEST_P(AllocationTest,
+       evaluateAllShouldNotAllocateMoreOnceTheConditionResultsAreCached) {
+  ConditionEvaluator evaluator(game_.Type(), game_.DataPath());
+  PluginMetadata metadata("Blank.esp");
+  metadata.SetTags({Tag("Relev"), Tag("Delev", true, "file(\"Blank.esm\")")});
+
+  AllocationCounter firstCounter;
+  evaluator.EvaluateAll(metadata);
+  auto firstCount = firstCounter.GetCount();
+
+  AllocationCounter secondCounter;
+  evaluator.EvaluateAll(metadata);
+  auto secondCount = secondCounter.GetCount();
+  auto secondBytes = secondCounter.GetBytes();
+
+  AllocationCounter thirdCounter;
+  auto evaluated = evaluator.EvaluateAll(metadata);
+
+  EXPECT_GE(firstCount, secondCount);
+  EXPECT_EQ(secondCount, thirdCounter.GetCount());
+  EXPECT_EQ(secondBytes, thirdCounter.GetBytes());
+  EXPECT_EQ(2, evaluated.GetTags().size());
+}
+
+TEST_P(AllocationTest,
+       getPluginMetadataShouldOnlyAllocateAFixedOverheadAndTheResultWhenCached) {
+  WriteMetadataFile(10);
+  auto database = game_.GetDatabase();
+  database->LoadLists(metadataPath);
+
+  // Populate the evaluated metadata cache.
+  auto metadata = database->GetPluginMetadata("0.esp", true, true);
+  ASSERT_TRUE(metadata.has_value());
+
+  AllocationCounter copyCounter;
+  auto copy = metadata;
+  auto copyCount = copyCounter.GetCount();
+
+  AllocationCounter counter;
+  auto cached = database->GetPluginMetadata("0.esp", true, true);
+
+  // The fixed overhead is for the vectors that the lookup is batched through.
+  EXPECT_GE(copyCount + 4, counter.GetCount());
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(2, cached.value().GetTags().size());
+}
+}
+}
+
+#endif
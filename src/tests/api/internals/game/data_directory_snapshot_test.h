@@ -0,0 +1,153 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_GAME_DATA_DIRECTORY_SNAPSHOT_TEST
+#define LOOT_TESTS_API_INTERNALS_GAME_DATA_DIRECTORY_SNAPSHOT_TEST
+
+#include "api/game/data_directory_snapshot.h"
+
+#include "api/helpers/text.h"
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+class DataDirectorySnapshotTest : public CommonGameTestFixture {};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(,
+                        DataDirectorySnapshotTest,
+                        ::testing::Values(GameType::tes5));
+
+TEST_P(DataDirectorySnapshotTest,
+       constructorShouldGiveAnEmptySnapshotIfTheDirectoryDoesNotExist) {
+  DataDirectorySnapshot snapshot(dataPath / "missing");
+
+  EXPECT_TRUE(snapshot.GetEntries().empty());
+}
+
+TEST_P(DataDirectorySnapshotTest,
+       findFileShouldReturnTheEntryForAFileInTheDirectory) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  auto entry = snapshot.FindFile(blankEsm);
+
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(dataPath / blankEsm, entry->path);
+  EXPECT_EQ(blankEsm, entry->filename);
+  EXPECT_EQ(NormalizeFilename(blankEsm), entry->normalizedFilename);
+  EXPECT_EQ(std::filesystem::file_size(dataPath / blankEsm), entry->fileSize);
+  EXPECT_EQ(std::filesystem::last_write_time(dataPath / blankEsm),
+            entry->modificationTime);
+}
+
+TEST_P(DataDirectorySnapshotTest,
+       findFileShouldReturnNullIfTheFileIsNotInTheDirectory) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  EXPECT_EQ(nullptr, snapshot.FindFile(missingEsp));
+}
+
+TEST_P(DataDirectorySnapshotTest, findFileShouldNotFindAFileCreatedAfterwards) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  std::ofstream out(dataPath / missingEsp);
+  out.close();
+
+  EXPECT_EQ(nullptr, snapshot.FindFile(missingEsp));
+}
+
+#ifdef _WIN32
+TEST_P(DataDirectorySnapshotTest, findFileShouldBeCaseInsensitiveOnWindows) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  EXPECT_NE(nullptr, snapshot.FindFile(boost::to_lower_copy(blankEsm)));
+}
+#else
+TEST_P(DataDirectorySnapshotTest, findFileShouldBeCaseSensitiveOnLinux) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  EXPECT_EQ(nullptr, snapshot.FindFile(boost::to_lower_copy(blankEsm)));
+}
+#endif
+
+TEST_P(DataDirectorySnapshotTest,
+       findPluginShouldFallBackToTheGhostedFilename) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  auto entry = snapshot.FindPlugin(blankMasterDependentEsm);
+
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(blankMasterDependentEsm + ".ghost", entry->filename);
+}
+
+TEST_P(DataDirectorySnapshotTest,
+       findPluginShouldReturnNullIfNeitherFilenameExists) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  EXPECT_EQ(nullptr, snapshot.FindPlugin(missingEsp));
+}
+
+TEST_P(DataDirectorySnapshotTest, refreshShouldAddEntriesForNewFiles) {
+  DataDirectorySnapshot snapshot(dataPath);
+  auto numEntries = snapshot.GetEntries().size();
+
+  std::ofstream out(dataPath / missingEsp);
+  out.close();
+  snapshot.Refresh({missingEsp});
+
+  EXPECT_NE(nullptr, snapshot.FindFile(missingEsp));
+  EXPECT_NE(nullptr, snapshot.FindFile(blankEsm));
+  EXPECT_EQ(numEntries + 1, snapshot.GetEntries().size());
+}
+
+TEST_P(DataDirectorySnapshotTest, refreshShouldUpdateEntriesForChangedFiles) {
+  DataDirectorySnapshot snapshot(dataPath);
+
+  std::ofstream out(dataPath / blankEsp, std::ios_base::app);
+  out << "appended";
+  out.close();
+  snapshot.Refresh({blankEsp});
+
+  auto entry = snapshot.FindFile(blankEsp);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(std::filesystem::file_size(dataPath / blankEsp), entry->fileSize);
+}
+
+TEST_P(DataDirectorySnapshotTest, refreshShouldRemoveEntriesForDeletedFiles) {
+  DataDirectorySnapshot snapshot(dataPath);
+  auto numEntries = snapshot.GetEntries().size();
+
+  std::filesystem::remove(dataPath / blankEsp);
+  snapshot.Refresh({blankEsp, missingEsp});
+
+  EXPECT_EQ(nullptr, snapshot.FindFile(blankEsp));
+  EXPECT_NE(nullptr, snapshot.FindFile(blankEsm));
+  EXPECT_EQ(numEntries - 1, snapshot.GetEntries().size());
+}
+}
+}
+
+#endif
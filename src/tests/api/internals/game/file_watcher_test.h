@@ -0,0 +1,126 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_GAME_FILE_WATCHER_TEST
+#define LOOT_TESTS_API_INTERNALS_GAME_FILE_WATCHER_TEST
+
+#include "api/game/file_watcher.h"
+
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+class FileWatcherTest : public CommonGameTestFixture {
+protected:
+  bool hasChange(const std::vector<FileWatcher::Change>& changes,
+                 const std::string& filename) {
+    for (const auto& change : changes) {
+      if (change.directory == dataPath && change.filename == filename) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(,
+                        FileWatcherTest,
+                        ::testing::Values(GameType::tes5));
+
+TEST_P(FileWatcherTest, readChangesShouldReturnNothingIfNoFilesHaveChanged) {
+  FileWatcher watcher({dataPath});
+
+  EXPECT_TRUE(watcher.ReadChanges().empty());
+}
+
+TEST_P(FileWatcherTest, isWatchingShouldBeFalseForADirectoryThatDoesNotExist) {
+  FileWatcher watcher({dataPath / "missing"});
+
+  EXPECT_FALSE(watcher.IsWatching(dataPath / "missing"));
+}
+
+#ifdef __linux__
+TEST_P(FileWatcherTest, isWatchingShouldBeTrueForAnExistingDirectory) {
+  FileWatcher watcher({dataPath});
+
+  EXPECT_TRUE(watcher.IsWatching(dataPath));
+  EXPECT_FALSE(watcher.IsWatching(localPath));
+}
+
+TEST_P(FileWatcherTest, readChangesShouldIncludeCreatedChangedAndDeletedFiles) {
+  FileWatcher watcher({dataPath});
+
+  std::ofstream out(dataPath / missingEsp);
+  out.close();
+  std::ofstream append(dataPath / blankEsp, std::ios_base::app);
+  append << "appended";
+  append.close();
+  std::filesystem::remove(dataPath / blankDifferentEsp);
+
+  auto changes = watcher.ReadChanges();
+
+  EXPECT_TRUE(hasChange(changes, missingEsp));
+  EXPECT_TRUE(hasChange(changes, blankEsp));
+  EXPECT_TRUE(hasChange(changes, blankDifferentEsp));
+  EXPECT_FALSE(hasChange(changes, blankEsm));
+}
+
+TEST_P(FileWatcherTest, readChangesShouldNotReturnTheSameChangesTwice) {
+  FileWatcher watcher({dataPath});
+
+  std::ofstream out(dataPath / missingEsp);
+  out.close();
+
+  EXPECT_FALSE(watcher.ReadChanges().empty());
+  EXPECT_TRUE(watcher.ReadChanges().empty());
+}
+
+TEST_P(FileWatcherTest,
+       readChangesShouldReturnAnUnnamedChangeIfAWatchedDirectoryIsDeleted) {
+  auto directory = dataPath / "watched";
+  std::filesystem::create_directory(directory);
+  FileWatcher watcher({directory});
+
+  std::filesystem::remove(directory);
+  auto changes = watcher.ReadChanges();
+
+  ASSERT_FALSE(changes.empty());
+  EXPECT_EQ(directory, changes.back().directory);
+  EXPECT_TRUE(changes.back().filename.empty());
+  EXPECT_FALSE(watcher.IsWatching(directory));
+}
+#else
+TEST_P(FileWatcherTest, isWatchingShouldBeFalseOnUnsupportedPlatforms) {
+  FileWatcher watcher({dataPath});
+
+  EXPECT_FALSE(watcher.IsWatching(dataPath));
+}
+#endif
+}
+}
+
+#endif
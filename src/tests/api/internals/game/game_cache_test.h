@@ -27,7 +27,11 @@ along with LOOT.  If not, see
 
 #include "api/game/game_cache.h"
 
+#include <set>
+#include <thread>
+
 #include "api/game/game.h"
+#include "api/helpers/text.h"
 #include "tests/common_game_test_fixture.h"
 
 namespace loot {
@@ -106,6 +110,220 @@ TEST_P(GameCacheTest,
   EXPECT_FALSE(cache_.GetPlugins().empty());
 }
 
+TEST_P(GameCacheTest, forEachPluginShouldCallTheFunctionOnceForEachPlugin) {
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankEsm,
+                          true));
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankMasterDependentEsm,
+                          true));
+
+  std::set<std::shared_ptr<const Plugin>> plugins;
+  cache_.ForEachPlugin([&](const std::shared_ptr<const Plugin>& plugin) {
+    EXPECT_TRUE(plugins.insert(plugin).second);
+  });
+
+  EXPECT_EQ(2, cache_.NumPlugins());
+  EXPECT_EQ(cache_.GetPlugins(), plugins);
+}
+
+TEST_P(GameCacheTest,
+       gettingAnUnchangedPluginShouldReturnAPluginWithTheSameHeaderOnlySetting) {
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankEsm,
+                          true));
+
+  EXPECT_EQ(cache_.GetPlugin(blankEsm),
+            cache_.GetUnchangedPlugin(blankEsm, true));
+}
+
+TEST_P(GameCacheTest,
+       gettingAnUnchangedPluginShouldReturnNullIfTheHeaderOnlySettingDiffers) {
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankEsm,
+                          true));
+
+  EXPECT_FALSE(cache_.GetUnchangedPlugin(blankEsm, false));
+}
+
+TEST_P(GameCacheTest,
+       gettingAnUnchangedPluginShouldReturnNullIfThePluginFileHasChanged) {
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankEsm,
+                          true));
+
+  auto path = game_.DataPath() / blankEsm;
+  std::filesystem::last_write_time(
+      path, std::filesystem::last_write_time(path) + std::chrono::hours(1));
+
+  EXPECT_FALSE(cache_.GetUnchangedPlugin(blankEsm, true));
+}
+
+TEST_P(GameCacheTest,
+       gettingAnUnchangedPluginShouldReturnNullIfThePluginIsNotCached) {
+  EXPECT_FALSE(cache_.GetUnchangedPlugin(blankEsm, true));
+}
+
+TEST_P(GameCacheTest, retainingPluginsShouldDiscardAllOtherCachedPlugins) {
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankEsm,
+                          true));
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankDifferentEsm,
+                          true));
+
+  cache_.RetainPlugins({boost::to_upper_copy(blankEsm)});
+
+  EXPECT_EQ(1, cache_.GetPlugins().size());
+  EXPECT_TRUE(cache_.GetPlugin(blankEsm));
+}
+
+TEST_P(GameCacheTest,
+       gettingDependentPluginsShouldReturnCachedPluginsWithTheGivenMaster) {
+  auto otherCache = std::make_shared<GameCache>(GameCache());
+  cache_.AddPlugin(
+      Plugin(game_.Type(), otherCache, game_.DataPath() / blankEsm, true));
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          otherCache,
+                          game_.DataPath() / blankMasterDependentEsm,
+                          true));
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          otherCache,
+                          game_.DataPath() / blankMasterDependentEsp,
+                          true));
+
+  std::set<std::string> dependents;
+  for (const auto& plugin : cache_.GetDependentPlugins(blankEsm)) {
+    dependents.insert(plugin->GetName());
+  }
+
+  EXPECT_EQ(std::set<std::string>({blankMasterDependentEsm,
+                                   blankMasterDependentEsp}),
+            dependents);
+  EXPECT_TRUE(cache_.GetDependentPlugins(blankMasterDependentEsm).empty());
+  EXPECT_TRUE(cache_.GetDependentPlugins("missing.esm").empty());
+}
+
+TEST_P(GameCacheTest, gettingMasterIdsShouldReturnTheIdsOfAPluginsMasters) {
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankMasterDependentEsm,
+                          true));
+
+  auto pluginId = cache_.GetPluginId(NormalizeFilename(blankMasterDependentEsm));
+  auto masterId = cache_.GetPluginId(NormalizeFilename(blankEsm));
+
+  ASSERT_TRUE(pluginId.has_value());
+  ASSERT_TRUE(masterId.has_value());
+  EXPECT_EQ(std::vector<uint32_t>({masterId.value()}),
+            cache_.GetMasterIds(pluginId.value()));
+  EXPECT_TRUE(cache_.GetMasterIds(masterId.value()).empty());
+}
+
+TEST_P(GameCacheTest,
+       retainingPluginsShouldRemoveDiscardedPluginsFromTheirMastersDependents) {
+  auto otherCache = std::make_shared<GameCache>(GameCache());
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          otherCache,
+                          game_.DataPath() / blankMasterDependentEsm,
+                          true));
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          otherCache,
+                          game_.DataPath() / blankMasterDependentEsp,
+                          true));
+
+  cache_.RetainPlugins({blankMasterDependentEsp});
+
+  auto dependents = cache_.GetDependentPlugins(blankEsm);
+  ASSERT_EQ(1, dependents.size());
+  EXPECT_EQ(blankMasterDependentEsp, dependents[0]->GetName());
+}
+
+TEST_P(GameCacheTest, replacingAPluginShouldNotDuplicateItInTheIndex) {
+  auto otherCache = std::make_shared<GameCache>(GameCache());
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          otherCache,
+                          game_.DataPath() / blankMasterDependentEsm,
+                          true));
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          otherCache,
+                          game_.DataPath() / blankMasterDependentEsm,
+                          true));
+
+  EXPECT_EQ(1, cache_.GetDependentPlugins(blankEsm).size());
+}
+
+TEST_P(GameCacheTest, clearingCachedPluginsShouldClearTheMasterIndex) {
+  cache_.AddPlugin(Plugin(game_.Type(),
+                          std::make_shared<GameCache>(GameCache()),
+                          game_.DataPath() / blankMasterDependentEsm,
+                          true));
+
+  cache_.ClearCachedPlugins();
+
+  EXPECT_TRUE(cache_.GetDependentPlugins(blankEsm).empty());
+  EXPECT_FALSE(cache_.GetPluginId(NormalizeFilename(blankEsm)).has_value());
+}
+
+TEST_P(GameCacheTest, pluginsShouldBeReadableWhileOtherPluginsAreBeingAdded) {
+  const std::vector<std::string> pluginNames({blankEsm,
+                                              blankDifferentEsm,
+                                              blankEsp,
+                                              blankDifferentEsp,
+                                              blankPluginDependentEsp});
+  std::vector<Plugin> plugins;
+  for (const auto& pluginName : pluginNames) {
+    plugins.push_back(Plugin(game_.Type(),
+                             std::make_shared<GameCache>(GameCache()),
+                             game_.DataPath() / pluginName,
+                             true));
+  }
+
+  std::thread writer([&]() {
+    for (size_t i = 0; i < 1000; ++i) {
+      cache_.AddPlugin(Plugin(plugins[i % plugins.size()]));
+    }
+  });
+
+  for (size_t i = 0; i < 1000; ++i) {
+    auto plugin = cache_.GetPlugin(pluginNames[i % pluginNames.size()]);
+    if (plugin) {
+      EXPECT_EQ(pluginNames[i % pluginNames.size()], plugin->GetName());
+    }
+    EXPECT_GE(plugins.size(), cache_.GetPlugins().size());
+  }
+
+  writer.join();
+
+  EXPECT_EQ(plugins.size(), cache_.NumPlugins());
+}
+
+TEST_P(GameCacheTest,
+       archivePathsShouldBeReadableWhileOtherThreadsAreCachingThem) {
+  std::thread writer([&]() {
+    for (size_t i = 0; i < 1000; ++i) {
+      cache_.CacheArchivePath("archive" + std::to_string(i) + ".bsa");
+    }
+  });
+
+  for (size_t i = 0; i < 1000; ++i) {
+    EXPECT_GE(1000, cache_.GetArchivePaths().size());
+    cache_.HasArchiveWithNormalizedPrefix("archive1");
+  }
+
+  writer.join();
+
+  EXPECT_EQ(1000, cache_.GetArchivePaths().size());
+  EXPECT_TRUE(cache_.HasArchiveWithNormalizedPrefix("archive1"));
+}
+
 TEST_P(GameCacheTest,
   gettingArchivePathsShouldReturnAnEmptySetIfNoPathsHaveBeenCached) {
   EXPECT_TRUE(cache_.GetArchivePaths().empty());
@@ -124,6 +342,29 @@ TEST_P(GameCacheTest,
   EXPECT_EQ(expected, cache_.GetArchivePaths());
 }
 
+TEST_P(GameCacheTest,
+       hasArchiveWithNormalizedPrefixShouldCheckNormalizedArchiveFilenames) {
+  cache_.CacheArchivePath(game_.DataPath() / "Blank - Different.bsa");
+
+  EXPECT_TRUE(
+      cache_.HasArchiveWithNormalizedPrefix(NormalizeFilename("BLANK")));
+  EXPECT_TRUE(cache_.HasArchiveWithNormalizedPrefix(
+      NormalizeFilename("blank - different")));
+  EXPECT_FALSE(cache_.HasArchiveWithNormalizedPrefix(
+      NormalizeFilename("Blank - Different2")));
+  EXPECT_FALSE(
+      cache_.HasArchiveWithNormalizedPrefix(NormalizeFilename("Other")));
+}
+
+TEST_P(GameCacheTest,
+       clearingCachedArchivePathsShouldClearNormalizedArchiveFilenames) {
+  cache_.CacheArchivePath(game_.DataPath() / "Blank.bsa");
+  cache_.ClearCachedArchivePaths();
+
+  EXPECT_FALSE(
+      cache_.HasArchiveWithNormalizedPrefix(NormalizeFilename("Blank")));
+}
+
 TEST_P(GameCacheTest, clearingCachedPluginsShouldNotThrowIfNoPluginsAreCached) {
   EXPECT_NO_THROW(cache_.ClearCachedPlugins());
 }
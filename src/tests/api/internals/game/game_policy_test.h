@@ -0,0 +1,89 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_GAME_GAME_POLICY_TEST
+#define LOOT_TESTS_API_INTERNALS_GAME_GAME_POLICY_TEST
+
+#include "api/game/game_policy.h"
+
+#include <gtest/gtest.h>
+
+namespace loot {
+namespace test {
+class GamePolicyTest : public ::testing::TestWithParam<GameType> {};
+
+INSTANTIATE_TEST_CASE_P(,
+                        GamePolicyTest,
+                        ::testing::Values(GameType::tes3,
+                                          GameType::tes4,
+                                          GameType::tes5,
+                                          GameType::fo3,
+                                          GameType::fonv,
+                                          GameType::fo4,
+                                          GameType::tes5se,
+                                          GameType::fo4vr,
+                                          GameType::tes5vr));
+
+TEST_P(GamePolicyTest, getGamePolicyShouldReturnThePolicyForTheGivenGameType) {
+  EXPECT_EQ(GetParam(), GetGamePolicy(GetParam()).gameType);
+}
+
+TEST_P(GamePolicyTest, getGamePolicyShouldReturnTheSameObjectEachTime) {
+  EXPECT_EQ(&GetGamePolicy(GetParam()), &GetGamePolicy(GetParam()));
+}
+
+TEST_P(GamePolicyTest,
+       hasPluginFileExtensionShouldIgnoreCaseAndAGhostExtension) {
+  const auto& policy = GetGamePolicy(GetParam());
+
+  EXPECT_TRUE(policy.HasPluginFileExtension("file.esp"));
+  EXPECT_TRUE(policy.HasPluginFileExtension("file.ESM"));
+  EXPECT_TRUE(policy.HasPluginFileExtension("file.Esp.GHOST"));
+  EXPECT_FALSE(policy.HasPluginFileExtension("file.ghost"));
+  EXPECT_FALSE(policy.HasPluginFileExtension("file.esp.bak"));
+  EXPECT_FALSE(policy.HasPluginFileExtension("esp"));
+  EXPECT_EQ(policy.supportsLightPlugins,
+            policy.HasPluginFileExtension("file.esl.ghost"));
+}
+
+TEST(GamePolicy, getGamePolicyShouldThrowForAnUnrecognisedGameType) {
+  EXPECT_THROW(GetGamePolicy(static_cast<GameType>(100)),
+               std::invalid_argument);
+}
+
+TEST(GamePolicy, dataDirectoryAndArchiveMatchingShouldMatchEachGamesBehaviour) {
+  EXPECT_EQ("Data Files", GetGamePolicy(GameType::tes3).dataDirectoryName);
+  EXPECT_EQ(ArchiveMatching::none,
+            GetGamePolicy(GameType::tes3).archiveMatching);
+
+  EXPECT_EQ("Data", GetGamePolicy(GameType::tes5).dataDirectoryName);
+  EXPECT_EQ(ArchiveMatching::exactBasename,
+            GetGamePolicy(GameType::tes5).archiveMatching);
+  EXPECT_EQ(ArchiveMatching::espBasenamePrefix,
+            GetGamePolicy(GameType::tes4).archiveMatching);
+}
+}
+}
+
+#endif
@@ -27,6 +27,9 @@ along with LOOT.  If not, see
 
 #include "api/game/game.h"
 
+#include <algorithm>
+
+#include "loot/exception/operation_cancelled_error.h"
 #include "tests/common_game_test_fixture.h"
 
 namespace loot {
@@ -85,8 +88,26 @@ TEST_P(GameTest, constructingShouldThrowOnLinuxIfGamePathIsNotGiven) {
   EXPECT_THROW(Game(GetParam(), "", localPath), std::invalid_argument);
 }
 
-TEST_P(GameTest, constructingShouldThrowOnLinuxIfLocalPathIsNotGiven) {
-  EXPECT_THROW(Game(GetParam(), dataPath.parent_path()), std::system_error);
+TEST_P(GameTest, constructingShouldNotThrowOnLinuxIfLocalPathIsNotGiven) {
+  EXPECT_NO_THROW(Game(GetParam(), dataPath.parent_path()));
+}
+
+TEST_P(GameTest,
+       loadingTheLoadOrderStateShouldThrowOnLinuxIfLocalPathIsNotGiven) {
+  Game game(GetParam(), dataPath.parent_path());
+
+  EXPECT_THROW(game.LoadCurrentLoadOrderState(), std::system_error);
+  EXPECT_THROW(game.GetLoadOrder(), std::system_error);
+}
+
+TEST_P(GameTest,
+       validatingPluginsAndGettingMetadataShouldNotInitialiseTheLoadOrder) {
+  // Initialising libloadorder would fail without a local path.
+  Game game(GetParam(), dataPath.parent_path());
+
+  EXPECT_TRUE(game.IsValidPlugin(blankEsm));
+  EXPECT_EQ(1, game.FilterValidPlugins({blankEsm, nonPluginFile}).size());
+  EXPECT_FALSE(game.GetDatabase()->GetPluginMetadata(blankEsm).has_value());
 }
 #else
 TEST_P(GameTest, constructingShouldNotThrowOnWindowsIfLocalPathIsNotGiven) {
@@ -123,6 +144,47 @@ TEST_P(GameTest, loadPluginsWithANonPluginShouldNotAddItToTheLoadedPlugins) {
   ASSERT_TRUE(game.GetLoadedPlugins().empty());
 }
 
+TEST_P(GameTest,
+       loadPluginsHeadersOnlyShouldReuseUnchangedHeadersParsedByFilterValidPlugins) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+  ASSERT_EQ(1, game.FilterValidPlugins({blankEsm}).size());
+
+  overwritePreservingFileState(blankEsm);
+
+  ASSERT_NO_THROW(game.LoadPlugins({blankEsm}, true));
+
+  auto plugin = game.GetPlugin(blankEsm);
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ("5.0", plugin->GetVersion().value());
+}
+
+TEST_P(GameTest,
+       loadPluginsShouldNotReuseHeadersParsedByFilterValidPluginsIfTheFileHasChanged) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+  ASSERT_EQ(1, game.FilterValidPlugins({blankEsm}).size());
+
+  auto path = dataPath / blankEsm;
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << "not a plugin";
+  out.close();
+
+  EXPECT_THROW(game.LoadPlugins({blankEsm}, true), std::invalid_argument);
+  EXPECT_FALSE(game.GetPlugin(blankEsm));
+}
+
+TEST_P(GameTest,
+       loadPluginsWithANonPluginShouldLoadTheOtherPluginsAndThenThrow) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+
+  ASSERT_THROW(game.LoadPlugins({blankEsm, nonPluginFile, blankEsp}, false),
+               std::invalid_argument);
+
+  EXPECT_EQ(2, game.GetLoadedPlugins().size());
+  EXPECT_TRUE(game.GetPlugin(blankEsm));
+  EXPECT_TRUE(game.GetPlugin(blankEsp));
+  EXPECT_FALSE(game.GetPlugin(nonPluginFile));
+}
+
 TEST_P(GameTest,
        loadPluginsWithAnInvalidPluginShouldNotAddItToTheLoadedPlugins) {
   ASSERT_FALSE(std::filesystem::exists(dataPath / invalidPlugin));
@@ -156,6 +218,233 @@ TEST_P(GameTest,
   EXPECT_EQ(blankEsmCrc, plugin->GetCRC().value());
 }
 
+TEST_P(GameTest, loadPluginsShouldReuseUnchangedPluginsThatWereAlreadyLoaded) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game, false));
+  auto plugin = game.GetPlugin(blankEsm);
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game, false));
+
+  EXPECT_EQ(plugin, game.GetPlugin(blankEsm));
+}
+
+TEST_P(GameTest, loadPluginsShouldReloadPluginsThatHaveChangedOnDisk) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game, false));
+  auto plugin = game.GetPlugin(blankEsm);
+
+  auto path = dataPath / blankEsm;
+  std::filesystem::last_write_time(
+      path, std::filesystem::last_write_time(path) + std::chrono::hours(1));
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game, false));
+
+  EXPECT_NE(plugin, game.GetPlugin(blankEsm));
+  EXPECT_EQ(blankEsmCrc, game.GetPlugin(blankEsm)->GetCRC().value());
+}
+
+TEST_P(GameTest,
+       loadPluginsShouldFullyLoadPluginsThatOnlyHadTheirHeadersLoaded) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game, true));
+  EXPECT_FALSE(game.GetPlugin(blankEsm)->GetCRC());
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game, false));
+
+  EXPECT_EQ(blankEsmCrc, game.GetPlugin(blankEsm)->GetCRC().value());
+}
+
+TEST_P(GameTest,
+       loadPluginsShouldReuseTheParsedHeadersOfPluginsLoadedHeaderOnly) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+  ASSERT_NO_THROW(game.LoadPlugins({blankEsm}, true));
+
+  overwritePreservingFileState(blankEsm);
+
+  ASSERT_NO_THROW(game.LoadPlugins({blankEsm}, false));
+
+  auto plugin = game.GetCache()->GetPlugin(blankEsm);
+  ASSERT_TRUE(plugin);
+  EXPECT_FALSE(plugin->IsHeaderOnly());
+  EXPECT_EQ("5.0", plugin->GetVersion().value());
+}
+
+TEST_P(GameTest,
+       loadPluginsHeadersOnlyShouldReuseTheParsedHeadersOfFullyLoadedPlugins) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+  ASSERT_NO_THROW(game.LoadPlugins({blankEsm}, false));
+  auto isEmpty = game.GetCache()->GetPlugin(blankEsm)->IsEmpty();
+
+  overwritePreservingFileState(blankEsm);
+
+  ASSERT_NO_THROW(game.LoadPlugins({blankEsm}, true));
+
+  auto plugin = game.GetCache()->GetPlugin(blankEsm);
+  ASSERT_TRUE(plugin);
+  EXPECT_TRUE(plugin->IsHeaderOnly());
+  EXPECT_EQ("5.0", plugin->GetVersion().value());
+  EXPECT_EQ(isEmpty, plugin->IsEmpty());
+}
+
+TEST_P(GameTest, loadPluginsShouldDiscardPluginsThatAreNotLoadedAgain) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game, false));
+  ASSERT_NO_THROW(game.LoadPlugins({blankEsm}, false));
+
+  EXPECT_EQ(1, game.GetCache()->GetPlugins().size());
+  EXPECT_TRUE(game.GetPlugin(blankEsm));
+}
+
+TEST_P(GameTest, loadPluginsAsyncShouldLoadPluginsAndReportEachOneLoaded) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+
+  std::vector<OperationProgress> progress;
+  auto future = game.LoadPluginsAsync(
+      {blankEsm, blankEsp},
+      false,
+      CancellationToken(),
+      [&](const OperationProgress& p) { progress.push_back(p); });
+  EXPECT_NO_THROW(future.get());
+
+  EXPECT_EQ(2, game.GetCache()->GetPlugins().size());
+  ASSERT_EQ(2, progress.size());
+  EXPECT_EQ("LoadPlugins", progress[0].stage);
+  EXPECT_EQ(1, progress[0].completed);
+  EXPECT_EQ(2, progress[0].total);
+  EXPECT_EQ(2, progress[1].completed);
+  EXPECT_EQ(2, progress[1].total);
+}
+
+TEST_P(GameTest,
+       loadPluginsAsyncShouldThrowAndLoadNothingIfTheTokenIsAlreadyCancelled) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+
+  CancellationToken token;
+  token.Cancel();
+  auto future = game.LoadPluginsAsync({blankEsm, blankEsp}, false, token);
+
+  EXPECT_THROW(future.get(), OperationCancelledError);
+  EXPECT_TRUE(game.GetCache()->GetPlugins().empty());
+}
+
+TEST_P(GameTest,
+       sortNewPluginsShouldLoadThePluginsAndInsertTheNewOnesIntoTheOrder) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.LoadCurrentLoadOrderState();
+
+  auto result =
+      game.SortNewPlugins({blankEsm, blankEsp}, {blankMasterDependentEsm});
+
+  EXPECT_EQ(
+      std::vector<std::string>({blankEsm, blankMasterDependentEsm, blankEsp}),
+      result);
+  EXPECT_EQ(3, game.GetCache()->GetPlugins().size());
+}
+
+TEST_P(GameTest,
+       sortPluginsShouldGiveTheSameResultsWithRecordReleaseAfterSortEnabled) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.LoadCurrentLoadOrderState();
+  const std::vector<std::string> plugins(
+      {masterFile, blankEsm, blankMasterDependentEsm, blankEsp});
+
+  auto expected = game.SortPlugins(plugins);
+  auto expectedOverlaps = game.GetOverlappingPlugins(blankMasterDependentEsm);
+
+  game.SetRecordReleaseAfterSortEnabled(true);
+
+  EXPECT_EQ(expected, game.SortPlugins(plugins));
+  EXPECT_EQ(expected, game.SortPlugins(plugins));
+  EXPECT_EQ(expectedOverlaps,
+            game.GetOverlappingPlugins(blankMasterDependentEsm));
+}
+
+TEST_P(GameTest, getMemoryUsageShouldCountLoadedPluginsAndTheirRecords) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  auto usage = game.GetMemoryUsage();
+
+  EXPECT_EQ(0, usage.pluginRecords);
+
+  game.LoadPlugins({blankEsm, blankMasterDependentEsm}, false);
+  auto loadedUsage = game.GetMemoryUsage();
+
+  EXPECT_LT(usage.plugins, loadedUsage.plugins);
+  EXPECT_LT(0, loadedUsage.pluginRecords);
+  EXPECT_LT(usage.Total(), loadedUsage.Total());
+}
+
+TEST_P(GameTest, trimCachesShouldFreePluginRecordsButKeepTheLoadedPlugins) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.LoadCurrentLoadOrderState();
+  game.SortPlugins({masterFile, blankEsm, blankMasterDependentEsm});
+
+  ASSERT_LT(0, game.GetMemoryUsage().pluginRecords);
+  ASSERT_LT(0, game.GetMemoryUsage().sorter);
+  auto sorterUsage = game.GetMemoryUsage().sorter;
+
+  game.TrimCaches();
+  auto usage = game.GetMemoryUsage();
+
+  EXPECT_EQ(0, usage.pluginRecords);
+  EXPECT_GT(sorterUsage, usage.sorter);
+  EXPECT_EQ(3, game.GetCache()->NumPlugins());
+}
+
+TEST_P(GameTest, sortPluginsShouldGiveTheSameResultAfterCachesAreTrimmed) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.LoadCurrentLoadOrderState();
+  const std::vector<std::string> plugins(
+      {masterFile, blankEsm, blankMasterDependentEsm, blankEsp});
+
+  auto expected = game.SortPlugins(plugins);
+  game.TrimCaches();
+
+  EXPECT_EQ(expected, game.SortPlugins(plugins));
+}
+
+TEST_P(GameTest, sortPluginsAsyncShouldGiveTheSameResultAsSortPlugins) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+  game.LoadCurrentLoadOrderState();
+  const std::vector<std::string> plugins({masterFile, blankEsm, blankEsp});
+
+  auto expected = game.SortPlugins(plugins);
+
+  std::vector<std::string> stages;
+  auto future = game.SortPluginsAsync(
+      plugins, CancellationToken(), [&](const OperationProgress& progress) {
+        stages.push_back(progress.stage);
+      });
+
+  EXPECT_EQ(expected, future.get());
+  ASSERT_FALSE(stages.empty());
+  EXPECT_EQ("LoadPlugins", stages.front());
+  EXPECT_EQ("TopologicalSort", stages.back());
+}
+
+TEST_P(GameTest, sortPluginsAsyncShouldThrowIfCancelledBetweenSortingPhases) {
+  Game game = Game(GetParam(), dataPath.parent_path(), localPath);
+  game.LoadCurrentLoadOrderState();
+
+  CancellationToken token;
+  std::vector<std::string> stages;
+  auto future = game.SortPluginsAsync(
+      {masterFile, blankEsm, blankEsp},
+      token,
+      [&](const OperationProgress& progress) {
+        stages.push_back(progress.stage);
+        if (progress.stage == "AddGroupEdges") {
+          token.Cancel();
+        }
+      });
+
+  EXPECT_THROW(future.get(), OperationCancelledError);
+  EXPECT_EQ("AddGroupEdges", stages.back());
+}
+
 TEST_P(GameTest,
   loadPluginsShouldFindAndCacheArchivesForLoadDetectionWhenLoadingPlugins) {
   Game game = Game(GetParam(), dataPath.parent_path(), localPath);
@@ -237,6 +526,47 @@ TEST_P(GameTest, shouldShowBlankEspAsInactiveIfItHasBeenFullyLoaded) {
 
   EXPECT_FALSE(game.IsPluginActive(blankEsp));
 }
+#ifdef __linux__
+TEST_P(GameTest,
+       loadPluginsShouldFindAPluginAddedSinceTheLastLoadIfWatchingFiles) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.SetFileWatchingEnabled(true);
+  game.LoadPlugins({blankEsm}, true);
+
+  std::filesystem::copy_file(dataPath / blankEsp, dataPath / missingEsp);
+
+  EXPECT_NO_THROW(game.LoadPlugins({blankEsm, missingEsp}, true));
+  EXPECT_EQ(2, game.GetCache()->NumPlugins());
+}
+
+TEST_P(GameTest,
+       getLoadOrderShouldReloadStateIfAPluginIsDeletedWhileWatchingFiles) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.SetFileWatchingEnabled(true);
+  game.LoadCurrentLoadOrderState();
+  auto loadOrder = game.GetLoadOrder();
+  ASSERT_NE(loadOrder.end(),
+            std::find(loadOrder.begin(), loadOrder.end(), blankDifferentEsp));
+
+  std::filesystem::remove(dataPath / blankDifferentEsp);
+  loadOrder = game.GetLoadOrder();
+
+  EXPECT_EQ(loadOrder.end(),
+            std::find(loadOrder.begin(), loadOrder.end(), blankDifferentEsp));
+}
+
+TEST_P(GameTest,
+       getLoadOrderShouldNotReloadTheLoadOrderStateIfNotWatchingFiles) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.LoadCurrentLoadOrderState();
+
+  std::filesystem::remove(dataPath / blankDifferentEsp);
+  auto loadOrder = game.GetLoadOrder();
+
+  EXPECT_NE(loadOrder.end(),
+            std::find(loadOrder.begin(), loadOrder.end(), blankDifferentEsp));
+}
+#endif
 }
 }
 
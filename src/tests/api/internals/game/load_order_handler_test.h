@@ -239,6 +239,77 @@ TEST_P(LoadOrderHandlerTest, setLoadOrderShouldSetTheLoadOrder) {
 
   EXPECT_EQ(loadOrderToSet_, getLoadOrder());
 }
+
+TEST_P(LoadOrderHandlerTest,
+       setLoadOrderShouldNotSetTheLoadOrderIfItIsUnchanged) {
+  initialiseHandler();
+  loadOrderHandler_.LoadCurrentState();
+
+  auto state = loadOrderHandler_.GetState();
+  auto movedPlugins = loadOrderHandler_.SetLoadOrder(state->GetLoadOrder());
+
+  EXPECT_TRUE(movedPlugins.empty());
+  EXPECT_EQ(state, loadOrderHandler_.GetState());
+}
+
+TEST_P(LoadOrderHandlerTest,
+       setLoadOrderShouldSetTheLoadOrderIfItWasChangedOnDiskSinceItWasLoaded) {
+  initialiseHandler();
+  loadOrderHandler_.LoadCurrentState();
+  auto initialLoadOrder = loadOrderHandler_.GetState()->GetLoadOrder();
+
+  LoadOrderHandler otherHandler;
+  otherHandler.Init(GetParam(), dataPath.parent_path(), localPath);
+  otherHandler.LoadCurrentState();
+  otherHandler.SetLoadOrder(loadOrderToSet_);
+  ASSERT_NE(initialLoadOrder, getLoadOrder());
+
+  loadOrderHandler_.SetLoadOrder(initialLoadOrder);
+
+  EXPECT_EQ(initialLoadOrder, getLoadOrder());
+}
+
+TEST_P(LoadOrderHandlerTest, setLoadOrderShouldReturnThePluginsThatWereMoved) {
+  initialiseHandler();
+  loadOrderHandler_.LoadCurrentState();
+
+  auto expectedPlugins =
+      loadOrderHandler_.GetState()->GetMovedPlugins(loadOrderToSet_);
+  auto movedPlugins = loadOrderHandler_.SetLoadOrder(loadOrderToSet_);
+
+  EXPECT_FALSE(movedPlugins.empty());
+  EXPECT_EQ(expectedPlugins, movedPlugins);
+}
+
+TEST_P(LoadOrderHandlerTest,
+       getStateShouldReturnTheSameSnapshotUntilTheStateIsChanged) {
+  initialiseHandler();
+  loadOrderHandler_.LoadCurrentState();
+
+  auto state = loadOrderHandler_.GetState();
+
+  EXPECT_EQ(state, loadOrderHandler_.GetState());
+  EXPECT_EQ(getLoadOrder(), state->GetLoadOrder());
+  EXPECT_TRUE(state->IsPluginActive(masterFile));
+  EXPECT_FALSE(state->IsPluginActive(blankEsp));
+
+  loadOrderHandler_.LoadCurrentState();
+
+  EXPECT_NE(state, loadOrderHandler_.GetState());
+}
+
+TEST_P(LoadOrderHandlerTest, getStateShouldReflectALoadOrderThatHasBeenSet) {
+  initialiseHandler();
+  loadOrderHandler_.LoadCurrentState();
+  loadOrderHandler_.GetState();
+
+  loadOrderHandler_.SetLoadOrder(loadOrderToSet_);
+
+  if (GetParam() == GameType::fo4 || GetParam() == GameType::tes5se)
+    loadOrderToSet_.erase(begin(loadOrderToSet_));
+
+  EXPECT_EQ(loadOrderToSet_, loadOrderHandler_.GetState()->GetLoadOrder());
+}
 }
 }
 
@@ -0,0 +1,105 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_GAME_LOAD_ORDER_STATE_TEST
+#define LOOT_TESTS_API_INTERNALS_GAME_LOAD_ORDER_STATE_TEST
+
+#include "api/game/load_order_state.h"
+
+#include <gtest/gtest.h>
+
+namespace loot {
+namespace test {
+TEST(LoadOrderState, defaultConstructorShouldGiveAnEmptyState) {
+  LoadOrderState state;
+
+  EXPECT_TRUE(state.GetLoadOrder().empty());
+  EXPECT_TRUE(state.GetActivePlugins().empty());
+  EXPECT_TRUE(state.GetImplicitlyActivePlugins().empty());
+  EXPECT_FALSE(state.IsPluginActive("Blank.esm"));
+}
+
+TEST(LoadOrderState, isPluginActiveShouldCompareNamesCaseInsensitively) {
+  LoadOrderState state({"Blank.esm", "Blank.esp"}, {"Blank.esm"}, {});
+
+  EXPECT_TRUE(state.IsPluginActive("Blank.esm"));
+  EXPECT_TRUE(state.IsPluginActive("blank.ESM"));
+  EXPECT_FALSE(state.IsPluginActive("Blank.esp"));
+}
+
+TEST(LoadOrderState,
+     isPluginActiveShouldReturnFalseForAPluginNotInTheLoadOrder) {
+  LoadOrderState state({"Blank.esm"}, {"Blank.esm"}, {});
+
+  EXPECT_FALSE(state.IsPluginActive("Blank.esp"));
+}
+
+TEST(LoadOrderState,
+     getLoadOrderIndexShouldReturnTheIndexOfAPluginInTheLoadOrder) {
+  LoadOrderState state({"Blank.esm", "Blank.esp"}, {}, {});
+
+  EXPECT_EQ(0, state.GetLoadOrderIndex("Blank.esm"));
+  EXPECT_EQ(1, state.GetLoadOrderIndex("blank.esp"));
+  EXPECT_FALSE(state.GetLoadOrderIndex("Blank - Different.esp").has_value());
+}
+
+TEST(LoadOrderState,
+     getMovedPluginsShouldReturnAnEmptyVectorIfTheLoadOrderIsUnchanged) {
+  LoadOrderState state({"Blank.esm", "Blank.esp", "Blank - Different.esp"},
+                       {},
+                       {});
+
+  EXPECT_TRUE(
+      state.GetMovedPlugins({"blank.esm", "Blank.esp", "Blank - Different.esp"})
+          .empty());
+}
+
+TEST(LoadOrderState,
+     getMovedPluginsShouldReturnOnlyThePluginsThatNeedToMove) {
+  LoadOrderState state({"A.esm", "B.esp", "C.esp", "D.esp", "E.esp"}, {}, {});
+
+  EXPECT_EQ(std::vector<std::string>({"E.esp"}),
+            state.GetMovedPlugins(
+                {"A.esm", "E.esp", "B.esp", "C.esp", "D.esp"}));
+  EXPECT_EQ(std::vector<std::string>({"B.esp"}),
+            state.GetMovedPlugins(
+                {"A.esm", "C.esp", "D.esp", "E.esp", "B.esp"}));
+  EXPECT_EQ(std::vector<std::string>({"D.esp", "A.esm"}),
+            state.GetMovedPlugins(
+                {"D.esp", "B.esp", "C.esp", "E.esp", "A.esm"}));
+}
+
+TEST(LoadOrderState,
+     getMovedPluginsShouldIncludePluginsThatAreNotInTheLoadOrder) {
+  LoadOrderState state({"Blank.esm", "Blank.esp"}, {}, {});
+
+  EXPECT_EQ(std::vector<std::string>({"Blank - Different.esp"}),
+            state.GetMovedPlugins(
+                {"Blank.esm", "Blank - Different.esp", "Blank.esp"}));
+}
+}
+}
+
+#endif
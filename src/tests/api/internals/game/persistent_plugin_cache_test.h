@@ -0,0 +1,377 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_GAME_PERSISTENT_PLUGIN_CACHE_TEST
+#define LOOT_TESTS_API_INTERNALS_GAME_PERSISTENT_PLUGIN_CACHE_TEST
+
+#include "api/game/persistent_plugin_cache.h"
+
+#include <fstream>
+
+#include "api/game/game.h"
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+class PersistentPluginCacheTest : public CommonGameTestFixture {
+protected:
+  PersistentPluginCacheTest() :
+      cacheFilePath(localPath / "plugin cache.bin"),
+      pluginPath(dataPath / blankEsm),
+      modificationTime(std::filesystem::file_time_type::clock::now()) {}
+
+  PersistentPluginCache cache_;
+
+  const std::filesystem::path cacheFilePath;
+  const std::filesystem::path pluginPath;
+  const std::filesystem::file_time_type modificationTime;
+};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(,
+                        PersistentPluginCacheTest,
+                        ::testing::Values(GameType::tes5));
+
+TEST_P(PersistentPluginCacheTest, getCrcShouldReturnNulloptIfNothingIsCached) {
+  EXPECT_FALSE(cache_.GetCrc(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       getCrcShouldReturnTheCachedCrcIfSizeAndModificationTimeMatch) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_EQ(0xDEADBEEF, cache_.GetCrc(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       getCrcShouldReturnNulloptIfSizeOrModificationTimeDiffer) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_FALSE(cache_.GetCrc(pluginPath, 11, modificationTime));
+  EXPECT_FALSE(cache_.GetCrc(
+      pluginPath, 10, modificationTime + std::chrono::seconds(1)));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       getCrcShouldReturnTheCachedCrcForALinkToTheSameFileInAnotherDirectory) {
+  const auto linkPath = localPath / "profile" / pluginPath.filename();
+  std::filesystem::create_directories(linkPath.parent_path());
+  std::filesystem::create_hard_link(pluginPath, linkPath);
+
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_EQ(0xDEADBEEF, cache_.GetCrc(linkPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       getCrcShouldReturnNulloptForACopyOfTheFileInAnotherDirectory) {
+  const auto copyPath = localPath / "profile" / pluginPath.filename();
+  std::filesystem::create_directories(copyPath.parent_path());
+  std::filesystem::copy_file(pluginPath, copyPath);
+
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_FALSE(cache_.GetCrc(copyPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest, setCrcShouldDoNothingIfTheFileDoesNotExist) {
+  cache_.SetCrc(dataPath / missingEsp, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_FALSE(cache_.IsModified());
+  EXPECT_FALSE(cache_.GetCrc(dataPath / missingEsp, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       getCrcShouldReturnNulloptForADifferentFileNameInTheSameDirectory) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_FALSE(cache_.GetCrc(dataPath / blankEsp, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       setCrcShouldNotReplaceTheCrcOfADifferentVersionOfTheSameFile) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+  cache_.SetCrc(pluginPath, 20, modificationTime, 0x12345678);
+
+  EXPECT_EQ(0xDEADBEEF, cache_.GetCrc(pluginPath, 10, modificationTime));
+  EXPECT_EQ(0x12345678, cache_.GetCrc(pluginPath, 20, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest, setCrcShouldMarkTheCacheAsModified) {
+  EXPECT_FALSE(cache_.IsModified());
+
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_TRUE(cache_.IsModified());
+}
+
+TEST_P(PersistentPluginCacheTest,
+       savingAndLoadingShouldRoundTripCachedCrcs) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+  cache_.SetCrc(dataPath / blankEsp, 20, modificationTime, 0x12345678);
+  cache_.Save(cacheFilePath);
+
+  EXPECT_FALSE(cache_.IsModified());
+
+  PersistentPluginCache loadedCache;
+  loadedCache.Load(cacheFilePath);
+
+  EXPECT_FALSE(loadedCache.IsModified());
+  EXPECT_EQ(0xDEADBEEF, loadedCache.GetCrc(pluginPath, 10, modificationTime));
+  EXPECT_EQ(0x12345678,
+            loadedCache.GetCrc(dataPath / blankEsp, 20, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       getIsValidAsLightMasterShouldReturnNulloptIfOnlyTheCrcIsCached) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_FALSE(cache_.GetIsValidAsLightMaster(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       setIsValidAsLightMasterShouldNotChangeTheCachedCrc) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+  cache_.SetIsValidAsLightMaster(pluginPath, 10, modificationTime, true);
+
+  EXPECT_EQ(0xDEADBEEF, cache_.GetCrc(pluginPath, 10, modificationTime));
+  EXPECT_EQ(true,
+            cache_.GetIsValidAsLightMaster(pluginPath, 10, modificationTime));
+  EXPECT_FALSE(cache_.GetCrc(dataPath / blankEsp, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       savingAndLoadingShouldRoundTripCachedLightMasterValidity) {
+  cache_.SetIsValidAsLightMaster(pluginPath, 10, modificationTime, true);
+  cache_.SetIsValidAsLightMaster(dataPath / blankEsp, 20, modificationTime, false);
+  cache_.Save(cacheFilePath);
+
+  PersistentPluginCache loadedCache;
+  loadedCache.Load(cacheFilePath);
+
+  EXPECT_EQ(true,
+            loadedCache.GetIsValidAsLightMaster(
+                pluginPath, 10, modificationTime));
+  EXPECT_EQ(false,
+            loadedCache.GetIsValidAsLightMaster(
+                dataPath / blankEsp, 20, modificationTime));
+  EXPECT_FALSE(loadedCache.GetCrc(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       savingShouldDropEntriesThatHaveNotBeenUsedForManySaves) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+  cache_.SetCrc(dataPath / blankEsp, 20, modificationTime, 0x12345678);
+  cache_.Save(cacheFilePath);
+
+  for (int i = 0; i < 100; ++i) {
+    PersistentPluginCache loadedCache;
+    loadedCache.Load(cacheFilePath);
+    ASSERT_EQ(0x12345678,
+              loadedCache.GetCrc(dataPath / blankEsp, 20, modificationTime));
+    loadedCache.Save(cacheFilePath);
+  }
+
+  PersistentPluginCache loadedCache;
+  loadedCache.Load(cacheFilePath);
+
+  EXPECT_FALSE(loadedCache.GetCrc(pluginPath, 10, modificationTime));
+  EXPECT_EQ(0x12345678,
+            loadedCache.GetCrc(dataPath / blankEsp, 20, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       loadingShouldLeaveTheCacheEmptyIfTheFileDoesNotExist) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  cache_.Load(cacheFilePath);
+
+  EXPECT_FALSE(cache_.GetCrc(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       loadingShouldLeaveTheCacheEmptyIfTheFileIsNotAValidCache) {
+  std::ofstream out(cacheFilePath);
+  out << "this is not a cache file";
+  out.close();
+
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+
+  EXPECT_NO_THROW(cache_.Load(cacheFilePath));
+  EXPECT_FALSE(cache_.GetCrc(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       loadingShouldLeaveTheCacheEmptyIfTheFileIsTruncated) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+  cache_.Save(cacheFilePath);
+  std::filesystem::resize_file(cacheFilePath,
+                               std::filesystem::file_size(cacheFilePath) - 1);
+
+  cache_.Load(cacheFilePath);
+
+  EXPECT_FALSE(cache_.GetCrc(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       loadingShouldLeaveTheCacheEmptyIfTheFileIsCorrupt) {
+  cache_.SetCrc(pluginPath, 10, modificationTime, 0xDEADBEEF);
+  cache_.Save(cacheFilePath);
+
+  std::fstream file(cacheFilePath,
+                    std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(-1, std::ios::end);
+  file.put('\xFF');
+  file.close();
+
+  cache_.Load(cacheFilePath);
+
+  EXPECT_FALSE(cache_.GetCrc(pluginPath, 10, modificationTime));
+}
+
+TEST_P(PersistentPluginCacheTest, pluginsShouldUseACachedCrcIfOneIsAvailable) {
+  auto gameCache = std::make_shared<GameCache>();
+  gameCache->GetPersistentCache().SetCrc(
+      pluginPath,
+      std::filesystem::file_size(pluginPath),
+      std::filesystem::last_write_time(pluginPath),
+      0xDEADBEEF);
+
+  Plugin plugin(GetParam(), gameCache, pluginPath, false);
+
+  EXPECT_EQ(0xDEADBEEF, plugin.GetCRC().value());
+}
+
+TEST_P(PersistentPluginCacheTest,
+       pluginsShouldNotCacheTheirCrcBeforeItIsCalculated) {
+  auto gameCache = std::make_shared<GameCache>();
+
+  Plugin plugin(GetParam(), gameCache, pluginPath, false);
+
+  EXPECT_FALSE(gameCache->GetPersistentCache().GetCrc(
+      pluginPath,
+      std::filesystem::file_size(pluginPath),
+      std::filesystem::last_write_time(pluginPath)));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       pluginsShouldCacheTheirCrcWhenItIsCalculated) {
+  auto gameCache = std::make_shared<GameCache>();
+
+  Plugin plugin(GetParam(), gameCache, pluginPath, false);
+  ASSERT_EQ(blankEsmCrc, plugin.GetCRC().value());
+
+  EXPECT_EQ(blankEsmCrc,
+            gameCache->GetPersistentCache().GetCrc(
+                pluginPath,
+                std::filesystem::file_size(pluginPath),
+                std::filesystem::last_write_time(pluginPath)));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       pluginsShouldCacheTheirLightMasterValidityWhenTheirRecordsAreParsed) {
+  auto gameCache = std::make_shared<GameCache>();
+
+  Plugin plugin(GetParam(), gameCache, pluginPath, false);
+  auto isValid = plugin.IsValidAsLightMaster();
+
+  EXPECT_EQ(isValid,
+            gameCache->GetPersistentCache().GetIsValidAsLightMaster(
+                pluginPath,
+                std::filesystem::file_size(pluginPath),
+                std::filesystem::last_write_time(pluginPath)));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       pluginsShouldUseACachedLightMasterValidityWithoutParsingTheirRecords) {
+  auto isValid =
+      Plugin(GetParam(), std::make_shared<GameCache>(), pluginPath, false)
+          .IsValidAsLightMaster();
+
+  // Cache the opposite result to show that the records weren't checked.
+  auto gameCache = std::make_shared<GameCache>();
+  gameCache->GetPersistentCache().SetIsValidAsLightMaster(
+      pluginPath,
+      std::filesystem::file_size(pluginPath),
+      std::filesystem::last_write_time(pluginPath),
+      !isValid);
+
+  Plugin plugin(GetParam(), gameCache, pluginPath, false);
+
+  EXPECT_EQ(!isValid, plugin.IsValidAsLightMaster());
+  EXPECT_EQ(0, plugin.GetRecordsMemoryUsage());
+}
+
+TEST_P(PersistentPluginCacheTest,
+       gameShouldSaveTheCacheFileAfterLoadingPluginsIfACachePathIsSet) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+  game.SetPluginCachePath(cacheFilePath);
+
+  game.LoadPlugins({blankEsm}, false);
+  game.GetPlugin(blankEsm)->GetCRC();
+  // Reloading the unchanged plugin saves the CRC calculated since the last
+  // load.
+  game.LoadPlugins({blankEsm}, false);
+
+  ASSERT_TRUE(std::filesystem::exists(cacheFilePath));
+
+  PersistentPluginCache loadedCache;
+  loadedCache.Load(cacheFilePath);
+  EXPECT_EQ(blankEsmCrc,
+            loadedCache.GetCrc(pluginPath,
+                               std::filesystem::file_size(pluginPath),
+                               std::filesystem::last_write_time(pluginPath)));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       gameShouldSaveTheCacheFileWhenDestroyedIfACachePathIsSet) {
+  {
+    Game game(GetParam(), dataPath.parent_path(), localPath);
+    game.SetPluginCachePath(cacheFilePath);
+
+    game.LoadPlugins({blankEsm}, false);
+    game.GetPlugin(blankEsm)->GetCRC();
+  }
+
+  PersistentPluginCache loadedCache;
+  loadedCache.Load(cacheFilePath);
+  EXPECT_EQ(blankEsmCrc,
+            loadedCache.GetCrc(pluginPath,
+                               std::filesystem::file_size(pluginPath),
+                               std::filesystem::last_write_time(pluginPath)));
+}
+
+TEST_P(PersistentPluginCacheTest,
+       gameShouldNotWriteACacheFileIfNoCachePathIsSet) {
+  Game game(GetParam(), dataPath.parent_path(), localPath);
+
+  game.LoadPlugins({blankEsm}, false);
+
+  EXPECT_FALSE(std::filesystem::exists(cacheFilePath));
+}
+}
+}
+
+#endif
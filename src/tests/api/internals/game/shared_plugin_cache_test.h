@@ -0,0 +1,117 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_GAME_SHARED_PLUGIN_CACHE_TEST
+#define LOOT_TESTS_API_INTERNALS_GAME_SHARED_PLUGIN_CACHE_TEST
+
+#include "api/game/shared_plugin_cache.h"
+
+#include "api/game/game.h"
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+class SharedPluginCacheTest : public CommonGameTestFixture {
+protected:
+  void SetUp() override {
+    CommonGameTestFixture::SetUp();
+    SharedPluginCache::Get().SetEnabled(true);
+  }
+
+  void TearDown() override {
+    SharedPluginCache::Get().SetEnabled(false);
+    CommonGameTestFixture::TearDown();
+  }
+};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(,
+                        SharedPluginCacheTest,
+                        ::testing::Values(GameType::tes5));
+
+TEST_P(SharedPluginCacheTest,
+       loadingAPluginInASecondGameShouldShareTheFirstGamesParse) {
+  Game game1(GetParam(), dataPath.parent_path(), localPath);
+  Game game2(GetParam(), dataPath.parent_path(), localPath);
+  ASSERT_NO_THROW(game1.LoadPlugins({blankEsm}, true));
+
+  overwritePreservingFileState(blankEsm);
+
+  ASSERT_NO_THROW(game2.LoadPlugins({blankEsm}, true));
+
+  auto plugin = game2.GetPlugin(blankEsm);
+  ASSERT_TRUE(plugin);
+  EXPECT_EQ("5.0", plugin->GetVersion().value());
+  EXPECT_NE(game1.GetPlugin(blankEsm), plugin);
+}
+
+TEST_P(SharedPluginCacheTest,
+       pluginsShouldNotBeSharedWithADifferentHeaderOnlySetting) {
+  Game game1(GetParam(), dataPath.parent_path(), localPath);
+  Game game2(GetParam(), dataPath.parent_path(), localPath);
+  ASSERT_NO_THROW(game1.LoadPlugins({blankEsp}, true));
+
+  overwritePreservingFileState(blankEsp);
+
+  EXPECT_THROW(game2.LoadPlugins({blankEsp}, false), std::invalid_argument);
+}
+
+TEST_P(SharedPluginCacheTest,
+       pluginsShouldNotBeSharedOnceNoGameHoldsThem) {
+  {
+    Game game1(GetParam(), dataPath.parent_path(), localPath);
+    ASSERT_NO_THROW(game1.LoadPlugins({blankEsm}, true));
+  }
+
+  overwritePreservingFileState(blankEsm);
+
+  Game game2(GetParam(), dataPath.parent_path(), localPath);
+  EXPECT_THROW(game2.LoadPlugins({blankEsm}, true), std::invalid_argument);
+}
+
+TEST_P(SharedPluginCacheTest, findShouldReturnNullIfSharingIsDisabled) {
+  Game game1(GetParam(), dataPath.parent_path(), localPath);
+  ASSERT_NO_THROW(game1.LoadPlugins({blankEsm}, true));
+  auto plugin = game1.GetCache()->GetPlugin(blankEsm);
+
+  EXPECT_TRUE(SharedPluginCache::Get().Find(GetParam(),
+                                            plugin->GetFilePath(),
+                                            plugin->GetLoadedFileSize(),
+                                            plugin->GetLoadedModificationTime(),
+                                            true));
+
+  SharedPluginCache::Get().SetEnabled(false);
+
+  EXPECT_FALSE(SharedPluginCache::Get().Find(GetParam(),
+                                             plugin->GetFilePath(),
+                                             plugin->GetLoadedFileSize(),
+                                             plugin->GetLoadedModificationTime(),
+                                             true));
+}
+}
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*  LOOT
+
+A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+Fallout: New Vegas.
+
+Copyright (C) 2014-2016    WrinklyNinja
+
+This file is part of LOOT.
+
+LOOT is free software: you can redistribute
+it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of
+the License, or (at your option) any later version.
+
+LOOT is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LOOT.  If not, see
+<https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_HELPERS_CACHE_FILE_TEST
+#define LOOT_TESTS_API_INTERNALS_HELPERS_CACHE_FILE_TEST
+
+#include "api/helpers/cache_file.h"
+
+#include <fstream>
+
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+class CacheFileTest : public CommonGameTestFixture {
+protected:
+  CacheFileTest() : cacheDirectory(localPath / "caches") {
+    std::filesystem::create_directories(cacheDirectory);
+  }
+
+  // Writes a cache file of the given size with a last use time that is the
+  // given number of hours in the past.
+  void WriteTestCacheFile(const std::filesystem::path& path,
+                          size_t size,
+                          int hoursAgo) {
+    WriteCacheFile(path, [&](std::ostream& out) {
+      out.write(CACHE_FILE_MAGIC_PREFIX, sizeof(CACHE_FILE_MAGIC_PREFIX));
+      out << std::string(size - sizeof(CACHE_FILE_MAGIC_PREFIX), '\0');
+    });
+    std::filesystem::last_write_time(
+        path,
+        std::filesystem::file_time_type::clock::now() -
+            std::chrono::hours(hoursAgo));
+  }
+
+  const std::filesystem::path cacheDirectory;
+};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(, CacheFileTest, ::testing::Values(GameType::tes5));
+
+TEST_P(CacheFileTest,
+       writeCacheFileShouldCreateTheParentDirectoryAndLeaveNoTemporaryFile) {
+  auto path = cacheDirectory / "game" / "cache.bin";
+
+  WriteCacheFile(path, [](std::ostream& out) { out << "LOOTdata"; });
+
+  std::ifstream in(path);
+  std::string content;
+  in >> content;
+  EXPECT_EQ("LOOTdata", content);
+  EXPECT_EQ(1,
+            std::distance(std::filesystem::directory_iterator(path.parent_path()),
+                          std::filesystem::directory_iterator()));
+}
+
+TEST_P(CacheFileTest,
+       writeCacheFileShouldLeaveAnExistingFileUnchangedIfWritingThrows) {
+  auto path = cacheDirectory / "cache.bin";
+  WriteTestCacheFile(path, 10, 0);
+
+  EXPECT_THROW(WriteCacheFile(path,
+                                    [](std::ostream& out) {
+                                      out << "partial";
+                                      throw std::runtime_error("failed");
+                                    }),
+               std::runtime_error);
+
+  EXPECT_EQ(10, std::filesystem::file_size(path));
+  EXPECT_EQ(1,
+            std::distance(std::filesystem::directory_iterator(cacheDirectory),
+                          std::filesystem::directory_iterator()));
+}
+
+TEST_P(CacheFileTest, isCacheFileShouldCheckForTheMagicPrefix) {
+  WriteTestCacheFile(cacheDirectory / "cache.bin", 10, 0);
+  std::ofstream out(cacheDirectory / "other.bin");
+  out << "not a cache";
+  out.close();
+
+  EXPECT_TRUE(IsCacheFile(cacheDirectory / "cache.bin"));
+  EXPECT_FALSE(IsCacheFile(cacheDirectory / "other.bin"));
+  EXPECT_FALSE(IsCacheFile(cacheDirectory / "missing.bin"));
+}
+
+TEST_P(CacheFileTest,
+       trimCacheFilesShouldRemoveTheLeastRecentlyUsedFilesAcrossSubdirectories) {
+  WriteTestCacheFile(cacheDirectory / "tes5" / "oldest.bin", 100, 3);
+  WriteTestCacheFile(cacheDirectory / "fo4" / "older.bin", 100, 2);
+  WriteTestCacheFile(cacheDirectory / "tes5" / "newest.bin", 100, 1);
+
+  EXPECT_EQ(200, TrimCacheFiles(cacheDirectory, 150));
+
+  EXPECT_FALSE(std::filesystem::exists(cacheDirectory / "tes5" / "oldest.bin"));
+  EXPECT_FALSE(std::filesystem::exists(cacheDirectory / "fo4" / "older.bin"));
+  EXPECT_TRUE(std::filesystem::exists(cacheDirectory / "tes5" / "newest.bin"));
+}
+
+TEST_P(CacheFileTest, trimCacheFilesShouldNotRemoveAnythingIfUnderTheLimit) {
+  WriteTestCacheFile(cacheDirectory / "a.bin", 100, 2);
+  WriteTestCacheFile(cacheDirectory / "b.bin", 100, 1);
+
+  EXPECT_EQ(0, TrimCacheFiles(cacheDirectory, 200));
+
+  EXPECT_TRUE(std::filesystem::exists(cacheDirectory / "a.bin"));
+  EXPECT_TRUE(std::filesystem::exists(cacheDirectory / "b.bin"));
+}
+
+TEST_P(CacheFileTest, trimCacheFilesShouldIgnoreFilesThatAreNotCacheFiles) {
+  std::ofstream out(cacheDirectory / "other.bin");
+  out << std::string(1000, 'x');
+  out.close();
+  WriteTestCacheFile(cacheDirectory / "cache.bin", 100, 1);
+
+  EXPECT_EQ(0, TrimCacheFiles(cacheDirectory, 100));
+
+  EXPECT_TRUE(std::filesystem::exists(cacheDirectory / "other.bin"));
+  EXPECT_TRUE(std::filesystem::exists(cacheDirectory / "cache.bin"));
+}
+
+TEST_P(CacheFileTest, markCacheFileUsedShouldProtectAFileFromBeingTrimmed) {
+  WriteTestCacheFile(cacheDirectory / "a.bin", 100, 2);
+  WriteTestCacheFile(cacheDirectory / "b.bin", 100, 1);
+
+  MarkCacheFileUsed(cacheDirectory / "a.bin");
+
+  EXPECT_EQ(100, TrimCacheFiles(cacheDirectory, 100));
+  EXPECT_TRUE(std::filesystem::exists(cacheDirectory / "a.bin"));
+  EXPECT_FALSE(std::filesystem::exists(cacheDirectory / "b.bin"));
+}
+
+TEST_P(CacheFileTest, trimCacheFilesShouldDoNothingIfTheDirectoryIsMissing) {
+  EXPECT_EQ(0, TrimCacheFiles(cacheDirectory / "missing", 0));
+}
+}
+}
+
+#endif
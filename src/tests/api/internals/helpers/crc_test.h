@@ -27,6 +27,8 @@ along with LOOT.  If not, see
 
 #include "api/helpers/crc.h"
 
+#include <boost/crc.hpp>
+
 #include "loot/exception/file_access_error.h"
 #include "tests/common_game_test_fixture.h"
 
@@ -47,6 +49,63 @@ TEST_P(GetCrc32Test, gettingTheCrcOfAMissingFileShouldThrow) {
 TEST_P(GetCrc32Test, gettingTheCrcOfAFileShouldReturnTheCorrectValue) {
   EXPECT_EQ(blankEsmCrc, GetCrc32(dataPath / blankEsm));
 }
+
+TEST_P(GetCrc32Test, gettingTheCrcOfAnEmptyFileShouldReturnZero) {
+  std::ofstream out(dataPath / "empty.esp");
+  out.close();
+
+  EXPECT_EQ(0, GetCrc32(dataPath / "empty.esp"));
+}
+
+TEST(UpdateCrc32, shouldReturnTheStandardCheckValueForTheStandardInput) {
+  std::string input = "123456789";
+
+  EXPECT_EQ(0xCBF43926, UpdateCrc32(0, input.data(), input.size()));
+}
+
+TEST(UpdateCrc32, shouldMatchBoostForAllLengthsAndAlignments) {
+  std::string input;
+  for (size_t i = 0; i < 1024; ++i) {
+    input.push_back((char)((i * 131 + 7) % 256));
+  }
+
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t length = 0; offset + length <= input.size(); ++length) {
+      boost::crc_32_type expected;
+      expected.process_bytes(input.data() + offset, length);
+
+      ASSERT_EQ(expected.checksum(),
+                UpdateCrc32(0, input.data() + offset, length))
+          << "offset " << offset << ", length " << length;
+    }
+  }
+}
+
+TEST(UpdateCrc32, shouldGiveTheSameResultWhenCalculatedInPieces) {
+  std::string input(1000, 'a');
+  auto expected = UpdateCrc32(0, input.data(), input.size());
+
+  auto crc = UpdateCrc32(0, input.data(), 333);
+  crc = UpdateCrc32(crc, input.data() + 333, input.size() - 333);
+
+  EXPECT_EQ(expected, crc);
+}
+
+TEST(CombineCrc32, shouldGiveTheCrcOfTheConcatenatedInputs) {
+  std::string input;
+  for (size_t i = 0; i < 1000; ++i) {
+    input.push_back((char)((i * 131 + 7) % 256));
+  }
+  auto expected = UpdateCrc32(0, input.data(), input.size());
+
+  for (size_t split : {0, 1, 7, 64, 333, 999, 1000}) {
+    auto crc1 = UpdateCrc32(0, input.data(), split);
+    auto crc2 = UpdateCrc32(0, input.data() + split, input.size() - split);
+
+    EXPECT_EQ(expected, CombineCrc32(crc1, crc2, input.size() - split))
+        << "split " << split;
+  }
+}
 }
 }
 
@@ -108,13 +108,47 @@ private:
 };
 
 TEST_F(GitHelperTest, destructorShouldCallLibgit2CleanupFunction) {
-  ASSERT_EQ(2, git_libgit2_init());
+  // The repository pool may also hold a reference to libgit2, depending on
+  // whether earlier tests have opened a repository.
+  auto initCount = git_libgit2_init();
 
   GitHelper* gitPointer = new GitHelper();
-  ASSERT_EQ(4, git_libgit2_init());
+  ASSERT_EQ(initCount + 2, git_libgit2_init());
 
   delete gitPointer;
-  EXPECT_EQ(2, git_libgit2_shutdown());
+  EXPECT_EQ(initCount, git_libgit2_shutdown());
+  git_libgit2_shutdown();
+}
+
+TEST_F(GitHelperTest, openShouldSeeCommitsMadeAfterAnEarlierHelperWasDestroyed) {
+  std::string headId;
+  {
+    GitHelper git;
+    git.Open(repoRoot);
+    headId = git.GetHeadCommitId(false);
+  }
+
+  auto currentPath = std::filesystem::current_path();
+  std::filesystem::current_path(repoRoot);
+  system(
+      "git -c user.name=test -c user.email=test@example.com commit "
+      "--allow-empty -m test");
+  std::filesystem::current_path(currentPath);
+
+  GitHelper git;
+  git.Open(repoRoot);
+
+  EXPECT_NE(headId, git.GetHeadCommitId(false));
+}
+
+TEST_F(GitHelperTest, openShouldBeAbleToOpenARepositoryThatIsAlreadyOpen) {
+  GitHelper git;
+  git.Open(repoRoot);
+
+  GitHelper other;
+  other.Open(repoRoot);
+
+  EXPECT_EQ(git.GetHeadCommitId(false), other.GetHeadCommitId(false));
 }
 
 TEST_F(GitHelperTest, isRepositoryShouldReturnTrueForARepositoryRoot) {
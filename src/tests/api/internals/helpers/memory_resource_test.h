@@ -0,0 +1,162 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_HELPERS_MEMORY_RESOURCE_TEST
+#define LOOT_TESTS_API_INTERNALS_HELPERS_MEMORY_RESOURCE_TEST
+
+#include "api/helpers/memory_resource.h"
+
+#include <gtest/gtest.h>
+
+#include "api/game/game.h"
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+// Counts the allocations that it passes on to the new/delete resource.
+class CountingMemoryResource : public MemoryResource {
+public:
+  void* Allocate(size_t bytes, size_t alignment) override {
+    allocations_ += 1;
+    allocatedBytes_ += bytes;
+    outstandingBytes_ += bytes;
+    return pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void Deallocate(void* pointer, size_t bytes, size_t alignment) override {
+    outstandingBytes_ -= bytes;
+    pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+
+  size_t GetAllocations() const { return allocations_; }
+  size_t GetAllocatedBytes() const { return allocatedBytes_; }
+  size_t GetOutstandingBytes() const { return outstandingBytes_; }
+
+private:
+  std::atomic<size_t> allocations_{0};
+  std::atomic<size_t> allocatedBytes_{0};
+  std::atomic<size_t> outstandingBytes_{0};
+};
+
+TEST(GetMemoryResourceAdapter, shouldReturnNullIfGivenNull) {
+  EXPECT_EQ(nullptr, GetMemoryResourceAdapter(nullptr));
+}
+
+TEST(GetMemoryResourceAdapter, shouldReturnTheSameAdapterForTheSameResource) {
+  CountingMemoryResource resource;
+
+  EXPECT_EQ(GetMemoryResourceAdapter(&resource),
+            GetMemoryResourceAdapter(&resource));
+}
+
+TEST(GetMemoryResourceAdapter, shouldForwardAllocationsToTheGivenResource) {
+  CountingMemoryResource resource;
+  auto adapter = GetMemoryResourceAdapter(&resource);
+
+  auto pointer = adapter->allocate(64, 16);
+  EXPECT_EQ(1, resource.GetAllocations());
+  EXPECT_EQ(64, resource.GetOutstandingBytes());
+
+  adapter->deallocate(pointer, 64, 16);
+  EXPECT_EQ(0, resource.GetOutstandingBytes());
+}
+
+TEST(GetGlobalMemoryResource, shouldReturnTheDefaultResourceIfNoneIsSet) {
+  EXPECT_EQ(pmr::get_default_resource(), GetGlobalMemoryResource());
+}
+
+TEST(GetGlobalMemoryResource, shouldReturnTheResourceThatWasSet) {
+  CountingMemoryResource resource;
+  auto adapter = GetMemoryResourceAdapter(&resource);
+  SetGlobalMemoryResource(adapter);
+  auto globalResource = GetGlobalMemoryResource();
+  SetGlobalMemoryResource(nullptr);
+
+  EXPECT_EQ(adapter, globalResource);
+  EXPECT_EQ(pmr::get_default_resource(), GetGlobalMemoryResource());
+}
+
+TEST(ResolveMemoryResource, shouldReturnTheGivenResourceIfItIsNotNull) {
+  CountingMemoryResource resource;
+  auto adapter = GetMemoryResourceAdapter(&resource);
+
+  EXPECT_EQ(adapter, ResolveMemoryResource(adapter));
+}
+
+TEST(ResolveMemoryResource, shouldReturnTheGlobalResourceIfGivenNull) {
+  EXPECT_EQ(GetGlobalMemoryResource(), ResolveMemoryResource(nullptr));
+}
+
+class MemoryResourceTest : public CommonGameTestFixture {};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(,
+                        MemoryResourceTest,
+                        ::testing::Values(GameType::tes5));
+
+TEST_P(MemoryResourceTest,
+       gameCacheShouldAllocateAddedPluginsFromItsMemoryResource) {
+  CountingMemoryResource resource;
+  {
+    GameCache cache;
+    cache.SetMemoryResource(GetMemoryResourceAdapter(&resource));
+    cache.AddPlugin(Plugin(GetParam(),
+                           std::make_shared<GameCache>(),
+                           dataPath / blankEsm,
+                           true));
+
+    EXPECT_EQ(1, resource.GetAllocations());
+    EXPECT_LT(sizeof(Plugin), resource.GetOutstandingBytes());
+  }
+
+  EXPECT_EQ(0, resource.GetOutstandingBytes());
+}
+
+TEST_P(MemoryResourceTest,
+       sortPluginsShouldAllocateFromTheGamesMemoryResourceAndGiveTheSameResult) {
+  const std::vector<std::string> plugins(
+      {masterFile, blankEsm, blankMasterDependentEsm, blankEsp});
+
+  Game defaultGame(GetParam(), dataPath.parent_path(), localPath);
+  defaultGame.LoadCurrentLoadOrderState();
+  auto expected = defaultGame.SortPlugins(plugins);
+
+  CountingMemoryResource resource;
+  {
+    Game game(GetParam(), dataPath.parent_path(), localPath);
+    game.SetMemoryResource(&resource);
+    game.LoadCurrentLoadOrderState();
+
+    EXPECT_EQ(expected, game.SortPlugins(plugins));
+    // Each plugin and each of the sorter's vertices allocates.
+    EXPECT_LT(2 * plugins.size(), resource.GetAllocations());
+  }
+
+  EXPECT_EQ(0, resource.GetOutstandingBytes());
+}
+}
+}
+
+#endif
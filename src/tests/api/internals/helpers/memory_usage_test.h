@@ -0,0 +1,83 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_HELPERS_MEMORY_USAGE_TEST
+#define LOOT_TESTS_API_INTERNALS_HELPERS_MEMORY_USAGE_TEST
+
+#include "api/helpers/memory_usage.h"
+
+#include <gtest/gtest.h>
+
+namespace loot {
+namespace test {
+TEST(EstimateHeapSize, shouldBeZeroForAnEmptyString) {
+  EXPECT_EQ(0, EstimateHeapSize(std::string()));
+}
+
+TEST(EstimateHeapSize, shouldCountTheCharactersOfALongString) {
+  std::string string(100, 'a');
+
+  EXPECT_EQ(101, EstimateHeapSize(string));
+}
+
+TEST(EstimateHeapSize, shouldBeZeroForAnEmptyOptional) {
+  EXPECT_EQ(0, EstimateHeapSize(std::optional<std::string>()));
+}
+
+TEST(EstimateHeapSize, shouldCountAVectorsCapacityAndItsElements) {
+  std::vector<std::string> vector({std::string(100, 'a'), "b"});
+  vector.reserve(4);
+
+  EXPECT_EQ(4 * sizeof(std::string) + 101, EstimateHeapSize(vector));
+}
+
+TEST(EstimateHeapSize, shouldCountANodeForEachSetElement) {
+  std::set<std::string> set({std::string(100, 'a'), "b"});
+
+  EXPECT_EQ(2 * (sizeof(std::string) + TREE_NODE_OVERHEAD) + 101,
+            EstimateHeapSize(set));
+}
+
+TEST(EstimateHeapSize, shouldUseTheGivenFunctionToCountMapValues) {
+  std::map<std::string, int> map({{"a", 1}, {"b", 2}});
+
+  auto bytes = EstimateHeapSize(map, [](int value) { return value; });
+
+  EXPECT_EQ(2 * (sizeof(std::string) + sizeof(int) + TREE_NODE_OVERHEAD) + 3,
+            bytes);
+}
+
+TEST(EstimateHeapSize, shouldIncreaseAsPluginMetadataIsAdded) {
+  PluginMetadata metadata("Blank.esm");
+  auto bytes = EstimateHeapSize(metadata);
+
+  metadata.SetMessages(
+      {Message(MessageType::say, std::string(100, 'a'), "file(\"Blank.esp\")")});
+
+  EXPECT_LT(bytes, EstimateHeapSize(metadata));
+}
+}
+}
+
+#endif
@@ -28,10 +28,49 @@ along with LOOT.  If not, see
 #include "api/helpers/text.h"
 #include "loot/loot_version.h"
 
+#include <random>
+#include <regex>
+
+#include <boost/algorithm/string.hpp>
 #include <gtest/gtest.h>
 
 namespace loot {
 namespace test {
+// The regex-based implementation that ExtractVersion() replaced, used to check
+// that its results haven't changed.
+std::optional<std::string> ExtractVersionUsingRegexes(
+    const std::string& text) {
+  using std::regex;
+
+  static const std::string pseudosemVersionRegex =
+      R"((\d+(?:\.\d+)+(?:[-._:]?[A-Za-z0-9]+)*))"
+      R"((?!,))";
+  static const std::vector<regex> versionRegexes({
+      regex(R"((\d{1,2}/\d{1,2}/\d{1,4} \d{1,2}:\d{1,2}:\d{1,2}))",
+            regex::ECMAScript | regex::icase),
+      regex(R"(version:?\s)" + pseudosemVersionRegex,
+            regex::ECMAScript | regex::icase),
+      regex(R"((?:^|v|\s))" + pseudosemVersionRegex,
+            regex::ECMAScript | regex::icase),
+      regex(R"((?:^|v)(\d+))", regex::ECMAScript | regex::icase),
+  });
+
+  std::smatch what;
+  for (const auto& versionRegex : versionRegexes) {
+    if (std::regex_search(text, what, versionRegex)) {
+      for (auto it = next(begin(what)); it != end(what); ++it) {
+        if (it->str().empty())
+          continue;
+
+        std::string version = *it;
+        boost::trim(version);
+        return version;
+      }
+    }
+  }
+
+  return std::nullopt;
+}
 
 TEST(ExtractBashTags, shouldExtractTagsFromPluginDescriptionText) {
   auto description = R"raw(Unofficial Skyrim Special Edition Patch
@@ -68,6 +107,29 @@ Requires Skyrim Special Edition 1.5.39 or greater.
   EXPECT_EQ(expectedTags, tags);
 }
 
+TEST(ExtractBashTags, shouldTrimWhitespaceAroundEachTag) {
+  auto tags = ExtractBashTags("{{BASH: Delev ,\tRelev\n, ,Names}}");
+
+  std::set<Tag> expectedTags({
+      Tag(""),
+      Tag("Delev"),
+      Tag("Names"),
+      Tag("Relev"),
+  });
+
+  EXPECT_EQ(expectedTags, tags);
+}
+
+TEST(ExtractBashTags, shouldOnlyExtractTagsUpToTheClosingBraces) {
+  auto tags = ExtractBashTags("{{BASH:Delev,Relev}} Names, Stats");
+
+  EXPECT_EQ(std::set<Tag>({Tag("Delev"), Tag("Relev")}), tags);
+}
+
+TEST(ExtractBashTags, shouldReturnNoTagsIfTheTagListIsNotClosed) {
+  EXPECT_TRUE(ExtractBashTags("{{BASH:Delev,Relev").empty());
+}
+
 TEST(ExtractVersion, shouldExtractAVersionContainingASingleDigit) {
   EXPECT_EQ("5", ExtractVersion("5").value());
 }
@@ -177,6 +239,27 @@ TEST(ExtractVersion, shouldPreferVersionPrefixedNumbersOverVPrefixedNumber) {
   EXPECT_EQ("1.0", text.value());
 }
 
+TEST(ExtractVersion, shouldGiveTheSameResultsAsTheRegexBasedImplementation) {
+  // Build strings out of fragments that are significant to the version
+  // formats, so that the different matching paths are well exercised.
+  const std::vector<std::string> fragments = {
+      "0", "1", "12", "123", "2016", ".", ",", "-", "_", ":", "/", " ",
+      "\t", "\n", "v", "V", "a", "Z", "version", "Version:", "VERSION", "+",
+      "\xC3"};
+  std::mt19937 generator(0);
+
+  for (int i = 0; i < 10000; ++i) {
+    std::string text;
+    auto length = generator() % 20;
+    for (size_t j = 0; j < length; ++j) {
+      text += fragments[generator() % fragments.size()];
+    }
+
+    ASSERT_EQ(ExtractVersionUsingRegexes(text), ExtractVersion(text))
+        << "Text: \"" << text << "\"";
+  }
+}
+
 // MSVC interprets source files in the default code page, so
 // for me u8"\xC3\x9C" != u8"\u00DC", which is a lot of fun.
 // To avoid insanity, write non-ASCII characters as \uXXXX escapes.
@@ -245,6 +328,46 @@ TEST(CompareFilenames, shouldBeCaseInsensitiveAndLocaleInvariant) {
   std::locale::global(boost::locale::generator().generate(""));
 }
 
+TEST(CompareFilenames, shouldOrderAsciiPunctuationAsThePlatformCaseMappingDoes) {
+  // Windows uppercases, so underscore sorts after letters, while case folding
+  // lowercases, so it sorts before them.
+#ifdef _WIN32
+  EXPECT_EQ(1, CompareFilenames("_.esp", "a.esp"));
+  EXPECT_EQ(1, CompareFilenames("_.esp", "A.esp"));
+#else
+  EXPECT_EQ(-1, CompareFilenames("_.esp", "a.esp"));
+  EXPECT_EQ(-1, CompareFilenames("_.esp", "A.esp"));
+#endif
+}
+
+TEST(CompareFilenames, shouldCompareLongAsciiFilenamesCaseInsensitively) {
+  EXPECT_EQ(0,
+            CompareFilenames("Blank - Different Master Dependent.esp",
+                             "BLANK - different master dependent.ESP"));
+  EXPECT_EQ(-1,
+            CompareFilenames("Blank - Different Master Dependent.esm",
+                             "BLANK - different master dependent.ESP"));
+  EXPECT_EQ(-1, CompareFilenames("Blank - Different", "blank - different "));
+  EXPECT_EQ(1, CompareFilenames(u8"Blank - Different Ä", "blank - different z"));
+}
+
+TEST(EndsWithIgnoringAsciiCase, shouldCompareTheEndOfTheTextCaseInsensitively) {
+  EXPECT_TRUE(EndsWithIgnoringAsciiCase("Blank.ESP", ".esp"));
+  EXPECT_TRUE(EndsWithIgnoringAsciiCase("Blank.esp", ".ESP"));
+  EXPECT_TRUE(EndsWithIgnoringAsciiCase(".esp", ".esp"));
+  EXPECT_FALSE(EndsWithIgnoringAsciiCase("Blank.esm", ".esp"));
+  EXPECT_FALSE(EndsWithIgnoringAsciiCase("esp", ".esp"));
+  EXPECT_TRUE(EndsWithIgnoringAsciiCase("Blank.esp", ""));
+}
+
+TEST(EndsWithIgnoringAsciiCase, shouldNotDependOnTheGlobalLocale) {
+  std::locale::global(boost::locale::generator().generate("tr_TR.UTF-8"));
+
+  EXPECT_TRUE(EndsWithIgnoringAsciiCase("Update.INI", ".ini"));
+
+  std::locale::global(boost::locale::generator().generate(""));
+}
+
 #ifdef _WIN32
 TEST(NormalizeFilename, shouldUppercaseStringsAndBeLocaleInvariant) {
   EXPECT_EQ("I", NormalizeFilename("i"));
@@ -321,6 +444,43 @@ TEST(NormalizeFilename, shouldCaseFoldStringsAndBeLocaleInvariant) {
   std::locale::global(boost::locale::generator().generate(""));
 }
 #endif
+
+TEST(CompareNormalizedFilenames, shouldGiveTheSameResultsAsCompareFilenames) {
+  const std::vector<std::string> filenames({
+      "",
+      "a",
+      "A",
+      "ab",
+      "b",
+      "Blank.esm",
+      "blank.esp",
+      "_.esp",
+      "Blank - Different Master Dependent.esp",
+      "BLANK - DIFFERENT MASTER DEPENDENT.ESP",
+      u8"Blank - Different Master Dependent\u00c4.esp",
+      "i",
+      "I",
+      u8"\u0130",
+      u8"\u0131",
+      u8"\u03a1",
+      u8"\u03c1",
+      u8"\u03f1",
+      u8"\ue000",
+      u8"\uffe0",
+      u8"\U0001f600",
+      u8"a\ue000",
+      u8"a\U0001f600",
+  });
+
+  for (const auto& lhs : filenames) {
+    for (const auto& rhs : filenames) {
+      EXPECT_EQ(CompareFilenames(lhs, rhs),
+                CompareNormalizedFilenames(NormalizeFilename(lhs),
+                                           NormalizeFilename(rhs)))
+          << "lhs: " << lhs << ", rhs: " << rhs;
+    }
+  }
+}
 }
 }
 
@@ -0,0 +1,362 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_HELPERS_THREAD_POOL_TEST
+#define LOOT_TESTS_API_INTERNALS_HELPERS_THREAD_POOL_TEST
+
+#include "api/helpers/thread_pool.h"
+
+#include <atomic>
+#include <mutex>
+
+#include <gtest/gtest.h>
+
+namespace loot {
+namespace test {
+// Runs each task on a new thread, or if deferring tasks, stores them until
+// RunDeferredTasks() is called. Tests must call JoinThreads() before their
+// pools and executor are destroyed, as the submitted tasks keep their pool
+// alive.
+class TestExecutor : public Executor {
+public:
+  TestExecutor(size_t concurrency, bool deferTasks = false) :
+      concurrency_(concurrency), deferTasks_(deferTasks), numSubmitted_(0) {}
+
+  ~TestExecutor() { JoinThreads(); }
+
+  size_t GetConcurrency() const override { return concurrency_; }
+
+  void Submit(std::function<void()> task) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++numSubmitted_;
+    if (deferTasks_) {
+      deferredTasks_.push_back(std::move(task));
+    } else {
+      threads_.emplace_back(std::move(task));
+    }
+  }
+
+  size_t NumSubmitted() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return numSubmitted_;
+  }
+
+  void JoinThreads() {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      threads.swap(threads_);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  void RunDeferredTasks() {
+    std::vector<std::function<void()>> tasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks.swap(deferredTasks_);
+    }
+    for (const auto& task : tasks) {
+      task();
+    }
+  }
+
+private:
+  const size_t concurrency_;
+  const bool deferTasks_;
+  size_t numSubmitted_;
+  std::vector<std::thread> threads_;
+  std::vector<std::function<void()>> deferredTasks_;
+  std::mutex mutex_;
+};
+
+TEST(ThreadPool, constructingWithZeroThreadsShouldCreateOneThread) {
+  ThreadPool pool(0);
+
+  EXPECT_EQ(1, pool.Size());
+}
+
+TEST(ThreadPool, runShouldReturnOneTimingPerThreadIfThereAreNoTasks) {
+  ThreadPool pool(3);
+
+  auto timings = pool.Run({});
+
+  ASSERT_EQ(3, timings.size());
+  for (const auto& timing : timings) {
+    EXPECT_EQ(0, timing.tasksRun);
+  }
+}
+
+TEST(ThreadPool, runShouldRunAllTasksBeforeReturning) {
+  ThreadPool pool(4);
+  std::atomic<size_t> counter(0);
+  std::vector<std::function<void()>> tasks(100, [&]() { ++counter; });
+
+  auto timings = pool.Run(tasks);
+
+  EXPECT_EQ(100, counter);
+
+  size_t tasksRun = 0;
+  for (const auto& timing : timings) {
+    tasksRun += timing.tasksRun;
+  }
+  EXPECT_EQ(100, tasksRun);
+}
+
+TEST(ThreadPool, runShouldRethrowAnExceptionThrownByATaskAfterAllTasksHaveRun) {
+  ThreadPool pool(2);
+  std::atomic<size_t> counter(0);
+  std::vector<std::function<void()>> tasks(10, [&]() { ++counter; });
+  tasks[5] = []() { throw std::runtime_error("error"); };
+
+  EXPECT_THROW(pool.Run(tasks), std::runtime_error);
+  EXPECT_EQ(9, counter);
+}
+
+TEST(ThreadPool, runShouldBeCallableConcurrentlyFromMultipleThreads) {
+  ThreadPool pool(2);
+  std::atomic<size_t> counter(0);
+  std::vector<std::function<void()>> tasks(50, [&]() { ++counter; });
+
+  std::thread other([&]() { pool.Run(tasks); });
+  pool.Run(tasks);
+  other.join();
+
+  EXPECT_EQ(100, counter);
+}
+
+TEST(ThreadPool, runShouldRunTasksInlineIfCalledFromATaskOnTheSamePool) {
+  ThreadPool pool(1);
+  std::atomic<size_t> counter(0);
+  std::vector<std::function<void()>> innerTasks(10, [&]() { ++counter; });
+  std::vector<std::function<void()>> tasks(
+      2, [&]() { pool.Run(innerTasks); });
+
+  pool.Run(tasks);
+
+  EXPECT_EQ(20, counter);
+}
+
+TEST(ThreadPool, runShouldLetIdleWorkersHelpIfCalledFromATaskOnTheSamePool) {
+  ThreadPool pool(2);
+  std::atomic<size_t> started(0);
+  std::atomic<bool> ranConcurrently(false);
+  // Each inner task waits for the other to start, which can only happen if
+  // they run on different workers.
+  std::vector<std::function<void()>> innerTasks(2, [&]() {
+    ++started;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (started < 2 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    if (started == 2) {
+      ranConcurrently = true;
+    }
+  });
+  std::vector<std::function<void()>> tasks(1, [&]() { pool.Run(innerTasks); });
+
+  pool.Run(tasks);
+
+  EXPECT_TRUE(ranConcurrently);
+}
+
+TEST(ThreadPool, runInChunksShouldCoverEachItemOnceInOrderedRanges) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<size_t>> calls(1000);
+
+  pool.RunInChunks(calls.size(), 64, [&](size_t start, size_t end) {
+    EXPECT_LT(start, end);
+    for (size_t i = start; i < end; ++i) {
+      ++calls[i];
+    }
+  });
+
+  for (const auto& count : calls) {
+    EXPECT_EQ(1, count);
+  }
+}
+
+TEST(ThreadPool, runInChunksShouldCallOnceIfThereAreTooFewItems) {
+  ThreadPool pool(4);
+  std::vector<std::pair<size_t, size_t>> ranges;
+
+  pool.RunInChunks(63, 64, [&](size_t start, size_t end) {
+    ranges.emplace_back(start, end);
+  });
+
+  ASSERT_EQ(1, ranges.size());
+  EXPECT_EQ(0, ranges[0].first);
+  EXPECT_EQ(63, ranges[0].second);
+}
+
+TEST(ThreadPool, runInChunksShouldNotCallIfThereAreNoItems) {
+  ThreadPool pool(4);
+  size_t calls = 0;
+
+  pool.RunInChunks(0, 0, [&](size_t, size_t) { ++calls; });
+
+  EXPECT_EQ(0, calls);
+}
+
+TEST(ThreadPool, getSharedShouldReturnTheSamePoolEachTime) {
+  EXPECT_EQ(&ThreadPool::GetShared(), &ThreadPool::GetShared());
+}
+
+TEST(ThreadPool, sizeOfAPoolUsingAnExecutorShouldBeTheExecutorsConcurrency) {
+  auto executor = std::make_shared<TestExecutor>(3);
+  auto pool = std::make_shared<ThreadPool>(executor);
+
+  EXPECT_EQ(3, pool->Size());
+}
+
+TEST(ThreadPool, sizeOfAPoolUsingAnExecutorWithZeroConcurrencyShouldBeOne) {
+  auto executor = std::make_shared<TestExecutor>(0);
+  auto pool = std::make_shared<ThreadPool>(executor);
+
+  EXPECT_EQ(1, pool->Size());
+}
+
+TEST(ThreadPool,
+     runOnAPoolUsingAnExecutorShouldReturnOneTimingPerWorkerIfThereAreNoTasks) {
+  auto executor = std::make_shared<TestExecutor>(3);
+  auto pool = std::make_shared<ThreadPool>(executor);
+
+  auto timings = pool->Run({});
+
+  EXPECT_EQ(3, timings.size());
+  EXPECT_EQ(0, executor->NumSubmitted());
+}
+
+TEST(ThreadPool,
+     runOnAPoolUsingAnExecutorShouldRunAllTasksAndSubmitOneLessThanItsSize) {
+  auto executor = std::make_shared<TestExecutor>(4);
+  auto pool = std::make_shared<ThreadPool>(executor);
+  std::atomic<size_t> counter(0);
+  std::vector<std::function<void()>> tasks(100, [&]() { ++counter; });
+
+  auto timings = pool->Run(tasks);
+  executor->JoinThreads();
+
+  EXPECT_EQ(100, counter);
+  EXPECT_EQ(3, executor->NumSubmitted());
+  ASSERT_EQ(4, timings.size());
+
+  size_t tasksRun = 0;
+  for (const auto& timing : timings) {
+    tasksRun += timing.tasksRun;
+  }
+  EXPECT_EQ(100, tasksRun);
+}
+
+TEST(ThreadPool,
+     runOnAPoolUsingAnExecutorShouldFinishIfTheExecutorDoesNotRunItsTasks) {
+  auto executor = std::make_shared<TestExecutor>(4, true);
+  auto pool = std::make_shared<ThreadPool>(executor);
+  std::atomic<size_t> counter(0);
+  std::vector<std::function<void()>> tasks(10, [&]() { ++counter; });
+
+  pool->Run(tasks);
+
+  EXPECT_EQ(10, counter);
+
+  // The submitted tasks find that there's nothing left to do.
+  executor->RunDeferredTasks();
+  EXPECT_EQ(10, counter);
+}
+
+TEST(ThreadPool,
+     executorTasksThatStartAfterRunReturnsShouldNotNeedTheTasksToExist) {
+  auto executor = std::make_shared<TestExecutor>(4, true);
+  auto pool = std::make_shared<ThreadPool>(executor);
+  std::atomic<size_t> counter(0);
+  {
+    std::vector<std::function<void()>> tasks(10, [&]() { ++counter; });
+    pool->Run(tasks);
+  }
+
+  executor->RunDeferredTasks();
+  EXPECT_EQ(10, counter);
+}
+
+TEST(ThreadPool, tasksRunThroughAnExecutorShouldHaveTheirPoolAsTheCurrentPool) {
+  auto executor = std::make_shared<TestExecutor>(2);
+  auto pool = std::make_shared<ThreadPool>(executor);
+  std::atomic<size_t> tasksOnPool(0);
+  std::vector<std::function<void()>> tasks(20, [&]() {
+    if (ThreadPool::GetCurrent() == pool) {
+      ++tasksOnPool;
+    }
+  });
+
+  pool->Run(tasks);
+  executor->JoinThreads();
+
+  EXPECT_EQ(20, tasksOnPool);
+}
+
+TEST(ThreadPool, getCurrentShouldReturnTheSharedPoolByDefault) {
+  EXPECT_EQ(&ThreadPool::GetShared(), ThreadPool::GetCurrent().get());
+}
+
+TEST(ThreadPool, getCurrentShouldReturnThePoolOfTheInnermostScope) {
+  auto outerPool =
+      std::make_shared<ThreadPool>(std::make_shared<TestExecutor>(1));
+  auto innerPool =
+      std::make_shared<ThreadPool>(std::make_shared<TestExecutor>(1));
+
+  {
+    ThreadPoolScope outerScope(outerPool);
+    EXPECT_EQ(outerPool, ThreadPool::GetCurrent());
+
+    {
+      ThreadPoolScope innerScope(innerPool);
+      EXPECT_EQ(innerPool, ThreadPool::GetCurrent());
+
+      ThreadPoolScope nullScope(nullptr);
+      EXPECT_EQ(innerPool, ThreadPool::GetCurrent());
+    }
+
+    EXPECT_EQ(outerPool, ThreadPool::GetCurrent());
+  }
+
+  EXPECT_EQ(&ThreadPool::GetShared(), ThreadPool::GetCurrent().get());
+}
+
+TEST(ThreadPool, getCurrentShouldUseTheGlobalExecutorOutsideOfAnyScope) {
+  auto executor = std::make_shared<TestExecutor>(5);
+  ThreadPool::SetGlobalExecutor(executor);
+
+  auto pool = ThreadPool::GetCurrent();
+  EXPECT_NE(&ThreadPool::GetShared(), pool.get());
+  EXPECT_EQ(5, pool->Size());
+
+  ThreadPool::SetGlobalExecutor(nullptr);
+  EXPECT_EQ(&ThreadPool::GetShared(), ThreadPool::GetCurrent().get());
+}
+}
+}
+
+#endif
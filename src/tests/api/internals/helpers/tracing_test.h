@@ -0,0 +1,148 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+#ifndef LOOT_TESTS_API_INTERNALS_HELPERS_TRACING_TEST
+#define LOOT_TESTS_API_INTERNALS_HELPERS_TRACING_TEST
+
+#include "api/helpers/tracing.h"
+
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "loot/exception/file_access_error.h"
+
+namespace loot {
+namespace test {
+class TracingTest : public ::testing::Test {
+protected:
+  void TearDown() override { setTraceCallback(TraceCallback()); }
+
+  void RecordSpans() {
+    setTraceCallback([&](const TraceSpan& span) {
+      std::lock_guard<std::mutex> lock(spansMutex_);
+      spans_.push_back(span);
+    });
+  }
+
+  std::mutex spansMutex_;
+  std::vector<TraceSpan> spans_;
+};
+
+TEST_F(TracingTest, tracingShouldBeDisabledByDefault) {
+  EXPECT_FALSE(isTracingEnabled());
+}
+
+TEST_F(TracingTest, traceScopeShouldRecordASpanWhenItEnds) {
+  RecordSpans();
+
+  {
+    TraceScope scope("name", "category", "detail");
+    EXPECT_TRUE(spans_.empty());
+  }
+
+  ASSERT_EQ(1, spans_.size());
+  EXPECT_EQ("name", spans_[0].name);
+  EXPECT_EQ("category", spans_[0].category);
+  EXPECT_EQ("detail", spans_[0].detail);
+  EXPECT_LE(0, spans_[0].start.count());
+  EXPECT_LE(0, spans_[0].duration.count());
+  EXPECT_NE(0, spans_[0].threadId);
+}
+
+TEST_F(TracingTest, nestedSpansShouldEndInsideTheirParents) {
+  RecordSpans();
+
+  {
+    TraceScope outer("outer", "category");
+    { TraceScope inner("inner", "category"); }
+  }
+
+  ASSERT_EQ(2, spans_.size());
+  EXPECT_EQ("inner", spans_[0].name);
+  EXPECT_EQ("outer", spans_[1].name);
+  EXPECT_LE(spans_[1].start, spans_[0].start);
+  EXPECT_GE(spans_[1].start + spans_[1].duration,
+            spans_[0].start + spans_[0].duration);
+}
+
+TEST_F(TracingTest, spansOnDifferentThreadsShouldHaveDifferentThreadIds) {
+  RecordSpans();
+
+  { TraceScope scope("main", "category"); }
+  std::thread([]() { TraceScope scope("other", "category"); }).join();
+
+  ASSERT_EQ(2, spans_.size());
+  EXPECT_NE(spans_[0].threadId, spans_[1].threadId);
+}
+
+TEST_F(TracingTest, traceScopeShouldNotRecordASpanIfTracingIsDisabled) {
+  RecordSpans();
+  setTraceCallback(TraceCallback());
+
+  { TraceScope scope("name", "category"); }
+
+  EXPECT_FALSE(isTracingEnabled());
+  EXPECT_TRUE(spans_.empty());
+}
+
+TEST_F(TracingTest, traceScopeShouldIgnoreExceptionsThrownByTheCallback) {
+  setTraceCallback(
+      [](const TraceSpan&) { throw std::runtime_error("error"); });
+
+  EXPECT_NO_THROW({ TraceScope scope("name", "category"); });
+}
+
+TEST_F(TracingTest, setTraceFileShouldWriteSpansAsChromeTraceEvents) {
+  auto traceFile = std::filesystem::absolute("tracing_test.json");
+
+  setTraceFile(traceFile);
+  { TraceScope scope("name", "category", "\"quoted\""); }
+  setTraceCallback(TraceCallback());
+
+  std::ifstream in(traceFile);
+  std::string content((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+  in.close();
+  std::filesystem::remove(traceFile);
+
+  EXPECT_EQ(0, content.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_NE(std::string::npos,
+            content.find("{\"name\":\"name\",\"cat\":\"category\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos,
+            content.find("\"args\":{\"detail\":\"\\\"quoted\\\"\"}"));
+  EXPECT_EQ(content.size() - 3, content.rfind("]}\n"));
+}
+
+TEST_F(TracingTest, setTraceFileShouldThrowIfTheFileCannotBeOpened) {
+  EXPECT_THROW(setTraceFile(std::filesystem::path("missing") / "trace.json"),
+               FileAccessError);
+  EXPECT_FALSE(isTracingEnabled());
+}
+}
+}
+
+#endif
@@ -24,12 +24,24 @@
 
 #include <boost/locale.hpp>
 
+#include "tests/api/internals/allocation_test.h"
+#include "tests/api/internals/game/data_directory_snapshot_test.h"
+#include "tests/api/internals/game/file_watcher_test.h"
 #include "tests/api/internals/game/game_cache_test.h"
+#include "tests/api/internals/game/game_policy_test.h"
 #include "tests/api/internals/game/game_test.h"
 #include "tests/api/internals/game/load_order_handler_test.h"
+#include "tests/api/internals/game/load_order_state_test.h"
+#include "tests/api/internals/game/persistent_plugin_cache_test.h"
+#include "tests/api/internals/game/shared_plugin_cache_test.h"
+#include "tests/api/internals/helpers/cache_file_test.h"
 #include "tests/api/internals/helpers/crc_test.h"
 #include "tests/api/internals/helpers/git_helper_test.h"
+#include "tests/api/internals/helpers/memory_resource_test.h"
+#include "tests/api/internals/helpers/memory_usage_test.h"
 #include "tests/api/internals/helpers/text_test.h"
+#include "tests/api/internals/helpers/thread_pool_test.h"
+#include "tests/api/internals/helpers/tracing_test.h"
 #include "tests/api/internals/helpers/yaml_set_helpers_test.h"
 #include "tests/api/internals/masterlist_test.h"
 #include "tests/api/internals/metadata/condition_evaluator_test.h"
@@ -41,11 +53,17 @@
 #include "tests/api/internals/metadata/message_test.h"
 #include "tests/api/internals/metadata/plugin_cleaning_data_test.h"
 #include "tests/api/internals/metadata/plugin_metadata_test.h"
+#include "tests/api/internals/metadata/regex_prefilter_test.h"
 #include "tests/api/internals/metadata/tag_test.h"
+#include "tests/api/internals/metadata_list_cache_test.h"
 #include "tests/api/internals/metadata_list_test.h"
 #include "tests/api/internals/plugin_test.h"
+#include "tests/api/internals/scalability_test.h"
 #include "tests/api/internals/sorting/group_sort_test.h"
+#include "tests/api/internals/sorting/overlap_matrix_test.h"
 #include "tests/api/internals/sorting/plugin_sorter_test.h"
+#include "tests/api/internals/sorting/sort_capture_test.h"
+#include "tests/api/internals/sorting/sorted_plugin_graph_test.h"
 
 TEST(ModuloOperator, shouldConformToTheCpp11Standard) {
   // C++11 defines the modulo operator more strongly
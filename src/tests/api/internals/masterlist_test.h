@@ -27,6 +27,8 @@ along with LOOT.  If not, see
 
 #include "api/masterlist.h"
 
+#include <chrono>
+
 #include "tests/common_game_test_fixture.h"
 
 namespace loot {
@@ -79,6 +81,38 @@ INSTANTIATE_TEST_CASE_P(,
                                           GameType::fo4,
                                           GameType::tes5se));
 
+TEST_P(MasterlistTest,
+       loadSharedShouldReturnTheSameMasterlistIfItIsStillInUseAndUnchanged) {
+  std::ofstream out(masterlistPath);
+  out << "bash_tags:\n  - C.Climate\n";
+  out.close();
+
+  auto masterlist1 = Masterlist::LoadShared(masterlistPath);
+  auto masterlist2 = Masterlist::LoadShared(masterlistPath);
+
+  EXPECT_EQ(masterlist1, masterlist2);
+  EXPECT_EQ(std::set<std::string>({"C.Climate"}), masterlist2->BashTags());
+}
+
+TEST_P(MasterlistTest, loadSharedShouldLoadTheMasterlistAgainIfItHasChanged) {
+  std::ofstream out(masterlistPath);
+  out << "bash_tags:\n  - C.Climate\n";
+  out.close();
+
+  auto masterlist1 = Masterlist::LoadShared(masterlistPath);
+
+  out.open(masterlistPath);
+  out << "bash_tags:\n  - C.Climate\n  - Relev\n";
+  out.close();
+
+  auto masterlist2 = Masterlist::LoadShared(masterlistPath);
+
+  EXPECT_NE(masterlist1, masterlist2);
+  EXPECT_EQ(std::set<std::string>({"C.Climate"}), masterlist1->BashTags());
+  EXPECT_EQ(std::set<std::string>({"C.Climate", "Relev"}),
+            masterlist2->BashTags());
+}
+
 TEST_P(MasterlistTest, updateShouldThrowIfAnInvalidPathIsGiven) {
   Masterlist masterlist;
 
@@ -145,6 +179,23 @@ TEST_P(MasterlistTest, updateShouldReturnFalseIfAnUpToDateMasterlistWithANonAsci
   EXPECT_TRUE(std::filesystem::exists(nonAsciiMasterlistPath));
 }
 
+TEST_P(MasterlistTest, updateShouldOnlyFetchTheGivenBranch) {
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, repoBranch));
+
+  auto remoteRefsPath = localPath / ".git" / "refs" / "remotes" / "origin";
+  EXPECT_TRUE(std::filesystem::exists(remoteRefsPath / repoBranch));
+  EXPECT_FALSE(std::filesystem::exists(remoteRefsPath / oldBranch));
+}
+
+TEST_P(MasterlistTest, updateShouldFetchANewBranchIfTheGivenBranchChanges) {
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, repoBranch));
+
+  EXPECT_TRUE(masterlist.Update(masterlistPath, repoUrl, oldBranch));
+  EXPECT_TRUE(Masterlist::IsLatest(masterlistPath, oldBranch));
+}
+
 TEST_P(MasterlistTest,
        updateShouldDiscardLocalHistoryIfRemoteHistoryIsDifferent) {
   Masterlist masterlist;
@@ -259,6 +310,109 @@ TEST_P(
 
   EXPECT_TRUE(Masterlist::IsLatest(masterlistPath, repoBranch));
 }
+
+TEST_P(MasterlistTest,
+       isLatestShouldNotFetchFromTheRemoteIfTheBranchIsAlreadyUpToDate) {
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, repoBranch));
+
+  auto fetchHeadPath = localPath / ".git" / "FETCH_HEAD";
+  std::filesystem::remove(fetchHeadPath);
+
+  EXPECT_TRUE(Masterlist::IsLatest(masterlistPath, repoBranch));
+  EXPECT_FALSE(std::filesystem::exists(fetchHeadPath));
+}
+
+TEST_P(MasterlistTest,
+       getInfoShouldReuseACachedRevisionIfHeadAndTheMasterlistAreUnchanged) {
+  MasterlistRevisionCache cache;
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, repoBranch, &cache));
+
+  auto info = Masterlist::GetInfo(masterlistPath, false, &cache);
+  auto revision = cache.GetRevision(masterlistPath, info.revision_id);
+  ASSERT_TRUE(revision.has_value());
+
+  revision->headDate = "cached";
+  cache.SetRevision(masterlistPath, revision.value());
+
+  info = Masterlist::GetInfo(masterlistPath, false, &cache);
+  EXPECT_EQ("cached", info.revision_date);
+  EXPECT_FALSE(info.is_modified);
+}
+
+TEST_P(MasterlistTest,
+       getInfoShouldNotReuseACachedRevisionIfTheMasterlistHasBeenEdited) {
+  MasterlistRevisionCache cache;
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, repoBranch, &cache));
+  ASSERT_FALSE(Masterlist::GetInfo(masterlistPath, false, &cache).is_modified);
+
+  std::ofstream out(masterlistPath);
+  out.close();
+
+  EXPECT_TRUE(Masterlist::GetInfo(masterlistPath, false, &cache).is_modified);
+}
+
+TEST_P(MasterlistTest,
+       isLatestShouldReuseACachedResultWithinTheFetchInterval) {
+  MasterlistRevisionCache cache;
+  cache.SetFetchInterval(std::chrono::hours(1));
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, oldBranch, &cache));
+
+  auto headId = Masterlist::GetInfo(masterlistPath, false).revision_id;
+  cache.SetIsLatest(masterlistPath, repoBranch, headId, true);
+
+  EXPECT_TRUE(Masterlist::IsLatest(masterlistPath, repoBranch, &cache));
+}
+
+TEST_P(MasterlistTest,
+       isLatestShouldNotReuseACachedResultIfTheFetchIntervalIsZero) {
+  MasterlistRevisionCache cache;
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, oldBranch, &cache));
+
+  auto headId = Masterlist::GetInfo(masterlistPath, false).revision_id;
+  cache.SetIsLatest(masterlistPath, repoBranch, headId, true);
+
+  EXPECT_FALSE(Masterlist::IsLatest(masterlistPath, repoBranch, &cache));
+}
+
+TEST_P(MasterlistTest,
+       updateShouldRecordThatTheMasterlistIsTheLatestRevisionOfItsBranch) {
+  MasterlistRevisionCache cache;
+  cache.SetFetchInterval(std::chrono::hours(1));
+  Masterlist masterlist;
+  ASSERT_TRUE(masterlist.Update(masterlistPath, repoUrl, repoBranch, &cache));
+
+  auto headId = Masterlist::GetInfo(masterlistPath, false).revision_id;
+  EXPECT_EQ(true, cache.IsLatest(masterlistPath, repoBranch, headId));
+}
+
+TEST(MasterlistRevisionCache,
+     isLatestShouldNotReuseAResultForADifferentBranchOrHeadCommit) {
+  MasterlistRevisionCache cache;
+  cache.SetFetchInterval(std::chrono::hours(1));
+  cache.SetIsLatest("masterlist.yaml", "master", "id", true);
+
+  EXPECT_EQ(true, cache.IsLatest("masterlist.yaml", "master", "id"));
+  EXPECT_FALSE(cache.IsLatest("masterlist.yaml", "other", "id"));
+  EXPECT_FALSE(cache.IsLatest("masterlist.yaml", "master", "other"));
+  EXPECT_FALSE(cache.IsLatest("other.yaml", "master", "id"));
+}
+
+TEST(MasterlistRevisionCache,
+     getRevisionShouldReturnNulloptIfTheFileIsMissing) {
+  MasterlistRevisionCache cache;
+  MasterlistRevisionCache::Revision revision;
+  revision.headId = "id";
+  revision.fileSize = 0;
+  revision.isModified = false;
+  cache.SetRevision("missing.yaml", revision);
+
+  EXPECT_FALSE(cache.GetRevision("missing.yaml", "id"));
+}
 }
 }
 
@@ -123,6 +123,62 @@ TEST_P(ConditionEvaluatorTest,
   EXPECT_TRUE(evaluator_.Evaluate("file(\"" + blankEsm + "\")"));
 }
 
+TEST_P(ConditionEvaluatorTest,
+       evaluateShouldAnswerSimpleFileConditionsFromTheDataDirectorySnapshot) {
+  const std::string snapshotEsp = "Snapshot.esp";
+  std::filesystem::copy_file(dataPath / blankEsp, dataPath / snapshotEsp);
+  evaluator_.SetDataDirectorySnapshot(DataDirectorySnapshot(dataPath));
+
+  // The file is checked for in the snapshot, not on disk.
+  std::filesystem::remove(dataPath / snapshotEsp);
+
+  EXPECT_TRUE(evaluator_.Evaluate("file(\"" + snapshotEsp + "\")"));
+  EXPECT_FALSE(evaluator_.Evaluate("not file(\"" + snapshotEsp + "\")"));
+  EXPECT_TRUE(evaluator_.Evaluate("file(\"" + blankMasterDependentEsm + "\")"));
+  EXPECT_FALSE(evaluator_.Evaluate("file(\"" + missingEsp + "\")"));
+  EXPECT_TRUE(evaluator_.Evaluate("not file(\"" + missingEsp + "\")"));
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluateShouldStillCheckTheFilesystemForPathsNotInTheSnapshot) {
+  evaluator_.SetDataDirectorySnapshot(DataDirectorySnapshot(dataPath));
+
+  EXPECT_TRUE(evaluator_.Evaluate("file(\"" + nonAsciiNestedFile + "\")"));
+  EXPECT_TRUE(evaluator_.Evaluate(
+      "file(\"" +
+      std::filesystem::u8path(nonAsciiNestedFile).parent_path().u8string() +
+      "\")"));
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluateShouldGiveTheSameResultForBackslashSeparatedPathsWithASnapshot) {
+  auto nestedFile = std::filesystem::u8path(nonAsciiNestedFile);
+  auto condition = "file(\"" + nestedFile.parent_path().u8string() + "\\" +
+                   nestedFile.filename().u8string() + "\")";
+  auto expected = evaluator_.Evaluate(condition);
+
+  ConditionEvaluator evaluator(game_.Type(), game_.DataPath());
+  evaluator.RefreshState(game_.GetLoadOrderHandler());
+  evaluator.SetDataDirectorySnapshot(DataDirectorySnapshot(dataPath));
+
+  EXPECT_EQ(expected, evaluator.Evaluate(condition));
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluateShouldGiveTheSameResultForSimpleActiveConditionsWithASnapshot) {
+  auto active = evaluator_.Evaluate("active(\"" + blankEsm + "\")");
+  auto inactive = evaluator_.Evaluate("active(\"" + blankEsp + "\")");
+
+  ConditionEvaluator evaluator(game_.Type(), game_.DataPath());
+  evaluator.RefreshState(game_.GetLoadOrderHandler());
+  evaluator.SetDataDirectorySnapshot(DataDirectorySnapshot(dataPath));
+
+  EXPECT_EQ(active, evaluator.Evaluate("active(\"" + blankEsm + "\")"));
+  EXPECT_EQ(inactive, evaluator.Evaluate("active(\"" + blankEsp + "\")"));
+  EXPECT_EQ(!inactive,
+            evaluator.Evaluate("not active(\"" + blankEsp + "\")"));
+}
+
 TEST_P(ConditionEvaluatorTest,
   evaluateFileConditionShouldReturnTrueForANonAsciiFileThatExists) {
   EXPECT_TRUE(evaluator_.Evaluate("file(\"" + nonAsciiEsm + "\")"));
@@ -164,6 +220,132 @@ TEST_P(ConditionEvaluatorTest,
   EXPECT_FALSE(evaluator_.Evaluate("file(\"" + missingEsp + "\")"));
 }
 
+TEST_P(ConditionEvaluatorTest,
+       evaluateShouldReuseResultsUntilTheConditionCacheIsCleared) {
+  std::string condition = "file(\"" + missingEsp + "\")";
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+
+  std::filesystem::copy_file(dataPath / blankEsp, dataPath / missingEsp);
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+
+  evaluator_.ClearConditionCache();
+  EXPECT_TRUE(evaluator_.Evaluate(condition));
+}
+
+TEST_P(
+    ConditionEvaluatorTest,
+    refreshStateWithTheLoadOrderHandlerShouldNotDiscardResultsThatDoNotDependOnActivePlugins) {
+  const std::string condition = "file(\"" + missingEsp + "\")";
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+
+  std::filesystem::copy_file(dataPath / blankEsp, dataPath / missingEsp);
+  evaluator_.RefreshState(game_.GetLoadOrderHandler());
+
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+}
+
+TEST_P(ConditionEvaluatorTest,
+       refreshStateWithTheGameCacheShouldDiscardResultsThatDependOnFiles) {
+  const std::string condition = "file(\"" + missingEsp + "\")";
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+
+  std::filesystem::copy_file(dataPath / blankEsp, dataPath / missingEsp);
+  evaluator_.RefreshState(game_.GetCache());
+
+  EXPECT_TRUE(evaluator_.Evaluate(condition));
+}
+
+TEST_P(ConditionEvaluatorTest,
+       updatePluginStateShouldNotDiscardResultsThatDoNotDependOnThePlugin) {
+  const std::string condition = "file(\"" + missingEsp + "\")";
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+
+  std::filesystem::copy_file(dataPath / blankEsp, dataPath / missingEsp);
+  evaluator_.UpdatePluginState(
+      Plugin(game_.Type(), game_.GetCache(), dataPath / blankEsm, true));
+
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+}
+
+TEST_P(ConditionEvaluatorTest,
+       retainPluginStatesShouldDiscardResultsThatDependOnPluginsNotRetained) {
+  const std::string condition = "version(\"" + blankEsm + "\", \"5.0\", ==)";
+  EXPECT_TRUE(evaluator_.Evaluate(condition));
+
+  std::filesystem::remove(dataPath / blankEsm);
+  evaluator_.RetainPluginStates({blankEsp});
+
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+}
+
+TEST_P(ConditionEvaluatorTest,
+       updatePluginStateShouldIncrementTheStateGeneration) {
+  auto generation = evaluator_.GetStateGeneration();
+
+  evaluator_.RetainPluginStates({});
+  evaluator_.UpdatePluginState(
+      Plugin(game_.Type(), game_.GetCache(), dataPath / blankEsm, true));
+
+  EXPECT_EQ(generation + 2, evaluator_.GetStateGeneration());
+}
+
+TEST_P(ConditionEvaluatorTest,
+       refreshStateShouldIncrementTheStateGeneration) {
+  auto generation = evaluator_.GetStateGeneration();
+
+  evaluator_.RefreshState(game_.GetCache());
+  EXPECT_EQ(generation + 1, evaluator_.GetStateGeneration());
+
+  evaluator_.RefreshState(game_.GetLoadOrderHandler());
+  EXPECT_EQ(generation + 2, evaluator_.GetStateGeneration());
+}
+
+TEST_P(ConditionEvaluatorTest,
+       clearConditionCacheShouldNotChangeTheStateGeneration) {
+  auto generation = evaluator_.GetStateGeneration();
+
+  evaluator_.ClearConditionCache();
+
+  EXPECT_EQ(generation, evaluator_.GetStateGeneration());
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluateAllShouldUseDirtyInfoWithAHexCrcMatchingThePluginCrc) {
+  game_.LoadPlugins({blankEsm}, false);
+  evaluator_.RefreshState(game_.GetCache());
+
+  PluginMetadata plugin(blankEsm);
+  PluginCleaningData info(blankEsmCrc, "utility", info_, 1, 2, 3);
+  plugin.SetDirtyInfo({info});
+
+  plugin = evaluator_.EvaluateAll(plugin);
+
+  EXPECT_EQ(std::set<PluginCleaningData>({info}), plugin.GetDirtyInfo());
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluateAllShouldCompareCleaningDataWithTheCrcOfALoadedPlugin) {
+  game_.LoadPlugins({blankEsm}, false);
+  game_.GetPlugin(blankEsm)->GetCRC();
+  evaluator_.RefreshState(game_.GetCache());
+
+  // Change the file on disk so that its CRC is only known from the cache.
+  std::filesystem::copy_file(dataPath / blankEsp,
+                             dataPath / blankEsm,
+                             std::filesystem::copy_options::overwrite_existing);
+
+  PluginMetadata plugin(blankEsm);
+  PluginCleaningData info1(blankEsmCrc, "utility", info_, 1, 2, 3);
+  PluginCleaningData info2(0xDEADBEEF, "utility", info_, 1, 2, 3);
+  plugin.SetDirtyInfo({info1, info2});
+  plugin.SetCleanInfo({info1, info2});
+
+  plugin = evaluator_.EvaluateAll(plugin);
+
+  EXPECT_EQ(std::set<PluginCleaningData>({info1}), plugin.GetDirtyInfo());
+  EXPECT_EQ(std::set<PluginCleaningData>({info1}), plugin.GetCleanInfo());
+}
+
 TEST_P(ConditionEvaluatorTest, evaluateAllShouldEvaluateAllMetadataConditions) {
   PluginMetadata plugin(nonAsciiEsm);
   plugin.SetGroup("group1");
@@ -206,6 +388,186 @@ TEST_P(ConditionEvaluatorTest, evaluateAllShouldPreserveGroupExplicitness) {
   EXPECT_NO_THROW(plugin = evaluator_.EvaluateAll(plugin));
   EXPECT_FALSE(plugin.GetGroup());
 }
+
+TEST_P(ConditionEvaluatorTest,
+       evaluatingABatchOfConditionsShouldReturnResultsInTheGivenOrder) {
+  std::string trueCondition = "file(\"" + blankEsm + "\")";
+  std::string falseCondition = "file(\"" + missingEsp + "\")";
+
+  auto results = evaluator_.Evaluate(std::vector<std::string>(
+      {trueCondition, falseCondition, "", falseCondition, trueCondition}));
+
+  EXPECT_EQ(std::vector<bool>({true, false, true, false, true}), results);
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluatingALargeBatchOfConditionsShouldGiveTheSameResultsAsOneByOne) {
+  std::vector<std::string> conditions;
+  for (size_t i = 0; i < 200; ++i) {
+    if (i % 3 == 0) {
+      conditions.push_back("file(\"" + blankEsm + "\")");
+    } else {
+      conditions.push_back("file(\"missing" + std::to_string(i) + ".esp\")");
+    }
+  }
+
+  auto results = evaluator_.Evaluate(conditions);
+
+  ASSERT_EQ(conditions.size(), results.size());
+  for (size_t i = 0; i < conditions.size(); ++i) {
+    EXPECT_EQ(evaluator_.Evaluate(conditions[i]), results[i]);
+  }
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluatingABatchOfConditionsShouldThrowIfAnyConditionIsInvalid) {
+  EXPECT_THROW(evaluator_.Evaluate(std::vector<std::string>(
+                   {"file(\"" + blankEsm + "\")", "condition"})),
+               ConditionSyntaxError);
+}
+
+TEST_P(ConditionEvaluatorTest,
+       evaluateAllForABatchOfPluginsShouldEvaluateEachPluginsConditions) {
+  PluginMetadata plugin1(blankEsm);
+  File file1(blankEsp);
+  File file2(blankDifferentEsm, "", "file(\"" + missingEsp + "\")");
+  plugin1.SetLoadAfterFiles({file1, file2});
+
+  PluginMetadata plugin2(blankEsp);
+  Tag tag1("Relev");
+  Tag tag2("Delev", true, "file(\"" + missingEsp + "\")");
+  plugin2.SetTags({tag1, tag2});
+  PluginCleaningData info1(blankEsmCrc, "utility", info_, 1, 2, 3);
+  PluginCleaningData info2(0xDEADBEEF, "utility", info_, 1, 2, 3);
+  plugin2.SetDirtyInfo({info1, info2});
+
+  PluginMetadata plugin3("Blank.*\\.esp");
+  plugin3.SetDirtyInfo({info1});
+
+  auto evaluated = evaluator_.EvaluateAll(
+      std::vector<PluginMetadata>({plugin1, plugin2, plugin3}));
+
+  ASSERT_EQ(3, evaluated.size());
+  EXPECT_EQ(plugin1.GetName(), evaluated[0].GetName());
+  EXPECT_EQ(std::set<File>({file1}), evaluated[0].GetLoadAfterFiles());
+  EXPECT_EQ(plugin2.GetName(), evaluated[1].GetName());
+  EXPECT_EQ(std::set<Tag>({tag1}), evaluated[1].GetTags());
+  EXPECT_EQ(evaluator_.EvaluateAll(plugin2).GetDirtyInfo(),
+            evaluated[1].GetDirtyInfo());
+  EXPECT_EQ(plugin3.GetName(), evaluated[2].GetName());
+  EXPECT_TRUE(evaluated[2].GetDirtyInfo().empty());
+}
+
+TEST_P(ConditionEvaluatorTest,
+       precomputeConditionsShouldCacheConditionsThatDoNotDependOnPluginStates) {
+  const std::string fileCondition = "file(\"" + blankEsm + "\")";
+  const std::string checksumCondition =
+      "checksum(\"" + blankEsm + "\", " + IntToHexString(blankEsmCrc) + ")";
+  PluginMetadata metadata(blankEsp);
+  metadata.SetTags(
+      {Tag("Relev", true, fileCondition), Tag("Delev", true, checksumCondition)});
+  evaluator_.SetProfilingEnabled(true);
+
+  evaluator_.PrecomputeConditions(metadata);
+  auto evaluated = evaluator_.EvaluateAll(metadata);
+
+  auto profile = evaluator_.GetProfile(0);
+  ASSERT_EQ(2, profile.size());
+  auto fileStats =
+      profile[0].condition == fileCondition ? profile[0] : profile[1];
+  auto checksumStats =
+      profile[0].condition == fileCondition ? profile[1] : profile[0];
+  EXPECT_EQ(1, fileStats.evaluations);
+  EXPECT_EQ(1, fileStats.cacheHits);
+  EXPECT_EQ(1, checksumStats.evaluations);
+  EXPECT_EQ(0, checksumStats.cacheHits);
+  EXPECT_EQ(2, evaluated.GetTags().size());
+}
+
+TEST_P(ConditionEvaluatorTest,
+       precomputeConditionsShouldNotUseInterpreterResultsForChangedFiles) {
+  const std::string file = "precompute.txt";
+  std::ofstream(dataPath / file).close();
+  const std::string condition =
+      "file(\"" + file + "\") and file(\"" + blankEsm + "\")";
+  ASSERT_TRUE(evaluator_.Evaluate(condition));
+
+  std::filesystem::remove(dataPath / file);
+  evaluator_.SetDataDirectorySnapshot(DataDirectorySnapshot(dataPath));
+
+  PluginMetadata metadata(blankEsp);
+  metadata.SetTags({Tag("Relev", true, condition)});
+  evaluator_.PrecomputeConditions(metadata);
+
+  EXPECT_FALSE(evaluator_.Evaluate(condition));
+}
+
+TEST_P(ConditionEvaluatorTest, getProfileShouldBeEmptyIfProfilingIsDisabled) {
+  evaluator_.Evaluate("file(\"" + blankEsm + "\")");
+
+  EXPECT_TRUE(evaluator_.GetProfile(0).empty());
+}
+
+TEST_P(ConditionEvaluatorTest,
+       profilingShouldRecordEvaluationsAndCacheHitsForEachCondition) {
+  const std::string condition1 = "file(\"" + blankEsm + "\")";
+  const std::string condition2 = "file(\"" + missingEsp + "\")";
+  evaluator_.SetProfilingEnabled(true);
+
+  evaluator_.Evaluate(condition1);
+  evaluator_.Evaluate(condition1);
+  evaluator_.Evaluate(condition1);
+  evaluator_.Evaluate(condition2);
+  evaluator_.Evaluate("");
+
+  auto profile = evaluator_.GetProfile(0);
+
+  ASSERT_EQ(2, profile.size());
+  auto stats1 = profile[0].condition == condition1 ? profile[0] : profile[1];
+  auto stats2 = profile[0].condition == condition1 ? profile[1] : profile[0];
+  EXPECT_EQ(condition1, stats1.condition);
+  EXPECT_EQ(1, stats1.evaluations);
+  EXPECT_EQ(2, stats1.cacheHits);
+  EXPECT_EQ(condition2, stats2.condition);
+  EXPECT_EQ(1, stats2.evaluations);
+  EXPECT_EQ(0, stats2.cacheHits);
+  EXPECT_GE(profile[0].totalTime, profile[1].totalTime);
+}
+
+TEST_P(ConditionEvaluatorTest,
+       getProfileShouldReturnOnlyTheGivenNumberOfMostExpensiveConditions) {
+  evaluator_.SetProfilingEnabled(true);
+
+  evaluator_.Evaluate("file(\"" + blankEsm + "\")");
+  evaluator_.Evaluate("file(\"" + blankEsp + "\")");
+  evaluator_.Evaluate("file(\"" + missingEsp + "\")");
+
+  auto all = evaluator_.GetProfile(0);
+  auto top = evaluator_.GetProfile(2);
+
+  ASSERT_EQ(3, all.size());
+  ASSERT_EQ(2, top.size());
+  EXPECT_EQ(all[0].condition, top[0].condition);
+  EXPECT_EQ(all[1].condition, top[1].condition);
+}
+
+TEST_P(ConditionEvaluatorTest,
+       disablingProfilingShouldKeepTheProfileAndEnablingItShouldClearIt) {
+  const std::string condition = "file(\"" + blankEsm + "\")";
+  evaluator_.SetProfilingEnabled(true);
+  evaluator_.Evaluate(condition);
+
+  evaluator_.SetProfilingEnabled(false);
+  evaluator_.Evaluate(condition);
+
+  auto profile = evaluator_.GetProfile(0);
+  ASSERT_EQ(1, profile.size());
+  EXPECT_EQ(0, profile[0].cacheHits);
+
+  evaluator_.SetProfilingEnabled(true);
+
+  EXPECT_TRUE(evaluator_.GetProfile(0).empty());
+}
 }
 }
 
@@ -82,6 +82,20 @@ TEST_P(ConditionalMetadataTest,
   EXPECT_THROW(conditionalMetadata_.ParseCondition(), ConditionSyntaxError);
 }
 
+TEST_P(ConditionalMetadataTest,
+       parseConditionShouldThrowForAnInvalidConditionEachTimeItIsParsed) {
+  conditionalMetadata_ = ConditionalMetadata("condition");
+  EXPECT_THROW(conditionalMetadata_.ParseCondition(), ConditionSyntaxError);
+  EXPECT_THROW(conditionalMetadata_.ParseCondition(), ConditionSyntaxError);
+}
+
+TEST_P(ConditionalMetadataTest,
+       parseConditionShouldNotThrowForAValidConditionThatWasAlreadyParsed) {
+  conditionalMetadata_ = ConditionalMetadata("file(\"" + blankEsm + "\")");
+  EXPECT_NO_THROW(conditionalMetadata_.ParseCondition());
+  EXPECT_NO_THROW(conditionalMetadata_.ParseCondition());
+}
+
 TEST_P(ConditionalMetadataTest, parseConditionShouldNotThrowForATrueCondition) {
   conditionalMetadata_ = ConditionalMetadata("file(\"" + blankEsm + "\")");
   EXPECT_NO_THROW(conditionalMetadata_.ParseCondition());
@@ -90,6 +90,30 @@ TEST(MessageContent,
   EXPECT_FALSE(content2 < content1);
 }
 
+TEST(MessageContent, choosePointerShouldReturnNullIfTheVectorIsEmpty) {
+  EXPECT_EQ(nullptr, MessageContent::ChoosePointer({}, french));
+}
+
+TEST(MessageContent,
+     choosePointerShouldPointToTheGivenLanguageContentIfItExists) {
+  std::vector<MessageContent> content({
+      MessageContent("content1"),
+      MessageContent("content2", french),
+  });
+
+  EXPECT_EQ(&content[1], MessageContent::ChoosePointer(content, french));
+}
+
+TEST(MessageContent,
+     choosePointerShouldPointToTheEnglishContentIfTheGivenLanguageIsMissing) {
+  std::vector<MessageContent> content({
+      MessageContent("content1", french),
+      MessageContent("content2"),
+  });
+
+  EXPECT_EQ(&content[1], MessageContent::ChoosePointer(content, "de"));
+}
+
 TEST(MessageContent, emittingAsYamlShouldOutputDataCorrectly) {
   MessageContent content("content", french);
   YAML::Emitter emitter;
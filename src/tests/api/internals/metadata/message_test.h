@@ -174,6 +174,38 @@ TEST_P(MessageTest, toSimpleMessageShouldSelectTextAndLanguageUsingGetContent) {
   EXPECT_EQ("condition1", simpleMessage.condition);
 }
 
+TEST_P(MessageTest,
+       toSimpleMessageViewShouldReferToTheSelectedContentWithoutCopyingIt) {
+  Message message(MessageType::warn,
+                  MessageContents({
+                      MessageContent("content1", german),
+                      MessageContent("content2"),
+                      MessageContent("content3", french),
+                  }),
+                  "condition1");
+
+  SimpleMessageView view = message.ToSimpleMessageView(french);
+
+  EXPECT_EQ(MessageType::warn, view.type);
+  EXPECT_EQ("content3", view.text);
+  EXPECT_EQ(french, view.language);
+  EXPECT_EQ("condition1", view.condition);
+  EXPECT_EQ(message.GetContent()[2].GetText().data(), view.text.data());
+  EXPECT_EQ(message.GetCondition().data(), view.condition.data());
+}
+
+TEST_P(MessageTest,
+       toSimpleMessageViewShouldReturnEmptyEnglishTextIfThereIsNoContent) {
+  Message message;
+
+  SimpleMessageView view = message.ToSimpleMessageView(french);
+
+  EXPECT_EQ(MessageType::say, view.type);
+  EXPECT_EQ("", view.text);
+  EXPECT_EQ(MessageContent::defaultLanguage, view.language);
+  EXPECT_EQ("", view.condition);
+}
+
 TEST_P(MessageTest, emittingAsYamlShouldOutputNoteMessageTypeCorrectly) {
   Message message(MessageType::say, "content1");
   YAML::Emitter emitter;
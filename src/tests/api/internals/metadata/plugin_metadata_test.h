@@ -27,6 +27,7 @@ along with LOOT.  If not, see
 
 #include "loot/metadata/plugin_metadata.h"
 
+#include "api/helpers/text.h"
 #include "tests/common_game_test_fixture.h"
 
 #include "api/metadata/yaml/plugin_metadata.h"
@@ -69,6 +70,36 @@ TEST_P(
   EXPECT_FALSE(plugin.GetGroup());
 }
 
+TEST_P(PluginMetadataTest,
+       getNormalizedNameShouldNormalizeTheNameWithoutAGhostExtension) {
+  PluginMetadata plugin(blankEsm + ".GHOST");
+
+  EXPECT_EQ(NormalizeFilename(blankEsm), plugin.GetNormalizedName());
+}
+
+TEST_P(PluginMetadataTest,
+       hashShouldBeEqualForNamesThatAreCaseInsensitivelyEqual) {
+  PluginMetadata plugin1(blankEsm);
+  PluginMetadata plugin2(boost::to_upper_copy(blankEsm));
+
+  EXPECT_EQ(std::hash<PluginMetadata>()(plugin1),
+            std::hash<PluginMetadata>()(plugin2));
+}
+
+TEST_P(PluginMetadataTest,
+       hashAndEqualityShouldBeKeptWhenCopyingAndAssigning) {
+  PluginMetadata plugin1(blankEsm);
+  PluginMetadata plugin2(plugin1);
+  PluginMetadata plugin3(blankDifferentEsm);
+  plugin3 = plugin1;
+
+  EXPECT_EQ(std::hash<PluginMetadata>()(plugin1),
+            std::hash<PluginMetadata>()(plugin2));
+  EXPECT_EQ(std::hash<PluginMetadata>()(plugin1),
+            std::hash<PluginMetadata>()(plugin3));
+  EXPECT_TRUE(plugin1 == plugin3);
+}
+
 TEST_P(PluginMetadataTest,
        equalityOperatorShouldUseCaseInsensitiveNameComparisonForNonRegexNames) {
   PluginMetadata plugin1(blankEsm);
@@ -212,6 +243,38 @@ TEST_P(PluginMetadataTest, mergeMetadataShouldMergeMessages) {
   EXPECT_EQ(std::vector<Message>({message, message}), plugin1.GetMessages());
 }
 
+TEST_P(PluginMetadataTest, copiesShouldShareMetadataContainers) {
+  PluginMetadata plugin1(blankEsm);
+  plugin1.SetTags({Tag("Relev")});
+
+  PluginMetadata plugin2(plugin1);
+
+  EXPECT_EQ(&plugin1.GetTags(), &plugin2.GetTags());
+}
+
+TEST_P(PluginMetadataTest, settingMetadataOnACopyShouldNotChangeTheOriginal) {
+  PluginMetadata plugin1(blankEsm);
+  plugin1.SetTags({Tag("Relev")});
+
+  PluginMetadata plugin2(plugin1);
+  plugin2.SetTags({Tag("Delev")});
+  plugin2.MergeMetadata(plugin1);
+
+  EXPECT_EQ(std::set<Tag>({Tag("Relev")}), plugin1.GetTags());
+  EXPECT_EQ(std::set<Tag>({Tag("Relev"), Tag("Delev")}), plugin2.GetTags());
+}
+
+TEST_P(PluginMetadataTest,
+       mergeMetadataShouldShareTheMergedContainersIfThisObjectHasNone) {
+  PluginMetadata plugin1(blankEsm);
+  PluginMetadata plugin2(blankEsm);
+  plugin2.SetTags({Tag("Relev")});
+
+  plugin1.MergeMetadata(plugin2);
+
+  EXPECT_EQ(&plugin2.GetTags(), &plugin1.GetTags());
+}
+
 TEST_P(PluginMetadataTest, mergeMetadataShouldMergeTags) {
   PluginMetadata plugin1;
   PluginMetadata plugin2;
@@ -452,6 +515,52 @@ TEST_P(PluginMetadataTest,
   EXPECT_EQ(std::set<Location>({location2}), newMetadata.GetLocations());
 }
 
+TEST_P(PluginMetadataTest,
+       newMetadataShouldShareDataThatHasNothingInCommonWithTheInputPlugin) {
+  PluginMetadata plugin1;
+  PluginMetadata plugin2;
+  Tag tag1("Relev");
+  Tag tag2("Delev");
+
+  plugin1.SetTags({tag1});
+  plugin1.SetLoadAfterFiles({File(blankEsm)});
+  plugin2.SetTags({tag2});
+  PluginMetadata newMetadata = plugin1.NewMetadata(plugin2);
+
+  EXPECT_EQ(&plugin1.GetTags(), &newMetadata.GetTags());
+  EXPECT_EQ(&plugin1.GetLoadAfterFiles(), &newMetadata.GetLoadAfterFiles());
+}
+
+TEST_P(PluginMetadataTest,
+       newMetadataShouldSortMessagesIfTheInputPluginHasNoMessages) {
+  PluginMetadata plugin1;
+  PluginMetadata plugin2;
+  Message message1(MessageType::say, "content1");
+  Message message2(MessageType::say, "content2");
+
+  plugin1.SetMessages({message2, message1});
+  PluginMetadata newMetadata = plugin1.NewMetadata(plugin2);
+
+  EXPECT_EQ(std::vector<Message>({message1, message2}),
+            newMetadata.GetMessages());
+}
+
+TEST_P(PluginMetadataTest,
+       mergeMetadataShouldKeepExistingElementsThatAreEqualToMergedElements) {
+  PluginMetadata plugin1;
+  PluginMetadata plugin2;
+  File file1(blankEsm, "display1");
+  File file2(blankEsm, "display2");
+  File file3(blankEsp);
+
+  plugin1.SetLoadAfterFiles({file1});
+  plugin2.SetLoadAfterFiles({file2, file3});
+  plugin1.MergeMetadata(plugin2);
+
+  EXPECT_EQ(std::set<File>({file1, file3}), plugin1.GetLoadAfterFiles());
+  EXPECT_EQ("display1", plugin1.GetLoadAfterFiles().begin()->GetDisplayName());
+}
+
 TEST_P(PluginMetadataTest, simpleMessagesShouldReturnMessagesAsSimpleMessages) {
   PluginMetadata plugin;
   plugin.SetMessages({
@@ -476,6 +585,27 @@ TEST_P(PluginMetadataTest, simpleMessagesShouldReturnMessagesAsSimpleMessages) {
   EXPECT_EQ("content3", simpleMessages.back().text);
 }
 
+TEST_P(PluginMetadataTest,
+       simpleMessageViewsShouldReturnMessagesAsSimpleMessageViews) {
+  PluginMetadata plugin;
+  plugin.SetMessages({
+      Message(MessageType::say, "content1"),
+      Message(MessageType::warn,
+              {{"content2", french},
+               {"other content2", MessageContent::defaultLanguage}}),
+  });
+
+  auto views = plugin.GetSimpleMessageViews(french);
+
+  ASSERT_EQ(2, views.size());
+  EXPECT_EQ(MessageType::say, views[0].type);
+  EXPECT_EQ(MessageContent::defaultLanguage, views[0].language);
+  EXPECT_EQ("content1", views[0].text);
+  EXPECT_EQ(MessageType::warn, views[1].type);
+  EXPECT_EQ(french, views[1].language);
+  EXPECT_EQ("content2", views[1].text);
+}
+
 TEST_P(PluginMetadataTest, unsetGroupShouldLeaveNoGroupValueSet) {
   PluginMetadata plugin;
   EXPECT_FALSE(plugin.GetGroup().has_value());
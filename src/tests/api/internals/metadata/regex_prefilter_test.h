@@ -0,0 +1,145 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_METADATA_REGEX_PREFILTER_TEST
+#define LOOT_TESTS_API_INTERNALS_METADATA_REGEX_PREFILTER_TEST
+
+#include "api/metadata/regex_prefilter.h"
+
+#include <regex>
+
+#include <gtest/gtest.h>
+
+namespace loot {
+namespace test {
+TEST(RegexPrefilter, getRequiredLiteralsShouldFindALiteralPrefixAndSuffix) {
+  auto literals = RegexPrefilter::GetRequiredLiterals("Foo.*\\.esp");
+
+  EXPECT_EQ("foo", literals.prefix);
+  EXPECT_EQ(".esp", literals.suffix);
+}
+
+TEST(RegexPrefilter,
+     getRequiredLiteralsShouldExcludeCharactersThatMayBeMatchedZeroTimes) {
+  auto literals = RegexPrefilter::GetRequiredLiterals("abc?d.*ef{0,2}");
+
+  EXPECT_EQ("ab", literals.prefix);
+  EXPECT_EQ("", literals.suffix);
+
+  literals = RegexPrefilter::GetRequiredLiterals("ab+.*c+d");
+  EXPECT_EQ("ab", literals.prefix);
+  EXPECT_EQ("d", literals.suffix);
+}
+
+TEST(RegexPrefilter,
+     getRequiredLiteralsShouldNotTreatEscapeSequencesOrClassesAsLiterals) {
+  auto literals = RegexPrefilter::GetRequiredLiterals("\\x41bc[de]\\d\\.esm");
+
+  EXPECT_EQ("", literals.prefix);
+  EXPECT_EQ(".esm", literals.suffix);
+}
+
+TEST(RegexPrefilter,
+     getRequiredLiteralsShouldFindNoLiteralsIfThereIsTopLevelAlternation) {
+  auto literals = RegexPrefilter::GetRequiredLiterals("foo\\.esp|bar\\.esp");
+
+  EXPECT_EQ("", literals.prefix);
+  EXPECT_EQ("", literals.suffix);
+
+  literals = RegexPrefilter::GetRequiredLiterals("(foo|bar)\\.esp");
+  EXPECT_EQ("", literals.prefix);
+  EXPECT_EQ(".esp", literals.suffix);
+}
+
+TEST(RegexPrefilter, getRequiredLiteralsShouldIgnoreLeadingAndTrailingAnchors) {
+  auto literals = RegexPrefilter::GetRequiredLiterals("^foo.*\\.esp$");
+
+  EXPECT_EQ("foo", literals.prefix);
+  EXPECT_EQ(".esp", literals.suffix);
+}
+
+TEST(RegexPrefilter, getCandidatesShouldOnlyReturnRegexesThatCouldMatch) {
+  RegexPrefilter prefilter;
+  prefilter.Add("Foo.*\\.esp");
+  prefilter.Add("Bar.*\\.esp");
+  prefilter.Add(".*\\.esm");
+  prefilter.Add(".*");
+
+  EXPECT_EQ(std::vector<size_t>({0, 3}), prefilter.GetCandidates("foobar.esp"));
+  EXPECT_EQ(std::vector<size_t>({1, 3}), prefilter.GetCandidates("BARFOO.ESP"));
+  EXPECT_EQ(std::vector<size_t>({0, 2, 3}), prefilter.GetCandidates("foo.esm"));
+  EXPECT_EQ(std::vector<size_t>({2, 3}), prefilter.GetCandidates("baz.esm"));
+  EXPECT_EQ(std::vector<size_t>({3}), prefilter.GetCandidates("f"));
+}
+
+TEST(RegexPrefilter, clearShouldRemoveAllRegexes) {
+  RegexPrefilter prefilter;
+  prefilter.Add(".*");
+  prefilter.Clear();
+  prefilter.Add("foo.*");
+
+  EXPECT_EQ(std::vector<size_t>({0}), prefilter.GetCandidates("foo.esp"));
+}
+
+TEST(RegexPrefilter,
+     getCandidatesShouldIncludeEveryRegexThatFullyMatchesTheText) {
+  const std::vector<std::string> regexes({
+      "Foo.*\\.esp",
+      "(foo|bar)\\.es[pm]",
+      "a+b?c*\\.esl",
+      "[Ff]oo\\d+\\.esp",
+      "Foo\\x2Eesp",
+      "foo(?:bar)?\\.esp",
+      "^FOO\\.esm$",
+      "foo{1,2}\\.esp",
+  });
+  const std::vector<std::string> texts({
+      "foo.esp", "FOO.ESP", "bar.esm", "foobar.esp", "foo12.esp", "fo.esp",
+      "aaa.esl", "abc.esl", "ac.esl", "foo.esm", "fooo.esp", "a.esp",
+  });
+
+  RegexPrefilter prefilter;
+  std::vector<std::regex> compiledRegexes;
+  for (const auto& regex : regexes) {
+    prefilter.Add(regex);
+    compiledRegexes.emplace_back(regex,
+                                 std::regex::ECMAScript | std::regex::icase);
+  }
+
+  for (const auto& text : texts) {
+    const auto candidates = prefilter.GetCandidates(text);
+    for (size_t i = 0; i < compiledRegexes.size(); ++i) {
+      if (std::regex_match(text, compiledRegexes[i])) {
+        EXPECT_NE(candidates.end(),
+                  std::find(candidates.begin(), candidates.end(), i))
+            << regexes[i] << " should be a candidate for " << text;
+      }
+    }
+  }
+}
+}
+}
+
+#endif
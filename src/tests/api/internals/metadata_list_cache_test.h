@@ -0,0 +1,312 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_METADATA_LIST_CACHE_TEST
+#define LOOT_TESTS_API_INTERNALS_METADATA_LIST_CACHE_TEST
+
+#include "api/metadata_list_cache.h"
+
+#include <fstream>
+
+#include "api/metadata/yaml/plugin_metadata.h"
+#include "api/metadata_list.h"
+#include "tests/common_game_test_fixture.h"
+
+namespace loot {
+namespace test {
+class MetadataListCacheTest : public CommonGameTestFixture {
+protected:
+  MetadataListCacheTest() :
+      metadataPath(metadataFilesPath / "masterlist.yaml"),
+      cacheFilePath(localPath / "masterlist.bin") {}
+
+  inline virtual void SetUp() {
+    CommonGameTestFixture::SetUp();
+
+    std::filesystem::copy(getSourceMetadataFilesPath() / "masterlist.yaml",
+                          metadataPath);
+    ASSERT_TRUE(std::filesystem::exists(metadataPath));
+    ASSERT_FALSE(std::filesystem::exists(cacheFilePath));
+  }
+
+  template<typename T>
+  static std::string ToYaml(const T& value) {
+    YAML::Emitter emitter;
+    emitter << value;
+    return emitter.c_str();
+  }
+
+  static std::map<std::string, std::string> ToYaml(
+      const std::list<PluginMetadata>& plugins) {
+    std::map<std::string, std::string> yaml;
+    for (const auto& plugin : plugins) {
+      yaml.emplace(plugin.GetName(), ToYaml(plugin));
+    }
+    return yaml;
+  }
+
+  // Groups' after groups are unordered, so they can't be compared as YAML.
+  static std::map<std::string,
+                  std::pair<std::string, std::set<std::string>>>
+  ToMap(const std::unordered_set<Group>& groups) {
+    std::map<std::string, std::pair<std::string, std::set<std::string>>> map;
+    for (const auto& group : groups) {
+      auto afterGroups = group.GetAfterGroups();
+      map.emplace(group.GetName(),
+                  std::make_pair(
+                      group.GetDescription(),
+                      std::set<std::string>(afterGroups.begin(),
+                                            afterGroups.end())));
+    }
+    return map;
+  }
+
+  const std::filesystem::path metadataPath;
+  const std::filesystem::path cacheFilePath;
+};
+
+// Pass an empty first argument, as it's a prefix for the test instantation,
+// but we only have the one so no prefix is necessary.
+INSTANTIATE_TEST_CASE_P(,
+                        MetadataListCacheTest,
+                        ::testing::Values(GameType::tes4));
+
+TEST_P(MetadataListCacheTest, loadShouldReturnNulloptIfTheCacheDoesNotExist) {
+  auto source = MetadataListSource::FromFile(metadataPath);
+
+  EXPECT_FALSE(LoadMetadataListCache(cacheFilePath, source));
+}
+
+TEST_P(MetadataListCacheTest, loadShouldReturnNulloptIfTheCacheIsInvalid) {
+  std::ofstream out(cacheFilePath);
+  out << "not a cache";
+  out.close();
+
+  auto source = MetadataListSource::FromFile(metadataPath);
+
+  EXPECT_FALSE(LoadMetadataListCache(cacheFilePath, source));
+}
+
+TEST_P(MetadataListCacheTest,
+       loadShouldReturnNulloptIfTheCacheWasSavedForADifferentSource) {
+  auto source = MetadataListSource::FromFile(metadataPath);
+  SaveMetadataListCache(cacheFilePath, source, MetadataListContents());
+
+  source.crc += 1;
+
+  EXPECT_FALSE(LoadMetadataListCache(cacheFilePath, source));
+}
+
+TEST_P(MetadataListCacheTest, loadShouldRoundTripSavedContents) {
+  PluginMetadata plugin(blankEsp);
+  plugin.SetEnabled(false);
+  plugin.SetGroup("group");
+  plugin.SetLoadAfterFiles({File(blankEsm, "display", "file(\"Blank.esm\")")});
+  plugin.SetRequirements({File(blankDifferentEsm)});
+  plugin.SetIncompatibilities({File(blankDifferentEsp)});
+  plugin.SetMessages({Message(MessageType::warn,
+                              std::vector<MessageContent>({
+                                  MessageContent("content"),
+                                  MessageContent("inhalt", "de"),
+                              }),
+                              "file(\"Blank.esm\")")});
+  plugin.SetTags({Tag("Relev", false, "file(\"Blank.esm\")")});
+  plugin.SetDirtyInfo({PluginCleaningData(
+      0x12345678, "utility", {MessageContent("info")}, 1, 2, 3)});
+  plugin.SetCleanInfo({PluginCleaningData(0x9ABCDEF0, "utility")});
+  plugin.SetLocations({Location("https://www.example.com", "example")});
+
+  MetadataListContents contents;
+  contents.bashTags = {"Relev", "Delev"};
+  contents.groups = {Group("group", {"default"}, "description"), Group()};
+  contents.messages = {Message(MessageType::say, "A global message.")};
+  contents.plugins = {plugin, PluginMetadata(blankEsm), PluginMetadata(".+")};
+
+  auto source = MetadataListSource::FromFile(metadataPath);
+  SaveMetadataListCache(cacheFilePath, source, contents);
+  auto loaded = LoadMetadataListCache(cacheFilePath, source);
+
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(contents.bashTags, loaded.value().bashTags);
+  EXPECT_EQ(ToMap(contents.groups), ToMap(loaded.value().groups));
+  EXPECT_EQ(ToYaml(contents.messages), ToYaml(loaded.value().messages));
+  EXPECT_EQ(ToYaml(contents.plugins), ToYaml(loaded.value().plugins));
+}
+
+TEST_P(MetadataListCacheTest,
+       lazyLoadShouldOnlyDecodeRegexPluginsAndIndexOthersByNormalizedName) {
+  MetadataListContents contents;
+  contents.plugins = {PluginMetadata("Cached.esp"), PluginMetadata(".+")};
+  contents.plugins.front().SetGroup("group");
+
+  auto source = MetadataListSource::FromFile(metadataPath);
+  SaveMetadataListCache(cacheFilePath, source, contents);
+  auto loaded = LoadMetadataListCache(cacheFilePath, source, true);
+
+  ASSERT_TRUE(loaded);
+  ASSERT_EQ(1, loaded.value().plugins.size());
+  EXPECT_EQ(".+", loaded.value().plugins.front().GetName());
+  ASSERT_EQ(1, loaded.value().undecodedPlugins.size());
+
+  auto it = loaded.value().undecodedPlugins.find(
+      PluginMetadata("Cached.esp").GetNormalizedName());
+  ASSERT_NE(loaded.value().undecodedPlugins.end(), it);
+  EXPECT_EQ(ToYaml(contents.plugins.front()), ToYaml(it->second()));
+}
+
+TEST_P(MetadataListCacheTest,
+       saveShouldReplaceTheCacheFileWithoutAffectingPluginsStillToBeDecoded) {
+  MetadataListContents contents;
+  contents.plugins = {PluginMetadata("Cached.esp")};
+  contents.plugins.front().SetGroup("group");
+
+  auto source = MetadataListSource::FromFile(metadataPath);
+  SaveMetadataListCache(cacheFilePath, source, contents);
+  auto loaded = LoadMetadataListCache(cacheFilePath, source, true);
+  ASSERT_TRUE(loaded);
+
+  MetadataListContents newContents;
+  newContents.plugins = {PluginMetadata("Other.esp")};
+  SaveMetadataListCache(cacheFilePath, source, newContents);
+
+  ASSERT_EQ(1, loaded.value().undecodedPlugins.size());
+  EXPECT_EQ(ToYaml(contents.plugins.front()),
+            ToYaml(loaded.value().undecodedPlugins.begin()->second()));
+
+  // Only the cache file should be left behind.
+  size_t fileCount = 0;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(cacheFilePath.parent_path())) {
+    if (entry.path().filename().u8string().rfind("masterlist.bin", 0) == 0) {
+      ++fileCount;
+    }
+  }
+  EXPECT_EQ(1, fileCount);
+
+  auto newLoaded = LoadMetadataListCache(cacheFilePath, source, true);
+  ASSERT_TRUE(newLoaded);
+  EXPECT_EQ(1,
+            newLoaded.value().undecodedPlugins.count(
+                PluginMetadata("Other.esp").GetNormalizedName()));
+}
+
+TEST_P(MetadataListCacheTest,
+       loadShouldReturnNulloptIfTheCacheDataHasBeenModified) {
+  MetadataListContents contents;
+  contents.plugins = {PluginMetadata("cached.esp")};
+  auto source = MetadataListSource::FromFile(metadataPath);
+  SaveMetadataListCache(cacheFilePath, source, contents);
+
+  std::fstream file(cacheFilePath,
+                    std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(-1, std::ios::end);
+  file.put('X');
+  file.close();
+
+  EXPECT_FALSE(LoadMetadataListCache(cacheFilePath, source));
+}
+
+TEST_P(MetadataListCacheTest,
+       metadataListWithUndecodedPluginsShouldSupportAddingAndErasingPlugins) {
+  MetadataListContents contents;
+  contents.plugins = {PluginMetadata("cached.esp")};
+  contents.plugins.front().SetGroup("group");
+  SaveMetadataListCache(
+      cacheFilePath, MetadataListSource::FromFile(metadataPath), contents);
+
+  MetadataList list;
+  list.Load(metadataPath, cacheFilePath);
+
+  EXPECT_EQ(1, list.Plugins().size());
+  EXPECT_THROW(list.AddPlugin(PluginMetadata("Cached.esp")),
+               std::invalid_argument);
+
+  list.ErasePlugin("Cached.esp");
+
+  EXPECT_FALSE(list.FindPlugin("cached.esp"));
+  EXPECT_TRUE(list.Plugins().empty());
+  EXPECT_NO_THROW(list.AddPlugin(PluginMetadata("cached.esp")));
+}
+
+TEST_P(MetadataListCacheTest,
+       metadataListLoadShouldWriteACacheThatGivesTheSameResultsAsTheFile) {
+  MetadataList uncachedList;
+  uncachedList.Load(metadataPath);
+
+  MetadataList firstCachedList;
+  firstCachedList.Load(metadataPath, cacheFilePath);
+  ASSERT_TRUE(std::filesystem::exists(cacheFilePath));
+
+  MetadataList secondCachedList;
+  secondCachedList.Load(metadataPath, cacheFilePath);
+
+  for (const auto& list : {firstCachedList, secondCachedList}) {
+    EXPECT_EQ(uncachedList.BashTags(), list.BashTags());
+    EXPECT_EQ(ToMap(uncachedList.Groups()), ToMap(list.Groups()));
+    EXPECT_EQ(ToYaml(uncachedList.Messages()), ToYaml(list.Messages()));
+    EXPECT_EQ(ToYaml(uncachedList.Plugins()), ToYaml(list.Plugins()));
+  }
+}
+
+TEST_P(MetadataListCacheTest,
+       metadataListLoadShouldUseTheCacheIfItMatchesTheFile) {
+  MetadataListContents contents;
+  contents.plugins = {PluginMetadata("cached.esp")};
+  contents.plugins.front().SetGroup("group");
+  SaveMetadataListCache(
+      cacheFilePath, MetadataListSource::FromFile(metadataPath), contents);
+
+  MetadataList list;
+  list.Load(metadataPath, cacheFilePath);
+
+  EXPECT_TRUE(list.FindPlugin("cached.esp"));
+  EXPECT_FALSE(list.FindPlugin(blankEsm));
+}
+
+TEST_P(MetadataListCacheTest,
+       metadataListLoadShouldIgnoreAndReplaceTheCacheIfTheFileHasChanged) {
+  MetadataListContents contents;
+  contents.plugins = {PluginMetadata("cached.esp")};
+  contents.plugins.front().SetGroup("group");
+  SaveMetadataListCache(
+      cacheFilePath, MetadataListSource::FromFile(metadataPath), contents);
+
+  std::ofstream out(metadataPath, std::ios::app);
+  out << std::endl << "# A comment." << std::endl;
+  out.close();
+
+  MetadataList list;
+  list.Load(metadataPath, cacheFilePath);
+
+  EXPECT_FALSE(list.FindPlugin("cached.esp"));
+  EXPECT_TRUE(list.FindPlugin(blankEsm));
+
+  auto source = MetadataListSource::FromFile(metadataPath);
+  EXPECT_TRUE(LoadMetadataListCache(cacheFilePath, source));
+}
+}
+}
+
+#endif
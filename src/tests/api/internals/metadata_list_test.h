@@ -169,6 +169,173 @@ TEST_P(MetadataListTest, loadYamlParsingShouldSupportMergeKeys) {
     groups.find(Group("default"))->GetAfterGroups());
 }
 
+TEST_P(MetadataListTest, loadShouldShareEqualMetadataBetweenPlugins) {
+  using std::endl;
+
+  std::ofstream out(metadataPath);
+  out << "plugins:" << endl
+      << "  - name: a.esp" << endl
+      << "    tag: [ Relev ]" << endl
+      << "  - name: b.esp" << endl
+      << "    tag: [ Relev ]" << endl
+      << "  - name: c.esp" << endl
+      << "    tag:" << endl
+      << "      - name: Relev" << endl
+      << "        condition: 'file(\"d.esp\")'" << endl;
+
+  out.close();
+
+  MetadataList metadataList;
+  ASSERT_NO_THROW(metadataList.Load(metadataPath));
+
+  auto plugins = metadataList.FindPlugins({"a.esp", "b.esp", "c.esp"});
+
+  EXPECT_EQ(&plugins[0].value().GetTags(), &plugins[1].value().GetTags());
+  EXPECT_NE(&plugins[0].value().GetTags(), &plugins[2].value().GetTags());
+  EXPECT_EQ("file(\"d.esp\")",
+            plugins[2].value().GetTags().begin()->GetCondition());
+}
+
+TEST_P(MetadataListTest,
+       loadShouldShareEqualStringsBetweenPluginsWithDifferentMetadata) {
+  using std::endl;
+
+  std::ofstream out(metadataPath);
+  out << "plugins:" << endl
+      << "  - name: a.esp" << endl
+      << "    msg:" << endl
+      << "      - type: say" << endl
+      << "        content: 'A shared message.'" << endl
+      << "        condition: 'file(\"d.esp\")'" << endl
+      << "  - name: b.esp" << endl
+      << "    msg:" << endl
+      << "      - type: say" << endl
+      << "        content: 'A shared message.'" << endl
+      << "        condition: 'file(\"d.esp\")'" << endl
+      << "      - type: say" << endl
+      << "        content: 'Another message.'" << endl;
+
+  out.close();
+
+  MetadataList metadataList;
+  ASSERT_NO_THROW(metadataList.Load(metadataPath));
+
+  auto plugins = metadataList.FindPlugins({"a.esp", "b.esp"});
+  auto& aMessages = plugins[0].value().GetMessages();
+  auto& bMessages = plugins[1].value().GetMessages();
+
+  ASSERT_EQ(1, aMessages.size());
+  ASSERT_EQ(2, bMessages.size());
+  EXPECT_EQ(&aMessages[0].GetContent()[0].GetText(),
+            &bMessages[0].GetContent()[0].GetText());
+  EXPECT_EQ(&aMessages[0].GetCondition(), &bMessages[0].GetCondition());
+  EXPECT_EQ("Another message.", bMessages[1].GetContent()[0].GetText());
+}
+
+TEST_P(MetadataListTest, loadShouldResolveAliasesAndMergeKeysInPluginEntries) {
+  using std::endl;
+
+  std::ofstream out(metadataPath);
+  out << "common:" << endl
+      << "  - &message" << endl
+      << "    type: say" << endl
+      << "    content: 'A message.'" << endl
+      << "plugins:" << endl
+      << "  - &base" << endl
+      << "    name: a.esp" << endl
+      << "    msg: [ *message ]" << endl
+      << "    tag: [ Relev ]" << endl
+      << "  - <<: *base" << endl
+      << "    name: b.esp" << endl
+      << "    tag: [ Delev ]" << endl;
+
+  out.close();
+
+  MetadataList metadataList;
+  ASSERT_NO_THROW(metadataList.Load(metadataPath));
+
+  auto plugin = metadataList.FindPlugin("b.esp");
+  ASSERT_TRUE(plugin.has_value());
+  EXPECT_EQ(std::vector<Message>({Message(MessageType::say, "A message.")}),
+            plugin.value().GetMessages());
+  EXPECT_EQ(std::set<Tag>({Tag("Delev")}), plugin.value().GetTags());
+  EXPECT_TRUE(metadataList.FindPlugin("a.esp").has_value());
+}
+
+TEST_P(MetadataListTest,
+       loadYamlParsingShouldGiveEarlierMapsInAMergeKeySequencePrecedence) {
+  using std::endl;
+
+  std::ofstream out(metadataPath);
+  out << "common:" << endl
+      << "  - &first" << endl
+      << "    after: [ first ]" << endl
+      << "  - &second" << endl
+      << "    after: [ second ]" << endl
+      << "    description: second" << endl
+      << "groups:" << endl
+      << "  - name: default" << endl
+      << "    <<: [ *first, *second ]" << endl;
+
+  out.close();
+
+  MetadataList metadataList;
+  ASSERT_NO_THROW(metadataList.Load(metadataPath));
+
+  auto groups = metadataList.Groups();
+  auto group = groups.find(Group("default"));
+  ASSERT_NE(groups.end(), group);
+  EXPECT_EQ(std::unordered_set<std::string>({"first"}),
+            group->GetAfterGroups());
+  EXPECT_EQ("second", group->GetDescription());
+}
+
+TEST_P(MetadataListTest, loadShouldLoadAllEntriesOfALargePluginsList) {
+  using std::endl;
+
+  std::ofstream out(metadataPath);
+  out << "plugins:" << endl;
+  for (size_t i = 0; i < 5000; ++i) {
+    out << "  - name: " << i << ".esp" << endl
+        << "    tag: [ Relev ]" << endl;
+  }
+  out.close();
+
+  MetadataList metadataList;
+  ASSERT_NO_THROW(metadataList.Load(metadataPath));
+
+  EXPECT_EQ(5000, metadataList.Plugins().size());
+  auto plugin = metadataList.FindPlugin("4999.esp");
+  ASSERT_TRUE(plugin.has_value());
+  EXPECT_EQ(std::set<Tag>({Tag("Relev")}), plugin.value().GetTags());
+}
+
+TEST_P(MetadataListTest,
+       loadShouldReportTheFirstDuplicateEntryInALargePluginsList) {
+  using std::endl;
+
+  std::ofstream out(metadataPath);
+  out << "plugins:" << endl;
+  for (size_t i = 0; i < 1000; ++i) {
+    out << "  - name: " << i << ".esp" << endl;
+  }
+  out << "  - name: 10.esp" << endl;
+  for (size_t i = 1000; i < 2000; ++i) {
+    out << "  - name: " << i << ".esp" << endl;
+  }
+  out << "  - name: 5.esp" << endl;
+  out.close();
+
+  MetadataList metadataList;
+  try {
+    metadataList.Load(metadataPath);
+    FAIL();
+  } catch (const FileAccessError& e) {
+    EXPECT_STREQ("More than one entry exists for \"10.esp\"", e.what());
+  }
+  EXPECT_TRUE(metadataList.Plugins().empty());
+}
+
 TEST_P(MetadataListTest, loadShouldThrowIfAnInvalidMetadataFileIsGiven) {
   MetadataList ml;
   for (const auto& path : invalidMetadataPaths) {
@@ -248,6 +415,51 @@ TEST_P(MetadataListTest, saveShouldWriteTheLoadedMetadataToTheGivenFilePath) {
             names);
 }
 
+TEST_P(MetadataListTest,
+       forEachPluginInFilenameOrderShouldVisitEveryPluginInFilenameOrder) {
+  MetadataList metadataList;
+  metadataList.AddPlugin(PluginMetadata("c.esp"));
+  metadataList.AddPlugin(PluginMetadata("B.esp"));
+  metadataList.AddPlugin(PluginMetadata("a.+\\.esp"));
+  metadataList.AddPlugin(PluginMetadata("A.esp"));
+
+  std::vector<std::string> names;
+  metadataList.ForEachPluginInFilenameOrder(
+      [&](const PluginMetadata& plugin) { names.push_back(plugin.GetName()); });
+
+  EXPECT_EQ(std::vector<std::string>({"a.+\\.esp", "A.esp", "B.esp", "c.esp"}),
+            names);
+}
+
+TEST_P(MetadataListTest,
+       findPluginsShouldReturnTheSameResultsAsFindPluginInTheGivenOrder) {
+  MetadataList metadataList;
+  ASSERT_NO_THROW(metadataList.Load(metadataPath));
+
+  // Enough names to be matched in parallel.
+  std::vector<std::string> pluginNames;
+  for (size_t i = 0; i < 50; ++i) {
+    pluginNames.push_back(blankEsp);
+    pluginNames.push_back(blankDifferentEsp);
+    pluginNames.push_back(missingEsp);
+  }
+
+  auto results = metadataList.FindPlugins(pluginNames);
+
+  ASSERT_EQ(pluginNames.size(), results.size());
+  for (size_t i = 0; i < pluginNames.size(); ++i) {
+    auto expected = metadataList.FindPlugin(pluginNames[i]);
+    ASSERT_EQ(expected.has_value(), results[i].has_value());
+    if (expected) {
+      EXPECT_EQ(PluginMetadataToString(expected.value()),
+                PluginMetadataToString(results[i].value()));
+      EXPECT_EQ(expected.value().GetLoadAfterFiles(),
+                results[i].value().GetLoadAfterFiles());
+      EXPECT_EQ(expected.value().GetTags(), results[i].value().GetTags());
+    }
+  }
+}
+
 TEST_P(MetadataListTest, clearShouldClearLoadedData) {
   MetadataList metadataList;
   ASSERT_NO_THROW(metadataList.Load(metadataPath));
@@ -334,6 +546,57 @@ TEST_P(MetadataListTest, addPluginShouldStoreGivenRegexPluginMetadata) {
   EXPECT_EQ("group1", plugin.GetGroup());
 }
 
+TEST_P(MetadataListTest,
+       findPluginShouldMergeAllRegexEntriesThatMatchTheGivenPlugin) {
+  MetadataList metadataList;
+
+  PluginMetadata plugin1(".+Dependent\\.esp");
+  plugin1.SetLoadAfterFiles({File(blankEsm)});
+  PluginMetadata plugin2("blank.+\\.esp");
+  plugin2.SetRequirements({File(blankDifferentEsm)});
+  PluginMetadata plugin3(".+\\.esm");
+  plugin3.SetIncompatibilities({File(blankEsp)});
+  metadataList.AddPlugin(plugin1);
+  metadataList.AddPlugin(plugin2);
+  metadataList.AddPlugin(plugin3);
+
+  auto plugin = metadataList.FindPlugin(blankPluginDependentEsp).value();
+
+  EXPECT_EQ(blankPluginDependentEsp, plugin.GetName());
+  EXPECT_EQ(std::set<File>({File(blankEsm)}), plugin.GetLoadAfterFiles());
+  EXPECT_EQ(std::set<File>({File(blankDifferentEsm)}),
+            plugin.GetRequirements());
+  EXPECT_TRUE(plugin.GetIncompatibilities().empty());
+}
+
+TEST_P(MetadataListTest,
+       findPluginWithARegexNameShouldOnlyFindTheRegexEntryWithThatName) {
+  MetadataList metadataList;
+
+  PluginMetadata plugin1(".+\\.esp");
+  plugin1.SetLoadAfterFiles({File(blankEsm)});
+  PluginMetadata plugin2("blank.+\\.esp");
+  plugin2.SetRequirements({File(blankDifferentEsm)});
+  metadataList.AddPlugin(plugin1);
+  metadataList.AddPlugin(plugin2);
+
+  auto plugin = metadataList.FindPlugin("blank.+\\.esp").value();
+
+  EXPECT_TRUE(plugin.GetLoadAfterFiles().empty());
+  EXPECT_EQ(std::set<File>({File(blankDifferentEsm)}),
+            plugin.GetRequirements());
+}
+
+TEST_P(MetadataListTest,
+       addPluginShouldThrowAndAddNothingIfGivenAnInvalidRegexPlugin) {
+  MetadataList metadataList;
+
+  PluginMetadata plugin("RagnvaldBook(Farengar(+Ragnvald)?)?\\.esp");
+
+  EXPECT_THROW(metadataList.AddPlugin(plugin), std::regex_error);
+  EXPECT_TRUE(metadataList.Plugins().empty());
+}
+
 TEST_P(MetadataListTest, addPluginShouldThrowIfAMatchingPluginAlreadyExists) {
   MetadataList metadataList;
   ASSERT_NO_THROW(metadataList.Load(metadataPath));
@@ -345,6 +608,17 @@ TEST_P(MetadataListTest, addPluginShouldThrowIfAMatchingPluginAlreadyExists) {
                std::invalid_argument);
 }
 
+TEST_P(MetadataListTest, getMemoryUsageShouldIncreaseWhenAPluginIsAdded) {
+  MetadataList metadataList;
+  auto bytes = metadataList.GetMemoryUsage();
+
+  PluginMetadata plugin(blankEsm);
+  plugin.SetGroup("group1");
+  metadataList.AddPlugin(plugin);
+
+  EXPECT_LT(bytes, metadataList.GetMemoryUsage());
+}
+
 TEST_P(MetadataListTest,
        erasePluginShouldRemoveStoredMetadataForTheGivenPlugin) {
   MetadataList metadataList;
@@ -394,6 +668,61 @@ TEST_P(
   EXPECT_EQ(blankEsp, plugin.GetName());
   EXPECT_TRUE(plugin.GetDirtyInfo().empty());
 }
+
+TEST_P(MetadataListTest, getChangesShouldReturnNoChangesForIdenticalLists) {
+  MetadataList from;
+  MetadataList to;
+  ASSERT_NO_THROW(from.Load(metadataPath));
+  ASSERT_NO_THROW(to.Load(metadataPath));
+
+  auto changes = GetChanges(from, to);
+
+  EXPECT_TRUE(changes.plugins.empty());
+  EXPECT_TRUE(changes.groups.empty());
+  EXPECT_TRUE(changes.bash_tags.empty());
+  EXPECT_FALSE(changes.messages_changed);
+}
+
+TEST_P(MetadataListTest,
+       getChangesShouldReturnPluginsThatWereAddedRemovedOrChanged) {
+  MetadataList from;
+  MetadataList to;
+  ASSERT_NO_THROW(from.Load(metadataPath));
+  ASSERT_NO_THROW(to.Load(metadataPath));
+
+  PluginMetadata changedPlugin(blankEsm);
+  changedPlugin.SetMessages({Message(MessageType::say, "A new message.")});
+  to.ErasePlugin(blankEsm);
+  to.AddPlugin(changedPlugin);
+  to.ErasePlugin(blankEsp);
+  to.AddPlugin(PluginMetadata("New.esp"));
+
+  auto changes = GetChanges(from, to);
+
+  EXPECT_EQ(std::vector<std::string>({blankEsm, blankEsp, "New.esp"}),
+            changes.plugins);
+  EXPECT_TRUE(changes.groups.empty());
+  EXPECT_TRUE(changes.bash_tags.empty());
+  EXPECT_FALSE(changes.messages_changed);
+}
+
+TEST_P(MetadataListTest, getChangesShouldReturnGroupsAndMessagesThatChanged) {
+  MetadataList from;
+  MetadataList to;
+  ASSERT_NO_THROW(from.Load(metadataPath));
+  ASSERT_NO_THROW(to.Load(metadataPath));
+
+  auto groups = to.Groups();
+  groups.insert(Group("New group"));
+  to.SetGroups(groups);
+  to.AppendMessage(Message(MessageType::say, "Another global message."));
+
+  auto changes = GetChanges(from, to);
+
+  EXPECT_TRUE(changes.plugins.empty());
+  EXPECT_EQ(std::vector<std::string>({"New group"}), changes.groups);
+  EXPECT_TRUE(changes.messages_changed);
+}
 }
 }
 
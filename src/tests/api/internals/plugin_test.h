@@ -197,6 +197,24 @@ TEST_P(PluginTest, loadingHeaderOnlyShouldReadHeaderData) {
   }
 }
 
+TEST_P(PluginTest,
+       loadingAGhostedFileWithAGivenStateShouldNameThePluginWithoutTheGhostExtension) {
+  auto path = game_.DataPath() / (blankMasterDependentEsm + ".ghost");
+  auto fileSize = std::filesystem::file_size(path);
+  auto modificationTime = std::filesystem::last_write_time(path);
+
+  Plugin plugin(game_.Type(),
+                game_.GetCache(),
+                path,
+                fileSize,
+                modificationTime,
+                true);
+
+  EXPECT_EQ(blankMasterDependentEsm, plugin.GetName());
+  EXPECT_EQ(std::vector<std::string>({blankEsm}), plugin.GetMasters());
+  EXPECT_TRUE(plugin.IsFileUnchanged());
+}
+
 TEST_P(PluginTest, loadingHeaderOnlyShouldNotReadFieldsOrCalculateCrc) {
   Plugin plugin(
       game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, true);
@@ -243,6 +261,155 @@ TEST_P(PluginTest, loadingWholePluginShouldCalculateCrc) {
   EXPECT_EQ(blankEsmCrc, plugin.GetCRC());
 }
 
+TEST_P(PluginTest, loadingWholePluginShouldNotCalculateCrcUntilItIsNeeded) {
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+
+  EXPECT_FALSE(plugin.GetCRCIfCalculated());
+  EXPECT_EQ(blankEsmCrc, plugin.GetCRC());
+  EXPECT_EQ(blankEsmCrc, plugin.GetCRCIfCalculated());
+}
+
+TEST_P(PluginTest, copiesOfAPluginShouldShareItsCalculatedCrc) {
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+  Plugin copy(plugin);
+
+  EXPECT_EQ(blankEsmCrc, plugin.GetCRC());
+  EXPECT_EQ(blankEsmCrc, copy.GetCRCIfCalculated());
+}
+
+TEST_P(PluginTest,
+       getCrcShouldThrowIfTheCrcIsNeededAndThePluginFileNoLongerExists) {
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsp, false);
+
+  std::filesystem::remove(game_.DataPath() / blankEsp);
+
+  EXPECT_THROW(plugin.GetCRC(), FileAccessError);
+}
+
+TEST_P(PluginTest,
+       loadingWholePluginWithACachedCrcShouldNotParseRecordsUntilTheyAreNeeded) {
+  // Calculating the plugin's CRC once caches it.
+  Plugin(game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false)
+      .GetCRC();
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+
+  std::filesystem::remove(game_.DataPath() / blankEsm);
+
+  EXPECT_EQ(blankEsmCrc, plugin.GetCRC());
+  EXPECT_TRUE(plugin.IsMaster());
+  EXPECT_THROW(plugin.LoadRecords(), FileAccessError);
+  EXPECT_THROW(plugin.NumOverrideFormIDs(), FileAccessError);
+}
+
+TEST_P(PluginTest,
+       loadingWholePluginWithoutACachedCrcShouldParseRecordsWhileLoading) {
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+
+  std::filesystem::remove(game_.DataPath() / blankEsm);
+
+  EXPECT_NO_THROW(plugin.LoadRecords());
+  EXPECT_EQ(0, plugin.NumOverrideFormIDs());
+}
+
+TEST_P(PluginTest, loadRecordsShouldDoNothingForAHeaderOnlyPlugin) {
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, true);
+
+  std::filesystem::remove(game_.DataPath() / blankEsm);
+
+  EXPECT_NO_THROW(plugin.LoadRecords());
+  EXPECT_EQ(0, plugin.NumOverrideFormIDs());
+}
+
+TEST_P(PluginTest, prefetchingRecordsShouldNotParseThem) {
+  Plugin plugin(game_.Type(),
+                game_.GetCache(),
+                game_.DataPath() / blankMasterDependentEsm,
+                false);
+
+  EXPECT_NO_THROW(plugin.PrefetchRecords());
+
+  // The records are still parsed the first time they're needed, so removing
+  // the file before then stops them from being read.
+  std::filesystem::remove(game_.DataPath() /
+                          (blankMasterDependentEsm + ".ghost"));
+
+  EXPECT_THROW(plugin.LoadRecords(), FileAccessError);
+  EXPECT_NO_THROW(plugin.PrefetchRecords());
+}
+
+TEST_P(PluginTest, prefetchingRecordsShouldDoNothingForAHeaderOnlyPlugin) {
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, true);
+
+  EXPECT_NO_THROW(plugin.PrefetchRecords());
+}
+
+TEST_P(PluginTest, releasingRecordsShouldKeepTheValuesReadFromThem) {
+  Plugin plugin(game_.Type(),
+                game_.GetCache(),
+                game_.DataPath() / blankMasterDependentEsm,
+                false);
+
+  plugin.LoadRecords();
+  plugin.ReleaseRecords();
+  std::filesystem::remove(game_.DataPath() /
+                          (blankMasterDependentEsm + ".ghost"));
+
+  EXPECT_NO_THROW(plugin.LoadRecords());
+  EXPECT_FALSE(plugin.IsEmpty());
+  if (GetParam() == GameType::tes3) {
+    EXPECT_EQ(0, plugin.NumOverrideFormIDs());
+  } else {
+    EXPECT_EQ(4, plugin.NumOverrideFormIDs());
+  }
+}
+
+TEST_P(PluginTest, releaseRecordsShouldDoNothingForAHeaderOnlyPlugin) {
+  Plugin plugin(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, true);
+
+  EXPECT_NO_THROW(plugin.ReleaseRecords());
+  EXPECT_NO_THROW(plugin.LoadRecords());
+}
+
+TEST_P(PluginTest, copiesOfAPluginShouldShareItsParsedRecords) {
+  Plugin plugin(game_.Type(),
+                game_.GetCache(),
+                game_.DataPath() / blankMasterDependentEsm,
+                false);
+  Plugin copy = plugin;
+
+  plugin.LoadRecords();
+  std::filesystem::remove(game_.DataPath() /
+                          (blankMasterDependentEsm + ".ghost"));
+
+  if (GetParam() == GameType::tes3) {
+    EXPECT_EQ(0, copy.NumOverrideFormIDs());
+  } else {
+    EXPECT_EQ(4, copy.NumOverrideFormIDs());
+  }
+}
+
+TEST_P(PluginTest, headerDataShouldNotBeReadFromTheFileAfterLoading) {
+  Plugin plugin(game_.Type(),
+                game_.GetCache(),
+                game_.DataPath() / blankMasterDependentEsp,
+                true);
+
+  std::filesystem::remove(game_.DataPath() / blankMasterDependentEsp);
+
+  EXPECT_FALSE(plugin.IsMaster());
+  EXPECT_FALSE(plugin.IsLightMaster());
+  EXPECT_EQ(std::vector<std::string>({blankEsm}), plugin.GetMasters());
+  EXPECT_EQ(plugin.GetMasters(), plugin.GetMastersRef());
+}
+
 TEST_P(PluginTest, loadingANonMasterPluginShouldReadTheMasterFlagAsFalse) {
   Plugin plugin(game_.Type(),
                 game_.GetCache(),
@@ -359,7 +526,6 @@ TEST_P(
     EXPECT_TRUE(loadsArchive);
 }
 
-#ifdef _WIN32
 TEST_P(
     PluginTest,
     loadsArchiveForAnArchiveWithAFilenameWhichStartsWithTheNonAsciiEspFileBasenameShouldReturnTrueForAllGamesExceptMorrowindAndSkyrim) {
@@ -375,7 +541,6 @@ TEST_P(
   else
     EXPECT_TRUE(loadsArchive);
 }
-#endif
 
 TEST_P(PluginTest,
        loadsArchiveShouldReturnFalseForAPluginThatDoesNotLoadAnArchive) {
@@ -500,6 +665,80 @@ TEST_P(PluginTest,
   EXPECT_TRUE(plugin2.DoFormIDsOverlap(plugin1));
 }
 
+TEST_P(PluginTest, doFormIDsOverlapShouldParseReleasedRecordsAgain) {
+  Plugin plugin1(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+  Plugin plugin2(game_.Type(),
+                 game_.GetCache(),
+                 game_.DataPath() / blankMasterDependentEsm,
+                 false);
+
+  plugin1.LoadRecords();
+  plugin2.LoadRecords();
+  plugin1.ReleaseRecords();
+  plugin2.ReleaseRecords();
+
+  EXPECT_TRUE(plugin1.DoFormIDsOverlap(plugin2));
+  EXPECT_TRUE(plugin2.DoFormIDsOverlap(plugin1));
+}
+
+TEST_P(PluginTest,
+       doFormIDsOverlapShouldThrowIfReleasedRecordsCannotBeParsedAgain) {
+  Plugin plugin1(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+  Plugin plugin2(game_.Type(),
+                 game_.GetCache(),
+                 game_.DataPath() / blankMasterDependentEsm,
+                 false);
+
+  plugin1.LoadRecords();
+  plugin1.ReleaseRecords();
+  std::filesystem::remove(game_.DataPath() / blankEsm);
+
+  EXPECT_THROW(plugin1.DoFormIDsOverlap(plugin2), FileAccessError);
+}
+
+TEST_P(PluginTest,
+       mayFormIDsOverlapShouldReturnFalseIfEitherPluginIsHeaderOnly) {
+  Plugin plugin1(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, true);
+  Plugin plugin2(game_.Type(),
+                 game_.GetCache(),
+                 game_.DataPath() / blankMasterDependentEsm,
+                 false);
+
+  EXPECT_FALSE(plugin1.MayFormIDsOverlap(plugin2));
+  EXPECT_FALSE(plugin2.MayFormIDsOverlap(plugin1));
+}
+
+TEST_P(PluginTest,
+       mayFormIDsOverlapShouldReturnTrueIfOnePluginIsAMasterOfTheOther) {
+  Plugin plugin1(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+  Plugin plugin2(game_.Type(),
+                 game_.GetCache(),
+                 game_.DataPath() / blankMasterDependentEsm,
+                 false);
+
+  EXPECT_TRUE(plugin1.MayFormIDsOverlap(plugin2));
+  EXPECT_TRUE(plugin2.MayFormIDsOverlap(plugin1));
+}
+
+TEST_P(PluginTest,
+       mayFormIDsOverlapShouldReturnFalseForPluginsWithNoOriginsInCommonUnlessTheGameIsMorrowind) {
+  Plugin plugin1(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsm, false);
+  Plugin plugin2(
+      game_.Type(), game_.GetCache(), game_.DataPath() / blankEsp, false);
+
+  if (GetParam() == GameType::tes3) {
+    EXPECT_TRUE(plugin1.MayFormIDsOverlap(plugin2));
+  } else {
+    EXPECT_FALSE(plugin1.MayFormIDsOverlap(plugin2));
+    EXPECT_FALSE(plugin2.MayFormIDsOverlap(plugin1));
+  }
+}
+
 TEST_P(PluginTest,
        hasPluginFileExtensionShouldBeTrueIfFileEndsInDotEspOrDotEsm) {
   EXPECT_TRUE(hasPluginFileExtension("file.esp", GetParam()));
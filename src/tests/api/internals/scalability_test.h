@@ -0,0 +1,397 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012-2016    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_SCALABILITY_TEST
+#define LOOT_TESTS_API_INTERNALS_SCALABILITY_TEST
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/game/game.h"
+#include "api/helpers/thread_pool.h"
+#include "api/metadata/condition_evaluator.h"
+#include "api/metadata_list.h"
+#include "api/sorting/plugin_sorter.h"
+#include "benchmarks/synthetic_game.h"
+#include "tests/api/internals/allocation_counter.h"
+
+namespace loot {
+namespace test {
+// The largest growth exponents that the measured operations may have.
+// Allocation and path query counts don't vary between runs, so their bounds
+// are close to the expected exponents, but timings vary with the machine's
+// load and caches, so their bounds leave more room. An operation that should
+// be near-linear but has become quadratic has an exponent of about 2.
+//
+// Timings are too slow to measure and too noisy to check in the default test
+// run, so they're only checked by the DISABLED_Times tests, which can be run
+// using --gtest_also_run_disabled_tests.
+constexpr double MAX_LINEAR_COUNT_EXPONENT = 1.2;
+constexpr double MAX_LINEAR_TIME_EXPONENT = 1.5;
+// Several sorting phases consider every pair of plugins, so their bounds only
+// catch them becoming worse than quadratic.
+constexpr double MAX_QUADRATIC_COUNT_EXPONENT = 2.2;
+constexpr double MAX_QUADRATIC_TIME_EXPONENT = 2.5;
+
+// The plugin counts that operations are measured at. Counts are exact at any
+// size, so they're measured at smaller sizes than timings, which need enough
+// work to stand out from noise. Sorting is measured at smaller counts because
+// of its quadratic phases.
+const std::vector<size_t> SCALABILITY_PLUGIN_COUNTS({500, 1000, 2000});
+const std::vector<size_t> SORT_SCALABILITY_PLUGIN_COUNTS({250, 500, 1000});
+const std::vector<size_t> TIMED_SCALABILITY_PLUGIN_COUNTS({1000, 4000, 16000});
+const std::vector<size_t> TIMED_SORT_SCALABILITY_PLUGIN_COUNTS(
+    {1000, 2000, 4000});
+
+// Each timing takes the fastest of this many runs, to reduce the effect of
+// anything else running at the same time.
+constexpr size_t SCALABILITY_REPETITIONS = 3;
+
+// What a scalability test checks the growth of.
+enum struct ScalabilityMeasure { counts, times };
+
+// Fits value = a * size^k to the given values by least squares on their
+// logarithms, and returns k. Values less than one are treated as one.
+inline double GetGrowthExponent(const std::vector<size_t>& sizes,
+                                const std::vector<double>& values) {
+  double sumX = 0;
+  double sumY = 0;
+  double sumXX = 0;
+  double sumXY = 0;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    const double x = std::log(static_cast<double>(sizes[i]));
+    const double y = std::log(std::max(values[i], 1.0));
+    sumX += x;
+    sumY += y;
+    sumXX += x * x;
+    sumXY += x * y;
+  }
+
+  const double n = static_cast<double>(sizes.size());
+  return (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+}
+
+TEST(GetGrowthExponent, shouldBeThePowerThatRelatesTheValuesToTheSizes) {
+  const std::vector<size_t> sizes({10, 100, 1000});
+
+  EXPECT_NEAR(0.0, GetGrowthExponent(sizes, {5, 5, 5}), 1e-9);
+  EXPECT_NEAR(1.0, GetGrowthExponent(sizes, {30, 300, 3000}), 1e-9);
+  EXPECT_NEAR(2.0, GetGrowthExponent(sizes, {1e2, 1e4, 1e6}), 1e-9);
+}
+
+// Runs parallel work on the thread that starts it, so that all of an
+// operation's allocations are counted and its timings aren't affected by how
+// many workers happen to be free.
+class CallingThreadExecutor : public Executor {
+public:
+  size_t GetConcurrency() const override { return 1; }
+
+  void Submit(std::function<void()> task) override { task(); }
+};
+
+class ScalabilityTest : public ::testing::TestWithParam<ScalabilityMeasure> {
+protected:
+  struct Measurement {
+    double allocations = 0;
+    double seconds = 0;
+  };
+
+  ScalabilityTest() :
+      threadPoolScope_(std::make_shared<ThreadPool>(
+          std::make_shared<CallingThreadExecutor>())) {}
+
+  bool IsTimed() const { return GetParam() == ScalabilityMeasure::times; }
+
+  const std::vector<size_t>& GetPluginCounts() const {
+    return IsTimed() ? TIMED_SCALABILITY_PLUGIN_COUNTS
+                     : SCALABILITY_PLUGIN_COUNTS;
+  }
+
+  const std::vector<size_t>& GetSortPluginCounts() const {
+    return IsTimed() ? TIMED_SORT_SCALABILITY_PLUGIN_COUNTS
+                     : SORT_SCALABILITY_PLUGIN_COUNTS;
+  }
+
+  // Creates the state that an operation needs using setup, then measures the
+  // operation. Timed measurements take the fastest of several runs that each
+  // have new state.
+  template<typename Setup, typename Operation>
+  Measurement Measure(const Setup& setup, const Operation& operation) const {
+    const size_t repetitions = IsTimed() ? SCALABILITY_REPETITIONS : 1;
+    Measurement fastest;
+    for (size_t i = 0; i < repetitions; ++i) {
+      auto state = setup();
+
+      AllocationCounter counter;
+      auto start = std::chrono::steady_clock::now();
+      operation(*state);
+      std::chrono::duration<double> duration =
+          std::chrono::steady_clock::now() - start;
+
+      if (i == 0 || duration.count() < fastest.seconds) {
+        fastest.seconds = duration.count();
+      }
+      fastest.allocations = static_cast<double>(counter.GetCount());
+    }
+
+    return fastest;
+  }
+
+  static std::unique_ptr<Game> CreateGame(
+      const benchmarks::SyntheticGame& syntheticGame) {
+    auto game = std::make_unique<Game>(benchmarks::SyntheticGame::gameType,
+                                       syntheticGame.GamePath(),
+                                       syntheticGame.LocalPath());
+    game->LoadCurrentLoadOrderState();
+    return game;
+  }
+
+  static std::unique_ptr<Game> CreateLoadedGame(
+      const benchmarks::SyntheticGame& syntheticGame) {
+    auto game = CreateGame(syntheticGame);
+    game->LoadPlugins(syntheticGame.Plugins(), false);
+    game->GetDatabase()->LoadLists(syntheticGame.MasterlistPath());
+    return game;
+  }
+
+  // Measures the operation at each plugin count, and checks that the growth
+  // of its allocations or time is near-linear.
+  template<typename Setup, typename Operation>
+  void ExpectNearLinear(const std::string& name,
+                        const Setup& setup,
+                        const Operation& operation) const {
+    std::vector<double> allocations;
+    std::vector<double> seconds;
+    for (const auto plugins : GetPluginCounts()) {
+      const auto& syntheticGame = benchmarks::GetSyntheticGame(plugins);
+      auto measurement = Measure([&]() { return setup(syntheticGame); },
+                                 [&](auto& state) {
+                                   operation(syntheticGame, state);
+                                 });
+      allocations.push_back(measurement.allocations);
+      seconds.push_back(measurement.seconds);
+    }
+
+    if (IsTimed()) {
+      ExpectExponentAtMost(name + " time",
+                           GetPluginCounts(),
+                           seconds,
+                           MAX_LINEAR_TIME_EXPONENT);
+    } else {
+      ExpectExponentAtMost(name + " allocations",
+                           GetPluginCounts(),
+                           allocations,
+                           MAX_LINEAR_COUNT_EXPONENT);
+    }
+  }
+
+  static void ExpectExponentAtMost(const std::string& name,
+                                   const std::vector<size_t>& sizes,
+                                   const std::vector<double>& values,
+                                   double maxExponent) {
+    const auto exponent = GetGrowthExponent(sizes, values);
+
+    std::string description;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      description += " " + std::to_string(sizes[i]) + ": " +
+                     std::to_string(values[i]) + ";";
+    }
+
+    ::testing::Test::RecordProperty(name, std::to_string(exponent));
+    EXPECT_LE(exponent, maxExponent) << name << " grew as" << description;
+  }
+
+private:
+  ThreadPoolScope threadPoolScope_;
+};
+
+INSTANTIATE_TEST_CASE_P(Counts,
+                        ScalabilityTest,
+                        ::testing::Values(ScalabilityMeasure::counts));
+INSTANTIATE_TEST_CASE_P(DISABLED_Times,
+                        ScalabilityTest,
+                        ::testing::Values(ScalabilityMeasure::times));
+
+TEST_P(ScalabilityTest, loadingAMetadataListShouldScaleNearLinearly) {
+  ExpectNearLinear(
+      "MetadataList::Load",
+      [](const benchmarks::SyntheticGame&) {
+        return std::make_unique<MetadataList>();
+      },
+      [](const benchmarks::SyntheticGame& game, MetadataList& metadataList) {
+        metadataList.Load(game.MasterlistPath());
+      });
+}
+
+TEST_P(ScalabilityTest, findingEachPluginsMetadataShouldScaleNearLinearly) {
+  ExpectNearLinear(
+      "MetadataList::FindPlugin",
+      [](const benchmarks::SyntheticGame& game) {
+        auto metadataList = std::make_unique<MetadataList>();
+        metadataList->Load(game.MasterlistPath());
+        return metadataList;
+      },
+      [](const benchmarks::SyntheticGame& game, MetadataList& metadataList) {
+        for (const auto& plugin : game.Plugins()) {
+          metadataList.FindPlugin(plugin);
+        }
+      });
+}
+
+TEST_P(ScalabilityTest, evaluatingAllPluginsMetadataShouldScaleNearLinearly) {
+  struct State {
+    std::vector<PluginMetadata> pluginsMetadata;
+    std::unique_ptr<ConditionEvaluator> evaluator;
+  };
+
+  ExpectNearLinear(
+      "ConditionEvaluator::EvaluateAll",
+      [](const benchmarks::SyntheticGame& game) {
+        MetadataList metadataList;
+        metadataList.Load(game.MasterlistPath());
+
+        auto state = std::make_unique<State>();
+        for (const auto& metadata : metadataList.FindPlugins(game.Plugins())) {
+          if (metadata.has_value()) {
+            state->pluginsMetadata.push_back(metadata.value());
+          }
+        }
+        state->evaluator = std::make_unique<ConditionEvaluator>(
+            benchmarks::SyntheticGame::gameType, game.DataPath());
+        return state;
+      },
+      [](const benchmarks::SyntheticGame&, State& state) {
+        state.evaluator->EvaluateAll(state.pluginsMetadata);
+      });
+}
+
+TEST_P(ScalabilityTest,
+       gettingAllPluginsEvaluatedMetadataShouldScaleNearLinearly) {
+  ExpectNearLinear(
+      "DatabaseInterface::GetPluginMetadataBatch",
+      [](const benchmarks::SyntheticGame& game) {
+        auto handle = CreateGame(game);
+        handle->GetDatabase()->LoadLists(game.MasterlistPath());
+        return handle;
+      },
+      [](const benchmarks::SyntheticGame& game, Game& handle) {
+        handle.GetDatabase()->GetPluginMetadataBatch(
+            game.Plugins(), true, true);
+      });
+}
+
+TEST_P(ScalabilityTest, loadingPluginsShouldScaleNearLinearly) {
+  ExpectNearLinear(
+      "Game::LoadPlugins",
+      [](const benchmarks::SyntheticGame& game) { return CreateGame(game); },
+      [](const benchmarks::SyntheticGame& game, Game& handle) {
+        handle.LoadPlugins(game.Plugins(), false);
+      });
+}
+
+TEST_P(ScalabilityTest, sortingPhasesShouldScaleNoWorseThanExpected) {
+  // The statistics of the fastest sort at each plugin count.
+  const auto& pluginCounts = GetSortPluginCounts();
+  std::vector<SortStatistics> statistics;
+  std::vector<double> seconds;
+  for (const auto plugins : pluginCounts) {
+    const auto& syntheticGame = benchmarks::GetSyntheticGame(plugins);
+    auto game = CreateLoadedGame(syntheticGame);
+
+    const auto getDuration = [](const SortStatistics& sortStatistics) {
+      std::chrono::microseconds duration(0);
+      for (const auto& phase : sortStatistics.phases) {
+        duration += phase.duration;
+      }
+      return duration;
+    };
+
+    SortStatistics fastestStatistics;
+    auto measurement = Measure(
+        // Use a new sorter each time so that no overlap results are reused.
+        []() { return std::make_unique<PluginSorter>(); },
+        [&](PluginSorter& sorter) {
+          sorter.Sort(*game);
+          if (fastestStatistics.phases.empty() ||
+              getDuration(sorter.GetStatistics()) <
+                  getDuration(fastestStatistics)) {
+            fastestStatistics = sorter.GetStatistics();
+          }
+        });
+
+    ASSERT_FALSE(fastestStatistics.phases.empty());
+    statistics.push_back(fastestStatistics);
+    seconds.push_back(measurement.seconds);
+  }
+
+  if (IsTimed()) {
+    ExpectExponentAtMost("PluginSorter::Sort time",
+                         pluginCounts,
+                         seconds,
+                         MAX_QUADRATIC_TIME_EXPONENT);
+  }
+
+  const auto& phases = statistics.front().phases;
+  for (size_t i = 0; i < phases.size(); ++i) {
+    std::vector<double> checks;
+    std::vector<double> phaseSeconds;
+    for (const auto& sortStatistics : statistics) {
+      const auto& phase = sortStatistics.phases.at(i);
+      ASSERT_EQ(phases[i].name, phase.name);
+      checks.push_back(
+          static_cast<double>(phase.cycleChecks + phase.pathQueries));
+      phaseSeconds.push_back(
+          std::chrono::duration<double>(phase.duration).count());
+    }
+
+    // Phases that don't check for paths aren't measured by their checks.
+    if (!IsTimed() &&
+        std::find(checks.begin(), checks.end(), 0.0) == checks.end()) {
+      ExpectExponentAtMost(phases[i].name + " path checks",
+                           pluginCounts,
+                           checks,
+                           MAX_QUADRATIC_COUNT_EXPONENT);
+    }
+
+    // Adding the vertices reads each plugin's load order position and
+    // metadata once, so it should be near-linear. The other phases are too
+    // short at these plugin counts for their timings to be reliable.
+    if (IsTimed() && phases[i].name == "AddPluginVertices") {
+      ExpectExponentAtMost(phases[i].name + " time",
+                           pluginCounts,
+                           phaseSeconds,
+                           MAX_LINEAR_TIME_EXPONENT);
+    }
+  }
+}
+}
+}
+
+#endif
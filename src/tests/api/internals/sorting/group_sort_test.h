@@ -106,6 +106,101 @@ TEST(GetTransitiveAfterGroups, shouldThrowIfAfterGroupsAreCyclic) {
   }
 }
 
+TEST(GetTransitiveAfterGroups, shouldReportACycleForEachSetOfCyclicGroups) {
+  std::unordered_set<Group> groups(
+      {Group("a", std::unordered_set<std::string>({"b"})),
+       Group("b", std::unordered_set<std::string>({"a"})),
+       Group("c", std::unordered_set<std::string>({"a"})),
+       Group("d", std::unordered_set<std::string>({"e"})),
+       Group("e", std::unordered_set<std::string>({"d"}))});
+
+  try {
+    GetTransitiveAfterGroups(groups, {});
+    FAIL();
+  } catch (CyclicInteractionError &e) {
+    auto cycles = e.GetCycles();
+    ASSERT_EQ(2, cycles.size());
+    EXPECT_EQ(e.GetCycle().size(), cycles[0].size());
+
+    std::set<std::string> cycleNames;
+    for (const auto &cycle : cycles) {
+      ASSERT_EQ(2, cycle.size());
+      std::string names;
+      for (const auto &vertex : cycle) {
+        names += vertex.GetName();
+        EXPECT_EQ(EdgeType::masterlistLoadAfter,
+                  vertex.GetTypeOfEdgeToNextVertex());
+      }
+      std::sort(names.begin(), names.end());
+      cycleNames.insert(names);
+    }
+
+    EXPECT_EQ(std::set<std::string>({"ab", "de"}), cycleNames);
+  }
+}
+
+TEST(GroupClosure, getGroupsInPathsShouldReturnAllGroupsBetweenTheTwoGroups) {
+  std::unordered_set<Group> groups({Group("a"),
+                                    Group("b", {"a"}),
+                                    Group("c", {"a"}),
+                                    Group("d", {"b", "c"}),
+                                    Group("e", {"d"}),
+                                    Group("f", {"a"})});
+  std::unordered_set<Group> userGroups({Group("g", {"e"})});
+
+  GroupClosure closure(groups, userGroups);
+
+  EXPECT_EQ(std::unordered_set<std::string>({"b", "c", "d", "e"}),
+            closure.GetGroupsInPaths("a", "g"));
+  EXPECT_EQ(std::unordered_set<std::string>({"d"}),
+            closure.GetGroupsInPaths("b", "e"));
+}
+
+TEST(GroupClosure,
+     getGroupsInPathsShouldReturnAnEmptySetIfThereIsNoPathBetweenTheGroups) {
+  std::unordered_set<Group> groups(
+      {Group("a"), Group("b", {"a"}), Group("c", {"a"})});
+
+  GroupClosure closure(groups, {});
+
+  EXPECT_TRUE(closure.GetGroupsInPaths("b", "c").empty());
+  EXPECT_TRUE(closure.GetGroupsInPaths("c", "a").empty());
+  EXPECT_TRUE(closure.GetGroupsInPaths("a", "a").empty());
+  EXPECT_TRUE(closure.GetGroupsInPaths("a", "d").empty());
+}
+
+TEST(GroupClosure, isBuiltFromShouldCompareAfterGroupsAsWellAsGroupNames) {
+  std::unordered_set<Group> groups({Group("a"), Group("b", {"a"})});
+  std::unordered_set<Group> userGroups({Group("c", {"b"})});
+
+  GroupClosure closure(groups, userGroups);
+
+  EXPECT_TRUE(closure.IsBuiltFrom(groups, userGroups));
+  EXPECT_FALSE(closure.IsBuiltFrom(groups, {}));
+  EXPECT_FALSE(closure.IsBuiltFrom(groups, {Group("c", {"a"})}));
+  EXPECT_FALSE(closure.IsBuiltFrom({Group("a"), Group("b")}, userGroups));
+}
+
+TEST(GroupClosure, getAfterGroupsShouldGiveTheIndicesOfTransitiveAfterGroups) {
+  std::unordered_set<Group> groups({Group("a"), Group("b", {"a"})});
+  std::unordered_set<Group> userGroups({Group("c", {"b"})});
+
+  GroupClosure closure(groups, userGroups);
+
+  ASSERT_EQ(3, closure.NumGroups());
+  auto a = closure.GetIndex("a").value();
+  auto b = closure.GetIndex("b").value();
+  auto c = closure.GetIndex("c").value();
+  EXPECT_FALSE(closure.GetIndex("d").has_value());
+
+  EXPECT_TRUE(closure.GetAfterGroups(a).none());
+  EXPECT_EQ(1, closure.GetAfterGroups(b).count());
+  EXPECT_TRUE(closure.GetAfterGroups(b).test(a));
+  EXPECT_EQ(2, closure.GetAfterGroups(c).count());
+  EXPECT_TRUE(closure.GetAfterGroups(c).test(a));
+  EXPECT_TRUE(closure.GetAfterGroups(c).test(b));
+}
+
 TEST(GetGroupsPath, shouldThrowIfTheFromGroupDoesNotExist) {
   std::unordered_set<Group> groups({Group("a", {"c"}), Group("b", {"a"})});
   std::unordered_set<Group> userGroups({Group("c", {"b"})});
@@ -179,7 +274,51 @@ TEST(GetGroupsPath,
   EXPECT_EQ("e", path[3].GetName());
   EXPECT_FALSE(path[3].GetTypeOfEdgeToNextVertex().has_value());
 }
+
+TEST(GroupPaths, getPathShouldGiveTheSameResultsWhenCalledRepeatedly) {
+  std::unordered_set<Group> groups({Group("a", {}),
+                                    Group("b", {"a"}),
+                                    Group("c", {"a"}),
+                                    Group("e", {"b", "d"})});
+  std::unordered_set<Group> userGroups({Group("d", {"c"})});
+
+  GroupPaths paths(groups, userGroups);
+
+  for (int i = 0; i < 2; ++i) {
+    auto path = paths.GetPath("a", "e");
+
+    ASSERT_EQ(4, path.size());
+    EXPECT_EQ("a", path[0].GetName());
+    EXPECT_EQ("c", path[1].GetName());
+    EXPECT_EQ("d", path[2].GetName());
+    EXPECT_EQ("e", path[3].GetName());
+
+    EXPECT_TRUE(paths.GetPath("b", "d").empty());
+  }
+
+  auto path = paths.GetPath("c", "d");
+  ASSERT_EQ(2, path.size());
+  EXPECT_EQ("c", path[0].GetName());
+  EXPECT_EQ(EdgeType::userLoadAfter,
+            path[0].GetTypeOfEdgeToNextVertex().value());
+  EXPECT_EQ("d", path[1].GetName());
+}
+
+TEST(GroupPaths, getPathShouldFindAPathInAGraphWithACycle) {
+  std::unordered_set<Group> groups(
+      {Group("a", {"c"}), Group("b", {"a"}), Group("c", {"b"})});
+
+  GroupPaths paths(groups, {});
+  auto path = paths.GetPath("a", "b");
+
+  ASSERT_EQ(2, path.size());
+  EXPECT_EQ("a", path[0].GetName());
+  EXPECT_EQ(EdgeType::masterlistLoadAfter,
+            path[0].GetTypeOfEdgeToNextVertex().value());
+  EXPECT_EQ("b", path[1].GetName());
+}
 }
 }
 
 #endif
+
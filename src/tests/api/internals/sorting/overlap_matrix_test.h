@@ -0,0 +1,106 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_SORTING_OVERLAP_MATRIX_TEST
+#define LOOT_TESTS_API_INTERNALS_SORTING_OVERLAP_MATRIX_TEST
+
+#include "api/sorting/overlap_matrix.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+#include "api/helpers/thread_pool.h"
+
+namespace loot {
+namespace test {
+TEST(OverlapMatrix, shouldBeEmptyWhenConstructed) {
+  OverlapMatrix matrix(3);
+
+  EXPECT_EQ(3, matrix.Size());
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      EXPECT_FALSE(matrix.Get(i, j));
+    }
+  }
+}
+
+TEST(OverlapMatrix, setShouldBeSymmetric) {
+  OverlapMatrix matrix(100);
+
+  matrix.Set(70, 2);
+
+  EXPECT_TRUE(matrix.Get(2, 70));
+  EXPECT_TRUE(matrix.Get(70, 2));
+  EXPECT_FALSE(matrix.Get(2, 71));
+  EXPECT_FALSE(matrix.Get(6, 70));
+}
+
+TEST(OverlapMatrix, computeShouldCallTheFunctionOnceForEachPair) {
+  const size_t size = 150;
+  std::vector<std::atomic<int>> calls(size * size);
+
+  ThreadPoolScope scope(std::make_shared<ThreadPool>(4));
+  auto matrix = OverlapMatrix::Compute(size, [&](size_t i, size_t j) {
+    calls[i * size + j] += 1;
+    return (i + j) % 3 == 0;
+  });
+
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = 0; j < size; ++j) {
+      EXPECT_EQ(i < j ? 1 : 0, calls[i * size + j].load());
+      if (i != j) {
+        EXPECT_EQ((i + j) % 3 == 0, matrix.Get(i, j));
+      }
+    }
+  }
+}
+
+TEST(OverlapMatrix, computeShouldRethrowAnExceptionThrownByTheFunction) {
+  EXPECT_THROW(OverlapMatrix::Compute(10,
+                                      [](size_t i, size_t j) -> bool {
+                                        if (i == 3 && j == 7) {
+                                          throw std::runtime_error("error");
+                                        }
+                                        return false;
+                                      }),
+               std::runtime_error);
+}
+
+TEST(OverlapMatrix, computeShouldNotCallTheFunctionForFewerThanTwoPlugins) {
+  bool isCalled = false;
+  auto matrix = OverlapMatrix::Compute(1, [&](size_t, size_t) {
+    isCalled = true;
+    return true;
+  });
+
+  EXPECT_FALSE(isCalled);
+  EXPECT_EQ(1, matrix.Size());
+}
+}
+}
+
+#endif
@@ -134,6 +134,8 @@ TEST_P(PluginSorterTest, sortingWithNoLoadedPluginsShouldReturnAnEmptyList) {
   std::vector<std::string> sorted = sorter.Sort(game_);
 
   EXPECT_TRUE(sorted.empty());
+  ASSERT_EQ(1, sorter.GetStatistics().phases.size());
+  EXPECT_EQ("AddPluginVertices", sorter.GetStatistics().phases[0].name);
 }
 
 TEST_P(PluginSorterTest,
@@ -149,14 +151,14 @@ TEST_P(PluginSorterTest,
       *dynamic_cast<const Plugin *>(game_.GetPlugin(blankEsp).get()),
       PluginMetadata(),
       PluginMetadata(),
-      getLoadOrder());
+      std::nullopt);
   EXPECT_FALSE(esp.IsMaster());
 
   auto master = PluginSortingData(
       *dynamic_cast<const Plugin *>(game_.GetPlugin(blankEsm).get()),
       PluginMetadata(),
       PluginMetadata(),
-      getLoadOrder());
+      std::nullopt);
   EXPECT_TRUE(master.IsMaster());
 
   if (GetParam() == GameType::fo4 || GetParam() == GameType::tes5se) {
@@ -164,14 +166,14 @@ TEST_P(PluginSorterTest,
         *dynamic_cast<const Plugin *>(game_.GetPlugin(blankEsl).get()),
         PluginMetadata(),
         PluginMetadata(),
-        getLoadOrder());
+        std::nullopt);
     EXPECT_TRUE(lightMaster.IsMaster());
 
     auto lightMasterEsp = PluginSortingData(
         *dynamic_cast<const Plugin *>(game_.GetPlugin(blankEslEsp).get()),
         PluginMetadata(),
         PluginMetadata(),
-        getLoadOrder());
+        std::nullopt);
     EXPECT_FALSE(lightMasterEsp.IsMaster());
   }
 }
@@ -190,6 +192,276 @@ TEST_P(PluginSorterTest,
   }
 }
 
+TEST_P(
+    PluginSorterTest,
+    sortingWithLexicographicTieBreaksShouldNotMakeUnnecessaryChangesToAnExistingLoadOrder) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.SetTieBreakMode(TieBreakMode::lexicographic);
+
+  EXPECT_EQ(getLoadOrder(), ps.Sort(game_));
+}
+
+TEST_P(PluginSorterTest,
+       sortingWithLexicographicTieBreaksShouldNotAddTieBreakEdges) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.SetTieBreakMode(TieBreakMode::lexicographic);
+  ps.Sort(game_);
+
+  for (const auto& phase : ps.GetStatistics().phases) {
+    EXPECT_NE("AddTieBreakEdges", phase.name);
+    EXPECT_EQ(0, phase.edgesAdded.count(EdgeType::tieBreak));
+  }
+  EXPECT_EQ("TopologicalSort", ps.GetStatistics().phases.back().name);
+}
+
+TEST_P(
+    PluginSorterTest,
+    sortingAgainAfterLoadingDifferentPluginsShouldGiveTheSameResultAsANewSorter) {
+  PluginSorter ps;
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+  auto firstSorted = ps.Sort(game_);
+
+  ASSERT_NO_THROW(game_.LoadPlugins({masterFile, blankEsm}, false));
+  EXPECT_EQ(PluginSorter().Sort(game_), ps.Sort(game_));
+
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+  EXPECT_EQ(firstSorted, ps.Sort(game_));
+}
+
+TEST_P(PluginSorterTest, sortingShouldRecordStatisticsForEachPhase) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  auto sorted = ps.Sort(game_);
+
+  std::vector<std::string> phaseNames;
+  size_t edgesAdded = 0;
+  for (const auto& phase : ps.GetStatistics().phases) {
+    phaseNames.push_back(phase.name);
+    EXPECT_LE(phase.pathHits, phase.pathQueries);
+    for (const auto& edges : phase.edgesAdded) {
+      edgesAdded += edges.second;
+    }
+  }
+
+  EXPECT_EQ(std::vector<std::string>({"AddPluginVertices",
+                                      "AddSpecificEdges",
+                                      "AddHardcodedPluginEdges",
+                                      "AddGroupEdges",
+                                      "AddOverlapEdges",
+                                      "AddTieBreakEdges",
+                                      "CheckForCycles",
+                                      "TopologicalSort"}),
+            phaseNames);
+  // The sorted order is unique, so there must be at least one edge between
+  // each pair of consecutive plugins.
+  EXPECT_LE(sorted.size() - 1, edgesAdded);
+  EXPECT_LT(0, ps.GetStatistics().phases[5].cycleChecks);
+  EXPECT_LT(0, ps.GetStatistics().peakGraphMemory);
+}
+
+TEST_P(PluginSorterTest,
+       sortingWithValidationEnabledShouldAddAPhaseAndFindNoViolations) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  auto expected = ps.Sort(game_);
+
+  for (auto mode : {TieBreakMode::edges, TieBreakMode::lexicographic}) {
+    ps.SetTieBreakMode(mode);
+    ps.SetValidationEnabled(true);
+    auto sorted = ps.Sort(game_);
+
+    if (mode == TieBreakMode::edges) {
+      EXPECT_EQ(expected, sorted);
+    }
+    EXPECT_EQ("ValidateSortedOrder", ps.GetStatistics().phases.back().name);
+    EXPECT_TRUE(ps.GetStatistics().constraintViolations.empty());
+  }
+}
+
+TEST_P(PluginSorterTest,
+       sortingWithValidationDisabledShouldNotRecordAValidationPhase) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.SetValidationEnabled(true);
+  ps.Sort(game_);
+  ps.SetValidationEnabled(false);
+  ps.Sort(game_);
+
+  EXPECT_EQ("TopologicalSort", ps.GetStatistics().phases.back().name);
+  EXPECT_TRUE(ps.GetStatistics().constraintViolations.empty());
+}
+
+TEST_P(PluginSorterTest, sortingTheSameInputsAgainShouldReuseTheEarlierResult) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  auto expected = ps.Sort(game_);
+  ASSERT_FALSE(ps.GetStatistics().isCachedResult);
+  auto peakGraphMemory = ps.GetStatistics().peakGraphMemory;
+
+  EXPECT_EQ(expected, ps.Sort(game_));
+  EXPECT_TRUE(ps.GetStatistics().isCachedResult);
+  ASSERT_EQ(1, ps.GetStatistics().phases.size());
+  EXPECT_EQ("AddPluginVertices", ps.GetStatistics().phases[0].name);
+  EXPECT_EQ(peakGraphMemory, ps.GetStatistics().peakGraphMemory);
+}
+
+TEST_P(PluginSorterTest, getPluginsPathShouldThrowIfNothingHasBeenSorted) {
+  PluginSorter ps;
+
+  EXPECT_THROW(ps.GetPluginsPath(blankEsm, blankMasterDependentEsm),
+               std::invalid_argument);
+}
+
+TEST_P(PluginSorterTest,
+       getPluginsPathShouldFindTheConstraintsBetweenPluginsInTheLastSort) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.Sort(game_);
+
+  auto path = ps.GetPluginsPath(blankEsm, blankMasterDependentEsm);
+
+  ASSERT_EQ(2, path.size());
+  EXPECT_EQ(blankEsm, path[0].GetName());
+  EXPECT_EQ(EdgeType::master, path[0].GetTypeOfEdgeToNextVertex());
+  EXPECT_EQ(blankMasterDependentEsm, path[1].GetName());
+  EXPECT_TRUE(ps.GetPluginsPath(blankMasterDependentEsm, blankEsm).empty());
+}
+
+TEST_P(PluginSorterTest,
+       getPluginsPathShouldUseTheGraphOfACachedSortWhenItIsReused) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.Sort(game_);
+  auto expected = ps.GetPluginsPath(blankEsm, blankPluginDependentEsp);
+
+  PluginMetadata plugin(blankEsp);
+  plugin.SetLoadAfterFiles({File(blankDifferentEsp)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+  ps.Sort(game_);
+
+  game_.GetDatabase()->DiscardPluginUserMetadata(blankEsp);
+  ps.Sort(game_);
+  ASSERT_TRUE(ps.GetStatistics().isCachedResult);
+
+  auto path = ps.GetPluginsPath(blankEsm, blankPluginDependentEsp);
+  ASSERT_EQ(expected.size(), path.size());
+  for (size_t i = 0; i < path.size(); ++i) {
+    EXPECT_EQ(expected[i].GetName(), path[i].GetName());
+    EXPECT_EQ(expected[i].GetTypeOfEdgeToNextVertex(),
+              path[i].GetTypeOfEdgeToNextVertex());
+  }
+}
+
+TEST_P(PluginSorterTest, trimShouldFreeTheGraphUsedToFindPluginsPaths) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.Sort(game_);
+  ps.Trim();
+
+  EXPECT_THROW(ps.GetPluginsPath(blankEsm, blankMasterDependentEsm),
+               std::invalid_argument);
+}
+
+TEST_P(PluginSorterTest,
+       sortingAfterChangingPluginMetadataShouldNotReuseTheEarlierResult) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.Sort(game_);
+
+  PluginMetadata plugin(blankEsp);
+  plugin.SetLoadAfterFiles({File(blankDifferentEsp)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+
+  auto sorted = ps.Sort(game_);
+
+  EXPECT_FALSE(ps.GetStatistics().isCachedResult);
+  EXPECT_EQ(PluginSorter().Sort(game_), sorted);
+}
+
+TEST_P(PluginSorterTest,
+       sortingAfterChangingTheTieBreakModeShouldNotReuseTheEarlierResult) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  ps.Sort(game_);
+  ps.SetTieBreakMode(TieBreakMode::lexicographic);
+  ps.Sort(game_);
+
+  EXPECT_FALSE(ps.GetStatistics().isCachedResult);
+  EXPECT_EQ("TopologicalSort", ps.GetStatistics().phases.back().name);
+}
+
+TEST_P(PluginSorterTest,
+       sortNewPluginsShouldInsertNewPluginsWithoutReorderingExistingPlugins) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  auto sorted = PluginSorter().Sort(game_);
+  std::vector<std::string> existing;
+  for (const auto& plugin : sorted) {
+    if (plugin != blankEsp && plugin != blankPluginDependentEsp) {
+      existing.push_back(plugin);
+    }
+  }
+
+  PluginSorter ps;
+  auto result =
+      ps.SortNewPlugins(game_, existing, {blankPluginDependentEsp, blankEsp});
+
+  ASSERT_EQ(sorted.size(), result.size());
+  std::vector<std::string> reusedOrder;
+  for (const auto& plugin : result) {
+    if (plugin != blankEsp && plugin != blankPluginDependentEsp) {
+      reusedOrder.push_back(plugin);
+    }
+  }
+  EXPECT_EQ(existing, reusedOrder);
+
+  const auto indexOf = [&](const std::string& plugin) {
+    return std::find(result.begin(), result.end(), plugin) - result.begin();
+  };
+  EXPECT_LT(indexOf(blankEsm), indexOf(blankEsp));
+  EXPECT_LT(indexOf(blankDifferentMasterDependentEsm), indexOf(blankEsp));
+  EXPECT_LT(indexOf(blankEsp), indexOf(blankPluginDependentEsp));
+  EXPECT_EQ("PlaceNewPlugins", ps.GetStatistics().phases.back().name);
+}
+
+TEST_P(PluginSorterTest,
+       sortNewPluginsShouldThrowIfTheExistingOrderLeavesNoValidPosition) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginMetadata plugin(blankDifferentEsm);
+  plugin.SetLoadAfterFiles({File(blankMasterDependentEsm)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+
+  PluginSorter ps;
+  EXPECT_THROW(ps.SortNewPlugins(game_,
+                                 {blankDifferentEsm, blankEsm},
+                                 {blankMasterDependentEsm}),
+               CyclicInteractionError);
+}
+
+TEST_P(PluginSorterTest,
+       sortNewPluginsShouldThrowIfANewPluginIsAlreadyInTheLoadOrder) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  EXPECT_THROW(ps.SortNewPlugins(game_, {blankEsm}, {blankEsm}),
+               std::invalid_argument);
+}
+
 TEST_P(PluginSorterTest, sortingShouldResolveGroupsAsTransitiveLoadAfterSets) {
   ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
 
@@ -358,6 +630,43 @@ TEST_P(
   EXPECT_EQ(expectedSortedOrder, sorted);
 }
 
+TEST_P(PluginSorterTest, sortingShouldReportEachSetOfCyclicPluginsAtOnce) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginMetadata plugin(blankEsp);
+  plugin.SetLoadAfterFiles({File(blankPluginDependentEsp)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+
+  plugin = PluginMetadata(blankEsm);
+  plugin.SetLoadAfterFiles({File(blankMasterDependentEsm)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+
+  try {
+    PluginSorter ps;
+    ps.Sort(game_);
+    FAIL();
+  } catch (CyclicInteractionError &e) {
+    auto cycles = e.GetCycles();
+    ASSERT_EQ(2, cycles.size());
+
+    std::set<std::set<std::string>> cyclePlugins;
+    for (const auto &cycle : cycles) {
+      std::set<std::string> plugins;
+      for (const auto &vertex : cycle) {
+        ASSERT_TRUE(vertex.GetTypeOfEdgeToNextVertex().has_value());
+        plugins.insert(vertex.GetName());
+      }
+      cyclePlugins.insert(plugins);
+    }
+
+    EXPECT_EQ(std::set<std::set<std::string>>({
+                  {blankEsp, blankPluginDependentEsp},
+                  {blankEsm, blankMasterDependentEsm},
+              }),
+              cyclePlugins);
+  }
+}
+
 TEST_P(
     PluginSorterTest,
     sortingShouldThrowForAGroupEdgeThatCausesAMultiGroupCycleBetweenTwoNonDefaultGroups) {
@@ -580,6 +889,152 @@ TEST_P(PluginSorterTest, sortingShouldThrowIfACyclicInteractionIsEncountered) {
   PluginSorter ps;
   EXPECT_THROW(ps.Sort(game_), CyclicInteractionError);
 }
+
+TEST_P(PluginSorterTest,
+       tieBreaksShouldOrderPluginsWithoutLoadOrderPositionsByBasenameThenExtension) {
+  SortCapture capture;
+  capture.gameType = GetParam();
+  for (const auto& name : {"b.esp", "Z.esp", "a.esp", "C.esp", "A.esm"}) {
+    SortCapture::Plugin plugin;
+    plugin.name = name;
+    plugin.normalizedName = NormalizeFilename(name);
+    plugin.group = "default";
+    capture.plugins.push_back(plugin);
+  }
+  capture.plugins[1].loadOrderIndex = 0;
+  capture.masterlistGroups = {Group()};
+  capture.hardcodedPlugins.verticesInDataDirectory =
+      std::vector<bool>(capture.plugins.size(), true);
+  capture.hardcodedPlugins.implicitlyActiveIndices =
+      std::vector<size_t>(capture.plugins.size(), 0);
+
+  const std::vector<std::string> expected(
+      {"Z.esp", "A.esm", "a.esp", "b.esp", "C.esp"});
+  for (auto mode : {TieBreakMode::edges, TieBreakMode::lexicographic}) {
+    PluginSorter ps;
+    ps.SetTieBreakMode(mode);
+    EXPECT_EQ(expected, ps.Sort(capture));
+  }
+}
+
+TEST_P(PluginSorterTest, replayingACapturedSortShouldGiveTheSameResult) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  PluginSorter ps;
+  auto expected = ps.Sort(game_);
+  auto capture = ps.Capture(game_);
+
+  EXPECT_EQ(expected.size(), capture.plugins.size());
+
+  auto capturePath = localPath / "sort.capture";
+  SaveSortCapture(capture, capturePath);
+
+  PluginSorter replaySorter;
+  EXPECT_EQ(expected, replaySorter.Sort(LoadSortCapture(capturePath)));
+}
+
+TEST_P(PluginSorterTest,
+       replayingACapturedSortThatFailedBecauseOfACycleShouldFailTheSameWay) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+  PluginMetadata plugin(blankEsm);
+  plugin.SetLoadAfterFiles({File(blankMasterDependentEsm)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+
+  PluginSorter ps;
+  auto capture = ps.Capture(game_);
+
+  EXPECT_THROW(PluginSorter().Sort(capture), CyclicInteractionError);
+}
+
+TEST_P(PluginSorterTest,
+       aCyclicInteractionErrorShouldRecordTheTypesOfTheEdgesInTheCycle) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+  PluginMetadata plugin(blankEsm);
+  plugin.SetLoadAfterFiles({File(blankMasterDependentEsm)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+
+  PluginSorter ps;
+  try {
+    ps.Sort(game_);
+    FAIL();
+  } catch (CyclicInteractionError &e) {
+    auto cycle = e.GetCycle();
+    ASSERT_EQ(2, cycle.size());
+
+    // The cycle may start at either plugin.
+    if (cycle[0].GetName() != blankEsm) {
+      std::swap(cycle[0], cycle[1]);
+    }
+    EXPECT_EQ(blankEsm, cycle[0].GetName());
+    EXPECT_EQ(EdgeType::master, cycle[0].GetTypeOfEdgeToNextVertex());
+    EXPECT_EQ(blankMasterDependentEsm, cycle[1].GetName());
+    EXPECT_EQ(EdgeType::userLoadAfter, cycle[1].GetTypeOfEdgeToNextVertex());
+  }
+}
+
+TEST_P(PluginSorterTest,
+       sortProfilesShouldGiveEachProfileTheResultOfSortingItsPluginsAlone) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+  const auto loadOrder = getLoadOrder();
+
+  SortProfile allPlugins;
+  for (const auto& plugin : game_.GetCache()->GetPlugins()) {
+    allPlugins.plugins.push_back(plugin->GetName());
+  }
+  allPlugins.loadOrder = loadOrder;
+
+  SortProfile somePlugins;
+  somePlugins.plugins = {blankEsp, blankEsm, masterFile};
+  somePlugins.loadOrder = loadOrder;
+
+  Game otherGame(GetParam(), dataPath.parent_path(), localPath);
+  otherGame.IdentifyMainMasterFile(masterFile);
+  otherGame.LoadCurrentLoadOrderState();
+  otherGame.LoadPlugins(somePlugins.plugins, false);
+
+  PluginSorter ps;
+  auto sorted = ps.SortProfiles(game_, {allPlugins, somePlugins});
+
+  ASSERT_EQ(2, sorted.size());
+  EXPECT_EQ(PluginSorter().Sort(game_), sorted[0]);
+  EXPECT_EQ(PluginSorter().Sort(otherGame), sorted[1]);
+}
+
+TEST_P(PluginSorterTest, sortProfilesShouldUseEachProfilesLoadOrder) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+
+  SortProfile profile;
+  profile.plugins = {blankEsp, blankDifferentEsp};
+  profile.loadOrder = {blankEsp, blankDifferentEsp};
+
+  SortProfile reversedProfile;
+  reversedProfile.plugins = profile.plugins;
+  reversedProfile.loadOrder = {blankDifferentEsp, blankEsp};
+
+  PluginSorter ps;
+  auto sorted = ps.SortProfiles(game_, {profile, reversedProfile});
+
+  ASSERT_EQ(2, sorted.size());
+  EXPECT_EQ(profile.loadOrder, sorted[0]);
+  EXPECT_EQ(reversedProfile.loadOrder, sorted[1]);
+}
+
+TEST_P(PluginSorterTest,
+       sortProfilesShouldThrowIfAProfileHasACyclicInteraction) {
+  ASSERT_NO_THROW(loadInstalledPlugins(game_, false));
+  PluginMetadata plugin(blankEsm);
+  plugin.SetLoadAfterFiles({File(blankMasterDependentEsm)});
+  game_.GetDatabase()->SetPluginUserMetadata(plugin);
+
+  SortProfile profile;
+  profile.plugins = {blankEsp};
+  SortProfile cyclicProfile;
+  cyclicProfile.plugins = {blankEsm, blankMasterDependentEsm};
+
+  PluginSorter ps;
+  EXPECT_THROW(ps.SortProfiles(game_, {profile, cyclicProfile}),
+               CyclicInteractionError);
+}
 }
 }
 
@@ -0,0 +1,145 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_SORTING_SORT_CAPTURE_TEST
+#define LOOT_TESTS_API_INTERNALS_SORTING_SORT_CAPTURE_TEST
+
+#include "api/sorting/sort_capture.h"
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "api/helpers/text.h"
+#include "loot/exception/file_access_error.h"
+
+namespace loot {
+namespace test {
+class SortCaptureTest : public ::testing::Test {
+protected:
+  SortCaptureTest() :
+      capturePath_(std::filesystem::absolute(".") / "sort.capture") {}
+
+  void TearDown() override { std::filesystem::remove(capturePath_); }
+
+  const std::filesystem::path capturePath_;
+};
+
+TEST_F(SortCaptureTest, loadingASavedCaptureShouldGiveTheSameData) {
+  SortCapture capture;
+  capture.gameType = GameType::tes5;
+  capture.plugins.resize(3);
+  capture.plugins[0].name = "Skyrim.esm";
+  capture.plugins[0].isMaster = true;
+  capture.plugins[0].loadOrderIndex = 0;
+  capture.plugins[1].name = "Blank.esp";
+  capture.plugins[1].loadsArchive = true;
+  capture.plugins[1].masters = {"Skyrim.esm"};
+  capture.plugins[1].numOverrideFormIDs = 3;
+  capture.plugins[1].group = "late";
+  capture.plugins[1].masterlistLoadAfterFiles = {"Skyrim.esm"};
+  capture.plugins[1].userRequirements = {"Other.esp"};
+  capture.plugins[2].name = "Other.esp";
+  capture.plugins[2].masters = {"Skyrim.esm"};
+  capture.plugins[2].numOverrideFormIDs = 1;
+  capture.plugins[2].masterlistRequirements = {"Skyrim.esm"};
+  capture.plugins[2].userLoadAfterFiles = {"Blank.esp"};
+  capture.plugins[2].loadOrderIndex = 1;
+  for (auto& plugin : capture.plugins) {
+    plugin.normalizedName = NormalizeFilename(plugin.name);
+  }
+  capture.plugins[1].overlappingPlugins = {"other.esp"};
+  capture.plugins[2].overlappingPlugins = {"blank.esp"};
+  capture.masterlistGroups = {Group(), Group("late", {"default"})};
+  capture.userGroups = {Group("late", {"default"})};
+  capture.hardcodedPlugins.implicitlyActivePlugins = {"Skyrim.esm"};
+  capture.hardcodedPlugins.verticesInDataDirectory = {true, true, false};
+  capture.hardcodedPlugins.implicitlyActiveIndices = {0, 1, 1};
+
+  SaveSortCapture(capture, capturePath_);
+  auto loaded = LoadSortCapture(capturePath_);
+
+  EXPECT_EQ(capture.gameType, loaded.gameType);
+  ASSERT_EQ(capture.plugins.size(), loaded.plugins.size());
+  for (size_t i = 0; i < capture.plugins.size(); ++i) {
+    const auto& expected = capture.plugins[i];
+    const auto& plugin = loaded.plugins[i];
+    EXPECT_EQ(expected.name, plugin.name);
+    EXPECT_EQ(expected.normalizedName, plugin.normalizedName);
+    EXPECT_EQ(expected.isMaster, plugin.isMaster);
+    EXPECT_EQ(expected.loadsArchive, plugin.loadsArchive);
+    EXPECT_EQ(expected.masters, plugin.masters);
+    EXPECT_EQ(expected.numOverrideFormIDs, plugin.numOverrideFormIDs);
+    EXPECT_EQ(expected.group, plugin.group);
+    EXPECT_EQ(expected.masterlistLoadAfterFiles,
+              plugin.masterlistLoadAfterFiles);
+    EXPECT_EQ(expected.userLoadAfterFiles, plugin.userLoadAfterFiles);
+    EXPECT_EQ(expected.masterlistRequirements, plugin.masterlistRequirements);
+    EXPECT_EQ(expected.userRequirements, plugin.userRequirements);
+    EXPECT_EQ(expected.loadOrderIndex, plugin.loadOrderIndex);
+    EXPECT_EQ(expected.overlappingPlugins, plugin.overlappingPlugins);
+  }
+
+  ASSERT_EQ(2, loaded.masterlistGroups.size());
+  ASSERT_EQ(1, loaded.userGroups.size());
+  EXPECT_EQ(std::unordered_set<std::string>({"default"}),
+            loaded.userGroups.begin()->GetAfterGroups());
+  EXPECT_EQ(capture.hardcodedPlugins.implicitlyActivePlugins,
+            loaded.hardcodedPlugins.implicitlyActivePlugins);
+  EXPECT_EQ(capture.hardcodedPlugins.verticesInDataDirectory,
+            loaded.hardcodedPlugins.verticesInDataDirectory);
+  EXPECT_EQ(capture.hardcodedPlugins.implicitlyActiveIndices,
+            loaded.hardcodedPlugins.implicitlyActiveIndices);
+}
+
+TEST_F(SortCaptureTest, loadingShouldThrowIfTheFileDoesNotExist) {
+  EXPECT_THROW(LoadSortCapture(capturePath_), FileAccessError);
+}
+
+TEST_F(SortCaptureTest, loadingShouldThrowIfTheFileIsNotASortCapture) {
+  std::ofstream out(capturePath_);
+  out << "Not a sort capture";
+  out.close();
+
+  EXPECT_THROW(LoadSortCapture(capturePath_), FileAccessError);
+}
+
+TEST_F(SortCaptureTest, loadingShouldThrowIfTheCaptureIsTruncated) {
+  SortCapture capture;
+  capture.plugins.resize(1);
+  capture.plugins[0].name = "Blank.esp";
+  capture.hardcodedPlugins.verticesInDataDirectory = {true};
+  capture.hardcodedPlugins.implicitlyActiveIndices = {0};
+  SaveSortCapture(capture, capturePath_);
+
+  std::filesystem::resize_file(capturePath_,
+                               std::filesystem::file_size(capturePath_) - 4);
+
+  EXPECT_THROW(LoadSortCapture(capturePath_), FileAccessError);
+}
+}
+}
+
+#endif
@@ -0,0 +1,136 @@
+/*  LOOT
+
+    A load order optimisation tool for Oblivion, Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2019    WrinklyNinja
+
+    This file is part of LOOT.
+
+    LOOT is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    LOOT is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LOOT.  If not, see
+    <https://www.gnu.org/licenses/>.
+    */
+
+
+#ifndef LOOT_TESTS_API_INTERNALS_SORTING_SORTED_PLUGIN_GRAPH_TEST
+#define LOOT_TESTS_API_INTERNALS_SORTING_SORTED_PLUGIN_GRAPH_TEST
+
+#include "api/sorting/sorted_plugin_graph.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace loot {
+namespace test {
+// A loads before D because of a tie-break edge, and also because of longer
+// chains of other edges. A also loads before C because of an overlap edge and
+// because of a longer chain.
+inline SortedPluginGraph CreateTestGraph() {
+  SortedPluginGraph graph;
+  graph.AddVertex("A.esp");
+  graph.AddEdge(1, EdgeType::master);
+  graph.AddEdge(2, EdgeType::overlap);
+  graph.AddEdge(3, EdgeType::tieBreak);
+  graph.AddVertex("B.esm");
+  graph.AddEdge(2, EdgeType::overlap);
+  graph.AddVertex("C.esp");
+  graph.AddEdge(3, EdgeType::group);
+  graph.AddVertex("D.esp");
+
+  return graph;
+}
+
+typedef std::vector<std::pair<std::string, std::optional<EdgeType>>>
+    PathPairs;
+
+inline PathPairs ToPairs(const std::vector<Vertex>& path) {
+  PathPairs pairs;
+  for (const auto& vertex : path) {
+    pairs.emplace_back(vertex.GetName(), vertex.GetTypeOfEdgeToNextVertex());
+  }
+  return pairs;
+}
+
+TEST(SortedPluginGraph, addEdgeShouldThrowIfTheEdgeDoesNotGoToALaterVertex) {
+  SortedPluginGraph graph;
+  graph.AddVertex("A.esp");
+  graph.AddVertex("B.esp");
+
+  EXPECT_THROW(graph.AddEdge(0, EdgeType::master), std::logic_error);
+  EXPECT_THROW(graph.AddEdge(1, EdgeType::master), std::logic_error);
+  EXPECT_NO_THROW(graph.AddEdge(2, EdgeType::master));
+}
+
+TEST(SortedPluginGraph, getPathShouldThrowIfAPluginIsNotInTheGraph) {
+  auto graph = CreateTestGraph();
+
+  EXPECT_THROW(graph.GetPath("A.esp", "E.esp"), std::invalid_argument);
+  EXPECT_THROW(graph.GetPath("E.esp", "A.esp"), std::invalid_argument);
+}
+
+TEST(SortedPluginGraph, getPathShouldMatchPluginNamesCaseInsensitively) {
+  auto graph = CreateTestGraph();
+
+  auto path = graph.GetPath("a.ESP", "c.esp");
+
+  ASSERT_EQ(2, path.size());
+  EXPECT_EQ("A.esp", path[0].GetName());
+  EXPECT_EQ("C.esp", path[1].GetName());
+}
+
+TEST(SortedPluginGraph, getPathFromAPluginToItselfShouldContainOnlyThatPlugin) {
+  auto graph = CreateTestGraph();
+
+  auto path = graph.GetPath("B.esm", "B.esm");
+
+  ASSERT_EQ(1, path.size());
+  EXPECT_EQ("B.esm", path[0].GetName());
+  EXPECT_FALSE(path[0].GetTypeOfEdgeToNextVertex().has_value());
+}
+
+TEST(SortedPluginGraph, getPathShouldReturnAnEmptyVectorIfThereIsNoPath) {
+  auto graph = CreateTestGraph();
+
+  EXPECT_TRUE(graph.GetPath("D.esp", "A.esp").empty());
+}
+
+TEST(SortedPluginGraph, getPathShouldPreferPathsWithFewerTieBreakEdges) {
+  auto graph = CreateTestGraph();
+
+  auto path = graph.GetPath("A.esp", "D.esp");
+
+  PathPairs expected{
+      {"A.esp", EdgeType::overlap},
+      {"C.esp", EdgeType::group},
+      {"D.esp", std::nullopt},
+  };
+  EXPECT_EQ(expected, ToPairs(path));
+}
+
+TEST(SortedPluginGraph, getPathShouldPreferFewerEdgesIfTieBreakCountsAreEqual) {
+  auto graph = CreateTestGraph();
+
+  auto path = graph.GetPath("A.esp", "C.esp");
+
+  PathPairs expected{
+      {"A.esp", EdgeType::overlap},
+      {"C.esp", std::nullopt},
+  };
+  EXPECT_EQ(expected, ToPairs(path));
+}
+}
+}
+
+#endif
@@ -172,6 +172,18 @@ protected:
     return lines;
   }
 
+  // Overwrite the plugin without changing its size or modification time, so
+  // that it can only be loaded by reusing data from an earlier parse.
+  void overwritePreservingFileState(const std::string& pluginName) {
+    auto path = dataPath / pluginName;
+    auto fileSize = std::filesystem::file_size(path);
+    auto modificationTime = std::filesystem::last_write_time(path);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << std::string(fileSize, 'x');
+    out.close();
+    std::filesystem::last_write_time(path, modificationTime);
+  }
+
   std::vector<std::string> getLoadOrder() {
     std::vector<std::string> actual;
     if (isLoadOrderTimestampBased(GetParam())) {